@@ -0,0 +1,302 @@
+/** @file
+ *
+ * @brief    Asset transfer into serial flash, see asset_xfer.h.
+ *
+ * @details  The slot ring has a single producer (message handlers, SoftDevice task) and a single
+ *           consumer (asset_xfer_process()), so head and tail need no lock.
+ */
+
+#include <string.h>
+#include "asset_xfer.h"
+#include "nus_proto.h"
+#include "../spi_mdc/src/mdc/crc16.h"                                               // SDK crc16.h shadows the plain name
+
+#define ASSET_XFER_VERIFY_BLOCK         64                                          /**< Read-back block size for the CRC check. */
+#define ASSET_XFER_ACK_EVERY            (ASSET_XFER_SLOTS / 2)                      /**< Progress ACK after this many programmed chunks. */
+
+#define LE16_GET(p)                     ((uint16_t)((p)[0] | ((p)[1] << 8)))
+#define LE32_GET(p)                     ((uint32_t)((p)[0] | ((p)[1] << 8) | ((uint32_t)(p)[2] << 16) | ((uint32_t)(p)[3] << 24)))
+#define LE32_PUT(p, v)                  do { (p)[0] = (uint8_t)(v); (p)[1] = (uint8_t)((v) >> 8); \
+                                             (p)[2] = (uint8_t)((v) >> 16); (p)[3] = (uint8_t)((v) >> 24); } while (0)
+
+typedef enum
+{
+    XFER_IDLE,
+    XFER_ACTIVE,                                                                    /**< Receiving and programming. */
+    XFER_FINISHED,                                                                  /**< Programmed and verified. */
+    XFER_FAILED,                                                                    /**< Flash or CRC error, needs a new BEGIN. */
+} xfer_state_t;
+
+typedef struct
+{
+    uint32_t offset;
+    uint16_t len;
+    uint8_t  data[ASSET_XFER_CHUNK_MAX];
+} xfer_slot_t;
+
+static asset_xfer_flash_t const * mp_flash;
+static void                    (* m_wake)(void);
+
+static xfer_slot_t             m_slots[ASSET_XFER_SLOTS];
+static volatile uint8_t        m_head;                                              /**< Next slot to fill, written by the handlers only. */
+static volatile uint8_t        m_tail;                                              /**< Next slot to program, written by the worker only. */
+
+static volatile xfer_state_t   m_state;
+static uint32_t                m_id;
+static uint32_t                m_addr;
+static uint32_t                m_size;
+static uint16_t                m_crc;
+static uint32_t                m_next;                                              /**< Next offset expected from the phone. */
+static uint32_t                m_gap_reported;                                      /**< m_next value of the last GAP ACK, limits ACK storms. */
+static volatile uint32_t       m_committed;                                         /**< Bytes programmed so far. */
+static uint32_t                m_erased_end;                                        /**< Flash address up to which sectors are erased. */
+static uint8_t                 m_since_ack;
+
+static uint8_t                 m_verify_buf[ASSET_XFER_VERIFY_BLOCK];
+
+
+static uint8_t slots_used(void)
+{
+    return (uint8_t)(m_head - m_tail);
+}
+
+
+static void ack_send(asset_xfer_status_t status)
+{
+    uint8_t payload[11];
+
+    payload[0] = (uint8_t)status;
+    LE32_PUT(&payload[1], m_next);
+    LE32_PUT(&payload[5], m_committed);
+    payload[9]  = ASSET_XFER_SLOTS;
+    payload[10] = ASSET_XFER_CHUNK_MAX;
+
+    (void)nus_proto_send(NUS_PROTO_TYPE_ASSET_ACK, 0, payload, sizeof(payload), NUS_PROTO_MIN_MTU);
+}
+
+
+static void begin_handler(nus_proto_msg_t const * p_msg)
+{
+    uint32_t id, addr, size;
+    uint16_t crc;
+
+    if ((mp_flash == NULL) || (p_msg->len < 14))
+    {
+        ack_send(ASSET_XFER_STATUS_BAD_REQUEST);
+        return;
+    }
+
+    id   = LE32_GET(&p_msg->p_data[0]);
+    addr = LE32_GET(&p_msg->p_data[4]);
+    size = LE32_GET(&p_msg->p_data[8]);
+    crc  = LE16_GET(&p_msg->p_data[12]);
+
+    // Same image again: resume where we left off.
+    if ((m_state == XFER_ACTIVE || m_state == XFER_FINISHED) &&
+        (id == m_id) && (addr == m_addr) && (size == m_size) && (crc == m_crc))
+    {
+        m_gap_reported = UINT32_MAX;
+        ack_send((m_state == XFER_FINISHED) ? ASSET_XFER_STATUS_DONE : ASSET_XFER_STATUS_OK);
+        return;
+    }
+
+    if (slots_used() != 0)
+    {
+        ack_send(ASSET_XFER_STATUS_BUSY);
+        return;
+    }
+
+    if ((size == 0) || (addr % mp_flash->sector_size) != 0)
+    {
+        ack_send(ASSET_XFER_STATUS_BAD_REQUEST);
+        return;
+    }
+
+    m_id           = id;
+    m_addr         = addr;
+    m_size         = size;
+    m_crc          = crc;
+    m_next         = 0;
+    m_gap_reported = UINT32_MAX;
+    m_committed    = 0;
+    m_erased_end   = addr;
+    m_since_ack    = 0;
+    m_state        = XFER_ACTIVE;
+
+    ack_send(ASSET_XFER_STATUS_OK);
+}
+
+
+static void data_handler(nus_proto_msg_t const * p_msg)
+{
+    xfer_slot_t * p_slot;
+    uint32_t      offset;
+    uint16_t      len;
+
+    if ((m_state != XFER_ACTIVE) || (p_msg->len <= 4))
+    {
+        ack_send(ASSET_XFER_STATUS_BAD_REQUEST);
+        return;
+    }
+
+    offset = LE32_GET(&p_msg->p_data[0]);
+    len    = p_msg->len - 4;
+
+    if (offset < m_next)
+    {
+        return;                                                                     // Duplicate after a go-back, already queued.
+    }
+    if (offset != m_next)
+    {
+        if (m_gap_reported != m_next)
+        {
+            m_gap_reported = m_next;
+            ack_send(ASSET_XFER_STATUS_GAP);
+        }
+        return;
+    }
+    if ((len > ASSET_XFER_CHUNK_MAX) || (offset + len > m_size))
+    {
+        ack_send(ASSET_XFER_STATUS_BAD_REQUEST);
+        return;
+    }
+    if (slots_used() == ASSET_XFER_SLOTS)
+    {
+        ack_send(ASSET_XFER_STATUS_BUSY);
+        return;
+    }
+
+    p_slot         = &m_slots[m_head % ASSET_XFER_SLOTS];
+    p_slot->offset = offset;
+    p_slot->len    = len;
+    memcpy(p_slot->data, &p_msg->p_data[4], len);
+    m_head++;
+
+    m_next += len;
+    if (m_wake != NULL)
+    {
+        m_wake();
+    }
+}
+
+
+static void abort_handler(nus_proto_msg_t const * p_msg)
+{
+    (void)p_msg;
+    m_state = XFER_IDLE;                                                            // Worker drops what is still queued.
+    if (m_wake != NULL)
+    {
+        m_wake();
+    }
+}
+
+
+/**@brief Erases as needed and programs one chunk page by page. */
+static bool slot_program(xfer_slot_t const * p_slot)
+{
+    uint32_t        addr = m_addr + p_slot->offset;
+    uint32_t        end  = addr + p_slot->len;
+    uint8_t const * p    = p_slot->data;
+
+    while (end > m_erased_end)
+    {
+        if (!mp_flash->erase_sector(m_erased_end))
+        {
+            return false;
+        }
+        m_erased_end += mp_flash->sector_size;
+    }
+
+    while (addr < end)
+    {
+        uint32_t n = mp_flash->page_size - (addr % mp_flash->page_size);
+        n = (n < end - addr) ? n : (end - addr);
+        if (!mp_flash->program(addr, p, n))
+        {
+            return false;
+        }
+        addr += n;
+        p    += n;
+    }
+
+    return true;
+}
+
+
+static bool image_verify(void)
+{
+    uint16_t crc = 0;
+
+    for (uint32_t off = 0; off < m_size; off += ASSET_XFER_VERIFY_BLOCK)
+    {
+        uint32_t n = m_size - off;
+        n = (n < ASSET_XFER_VERIFY_BLOCK) ? n : ASSET_XFER_VERIFY_BLOCK;
+        if (!mp_flash->read(m_addr + off, m_verify_buf, n))
+        {
+            return false;
+        }
+        crc = crc16_ccitt_update(crc, m_verify_buf, (int)n);
+    }
+
+    return (crc == m_crc);
+}
+
+
+void asset_xfer_init(asset_xfer_flash_t const * p_flash, void (*wake)(void))
+{
+    mp_flash = p_flash;
+    m_wake   = wake;
+    m_head   = 0;
+    m_tail   = 0;
+    m_state  = XFER_IDLE;
+
+    (void)nus_proto_register(NUS_PROTO_TYPE_ASSET_BEGIN, begin_handler);
+    (void)nus_proto_register(NUS_PROTO_TYPE_ASSET_DATA, data_handler);
+    (void)nus_proto_register(NUS_PROTO_TYPE_ASSET_ABORT, abort_handler);
+}
+
+
+void asset_xfer_process(void)
+{
+    while (m_tail != m_head)
+    {
+        xfer_slot_t const * p_slot = &m_slots[m_tail % ASSET_XFER_SLOTS];
+
+        if (m_state == XFER_ACTIVE)
+        {
+            if (!slot_program(p_slot))
+            {
+                m_state = XFER_FAILED;
+                ack_send(ASSET_XFER_STATUS_FLASH_ERROR);
+            }
+            else
+            {
+                m_committed = p_slot->offset + p_slot->len;
+                if (++m_since_ack >= ASSET_XFER_ACK_EVERY)
+                {
+                    m_since_ack = 0;
+                    ack_send(ASSET_XFER_STATUS_OK);
+                }
+            }
+        }
+        m_tail++;
+    }
+
+    if ((m_state == XFER_ACTIVE) && (m_committed == m_size))
+    {
+        m_state = image_verify() ? XFER_FINISHED : XFER_FAILED;
+        ack_send((m_state == XFER_FINISHED) ? ASSET_XFER_STATUS_DONE : ASSET_XFER_STATUS_CRC_ERROR);
+    }
+    else if ((m_state == XFER_ACTIVE) && (m_since_ack != 0))
+    {
+        // Ring drained: report progress so the phone can refill the window.
+        m_since_ack = 0;
+        ack_send(ASSET_XFER_STATUS_OK);
+    }
+}
+
+
+bool asset_xfer_busy(void)
+{
+    return (m_state == XFER_ACTIVE);
+}
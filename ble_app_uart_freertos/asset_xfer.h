@@ -0,0 +1,90 @@
+/** @file
+ *
+ * @defgroup asset_xfer Asset transfer into serial flash
+ * @{
+ * @ingroup  ble_sdk_app_nus_eval
+ * @brief    Streams fonts and images received over the framed NUS protocol into serial flash.
+ *
+ * @details  The phone opens a transfer with ASSET_BEGIN (id, flash address, size, CRC16 of the
+ *           whole image) and then streams ASSET_DATA chunks tagged with their offset. Received
+ *           chunks are queued in a small slot ring by the SoftDevice task and programmed by a
+ *           worker (asset_xfer_process()), so flash erase/program overlaps radio reception.
+ *
+ *           Flow control is a sliding window of ASSET_XFER_SLOTS chunks. Every ASSET_ACK carries
+ *           the next offset the watch expects and the offset already programmed; the phone keeps at
+ *           most one window beyond the programmed offset and restarts from "next" on any gap or
+ *           BUSY status. After a disconnect, repeating the same ASSET_BEGIN resumes from "next".
+ *           When the last byte is programmed the worker reads the image back, checks the CRC and
+ *           sends a final ACK with ASSET_XFER_STATUS_DONE or ASSET_XFER_STATUS_CRC_ERROR.
+ *
+ *           Payloads (little endian):
+ *           - ASSET_BEGIN: id u32, addr u32, size u32, crc u16. addr must be sector aligned.
+ *           - ASSET_DATA:  offset u32, data[1..ASSET_XFER_CHUNK_MAX].
+ *           - ASSET_ACK:   status u8, next u32, committed u32, window u8, chunk u8.
+ *           - ASSET_ABORT: empty.
+ */
+
+#ifndef ASSET_XFER_H__
+#define ASSET_XFER_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ASSET_XFER_SLOTS                8                                           /**< Chunks buffered between radio and flash, also the window. */
+#define ASSET_XFER_CHUNK_MAX            232                                         /**< Largest chunk that keeps ASSET_DATA in one 244 byte write. */
+
+/**@brief Message types used on top of nus_proto. */
+#define NUS_PROTO_TYPE_ASSET_BEGIN      0x10
+#define NUS_PROTO_TYPE_ASSET_DATA       0x11
+#define NUS_PROTO_TYPE_ASSET_ACK        0x12
+#define NUS_PROTO_TYPE_ASSET_ABORT      0x13
+
+/**@brief Status byte of ASSET_ACK. */
+typedef enum
+{
+    ASSET_XFER_STATUS_OK          = 0,                                              /**< Progress report. */
+    ASSET_XFER_STATUS_BUSY        = 1,                                              /**< Slot ring full, chunk dropped. */
+    ASSET_XFER_STATUS_GAP         = 2,                                              /**< Unexpected offset, resend from next. */
+    ASSET_XFER_STATUS_DONE        = 3,                                              /**< Image programmed and CRC matched. */
+    ASSET_XFER_STATUS_CRC_ERROR   = 4,                                              /**< Image programmed but CRC mismatch. */
+    ASSET_XFER_STATUS_FLASH_ERROR = 5,                                              /**< Erase, program or read failed. */
+    ASSET_XFER_STATUS_BAD_REQUEST = 6,                                              /**< Malformed or unexpected message. */
+} asset_xfer_status_t;
+
+/**@brief Flash access used by the worker. All calls are blocking. */
+typedef struct
+{
+    bool   (*erase_sector)(uint32_t addr);
+    bool   (*program)(uint32_t addr, uint8_t const * p_data, uint32_t len);         /**< Never crosses a page. */
+    bool   (*read)(uint32_t addr, uint8_t * p_data, uint32_t len);
+    uint32_t sector_size;
+    uint32_t page_size;
+} asset_xfer_flash_t;
+
+/**@brief Function for initializing the transfer service and registering its message handlers.
+ *
+ * @param[in] p_flash  Flash access, may be NULL when no flash is attached (every BEGIN is refused).
+ * @param[in] wake     Called from the receive context when the worker has something to do.
+ */
+void asset_xfer_init(asset_xfer_flash_t const * p_flash, void (*wake)(void));
+
+/**@brief Function for programming queued chunks and verifying a finished image.
+ *
+ * @details Call from a low priority task whenever @p wake fired. Returns once the ring is empty.
+ */
+void asset_xfer_process(void);
+
+/**@brief Function for telling whether a transfer is open (for power management decisions). */
+bool asset_xfer_busy(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ASSET_XFER_H__
+
+/** @} */
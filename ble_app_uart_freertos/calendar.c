@@ -0,0 +1,317 @@
+/** @file
+ *
+ * @brief    Calendar service, see calendar.h.
+ *
+ * @details  calendar_tick() is the only writer of the time. calendar_set() may be called from any
+ *           task: it posts the new time, calendar_get() returns it at once and the next tick applies
+ *           it and publishes the change, so all events come from the 1 Hz source context.
+ */
+
+#include <string.h>
+#include "calendar.h"
+
+#define CALENDAR_RETAIN_MAGIC           0x43414C44UL                                /**< "CALD" */
+
+#ifndef CALENDAR_RETAINED_SECTION
+#define CALENDAR_RETAINED_SECTION       ".non_init"                                 /**< Not cleared by the start-up code. */
+#endif
+
+/**@brief Time kept across soft resets, valid if magic and check match. */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t time;
+    uint32_t check;                                                                 /**< ~time */
+} calendar_retained_t;
+
+static calendar_retained_t m_retained __attribute__((section(CALENDAR_RETAINED_SECTION)));
+
+static calendar_rtc_t const * mp_rtc;
+static calendar_handler_t     m_handlers[CALENDAR_MAX_HANDLERS];
+static volatile uint32_t      m_time;                                               /**< Seconds since 1970, written by calendar_tick() only. */
+static calendar_tm_t          m_tm;                                                 /**< m_time as calendar fields. */
+static volatile uint32_t      m_set_time;                                           /**< Time posted by calendar_set(). */
+static volatile uint8_t       m_set_seq;                                            /**< Bumped by calendar_set() after m_set_time. */
+static uint8_t                m_set_applied;                                        /**< m_set_seq value last applied by calendar_tick(). */
+
+static const char m_wday_names[]  = "SunMonTueWedThuFriSat";
+static const char m_month_names[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+
+/**@brief Text positions of the fields in "Www Mmm dd yyyy\nhh:mm:ss". */
+#define POS_WDAY                        0
+#define POS_MONTH                       4
+#define POS_DAY                         8
+#define POS_YEAR                        11
+#define POS_HOUR                        16
+#define POS_MINUTE                      19
+#define POS_SECOND                      22
+
+
+/**@brief Days since 1970-01-01 of a proleptic Gregorian date (H. Hinnant's days_from_civil). */
+static uint32_t days_from_civil(uint32_t y, uint32_t m, uint32_t d)
+{
+    uint32_t era, yoe, doy, doe;
+
+    y  -= (m <= 2);
+    era = y / 400;
+    yoe = y - era * 400;
+    doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+
+    return era * 146097 + doe - 719468;
+}
+
+
+void calendar_time_to_tm(time_t time, calendar_tm_t * p_tm)
+{
+    uint32_t t    = (uint32_t)time;
+    uint32_t days = t / 86400;
+    uint32_t secs = t % 86400;
+    uint32_t z, era, doe, yoe, doy, mp, y;
+
+    p_tm->hour   = (uint8_t)(secs / 3600);
+    p_tm->minute = (uint8_t)((secs / 60) % 60);
+    p_tm->second = (uint8_t)(secs % 60);
+    p_tm->wday   = (uint8_t)((days + 4) % 7);                                       // 1970-01-01 was a Thursday
+
+    z   = days + 719468;
+    era = z / 146097;
+    doe = z - era * 146097;
+    yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    mp  = (5 * doy + 2) / 153;
+    y   = yoe + era * 400;
+
+    p_tm->day   = (uint8_t)(doy - (153 * mp + 2) / 5 + 1);
+    p_tm->month = (uint8_t)(mp < 10 ? mp + 3 : mp - 9);
+    p_tm->year  = (uint16_t)(y + (p_tm->month <= 2));
+}
+
+
+time_t calendar_tm_to_time(calendar_tm_t const * p_tm)
+{
+    uint32_t days = days_from_civil(p_tm->year, p_tm->month, p_tm->day);
+
+    return (time_t)(days * 86400UL + p_tm->hour * 3600UL + p_tm->minute * 60UL + p_tm->second);
+}
+
+
+/**@brief Returns the change mask between two calendar field sets. */
+static uint32_t changed_mask(calendar_tm_t const * p_old, calendar_tm_t const * p_new)
+{
+    uint32_t top = 0;
+
+    if (p_old->year != p_new->year)          top = CALENDAR_CHANGED_YEAR;
+    else if (p_old->month != p_new->month)   top = CALENDAR_CHANGED_MONTH;
+    else if (p_old->day != p_new->day)       top = CALENDAR_CHANGED_DAY;
+    else if (p_old->hour != p_new->hour)     top = CALENDAR_CHANGED_HOUR;
+    else if (p_old->minute != p_new->minute) top = CALENDAR_CHANGED_MINUTE;
+    else if (p_old->second != p_new->second) top = CALENDAR_CHANGED_SECOND;
+
+    return (top == 0) ? 0 : ((top << 1) - 1);
+}
+
+
+static void publish(uint32_t changed)
+{
+    for (uint8_t i = 0; i < CALENDAR_MAX_HANDLERS; i++)
+    {
+        if (m_handlers[i] != NULL)
+        {
+            m_handlers[i](changed, &m_tm);
+        }
+    }
+}
+
+
+static void retain(uint32_t time)
+{
+    m_retained.time  = time;
+    m_retained.check = ~time;
+    m_retained.magic = CALENDAR_RETAIN_MAGIC;
+}
+
+
+void calendar_init(calendar_rtc_t const * p_rtc, time_t fallback)
+{
+    calendar_tm_t tm;
+
+    mp_rtc = p_rtc;
+    memset(m_handlers, 0, sizeof(m_handlers));
+    m_set_applied = m_set_seq;
+
+    if ((mp_rtc != NULL) && mp_rtc->read(&tm))
+    {
+        m_time = (uint32_t)calendar_tm_to_time(&tm);
+    }
+    else if ((m_retained.magic == CALENDAR_RETAIN_MAGIC) && (m_retained.check == ~m_retained.time))
+    {
+        m_time = m_retained.time;
+    }
+    else
+    {
+        m_time = (uint32_t)fallback;
+    }
+
+    calendar_time_to_tm(m_time, &m_tm);
+    retain(m_time);
+}
+
+
+bool calendar_subscribe(calendar_handler_t handler)
+{
+    for (uint8_t i = 0; i < CALENDAR_MAX_HANDLERS; i++)
+    {
+        if (m_handlers[i] == NULL)
+        {
+            m_handlers[i] = handler;
+            return true;
+        }
+    }
+    return false;
+}
+
+
+void calendar_tick(uint32_t seconds)
+{
+    calendar_tm_t old = m_tm;
+    uint32_t      changed;
+    uint8_t       seq = m_set_seq;
+
+    if (seq != m_set_applied)
+    {
+        m_set_applied = seq;
+        m_time        = m_set_time;
+        calendar_time_to_tm(m_time, &m_tm);
+        if ((mp_rtc != NULL) && (mp_rtc->write != NULL))
+        {
+            (void)mp_rtc->write(&m_tm);
+        }
+        changed = CALENDAR_CHANGED_ALL;
+    }
+    else
+    {
+        if (seconds == 0)
+        {
+            return;
+        }
+        m_time += seconds;
+        calendar_time_to_tm(m_time, &m_tm);
+        changed = changed_mask(&old, &m_tm);
+    }
+
+    retain(m_time);
+    publish(changed);
+}
+
+
+void calendar_set(time_t time)
+{
+    m_set_time = (uint32_t)time;
+    m_set_seq++;
+}
+
+
+time_t calendar_get(void)
+{
+    return (time_t)((m_set_seq != m_set_applied) ? m_set_time : m_time);
+}
+
+
+void calendar_tm_get(calendar_tm_t * p_tm)
+{
+    calendar_time_to_tm(calendar_get(), p_tm);
+}
+
+
+/**@brief Copies @p n characters into the text, touching only those that differ. */
+static void text_put(calendar_fmt_t * p_fmt, uint8_t pos, char const * p_src, uint8_t n,
+                     int16_t * p_first, int16_t * p_last)
+{
+    for (uint8_t i = 0; i < n; i++)
+    {
+        if (p_fmt->text[pos + i] != p_src[i])
+        {
+            p_fmt->text[pos + i] = p_src[i];
+            if ((*p_first < 0) || (pos + i < *p_first))
+            {
+                *p_first = pos + i;
+            }
+            if (pos + i > *p_last)
+            {
+                *p_last = pos + i;
+            }
+        }
+    }
+}
+
+
+static void text_put_2d(calendar_fmt_t * p_fmt, uint8_t pos, uint8_t value,
+                        int16_t * p_first, int16_t * p_last)
+{
+    char digits[2];
+
+    digits[0] = (char)('0' + (value / 10) % 10);
+    digits[1] = (char)('0' + value % 10);
+    text_put(p_fmt, pos, digits, 2, p_first, p_last);
+}
+
+
+void calendar_fmt_init(calendar_fmt_t * p_fmt)
+{
+    memcpy(p_fmt->text, "--- --- -- ----\n--:--:--", CALENDAR_TEXT_LEN + 1);
+    p_fmt->valid = false;
+}
+
+
+bool calendar_fmt_update(calendar_fmt_t * p_fmt, calendar_tm_t const * p_tm,
+                         uint8_t * p_first, uint8_t * p_last)
+{
+    calendar_tm_t const * p_old = &p_fmt->shown;
+    bool                  all   = !p_fmt->valid;
+    int16_t               first = -1;
+    int16_t               last  = -1;
+
+    // Only fields whose value moved are formatted; text_put() then skips unchanged digits.
+    if (all || (p_tm->second != p_old->second))
+    {
+        text_put_2d(p_fmt, POS_SECOND, p_tm->second, &first, &last);
+    }
+    if (all || (p_tm->minute != p_old->minute))
+    {
+        text_put_2d(p_fmt, POS_MINUTE, p_tm->minute, &first, &last);
+    }
+    if (all || (p_tm->hour != p_old->hour))
+    {
+        text_put_2d(p_fmt, POS_HOUR, p_tm->hour, &first, &last);
+    }
+    if (all || (p_tm->day != p_old->day))
+    {
+        text_put_2d(p_fmt, POS_DAY, p_tm->day, &first, &last);
+    }
+    if (all || (p_tm->wday != p_old->wday))
+    {
+        text_put(p_fmt, POS_WDAY, &m_wday_names[(p_tm->wday % 7) * 3], 3, &first, &last);
+    }
+    if ((all || (p_tm->month != p_old->month)) && (p_tm->month >= 1) && (p_tm->month <= 12))
+    {
+        text_put(p_fmt, POS_MONTH, &m_month_names[(p_tm->month - 1) * 3], 3, &first, &last);
+    }
+    if (all || (p_tm->year != p_old->year))
+    {
+        text_put_2d(p_fmt, POS_YEAR, (uint8_t)(p_tm->year / 100), &first, &last);
+        text_put_2d(p_fmt, POS_YEAR + 2, (uint8_t)(p_tm->year % 100), &first, &last);
+    }
+
+    p_fmt->shown = *p_tm;
+    p_fmt->valid = true;
+
+    if (first < 0)
+    {
+        return false;
+    }
+
+    *p_first = (uint8_t)first;
+    *p_last  = (uint8_t)last;
+    return true;
+}
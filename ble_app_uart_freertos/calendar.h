@@ -0,0 +1,135 @@
+/** @file
+ *
+ * @defgroup calendar Calendar service
+ * @{
+ * @ingroup  ble_sdk_app_nus_eval
+ * @brief    Wall clock time kept from a 1 Hz source, published to subscribers as change events.
+ *
+ * @details  The service holds the time as seconds since 1970-01-01 (UTC, no leap seconds) and
+ *           converts it to calendar fields itself, so it needs neither localtime() nor the C library
+ *           time zone state. A 1 Hz source calls calendar_tick(): on the BLE board that is a
+ *           FreeRTOS timer, whose tick count RTC1 drives from the low frequency clock.
+ *           The optional hardware RTC binding is read at start-up and written on every
+ *           calendar_set(), so the time survives resets of the host. With an S1D13C00 attached
+ *           that is its RTC, see mdc_disp_rtc. Without one the time is retained in uninitialized
+ *           RAM across soft resets.
+ *
+ *           The formatter keeps the last text it produced and rewrites only the characters whose
+ *           calendar field changed, reporting the changed range so the UI can invalidate just
+ *           those glyph cells. The layout puts the fastest changing field last:
+ *
+ *           "Www Mmm dd yyyy\nhh:mm:ss"
+ */
+
+#ifndef CALENDAR_H__
+#define CALENDAR_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CALENDAR_MAX_HANDLERS           4                                           /**< Number of subscribers. */
+#define CALENDAR_TEXT_LEN               24                                          /**< Characters produced by the formatter. */
+
+/**@brief Bits of the change mask passed to subscribers. A change implies all lower bits. */
+#define CALENDAR_CHANGED_SECOND         (1 << 0)
+#define CALENDAR_CHANGED_MINUTE         (1 << 1)
+#define CALENDAR_CHANGED_HOUR           (1 << 2)
+#define CALENDAR_CHANGED_DAY            (1 << 3)
+#define CALENDAR_CHANGED_MONTH          (1 << 4)
+#define CALENDAR_CHANGED_YEAR           (1 << 5)
+#define CALENDAR_CHANGED_ALL            0x3F                                        /**< Time was set, redraw everything. */
+
+/**@brief Calendar fields, tm-like but fixed width and without time zone state. */
+typedef struct
+{
+    uint16_t year;                                                                  /**< Full year, e.g. 2020. */
+    uint8_t  month;                                                                 /**< 1..12. */
+    uint8_t  day;                                                                   /**< 1..31. */
+    uint8_t  wday;                                                                  /**< 0 = Sunday. */
+    uint8_t  hour;
+    uint8_t  minute;
+    uint8_t  second;
+} calendar_tm_t;
+
+/**@brief Called from the context of the 1 Hz source, keep it short. */
+typedef void (*calendar_handler_t)(uint32_t changed, calendar_tm_t const * p_tm);
+
+/**@brief Optional hardware RTC that keeps counting while the application is reset. */
+typedef struct
+{
+    bool (*read)(calendar_tm_t * p_tm);                                             /**< false if the RTC holds no valid time. */
+    bool (*write)(calendar_tm_t const * p_tm);
+} calendar_rtc_t;
+
+/**@brief Incremental formatter state. */
+typedef struct
+{
+    char          text[CALENDAR_TEXT_LEN + 1];                                      /**< Always NUL terminated. */
+    calendar_tm_t shown;                                                            /**< Fields text currently reflects. */
+    bool          valid;                                                            /**< false until the first full format. */
+} calendar_fmt_t;
+
+/**@brief Function for initializing the service.
+ *
+ * @details The start time is taken from @p p_rtc if it holds a valid time, else from retained RAM
+ *          if the last reset preserved it, else @p fallback.
+ *
+ * @param[in] p_rtc     Hardware RTC binding, may be NULL.
+ * @param[in] fallback  Seconds since 1970 used on a cold start without RTC.
+ */
+void calendar_init(calendar_rtc_t const * p_rtc, time_t fallback);
+
+/**@brief Function for registering a change event handler.
+ *
+ * @return false if all CALENDAR_MAX_HANDLERS slots are taken.
+ */
+bool calendar_subscribe(calendar_handler_t handler);
+
+/**@brief Function for advancing the time, called by the 1 Hz source.
+ *
+ * @param[in] seconds  Seconds elapsed since the previous call, normally 1.
+ */
+void calendar_tick(uint32_t seconds);
+
+/**@brief Function for setting the time. Writes the hardware RTC and publishes CALENDAR_CHANGED_ALL. */
+void calendar_set(time_t time);
+
+/**@brief Function for reading the time as seconds since 1970. */
+time_t calendar_get(void);
+
+/**@brief Function for reading the time as calendar fields. */
+void calendar_tm_get(calendar_tm_t * p_tm);
+
+/**@brief Function for converting seconds since 1970 to calendar fields. */
+void calendar_time_to_tm(time_t time, calendar_tm_t * p_tm);
+
+/**@brief Function for converting calendar fields to seconds since 1970. wday is ignored. */
+time_t calendar_tm_to_time(calendar_tm_t const * p_tm);
+
+/**@brief Function for resetting a formatter so the next update formats the whole text. */
+void calendar_fmt_init(calendar_fmt_t * p_fmt);
+
+/**@brief Function for bringing the formatter text up to date.
+ *
+ * @param[in,out] p_fmt    Formatter.
+ * @param[in]     p_tm     Time to show.
+ * @param[out]    p_first  Index of the first rewritten character.
+ * @param[out]    p_last   Index of the last rewritten character.
+ *
+ * @return false if no character changed (*p_first and *p_last are left untouched).
+ */
+bool calendar_fmt_update(calendar_fmt_t * p_fmt, calendar_tm_t const * p_tm,
+                         uint8_t * p_first, uint8_t * p_last);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CALENDAR_H__
+
+/** @} */
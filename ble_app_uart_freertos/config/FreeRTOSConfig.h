@@ -84,8 +84,8 @@
 #define configUSE_MALLOC_FAILED_HOOK                                              0
 
 /* Run time and task stats gathering related definitions. */
-#define configGENERATE_RUN_TIME_STATS                                             0
-#define configUSE_TRACE_FACILITY                                                  0
+#define configGENERATE_RUN_TIME_STATS                                             1 /* Clocked by the tick RTC, see perf_metrics.h */
+#define configUSE_TRACE_FACILITY                                                  1
 #define configUSE_STATS_FORMATTING_FUNCTIONS                                      0
 
 /* Co-routine definitions. */
@@ -189,6 +189,16 @@ standard names - or at least those used in the unmodified vector table. */
         #include <stdint.h>
         extern uint32_t SystemCoreClock;
     #endif
+
+    /* Run time stats and tickless idle accounting, implemented in perf_metrics.c. */
+    extern uint32_t perf_metrics_rtc_time(void);
+    extern void perf_metrics_sleep_begin(void);
+    extern void perf_metrics_sleep_end(void);
+
+    #define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()                            /* The tick RTC is started by the port. */
+    #define portGET_RUN_TIME_COUNTER_VALUE()                                    perf_metrics_rtc_time()
+    #define traceLOW_POWER_IDLE_BEGIN()                                         perf_metrics_sleep_begin()
+    #define traceLOW_POWER_IDLE_END()                                           perf_metrics_sleep_end()
 #endif /* !assembler */
 
 /** Implementation note:  Use this with caution and set this to 1 ONLY for debugging
@@ -0,0 +1,485 @@
+/** @file
+ *
+ * @brief    Host simulator of the asset transfer service: a phone and a fake link against the
+ *           watch side in asset_xfer.c, which programs a fake serial flash.
+ *
+ * @details  asset_xfer_sim [seed]
+ *
+ *           Time is virtual, in microseconds. The link carries one write at a time at
+ *           SIM_LINK_BPS, each direction loses writes with the scenario's loss rate and delivers
+ *           them after SIM_LINK_LATENCY_US. The fake flash follows NOR rules: erase sets a sector
+ *           to 0xFF, programming only clears bits and may not cross a page, and every operation
+ *           keeps the worker busy for its typical duration. The worker runs when woken and idle,
+ *           while the radio keeps delivering, so the reported time shows how much of the flash
+ *           work is hidden behind reception.
+ *
+ *           The phone follows asset_xfer.h: it streams chunks up to one window beyond the
+ *           programmed offset, goes back to "next" on GAP or BUSY, and repeats ASSET_BEGIN to
+ *           poll the state when no ACK came for SIM_PHONE_TIMEOUT_US, which also resumes after a
+ *           disconnect.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "asset_xfer.h"
+#include "nus_proto.h"
+#include "crc16.h"
+
+#define SIM_FLASH_SIZE                  (512 * 1024)
+#define SIM_FLASH_SECTOR                4096
+#define SIM_FLASH_PAGE                  256
+#define SIM_ERASE_US                    45000                                       /**< Sector erase. */
+#define SIM_PROGRAM_US                  700                                         /**< Page program, any length. */
+#define SIM_READ_US_PER_KB              80                                          /**< Read back for the CRC check. */
+
+#define SIM_LINK_BPS                    800000                                      /**< Payload rate of the link. */
+#define SIM_LINK_LATENCY_US             7500                                        /**< One connection interval. */
+#define SIM_LINK_QUEUE                  64                                          /**< Writes in flight per direction. */
+#define SIM_MTU                         244
+
+#define SIM_PHONE_TIMEOUT_US            300000
+#define SIM_TIME_LIMIT_US               (120ULL * 1000000)
+#define SIM_STEP_US                     100
+
+#define SIM_IMAGE_ADDR                  0x10000
+#define SIM_IMAGE_SIZE                  100000
+
+/**@brief One write on the link. */
+typedef struct
+{
+    uint64_t at;                                                                    /**< Delivery time. */
+    uint16_t len;
+    uint8_t  data[SIM_MTU];
+} sim_write_t;
+
+typedef struct
+{
+    sim_write_t q[SIM_LINK_QUEUE];
+    uint32_t    head;
+    uint32_t    tail;
+    uint64_t    busy_until;                                                         /**< Sender side: link free again. */
+    uint32_t    writes;
+    uint32_t    lost;
+} sim_link_t;
+
+/**@brief Scenario parameters and results. */
+typedef struct
+{
+    char const * p_name;
+    uint32_t     loss_ppm;                                                          /**< Writes lost per million, both ways. */
+    uint32_t     disconnect_at;                                                     /**< Drop the link once this many bytes were sent, 0 for never. */
+    uint64_t     disconnect_us;
+    uint32_t     stuck_addr;                                                        /**< Flash byte that cannot be programmed, 0 for none. */
+    uint32_t     fail_program;                                                      /**< Program call that fails, 0 for none. */
+    uint8_t      expect;                                                            /**< Final ACK status expected. */
+} sim_scenario_t;
+
+static uint8_t    m_flash[SIM_FLASH_SIZE];
+static uint32_t   m_flash_erases;
+static uint32_t   m_flash_programs;
+static uint32_t   m_flash_violations;                                               /**< Page crossings or bits set by programming. */
+static uint64_t   m_flash_cost_us;                                                  /**< Worker time of the current process() call. */
+static uint64_t   m_flash_total_us;
+static uint32_t   m_flash_stuck_addr;
+static uint32_t   m_flash_fail_program;
+
+static sim_link_t m_up;                                                             /**< Phone to watch. */
+static sim_link_t m_down;                                                           /**< Watch to phone. */
+static bool       m_link_up;
+static uint32_t   m_loss_ppm;
+static uint64_t   m_now;
+static bool       m_woken;
+
+static uint8_t    m_image[SIM_IMAGE_SIZE];
+static uint16_t   m_image_crc;
+
+/**@brief Phone state. */
+static struct
+{
+    bool     begun;                                                                 /**< First BEGIN answered. */
+    bool     resync;                                                                /**< Take "next" from the next OK ACK. */
+    uint32_t send_off;
+    uint32_t committed;
+    uint32_t window;
+    uint32_t chunk;
+    uint64_t last_ack;
+    uint32_t data_bytes;                                                            /**< Chunk bytes sent, with resends. */
+    uint32_t sent_end;                                                              /**< Highest offset sent. */
+    uint32_t resent;
+    uint32_t acks;
+    int      final;                                                                 /**< Final status, -1 while running. */
+} m_phone;
+
+static uint32_t m_rand;
+
+
+static uint32_t rand32(void)
+{
+    m_rand ^= m_rand << 13;
+    m_rand ^= m_rand >> 17;
+    m_rand ^= m_rand << 5;
+    return m_rand;
+}
+
+
+static uint32_t le32_get(uint8_t const * p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+
+static void le32_put(uint8_t * p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+
+/**@brief Fake flash, see asset_xfer_flash_t. */
+static bool flash_erase(uint32_t addr)
+{
+    m_flash_cost_us += SIM_ERASE_US;
+    if ((addr % SIM_FLASH_SECTOR != 0) || (addr + SIM_FLASH_SECTOR > SIM_FLASH_SIZE))
+    {
+        m_flash_violations++;
+        return false;
+    }
+    memset(&m_flash[addr], 0xFF, SIM_FLASH_SECTOR);
+    m_flash_erases++;
+    return true;
+}
+
+
+static bool flash_program(uint32_t addr, uint8_t const * p_data, uint32_t len)
+{
+    m_flash_cost_us += SIM_PROGRAM_US;
+    if ((len == 0) || (addr / SIM_FLASH_PAGE != (addr + len - 1) / SIM_FLASH_PAGE) ||
+        (addr + len > SIM_FLASH_SIZE))
+    {
+        m_flash_violations++;
+        return false;
+    }
+    if (++m_flash_programs == m_flash_fail_program)
+    {
+        return false;
+    }
+    for (uint32_t i = 0; i < len; i++)
+    {
+        if ((p_data[i] & ~m_flash[addr + i]) != 0)
+        {
+            m_flash_violations++;                                                   // Needs an erase first
+        }
+        m_flash[addr + i] &= p_data[i];
+        if ((m_flash_stuck_addr != 0) && (addr + i == m_flash_stuck_addr))
+        {
+            m_flash[addr + i] &= 0xFE;                                              // Stuck at 0
+        }
+    }
+    return true;
+}
+
+
+static bool flash_read(uint32_t addr, uint8_t * p_data, uint32_t len)
+{
+    m_flash_cost_us += (uint64_t)len * SIM_READ_US_PER_KB / 1024;
+    if (addr + len > SIM_FLASH_SIZE)
+    {
+        return false;
+    }
+    memcpy(p_data, &m_flash[addr], len);
+    return true;
+}
+
+
+static asset_xfer_flash_t const m_sim_flash =
+{
+    .erase_sector = flash_erase,
+    .program      = flash_program,
+    .read         = flash_read,
+    .sector_size  = SIM_FLASH_SECTOR,
+    .page_size    = SIM_FLASH_PAGE,
+};
+
+
+static bool link_free(sim_link_t const * p_link)
+{
+    return (m_now >= p_link->busy_until) && (p_link->head - p_link->tail < SIM_LINK_QUEUE);
+}
+
+
+/**@brief Puts a write on the link. It takes the link for its air time and may get lost. */
+static void link_send(sim_link_t * p_link, uint8_t const * p_data, uint16_t len)
+{
+    sim_write_t * p_write;
+    uint64_t      start = (m_now > p_link->busy_until) ? m_now : p_link->busy_until;
+
+    p_link->busy_until = start + (uint64_t)len * 8 * 1000000 / SIM_LINK_BPS;
+    p_link->writes++;
+    if (!m_link_up || (rand32() % 1000000 < m_loss_ppm) || (p_link->head - p_link->tail == SIM_LINK_QUEUE))
+    {
+        p_link->lost++;
+        return;
+    }
+    p_write      = &p_link->q[p_link->head++ % SIM_LINK_QUEUE];
+    p_write->at  = p_link->busy_until + SIM_LINK_LATENCY_US;
+    p_write->len = len;
+    memcpy(p_write->data, p_data, len);
+}
+
+
+static sim_write_t const * link_receive(sim_link_t * p_link)
+{
+    sim_write_t const * p_write;
+
+    if ((p_link->head == p_link->tail) || (p_link->q[p_link->tail % SIM_LINK_QUEUE].at > m_now))
+    {
+        return NULL;
+    }
+    p_write = &p_link->q[p_link->tail % SIM_LINK_QUEUE];
+    p_link->tail++;
+    return p_write;
+}
+
+
+static void link_drop(sim_link_t * p_link)
+{
+    p_link->tail = p_link->head;
+}
+
+
+/**@brief Watch side transmit hook, see nus_proto_tx_t. */
+static bool watch_tx(uint8_t const * p_data, uint16_t len)
+{
+    link_send(&m_down, p_data, len);
+    return true;
+}
+
+
+static void watch_wake(void)
+{
+    m_woken = true;
+}
+
+
+static void phone_send(uint8_t type, uint8_t const * p_payload, uint16_t len)
+{
+    uint8_t frame[SIM_MTU];
+
+    link_send(&m_up, frame, nus_proto_encode(type, 0, 0, p_payload, len, frame, sizeof(frame)));
+}
+
+
+static void phone_begin(void)
+{
+    uint8_t payload[14];
+
+    le32_put(&payload[0], 0xA55E7001UL);
+    le32_put(&payload[4], SIM_IMAGE_ADDR);
+    le32_put(&payload[8], SIM_IMAGE_SIZE);
+    payload[12] = (uint8_t)m_image_crc;
+    payload[13] = (uint8_t)(m_image_crc >> 8);
+    phone_send(NUS_PROTO_TYPE_ASSET_BEGIN, payload, sizeof(payload));
+    m_phone.resync   = true;
+    m_phone.last_ack = m_now;
+}
+
+
+/**@brief Handles one write from the watch: an ACK frame, built in one write by the watch. */
+static void phone_receive(uint8_t const * p_data, uint16_t len)
+{
+    uint8_t const * p = &p_data[NUS_PROTO_HDR_LEN];
+    uint32_t        next;
+
+    if ((len != NUS_PROTO_OVERHEAD + 11) || (p_data[0] != NUS_PROTO_SYNC) ||
+        (p_data[1] != NUS_PROTO_TYPE_ASSET_ACK) ||
+        (crc16_ccitt(p_data, NUS_PROTO_HDR_LEN + 11) != (uint16_t)(p[11] | (p[12] << 8))))
+    {
+        return;
+    }
+    next              = le32_get(&p[1]);
+    m_phone.committed = le32_get(&p[5]);
+    m_phone.window    = p[9];
+    m_phone.chunk     = p[10];
+    m_phone.last_ack  = m_now;
+    m_phone.acks++;
+
+    switch (p[0])
+    {
+        case ASSET_XFER_STATUS_OK:
+            m_phone.begun = true;
+            if (m_phone.resync)
+            {
+                m_phone.resync   = false;
+                m_phone.send_off = next;
+            }
+            break;
+
+        case ASSET_XFER_STATUS_BUSY:
+        case ASSET_XFER_STATUS_GAP:
+            m_phone.send_off = next;
+            break;
+
+        default:
+            m_phone.final = p[0];
+            break;
+    }
+}
+
+
+static void phone_step(void)
+{
+    sim_write_t const * p_write;
+
+    while ((p_write = link_receive(&m_down)) != NULL)
+    {
+        phone_receive(p_write->data, p_write->len);
+    }
+    if ((m_phone.final >= 0) || !link_free(&m_up))
+    {
+        return;
+    }
+    if (m_now - m_phone.last_ack > SIM_PHONE_TIMEOUT_US)
+    {
+        phone_begin();                                                              // Poll, resumes after a disconnect
+        return;
+    }
+    if (m_phone.begun && (m_phone.send_off < SIM_IMAGE_SIZE) &&
+        (m_phone.send_off < m_phone.committed + m_phone.window * m_phone.chunk))
+    {
+        uint8_t  payload[4 + ASSET_XFER_CHUNK_MAX];
+        uint32_t n = SIM_IMAGE_SIZE - m_phone.send_off;
+
+        n = (n < m_phone.chunk) ? n : m_phone.chunk;
+        le32_put(payload, m_phone.send_off);
+        memcpy(&payload[4], &m_image[m_phone.send_off], n);
+        phone_send(NUS_PROTO_TYPE_ASSET_DATA, payload, (uint16_t)(4 + n));
+        if (m_phone.send_off < m_phone.sent_end)
+        {
+            m_phone.resent += n;
+        }
+        m_phone.send_off   += n;
+        m_phone.data_bytes += n;
+        m_phone.sent_end    = (m_phone.send_off > m_phone.sent_end) ? m_phone.send_off : m_phone.sent_end;
+    }
+}
+
+
+/**@brief Runs one scenario, returns true if it ended as expected. */
+static bool scenario_run(sim_scenario_t const * p_sc)
+{
+    uint64_t worker_free = 0;
+    uint64_t disconnect_end = 0;
+    bool     disconnected = false;
+    bool     ok;
+
+    memset(m_flash, 0x00, sizeof(m_flash));                                         // Old content, needs erasing
+    memset(&m_up, 0, sizeof(m_up));
+    memset(&m_down, 0, sizeof(m_down));
+    memset(&m_phone, 0, sizeof(m_phone));
+    m_phone.final        = -1;
+    m_flash_erases       = 0;
+    m_flash_programs     = 0;
+    m_flash_violations   = 0;
+    m_flash_total_us     = 0;
+    m_flash_stuck_addr   = p_sc->stuck_addr;
+    m_flash_fail_program = p_sc->fail_program;
+    m_loss_ppm           = p_sc->loss_ppm;
+    m_link_up            = true;
+    m_now                = 0;
+    m_woken              = false;
+
+    nus_proto_init(NULL, watch_tx);
+    asset_xfer_init(&m_sim_flash, watch_wake);
+    phone_begin();
+
+    for (; (m_phone.final < 0) && (m_now < SIM_TIME_LIMIT_US); m_now += SIM_STEP_US)
+    {
+        sim_write_t const * p_write;
+
+        if (!disconnected && (p_sc->disconnect_at != 0) && (m_phone.data_bytes >= p_sc->disconnect_at))
+        {
+            disconnected   = true;
+            disconnect_end = m_now + p_sc->disconnect_us;
+            m_link_up      = false;
+            link_drop(&m_up);
+            link_drop(&m_down);
+            nus_proto_reset();
+        }
+        if (!m_link_up && (m_now >= disconnect_end))
+        {
+            m_link_up = true;
+        }
+
+        while ((p_write = link_receive(&m_up)) != NULL)
+        {
+            nus_proto_input(p_write->data, p_write->len);
+        }
+        if (m_woken && (m_now >= worker_free))
+        {
+            m_woken         = false;
+            m_flash_cost_us = 0;
+            asset_xfer_process();
+            worker_free       = m_now + m_flash_cost_us;
+            m_flash_total_us += m_flash_cost_us;
+        }
+        phone_step();
+    }
+
+    ok = (m_phone.final == p_sc->expect) && (m_flash_violations == 0);
+    if (ok && (p_sc->expect == ASSET_XFER_STATUS_DONE))
+    {
+        ok = (memcmp(&m_flash[SIM_IMAGE_ADDR], m_image, SIM_IMAGE_SIZE) == 0);
+    }
+
+    printf("{\"scenario\":\"%s\",\"status\":%d,\"ok\":%s,\"time_ms\":%.1f,\"kBps\":%.1f,\"radio_ms\":%.1f,"
+           "\"flash_ms\":%.1f,\"sent\":%u,\"resent\":%u,\"lost\":%u,\"acks\":%u,\"erases\":%u,\"programs\":%u}\n",
+           p_sc->p_name, m_phone.final, ok ? "true" : "false", m_now / 1000.0,
+           SIM_IMAGE_SIZE / 1.024 / (m_now / 1000.0), (double)m_phone.data_bytes * 8 * 1000 / SIM_LINK_BPS, m_flash_total_us / 1000.0,
+           m_phone.data_bytes, m_phone.resent, m_up.lost + m_down.lost, m_phone.acks,
+           m_flash_erases, m_flash_programs);
+    return ok;
+}
+
+
+int main(int argc, char * argv[])
+{
+    static sim_scenario_t const scenarios[] =
+    {
+        { "clean",       0,     0,                  0,      0,                   0,  ASSET_XFER_STATUS_DONE },
+        { "lossy",       20000, 0,                  0,      0,                   0,  ASSET_XFER_STATUS_DONE },
+        { "disconnect",  5000,  SIM_IMAGE_SIZE / 2, 800000, 0,                   0,  ASSET_XFER_STATUS_DONE },
+        { "stuck_bit",   0,     0,                  0,      SIM_IMAGE_ADDR + 777, 0, ASSET_XFER_STATUS_CRC_ERROR },
+        { "program_err", 0,     0,                  0,      0,                   50, ASSET_XFER_STATUS_FLASH_ERROR },
+    };
+    uint32_t failures = 0;
+
+    m_rand = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : 0x1234567UL;
+    if (m_rand == 0)
+    {
+        m_rand = 1;
+    }
+    for (uint32_t i = 0; i < SIM_IMAGE_SIZE; i++)
+    {
+        m_image[i] = (uint8_t)rand32();
+    }
+    m_image_crc = crc16_ccitt(m_image, SIM_IMAGE_SIZE);
+
+    for (uint32_t i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++)
+    {
+        // Stuck bits only show where the image has a 1.
+        if ((scenarios[i].stuck_addr != 0) && ((m_image[scenarios[i].stuck_addr - SIM_IMAGE_ADDR] & 1) == 0))
+        {
+            m_image[scenarios[i].stuck_addr - SIM_IMAGE_ADDR] |= 1;
+            m_image_crc = crc16_ccitt(m_image, SIM_IMAGE_SIZE);
+        }
+        failures += scenario_run(&scenarios[i]) ? 0 : 1;
+    }
+
+    printf("%s\n", (failures == 0) ? "PASS" : "FAIL");
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,189 @@
+/** @file
+ *
+ * @brief    Host test of the Sharp MIP row packing against the per-pixel driver.
+ *
+ * @details  mip_pack_test [iterations]
+ *
+ *           Packs random rows of random width, pixel values and source and destination alignment
+ *           with mip_pack_row() and compares every line with the frame bits set one pixel at a
+ *           time, as the set_px_cb driver sets them. The bytes around each line must stay as they
+ *           were.
+ *
+ *           The throughput test converts 240x240 frames both ways and reports the time per frame.
+ *           On the host mip_pack_row() uses the word arithmetic of cores without the DSP
+ *           extension; cycle counts on the nRF52 come from mip_pack_bench().
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "mip_pack.h"
+
+#define TEST_MAX_WIDTH                  400                                         /**< Widest random row. */
+#define TEST_GUARD                      8                                           /**< Bytes checked around each line. */
+#define TEST_BENCH_WIDTH                240
+#define TEST_BENCH_LINES                240
+#define TEST_BENCH_FRAMES               500
+
+static uint8_t  m_px[TEST_BENCH_WIDTH * TEST_BENCH_LINES + 4];
+static uint8_t  m_frame[2][MIP_PACK_FRAME_SIZE(TEST_BENCH_WIDTH, TEST_BENCH_LINES)];
+static uint32_t m_failures;
+
+static uint32_t m_rand = 0x6C8E9CF5UL;
+
+
+static uint32_t rand32(void)
+{
+    m_rand ^= m_rand << 13;
+    m_rand ^= m_rand >> 17;
+    m_rand ^= m_rand << 5;
+    return m_rand;
+}
+
+
+static double now_s(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+
+static void fail(char const * p_what, uint32_t a, uint32_t b)
+{
+    if (m_failures++ < 10)
+    {
+        printf("FAIL %s (%lu, %lu)\n", p_what, (unsigned long)a, (unsigned long)b);
+    }
+}
+
+
+/**@brief Sets one frame pixel as the set_px_cb driver in main.c does. */
+static void px_set(uint8_t * p_line, uint32_t x, uint8_t px)
+{
+    if (px != 0)
+    {
+        p_line[x >> 3] |= (uint8_t)(0x80 >> (x & 7));
+    }
+    else
+    {
+        p_line[x >> 3] &= (uint8_t)~(0x80 >> (x & 7));
+    }
+}
+
+/**@brief Called through a pointer, as LVGL calls set_px_cb. */
+static void (* volatile mp_px_set)(uint8_t *, uint32_t, uint8_t) = px_set;
+
+
+/**@brief A pixel: black, white 1 as LVGL writes it, or any other non-zero byte. */
+static uint8_t rand_px(void)
+{
+    uint32_t r = rand32();
+
+    switch (r & 3)
+    {
+        case 0:
+        case 1:
+            return 0;
+        case 2:
+            return 1;
+        default:
+            return (uint8_t)((r >> 8) | 1);
+    }
+}
+
+
+static void row_test(uint32_t iterations)
+{
+    static uint8_t px[TEST_MAX_WIDTH + 4];
+    static uint8_t got[TEST_MAX_WIDTH / 8 + 2 * TEST_GUARD + 4];
+    static uint8_t want[sizeof(got)];
+    uint32_t       pixels = 0;
+
+    for (uint32_t it = 0; it < iterations; it++)
+    {
+        uint32_t width   = 8 * (rand32() % (TEST_MAX_WIDTH / 8 + 1));
+        uint32_t src_ofs = rand32() & 3;
+        uint32_t dst_ofs = TEST_GUARD + (rand32() & 3);
+        uint8_t  fill    = (uint8_t)rand32();
+
+        for (uint32_t x = 0; x < width; x++)
+        {
+            px[src_ofs + x] = rand_px();
+        }
+        memset(got, fill, sizeof(got));
+        memset(want, fill, sizeof(want));
+        for (uint32_t x = 0; x < width; x++)
+        {
+            mp_px_set(&want[dst_ofs], x, px[src_ofs + x]);
+        }
+        mip_pack_row(&got[dst_ofs], &px[src_ofs], width);
+
+        if (memcmp(got, want, sizeof(got)) != 0)
+        {
+            fail("line differs", width, src_ofs * 4 + dst_ofs - TEST_GUARD);
+        }
+        pixels += width;
+    }
+    printf("rows: %lu rows, %lu pixels\n", (unsigned long)iterations, (unsigned long)pixels);
+}
+
+
+/**@brief Times TEST_BENCH_FRAMES frames converted per pixel and by rows. */
+static void throughput_test(void)
+{
+    uint32_t const line = MIP_PACK_LINE_BYTES(TEST_BENCH_WIDTH);
+    double         t0, t_px, t_row;
+
+    for (uint32_t i = 0; i < sizeof(m_px); i++)
+    {
+        m_px[i] = rand_px();
+    }
+
+    t0 = now_s();
+    for (uint32_t f = 0; f < TEST_BENCH_FRAMES; f++)
+    {
+        for (uint32_t y = 0; y < TEST_BENCH_LINES; y++)
+        {
+            for (uint32_t x = 0; x < TEST_BENCH_WIDTH; x++)
+            {
+                mp_px_set(&m_frame[0][y * line + 2], x, m_px[y * TEST_BENCH_WIDTH + x]);
+            }
+        }
+    }
+    t_px = now_s() - t0;
+
+    t0 = now_s();
+    for (uint32_t f = 0; f < TEST_BENCH_FRAMES; f++)
+    {
+        for (uint32_t y = 0; y < TEST_BENCH_LINES; y++)
+        {
+            mip_pack_row(&m_frame[1][y * line + 2], &m_px[y * TEST_BENCH_WIDTH], TEST_BENCH_WIDTH);
+        }
+    }
+    t_row = now_s() - t0;
+
+    if (memcmp(m_frame[0], m_frame[1], sizeof(m_frame[0])) != 0)
+    {
+        fail("frames differ", 0, 0);
+    }
+    printf("{\"width\":%u,\"lines\":%u,\"frames\":%u,\"per_pixel_us\":%.1f,\"row_packed_us\":%.1f,\"speedup\":%.1f}\n",
+           TEST_BENCH_WIDTH, TEST_BENCH_LINES, TEST_BENCH_FRAMES, t_px * 1e6 / TEST_BENCH_FRAMES,
+           t_row * 1e6 / TEST_BENCH_FRAMES, (t_row > 0) ? t_px / t_row : 0.0);
+}
+
+
+int main(int argc, char * argv[])
+{
+    uint32_t iterations = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : 20000;
+
+    row_test(iterations);
+    throughput_test();
+
+    printf("%s\n", (m_failures == 0) ? "PASS" : "FAIL");
+    return (m_failures == 0) ? 0 : 1;
+}
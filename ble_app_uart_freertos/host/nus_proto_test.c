@@ -0,0 +1,349 @@
+/** @file
+ *
+ * @brief    Host test of the framed NUS protocol: round trips, fuzzing and throughput.
+ *
+ * @details  nus_proto_test [iterations]
+ *
+ *           The round trip sends random messages with nus_proto_send() at random MTUs and feeds
+ *           the captured writes back cut at random points, so frames straddle writes and writes
+ *           carry several frames. Every message must arrive once and unchanged.
+ *
+ *           The fuzzer flips every single bit of random frames. Outside the length field, where a
+ *           shorter length may meet a matching CRC by chance, they must never reach a handler. It
+ *           also feeds random writes starting with the sync byte, after which valid frames must be
+ *           received again within one maximum sized frame.
+ *
+ *           The throughput test times encoding and zero-copy and reassembled decoding per payload
+ *           size, to show that the cost per message is small and constant.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "nus_proto.h"
+
+#define TEST_TYPE                       0x1E                                        /**< Message type of the test messages. */
+#define TEST_LINK_SIZE                  (1024 * 1024)                               /**< Captured writes. */
+#define TEST_MAX_MSGS                   4096                                        /**< Messages per round trip batch. */
+#define TEST_BENCH_MSGS                 200000                                      /**< Messages per throughput run. */
+
+/**@brief Message expected by the handler. */
+typedef struct
+{
+    uint16_t len;
+    uint32_t offset;                                                                /**< Payload position in m_payloads. */
+} test_msg_t;
+
+static uint8_t    m_link[TEST_LINK_SIZE];
+static uint32_t   m_link_len;
+static uint16_t   m_link_mtu;
+static uint32_t   m_link_writes;
+static bool       m_link_ok;
+
+static uint8_t    m_payloads[TEST_MAX_MSGS * 64];
+static test_msg_t m_expect[TEST_MAX_MSGS];
+static uint32_t   m_expect_count;
+static uint32_t   m_received;
+static uint32_t   m_raw_bytes;
+static bool       m_check;                                                          /**< Handler compares against m_expect. */
+static uint32_t   m_failures;
+
+static uint32_t   m_rand = 0x2545F491UL;
+
+
+static uint32_t rand32(void)
+{
+    m_rand ^= m_rand << 13;
+    m_rand ^= m_rand >> 17;
+    m_rand ^= m_rand << 5;
+    return m_rand;
+}
+
+
+static uint32_t rand_below(uint32_t n)
+{
+    return rand32() % n;
+}
+
+
+static double now_s(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+
+static void fail(char const * p_what, uint32_t a, uint32_t b)
+{
+    if (m_failures++ < 10)
+    {
+        printf("FAIL %s (%lu, %lu)\n", p_what, (unsigned long)a, (unsigned long)b);
+    }
+}
+
+
+/**@brief Transmit hook: appends the write to m_link. */
+static bool link_tx(uint8_t const * p_data, uint16_t len)
+{
+    if ((len == 0) || (len > m_link_mtu) || (m_link_len + len > sizeof(m_link)))
+    {
+        m_link_ok = false;
+        return false;
+    }
+    memcpy(&m_link[m_link_len], p_data, len);
+    m_link_len += len;
+    m_link_writes++;
+    return true;
+}
+
+
+static void raw_handler(uint8_t const * p_data, uint16_t len)
+{
+    (void)p_data;
+    m_raw_bytes += len;
+}
+
+
+static void test_handler(nus_proto_msg_t const * p_msg)
+{
+    test_msg_t const * p_exp;
+
+    m_received++;
+    if (!m_check)
+    {
+        return;
+    }
+    if (m_received > m_expect_count)
+    {
+        fail("unexpected message", m_received, m_expect_count);
+        return;
+    }
+    p_exp = &m_expect[m_received - 1];
+    if ((p_msg->type != TEST_TYPE) || (p_msg->len != p_exp->len) ||
+        (memcmp(p_msg->p_data, &m_payloads[p_exp->offset], p_msg->len) != 0))
+    {
+        fail("message changed", m_received - 1, p_msg->len);
+    }
+}
+
+
+static void proto_setup(void)
+{
+    nus_proto_init(raw_handler, link_tx);
+    (void)nus_proto_register(TEST_TYPE, test_handler);
+    m_link_len    = 0;
+    m_link_writes = 0;
+    m_link_ok     = true;
+    m_received    = 0;
+    m_raw_bytes   = 0;
+}
+
+
+/**@brief Feeds m_link to the receiver in writes of random length up to max_write. */
+static void link_feed(uint16_t max_write)
+{
+    uint32_t pos = 0;
+
+    while (pos < m_link_len)
+    {
+        uint32_t n = 1 + rand_below(max_write);
+        n = (n < m_link_len - pos) ? n : (m_link_len - pos);
+        nus_proto_input(&m_link[pos], (uint16_t)n);
+        pos += n;
+    }
+}
+
+
+static void roundtrip_test(uint32_t iterations)
+{
+    uint32_t total = 0;
+    uint32_t zero_copy = 0;
+
+    for (uint32_t it = 0; it < iterations; it++)
+    {
+        uint32_t count = 1 + rand_below(64);
+        uint32_t used  = 0;
+
+        proto_setup();
+        m_check        = true;
+        m_link_mtu     = (uint16_t)(NUS_PROTO_MIN_MTU + rand_below(244 - NUS_PROTO_MIN_MTU + 1));
+        m_expect_count = count;
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            uint16_t len = (uint16_t)rand_below(((i & 7) == 0) ? NUS_PROTO_MAX_PAYLOAD + 1 : 64);
+
+            if (used + len > sizeof(m_payloads))
+            {
+                len = 0;
+            }
+            for (uint16_t j = 0; j < len; j++)
+            {
+                m_payloads[used + j] = (uint8_t)rand32();
+            }
+            m_expect[i].len    = len;
+            m_expect[i].offset = used;
+            if (!nus_proto_send(TEST_TYPE, 0, &m_payloads[used], len, m_link_mtu))
+            {
+                fail("send", i, len);
+            }
+            used += len;
+        }
+        if (!m_link_ok)
+        {
+            fail("write longer than the MTU", it, m_link_mtu);
+        }
+
+        link_feed((uint16_t)((it & 1) ? m_link_mtu : 1 + rand_below(16)));
+        if ((m_received != count) || (m_raw_bytes != 0))
+        {
+            fail("messages lost", m_received, count);
+        }
+        total     += count;
+        zero_copy += nus_proto_stats_get()->zero_copy;
+    }
+    printf("roundtrip: %lu messages, %lu zero-copy\n", (unsigned long)total, (unsigned long)zero_copy);
+}
+
+
+static void fuzz_test(uint32_t iterations)
+{
+    uint8_t  frame[NUS_PROTO_OVERHEAD + 64];
+    uint8_t  payload[64];
+    uint8_t  garbage[NUS_PROTO_MIN_MTU * 4];
+    uint32_t flips = 0;
+    uint32_t worst = 0;
+
+    proto_setup();
+    m_check = false;
+    for (uint32_t it = 0; it < iterations; it++)
+    {
+        uint16_t len = (uint16_t)rand_below(sizeof(payload) + 1);
+        uint16_t flen;
+
+        for (uint16_t j = 0; j < len; j++)
+        {
+            payload[j] = (uint8_t)rand32();
+        }
+        flen = nus_proto_encode(TEST_TYPE, (uint8_t)it, 0, payload, len, frame, sizeof(frame));
+
+        // Single bit errors are caught by the CRC or the framing.
+        for (uint32_t bit = 0; bit < flen * 8u; bit++)
+        {
+            frame[bit / 8] ^= (uint8_t)(1 << (bit % 8));
+            m_received = 0;
+            nus_proto_input(frame, flen);
+            nus_proto_reset();
+            if ((m_received != 0) && ((bit / 8 < 4) || (bit / 8 >= NUS_PROTO_HDR_LEN)))
+            {
+                fail("corrupted frame dispatched", it, bit);
+            }
+            frame[bit / 8] ^= (uint8_t)(1 << (bit % 8));
+            flips++;
+        }
+
+        // Random input, then valid frames until one gets through. The frame holds no other sync
+        // byte, so the receiver finds it once the frame the garbage announced is dropped.
+        for (uint32_t w = 1 + rand_below(8); w > 0; w--)
+        {
+            uint16_t glen = (uint16_t)(1 + rand_below(sizeof(garbage)));
+
+            for (uint16_t j = 0; j < glen; j++)
+            {
+                garbage[j] = (uint8_t)rand32();
+            }
+            garbage[0] = NUS_PROTO_SYNC;
+            nus_proto_input(garbage, glen);
+        }
+        while (memchr(&frame[1], NUS_PROTO_SYNC, flen - 1u) != NULL)
+        {
+            for (uint16_t j = 0; j < len; j++)
+            {
+                payload[j] = (uint8_t)rand32();
+            }
+            flen = nus_proto_encode(TEST_TYPE, (uint8_t)rand32(), 0, payload, len, frame, sizeof(frame));
+        }
+        m_received = 0;
+        for (uint32_t sent = 0; m_received == 0; sent += flen)
+        {
+            if (sent > NUS_PROTO_OVERHEAD + NUS_PROTO_MAX_PAYLOAD + 2u * flen)
+            {
+                fail("no resync", it, sent);
+                nus_proto_reset();
+                break;
+            }
+            nus_proto_input(frame, flen);
+            worst = (sent > worst) ? sent : worst;
+        }
+    }
+    printf("fuzz: %lu bit flips, resync within %lu bytes, %lu crc and %lu length errors\n",
+           (unsigned long)flips, (unsigned long)worst,
+           (unsigned long)nus_proto_stats_get()->crc_errors, (unsigned long)nus_proto_stats_get()->len_errors);
+}
+
+
+/**@brief Times encoding and decoding of TEST_BENCH_MSGS messages of one payload size. */
+static void throughput_test(uint16_t len)
+{
+    static uint8_t payload[NUS_PROTO_MAX_PAYLOAD];
+    uint16_t       flen = len + NUS_PROTO_OVERHEAD;
+    uint32_t       count = sizeof(m_link) / flen;
+    double         t0, t_enc, t_dec, t_split;
+
+    count = (count < TEST_BENCH_MSGS) ? count : TEST_BENCH_MSGS;
+    memset(payload, 0x3C, len);
+    proto_setup();
+    m_check = false;
+
+    t0 = now_s();
+    for (uint32_t i = 0; i < count; i++)
+    {
+        m_link_len += nus_proto_encode(TEST_TYPE, (uint8_t)i, 0, payload, len, &m_link[m_link_len], flen);
+    }
+    t_enc = now_s() - t0;
+
+    t0 = now_s();
+    for (uint32_t i = 0; i < count; i++)
+    {
+        nus_proto_input(&m_link[i * flen], flen);                                   // One frame per write
+    }
+    t_dec = now_s() - t0;
+
+    t0 = now_s();
+    for (uint32_t pos = 0; pos < m_link_len; pos += NUS_PROTO_MIN_MTU)
+    {
+        uint32_t n = m_link_len - pos;
+        nus_proto_input(&m_link[pos], (uint16_t)((n < NUS_PROTO_MIN_MTU) ? n : NUS_PROTO_MIN_MTU));
+    }
+    t_split = now_s() - t0;
+
+    if (m_received != 2 * count)
+    {
+        fail("throughput messages lost", m_received, 2 * count);
+    }
+    printf("{\"payload\":%u,\"msgs\":%lu,\"encode_ns\":%.1f,\"decode_ns\":%.1f,\"decode_split_ns\":%.1f,"
+           "\"decode_MBps\":%.1f}\n",
+           len, (unsigned long)count, t_enc * 1e9 / count, t_dec * 1e9 / count, t_split * 1e9 / count,
+           (double)m_link_len / t_dec / 1e6);
+}
+
+
+int main(int argc, char * argv[])
+{
+    uint32_t iterations = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : 2000;
+
+    roundtrip_test(iterations);
+    fuzz_test(iterations);
+    throughput_test(0);
+    throughput_test(16);
+    throughput_test(128);
+    throughput_test(NUS_PROTO_MAX_PAYLOAD);
+
+    printf("%s\n", (m_failures == 0) ? "PASS" : "FAIL");
+    return (m_failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,276 @@
+/** @file
+ *
+ * @brief    Host simulation of the time synchronization: a drifting watch clock synced by a phone.
+ *
+ * @details  time_sync_sim [seed]
+ *
+ *           The watch clock is modelled like the BLE board: a 1024 Hz tick count whose oscillator
+ *           runs off by the scenario's true drift, and a corrected local time derived from it with
+ *           the rate correction time_sync applies. The phone sends its time at a fixed interval,
+ *           delivered after a random link latency, through nus_proto into time_sync, and the
+ *           replies are decoded.
+ *
+ *           Each scenario checks that the estimate converges to the true drift and that the
+ *           offset found at a sync, i.e. the time error built up since the previous one, ends up
+ *           a small fraction of what the uncorrected drift would accumulate. A restart scenario
+ *           passes the learned drift to time_sync_init(), as the board does from retained RAM, and
+ *           checks that the clock is right from the first interval.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "time_sync.h"
+#include "nus_proto.h"
+
+#define SIM_TICK_HZ                     1024
+#define SIM_EPOCH_MS                    1600000000000LL                             /**< Phone time at the start. */
+#define SIM_LATENCY_MIN_MS              10
+#define SIM_LATENCY_MAX_MS              60
+
+/**@brief Scenario parameters. */
+typedef struct
+{
+    char const * p_name;
+    int32_t      drift_ppb;                                                         /**< True oscillator error, positive if slow. */
+    int32_t      drift2_ppb;                                                        /**< True error after half the syncs, e.g. a temperature change. */
+    int64_t      jump_ms;                                                           /**< Phone time change after a quarter of the syncs, 0 for none. */
+    uint32_t     interval_s;                                                        /**< Between syncs. */
+    uint32_t     syncs;
+    bool         restart;                                                           /**< Start from the drift learned by the previous scenario. */
+    int32_t      tolerance_ppb;                                                     /**< Allowed final estimate error. */
+} sim_scenario_t;
+
+/**@brief Watch clock. Times in ms, the phone's true time is the simulation time. */
+static double   m_true_ms;                                                          /**< Since the start. */
+static double   m_osc_ppb;                                                          /**< True oscillator error. */
+static double   m_tick_origin;                                                      /**< Fractional ticks before the scenario. */
+static int64_t  m_base_ms;                                                          /**< Corrected local time at m_base_tick. */
+static uint32_t m_base_tick;
+static int32_t  m_drift_ppb;                                                        /**< Correction in use. */
+static bool     m_woken;
+
+/**@brief Last reply. */
+static bool     m_reply;
+static uint8_t  m_reply_status;
+static int32_t  m_reply_offset;
+static int32_t  m_reply_drift;
+
+static int32_t  m_learned_ppb;
+static uint32_t m_rand;
+
+
+static uint32_t rand32(void)
+{
+    m_rand ^= m_rand << 13;
+    m_rand ^= m_rand >> 17;
+    m_rand ^= m_rand << 5;
+    return m_rand;
+}
+
+
+static uint32_t le32_get(uint8_t const * p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+
+/**@brief Advances the true time, the ticks follow at the oscillator rate. */
+static void time_advance(double ms)
+{
+    m_tick_origin += ms * SIM_TICK_HZ / 1000.0 * (1.0 - m_osc_ppb * 1e-9);
+    m_true_ms     += ms;
+}
+
+
+/**@brief Clock binding, see time_sync_clock_t and its implementation in main.c. */
+static uint32_t clock_stamp(void)
+{
+    return (uint32_t)(uint64_t)m_tick_origin;
+}
+
+
+static int64_t clock_stamp_to_ms(uint32_t stamp)
+{
+    double ticks = (double)(int32_t)(stamp - m_base_tick);
+
+    return m_base_ms + (int64_t)(ticks * (1.0 + m_drift_ppb * 1e-9) * 1000.0 / SIM_TICK_HZ);
+}
+
+
+static void clock_step(int64_t offset_ms)
+{
+    uint32_t now = clock_stamp();
+
+    m_base_ms   = clock_stamp_to_ms(now) + offset_ms;
+    m_base_tick = now;
+}
+
+
+static void clock_trim(int32_t drift_ppb)
+{
+    clock_step(0);
+    m_drift_ppb = drift_ppb;
+}
+
+
+static void clock_wake(void)
+{
+    m_woken = true;
+}
+
+
+static time_sync_clock_t const m_clock =
+{
+    .stamp       = clock_stamp,
+    .stamp_to_ms = clock_stamp_to_ms,
+    .step        = clock_step,
+    .trim        = clock_trim,
+    .wake        = clock_wake,
+};
+
+
+/**@brief Watch side transmit hook, decodes the TIME_SYNC reply. */
+static bool watch_tx(uint8_t const * p_data, uint16_t len)
+{
+    uint8_t const * p = &p_data[NUS_PROTO_HDR_LEN];
+
+    if ((len == NUS_PROTO_OVERHEAD + 9) && (p_data[1] == NUS_PROTO_TYPE_TIME_SYNC))
+    {
+        m_reply        = true;
+        m_reply_status = p[0];
+        m_reply_offset = (int32_t)le32_get(&p[1]);
+        m_reply_drift  = (int32_t)le32_get(&p[5]);
+    }
+    return true;
+}
+
+
+/**@brief Phone: sends its time, which reaches the watch after the link latency. */
+static void phone_sync(int64_t phone_ms)
+{
+    uint8_t  payload[6];
+    uint8_t  frame[NUS_PROTO_OVERHEAD + sizeof(payload)];
+    uint64_t s  = (uint64_t)(phone_ms / 1000);
+    uint16_t ms = (uint16_t)(phone_ms % 1000);
+
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        payload[i] = (uint8_t)(s >> (8 * i));
+    }
+    payload[4] = (uint8_t)ms;
+    payload[5] = (uint8_t)(ms >> 8);
+
+    time_advance(SIM_LATENCY_MIN_MS + rand32() % (SIM_LATENCY_MAX_MS - SIM_LATENCY_MIN_MS + 1));
+    m_reply = false;
+    nus_proto_input(frame, nus_proto_encode(NUS_PROTO_TYPE_TIME_SYNC, 1, 0, payload, sizeof(payload),
+                                            frame, sizeof(frame)));
+    if (m_woken)
+    {
+        m_woken = false;
+        time_sync_process();
+    }
+}
+
+
+static bool scenario_run(sim_scenario_t const * p_sc)
+{
+    double   free_error = 0;                                                        /**< Uncorrected error per interval, ms. */
+    double   tail_error = 0;                                                        /**< Mean |offset| over the last quarter. */
+    double   limit;
+    uint32_t tail = 0;
+    uint32_t first_trim = 0;
+    uint32_t rejected = 0;
+    int64_t  jump = 0;
+    int32_t  err;
+    bool     ok;
+
+    m_true_ms     = 0;
+    m_tick_origin = rand32() % 0x10000000UL;
+    m_osc_ppb     = p_sc->drift_ppb;
+    m_base_tick   = clock_stamp();
+    m_base_ms     = SIM_EPOCH_MS;
+    m_drift_ppb   = 0;
+
+    nus_proto_init(NULL, watch_tx);
+    time_sync_init(&m_clock, p_sc->restart ? m_learned_ppb : 0);
+
+    for (uint32_t i = 0; i < p_sc->syncs; i++)
+    {
+        if (i == p_sc->syncs / 2)
+        {
+            m_osc_ppb = p_sc->drift2_ppb;
+        }
+        if ((i == p_sc->syncs / 4) && (p_sc->jump_ms != 0))
+        {
+            jump = p_sc->jump_ms;
+        }
+
+        phone_sync(SIM_EPOCH_MS + (int64_t)m_true_ms + jump);
+        if (!m_reply)
+        {
+            printf("%s: no reply to sync %lu\n", p_sc->p_name, (unsigned long)i);
+            return false;
+        }
+        if ((m_reply_status == TIME_SYNC_STATUS_TRIMMED) && (first_trim == 0))
+        {
+            first_trim = (uint32_t)abs(m_reply_offset);
+        }
+        rejected += (m_reply_status == TIME_SYNC_STATUS_REJECTED) ? 1 : 0;
+        if (i >= p_sc->syncs - p_sc->syncs / 4)
+        {
+            tail_error += abs(m_reply_offset);
+            tail++;
+        }
+        time_advance(p_sc->interval_s * 1000.0);
+    }
+
+    // Latency jitter stays in every offset, the drift part must be mostly corrected.
+    tail_error /= tail;
+    free_error  = m_osc_ppb * 1e-9 * p_sc->interval_s * 1000.0;
+    limit       = 0.25 * ((free_error < 0) ? -free_error : free_error) + SIM_LATENCY_MAX_MS;
+    err         = m_reply_drift - (int32_t)m_osc_ppb;
+    ok          = (abs(err) <= p_sc->tolerance_ppb) && (tail_error < limit) &&
+                  (rejected == ((p_sc->jump_ms != 0) ? 1u : 0u));
+    if (p_sc->restart)
+    {
+        ok = ok && (first_trim < limit);
+    }
+    m_learned_ppb = m_reply_drift;
+
+    printf("{\"scenario\":\"%s\",\"ok\":%s,\"true_ppb\":%d,\"est_ppb\":%d,\"err_ppb\":%d,\"free_ms\":%.1f,"
+           "\"tail_offset_ms\":%.1f,\"first_trim_ms\":%u,\"rejected\":%u}\n",
+           p_sc->p_name, ok ? "true" : "false", (int)m_osc_ppb, (int)m_reply_drift, (int)err, free_error,
+           tail_error, first_trim, rejected);
+    return ok;
+}
+
+
+int main(int argc, char * argv[])
+{
+    static sim_scenario_t const scenarios[] =
+    {
+        //  name          drift    drift2   jump       interval  syncs  restart  tolerance
+        { "slow_40ppm",   40000,   40000,   0,         3600,     96,    false,   3000 },
+        { "restart",      40000,   40000,   0,         3600,     24,    true,    3000 },
+        { "fast_25ppm",  -25000,  -25000,   0,         7200,     48,    false,   3000 },
+        { "temperature",  30000,   10000,   0,         3600,     96,    false,   3000 },
+        { "time_change",  20000,   20000,   3600000,   3600,     96,    false,   3000 },
+    };
+    uint32_t failures = 0;
+
+    m_rand = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : 0x7F4A7C15UL;
+    if (m_rand == 0)
+    {
+        m_rand = 1;
+    }
+    for (uint32_t i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++)
+    {
+        failures += scenario_run(&scenarios[i]) ? 0 : 1;
+    }
+
+    printf("%s\n", (failures == 0) ? "PASS" : "FAIL");
+    return (failures == 0) ? 0 : 1;
+}
@@ -107,6 +107,33 @@
 
 #include "time.h"
 
+#include "nus_proto.h"
+#include "asset_xfer.h"
+#include "calendar.h"
+#include "time_sync.h"
+#include "perf_metrics.h"
+#include "mip_pack.h"
+
+#define DISPLAY_MDC                     0                                           /**< Set to 1 when the panel is driven by an S1D13C00 instead of the nRF SPIM. */
+#define ASSET_XFER_SERIAL_FLASH         DISPLAY_MDC                                 /**< Assets go to the serial flash behind the S1D13C00, otherwise to internal flash. */
+
+#if DISPLAY_MDC
+#include "mdc_disp.h"
+#include "se_rtc.h"
+#endif
+
+#if !ASSET_XFER_SERIAL_FLASH
+#include "nrf_fstorage.h"
+#include "nrf_fstorage_sd.h"
+#endif
+
+#if ASSET_XFER_SERIAL_FLASH
+#include "s1d13c00_hcl.h"
+#include "se_common.h"
+#include "serial_flash.h"
+#include "sf_bridge.h"
+#endif
+
 #define APP_BLE_CONN_CFG_TAG            1                                           /**< A tag identifying the SoftDevice BLE configuration. */
 
 #define DEVICE_NAME                     "NUS FreeRTOS"                              /**< Name of device. Will be included in the advertising data. */
@@ -143,11 +170,17 @@
 #define SHARP_MIP_CLEAR_SCREEN_FLAG     (1 << 5)                                    /* (M2) All clear flag : H -> clear all pixels               */
 #define SHARP_MIP_HOR_RES               LV_HOR_RES
 #define SHARP_MIP_VER_RES               LV_VER_RES
-#define SHARP_MIP_SOFT_COM_INVERSION    1
+#define SHARP_MIP_SOFT_COM_INVERSION    (!DISPLAY_MDC)                              /* The S1D13C00 generates VCOM itself */
+#define SHARP_MIP_ROW_PACK              (LV_COLOR_DEPTH == 1)                       /* Native 1-bit pixels packed by the flush, else set_px_cb writes the frame */
+#if SHARP_MIP_ROW_PACK
+#define SHARP_MIP_BUF_LINES             (LV_VER_RES_MAX / 8)                        /* Full width lines per VDB */
+#else
+#define SHARP_MIP_BUF_LINES             LV_VER_RES_MAX                              /* The VDB is the SPI frame */
 static const uint8_t table[] = {0x00, 0x80, 0x40, 0xc0, 0x20, 0xa0, 0x60, 0xe0, 0x10, 0x90, 0x50, 0xd0, 0x30, 0xb0, 0x70, 0xf0, 0x08, 0x88, 0x48, 0xc8, 0x28, 0xa8, 0x68, 0xe8, 0x18, 0x98, 0x58, 0xd8, 0x38, 0xb8, 0x78, 0xf8, 0x04, 0x84, 0x44, 0xc4, 0x24, 0xa4, 0x64, 0xe4, 0x14, 0x94, 0x54, 0xd4, 0x34, 0xb4, 0x74, 0xf4, 0x0c, 0x8c, 0x4c, 0xcc, 0x2c, 0xac, 0x6c, 0xec, 0x1c, 0x9c, 0x5c, 0xdc, 0x3c, 0xbc, 0x7c, 0xfc, 0x02, 0x82, 0x42, 0xc2, 0x22, 0xa2, 0x62, 0xe2, 0x12, 0x92, 0x52, 0xd2, 0x32, 0xb2, 0x72, 0xf2, 0x0a, 0x8a, 0x4a, 0xca, 0x2a, 0xaa, 0x6a, 0xea, 0x1a, 0x9a, 0x5a, 0xda, 0x3a, 0xba, 0x7a, 0xfa, 0x06, 0x86, 0x46, 0xc6, 0x26, 0xa6, 0x66, 0xe6, 0x16, 0x96, 0x56, 0xd6, 0x36, 0xb6, 0x76, 0xf6, 0x0e, 0x8e, 0x4e, 0xce, 0x2e, 0xae, 0x6e, 0xee, 0x1e, 0x9e, 0x5e, 0xde, 0x3e, 0xbe, 0x7e, 0xfe, 0x01, 0x81, 0x41, 0xc1, 0x21, 0xa1, 0x61, 0xe1, 0x11, 0x91, 0x51, 0xd1, 0x31, 0xb1, 0x71, 0xf1, 0x09, 0x89, 0x49, 0xc9, 0x29, 0xa9, 0x69, 0xe9, 0x19, 0x99, 0x59, 0xd9, 0x39, 0xb9, 0x79, 0xf9, 0x05, 0x85, 0x45, 0xc5, 0x25, 0xa5, 0x65, 0xe5, 0x15, 0x95, 0x55, 0xd5, 0x35, 0xb5, 0x75, 0xf5, 0x0d, 0x8d, 0x4d, 0xcd, 0x2d, 0xad, 0x6d, 0xed, 0x1d, 0x9d, 0x5d, 0xdd, 0x3d, 0xbd, 0x7d, 0xfd, 0x03, 0x83, 0x43, 0xc3, 0x23, 0xa3, 0x63, 0xe3, 0x13, 0x93, 0x53, 0xd3, 0x33, 0xb3, 0x73, 0xf3, 0x0b, 0x8b, 0x4b, 0xcb, 0x2b, 0xab, 0x6b, 0xeb, 0x1b, 0x9b, 0x5b, 0xdb, 0x3b, 0xbb, 0x7b, 0xfb, 0x07, 0x87, 0x47, 0xc7, 0x27, 0xa7, 0x67, 0xe7, 0x17, 0x97, 0x57, 0xd7, 0x37, 0xb7, 0x77, 0xf7, 0x0f, 0x8f, 0x4f, 0xcf, 0x2f, 0xaf, 0x6f, 0xef, 0x1f, 0x9f, 0x5f, 0xdf, 0x3f, 0xbf, 0x7f, 0xff};
 #define SHARP_MIP_REV_BYTE(b)           table[b]                                    /*((uint8_t) __REV(__RBIT(b)))*/  /*Architecture / compiler dependent byte bits order reverse*/
-#define BUFIDX(x, y)                    (((x) >> 3) + ((y) * (2 + (SHARP_MIP_HOR_RES >> 3))) + 2)
 #define PIXIDX(x)                       SHARP_MIP_REV_BYTE(1 << ((x) & 7))
+#endif
+#define BUFIDX(x, y)                    (((x) >> 3) + ((y) * MIP_PACK_LINE_BYTES(SHARP_MIP_HOR_RES)) + 2)
 #if SHARP_MIP_SOFT_COM_INVERSION
 static bool com_output_state = false;
 #endif
@@ -185,6 +218,7 @@ static TaskHandle_t m_logger_thread;
 
 static TaskHandle_t m_led_thread;                                                   /**< Definition of LED thread. */
 static TaskHandle_t m_lvgl_thread;                                                  /**< Definition of LED thread. */
+static TaskHandle_t m_asset_thread;                                                 /**< Definition of asset transfer thread. */
 
 const nrfx_spim_t spi = NRFX_SPIM_INSTANCE(SPI_INSTANCE);                           /**< SPI instance. */
 nrfx_spim_xfer_desc_t mip_data_struct;
@@ -195,19 +229,50 @@ static const uint16_t bit_reverse_table[303] = {256, 128, 384, 64, 320, 192, 448
 TimerHandle_t lvgl_toggle_timer_handle;                                             /**< Reference to LED1 toggling FreeRTOS timer. */
 TimerHandle_t calendar_timer_handle;                                                // 1s timer for undating the clock and date
 
-static struct tm time_struct = {0};
-static time_t calendar_time = 1595256600, calendar_time_old = 1595256600;
+#define CALENDAR_FALLBACK_TIME          1595256600                                  /**< Start time after a cold start without RTC. */
+
+static calendar_fmt_t m_time_fmt;                                                   /**< Clock text, only the changed characters are rewritten. */
+static volatile bool  m_time_changed = true;                                        /**< Set by the calendar event, cleared by the LVGL thread. */
+static TickType_t     m_calendar_last_tick;                                         /**< Tick count at the previous calendar timer callback. */
+static int64_t        m_calendar_acc;                                               /**< Corrected tick units not yet accounted as whole seconds. */
+static int32_t        m_calendar_drift_ppb;                                         /**< Rate correction learned by time_sync. */
+
+#define CALENDAR_UNITS_PER_SEC          ((int64_t)configTICK_RATE_HZ * 1000000000LL) /**< Corrected tick units per second. */
+#define RTC_TRIM_PERIOD                 900                                         /**< Seconds between trims of the S1D13C00 RTC. */
+#define DRIFT_RETAIN_MAGIC              0x44524654UL                                /**< "DRFT" */
+
+/**@brief Drift learned by time_sync, kept across soft resets, valid if magic and check match. */
+typedef struct
+{
+    uint32_t magic;
+    int32_t  drift_ppb;
+    uint32_t check;                                                                 /**< ~drift_ppb */
+} drift_retained_t;
+
+static drift_retained_t m_drift_retained __attribute__((section(".non_init")));
+
+#if DISPLAY_MDC
+static int16_t        m_rtc_freqerr_mhz;                                            /**< OSC1 error the S1D13C00 RTC is trimmed by. */
+static uint32_t       m_rtc_trim_secs;                                              /**< Seconds to the next RTC trim, 0 while the regulation is not running. */
+#endif
 
-static char* time_string;
 static lv_obj_t * ta1;
 static lv_obj_t * ta2;
 
 static lv_disp_drv_t disp_drv;                     /*A variable to hold the drivers. Can be local variable*/
 //static lv_disp_drv_t * disp_p;
 
-static uint8_t const * received_data = NULL;
-static uint16_t received_data_len = 0;
+#define NUS_TX_RETRY_MS                 75                                          /**< Longest wait for a notification to go out, the maximum connection interval. */
+#define RECEIVED_TEXT_MAX_LEN           128                                         /**< Longest text kept for the notification area. */
+
+static char received_data[RECEIVED_TEXT_MAX_LEN + 1];                               /**< Copy of the last text, NUS buffers are only valid inside the handler. */
 bool received_new_data = false;
+static SemaphoreHandle_t m_nus_tx_ready;                                            /**< Given when a notification went out or the link dropped. */
+static SemaphoreHandle_t m_received_mutex;                                          /**< Guards received_data, written by the SoftDevice task, read by the LVGL thread. */
+
+#if SHARP_MIP_ROW_PACK
+static uint8_t m_mip_frame[MIP_PACK_FRAME_SIZE(LV_HOR_RES_MAX, SHARP_MIP_BUF_LINES)]; /* SPI frame of one VDB */
+#endif
 
 void sharp_mip_init(void) {
   /* These displays have nothing to initialize */
@@ -224,34 +289,44 @@ void sharp_mip_flush(lv_disp_drv_t * disp_drv, const lv_area_t * area, lv_color_
   uint16_t act_y1 = area->y1 < 0 ? 0 : area->y1;
   uint16_t act_y2 = area->y2 > SHARP_MIP_VER_RES - 1 ? SHARP_MIP_VER_RES - 1 : area->y2;
 
-  uint8_t * buf      = (uint8_t *) color_p;                     /*Get the buffer address*/
+#if SHARP_MIP_ROW_PACK
+  uint8_t const * px = (uint8_t const *) color_p;              /*One byte per pixel, whole lines (rounder)*/
+  uint8_t * buf      = m_mip_frame;                             /*Free again, the transfer below blocks*/
+#else
+  uint8_t * buf      = (uint8_t *) color_p;                     /*Get the buffer address, pixels set by sharp_mip_set_px*/
+#endif
   uint16_t  buf_h    = (act_y2 - act_y1 + 1);                   /*Number of buffer lines*/
-  uint16_t  buf_size = buf_h * (2 + SHARP_MIP_HOR_RES / 8) + 2; /*Buffer size in bytes  */
-  
-  //buf[0] = 0;
-  
-  /* Set lines to flush dummy byte & gate address in VDB*/
+  uint16_t  buf_size = MIP_PACK_FRAME_SIZE(SHARP_MIP_HOR_RES, buf_h); /*Buffer size in bytes*/
+
+  /* Set gate address & pack the pixels of each line*/
   for(uint16_t act_y = 0 ; act_y < buf_h ; act_y++) {
     buf[BUFIDX(0, act_y) - 1] = bit_reverse_table[act_y1 + act_y + 0] & 0xFF;
     buf[BUFIDX(0, act_y) - 2] = (bit_reverse_table[act_y1 + act_y + 0] >> 8);
+#if SHARP_MIP_ROW_PACK
+    mip_pack_row(&buf[BUFIDX(0, act_y)], px, SHARP_MIP_HOR_RES);
+    px += SHARP_MIP_HOR_RES;
+#endif
   }
 
-  /* Set last dummy two bytes in VDB */
+  /* Set last dummy two bytes in frame */
   buf[BUFIDX(0, buf_h) - 1] = 0;
   buf[BUFIDX(0, buf_h) - 2] = 0;
 
-  /* Set frame header in VDB */
+  /* Set frame header */
   buf[0] |= SHARP_MIP_HEADER | SHARP_MIP_UPDATE_RAM_FLAG;
 
   /* Write the frame on display memory */
   mip_data_struct.p_tx_buffer = buf;
   mip_data_struct.tx_length = buf_size;
   nrfx_spim_xfer(&spi, &mip_data_struct, 0);
+  perf_metrics_bus_bytes(buf_size);
+  perf_metrics_lines(buf_h);
 
   lv_disp_flush_ready(disp_drv);
   //disp_p = disp_drv;
 }
 
+#if !SHARP_MIP_ROW_PACK
 void sharp_mip_set_px(lv_disp_drv_t * disp_drv, uint8_t * buf, lv_coord_t buf_w, lv_coord_t x, lv_coord_t y, lv_color_t color, lv_opa_t opa) {
   (void) disp_drv;
   (void) buf_w;
@@ -263,6 +338,7 @@ void sharp_mip_set_px(lv_disp_drv_t * disp_drv, uint8_t * buf, lv_coord_t buf_w,
     buf[BUFIDX(x, y)] &= ~PIXIDX(x);  /*Set VDB pixel bit to 0 for BLACK color*/
   }
 }
+#endif
 
 void sharp_mip_rounder(lv_disp_drv_t * disp_drv, lv_area_t * area) {
   (void) disp_drv;
@@ -288,6 +364,7 @@ void sharp_mip_com_inversion(void) {
   mip_data_struct.p_tx_buffer = inversion_header;
   mip_data_struct.tx_length = 2;
   nrfx_spim_xfer(&spi, &mip_data_struct, 0);
+  perf_metrics_bus_bytes(2);
 }
 #endif
 
@@ -414,10 +491,94 @@ static void nrf_qwr_error_handler(uint32_t nrf_error)
 }
 
 
+/**@brief Function for showing received text in the notification area.
+ *
+ * @param[in] p_data  Text, not necessarily zero terminated.
+ * @param[in] len     Text length.
+ */
+static void received_text_set(uint8_t const * p_data, uint16_t len)
+{
+    if (len > RECEIVED_TEXT_MAX_LEN)
+    {
+        len = RECEIVED_TEXT_MAX_LEN;
+    }
+    UNUSED_RETURN_VALUE(xSemaphoreTake(m_received_mutex, portMAX_DELAY));
+    memcpy(received_data, p_data, len);
+    received_data[len] = '\0';
+    received_new_data = true;
+    UNUSED_RETURN_VALUE(xSemaphoreGive(m_received_mutex));
+}
+
+
+/**@brief Function for handling unframed NUS data.
+ *
+ * @details Plain text from a terminal: shown in the notification area and sent to the UART module.
+ *
+ * @param[in] p_data  Received data.
+ * @param[in] len     Received data length.
+ */
+static void nus_raw_handler(uint8_t const * p_data, uint16_t len)
+{
+    uint32_t err_code;
+
+    received_text_set(p_data, len);
+
+    NRF_LOG_DEBUG("Received data from BLE NUS. Writing data on UART.");
+    NRF_LOG_HEXDUMP_DEBUG(p_data, len);
+
+    for (uint32_t i = 0; i < len; i++)
+    {
+        do
+        {
+            err_code = app_uart_put(p_data[i]);
+            if ((err_code != NRF_SUCCESS) && (err_code != NRF_ERROR_BUSY))
+            {
+                NRF_LOG_ERROR("Failed receiving NUS message. Error 0x%x. ", err_code);
+                APP_ERROR_CHECK(err_code);
+            }
+        } while (err_code == NRF_ERROR_BUSY);
+    }
+    if (p_data[len - 1] == '\r')
+    {
+        while (app_uart_put('\n') == NRF_ERROR_BUSY);
+    }
+}
+
+
+/**@brief Function for handling NUS_PROTO_TYPE_TEXT messages. */
+static void nus_text_handler(nus_proto_msg_t const * p_msg)
+{
+    received_text_set(p_msg->p_data, p_msg->len);
+}
+
+
+/**@brief Transmit hook for the framed protocol, one NUS notification per call.
+ *
+ * @details While the SoftDevice queue is full the caller sleeps until a notification went out.
+ *          The SoftDevice task dispatches that event itself, so when it is the sender it sleeps
+ *          for the timeout and tries again.
+ */
+static bool nus_proto_tx(uint8_t const * p_data, uint16_t len)
+{
+    uint32_t err_code;
+
+    for (;;)
+    {
+        uint16_t length = len;
+        err_code = ble_nus_data_send(&m_nus, (uint8_t *)p_data, &length, m_conn_handle);
+        if (err_code != NRF_ERROR_RESOURCES)
+        {
+            return (err_code == NRF_SUCCESS);
+        }
+        UNUSED_RETURN_VALUE(xSemaphoreTake(m_nus_tx_ready, pdMS_TO_TICKS(NUS_TX_RETRY_MS)));
+    }
+}
+
+
 /**@brief Function for handling the data from the Nordic UART Service.
  *
- * @details This function will process the data received from the Nordic UART BLE Service and send
- *          it to the UART module.
+ * @details Every write is fed to the framed protocol, which dispatches complete messages to
+ *          their handlers and passes unframed text to nus_raw_handler().
  *
  * @param[in] p_evt       Nordic UART Service event.
  */
@@ -425,37 +586,294 @@ static void nrf_qwr_error_handler(uint32_t nrf_error)
 static void nus_data_handler(ble_nus_evt_t * p_evt)
 {
 
-    if (p_evt->type == BLE_NUS_EVT_RX_DATA)
+    if ((p_evt->type == BLE_NUS_EVT_RX_DATA) && (p_evt->params.rx_data.length > 0))
     {
-        uint32_t err_code;
+        nus_proto_input(p_evt->params.rx_data.p_data, p_evt->params.rx_data.length);
+    }
+    else if (p_evt->type == BLE_NUS_EVT_TX_RDY)
+    {
+        UNUSED_RETURN_VALUE(xSemaphoreGive(m_nus_tx_ready));
+    }
 
-        received_new_data = true;
-        received_data = (p_evt->params.rx_data.p_data);
-        received_data_len = (p_evt->params.rx_data.length);
+}
+/**@snippet [Handling the data received over BLE] */
 
-        NRF_LOG_DEBUG("Received data from BLE NUS. Writing data on UART.");
-        NRF_LOG_HEXDUMP_DEBUG(p_evt->params.rx_data.p_data, p_evt->params.rx_data.length);
 
-        for (uint32_t i = 0; i < p_evt->params.rx_data.length; i++)
-        {
-            do
-            {
-                err_code = app_uart_put(p_evt->params.rx_data.p_data[i]);
-                if ((err_code != NRF_SUCCESS) && (err_code != NRF_ERROR_BUSY))
-                {
-                    NRF_LOG_ERROR("Failed receiving NUS message. Error 0x%x. ", err_code);
-                    APP_ERROR_CHECK(err_code);
-                }
-            } while (err_code == NRF_ERROR_BUSY);
-        }
-        if (p_evt->params.rx_data.p_data[p_evt->params.rx_data.length - 1] == '\r')
-        {
-            while (app_uart_put('\n') == NRF_ERROR_BUSY);
-        }
+#if ASSET_XFER_SERIAL_FLASH
+/**@brief Serial flash access for the asset transfer service. */
+static bool asset_flash_erase(uint32_t addr)
+{
+    bool ok;
+
+    mdc_disp_lock();
+    ok = (EraseFlashSector(addr) == seSTATUS_OK) && (WaitFlashBusy() == seSTATUS_OK);
+    mdc_disp_unlock();
+
+    return ok;
+}
+
+
+static bool asset_flash_program(uint32_t addr, uint8_t const * p_data, uint32_t len)
+{
+    bool ok;
+
+    mdc_disp_lock();
+    ok = (ProgramFlash(addr, (uint8_t *)p_data, len) == seSTATUS_OK);
+    mdc_disp_unlock();
+
+    return ok;
+}
+
+
+static bool asset_flash_read(uint32_t addr, uint8_t * p_data, uint32_t len)
+{
+    bool ok;
+
+    mdc_disp_lock();
+    ok = (ReadFlash(addr, p_data, len) == seSTATUS_OK);
+    mdc_disp_unlock();
+
+    return ok;
+}
+
+
+static asset_xfer_flash_t const m_asset_flash =
+{
+    .erase_sector = asset_flash_erase,
+    .program      = asset_flash_program,
+    .read         = asset_flash_read,
+    .sector_size  = 4096,
+    .page_size    = 256,
+};
+#else
+#define ASSET_FLASH_START               0xC0000                                     /**< Internal flash region for assets, below the FDS pages. */
+#define ASSET_FLASH_SIZE                0x3C000
+#define ASSET_FLASH_PAGE                4096
+
+static void asset_fstorage_evt_handler(nrf_fstorage_evt_t * p_evt);
+
+NRF_FSTORAGE_DEF(nrf_fstorage_t m_asset_fstorage) =
+{
+    .evt_handler = asset_fstorage_evt_handler,
+    .start_addr  = ASSET_FLASH_START,
+    .end_addr    = ASSET_FLASH_START + ASSET_FLASH_SIZE - 1,
+};
+
+static SemaphoreHandle_t m_asset_flash_done;                                        /**< Given by the fstorage event, taken by the asset thread. */
+static volatile bool     m_asset_flash_ok;
+static uint32_t          m_asset_flash_buf[(ASSET_XFER_CHUNK_MAX + 6) / 4 + 1];     /**< Chunk padded to whole words. */
+
+
+/**@brief Internal flash access for the asset transfer service.
+ *
+ * @details fstorage runs the operation between radio events and reports it from the SoftDevice
+ *          task, the asset thread blocks until then. Addresses are offsets into the region.
+ */
+static void asset_fstorage_evt_handler(nrf_fstorage_evt_t * p_evt)
+{
+    m_asset_flash_ok = (p_evt->result == NRF_SUCCESS);
+    UNUSED_RETURN_VALUE(xSemaphoreGive(m_asset_flash_done));
+}
+
+
+static bool asset_flash_wait(ret_code_t err_code)
+{
+    if (err_code != NRF_SUCCESS)
+    {
+        return false;
     }
+    UNUSED_RETURN_VALUE(xSemaphoreTake(m_asset_flash_done, portMAX_DELAY));
+    return m_asset_flash_ok;
+}
 
+
+static bool asset_flash_in_range(uint32_t addr, uint32_t len)
+{
+    return (addr < ASSET_FLASH_SIZE) && (len <= ASSET_FLASH_SIZE - addr);
 }
-/**@snippet [Handling the data received over BLE] */
+
+
+static bool asset_flash_erase(uint32_t addr)
+{
+    return asset_flash_in_range(addr, ASSET_FLASH_PAGE) &&
+           asset_flash_wait(nrf_fstorage_erase(&m_asset_fstorage, ASSET_FLASH_START + addr, 1, NULL));
+}
+
+
+/**@brief Programs whole words, padding with 0xFF, which leaves bits already programmed as they are. */
+static bool asset_flash_program(uint32_t addr, uint8_t const * p_data, uint32_t len)
+{
+    uint32_t start = addr & ~3UL;
+    uint32_t size  = ((addr + len + 3) & ~3UL) - start;
+
+    if (!asset_flash_in_range(addr, len) || (size > sizeof(m_asset_flash_buf)))
+    {
+        return false;
+    }
+    memset(m_asset_flash_buf, 0xFF, size);
+    memcpy((uint8_t *)m_asset_flash_buf + (addr - start), p_data, len);
+    return asset_flash_wait(nrf_fstorage_write(&m_asset_fstorage, ASSET_FLASH_START + start,
+                                               m_asset_flash_buf, size, NULL));
+}
+
+
+static bool asset_flash_read(uint32_t addr, uint8_t * p_data, uint32_t len)
+{
+    return asset_flash_in_range(addr, len) &&
+           (nrf_fstorage_read(&m_asset_fstorage, ASSET_FLASH_START + addr, p_data, len) == NRF_SUCCESS);
+}
+
+
+static asset_xfer_flash_t const m_asset_flash =
+{
+    .erase_sector = asset_flash_erase,
+    .program      = asset_flash_program,
+    .read         = asset_flash_read,
+    .sector_size  = ASSET_FLASH_PAGE,
+    .page_size    = ASSET_FLASH_PAGE,
+};
+#endif
+
+
+/**@brief Wakes the asset thread, called from the SoftDevice task. */
+static void asset_thread_wake(void)
+{
+    xTaskNotifyGive(m_asset_thread);
+}
+
+
+/**@brief Thread programming received asset chunks into flash.
+ *
+ * @details Runs at the same priority as the UI, so the SoftDevice task keeps receiving while a
+ *          page is being programmed.
+ */
+static void asset_thread(void * arg)
+{
+    UNUSED_PARAMETER(arg);
+
+    while (1)
+    {
+        UNUSED_RETURN_VALUE(ulTaskNotifyTake(pdTRUE, portMAX_DELAY));
+        asset_xfer_process();
+    }
+}
+
+
+/**@brief Converts ticks to corrected tick units, 1e9 units per tick plus the drift correction. */
+static int64_t calendar_units(int32_t ticks)
+{
+    return (int64_t)ticks * (1000000000LL + m_calendar_drift_ppb);
+}
+
+
+/**@brief Time sync clock binding. Everything but the stamp runs in the timer task, like the
+ *        calendar 1 Hz source, so the calendar state needs no locking.
+ */
+static uint32_t time_sync_stamp(void)
+{
+    return xTaskGetTickCount();
+}
+
+
+static int64_t time_sync_stamp_to_ms(uint32_t stamp)
+{
+    int64_t acc = m_calendar_acc + calendar_units((int32_t)(stamp - m_calendar_last_tick));
+
+    return (int64_t)calendar_get() * 1000 + acc * 1000 / CALENDAR_UNITS_PER_SEC;
+}
+
+
+static void time_sync_step(int64_t offset_ms)
+{
+    TickType_t now = xTaskGetTickCount();
+    int64_t    ms  = time_sync_stamp_to_ms(now) + offset_ms;
+
+    m_calendar_last_tick = now;
+    m_calendar_acc       = (ms % 1000) * (CALENDAR_UNITS_PER_SEC / 1000);
+    calendar_set((time_t)(ms / 1000));
+    calendar_tick(0);                                                               // Apply and publish now.
+}
+
+
+#if DISPLAY_MDC
+/**@brief Function for trimming the S1D13C00 RTC, which keeps the time while the host is reset.
+ *
+ * @details Runs in the timer task, on each drift estimate and then every RTC_TRIM_PERIOD seconds
+ *          from the calendar timer. Each trim makes up for m_rtc_freqerr_mhz over the period that
+ *          starts with it.
+ */
+static void rtc_trim(void)
+{
+    mdc_disp_lock();
+    if (m_rtc_trim_secs == 0)
+    {
+        UNUSED_RETURN_VALUE(seRTC_InitTheoreticalRegulation(RTC_TRIM_PERIOD, m_rtc_freqerr_mhz));
+    }
+    UNUSED_RETURN_VALUE(seRTC_TheoreticalRegulationTrim(m_rtc_freqerr_mhz));
+    mdc_disp_unlock();
+    m_rtc_trim_secs = RTC_TRIM_PERIOD;
+}
+#endif
+
+
+static void time_sync_trim(int32_t drift_ppb)
+{
+    TickType_t now = xTaskGetTickCount();
+
+    // Ticks so far count at the old rate.
+    m_calendar_acc      += calendar_units((int32_t)(now - m_calendar_last_tick));
+    m_calendar_last_tick = now;
+    m_calendar_drift_ppb = drift_ppb;
+    NRF_LOG_INFO("Clock drift %d ppb.", drift_ppb);
+
+    m_drift_retained.drift_ppb = drift_ppb;
+    m_drift_retained.check     = ~(uint32_t)drift_ppb;
+    m_drift_retained.magic     = DRIFT_RETAIN_MAGIC;
+
+#if DISPLAY_MDC
+    // The drift is learned against the LFCLK, OSC1 has no reference of its own: the RTC is
+    // trimmed by the same estimate.
+    m_rtc_freqerr_mhz = TIME_SYNC_PPB_TO_OSC1_MHZ(drift_ppb);
+    rtc_trim();
+#endif
+}
+
+
+/**@brief Function for reading the drift retained from before the last soft reset, 0 if none. */
+static int32_t drift_retained_get(void)
+{
+    if ((m_drift_retained.magic == DRIFT_RETAIN_MAGIC) &&
+        (m_drift_retained.check == ~(uint32_t)m_drift_retained.drift_ppb))
+    {
+        return m_drift_retained.drift_ppb;
+    }
+    return 0;
+}
+
+
+static void time_sync_pended(void * p_param, uint32_t param)
+{
+    UNUSED_PARAMETER(p_param);
+    UNUSED_PARAMETER(param);
+
+    time_sync_process();
+}
+
+
+static void time_sync_wake(void)
+{
+    UNUSED_RETURN_VALUE(xTimerPendFunctionCall(time_sync_pended, NULL, 0, 0));
+}
+
+
+static time_sync_clock_t const m_time_sync_clock =
+{
+    .stamp       = time_sync_stamp,
+    .stamp_to_ms = time_sync_stamp_to_ms,
+    .step        = time_sync_step,
+    .trim        = time_sync_trim,
+    .wake        = time_sync_wake,
+};
 
 
 /**@brief Function for initializing services that will be used by the application.
@@ -479,6 +897,24 @@ static void services_init(void)
 
     err_code = ble_nus_init(&m_nus, &nus_init);
     APP_ERROR_CHECK(err_code);
+
+    // Initialize the framed protocol on top of NUS.
+    m_nus_tx_ready = xSemaphoreCreateBinary();
+    APP_ERROR_CHECK_BOOL(m_nus_tx_ready != NULL);
+    nus_proto_init(nus_raw_handler, nus_proto_tx);
+    UNUSED_RETURN_VALUE(nus_proto_register(NUS_PROTO_TYPE_TEXT, nus_text_handler));
+
+#if ASSET_XFER_SERIAL_FLASH
+    asset_xfer_init(SF_bridge_init() ? &m_asset_flash : NULL, asset_thread_wake);
+#else
+    m_asset_flash_done = xSemaphoreCreateBinary();
+    APP_ERROR_CHECK_BOOL(m_asset_flash_done != NULL);
+    err_code = nrf_fstorage_init(&m_asset_fstorage, &nrf_fstorage_sd, NULL);
+    APP_ERROR_CHECK(err_code);
+    asset_xfer_init(&m_asset_flash, asset_thread_wake);
+#endif
+    time_sync_init(&m_time_sync_clock, drift_retained_get());
+    perf_metrics_init(NULL);
 }
 
 
@@ -606,6 +1042,8 @@ static void ble_evt_handler(ble_evt_t const * p_ble_evt, void * p_context)
             NRF_LOG_INFO("Disconnected");
             // LED indication will be changed when advertising starts.
             m_conn_handle = BLE_CONN_HANDLE_INVALID;
+            nus_proto_reset();
+            UNUSED_RETURN_VALUE(xSemaphoreGive(m_nus_tx_ready));                    // Senders fail instead of waiting.
             break;
 
         case BLE_GAP_EVT_PHY_UPDATE_REQUEST:
@@ -1084,6 +1522,17 @@ static void led_thread(void * arg)
 }
 
 
+/**@brief LVGL refresh monitor, called at the end of every refresh that drew something. */
+static void lvgl_monitor(lv_disp_drv_t * p_drv, uint32_t time, uint32_t px)
+{
+    UNUSED_PARAMETER(p_drv);
+    UNUSED_PARAMETER(time);
+    UNUSED_PARAMETER(px);
+
+    perf_metrics_render_end();
+}
+
+
 static void event_handler(lv_obj_t * obj, lv_event_t event)
 {
     if(event == LV_EVENT_CLICKED) {
@@ -1097,14 +1546,29 @@ void lvgl_init(void)
     // LV init
     lv_init();
     static lv_disp_buf_t disp_buf;              /*A static or global variable to store the buffers*/
-    static lv_color_t buf_1[(LV_VER_RES_MAX) * (2 + (LV_HOR_RES_MAX / 8)) + 2]; /*Static or global buffer(s). The second buffer is optional*/
-    lv_disp_buf_init(&disp_buf, buf_1, NULL, LV_HOR_RES_MAX*LV_VER_RES_MAX);/*Initialize `disp_buf` with the buffer(s) */
+#if DISPLAY_MDC
+    static lv_color_t buf_1[MDC_DISP_BUF_SIZE]; /*Part of the screen, the S1D13C00 holds the frame*/
+    lv_disp_buf_init(&disp_buf, buf_1, NULL, MDC_DISP_BUF_PX);
+    lv_disp_drv_init(&disp_drv);            /*Basic initialization*/
+    disp_drv.buffer = &disp_buf;            /*Set an initialized buffer*/
+    mdc_disp_drv_init(&disp_drv);
+#else
+#if SHARP_MIP_ROW_PACK
+    static lv_color_t buf_1[LV_HOR_RES_MAX * SHARP_MIP_BUF_LINES]; /*Native pixels, packed into m_mip_frame by the flush*/
+#else
+    static lv_color_t buf_1[MIP_PACK_FRAME_SIZE(LV_HOR_RES_MAX, SHARP_MIP_BUF_LINES)]; /*The SPI frame, bits set by sharp_mip_set_px*/
+#endif
+    lv_disp_buf_init(&disp_buf, buf_1, NULL, LV_HOR_RES_MAX * SHARP_MIP_BUF_LINES);/*Initialize `disp_buf` with the buffer(s) */
 //    lv_disp_drv_t disp_drv;                     /*A variable to hold the drivers. Can be local variable*/
     lv_disp_drv_init(&disp_drv);            /*Basic initialization*/
     disp_drv.buffer = &disp_buf;            /*Set an initialized buffer*/
     disp_drv.flush_cb = sharp_mip_flush;   /*Set a flush callback to draw to the display*/
     disp_drv.rounder_cb = sharp_mip_rounder;
+#if !SHARP_MIP_ROW_PACK
     disp_drv.set_px_cb = sharp_mip_set_px;
+#endif
+#endif
+    disp_drv.monitor_cb = lvgl_monitor;
     lv_disp_t * disp;
     disp = lv_disp_drv_register(&disp_drv); /*Register the driver and save the created display objects*/
     
@@ -1195,6 +1659,50 @@ void lvgl_init(void)
 }
 
 
+/**@brief Function for updating the clock text area.
+ *
+ * @details After the first full layout the label text is patched in place and only the glyph cells
+ *          from the first changed character to the end of its line are invalidated. Glyphs after the
+ *          change may move with a proportional font, which is why the area runs to the line end.
+ */
+static void time_text_refresh(void)
+{
+    calendar_tm_t      tm;
+    uint8_t            first, last;
+    lv_obj_t         * label  = lv_textarea_get_label(ta1);
+    char             * p_text = lv_label_get_text(label);
+    lv_font_t const  * font;
+    lv_point_t         p1, p2;
+    lv_area_t          area;
+
+    calendar_tm_get(&tm);
+    if (!calendar_fmt_update(&m_time_fmt, &tm, &first, &last))
+    {
+        return;
+    }
+
+    if ((p_text == NULL) || (strlen(p_text) != CALENDAR_TEXT_LEN))
+    {
+        lv_textarea_set_text(ta1, m_time_fmt.text);                                 // First time, or the text was edited.
+        return;
+    }
+
+    memcpy(&p_text[first], &m_time_fmt.text[first], last - first + 1);
+
+    font = lv_obj_get_style_text_font(label, LV_LABEL_PART_MAIN);
+    lv_label_get_letter_pos(label, first, &p1);
+    lv_label_get_letter_pos(label, last, &p2);
+    lv_obj_get_coords(label, &area);
+    if (p1.y == p2.y)
+    {
+        area.x1 += p1.x;
+    }
+    area.y2  = area.y1 + p2.y + lv_font_get_line_height(font) - 1;
+    area.y1 += p1.y;
+    lv_obj_invalidate_area(label, &area);
+}
+
+
 static void lvgl_thread(void * arg)
 {
     UNUSED_PARAMETER(arg);
@@ -1204,21 +1712,27 @@ static void lvgl_thread(void * arg)
     while(1)
     {
         //bsp_board_led_invert(BSP_BOARD_LED_2);
+        perf_metrics_render_begin();
         lv_task_handler();
+#if DISPLAY_MDC
+        mdc_disp_poll();
+#endif
 
-        if(calendar_time != calendar_time_old)
+        if(m_time_changed)
         {
-            time_string = ctime(&calendar_time);
-            lv_textarea_set_text(ta1, time_string);
-            //lv_textarea_set_text(ta1, "\b");
-            calendar_time_old = calendar_time;
+            m_time_changed = false;
+            time_text_refresh();
         }
 
         if(received_new_data)
         {
-            lv_textarea_set_max_length(ta2, (uint32_t)received_data_len);
-            lv_textarea_set_text(ta2, received_data);
+            static char text[RECEIVED_TEXT_MAX_LEN + 1];
+
+            UNUSED_RETURN_VALUE(xSemaphoreTake(m_received_mutex, portMAX_DELAY));
+            memcpy(text, received_data, sizeof(text));
             received_new_data = false;
+            UNUSED_RETURN_VALUE(xSemaphoreGive(m_received_mutex));
+            lv_textarea_set_text(ta2, text);
         }
 
 
@@ -1274,12 +1788,49 @@ static void lvgl_toggle_timer_callback (void * pvParameter)
     
 }
 
+/**@brief Calendar event handler, runs in the timer task. The LVGL thread does the drawing. */
+static void calendar_evt_handler(uint32_t changed, calendar_tm_t const * p_tm)
+{
+    UNUSED_PARAMETER(changed);
+    UNUSED_PARAMETER(p_tm);
+
+    m_time_changed = true;
+}
+
+
+/**@brief 1 Hz source of the calendar.
+ *
+ * @details Seconds are derived from the tick count, which RTC1 drives from the 32.768 kHz LFCLK
+ *          (configTICK_SOURCE is FREERTOS_USE_RTC), instead of counting callbacks, so a late
+ *          callback does not lose time. They are scaled by the drift learned by time_sync.
+ */
 static void calendar_timer_callback(void * pvParameter)
 {
+    TickType_t now = xTaskGetTickCount();
+    uint32_t   secs;
+
     UNUSED_PARAMETER(pvParameter);
 
     //bsp_board_led_invert(BSP_BOARD_LED_2);
-    calendar_time++;
+    m_calendar_acc      += calendar_units((int32_t)(now - m_calendar_last_tick));
+    m_calendar_last_tick = now;
+    secs                 = (uint32_t)(m_calendar_acc / CALENDAR_UNITS_PER_SEC);
+    calendar_tick(secs);
+    m_calendar_acc      %= CALENDAR_UNITS_PER_SEC;
+#if DISPLAY_MDC
+    if (m_rtc_trim_secs != 0)
+    {
+        if (m_rtc_trim_secs <= secs)
+        {
+            rtc_trim();
+        }
+        else
+        {
+            m_rtc_trim_secs -= secs;
+        }
+    }
+#endif
+    perf_metrics_tick();                                                            // Shares the 1 Hz wakeup.
     
 
     
@@ -1302,10 +1853,20 @@ int main(void)
     
     //calendar_time = time(NULL);
 
+#if DISPLAY_MDC
+    APP_ERROR_CHECK_BOOL(mdc_disp_init());
+#else
     spi_init();
+#endif
     uart_init();
     log_init();
     clock_init();
+#if MIP_PACK_BENCH
+    mip_pack_bench();
+#endif
+#if DISPLAY_MDC
+    APP_ERROR_CHECK_BOOL(mdc_disp_init_finish());                                   // Panel supplies ramped up meanwhile.
+#endif
 
     // Do not start any interrupt that uses system functions before system initialisation.
     // The best solution is to start the OS before any other initalisation.
@@ -1324,17 +1885,33 @@ int main(void)
     //}
     //NRF_LOG_INFO("LED thread started.");
 
+    m_received_mutex = xSemaphoreCreateMutex();
+    APP_ERROR_CHECK_BOOL(m_received_mutex != NULL);
+
     if (pdPASS != xTaskCreate(lvgl_thread, "LVGL", 1024, NULL, 1, &m_lvgl_thread))
     {
         APP_ERROR_HANDLER(NRF_ERROR_NO_MEM);
     }
     NRF_LOG_INFO("LVGL thread started.");
 
+    if (pdPASS != xTaskCreate(asset_thread, "ASSET", 256, NULL, 1, &m_asset_thread))
+    {
+        APP_ERROR_HANDLER(NRF_ERROR_NO_MEM);
+    }
+
     lvgl_toggle_timer_handle = xTimerCreate( "LVGL", LVGL_TIMER_PERIOD, pdTRUE, NULL, lvgl_toggle_timer_callback);
     UNUSED_VARIABLE(xTimerStart(lvgl_toggle_timer_handle, 0));
     NRF_LOG_INFO("LVGL timer started.");
 
-    calendar_timer_handle = xTimerCreate("CALENDAR", CALENDAR_TIMER_PERIOD, pdTRUE, NULL, calendar_timer_callback);
+#if DISPLAY_MDC
+    calendar_init(&mdc_disp_rtc, CALENDAR_FALLBACK_TIME);
+#else
+    calendar_init(NULL, CALENDAR_FALLBACK_TIME);
+#endif
+    UNUSED_RETURN_VALUE(calendar_subscribe(calendar_evt_handler));
+    calendar_fmt_init(&m_time_fmt);
+
+    calendar_timer_handle = xTimerCreate("CALENDAR", pdMS_TO_TICKS(CALENDAR_TIMER_PERIOD), pdTRUE, NULL, calendar_timer_callback);
     UNUSED_VARIABLE(xTimerStart(calendar_timer_handle, 0));
     NRF_LOG_INFO("Calendar timer started.");
 
@@ -0,0 +1,415 @@
+/** @file
+ *
+ * @brief    S1D13C00 display driver for LVGL, see mdc_disp.h.
+ *
+ * @details  The graphics engine has one set of parameter registers, so every operation waits for
+ *           the previous one before it is programmed (gfx_sync()). Uploads to the bitmap scratch
+ *           area go to RAM the engine is not using, so the upload of a mixed band overlaps the
+ *           background fill of the same band.
+ *
+ *           MDCINT in SYS_INTS is shared by the graphics and the update interrupt, so a panel
+ *           update still running from the previous flush is waited for before the engine is used.
+ */
+
+#include <string.h>
+#include "nordic_common.h"
+#include "app_util.h"
+#include "mdc_disp.h"
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include "s1d13c00_hcl.h"
+#include "s1d13c00_memregs.h"
+#include "se_common.h"
+#include "se_clg.h"
+#include "se_mdc.h"
+#include "s1d13c00_trace.h"
+#include "support.h"
+#include "perf_metrics.h"
+
+#define MDC_DISP_FB_ADDR                RAM_BASE                                    /**< 8 bpp frame buffer, stride = width. */
+#define MDC_DISP_SCRATCH_ADDR           (RAM_BASE + MDC_DISP_HOR_RES * MDC_DISP_VER_RES)  /**< Bitmaps on their way to the frame buffer. */
+
+#define MDC_DISP_BIT(x)                 (0x80 >> ((x) & 7))                         /**< Bit of column x in its bitmap byte. */
+#define MDC_DISP_SCALE_1                256                                         /**< Engine scale factor 1.0. */
+#define MDC_DISP_LINK_MAGIC             0x4C4E4B53UL                                /**< "LNKS" */
+
+#ifndef MDC_DISP_RETAINED_SECTION
+#define MDC_DISP_RETAINED_SECTION       ".non_init"                                 /**< Not cleared by the start-up code. */
+#endif
+
+/**@brief Calibrated host interface speeds kept across soft resets, valid if magic and check match. */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t wr_hz;
+    uint32_t rd_hz;
+    uint32_t check;                                                                 /**< ~(wr_hz ^ rd_hz) */
+} link_retained_t;
+
+/**@brief Row content of a VDB band. */
+typedef enum
+{
+    ROW_BLACK,
+    ROW_WHITE,
+    ROW_MIXED,
+} row_kind_t;
+
+static SemaphoreHandle_t m_lock;
+static bool              m_gfx_busy;                                                /**< Engine started and not yet waited for. */
+static bool              m_first_frame;                                             /**< Panel not enabled yet, see seMDC_INIT_NOBLANK. */
+static bool              m_warm;                                                    /**< Running panel taken over by mdc_disp_init(). */
+
+static seS1D13C00Transport const * mp_bus;                                          /**< Transport the counting wrapper forwards to. */
+static seS1D13C00Transport         m_bus_counted;
+
+static link_retained_t m_link __attribute__((section(MDC_DISP_RETAINED_SECTION)));
+static const uint32_t  m_link_speeds[] = MDC_DISP_LINK_SPEEDS;
+
+
+/**@brief Transport wrapper counting the host interface bytes for perf_metrics. */
+static void bus_xfer(const uint8_t hdr[], uint32_t hlen, const uint8_t wdata[], uint32_t wlen,
+                     uint8_t rdata[], uint32_t rlen)
+{
+    mp_bus->xfer(hdr, hlen, wdata, wlen, rdata, rlen);
+    perf_metrics_bus_bytes(hlen + wlen + rlen);
+}
+
+
+/**@brief Function for setting the retained host interface speeds.
+ *
+ * @return false if none are retained.
+ */
+static bool link_speed_retained(void)
+{
+    if ((m_link.magic == MDC_DISP_LINK_MAGIC) && (m_link.check == ~(m_link.wr_hz ^ m_link.rd_hz)))
+    {
+        seS1D13C00SetSpeed(m_link.wr_hz, m_link.rd_hz);
+        return true;
+    }
+    return false;
+}
+
+
+/**@brief Function for setting the host interface speeds, retained or calibrated. Without a
+ *        calibration the speeds of InitializeMDC() stay.
+ */
+static void link_speed_init(void)
+{
+    uint32_t wr_hz;
+    uint32_t rd_hz;
+
+    if (link_speed_retained())
+    {
+        return;
+    }
+    if (seS1D13C00CalibrateSpeed(MDC_DISP_FB_ADDR, m_link_speeds, ARRAY_SIZE(m_link_speeds),
+                                      &wr_hz, &rd_hz) == seSTATUS_OK)
+    {
+        m_link.wr_hz = wr_hz;
+        m_link.rd_hz = rd_hz;
+        m_link.check = ~(wr_hz ^ rd_hz);
+        m_link.magic = MDC_DISP_LINK_MAGIC;
+    }
+}
+
+
+static void gfx_sync(void)
+{
+    if (m_gfx_busy)
+    {
+        seMDC_WaitGfxDone();
+        m_gfx_busy = false;
+    }
+}
+
+
+static row_kind_t row_kind(uint8_t const * p_row, uint16_t nbytes)
+{
+    uint8_t all_or  = 0x00;
+    uint8_t all_and = 0xFF;
+
+    for (uint16_t i = 0; i < nbytes; i++)
+    {
+        all_or  |= p_row[i];
+        all_and &= p_row[i];
+    }
+
+    if (all_or == 0x00)
+    {
+        return ROW_BLACK;
+    }
+    return (all_and == 0xFF) ? ROW_WHITE : ROW_MIXED;
+}
+
+
+/**@brief Draws @p h rows of the VDB starting at @p p_rows to frame buffer position x, y. */
+static void band_draw(uint16_t x, uint16_t y, uint16_t w, uint16_t h, row_kind_t kind,
+                      uint8_t const * p_rows)
+{
+    seMDC_ImgCopyRotScaleCtrl ctrl;
+
+    gfx_sync();
+    (void)seMDC_DrawRectangle(x, y, x + w - 1, y + h - 1,
+                              (kind == ROW_WHITE) ? MDC_DISP_WHITE : MDC_DISP_BLACK, 0, 0, FILL_ENABLE);
+    m_gfx_busy = true;
+
+    if (kind != ROW_MIXED)
+    {
+        return;
+    }
+
+    // White pixels are set bits, the black background shows through the clear ones.
+    seS1D13C00Write(MDC_DISP_SCRATCH_ADDR, (uint8_t *)p_rows, (uint32_t)h * MDC_DISP_ROW_BYTES(w));
+
+    ctrl.ctrlword              = 0;
+    ctrl.ctrlword_b.bitmapen   = 1;
+    ctrl.ctrlword_b.bitmapfmt  = seMDC_1BIT_BITMAP;
+
+    gfx_sync();
+    (void)seMDC_ImgCpyRotScale(x + (w >> 1), y + (h >> 1),
+                               MDC_DISP_SCRATCH_ADDR, w, w, h, w >> 1, h >> 1,
+                               MDC_DISP_WHITE, 0,
+                               MDC_DISP_SCALE_1, MDC_DISP_SCALE_1, MDC_DISP_SCALE_1, MDC_DISP_SCALE_1,
+                               &ctrl);
+    m_gfx_busy = true;
+}
+
+
+static void mdc_disp_flush(lv_disp_drv_t * p_drv, const lv_area_t * p_area, lv_color_t * p_color)
+{
+    uint8_t const * p_buf  = (uint8_t const *)p_color;
+    uint16_t        w      = (uint16_t)lv_area_get_width(p_area);
+    uint16_t        h      = (uint16_t)lv_area_get_height(p_area);
+    uint16_t        stride = MDC_DISP_ROW_BYTES(w);
+    uint16_t        y      = 0;
+
+    mdc_disp_lock();
+
+    while (y < h)
+    {
+        row_kind_t kind = row_kind(&p_buf[y * stride], w >> 3);
+        uint16_t   n    = 1;
+
+        while ((y + n < h) && (row_kind(&p_buf[(y + n) * stride], w >> 3) == kind))
+        {
+            n++;
+        }
+        band_draw((uint16_t)p_area->x1, (uint16_t)(p_area->y1 + y), w, n, kind, &p_buf[y * stride]);
+        y += n;
+    }
+
+    gfx_sync();
+    (void)seMDC_PanelUpdateAsync((uint16_t)p_area->y1, (uint16_t)p_area->y2);      // Merged if the panel is still busy.
+    perf_metrics_lines((uint32_t)h);
+
+    if (lv_disp_flush_is_last(p_drv))
+    {
+        if (m_first_frame)
+        {
+            seMDC_WaitUpdDone();                                                    // Enables the panel.
+            m_first_frame = false;
+        }
+        seTRACE_FRAME();
+    }
+
+    mdc_disp_unlock();
+
+    lv_disp_flush_ready(p_drv);
+}
+
+
+static void mdc_disp_set_px(lv_disp_drv_t * p_drv, uint8_t * p_buf, lv_coord_t buf_w,
+                            lv_coord_t x, lv_coord_t y, lv_color_t color, lv_opa_t opa)
+{
+    uint8_t * p_byte = &p_buf[y * MDC_DISP_ROW_BYTES(buf_w) + (x >> 3)];
+
+    UNUSED_PARAMETER(p_drv);
+    UNUSED_PARAMETER(opa);
+
+    if (lv_color_to1(color) != 0)
+    {
+        *p_byte |= MDC_DISP_BIT(x);
+    }
+    else
+    {
+        *p_byte &= ~MDC_DISP_BIT(x);
+    }
+}
+
+
+/**@brief Widens areas to whole bitmap bytes, see MDC_DISP_BUF_PX. */
+static void mdc_disp_rounder(lv_disp_drv_t * p_drv, lv_area_t * p_area)
+{
+    UNUSED_PARAMETER(p_drv);
+
+    p_area->x1 &= ~7;
+    p_area->x2 |= 7;
+    if (p_area->x2 > MDC_DISP_HOR_RES - 1)
+    {
+        p_area->x2 = MDC_DISP_HOR_RES - 1;
+    }
+}
+
+
+bool mdc_disp_init(void)
+{
+    m_lock = xSemaphoreCreateMutex();
+    if (m_lock == NULL)
+    {
+        return false;
+    }
+
+    // The counter wraps the transport the HCL would pick for the mode.
+    mp_bus             = seS1D13C00HostIfTransport(MDC_DISP_HOSTIF);
+    m_bus_counted      = *mp_bus;
+    m_bus_counted.xfer = bus_xfer;
+    seS1D13C00SetTransport(&m_bus_counted);
+
+    InitializeHost();
+
+    // A panel left running by the previous start is kept as is. The calibration resets the
+    // controller, so only retained speeds are used until the panel is known to be lost.
+    ResumeMDC(MDC_DISP_HOSTIF);
+    (void)link_speed_retained();
+    m_warm = (seMDC_PanelResume(&MDC_DISP_PANEL, MDC_DISP_SYSFREQ, MDC_DISP_FB_ADDR) == seSTATUS_OK);
+    if (m_warm)
+    {
+        return true;
+    }
+
+    InitializeMDC(MDC_DISP_HOSTIF);
+    link_speed_init();
+    seCLG_Start(seCLG_IOSC);
+    seCLG_Start(seCLG_OSC1);
+
+    // LVGL draws the whole screen first, so the panel is not blanked.
+    return seMDC_PanelInitStart(&MDC_DISP_PANEL, MDC_DISP_SYSFREQ, MDC_DISP_FB_ADDR,
+                                seMDC_INIT_NOBLANK) == seSTATUS_OK;
+}
+
+
+bool mdc_disp_init_finish(void)
+{
+    seMDC_DestWindowParams win;
+
+    if (!m_warm && (seMDC_PanelInitFinish() != seSTATUS_OK))
+    {
+        return false;
+    }
+
+    win.obaseaddr = MDC_DISP_FB_ADDR;
+    win.owidth    = MDC_DISP_HOR_RES;
+    win.oheight   = MDC_DISP_VER_RES;
+    win.ostride   = MDC_DISP_HOR_RES;
+    (void)seMDC_SetDestWindow(&win);
+
+    m_gfx_busy    = false;
+    m_first_frame = !m_warm;
+
+    return true;
+}
+
+
+void mdc_disp_poll(void)
+{
+    mdc_disp_lock();
+    (void)seMDC_PanelUpdatePoll();
+    mdc_disp_unlock();
+}
+
+
+void mdc_disp_drv_init(lv_disp_drv_t * p_drv)
+{
+    p_drv->hor_res    = MDC_DISP_HOR_RES;
+    p_drv->ver_res    = MDC_DISP_VER_RES;
+    p_drv->flush_cb   = mdc_disp_flush;
+    p_drv->set_px_cb  = mdc_disp_set_px;
+    p_drv->rounder_cb = mdc_disp_rounder;
+}
+
+
+void mdc_disp_lock(void)
+{
+    (void)xSemaphoreTake(m_lock, portMAX_DELAY);
+}
+
+
+void mdc_disp_unlock(void)
+{
+    (void)xSemaphoreGive(m_lock);
+}
+
+
+static uint8_t bcd_to_bin(uint32_t bcd)
+{
+    return (uint8_t)((bcd >> 4) * 10 + (bcd & 0x0F));
+}
+
+
+static uint16_t bin_to_bcd(uint32_t bin)
+{
+    return (uint16_t)(((bin / 10) << 4) | (bin % 10));
+}
+
+
+/**@brief Function for reading the S1D13C00 RTC, see calendar_rtc_t. */
+static bool mdc_disp_rtc_read(calendar_tm_t * p_tm)
+{
+    uint16_t sec, hur, mon, yar;
+    bool     running;
+
+    mdc_disp_lock();
+    running = (seS1D13C00Read8(RTC_CTLL) & RTC_RUN_bits) != 0;
+
+    // The counters are read one register at a time, so read again if the seconds carried.
+    do
+    {
+        sec = seS1D13C00Read16(RTC_SEC);
+        hur = seS1D13C00Read16(RTC_HUR);
+        mon = seS1D13C00Read16(RTC_MON);
+        yar = seS1D13C00Read16(RTC_YAR);
+    } while (running && (((seS1D13C00Read16(RTC_SEC) ^ sec) & (RTC_SH_bits | RTC_SL_bits)) != 0));
+    mdc_disp_unlock();
+
+    p_tm->second = bcd_to_bin((sec & (RTC_SH_bits | RTC_SL_bits)) >> 8);
+    p_tm->minute = bcd_to_bin(hur & (RTC_MIH_bits | RTC_MIL_bits));
+    p_tm->hour   = bcd_to_bin((hur & (RTC_HH_bits | RTC_HL_bits)) >> 8);
+    p_tm->day    = bcd_to_bin(mon & (RTC_DH_bits | RTC_DL_bits));
+    p_tm->month  = bcd_to_bin((mon & (RTC_MOH_bits | RTC_MOL_bits)) >> 8);
+    p_tm->year   = 2000 + bcd_to_bin(yar & (RTC_YH_bits | RTC_YL_bits));
+    p_tm->wday   = (uint8_t)((yar & RTC_WK_bits) >> 8);
+
+    return running && (p_tm->second < 60) && (p_tm->minute < 60) && (p_tm->hour < 24) &&
+           (p_tm->day >= 1) && (p_tm->day <= 31) && (p_tm->month >= 1) && (p_tm->month <= 12);
+}
+
+
+/**@brief Function for setting the S1D13C00 RTC, see calendar_rtc_t. */
+static bool mdc_disp_rtc_write(calendar_tm_t const * p_tm)
+{
+    if ((p_tm->year < 2000) || (p_tm->year > 2099))
+    {
+        return false;
+    }
+
+    mdc_disp_lock();
+    seS1D13C00Write8(RTC_CTLL, RTC_24H_bits);                                       // Stop, counters writable
+    while ((seS1D13C00Read8(RTC_CTLL) & RTC_BSY_bits) != 0)
+    {
+    }
+    seS1D13C00Write16(RTC_SEC, (uint16_t)(bin_to_bcd(p_tm->second) << 8));
+    seS1D13C00Write16(RTC_HUR, (uint16_t)((bin_to_bcd(p_tm->hour) << 8) | bin_to_bcd(p_tm->minute)));
+    seS1D13C00Write16(RTC_MON, (uint16_t)((bin_to_bcd(p_tm->month) << 8) | bin_to_bcd(p_tm->day)));
+    seS1D13C00Write16(RTC_YAR, (uint16_t)((p_tm->wday << 8) | bin_to_bcd(p_tm->year - 2000)));
+    seS1D13C00Write8(RTC_CTLL, RTC_24H_bits | RTC_RUN_bits);
+    mdc_disp_unlock();
+
+    return true;
+}
+
+
+calendar_rtc_t const mdc_disp_rtc =
+{
+    .read  = mdc_disp_rtc_read,
+    .write = mdc_disp_rtc_write,
+};
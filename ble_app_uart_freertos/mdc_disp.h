@@ -0,0 +1,135 @@
+/** @file
+ *
+ * @defgroup mdc_disp LVGL display driver for the S1D13C00 memory display controller
+ * @{
+ * @ingroup  ble_sdk_app_nus_eval
+ * @brief    Renders LVGL frames into S1D13C00 frame buffer RAM and lets the MDC refresh the panel.
+ *
+ * @details  The S1D13C00 owns the panel: it keeps the frame buffer, generates VCOM and shifts
+ *           the lines out to the display, so the nRF neither holds a panel sized buffer nor
+ *           wakes up for COM inversion.
+ *
+ *           LVGL renders each invalidated area into a small VDB kept in the MDC 1-bit bitmap
+ *           format (one bit per pixel, MSB first, (width / 8) + 1 bytes per row). The flush
+ *           splits the area into bands of rows. Bands of one colour are drawn by the graphics
+ *           engine as filled rectangles, mixed bands are uploaded as a bitmap and expanded by
+ *           the engine into the frame buffer, which moves an eighth of the pixel data over SPI.
+ *           Only the flushed lines are then sent to the panel. The panel update runs while
+ *           LVGL renders the next area.
+ *
+ *           LVGL 7 does not call its GPU fill and blend hooks for drivers with set_px_cb, which
+ *           a 1-bit display needs, so the engine is driven from the flush instead.
+ */
+
+#ifndef MDC_DISP_H__
+#define MDC_DISP_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "lvgl.h"
+#include "calendar.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef MDC_DISP_PANEL
+#define MDC_DISP_PANEL                  seMDC_Panel_LS012B7DH02                     /**< Panel descriptor from se_mdc.h. */
+#endif
+#ifndef MDC_DISP_HOR_RES
+#define MDC_DISP_HOR_RES                240
+#endif
+#ifndef MDC_DISP_VER_RES
+#define MDC_DISP_VER_RES                240
+#endif
+#ifndef MDC_DISP_BLACK
+#define MDC_DISP_BLACK                  0x0002                                      /**< Frame buffer value of a black pixel (SPI 1-bit panels). */
+#endif
+#ifndef MDC_DISP_WHITE
+#define MDC_DISP_WHITE                  0x0003                                      /**< Frame buffer value of a white pixel. */
+#endif
+#ifndef MDC_DISP_LINK_SPEEDS
+#define MDC_DISP_LINK_SPEEDS            { 1000000, 2000000, 4000000, 8000000 }      /**< Host interface speeds calibrated, increasing. */
+#endif
+#ifndef MDC_DISP_HOSTIF
+#define MDC_DISP_HOSTIF                 HOSTMCU_SPI_MONOADDR_DUALDATA               /**< Host interface mode, see hostmcu_config. */
+#endif
+
+#define MDC_DISP_SYSFREQ                20000000UL                                  /**< MDC system clock assumed by the panel timing. */
+#define MDC_DISP_BUF_LINES              (MDC_DISP_VER_RES / 4)                      /**< Full width lines per VDB. */
+
+/**@brief Bytes of one VDB row in the MDC 1-bit bitmap format. */
+#define MDC_DISP_ROW_BYTES(w)           (((w) >> 3) + 1)
+
+/**@brief VDB size in bytes, and the size in pixels to pass to lv_disp_buf_init().
+ *
+ * @details The rounder keeps areas a multiple of 8 pixels wide, so a row takes at most 1/4 byte
+ *          per pixel, including the pad byte, and the pixel count may be four times the bytes.
+ */
+#define MDC_DISP_BUF_SIZE               (MDC_DISP_BUF_LINES * MDC_DISP_ROW_BYTES(MDC_DISP_HOR_RES))
+#define MDC_DISP_BUF_PX                 (MDC_DISP_BUF_SIZE * 4)
+
+/**@brief Function for starting the controller and the panel.
+ *
+ * @details Call before the scheduler starts and before anything else uses the S1D13C00, the
+ *          controller is soft reset. The first start calibrates the host interface write and
+ *          read speeds among MDC_DISP_LINK_SPEEDS, later starts take them from retained RAM, so
+ *          they are kept across soft resets and recalibrated after a power-on reset.
+ *
+ *          Modes other than single data run on the QSPI, as picked by seS1D13C00HostIfTransport(),
+ *          which falls back to single data on the SPIM if the controller does not answer in the
+ *          mode, see seS1D13C00GetHostIf().
+ *
+ *          If the S1D13C00 still runs the panel from an earlier start, e.g. after a soft reset of
+ *          the host only, the panel is taken over without a reset and keeps its image, see
+ *          seMDC_PanelResume(). Otherwise the panel supplies are left ramping up, see
+ *          mdc_disp_init_finish().
+ *
+ * @return false if the panel could not be initialized.
+ */
+bool mdc_disp_init(void);
+
+/**@brief Function for completing the panel start.
+ *
+ * @details Call after mdc_disp_init(), before the scheduler starts. Start-up work that does not
+ *          use the S1D13C00 can run in between and covers the supply stabilization time. The
+ *          panel is not blanked: it is enabled once the first LVGL frame has been sent to it.
+ *          After a takeover there is nothing left to wait for.
+ *
+ * @return false if the panel could not be initialized.
+ */
+bool mdc_disp_init_finish(void);
+
+/**@brief Function for setting the driver callbacks. The buffer is set by the caller. */
+void mdc_disp_drv_init(lv_disp_drv_t * p_drv);
+
+/**@brief Function for advancing the panel updates after lv_task_handler().
+ *
+ * @details Flushes do not wait for the panel: their lines are merged into the update that
+ *          follows the running one, which this call triggers. The booster returns to ECO mode
+ *          from here once the panel is idle.
+ */
+void mdc_disp_poll(void);
+
+/**@brief Function for taking the S1D13C00 host interface, which other tasks share with the display. */
+void mdc_disp_lock(void);
+
+/**@brief Function for releasing the S1D13C00 host interface. */
+void mdc_disp_unlock(void);
+
+/**@brief Calendar binding of the S1D13C00 RTC, for calendar_init().
+ *
+ * @details The RTC runs from OSC1 and keeps counting while the host is reset, as long as the
+ *          controller is not: read() fails after a controller reset, until the next write().
+ *          Valid for years 2000 to 2099. Uses the host interface lock, so the calendar must not
+ *          be ticked or set with the lock held.
+ */
+extern calendar_rtc_t const mdc_disp_rtc;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MDC_DISP_H__
+
+/** @} */
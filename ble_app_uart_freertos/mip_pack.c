@@ -0,0 +1,154 @@
+/** @file
+ *
+ * @brief    Sharp memory-in-pixel line packing, see mip_pack.h.
+ */
+
+#include <stdbool.h>
+#include <string.h>
+#include "mip_pack.h"
+
+#ifdef __arm__
+#include "nrf.h"
+#else
+// Host build for mip_pack_test, without CMSIS
+#define __INLINE                        inline
+
+static inline uint32_t __RBIT(uint32_t w)
+{
+    w = ((w >> 1) & 0x55555555UL) | ((w & 0x55555555UL) << 1);
+    w = ((w >> 2) & 0x33333333UL) | ((w & 0x33333333UL) << 2);
+    w = ((w >> 4) & 0x0F0F0F0FUL) | ((w & 0x0F0F0F0FUL) << 4);
+    return __builtin_bswap32(w);
+}
+
+static inline uint32_t __REV(uint32_t w)
+{
+    return __builtin_bswap32(w);
+}
+#endif
+
+#if MIP_PACK_BENCH
+#define NRF_LOG_MODULE_NAME mip
+#include "nrf_log.h"
+NRF_LOG_MODULE_REGISTER();
+
+#define MIP_PACK_BENCH_WIDTH            240                                         /**< Pixels per line. */
+#define MIP_PACK_BENCH_LINES            30                                          /**< Lines converted at a time, as in one VDB. */
+#define MIP_PACK_BENCH_CHUNKS           8                                           /**< Chunks per frame. */
+#define MIP_PACK_BENCH_LINE             MIP_PACK_LINE_BYTES(MIP_PACK_BENCH_WIDTH)
+#endif
+
+
+/**@brief Function for turning four pixels into a nibble, the first pixel in bit 0. */
+static __INLINE uint32_t px4(uint32_t w)
+{
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+    w -= __UQSUB8(w, 0x01010101UL);                                                 // Each byte min(px, 1)
+#else
+    w = ((((w & 0x7F7F7F7FUL) + 0x7F7F7F7FUL) | w) >> 7) & 0x01010101UL;            // Bit 7 set if any bit is
+#endif
+    return (uint32_t)(w * 0x10204080UL) >> 28;                                      // Byte n to bit 28 + n
+}
+
+
+void mip_pack_row(uint8_t * p_dst, uint8_t const * p_px, uint32_t width)
+{
+    uint32_t w0, w1, bits;
+
+    for (; width >= 32; width -= 32)
+    {
+        bits = 0;
+        for (uint32_t i = 0; i < 32; i += 4)
+        {
+            memcpy(&w0, &p_px[i], 4);
+            bits |= px4(w0) << i;
+        }
+        bits = __REV(__RBIT(bits));                                                 // Pixel 0 to bit 7 of byte 0
+        memcpy(p_dst, &bits, 4);
+        p_px  += 32;
+        p_dst += 4;
+    }
+
+    for (; width >= 8; width -= 8)
+    {
+        memcpy(&w0, &p_px[0], 4);
+        memcpy(&w1, &p_px[4], 4);
+        *p_dst++ = (uint8_t)(__RBIT(px4(w0) | (px4(w1) << 4)) >> 24);
+        p_px += 8;
+    }
+}
+
+
+#if MIP_PACK_BENCH
+/**@brief Bit of pixel x in its frame byte, as looked up by the per-pixel driver. */
+static const uint8_t m_px_bit[8] = {0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01};
+
+static uint8_t m_bench_px[MIP_PACK_BENCH_LINES * MIP_PACK_BENCH_WIDTH];
+static uint8_t m_bench_frame[2][MIP_PACK_FRAME_SIZE(MIP_PACK_BENCH_WIDTH, MIP_PACK_BENCH_LINES)];
+
+
+/**@brief Function for setting one frame pixel, as the former set_px_cb did. */
+static void px_set(uint8_t * p_frame, uint32_t x, uint32_t y, uint8_t px)
+{
+    uint8_t * p_byte = &p_frame[(x >> 3) + y * MIP_PACK_BENCH_LINE + 2];
+
+    if (px != 0)
+    {
+        *p_byte |= m_px_bit[x & 7];
+    }
+    else
+    {
+        *p_byte &= ~m_px_bit[x & 7];
+    }
+}
+
+/**@brief Called through a pointer, LVGL calls set_px_cb for every pixel. */
+static void (* volatile mp_px_set)(uint8_t *, uint32_t, uint32_t, uint8_t) = px_set;
+
+
+void mip_pack_bench(void)
+{
+    uint32_t seed = 0x12345678UL;
+    uint32_t start, px_cycles = 0, row_cycles = 0;
+    bool     match = true;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL        |= DWT_CTRL_CYCCNTENA_Msk;
+
+    for (uint32_t chunk = 0; chunk < MIP_PACK_BENCH_CHUNKS; chunk++)
+    {
+        for (uint32_t i = 0; i < sizeof(m_bench_px); i++)
+        {
+            seed = seed * 1664525UL + 1013904223UL;
+            m_bench_px[i] = (uint8_t)(seed >> 31);
+        }
+
+        start = DWT->CYCCNT;
+        for (uint32_t y = 0; y < MIP_PACK_BENCH_LINES; y++)
+        {
+            for (uint32_t x = 0; x < MIP_PACK_BENCH_WIDTH; x++)
+            {
+                mp_px_set(m_bench_frame[0], x, y, m_bench_px[y * MIP_PACK_BENCH_WIDTH + x]);
+            }
+        }
+        px_cycles += DWT->CYCCNT - start;
+
+        start = DWT->CYCCNT;
+        for (uint32_t y = 0; y < MIP_PACK_BENCH_LINES; y++)
+        {
+            mip_pack_row(&m_bench_frame[1][y * MIP_PACK_BENCH_LINE + 2],
+                         &m_bench_px[y * MIP_PACK_BENCH_WIDTH], MIP_PACK_BENCH_WIDTH);
+        }
+        row_cycles += DWT->CYCCNT - start;
+
+        match = match && (memcmp(m_bench_frame[0], m_bench_frame[1], sizeof(m_bench_frame[0])) == 0);
+    }
+
+    NRF_LOG_INFO("%ux%u frame: per pixel %u cycles, row packed %u cycles.",
+                 MIP_PACK_BENCH_WIDTH, MIP_PACK_BENCH_LINES * MIP_PACK_BENCH_CHUNKS, px_cycles, row_cycles);
+    NRF_LOG_INFO("Cycles per 100 pixels: %u per pixel, %u row packed, outputs %s.",
+                 px_cycles / (MIP_PACK_BENCH_WIDTH * MIP_PACK_BENCH_LINES * MIP_PACK_BENCH_CHUNKS / 100),
+                 row_cycles / (MIP_PACK_BENCH_WIDTH * MIP_PACK_BENCH_LINES * MIP_PACK_BENCH_CHUNKS / 100),
+                 match ? "match" : "DIFFER");
+}
+#endif
@@ -0,0 +1,66 @@
+/** @file
+ *
+ * @defgroup mip_pack Sharp memory-in-pixel line packing
+ * @{
+ * @ingroup  ble_sdk_app_nus_eval
+ * @brief    Converts rows of one byte per pixel into the 1-bit lines a Sharp MIP panel is written with.
+ *
+ * @details  LVGL renders the Sharp panel in its native 1-bit colour format, one byte per pixel, 0 for
+ *           black and anything else for white. The panel takes each line as a gate address followed
+ *           by one bit per pixel, the first pixel in the most significant bit of the first byte.
+ *
+ *           mip_pack_row() converts a whole row 32 pixels at a time. On a Cortex-M4 each 4-pixel word
+ *           is reduced to one bit per byte with a saturating SIMD subtract and gathered into a nibble
+ *           with one multiply, the first pixel in bit 0. Eight nibbles make a 32-bit word which
+ *           __RBIT and __REV turn into the four bytes of the line, stored with one write. Cores
+ *           without the DSP extension reduce the bytes with plain word arithmetic.
+ *
+ *           mip_pack_bench() measures this against setting the frame bits one pixel at a time, as a
+ *           set_px_cb driver does, and logs the cycle counts. Build with MIP_PACK_BENCH set to 1 to
+ *           include it. host/mip_pack_test checks the packing against the per-pixel reference and
+ *           times both on the build host, where the plain word arithmetic is used.
+ */
+
+#ifndef MIP_PACK_H__
+#define MIP_PACK_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef MIP_PACK_BENCH
+#define MIP_PACK_BENCH                  0                                           /**< Include mip_pack_bench(). */
+#endif
+
+/**@brief Bytes of one panel line of w pixels: gate address, then the pixel data. */
+#define MIP_PACK_LINE_BYTES(w)          (2 + ((w) >> 3))
+
+/**@brief Bytes of a frame of h lines: the lines and two trailing dummy bytes. */
+#define MIP_PACK_FRAME_SIZE(w, h)       ((h) * MIP_PACK_LINE_BYTES(w) + 2)
+
+/**@brief Function for packing a row into panel line data.
+ *
+ * @param[out] p_dst  Pixel data of the line, width / 8 bytes, no alignment needed.
+ * @param[in]  p_px   Row, one byte per pixel, non-zero for white. No alignment needed.
+ * @param[in]  width  Pixels, a multiple of 8.
+ */
+void mip_pack_row(uint8_t * p_dst, uint8_t const * p_px, uint32_t width);
+
+#if MIP_PACK_BENCH
+/**@brief Function for comparing per-pixel and row-packed conversion of a full frame.
+ *
+ * @details Converts the same random frame both ways, checks that the results match and logs the
+ *          DWT cycle counts. Takes a few milliseconds, call it before the SoftDevice is enabled.
+ */
+void mip_pack_bench(void);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MIP_PACK_H__
+
+/** @} */
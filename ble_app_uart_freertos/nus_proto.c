@@ -0,0 +1,314 @@
+/** @file
+ *
+ * @brief    Framed binary protocol over NUS, see nus_proto.h.
+ *
+ * @details  The module has no SoftDevice dependency. Transmission goes through the hook given to
+ *           nus_proto_init(), so the same file encodes and decodes frames on the phone/PC side.
+ */
+
+#include <string.h>
+#include "nus_proto.h"
+#include "../spi_mdc/src/mdc/crc16.h"                                               // SDK crc16.h shadows the plain name
+
+#define NUS_PROTO_TX_CHUNK              244                                         /**< Largest NUS write, ATT MTU 247 - 3. */
+
+#define LE16_GET(p)                     ((uint16_t)((p)[0] | ((p)[1] << 8)))
+#define LE16_PUT(p, v)                  do { (p)[0] = (uint8_t)(v); (p)[1] = (uint8_t)((v) >> 8); } while (0)
+
+static nus_proto_handler_t     m_handlers[NUS_PROTO_MAX_TYPES];
+static nus_proto_raw_handler_t m_raw_handler;
+static nus_proto_tx_t          m_tx;
+static nus_proto_stats_t       m_stats;
+static uint8_t                 m_tx_seq;
+static uint8_t                 m_tx_chunk[NUS_PROTO_TX_CHUNK];                      /**< Write-sized staging buffer, kept off the SoftDevice task stack. */
+
+static uint8_t                 m_rx_buf[NUS_PROTO_OVERHEAD + NUS_PROTO_MAX_PAYLOAD]; /**< Reassembly buffer for frames split over writes. */
+static uint16_t                m_rx_pos;                                            /**< Bytes of the pending frame collected so far. */
+static uint16_t                m_rx_need;                                           /**< Total length of the pending frame, 0 until the header is complete. */
+
+
+static void frame_header_fill(uint8_t * p_hdr, uint8_t type, uint8_t seq, uint8_t flags, uint16_t len)
+{
+    p_hdr[0] = NUS_PROTO_SYNC;
+    p_hdr[1] = type;
+    p_hdr[2] = seq;
+    p_hdr[3] = flags;
+    LE16_PUT(&p_hdr[4], len);
+}
+
+
+/**@brief Checks and dispatches one complete frame. */
+static void frame_process(uint8_t const * p_frame, bool zero_copy)
+{
+    nus_proto_msg_t msg;
+    uint16_t        crc;
+    uint8_t         status;
+
+    msg.type   = p_frame[1];
+    msg.seq    = p_frame[2];
+    msg.flags  = p_frame[3];
+    msg.len    = LE16_GET(&p_frame[4]);
+    msg.p_data = &p_frame[NUS_PROTO_HDR_LEN];
+
+    crc = crc16_ccitt(p_frame, NUS_PROTO_HDR_LEN + msg.len);
+    if (crc != LE16_GET(&p_frame[NUS_PROTO_HDR_LEN + msg.len]))
+    {
+        m_stats.crc_errors++;
+        return;
+    }
+
+    m_stats.frames++;
+    if (zero_copy)
+    {
+        m_stats.zero_copy++;
+    }
+
+    if ((msg.type < NUS_PROTO_MAX_TYPES) && (m_handlers[msg.type] != NULL))
+    {
+        m_handlers[msg.type](&msg);
+        status = 0;
+    }
+    else
+    {
+        m_stats.unhandled++;
+        status = 1;
+    }
+
+    if (msg.flags & NUS_PROTO_FLAG_ACK_REQ)
+    {
+        (void)nus_proto_reply(&msg, NUS_PROTO_TYPE_ACK, &status, 1, NUS_PROTO_MIN_MTU);
+    }
+}
+
+
+static void ping_handler(nus_proto_msg_t const * p_msg)
+{
+    if ((p_msg->flags & NUS_PROTO_FLAG_RESPONSE) == 0)
+    {
+        (void)nus_proto_reply(p_msg, NUS_PROTO_TYPE_PING, p_msg->p_data, p_msg->len, NUS_PROTO_MIN_MTU);
+    }
+}
+
+
+void nus_proto_init(nus_proto_raw_handler_t raw_handler, nus_proto_tx_t tx)
+{
+    memset(m_handlers, 0, sizeof(m_handlers));
+    memset(&m_stats, 0, sizeof(m_stats));
+    m_raw_handler = raw_handler;
+    m_tx          = tx;
+    m_tx_seq      = 0;
+    nus_proto_reset();
+
+    m_handlers[NUS_PROTO_TYPE_PING] = ping_handler;
+}
+
+
+bool nus_proto_register(uint8_t type, nus_proto_handler_t handler)
+{
+    if (type >= NUS_PROTO_MAX_TYPES)
+    {
+        return false;
+    }
+    m_handlers[type] = handler;
+    return true;
+}
+
+
+void nus_proto_reset(void)
+{
+    m_rx_pos  = 0;
+    m_rx_need = 0;
+}
+
+
+void nus_proto_input(uint8_t const * p_data, uint16_t len)
+{
+    uint16_t n;
+
+    // Unframed write while idle: legacy text.
+    if ((m_rx_pos == 0) && (len > 0) && (p_data[0] != NUS_PROTO_SYNC))
+    {
+        if (m_raw_handler != NULL)
+        {
+            m_raw_handler(p_data, len);
+        }
+        return;
+    }
+
+    while (len > 0)
+    {
+        if (m_rx_pos == 0)
+        {
+            uint16_t plen;
+
+            if (p_data[0] != NUS_PROTO_SYNC)
+            {
+                m_stats.resync_bytes++;
+                p_data++;
+                len--;
+                continue;
+            }
+
+            // Fast path: the whole frame is inside this write, hand out a view of it.
+            if (len >= NUS_PROTO_HDR_LEN)
+            {
+                plen = LE16_GET(&p_data[4]);
+                if (plen > NUS_PROTO_MAX_PAYLOAD)
+                {
+                    m_stats.len_errors++;
+                    p_data++;
+                    len--;
+                    continue;
+                }
+                if (len >= plen + NUS_PROTO_OVERHEAD)
+                {
+                    frame_process(p_data, true);
+                    p_data += plen + NUS_PROTO_OVERHEAD;
+                    len    -= plen + NUS_PROTO_OVERHEAD;
+                    continue;
+                }
+            }
+        }
+
+        // Slow path: collect the header, then the rest of the frame.
+        if (m_rx_need == 0)
+        {
+            n = NUS_PROTO_HDR_LEN - m_rx_pos;
+            n = (n < len) ? n : len;
+            memcpy(&m_rx_buf[m_rx_pos], p_data, n);
+            m_rx_pos += n;
+            p_data   += n;
+            len      -= n;
+
+            if (m_rx_pos == NUS_PROTO_HDR_LEN)
+            {
+                uint16_t plen = LE16_GET(&m_rx_buf[4]);
+                if (plen > NUS_PROTO_MAX_PAYLOAD)
+                {
+                    m_stats.len_errors++;
+                    nus_proto_reset();
+                    continue;
+                }
+                m_rx_need = plen + NUS_PROTO_OVERHEAD;
+            }
+        }
+        else
+        {
+            n = m_rx_need - m_rx_pos;
+            n = (n < len) ? n : len;
+            memcpy(&m_rx_buf[m_rx_pos], p_data, n);
+            m_rx_pos += n;
+            p_data   += n;
+            len      -= n;
+
+            if (m_rx_pos == m_rx_need)
+            {
+                frame_process(m_rx_buf, false);
+                nus_proto_reset();
+            }
+        }
+    }
+}
+
+
+uint16_t nus_proto_encode(uint8_t type, uint8_t seq, uint8_t flags,
+                          uint8_t const * p_payload, uint16_t len,
+                          uint8_t * p_out, uint16_t out_size)
+{
+    uint16_t crc;
+
+    if ((len > NUS_PROTO_MAX_PAYLOAD) || (out_size < len + NUS_PROTO_OVERHEAD))
+    {
+        return 0;
+    }
+
+    frame_header_fill(p_out, type, seq, flags, len);
+    memcpy(&p_out[NUS_PROTO_HDR_LEN], p_payload, len);
+    crc = crc16_ccitt(p_out, NUS_PROTO_HDR_LEN + len);
+    LE16_PUT(&p_out[NUS_PROTO_HDR_LEN + len], crc);
+
+    return len + NUS_PROTO_OVERHEAD;
+}
+
+
+/**@brief Streams header, payload and CRC through one write-sized chunk buffer. */
+static bool frame_send(uint8_t type, uint8_t seq, uint8_t flags,
+                       uint8_t const * p_payload, uint16_t len, uint16_t mtu)
+{
+    uint8_t         hdr[NUS_PROTO_HDR_LEN];
+    uint8_t         tail[NUS_PROTO_CRC_LEN];
+    uint8_t const * parts[3];
+    uint16_t        part_len[3];
+    uint16_t        crc;
+    uint16_t        fill = 0;
+
+    if ((m_tx == NULL) || (mtu == 0) || (len > NUS_PROTO_MAX_PAYLOAD))
+    {
+        return false;
+    }
+
+    // Short frames are built on the stack, so status replies can come from any task.
+    if (len + NUS_PROTO_OVERHEAD <= NUS_PROTO_MIN_MTU)
+    {
+        uint8_t frame[NUS_PROTO_MIN_MTU];
+        return m_tx(frame, nus_proto_encode(type, seq, flags, p_payload, len, frame, sizeof(frame)));
+    }
+    if (mtu > NUS_PROTO_TX_CHUNK)
+    {
+        mtu = NUS_PROTO_TX_CHUNK;
+    }
+
+    frame_header_fill(hdr, type, seq, flags, len);
+    crc = crc16_ccitt_update(crc16_ccitt(hdr, NUS_PROTO_HDR_LEN), p_payload, len);
+    LE16_PUT(tail, crc);
+
+    parts[0] = hdr;       part_len[0] = NUS_PROTO_HDR_LEN;
+    parts[1] = p_payload; part_len[1] = len;
+    parts[2] = tail;      part_len[2] = NUS_PROTO_CRC_LEN;
+
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        uint8_t const * p   = parts[i];
+        uint16_t        rem = part_len[i];
+
+        while (rem > 0)
+        {
+            uint16_t n = mtu - fill;
+            n = (n < rem) ? n : rem;
+            memcpy(&m_tx_chunk[fill], p, n);
+            fill += n;
+            p    += n;
+            rem  -= n;
+
+            if (fill == mtu)
+            {
+                if (!m_tx(m_tx_chunk, fill))
+                {
+                    return false;
+                }
+                fill = 0;
+            }
+        }
+    }
+
+    return (fill == 0) ? true : m_tx(m_tx_chunk, fill);
+}
+
+
+bool nus_proto_send(uint8_t type, uint8_t flags, uint8_t const * p_payload, uint16_t len, uint16_t mtu)
+{
+    return frame_send(type, m_tx_seq++, flags, p_payload, len, mtu);
+}
+
+
+bool nus_proto_reply(nus_proto_msg_t const * p_req, uint8_t type,
+                     uint8_t const * p_payload, uint16_t len, uint16_t mtu)
+{
+    return frame_send(type, p_req->seq, NUS_PROTO_FLAG_RESPONSE, p_payload, len, mtu);
+}
+
+
+nus_proto_stats_t const * nus_proto_stats_get(void)
+{
+    return &m_stats;
+}
@@ -0,0 +1,131 @@
+/** @file
+ *
+ * @defgroup nus_proto Framed binary protocol over NUS
+ * @{
+ * @ingroup  ble_sdk_app_nus_eval
+ * @brief    Length-prefixed, CRC protected message framing on top of the Nordic UART Service.
+ *
+ * @details  Every message is sent as one frame:
+ *
+ *           | sync | type | seq | flags | len (LE16) | payload[len] | crc16 (LE16) |
+ *
+ *           The CRC is crc16_ccitt() over header and payload. A frame may be split over any
+ *           number of NUS writes and one write may carry several frames. Frames that arrive in a
+ *           single write are dispatched as a view into the SoftDevice buffer, only frames that
+ *           straddle writes are copied into the reassembly buffer. Handlers get a read-only view
+ *           that is valid for the duration of the call.
+ *
+ *           Writes that do not start with the sync byte while no frame is pending are passed to
+ *           the raw handler unchanged, so plain text terminals keep working.
+ */
+
+#ifndef NUS_PROTO_H__
+#define NUS_PROTO_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NUS_PROTO_SYNC                  0xA5                                        /**< First byte of every frame. */
+#define NUS_PROTO_HDR_LEN               6                                           /**< sync, type, seq, flags, len. */
+#define NUS_PROTO_CRC_LEN               2                                           /**< Trailing CRC16. */
+#define NUS_PROTO_OVERHEAD              (NUS_PROTO_HDR_LEN + NUS_PROTO_CRC_LEN)     /**< Framing bytes per message. */
+#define NUS_PROTO_MAX_PAYLOAD           512                                         /**< Largest payload accepted by the receiver. */
+#define NUS_PROTO_MAX_TYPES             32                                          /**< Size of the dispatch table. */
+#define NUS_PROTO_MIN_MTU               20                                          /**< NUS payload with the default ATT MTU. */
+
+#define NUS_PROTO_FLAG_ACK_REQ          (1 << 0)                                    /**< Sender wants an ACK frame back. */
+#define NUS_PROTO_FLAG_RESPONSE         (1 << 1)                                    /**< Frame answers a request with the same seq. */
+
+/**@brief Message types. */
+typedef enum
+{
+    NUS_PROTO_TYPE_ACK          = 0x00,                                             /**< Payload: status byte. */
+    NUS_PROTO_TYPE_TEXT         = 0x01,                                             /**< UTF-8 text for the notification area. */
+    NUS_PROTO_TYPE_PING         = 0x02,                                             /**< Echoed back with NUS_PROTO_FLAG_RESPONSE. */
+} nus_proto_type_t;
+
+/**@brief Receiver statistics. */
+typedef struct
+{
+    uint32_t frames;                                                                /**< Frames dispatched. */
+    uint32_t zero_copy;                                                             /**< Of those, dispatched without copying. */
+    uint32_t crc_errors;                                                            /**< Frames dropped on CRC mismatch. */
+    uint32_t len_errors;                                                            /**< Frames dropped because len > NUS_PROTO_MAX_PAYLOAD. */
+    uint32_t unhandled;                                                             /**< Frames with no registered handler. */
+    uint32_t resync_bytes;                                                          /**< Bytes skipped while looking for sync. */
+} nus_proto_stats_t;
+
+/**@brief View of a received message. Only valid inside the handler. */
+typedef struct
+{
+    uint8_t         type;
+    uint8_t         seq;
+    uint8_t         flags;
+    uint16_t        len;
+    uint8_t const * p_data;
+} nus_proto_msg_t;
+
+typedef void (*nus_proto_handler_t)(nus_proto_msg_t const * p_msg);
+
+/**@brief Called with unframed input, e.g. text typed into a terminal. */
+typedef void (*nus_proto_raw_handler_t)(uint8_t const * p_data, uint16_t len);
+
+/**@brief Transmit hook. Must send @p len bytes (len <= MTU payload) or return false. */
+typedef bool (*nus_proto_tx_t)(uint8_t const * p_data, uint16_t len);
+
+/**@brief Function for initializing the protocol.
+ *
+ * @param[in] raw_handler  Handler for unframed writes, may be NULL.
+ * @param[in] tx           Transmit hook used by nus_proto_send(), may be NULL.
+ */
+void nus_proto_init(nus_proto_raw_handler_t raw_handler, nus_proto_tx_t tx);
+
+/**@brief Function for registering a handler for one message type.
+ *
+ * @return false if @p type is outside the dispatch table.
+ */
+bool nus_proto_register(uint8_t type, nus_proto_handler_t handler);
+
+/**@brief Function for feeding one NUS write into the receiver. */
+void nus_proto_input(uint8_t const * p_data, uint16_t len);
+
+/**@brief Function for dropping a partially received frame, e.g. on disconnect. */
+void nus_proto_reset(void);
+
+/**@brief Function for encoding one frame into a caller supplied buffer.
+ *
+ * @return Frame length, or 0 if @p out_size is too small.
+ */
+uint16_t nus_proto_encode(uint8_t type, uint8_t seq, uint8_t flags,
+                          uint8_t const * p_payload, uint16_t len,
+                          uint8_t * p_out, uint16_t out_size);
+
+/**@brief Function for sending one message, fragmented to @p mtu bytes per write.
+ *
+ * @details The frame is streamed through one write-sized staging buffer, so it is never
+ *          assembled in RAM as a whole. Frames that fit the default MTU (payload up to
+ *          NUS_PROTO_MIN_MTU - NUS_PROTO_OVERHEAD bytes) are built on the stack and may be sent
+ *          from any task; longer frames must all be sent from one context.
+ *
+ * @return false if the transmit hook failed.
+ */
+bool nus_proto_send(uint8_t type, uint8_t flags, uint8_t const * p_payload, uint16_t len, uint16_t mtu);
+
+/**@brief Function for answering a message with the same seq and NUS_PROTO_FLAG_RESPONSE set. */
+bool nus_proto_reply(nus_proto_msg_t const * p_req, uint8_t type,
+                     uint8_t const * p_payload, uint16_t len, uint16_t mtu);
+
+/**@brief Function for reading the receiver statistics. */
+nus_proto_stats_t const * nus_proto_stats_get(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NUS_PROTO_H__
+
+/** @} */
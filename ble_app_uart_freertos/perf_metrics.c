@@ -0,0 +1,461 @@
+/** @file
+ *
+ * @brief    Runtime performance counters and energy estimate, see perf_metrics.h.
+ *
+ * @details  Every counter only grows and a window is the difference of two samples, so the
+ *           counting side never takes a lock. Counters written by one context are plain
+ *           variables, the bus byte and line counters are shared by the LVGL and asset tasks and
+ *           use nrf_atomic. Sleep time, wakeups and the run time counter are only touched with
+ *           the scheduler suspended or from the context switch, which is how they are sampled.
+ */
+
+#include <string.h>
+#include "nrf.h"
+#include "nrf_soc.h"
+#include "nrf_nvic.h"
+#include "nrf_atomic.h"
+#include "app_error.h"
+#include "app_util.h"
+#include "app_util_platform.h"
+#include "ble.h"
+#include "ble_srv_common.h"
+#include "nrf_sdh_ble.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "perf_metrics.h"
+
+#define NRF_LOG_MODULE_NAME perf
+#include "nrf_log.h"
+NRF_LOG_MODULE_REGISTER();
+
+#define PERF_METRICS_BLE_OBSERVER_PRIO  2                                           /**< Service priority, before the application. */
+#define PERF_METRICS_RTC                NRF_RTC1                                    /**< FreeRTOS tick RTC, see xPortSysTickHandler. */
+
+/**@brief Free running counters. */
+typedef struct
+{
+    uint32_t time;                                                                  /**< Run time counter, RTC periods. */
+    uint32_t sleep;                                                                 /**< RTC periods in tickless idle. */
+    uint32_t wakeups;
+    uint32_t frames;
+    uint32_t render_us;
+    uint32_t bus_bytes;
+    uint32_t lines;
+    uint32_t radio_events;
+} counters_t;
+
+static counters_t           m_cnt;                                                  /**< Current values. */
+static counters_t           m_prev;                                                 /**< Values at the start of the window. */
+static uint32_t             m_rtc_last;                                             /**< RTC COUNTER at the previous perf_metrics_rtc_time(). */
+static uint32_t             m_sleep_start;
+static uint32_t             m_render_start;                                         /**< DWT CYCCNT at perf_metrics_render_begin(). */
+static nrf_atomic_u32_t     m_render_max_us;
+static uint8_t              m_seconds;
+
+static TaskStatus_t         m_tasks[PERF_METRICS_MAX_TASKS];
+static UBaseType_t          m_prev_task_num[PERF_METRICS_MAX_TASKS];                /**< xTaskNumber of the tasks in the previous window. */
+static uint32_t             m_prev_task_time[PERF_METRICS_MAX_TASKS];
+static uint8_t              m_prev_task_count;
+static uint32_t             m_prev_task_total;
+
+static perf_metrics_t       m_last;                                                 /**< Last complete window. */
+static perf_metrics_costs_t m_costs = PERF_METRICS_COSTS_DEFAULT;
+
+static uint16_t                 m_service_handle;
+static ble_gatts_char_handles_t m_metrics_handles;
+static ble_gatts_char_handles_t m_costs_handles;
+
+
+/**@brief Radio notification, raised before each radio event. */
+void RADIO_NOTIFICATION_IRQHandler(void)
+{
+    m_cnt.radio_events++;
+}
+
+
+uint32_t perf_metrics_rtc_time(void)
+{
+    uint32_t counter = PERF_METRICS_RTC->COUNTER;
+
+    m_cnt.time += (counter - m_rtc_last) & RTC_COUNTER_COUNTER_Msk;
+    m_rtc_last  = counter;
+
+    return m_cnt.time;
+}
+
+
+void perf_metrics_sleep_begin(void)
+{
+    m_sleep_start = perf_metrics_rtc_time();
+}
+
+
+void perf_metrics_sleep_end(void)
+{
+    m_cnt.sleep += perf_metrics_rtc_time() - m_sleep_start;
+    m_cnt.wakeups++;
+}
+
+
+void perf_metrics_bus_bytes(uint32_t count)
+{
+    UNUSED_RETURN_VALUE(nrf_atomic_u32_add(&m_cnt.bus_bytes, count));
+}
+
+
+void perf_metrics_lines(uint32_t count)
+{
+    UNUSED_RETURN_VALUE(nrf_atomic_u32_add(&m_cnt.lines, count));
+}
+
+
+void perf_metrics_render_begin(void)
+{
+    m_render_start = DWT->CYCCNT;
+}
+
+
+void perf_metrics_render_end(void)
+{
+    uint32_t us = (DWT->CYCCNT - m_render_start) / (SystemCoreClock / 1000000);
+
+    m_cnt.render_us += us;
+    m_cnt.frames++;
+    if (us > m_render_max_us)
+    {
+        m_render_max_us = us;                                                       // A window closing in between may keep it, harmless.
+    }
+}
+
+
+uint32_t perf_metrics_charge(perf_metrics_t const * p_metrics, perf_metrics_costs_t const * p_costs)
+{
+    uint64_t sleep_ms = (uint64_t)p_metrics->window_ms * p_metrics->sleep_permille / 1000;
+    uint64_t pc;
+
+    if (p_metrics->window_ms == 0)
+    {
+        return 0;
+    }
+
+    // nA * ms and the event charges are both pC; pC per ms is nA, i.e. nAh per hour.
+    pc  = (uint64_t)p_costs->run_na   * (p_metrics->window_ms - sleep_ms);
+    pc += (uint64_t)p_costs->sleep_na * sleep_ms;
+    pc += (uint64_t)p_costs->byte_pc   * p_metrics->bus_bytes;
+    pc += (uint64_t)p_costs->line_pc   * p_metrics->lines;
+    pc += (uint64_t)p_costs->radio_pc  * p_metrics->radio_events;
+    pc += (uint64_t)p_costs->wakeup_pc * p_metrics->wakeups;
+
+    return (uint32_t)(pc / p_metrics->window_ms);
+}
+
+
+uint16_t perf_metrics_encode(perf_metrics_t const * p_metrics, uint8_t * p_out)
+{
+    uint16_t len = 0;
+
+    p_out[len++] = PERF_METRICS_VERSION;
+    p_out[len++] = p_metrics->task_count;
+    len += uint32_encode(p_metrics->window_ms, &p_out[len]);
+    len += uint32_encode(p_metrics->frames, &p_out[len]);
+    len += uint32_encode(p_metrics->render_avg_us, &p_out[len]);
+    len += uint32_encode(p_metrics->render_max_us, &p_out[len]);
+    len += uint32_encode(p_metrics->bus_bytes, &p_out[len]);
+    len += uint32_encode(p_metrics->lines, &p_out[len]);
+    len += uint32_encode(p_metrics->radio_events, &p_out[len]);
+    len += uint32_encode(p_metrics->wakeups, &p_out[len]);
+    len += uint16_encode(p_metrics->sleep_permille, &p_out[len]);
+    len += uint32_encode(p_metrics->charge_nah, &p_out[len]);
+
+    for (uint8_t i = 0; i < p_metrics->task_count; i++)
+    {
+        memcpy(&p_out[len], p_metrics->tasks[i].name, PERF_METRICS_TASK_NAME_LEN);
+        len += PERF_METRICS_TASK_NAME_LEN;
+        len += uint16_encode(p_metrics->tasks[i].cpu_permille, &p_out[len]);
+    }
+
+    return len;
+}
+
+
+static uint16_t costs_encode(perf_metrics_costs_t const * p_costs, uint8_t * p_out)
+{
+    uint16_t len = 0;
+
+    len += uint32_encode(p_costs->run_na, &p_out[len]);
+    len += uint32_encode(p_costs->sleep_na, &p_out[len]);
+    len += uint32_encode(p_costs->byte_pc, &p_out[len]);
+    len += uint32_encode(p_costs->line_pc, &p_out[len]);
+    len += uint32_encode(p_costs->radio_pc, &p_out[len]);
+    len += uint32_encode(p_costs->wakeup_pc, &p_out[len]);
+
+    return len;
+}
+
+
+static void costs_decode(uint8_t const * p_in, perf_metrics_costs_t * p_costs)
+{
+    p_costs->run_na    = uint32_decode(&p_in[0]);
+    p_costs->sleep_na  = uint32_decode(&p_in[4]);
+    p_costs->byte_pc   = uint32_decode(&p_in[8]);
+    p_costs->line_pc   = uint32_decode(&p_in[12]);
+    p_costs->radio_pc  = uint32_decode(&p_in[16]);
+    p_costs->wakeup_pc = uint32_decode(&p_in[20]);
+}
+
+
+/**@brief Fills the task list of a window from the run time stats. */
+static void tasks_sample(perf_metrics_t * p_metrics)
+{
+    uint32_t    total = m_prev_task_total;                                          // Not written if there are too many tasks.
+    uint32_t    elapsed;
+    UBaseType_t n = uxTaskGetSystemState(m_tasks, PERF_METRICS_MAX_TASKS, &total);
+
+    elapsed = total - m_prev_task_total;
+    for (UBaseType_t i = 0; (i < n) && (elapsed > 0); i++)
+    {
+        uint32_t time = m_tasks[i].ulRunTimeCounter;
+
+        for (uint8_t j = 0; j < m_prev_task_count; j++)
+        {
+            if (m_prev_task_num[j] == m_tasks[i].xTaskNumber)
+            {
+                time -= m_prev_task_time[j];
+                break;
+            }
+        }
+
+        memcpy(p_metrics->tasks[i].name, m_tasks[i].pcTaskName,
+               strnlen(m_tasks[i].pcTaskName, PERF_METRICS_TASK_NAME_LEN));
+        p_metrics->tasks[i].cpu_permille = (uint16_t)((uint64_t)time * 1000 / elapsed);
+        p_metrics->task_count++;
+    }
+
+    for (UBaseType_t i = 0; i < n; i++)
+    {
+        m_prev_task_num[i]  = m_tasks[i].xTaskNumber;
+        m_prev_task_time[i] = m_tasks[i].ulRunTimeCounter;
+    }
+    m_prev_task_count = (uint8_t)n;
+    m_prev_task_total = total;
+}
+
+
+/**@brief Closes the current window, publishes and prints it. */
+static void window_close(void)
+{
+    static uint8_t       value[PERF_METRICS_MAX_LEN];
+    perf_metrics_t       m;
+    perf_metrics_costs_t costs;
+    counters_t           cnt;
+    uint32_t             ticks;
+
+    memset(&m, 0, sizeof(m));
+
+    vTaskSuspendAll();
+    UNUSED_RETURN_VALUE(perf_metrics_rtc_time());
+    cnt = m_cnt;
+    UNUSED_RETURN_VALUE(xTaskResumeAll());
+
+    ticks = cnt.time - m_prev.time;
+    if (ticks == 0)
+    {
+        return;
+    }
+
+    m.window_ms      = (uint32_t)((uint64_t)ticks * 1000 / configTICK_RATE_HZ);
+    m.frames         = cnt.frames - m_prev.frames;
+    m.render_avg_us  = (m.frames > 0) ? (cnt.render_us - m_prev.render_us) / m.frames : 0;
+    m.render_max_us  = nrf_atomic_u32_fetch_store(&m_render_max_us, 0);
+    m.bus_bytes      = cnt.bus_bytes - m_prev.bus_bytes;
+    m.lines          = cnt.lines - m_prev.lines;
+    m.radio_events   = cnt.radio_events - m_prev.radio_events;
+    m.wakeups        = cnt.wakeups - m_prev.wakeups;
+    m.sleep_permille = (uint16_t)((uint64_t)(cnt.sleep - m_prev.sleep) * 1000 / ticks);
+    m_prev           = cnt;
+
+    tasks_sample(&m);
+
+    perf_metrics_costs_get(&costs);
+    m.charge_nah = perf_metrics_charge(&m, &costs);
+
+    taskENTER_CRITICAL();
+    m_last = m;
+    taskEXIT_CRITICAL();
+
+    if (m_metrics_handles.value_handle != BLE_GATT_HANDLE_INVALID)
+    {
+        ble_gatts_value_t gatts_value =
+        {
+            .len     = perf_metrics_encode(&m, value),
+            .offset  = 0,
+            .p_value = value,
+        };
+        UNUSED_RETURN_VALUE(sd_ble_gatts_value_set(BLE_CONN_HANDLE_INVALID, m_metrics_handles.value_handle,
+                                                   &gatts_value));
+    }
+
+#if PERF_METRICS_LOG_WINDOWS
+    perf_metrics_print();
+#endif
+}
+
+
+void perf_metrics_tick(void)
+{
+    if (++m_seconds < PERF_METRICS_WINDOW_S)
+    {
+        return;
+    }
+    m_seconds = 0;
+    window_close();
+}
+
+
+void perf_metrics_get(perf_metrics_t * p_metrics)
+{
+    taskENTER_CRITICAL();
+    *p_metrics = m_last;
+    taskEXIT_CRITICAL();
+}
+
+
+void perf_metrics_print(void)
+{
+    perf_metrics_t m;
+    uint32_t       ms;
+
+    perf_metrics_get(&m);
+    ms = (m.window_ms > 0) ? m.window_ms : 1;
+
+    NRF_LOG_INFO("%u ms: %u frames, render avg %u us, max %u us.",
+                 m.window_ms, m.frames, m.render_avg_us, m.render_max_us);
+    NRF_LOG_INFO("Bus %u B, %u lines, %u radio events/min, %u wakeups/min.",
+                 m.bus_bytes, m.lines,
+                 (uint32_t)((uint64_t)m.radio_events * 60000 / ms),
+                 (uint32_t)((uint64_t)m.wakeups * 60000 / ms));
+    NRF_LOG_INFO("Sleep %u permille, charge %u nAh per hour.", m.sleep_permille, m.charge_nah);
+
+    for (uint8_t i = 0; i < m.task_count; i++)
+    {
+        char name[PERF_METRICS_TASK_NAME_LEN + 1];
+
+        memcpy(name, m.tasks[i].name, PERF_METRICS_TASK_NAME_LEN);
+        name[PERF_METRICS_TASK_NAME_LEN] = '\0';
+        NRF_LOG_INFO("  %s %u permille", NRF_LOG_PUSH(name), m.tasks[i].cpu_permille);
+    }
+}
+
+
+void perf_metrics_costs_set(perf_metrics_costs_t const * p_costs)
+{
+    taskENTER_CRITICAL();
+    m_costs = *p_costs;
+    taskEXIT_CRITICAL();
+}
+
+
+void perf_metrics_costs_get(perf_metrics_costs_t * p_costs)
+{
+    taskENTER_CRITICAL();
+    *p_costs = m_costs;
+    taskEXIT_CRITICAL();
+}
+
+
+/**@brief Takes new costs written by the peer. */
+static void on_ble_evt(ble_evt_t const * p_ble_evt, void * p_context)
+{
+    ble_gatts_evt_write_t const * p_write = &p_ble_evt->evt.gatts_evt.params.write;
+    perf_metrics_costs_t          costs;
+
+    UNUSED_PARAMETER(p_context);
+
+    if ((p_ble_evt->header.evt_id == BLE_GATTS_EVT_WRITE) &&
+        (p_write->handle == m_costs_handles.value_handle) &&
+        (p_write->offset == 0) && (p_write->len == PERF_METRICS_COSTS_LEN))
+    {
+        costs_decode(p_write->data, &costs);
+        perf_metrics_costs_set(&costs);
+        NRF_LOG_INFO("Costs set.");
+    }
+}
+
+NRF_SDH_BLE_OBSERVER(m_perf_metrics_obs, PERF_METRICS_BLE_OBSERVER_PRIO, on_ble_evt, NULL);
+
+
+static void service_init(void)
+{
+    static uint8_t        costs_value[PERF_METRICS_COSTS_LEN];
+    ret_code_t            err_code;
+    ble_uuid128_t         base_uuid = {PERF_METRICS_UUID_BASE};
+    ble_uuid_t            uuid;
+    ble_add_char_params_t params;
+
+    err_code = sd_ble_uuid_vs_add(&base_uuid, &uuid.type);
+    APP_ERROR_CHECK(err_code);
+
+    uuid.uuid = PERF_METRICS_UUID_SERVICE;
+    err_code  = sd_ble_gatts_service_add(BLE_GATTS_SRVC_TYPE_PRIMARY, &uuid, &m_service_handle);
+    APP_ERROR_CHECK(err_code);
+
+    memset(&params, 0, sizeof(params));
+    params.uuid              = PERF_METRICS_UUID_METRICS_CHAR;
+    params.uuid_type         = uuid.type;
+    params.max_len           = PERF_METRICS_MAX_LEN;
+    params.init_len          = 0;
+    params.is_var_len        = true;
+    params.char_props.read   = 1;
+    params.read_access       = SEC_OPEN;
+
+    err_code = characteristic_add(m_service_handle, &params, &m_metrics_handles);
+    APP_ERROR_CHECK(err_code);
+
+    memset(&params, 0, sizeof(params));
+    params.uuid              = PERF_METRICS_UUID_COSTS_CHAR;
+    params.uuid_type         = uuid.type;
+    params.max_len           = PERF_METRICS_COSTS_LEN;
+    params.init_len          = costs_encode(&m_costs, costs_value);
+    params.p_init_value      = costs_value;
+    params.char_props.read   = 1;
+    params.char_props.write  = 1;
+    params.read_access       = SEC_OPEN;
+    params.write_access      = SEC_OPEN;
+
+    err_code = characteristic_add(m_service_handle, &params, &m_costs_handles);
+    APP_ERROR_CHECK(err_code);
+}
+
+
+static void radio_notification_init(void)
+{
+    ret_code_t err_code;
+
+    err_code = sd_nvic_ClearPendingIRQ(RADIO_NOTIFICATION_IRQn);
+    APP_ERROR_CHECK(err_code);
+
+    err_code = sd_nvic_SetPriority(RADIO_NOTIFICATION_IRQn, APP_IRQ_PRIORITY_LOW);
+    APP_ERROR_CHECK(err_code);
+
+    err_code = sd_nvic_EnableIRQ(RADIO_NOTIFICATION_IRQn);
+    APP_ERROR_CHECK(err_code);
+
+    err_code = sd_radio_notification_cfg_set(NRF_RADIO_NOTIFICATION_TYPE_INT_ON_ACTIVE,
+                                             NRF_RADIO_NOTIFICATION_DISTANCE_800US);
+    APP_ERROR_CHECK(err_code);
+}
+
+
+void perf_metrics_init(perf_metrics_costs_t const * p_costs)
+{
+    if (p_costs != NULL)
+    {
+        m_costs = *p_costs;
+    }
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL        |= DWT_CTRL_CYCCNTENA_Msk;
+
+    service_init();
+    radio_notification_init();
+}
@@ -0,0 +1,179 @@
+/** @file
+ *
+ * @defgroup perf_metrics Runtime performance counters and energy estimate
+ * @{
+ * @ingroup  ble_sdk_app_nus_eval
+ * @brief    Per-window CPU, display and radio activity, combined into an estimated charge per hour.
+ *
+ * @details  Counters run freely and are sampled once per window (PERF_METRICS_WINDOW_S, driven by
+ *           perf_metrics_tick() from an existing 1 Hz timer, so the metrics add no wakeups of their
+ *           own). A window reports
+ *           - per-task CPU time from the FreeRTOS run time stats. The run time counter is the
+ *             tick RTC (1/configTICK_RATE_HZ s), so a task is charged the RTC periods that end
+ *             while it runs. This is exact on average over many switches, not per switch,
+ *           - time in tickless idle and the number of wakeups from it (FreeRTOS trace hooks),
+ *           - frames rendered by LVGL and their render time, from the DWT cycle counter. Time
+ *             asleep inside a frame is not counted,
+ *           - bytes sent on the display bus and panel lines refreshed,
+ *           - radio events, from the SoftDevice radio notification on the active signal. It adds
+ *             one short interrupt per radio event.
+ *
+ *           The estimate charges the CPU run and sleep currents for the time spent awake and in
+ *           tickless idle, plus a fixed charge per bus byte, panel line, radio event and wakeup.
+ *           The defaults are rough figures for an nRF52840 on DC/DC with a memory-in-pixel panel;
+ *           calibrate them against a power analyzer before comparing builds by the estimate.
+ *
+ *           The last window is published in a vendor GATT service (read only, encoded as below)
+ *           and printed on the log backend. The costs characteristic reads and writes the costs.
+ *
+ *           Metrics characteristic (little endian):
+ *           | version u8 | tasks u8 | window ms u32 | frames u32 | render avg us u32 |
+ *           | render max us u32 | bus bytes u32 | lines u32 | radio events u32 | wakeups u32 |
+ *           | sleep permille u16 | charge nAh per hour u32 | tasks x (name[4] | cpu permille u16) |
+ *
+ *           Costs characteristic: run nA u32 | sleep nA u32 | byte pC u32 | line pC u32 |
+ *           radio event pC u32 | wakeup pC u32.
+ */
+
+#ifndef PERF_METRICS_H__
+#define PERF_METRICS_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef PERF_METRICS_WINDOW_S
+#define PERF_METRICS_WINDOW_S           10                                          /**< Seconds per window. */
+#endif
+#ifndef PERF_METRICS_LOG_WINDOWS
+#define PERF_METRICS_LOG_WINDOWS        1                                           /**< Print every window on the log backend. */
+#endif
+
+#define PERF_METRICS_MAX_TASKS          8                                           /**< Tasks reported. With more tasks no task is reported. */
+#define PERF_METRICS_TASK_NAME_LEN      4                                           /**< Name characters reported, as configMAX_TASK_NAME_LEN. */
+#define PERF_METRICS_VERSION            1                                           /**< First byte of the metrics characteristic. */
+#define PERF_METRICS_HDR_LEN            40                                          /**< Encoded metrics without tasks. */
+#define PERF_METRICS_TASK_LEN           (PERF_METRICS_TASK_NAME_LEN + 2)            /**< Encoded size of one task. */
+#define PERF_METRICS_MAX_LEN            (PERF_METRICS_HDR_LEN + PERF_METRICS_MAX_TASKS * PERF_METRICS_TASK_LEN)
+#define PERF_METRICS_COSTS_LEN          24                                          /**< Encoded costs. */
+
+#define PERF_METRICS_UUID_BASE          {0x94, 0x0A, 0x1E, 0x6D, 0x7C, 0x2B, 0x3F, 0x9A, \
+                                         0x5E, 0x4D, 0x1B, 0x5C, 0x00, 0x00, 0xA8, 0xF3}
+#define PERF_METRICS_UUID_SERVICE       0x0001
+#define PERF_METRICS_UUID_METRICS_CHAR  0x0002
+#define PERF_METRICS_UUID_COSTS_CHAR    0x0003
+
+/**@brief Default costs: CPU running from flash, System ON idle with the RTC, SPIM at 2 MHz, one
+ *        panel line, one connection event, HFCLK start and exit from sleep.
+ */
+#define PERF_METRICS_COSTS_DEFAULT      { 3300000, 3200, 2000, 300, 7000000, 500000 }
+
+/**@brief Charge model. */
+typedef struct
+{
+    uint32_t run_na;                                                                /**< Current while the CPU runs. */
+    uint32_t sleep_na;                                                              /**< Current in tickless idle. */
+    uint32_t byte_pc;                                                               /**< Charge per display bus byte. */
+    uint32_t line_pc;                                                               /**< Charge per panel line refreshed. */
+    uint32_t radio_pc;                                                              /**< Charge per radio event. */
+    uint32_t wakeup_pc;                                                             /**< Charge per wakeup from tickless idle. */
+} perf_metrics_costs_t;
+
+/**@brief CPU time of one task in a window. */
+typedef struct
+{
+    char     name[PERF_METRICS_TASK_NAME_LEN];                                      /**< Not zero terminated if 4 characters long. */
+    uint16_t cpu_permille;
+} perf_metrics_task_t;
+
+/**@brief One window. */
+typedef struct
+{
+    uint32_t            window_ms;
+    uint32_t            frames;                                                     /**< LVGL refreshes that drew something. */
+    uint32_t            render_avg_us;
+    uint32_t            render_max_us;
+    uint32_t            bus_bytes;                                                  /**< Display bus bytes, headers included. */
+    uint32_t            lines;                                                      /**< Panel lines refreshed. */
+    uint32_t            radio_events;
+    uint32_t            wakeups;                                                    /**< Exits from tickless idle. */
+    uint16_t            sleep_permille;                                             /**< Time in tickless idle. */
+    uint32_t            charge_nah;                                                 /**< Estimated charge per hour, i.e. average current in nA. */
+    uint8_t             task_count;
+    perf_metrics_task_t tasks[PERF_METRICS_MAX_TASKS];
+} perf_metrics_t;
+
+/**@brief Function for starting the counters and adding the GATT service.
+ *
+ * @details Call once the SoftDevice is enabled, e.g. from services_init().
+ *
+ * @param[in] p_costs  Charge model, NULL for PERF_METRICS_COSTS_DEFAULT.
+ */
+void perf_metrics_init(perf_metrics_costs_t const * p_costs);
+
+/**@brief Function for closing a window every PERF_METRICS_WINDOW_S calls. Call once per second
+ *        from a timer task callback.
+ */
+void perf_metrics_tick(void);
+
+/**@brief Function for reading the last complete window. */
+void perf_metrics_get(perf_metrics_t * p_metrics);
+
+/**@brief Function for printing the last complete window on the log backend. */
+void perf_metrics_print(void);
+
+/**@brief Function for replacing the charge model, applied from the next window. */
+void perf_metrics_costs_set(perf_metrics_costs_t const * p_costs);
+
+/**@brief Function for reading the charge model. */
+void perf_metrics_costs_get(perf_metrics_costs_t * p_costs);
+
+/**@brief Function for estimating the charge per hour of a window.
+ *
+ * @param[in] p_metrics  Window, charge_nah is not used.
+ * @param[in] p_costs    Charge model.
+ *
+ * @return Charge per hour in nAh.
+ */
+uint32_t perf_metrics_charge(perf_metrics_t const * p_metrics, perf_metrics_costs_t const * p_costs);
+
+/**@brief Function for encoding a window as the metrics characteristic.
+ *
+ * @return Encoded length, at most PERF_METRICS_MAX_LEN.
+ */
+uint16_t perf_metrics_encode(perf_metrics_t const * p_metrics, uint8_t * p_out);
+
+/**@brief Function for counting bytes sent or received on the display bus. Any task. */
+void perf_metrics_bus_bytes(uint32_t count);
+
+/**@brief Function for counting panel lines refreshed. Any task. */
+void perf_metrics_lines(uint32_t count);
+
+/**@brief Function for marking the start of a possible frame, before lv_task_handler(). */
+void perf_metrics_render_begin(void);
+
+/**@brief Function for ending a frame, from the LVGL monitor callback. */
+void perf_metrics_render_end(void);
+
+/**@brief FreeRTOS run time counter, portGET_RUN_TIME_COUNTER_VALUE(). The 24-bit tick RTC
+ *        extended to 32 bits.
+ *
+ * @details Only called by the kernel from the context switch, or with the scheduler suspended,
+ *          which never overlap.
+ */
+uint32_t perf_metrics_rtc_time(void);
+
+/**@brief FreeRTOS traceLOW_POWER_IDLE_BEGIN() and traceLOW_POWER_IDLE_END() hooks. */
+void perf_metrics_sleep_begin(void);
+void perf_metrics_sleep_end(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PERF_METRICS_H__
+
+/** @} */
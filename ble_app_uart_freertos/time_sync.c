@@ -0,0 +1,186 @@
+/** @file
+ *
+ * @brief    Time synchronization over NUS, see time_sync.h.
+ *
+ * @details  One sample is buffered between the receive handler (SoftDevice task) and
+ *           time_sync_process(). A newer sample replaces one not yet processed, which is what the
+ *           clock wants anyway. The sequence counter works as a seqlock: the handler makes it odd
+ *           while writing and even when done, and the worker retries a copy the handler overlapped.
+ */
+
+#include <string.h>
+#include "time_sync.h"
+#include "nus_proto.h"
+
+#define LE16_GET(p)                     ((uint16_t)((p)[0] | ((p)[1] << 8)))
+#define LE32_GET(p)                     ((uint32_t)((p)[0] | ((p)[1] << 8) | ((uint32_t)(p)[2] << 16) | ((uint32_t)(p)[3] << 24)))
+#define LE32_PUT(p, v)                  do { (p)[0] = (uint8_t)(v); (p)[1] = (uint8_t)((v) >> 8); \
+                                             (p)[2] = (uint8_t)((v) >> 16); (p)[3] = (uint8_t)((v) >> 24); } while (0)
+
+static time_sync_clock_t const * mp_clock;
+static time_sync_est_t           m_est;
+
+static volatile int64_t          m_rx_remote_ms;                                    /**< Phone time of the pending sample. */
+static volatile uint32_t         m_rx_stamp;                                        /**< Local stamp taken on reception. */
+static volatile uint8_t          m_rx_req_seq;                                      /**< nus_proto seq to answer. */
+static volatile uint8_t          m_rx_seq;                                          /**< Odd while the handler writes a sample, even when stored. */
+static uint8_t                   m_rx_done;                                         /**< m_rx_seq value last processed. */
+
+
+void time_sync_est_init(time_sync_est_t * p_est, int32_t drift_ppb)
+{
+    p_est->last_ms   = 0;
+    p_est->have_last = false;
+    p_est->drift_ppb = drift_ppb;
+    p_est->weight    = 0.0f;
+}
+
+
+int64_t time_sync_est_update(time_sync_est_t * p_est, int64_t local_ms, int64_t remote_ms,
+                             time_sync_status_t * p_status)
+{
+    int64_t offset   = remote_ms - local_ms;
+    int64_t interval = local_ms - p_est->last_ms;
+    bool    had_last = p_est->have_last;
+
+    // The caller steps the clock onto the remote time, which starts the next interval.
+    p_est->last_ms   = remote_ms;
+    p_est->have_last = true;
+    *p_status        = TIME_SYNC_STATUS_STEPPED;
+
+    if (!had_last || (interval < (int64_t)TIME_SYNC_MIN_INTERVAL_MS))
+    {
+        return offset;
+    }
+
+    {
+        int64_t residual = offset * 1000000000LL / interval;
+        float   w        = (float)interval * 1e-3f;
+        int64_t drift;
+
+        if ((residual > TIME_SYNC_MAX_DRIFT_PPB) || (residual < -TIME_SYNC_MAX_DRIFT_PPB))
+        {
+            p_est->weight = 0.0f;                                                   // Time was changed on one side, start over.
+            *p_status     = TIME_SYNC_STATUS_REJECTED;
+            return offset;
+        }
+
+        // Residual variance ~ jitter^2 / interval^2, so weight by interval^2.
+        w             = w * w;
+        p_est->weight = p_est->weight * TIME_SYNC_FORGET + w;
+        drift         = p_est->drift_ppb + (int64_t)((float)residual * (w / p_est->weight));
+
+        if (drift > TIME_SYNC_MAX_DRIFT_PPB)
+        {
+            drift = TIME_SYNC_MAX_DRIFT_PPB;
+        }
+        else if (drift < -TIME_SYNC_MAX_DRIFT_PPB)
+        {
+            drift = -TIME_SYNC_MAX_DRIFT_PPB;
+        }
+        p_est->drift_ppb = (int32_t)drift;
+        *p_status        = TIME_SYNC_STATUS_TRIMMED;
+    }
+
+    return offset;
+}
+
+
+static void reply_send(uint8_t req_seq, time_sync_status_t status, int32_t offset_ms)
+{
+    nus_proto_msg_t req = { .seq = req_seq };
+    uint8_t         payload[9];
+
+    payload[0] = (uint8_t)status;
+    LE32_PUT(&payload[1], (uint32_t)offset_ms);
+    LE32_PUT(&payload[5], (uint32_t)m_est.drift_ppb);
+
+    (void)nus_proto_reply(&req, NUS_PROTO_TYPE_TIME_SYNC, payload, sizeof(payload), NUS_PROTO_MIN_MTU);
+}
+
+
+static void sync_handler(nus_proto_msg_t const * p_msg)
+{
+    uint32_t stamp;
+
+    if ((mp_clock == NULL) || (p_msg->flags & NUS_PROTO_FLAG_RESPONSE))
+    {
+        return;
+    }
+    stamp = mp_clock->stamp();
+
+    if (p_msg->len < 6)
+    {
+        reply_send(p_msg->seq, TIME_SYNC_STATUS_BAD_REQUEST, 0);
+        return;
+    }
+
+    m_rx_seq++;
+    m_rx_remote_ms = (int64_t)LE32_GET(&p_msg->p_data[0]) * 1000 + LE16_GET(&p_msg->p_data[4]);
+    m_rx_stamp     = stamp;
+    m_rx_req_seq   = p_msg->seq;
+    m_rx_seq++;
+
+    mp_clock->wake();
+}
+
+
+void time_sync_init(time_sync_clock_t const * p_clock, int32_t drift_ppb)
+{
+    mp_clock  = p_clock;
+    m_rx_done = m_rx_seq;
+    time_sync_est_init(&m_est, drift_ppb);
+
+    if (mp_clock != NULL)
+    {
+        mp_clock->trim(drift_ppb);
+    }
+    (void)nus_proto_register(NUS_PROTO_TYPE_TIME_SYNC, sync_handler);
+}
+
+
+void time_sync_process(void)
+{
+    time_sync_status_t status;
+    int64_t            offset;
+    int64_t            remote_ms;
+    uint32_t           stamp;
+    uint8_t            req_seq;
+    uint8_t            seq;
+
+    do
+    {
+        seq = m_rx_seq;
+        if ((seq == m_rx_done) || (seq & 1))
+        {
+            return;                                                                 // Nothing new, or the handler wakes us again when done.
+        }
+        remote_ms = m_rx_remote_ms;
+        stamp     = m_rx_stamp;
+        req_seq   = m_rx_req_seq;
+    } while (seq != m_rx_seq);
+    m_rx_done = seq;
+
+    offset = time_sync_est_update(&m_est, mp_clock->stamp_to_ms(stamp), remote_ms, &status);
+    mp_clock->step(offset);
+    if (status == TIME_SYNC_STATUS_TRIMMED)
+    {
+        mp_clock->trim(m_est.drift_ppb);
+    }
+
+    if (offset > INT32_MAX)
+    {
+        offset = INT32_MAX;
+    }
+    else if (offset < INT32_MIN)
+    {
+        offset = INT32_MIN;
+    }
+    reply_send(req_seq, status, (int32_t)offset);
+}
+
+
+int32_t time_sync_drift_get(void)
+{
+    return m_est.drift_ppb;
+}
@@ -0,0 +1,112 @@
+/** @file
+ *
+ * @defgroup time_sync Time synchronization over NUS
+ * @{
+ * @ingroup  ble_sdk_app_nus_eval
+ * @brief    Sets the calendar from phone time samples and learns the oscillator drift.
+ *
+ * @details  The phone sends TIME_SYNC with its UTC time. The receive handler only stamps the
+ *           local clock and hands the sample to time_sync_process(), which runs in the context
+ *           that owns the clock (the calendar timer task on the BLE board). There the offset
+ *           between phone and watch is measured, the local clock is stepped onto the phone time
+ *           and the drift estimate is updated.
+ *
+ *           The estimator sees the clock after correction, so the offset found at a sync is the
+ *           residual error of the current estimate accumulated since the previous sync. Residuals
+ *           are folded into the estimate with a weight growing with the square of the interval,
+ *           since the link latency jitter is roughly constant and longer intervals measure the
+ *           rate more precisely. Older residuals are slowly forgotten to follow temperature.
+ *           Samples closer than TIME_SYNC_MIN_INTERVAL_MS only step the clock.
+ *
+ *           Payloads (little endian):
+ *           - TIME_SYNC:       seconds since 1970 u32, milliseconds u16.
+ *           - TIME_SYNC reply: status u8, offset ms i32, drift ppb i32.
+ */
+
+#ifndef TIME_SYNC_H__
+#define TIME_SYNC_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NUS_PROTO_TYPE_TIME_SYNC        0x18                                        /**< Message type on top of nus_proto. */
+
+#define TIME_SYNC_MIN_INTERVAL_MS       (10UL * 60 * 1000)                          /**< Shorter intervals do not update the drift. */
+#define TIME_SYNC_MAX_DRIFT_PPB         500000                                      /**< Larger residuals are taken as a time change, not drift. */
+#define TIME_SYNC_FORGET                0.9f                                        /**< Weight kept from earlier residuals per sync. */
+
+/**@brief OSC1 frequency error in mHz for a drift estimate, as taken by seRTC_TheoreticalRegulationTrim().
+ *
+ * @details A positive drift means the local clock runs slow, i.e. a negative frequency error.
+ */
+#define TIME_SYNC_PPB_TO_OSC1_MHZ(ppb)  ((int16_t)(-((int64_t)(ppb) * 32768) / 1000000))
+
+/**@brief Status byte of the TIME_SYNC reply. */
+typedef enum
+{
+    TIME_SYNC_STATUS_STEPPED     = 0,                                               /**< Clock set, drift not updated. */
+    TIME_SYNC_STATUS_TRIMMED     = 1,                                               /**< Clock set and drift updated. */
+    TIME_SYNC_STATUS_REJECTED    = 2,                                               /**< Residual too large for drift, estimate restarted. */
+    TIME_SYNC_STATUS_BAD_REQUEST = 3,                                               /**< Malformed message. */
+} time_sync_status_t;
+
+/**@brief Drift estimator state. */
+typedef struct
+{
+    int64_t  last_ms;                                                               /**< Local time right after the previous sync. */
+    bool     have_last;
+    int32_t  drift_ppb;                                                             /**< Correction in use, positive if the oscillator is slow. */
+    float    weight;                                                                /**< Accumulated residual weight. */
+} time_sync_est_t;
+
+/**@brief Local clock access. */
+typedef struct
+{
+    uint32_t (*stamp)(void);                                                        /**< Any context: raw timestamp of the reception. */
+    int64_t  (*stamp_to_ms)(uint32_t stamp);                                        /**< Corrected local time at @p stamp, ms since 1970. */
+    void     (*step)(int64_t offset_ms);                                            /**< Moves the local time by @p offset_ms. */
+    void     (*trim)(int32_t drift_ppb);                                            /**< Applies a new rate correction. */
+    void     (*wake)(void);                                                         /**< Schedules time_sync_process() in the clock context. */
+} time_sync_clock_t;
+
+/**@brief Function for resetting an estimator.
+ *
+ * @param[out] p_est      Estimator.
+ * @param[in]  drift_ppb  Initial correction, e.g. a value saved before the last reset.
+ */
+void time_sync_est_init(time_sync_est_t * p_est, int32_t drift_ppb);
+
+/**@brief Function for feeding one sample into an estimator.
+ *
+ * @details The caller is expected to step the local clock by the returned offset.
+ *
+ * @param[in,out] p_est      Estimator.
+ * @param[in]     local_ms   Corrected local time of the sample.
+ * @param[in]     remote_ms  Reference time of the sample.
+ * @param[out]    p_status   TIME_SYNC_STATUS_STEPPED, _TRIMMED or _REJECTED.
+ *
+ * @return Offset remote - local in ms.
+ */
+int64_t time_sync_est_update(time_sync_est_t * p_est, int64_t local_ms, int64_t remote_ms,
+                             time_sync_status_t * p_status);
+
+/**@brief Function for initializing the service and registering its message handler. */
+void time_sync_init(time_sync_clock_t const * p_clock, int32_t drift_ppb);
+
+/**@brief Function for handling a received sample, call from the clock context after wake. */
+void time_sync_process(void);
+
+/**@brief Function for reading the current drift estimate. */
+int32_t time_sync_drift_get(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TIME_SYNC_H__
+
+/** @} */
@@ -0,0 +1,1458 @@
+/** @file
+ *
+ * @brief    Graphics primitive benchmark, see gfx_bench.h.
+ */
+
+#ifdef GFX_BENCH
+
+#ifndef SE_HCL_TRACE
+#error "gfx_bench counts transactions with the HCL tracer, define SE_HCL_TRACE"
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include "gfx_bench.h"
+#include "s1d13c00_hcl.h"
+#include "s1d13c00_memregs.h"
+#include "s1d13c00_trace.h"
+#include "se_common.h"
+#include "se_dmac.h"
+#include "se_mdc.h"
+#include "semdc_anim.h"
+#include "semdc_gfx.h"
+#include "semdc_layer.h"
+#include "semdc_pack.h"
+#include "semdc_text.h"
+#ifdef SE_HCL_HOST
+#include <time.h>
+#include "s1d13c00_emu.h"
+#endif
+
+#define BENCH_FG                0xFF                        /**< Pen color. */
+#define BENCH_BG                0x00                        /**< Clear color. */
+
+#define BENCH_BMP_OFS           0x0000                      /**< Rot-scale source bitmap, from m_scratch. */
+#define BENCH_FONT_OFS          0x0400                      /**< External font. */
+#define BENCH_STRBUF_OFS        0x2000                      /**< PutString copy buffer. */
+#define BENCH_DASH_OFS          BENCH_STRBUF_OFS            /**< Dash sprites, free until the string cases. */
+#define BENCH_DMA_OFS           0x3000                      /**< DMAC descriptors, 1 KB aligned. */
+#define BENCH_HANDS_OFS         0x3400                      /**< Clock hand sprites. */
+#define BENCH_FACE_OFS          0x3800                      /**< Clock face under the hand sprites. */
+#define BENCH_LAYER_OFS         BENCH_FACE_OFS              /**< Layer pool, over the face as the watch cases run last. */
+#define BENCH_DIAL_OFS          BENCH_FACE_OFS              /**< Unpacked dial, over the face after the hand cases. */
+
+#define BENCH_BMP_W             32                          /**< Rot-scale source bitmap size. */
+#define BENCH_BMP_STRIDE        ((BENCH_BMP_W >> 3) + 1)    /**< Bytes per 1-bit bitmap row. */
+
+#define FONT_FIRST              0x20                        /**< First character of the test font. */
+#define FONT_CHARS              95                          /**< Printable ASCII. */
+#define FONT_H                  16                          /**< Glyph height. */
+#define FONT_MAX_ROW            2                           /**< Bytes per glyph row, widths 6 to 10. */
+
+#define BENCH_STAR_POINTS       10
+#define BENCH_RAND_POINTS       12
+#define BENCH_HAND_POINTS       5
+#define BENCH_HAND_W            7                           /**< Hand sprite width, at most 15, the pivot is in the middle. */
+#define BENCH_HAND_TAIL         12                          /**< Hand length behind the pivot. */
+#define BENCH_HAND_MAX          120                         /**< Longest hand sprite, tail included. */
+#define BENCH_DATE_W            64                          /**< Date complication size. */
+#define BENCH_TIME_W            80                          /**< Digital time complication size. */
+#define BENCH_COMP_H            20
+#define BENCH_LAYOUTS           1000                        /**< Layouts per rep of layout_rate. */
+#define BENCH_ANIM_FRAMES       30                          /**< Frames per rep of the animation cases. */
+#define BENCH_DIAL_MAX          260                         /**< Largest packed dial side, 260x260 panels. */
+#define BENCH_DIAL_SIZE         (((BENCH_DIAL_MAX >> 3) + 1) * BENCH_DIAL_MAX)
+
+/**@brief A workload: draws one repetition, parameters in p_arg. */
+typedef seStatus (*bench_fn_t)(uint32_t rep, uint16_t const * p_arg);
+
+typedef struct
+{
+    char const * p_name;
+    bench_fn_t   fn;
+    uint16_t     arg[4];
+} bench_case_t;
+
+typedef struct
+{
+    seTRACE_Counters c;
+    uint64_t         gfx_ns;
+    uint64_t         t_ns;
+} bench_snap_t;
+
+typedef struct
+{
+    uint32_t xacts;
+    uint32_t wr_bytes;
+    uint32_t rd_bytes;
+    uint32_t wasted_xacts;
+    uint64_t gfx_ns;
+    uint64_t draw_ns;
+    uint64_t upd_ns;
+    uint32_t lines;
+} bench_result_t;
+
+static uint16_t             m_w;                            /**< Destination window size. */
+static uint16_t             m_h;
+static uint16_t             m_cx;
+static uint16_t             m_cy;
+static uint16_t             m_r;                            /**< Largest radius that fits. */
+static uint32_t             m_scratch;                      /**< Controller RAM after the frame buffer. */
+static int32_t              m_row_min;                      /**< Rows touched by the current workload. */
+static int32_t              m_row_max;
+
+static seMDC_GFX_FontChar   m_font_chars[FONT_CHARS];
+static uint8_t              m_font_px[FONT_CHARS * FONT_MAX_ROW * FONT_H];
+static seMDC_GFX_FontStruct m_font_int;                     /**< Glyphs in host memory. */
+static seMDC_GFX_FontStruct m_font_ext;                     /**< Glyphs in controller memory. */
+
+static uint32_t             m_star_buf[(sizeof(seMDC_GFX_PolygonStruct) + BENCH_STAR_POINTS * sizeof(seMDC_GFX_Point) + 3) / 4];
+static uint32_t             m_rand_buf[(sizeof(seMDC_GFX_PolygonStruct) + BENCH_RAND_POINTS * sizeof(seMDC_GFX_Point) + 3) / 4];
+static uint32_t             m_hand_buf[(sizeof(seMDC_GFX_PolygonStruct) + BENCH_HAND_POINTS * sizeof(seMDC_GFX_Point) + 3) / 4];
+static seMDC_GFX_Sprite     m_hands[3];                     /**< Hour, minute and second hand. */
+static seMDC_GFX_SpriteBg   m_face;                         /**< Background under the hands. */
+static seMDC_GFX_Sprite     m_dash;                         /**< Dashed line or arc, built in the first rep. */
+static seMDC_ANIM_Object    m_anim[3];                      /**< The hands, animated. */
+static seMDC_LAYER_Layer    m_dial;                         /**< Watch face layers: dial with ticks, */
+static seMDC_LAYER_Layer    m_date;                         /**< date, rendered once, */
+static seMDC_LAYER_Layer    m_time;                         /**< and digital time, rendered every frame. */
+static uint32_t             m_watch_t;                      /**< Time shown by the watch cases, in seconds. */
+static char                 m_time_text[12];
+static char                 m_date_text[] = "19 OCT";
+static seMDC_TEXT_Font      m_text_fonts[2];                /**< Test font, internal then external. */
+static seMDC_TEXT_Run       m_run;                          /**< Laid out by the text cases. */
+static seMDC_TEXT_Run       m_label;
+static uint32_t             m_layouts;                      /**< Layouts done by layout_rate, */
+static uint64_t             m_layout_ns;                    /**< and their CPU time. */
+static uint16_t             m_dial_side;                    /**< 1-bit dial image for the packed image cases, */
+static uint8_t              m_dial_bmp[BENCH_DIAL_SIZE];
+static uint8_t              m_dial_rle[seMDC_PACK_BOUND(BENCH_DIAL_SIZE)];  /**< packed once at start-up. */
+static uint8_t              m_dial_lz[seMDC_PACK_BOUND(BENCH_DIAL_SIZE)];
+static uint32_t             m_dial_rle_len;
+static uint32_t             m_dial_lz_len;
+
+/** cos and sin * 256 in steps of 36 degrees. */
+static int16_t const m_cos36[10] = { 256, 207,  79, -79, -207, -256, -207, -79,   79,  207 };
+static int16_t const m_sin36[10] = {   0, 150, 243, 243,  150,    0, -150, -243, -243, -150 };
+
+/** Directions * 256 in steps of 45 degrees. */
+static int16_t const m_dir45[8][2] =
+{
+    { 256, 0 }, { 181, 181 }, { 0, 256 }, { -181, 181 }, { -256, 0 }, { -181, -181 }, { 0, -256 }, { 181, -181 }
+};
+
+static char m_text[] = "12:34:56 Bench";
+
+
+/**@brief Fixed-seed generator, so every run draws the same shapes. */
+static uint32_t lcg(uint32_t * p_state)
+{
+    *p_state = *p_state * 1664525u + 1013904223u;
+    return *p_state >> 16;
+}
+
+
+static void rows_add(int32_t y0, int32_t y1)
+{
+    if (y0 > y1)
+    {
+        int32_t t = y0;
+        y0 = y1;
+        y1 = t;
+    }
+    if (y0 < m_row_min)
+    {
+        m_row_min = (y0 < 0) ? 0 : y0;
+    }
+    if (y1 > m_row_max)
+    {
+        m_row_max = (y1 >= m_h) ? m_h - 1 : y1;
+    }
+}
+
+
+static seStatus wait_gfx(seStatus status)
+{
+    seMDC_WaitGfxDone();
+    return status;
+}
+
+
+//---------------------------------------------------------------------------
+// Workloads
+//---------------------------------------------------------------------------
+
+/**@brief Engine rectangle; arg: fill. */
+static seStatus bench_rect(uint32_t rep, uint16_t const * p_arg)
+{
+    uint16_t x0 = (uint16_t)(4 + rep);
+    uint16_t y0 = (uint16_t)(4 + rep);
+
+    rows_add(y0, m_cy);
+    return wait_gfx(seMDC_DrawRectangle(x0, y0, m_cx, m_cy, BENCH_FG, 2, 2, (uint8_t)p_arg[0]));
+}
+
+
+/**@brief Engine ellipse; arg: fill. */
+static seStatus bench_ellipse(uint32_t rep, uint16_t const * p_arg)
+{
+    uint16_t ry = (uint16_t)(m_r / 2 - rep);
+
+    rows_add(m_cy - ry, m_cy + ry);
+    return wait_gfx(seMDC_DrawEllipse(m_cx, m_cy, m_r - 2, ry, BENCH_FG, 2, 2, (uint8_t)p_arg[0]));
+}
+
+
+/**@brief Fan of 8 lines from the center; arg: thickness, round tips, 1 for seMDC_DrawLine. */
+static seStatus bench_lines(uint32_t rep, uint16_t const * p_arg)
+{
+    seStatus status = seSTATUS_OK;
+    uint16_t len    = (uint16_t)(m_r - p_arg[0] - rep);
+
+    for (uint32_t i = 0; (i < 8) && (status == seSTATUS_OK); i++)
+    {
+        uint16_t x = (uint16_t)(m_cx + m_dir45[i][0] * len / 256);
+        uint16_t y = (uint16_t)(m_cy + m_dir45[i][1] * len / 256);
+
+        rows_add(m_cy, y);
+        if (p_arg[2])
+        {
+            status = wait_gfx(seMDC_DrawLine(m_cx, m_cy, x, y, BENCH_FG, p_arg[0]));
+        }
+        else
+        {
+            status = seMDC_GFX_DrawLine(m_cx, m_cy, x, y, BENCH_FG, p_arg[0], (uint8_t)p_arg[1]);
+        }
+    }
+    return status;
+}
+
+
+/**@brief 8 dashed horizontal lines; arg: thickness, dash, blank. */
+static seStatus bench_dhline(uint32_t rep, uint16_t const * p_arg)
+{
+    seStatus status = seSTATUS_OK;
+
+    for (uint16_t i = 0; (i < 8) && (status == seSTATUS_OK); i++)
+    {
+        uint16_t y = (uint16_t)(8 + i * (m_h - 16) / 8 + rep);
+
+        rows_add(y, y + p_arg[0]);
+        status = seMDC_GFX_DrawDHLine(4, y, m_w - 5, BENCH_FG, p_arg[0], p_arg[1], p_arg[2]);
+    }
+    return status;
+}
+
+
+/**@brief 8 dashed vertical lines; arg: thickness, dash, blank. */
+static seStatus bench_dvline(uint32_t rep, uint16_t const * p_arg)
+{
+    seStatus status = seSTATUS_OK;
+
+    for (uint16_t i = 0; (i < 8) && (status == seSTATUS_OK); i++)
+    {
+        uint16_t x = (uint16_t)(8 + i * (m_w - 16) / 8 + rep);
+
+        status = seMDC_GFX_DrawDVLine(x, 4, m_h - 5, BENCH_FG, p_arg[0], p_arg[1], p_arg[2]);
+    }
+    rows_add(4, m_h - 5);
+    return status;
+}
+
+
+/**@brief The dashed lines of bench_dhline() or bench_dvline() stamped from one dash sprite;
+ *        arg: thickness, dash, blank, vertical.
+ */
+static seStatus bench_dline_sprite(uint32_t rep, uint16_t const * p_arg)
+{
+    seStatus status = seSTATUS_OK;
+    uint16_t vertical = p_arg[3];
+    uint16_t length   = (uint16_t)((vertical ? m_h : m_w) - 8);
+
+    if (rep == 0)
+    {
+        m_dash.color = BENCH_FG;
+        status = seMDC_GFX_DashLineLoad(&m_dash, m_scratch + BENCH_DASH_OFS, length, p_arg[0], p_arg[1], p_arg[2],
+                                        (uint8_t)vertical);
+    }
+    for (uint16_t i = 0; (i < 8) && (status == seSTATUS_OK); i++)
+    {
+        if (vertical)
+        {
+            status = seMDC_GFX_SpriteDraw(&m_dash, (int16_t)(8 + i * (m_w - 16) / 8 + rep), 4, 0);
+        }
+        else
+        {
+            uint16_t y = (uint16_t)(8 + i * (m_h - 16) / 8 + rep);
+
+            rows_add(y, y + p_arg[0]);
+            status = seMDC_GFX_SpriteDraw(&m_dash, 4, (int16_t)y, 0);
+        }
+    }
+    if (vertical)
+    {
+        rows_add(4, m_h - 5);
+    }
+    return status;
+}
+
+
+/**@brief Arc around the center; arg: radius (0 for the largest), sweep in 512ths, thickness. */
+static seStatus bench_arc(uint32_t rep, uint16_t const * p_arg)
+{
+    uint16_t radius = (p_arg[0] != 0) ? p_arg[0] : m_r;
+    uint16_t start  = (uint16_t)(rep * 8);
+    uint16_t end    = (uint16_t)(start + p_arg[1] - 1);
+
+    if (end > 511)
+    {
+        end = 511;
+    }
+    rows_add(m_cy - radius, m_cy + radius);
+    return seMDC_GFX_DrawArc(m_cx, m_cy, radius, p_arg[2], start, end, BENCH_FG);
+}
+
+
+/**@brief Dashed arc, full circle; arg: radius, dash and blank in 512ths. */
+static seStatus bench_darc(uint32_t rep, uint16_t const * p_arg)
+{
+    rows_add(m_cy - p_arg[0], m_cy + p_arg[0]);
+    return seMDC_GFX_DrawDArc(m_cx, m_cy, p_arg[0], 4, (uint16_t)(rep * 4), 511, BENCH_FG, p_arg[1], p_arg[2]);
+}
+
+
+/**@brief Unchanged dashed bezel, full circle, built once and drawn with one copy per frame;
+ *        arg: radius, dash and blank in 512ths.
+ */
+static seStatus bench_darc_sprite(uint32_t rep, uint16_t const * p_arg)
+{
+    seStatus status = seSTATUS_OK;
+
+    if (rep == 0)
+    {
+        m_dash.color = BENCH_FG;
+        status = seMDC_GFX_DashArcLoad(&m_dash, m_scratch + BENCH_DASH_OFS, p_arg[0], 4, 0, 511, p_arg[1], p_arg[2]);
+    }
+    rows_add(m_cy - p_arg[0], m_cy + p_arg[0]);
+    return (status == seSTATUS_OK) ? seMDC_GFX_SpriteDraw(&m_dash, (int16_t)m_cx, (int16_t)m_cy, 0) : status;
+}
+
+
+/**@brief Polygon; arg: 0 for a star, 1 for random points, 2 for a clock hand, thickness, fill. */
+static seStatus bench_polygon(uint32_t rep, uint16_t const * p_arg)
+{
+    static uint32_t * const p_bufs[] = { m_star_buf, m_rand_buf, m_hand_buf };
+    seMDC_GFX_PolygonStruct * p_poly = (seMDC_GFX_PolygonStruct *)p_bufs[p_arg[0]];
+
+    p_poly->thickness  = p_arg[1];
+    p_poly->fillenable = p_arg[2];
+    p_poly->rotval    = (uint16_t)(rep * 13);
+    rows_add(m_cy - m_r, m_cy + m_r);
+    return seMDC_GFX_DrawPolygon(p_poly);
+}
+
+
+/**@brief Rotations of the hour, minute and second hand at a time in seconds. */
+static void hands_rot(uint32_t t, uint16_t rot[3])
+{
+    rot[0] = (uint16_t)((t % 43200) * 512 / 43200);
+    rot[1] = (uint16_t)((t % 3600) * 512 / 3600);
+    rot[2] = (uint16_t)((t % 60) * 512 / 60);
+}
+
+
+/**@brief Three clock hands moved by one second, erased in the background color and redrawn as
+ *        polygon outlines.
+ */
+static seStatus bench_hands_polygon(uint32_t rep, uint16_t const * p_arg)
+{
+    seMDC_GFX_PolygonStruct * p_poly = (seMDC_GFX_PolygonStruct *)m_hand_buf;
+    seStatus status = seSTATUS_OK;
+    uint16_t old[3];
+    uint16_t rot[3];
+
+    (void)p_arg;
+
+    hands_rot(rep * 61, old);
+    hands_rot(rep * 61 + 61, rot);
+    p_poly->thickness  = 2;
+    p_poly->fillenable = 0;
+    for (uint32_t i = 0; (i < 3) && (status == seSTATUS_OK); i++)
+    {
+        p_poly->scaleval = (uint16_t)(m_hands[i].pivoty * 256 / (m_r - 12));
+        p_poly->rotval   = (uint16_t)((512 - old[i]) & 511);        // Counterclockwise
+        p_poly->pencolor = BENCH_BG;
+        status = seMDC_GFX_DrawPolygon(p_poly);
+        if (status == seSTATUS_OK)
+        {
+            p_poly->rotval   = (uint16_t)((512 - rot[i]) & 511);
+            p_poly->pencolor = BENCH_FG;
+            status = seMDC_GFX_DrawPolygon(p_poly);
+        }
+    }
+    rows_add(m_face.top, m_face.top + m_face.height - 1);
+    return status;
+}
+
+
+/**@brief Three clock hand sprites moved by one second: three erases, three rotated copies. */
+static seStatus bench_hands_sprite(uint32_t rep, uint16_t const * p_arg)
+{
+    seStatus status = seSTATUS_OK;
+    uint16_t rot[3];
+
+    (void)p_arg;
+
+    if (m_face.width == 0)
+    {
+        return seSTATUS_NG;                                         // No room for the face.
+    }
+    hands_rot(rep * 61 + 61, rot);
+    for (uint32_t i = 0; (i < 3) && (status == seSTATUS_OK); i++)
+    {
+        status = seMDC_GFX_SpriteErase(&m_hands[i], &m_face);
+    }
+    for (uint32_t i = 0; (i < 3) && (status == seSTATUS_OK); i++)
+    {
+        status = seMDC_GFX_SpriteDraw(&m_hands[i], (int16_t)m_cx, (int16_t)m_cy, rot[i]);
+    }
+    rows_add(m_face.top, m_face.top + m_face.height - 1);
+    return status;
+}
+
+
+/**@brief BENCH_ANIM_FRAMES animation frames of the hand sprites; arg: target frame rate. The second
+ *        hand sweeps, the minute hand steps with ease in and out and the hour hand grows and
+ *        shrinks. draw_us is mostly the wait for the frame slots; the rate reached and the
+ *        frames dropped are reported by an "anim" object after the case.
+ */
+static seStatus bench_anim(uint32_t rep, uint16_t const * p_arg)
+{
+    seStatus status = seSTATUS_OK;
+    uint16_t rot[3];
+
+    if (m_face.width == 0)
+    {
+        return seSTATUS_NG;
+    }
+    if (rep == 0)
+    {
+        if (seMDC_ANIM_Init(&m_face, p_arg[0]) != seSTATUS_OK)
+        {
+            return seSTATUS_NG;
+        }
+        hands_rot(10 * 3600 + 8 * 60, rot);
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            memset(&m_anim[i], 0, sizeof(m_anim[i]));
+            m_anim[i].sprite                  = &m_hands[i];
+            m_anim[i].value[seMDC_ANIM_X]     = m_cx;
+            m_anim[i].value[seMDC_ANIM_Y]     = m_cy;
+            m_anim[i].value[seMDC_ANIM_ROT]   = rot[i];
+            m_anim[i].value[seMDC_ANIM_SCALE] = 256;
+            seMDC_ANIM_Add(&m_anim[i]);
+        }
+        seMDC_ANIM_Start(&m_anim[2], seMDC_ANIM_ROT, rot[2] + 512, 60000, seMDC_ANIM_LINEAR, seMDC_ANIM_LOOP);
+    }
+
+    // New tweens every rep: the minute hand one minute on, the hour hand pulsing
+    seMDC_ANIM_Start(&m_anim[1], seMDC_ANIM_ROT, m_anim[1].value[seMDC_ANIM_ROT] + 512 / 60, 400,
+                     seMDC_ANIM_EASEINOUT, 0);
+    seMDC_ANIM_Start(&m_anim[0], seMDC_ANIM_SCALE, (rep & 1) ? 256 : 224, 500, seMDC_ANIM_EASEOUT, 0);
+    for (uint32_t n = 0; (n < BENCH_ANIM_FRAMES) && (status == seSTATUS_OK); n++)
+    {
+        status = seMDC_ANIM_Frame();
+    }
+    rows_add(m_face.top, m_face.top + m_face.height - 1);
+    return status;
+}
+
+
+/**@brief Minute ticks of an analog clock; arg: first and last tick. */
+static seStatus bench_ticks(uint32_t rep, uint16_t const * p_arg)
+{
+    seMDC_GFX_ClockTicksStruct ticks;
+
+    (void)rep;
+
+    ticks.leftedge       = m_cx - m_r;
+    ticks.rightedge      = m_cx + m_r;
+    ticks.topedge        = m_cy - m_r;
+    ticks.botedge        = m_cy + m_r;
+    ticks.starttimeangle = (uint8_t)p_arg[0];
+    ticks.endtimeangle   = (uint8_t)p_arg[1];
+    ticks.minorlength    = 6;
+    ticks.majorlength    = 14;
+    ticks.minorthickness = 1;
+    ticks.majorthickness = 3;
+    ticks.minorlinecolor = BENCH_FG;
+    ticks.majorlinecolor = BENCH_FG;
+    rows_add(ticks.topedge, ticks.botedge);
+    return seMDC_GFX_DrawClockTicks(&ticks);
+}
+
+
+/**@brief 1-bit bitmap copy rotated by 45 degrees per repetition; arg: scale in 256ths. */
+static seStatus bench_rotscale(uint32_t rep, uint16_t const * p_arg)
+{
+    seMDC_ImgCopyRotScaleCtrl ctrl;
+    uint16_t half = (uint16_t)((BENCH_BMP_W * p_arg[0] / 256) * 181 / 256 + 1);   // Half diagonal
+
+    ctrl.ctrlword             = 0;
+    ctrl.ctrlword_b.bitmapen  = 1;
+    ctrl.ctrlword_b.bitmapfmt = seMDC_BITMAP_1BIT;
+
+    rows_add(m_cy - half, m_cy + half);
+    return wait_gfx(seMDC_ImgCpyRotScale(m_cx, m_cy, m_scratch + BENCH_BMP_OFS,
+                                         BENCH_BMP_W, BENCH_BMP_W, BENCH_BMP_W, BENCH_BMP_W / 2, BENCH_BMP_W / 2,
+                                         BENCH_FG, (uint16_t)((rep * 64) & 511),
+                                         p_arg[0], p_arg[0], p_arg[0], p_arg[0], &ctrl));
+}
+
+
+/**@brief The test string; arg: external font, rotation. */
+static seStatus bench_string(uint32_t rep, uint16_t const * p_arg)
+{
+    seMDC_GFX_PutStr_Params params;
+    seMDC_GFX_FontStruct *  p_font = p_arg[0] ? &m_font_ext : &m_font_int;
+
+    memset(&params, 0, sizeof(params));
+    params.destx       = m_cx;
+    params.desty       = (uint16_t)(m_cy - 20 + rep * 12);
+    params.font1       = p_font;
+    params.extloc1     = (uint8_t)p_arg[0];
+    params.font2       = p_font;
+    params.extloc2     = (uint8_t)p_arg[0];
+    params.textcolor   = BENCH_FG;
+    params.xscale      = 256;
+    params.yscale      = 256;
+    params.justify     = seMDC_GFX_CENTER_JUSTIFIED;
+    params.rotation    = seMDC_GFX_ROTSTRING;
+    params.rotval      = p_arg[1];
+    params.extbuffaddr = m_scratch + BENCH_STRBUF_OFS;
+    params.dmachan     = seDMAC_CH0;
+
+    rows_add((p_arg[1] != 0) ? m_cy - m_r : params.desty - FONT_H, (p_arg[1] != 0) ? m_cy + m_r : params.desty + FONT_H);
+    return seMDC_GFX_PutString(&params, m_text);
+}
+
+
+/**@brief The test string from a glyph run; arg: external font, rotation. Matches string_int_rot
+ *        when rotated, unrotated glyphs are placed without the rounding of each step.
+ */
+static seStatus bench_string_layout(uint32_t rep, uint16_t const * p_arg)
+{
+    seMDC_TEXT_Style style;
+    seStatus         status;
+
+    memset(&m_run, 0, sizeof(m_run));
+    m_run.fonts       = &m_text_fonts[p_arg[0] ? 1 : 0];
+    m_run.numfonts    = 1;
+    m_run.justify     = seMDC_GFX_CENTER_JUSTIFIED;
+    m_run.extbuffaddr = m_scratch + BENCH_STRBUF_OFS;
+    m_run.dmachan     = seDMAC_CH0;
+    status = seMDC_TEXT_Layout(&m_run, m_text);
+    if (status != seSTATUS_OK)
+    {
+        return status;
+    }
+
+    memset(&style, 0, sizeof(style));
+    style.destx     = m_cx;
+    style.desty     = (uint16_t)(m_cy - 20 + rep * 12);
+    style.textcolor = BENCH_FG;
+    style.xscale    = 256;
+    style.yscale    = 256;
+    style.rotation  = seMDC_GFX_ROTSTRING;
+    style.rotval    = p_arg[1];
+
+    rows_add((p_arg[1] != 0) ? m_cy - m_r : style.desty - FONT_H, (p_arg[1] != 0) ? m_cy + m_r : style.desty + FONT_H);
+    return seMDC_TEXT_Draw(&m_run, 0, &style);
+}
+
+
+/**@brief A left-justified clock ticking a second per rep; arg: glyph run. PutString erases and
+ *        draws the whole string, the run only the glyphs after the first changed character.
+ */
+static seStatus bench_time(uint32_t rep, uint16_t const * p_arg)
+{
+    seMDC_GFX_PutStr_Params params;
+    seMDC_TEXT_Style        style;
+    seStatus                status;
+    int32_t                 left, top, right, bottom;
+    char                    text[] = "10:08:30";
+    uint16_t                x = (uint16_t)(m_cx - 40);
+
+    text[7] = (char)('0' + rep % 10);
+    rows_add(m_cy - FONT_H, m_cy + FONT_H);
+    if (p_arg[0] == 0)
+    {
+        (void)wait_gfx(seMDC_DrawRectangle(x - 6, m_cy - FONT_H / 2 - 1, x + 80, m_cy + FONT_H / 2 + 1,
+                                           BENCH_BG, 0, 0, FILL_ENABLE));
+        memset(&params, 0, sizeof(params));
+        params.destx       = x;
+        params.desty       = m_cy;
+        params.font1       = &m_font_int;
+        params.font2       = &m_font_int;
+        params.textcolor   = BENCH_FG;
+        params.xscale      = 256;
+        params.yscale      = 256;
+        params.justify     = seMDC_GFX_LEFT_JUSTIFIED;
+        params.rotation    = seMDC_GFX_ROTSTRING;
+        params.extbuffaddr = m_scratch + BENCH_STRBUF_OFS;
+        params.dmachan     = seDMAC_CH0;
+        return seMDC_GFX_PutString(&params, text);
+    }
+
+    if (rep == 0)
+    {
+        memset(&m_run, 0, sizeof(m_run));
+        m_run.fonts       = &m_text_fonts[0];
+        m_run.numfonts    = 1;
+        m_run.justify     = seMDC_GFX_LEFT_JUSTIFIED;
+        m_run.extbuffaddr = m_scratch + BENCH_STRBUF_OFS;
+        m_run.dmachan     = seDMAC_CH0;
+    }
+    status = seMDC_TEXT_Layout(&m_run, text);
+    if (status != seSTATUS_OK)
+    {
+        return status;
+    }
+
+    memset(&style, 0, sizeof(style));
+    style.destx     = x;
+    style.desty     = m_cy;
+    style.textcolor = BENCH_FG;
+    style.xscale    = 256;
+    style.yscale    = 256;
+    style.rotation  = seMDC_GFX_ROTSTRING;
+    if (seMDC_TEXT_Box(&m_run, &style, &left, &top, &right, &bottom) == 0)
+    {
+        (void)wait_gfx(seMDC_DrawRectangle((uint16_t)left, (uint16_t)top, (uint16_t)right, (uint16_t)bottom,
+                                           BENCH_BG, 0, 0, FILL_ENABLE));
+    }
+    return seMDC_TEXT_Draw(&m_run, m_run.redraw, &style);
+}
+
+
+/**@brief Host CPU time. The emulator's virtual time does not advance without bus traffic, and a
+ *        layout of glyphs in the font cache has none.
+ */
+static uint64_t cpu_ns(void)
+{
+#ifdef SE_HCL_HOST
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#else
+    return seS1D13C00NowNS();
+#endif
+}
+
+
+/**@brief BENCH_LAYOUTS layouts of a ticking clock string and of a static label, without drawing.
+ *        Timed with cpu_ns() into m_layouts and m_layout_ns, reported by put_rate().
+ */
+static seStatus bench_layout_rate(uint32_t rep, uint16_t const * p_arg)
+{
+    seStatus status = seSTATUS_OK;
+    char     text[] = "10:08:00";
+    uint64_t t0;
+
+    (void)p_arg;
+
+    if (rep == 0)
+    {
+        m_layouts   = 0;
+        m_layout_ns = 0;
+        memset(&m_run, 0, sizeof(m_run));
+        m_run.fonts       = &m_text_fonts[0];
+        m_run.numfonts    = 2;
+        m_run.justify     = seMDC_GFX_LEFT_JUSTIFIED;
+        m_run.extbuffaddr = m_scratch + BENCH_STRBUF_OFS;
+        m_run.dmachan     = seDMAC_CH0;
+        m_label = m_run;
+    }
+    t0 = cpu_ns();
+    for (uint32_t n = 0; (n < BENCH_LAYOUTS) && (status == seSTATUS_OK); n++)
+    {
+        uint32_t t = rep * BENCH_LAYOUTS + n;
+
+        text[6] = (char)('0' + t / 10 % 6);
+        text[7] = (char)('0' + t % 10);
+        status = seMDC_TEXT_Layout(&m_run, text);
+        if (status == seSTATUS_OK)
+        {
+            status = seMDC_TEXT_Layout(&m_label, m_text);
+        }
+        m_layouts += 2;
+    }
+    m_layout_ns += cpu_ns() - t0;
+    return status;
+}
+
+
+/**@brief 1-bit dial image written to controller RAM, then drawn at 1:1; arg: seMDC_PACK_METHOD,
+ *        seMDC_PACK_RAW for a plain write. The host unpacks, so wr_bytes are the same for all
+ *        methods; what packing saves is host flash, reported by put_stored().
+ */
+static seStatus bench_dial(uint32_t rep, uint16_t const * p_arg)
+{
+    seMDC_ImgCopyRotScaleCtrl ctrl;
+    seStatus status;
+    uint32_t addr   = m_scratch + BENCH_DIAL_OFS;
+    uint16_t stride = (uint16_t)((m_dial_side >> 3) + 1);
+
+    (void)rep;
+
+    switch (p_arg[0])
+    {
+        case seMDC_PACK_RLE:
+            status = seMDC_PACK_Load(addr, m_dial_rle, m_dial_rle_len);
+            break;
+        case seMDC_PACK_LZ:
+            status = seMDC_PACK_Load(addr, m_dial_lz, m_dial_lz_len);
+            break;
+        default:
+            seS1D13C00Write(addr, m_dial_bmp, (uint32_t)stride * m_dial_side);
+            status = seSTATUS_OK;
+            break;
+    }
+    if (status != seSTATUS_OK)
+    {
+        return status;
+    }
+
+    ctrl.ctrlword             = 0;
+    ctrl.ctrlword_b.bitmapen  = 1;
+    ctrl.ctrlword_b.bitmapfmt = seMDC_BITMAP_1BIT;
+
+    rows_add(m_cy - m_dial_side / 2, m_cy + m_dial_side / 2);
+    return wait_gfx(seMDC_ImgCpyRotScale(m_cx, m_cy, addr, m_dial_side, m_dial_side, m_dial_side,
+                                         m_dial_side / 2, m_dial_side / 2, BENCH_FG, 0,
+                                         256, 256, 256, 256, &ctrl));
+}
+
+
+/**@brief Centered text in the test font, for the watch cases. */
+static seStatus watch_text(uint16_t x, uint16_t y, char * p_text)
+{
+    seMDC_GFX_PutStr_Params params;
+
+    memset(&params, 0, sizeof(params));
+    params.destx       = x;
+    params.desty       = y;
+    params.font1       = &m_font_int;
+    params.font2       = &m_font_int;
+    params.textcolor   = BENCH_FG;
+    params.xscale      = 256;
+    params.yscale      = 256;
+    params.justify     = seMDC_GFX_CENTER_JUSTIFIED;
+    params.rotation    = seMDC_GFX_ROTSTRING;
+    params.extbuffaddr = m_scratch + BENCH_STRBUF_OFS;
+    params.dmachan     = seDMAC_CH0;
+    return seMDC_GFX_PutString(&params, p_text);
+}
+
+
+/**@brief Dial of side pixels with its top left corner at (x, y): background and minute ticks. */
+static seStatus watch_dial(uint16_t x, uint16_t y, uint16_t side)
+{
+    seMDC_GFX_ClockTicksStruct ticks;
+
+    (void)wait_gfx(seMDC_DrawRectangle(x, y, x + side - 1, y + side - 1, BENCH_BG, 0, 0, FILL_ENABLE));
+    ticks.leftedge       = x + 2;
+    ticks.rightedge      = x + side - 3;
+    ticks.topedge        = y + 2;
+    ticks.botedge        = y + side - 3;
+    ticks.starttimeangle = 0;
+    ticks.endtimeangle   = 59;
+    ticks.minorlength    = 6;
+    ticks.majorlength    = 14;
+    ticks.minorthickness = 1;
+    ticks.majorthickness = 3;
+    ticks.minorlinecolor = BENCH_FG;
+    ticks.majorlinecolor = BENCH_FG;
+    return seMDC_GFX_DrawClockTicks(&ticks);
+}
+
+
+/**@brief Digital time of m_watch_t. */
+static void watch_time_text(void)
+{
+    snprintf(m_time_text, sizeof(m_time_text), "%02lu:%02lu:%02lu",
+             (unsigned long)(m_watch_t / 3600 % 24), (unsigned long)(m_watch_t / 60 % 60), (unsigned long)(m_watch_t % 60));
+}
+
+
+static seStatus render_dial(seMDC_LAYER_Layer * p_layer)
+{
+    return watch_dial(0, 0, p_layer->width);
+}
+
+
+static seStatus render_text(seMDC_LAYER_Layer * p_layer)
+{
+    (void)wait_gfx(seMDC_DrawRectangle(0, 0, p_layer->width - 1, p_layer->height - 1, BENCH_BG, 0, 0, FILL_ENABLE));
+    return watch_text(p_layer->width / 2, p_layer->height / 2, (char *)p_layer->arg);
+}
+
+
+/**@brief Watch face one second later, drawn from scratch: dial, ticks, date, digital time and
+ *        three hand sprites.
+ */
+static seStatus bench_watch_redraw(uint32_t rep, uint16_t const * p_arg)
+{
+    seStatus status;
+    uint16_t rot[3];
+
+    (void)p_arg;
+
+    if (m_face.width == 0)
+    {
+        return seSTATUS_NG;
+    }
+    m_watch_t = rep * 61 + 61;
+    watch_time_text();
+    hands_rot(m_watch_t, rot);
+    status = watch_dial((uint16_t)m_face.left, (uint16_t)m_face.top, m_face.width);
+    if (status == seSTATUS_OK)
+    {
+        status = watch_text(m_cx, (uint16_t)(m_cy - 40), m_date_text);
+    }
+    if (status == seSTATUS_OK)
+    {
+        status = watch_text(m_cx, (uint16_t)(m_cy + 40), m_time_text);
+    }
+    for (uint32_t i = 0; (i < 3) && (status == seSTATUS_OK); i++)
+    {
+        status = seMDC_GFX_SpriteDraw(&m_hands[i], (int16_t)m_cx, (int16_t)m_cy, rot[i]);
+    }
+    rows_add(m_face.top, m_face.top + m_face.height - 1);
+    return status;
+}
+
+
+/**@brief Only the digital time band of the watch face redrawn, by drawing the whole face with
+ *        the clip window set to the band. Primitives outside the band cost no transactions.
+ */
+static seStatus bench_watch_band(uint32_t rep, uint16_t const * p_arg)
+{
+    seStatus status;
+    uint16_t top    = (uint16_t)(m_cy + 40 - BENCH_COMP_H / 2);
+    uint16_t bottom = (uint16_t)(top + BENCH_COMP_H - 1);
+
+    (void)p_arg;
+
+    if (m_face.width == 0)
+    {
+        return seSTATUS_NG;
+    }
+    m_watch_t = rep * 61 + 61;
+    watch_time_text();
+    status = seMDC_SetClipWindow((uint16_t)m_face.left, top, (uint16_t)(m_face.left + m_face.width - 1), bottom);
+    if (status == seSTATUS_OK)
+    {
+        status = watch_dial((uint16_t)m_face.left, (uint16_t)m_face.top, m_face.width);
+    }
+    if (status == seSTATUS_OK)
+    {
+        status = watch_text(m_cx, (uint16_t)(m_cy - 40), m_date_text);
+    }
+    if (status == seSTATUS_OK)
+    {
+        status = watch_text(m_cx, (uint16_t)(m_cy + 40), m_time_text);
+    }
+    seMDC_ResetClipWindow();
+    rows_add(top, bottom);
+    return status;
+}
+
+
+/**@brief The same watch face from layers: the dial and date are rendered once, the digital
+ *        time every frame, and the hand boxes are composited back before the hands are drawn.
+ */
+static seStatus bench_watch_layers(uint32_t rep, uint16_t const * p_arg)
+{
+    seMDC_DestWindowParams win;
+    seStatus status = seSTATUS_OK;
+    uint16_t rot[3];
+    uint16_t starty, endy;
+
+    (void)p_arg;
+
+    if (m_face.width == 0)
+    {
+        return seSTATUS_NG;
+    }
+    if (rep == 0)
+    {
+        uint32_t pool = m_scratch + BENCH_LAYER_OFS;
+
+        win.obaseaddr = seS1D13C00Read32(MDC_GFXOBADDR0);
+        win.owidth    = m_w;
+        win.oheight   = m_h;
+        win.ostride   = seS1D13C00Read16(MDC_GFXOSTRIDE);
+        status = seMDC_LAYER_Init(pool, seMDC_RESUME_ADDR - pool, &win, seDMAC_CH0);
+
+        memset(&m_dial, 0, sizeof(m_dial));
+        m_dial.render = render_dial;
+        m_dial.left   = m_face.left;
+        m_dial.top    = m_face.top;
+        m_dial.width  = m_face.width;
+        m_dial.height = m_face.height;
+
+        memset(&m_date, 0, sizeof(m_date));
+        m_date.render = render_text;
+        m_date.arg    = m_date_text;
+        m_date.left   = (int16_t)(m_cx - BENCH_DATE_W / 2);
+        m_date.top    = (int16_t)(m_cy - 40 - BENCH_COMP_H / 2);
+        m_date.width  = BENCH_DATE_W;
+        m_date.height = BENCH_COMP_H;
+
+        memset(&m_time, 0, sizeof(m_time));
+        m_time.render = render_text;
+        m_time.arg    = m_time_text;
+        m_time.left   = (int16_t)(m_cx - BENCH_TIME_W / 2);
+        m_time.top    = (int16_t)(m_cy + 40 - BENCH_COMP_H / 2);
+        m_time.width  = BENCH_TIME_W;
+        m_time.height = BENCH_COMP_H;
+        m_time.flags  = seMDC_LAYER_DYNAMIC;
+
+        if (status == seSTATUS_OK)
+        {
+            status = seMDC_LAYER_Add(&m_dial);
+        }
+        if (status == seSTATUS_OK)
+        {
+            status = seMDC_LAYER_Add(&m_date);
+        }
+        if (status == seSTATUS_OK)
+        {
+            status = seMDC_LAYER_Add(&m_time);
+        }
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            m_hands[i].drawn = 0;
+        }
+    }
+    if (status != seSTATUS_OK)
+    {
+        return status;
+    }
+
+    m_watch_t = rep * 61 + 61;
+    watch_time_text();
+    hands_rot(m_watch_t, rot);
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        if (m_hands[i].drawn)
+        {
+            seMDC_LAYER_Damage(m_hands[i].left, m_hands[i].top, m_hands[i].right, m_hands[i].bottom);
+            m_hands[i].drawn = 0;
+        }
+    }
+    status = seMDC_LAYER_Compose(&starty, &endy);
+    if (endy >= starty)
+    {
+        rows_add(starty, endy);
+    }
+    for (uint32_t i = 0; (i < 3) && (status == seSTATUS_OK); i++)
+    {
+        status = seMDC_GFX_SpriteDraw(&m_hands[i], (int16_t)m_cx, (int16_t)m_cy, rot[i]);
+        rows_add(m_hands[i].top, m_hands[i].bottom);
+    }
+    return status;
+}
+
+
+static bench_case_t const m_cases[] =
+{
+    { "mdc_rect_outline", bench_rect,     { 0 } },
+    { "mdc_rect_fill",    bench_rect,     { 1 } },
+    { "mdc_ellipse",      bench_ellipse,  { 0 } },
+    { "mdc_line_t1",      bench_lines,    { 1, 0, 1 } },
+    { "gfx_line_t3",      bench_lines,    { 3, 0, 0 } },
+    { "gfx_line_t8_round",bench_lines,    { 8, 1, 0 } },
+    { "dhline_t1_d4b2",   bench_dhline,   { 1, 4, 2 } },
+    { "dhline_t3_d8b4",   bench_dhline,   { 3, 8, 4 } },
+    { "dhline_t3_sprite", bench_dline_sprite, { 3, 8, 4, 0 } },
+    { "dvline_t1_d4b2",   bench_dvline,   { 1, 4, 2 } },
+    { "dvline_t3_d8b4",   bench_dvline,   { 3, 8, 4 } },
+    { "dvline_t3_sprite", bench_dline_sprite, { 3, 8, 4, 1 } },
+    { "arc_r20_90",       bench_arc,      { 20, 128, 4 } },
+    { "arc_r60_180",      bench_arc,      { 60, 256, 6 } },
+    { "arc_rmax_360",     bench_arc,      { 0, 512, 8 } },
+    { "darc_r60_16_8",    bench_darc,     { 60, 16, 8 } },
+    { "darc_r60_sprite",  bench_darc_sprite, { 60, 16, 8 } },
+    { "polygon_star",     bench_polygon,  { 0, 2 } },
+    { "polygon_random",   bench_polygon,  { 1, 1 } },
+    { "polygon_star_fill",bench_polygon,  { 0, 0, 1 } },
+    { "polygon_rand_fill",bench_polygon,  { 1, 0, 1 } },
+    { "hand_outline_t2",  bench_polygon,  { 2, 2, 0 } },
+    { "hand_fill",        bench_polygon,  { 2, 0, 1 } },
+    { "hands_polygon",    bench_hands_polygon, { 0 } },
+    { "hands_sprite",     bench_hands_sprite,  { 0 } },
+    { "anim_30fps",       bench_anim,     { 30 } },
+    { "anim_60fps",       bench_anim,     { 60 } },
+    { "clock_ticks",      bench_ticks,    { 0, 59 } },
+    { "rotscale_1x",      bench_rotscale, { 256 } },
+    { "rotscale_2x",      bench_rotscale, { 512 } },
+    { "string_int",       bench_string,   { 0, 0 } },
+    { "string_int_rot",   bench_string,   { 0, 64 } },
+    { "string_ext",       bench_string,   { 1, 0 } },
+    { "string_layout",    bench_string_layout, { 0, 0 } },
+    { "string_layout_rot",bench_string_layout, { 0, 64 } },
+    { "string_layout_ext",bench_string_layout, { 1, 0 } },
+    { "time_putstring",   bench_time,     { 0 } },
+    { "time_layout",      bench_time,     { 1 } },
+    { "layout_rate",      bench_layout_rate, { 0 } },
+    { "dial_raw",         bench_dial,     { seMDC_PACK_RAW } },
+    { "dial_rle",         bench_dial,     { seMDC_PACK_RLE } },
+    { "dial_lz",          bench_dial,     { seMDC_PACK_LZ } },
+    { "watch_redraw",     bench_watch_redraw, { 0 } },
+    { "watch_band",       bench_watch_band,   { 0 } },
+    { "watch_layers",     bench_watch_layers, { 0 } },
+};
+
+
+//---------------------------------------------------------------------------
+// Setup
+//---------------------------------------------------------------------------
+
+/**@brief Builds the test font in host memory and copies it to controller memory. */
+static void font_init(void)
+{
+    uint32_t offset = 0;
+    uint32_t ext    = m_scratch + BENCH_FONT_OFS;
+
+    for (uint32_t c = 0; c < FONT_CHARS; c++)
+    {
+        uint16_t width  = (uint16_t)(6 + c % 5);
+        uint32_t stride = (width >> 3) + 1;
+
+        m_font_chars[c].width     = width;
+        m_font_chars[c].offsetloc = offset;
+        for (uint32_t i = 0; i < stride * FONT_H; i++)
+        {
+            m_font_px[offset + i] = (uint8_t)((FONT_FIRST + c) * 37 + i * 11);
+        }
+        offset += stride * FONT_H;
+    }
+
+    m_font_int.bitmapfmt    = seMDC_BITMAP_1BIT;
+    m_font_int.height       = FONT_H;
+    m_font_int.numchars     = FONT_CHARS;
+    m_font_int.unicode_base = FONT_FIRST;
+    m_font_int.charstbl     = m_font_chars;
+    m_font_int.pxdata       = m_font_px;
+
+    // The library reads external glyph descriptors and pixels by controller address
+    seS1D13C00Write(ext, (uint8_t *)m_font_chars, sizeof(m_font_chars));
+    seS1D13C00Write(ext + sizeof(m_font_chars), m_font_px, offset);
+    m_font_ext          = m_font_int;
+    m_font_ext.charstbl = (seMDC_GFX_FontChar *)(uintptr_t)ext;
+    m_font_ext.pxdata   = (uint8_t *)(uintptr_t)(ext + sizeof(m_font_chars));
+
+    m_text_fonts[0].font   = &m_font_int;
+    m_text_fonts[1].font   = &m_font_ext;
+    m_text_fonts[1].extloc = 1;
+}
+
+
+static void shapes_init(void)
+{
+    seMDC_GFX_PolygonStruct * p_star = (seMDC_GFX_PolygonStruct *)m_star_buf;
+    seMDC_GFX_PolygonStruct * p_rand = (seMDC_GFX_PolygonStruct *)m_rand_buf;
+    seMDC_GFX_PolygonStruct * p_hand = (seMDC_GFX_PolygonStruct *)m_hand_buf;
+    uint8_t  bmp[BENCH_BMP_STRIDE * BENCH_BMP_W];
+    uint32_t seed = 1;
+
+    // Arrow-like pattern, asymmetric so rotation matters
+    for (uint32_t y = 0; y < BENCH_BMP_W; y++)
+    {
+        for (uint32_t b = 0; b < BENCH_BMP_STRIDE; b++)
+        {
+            bmp[y * BENCH_BMP_STRIDE + b] = (b * 8 < y) ? 0xFF : ((y & 3) ? 0x81 : 0x00);
+        }
+    }
+    seS1D13C00Write(m_scratch + BENCH_BMP_OFS, bmp, sizeof(bmp));
+
+    memset(m_star_buf, 0, sizeof(m_star_buf));
+    p_star->numpoints = BENCH_STAR_POINTS;
+    p_star->pencolor  = BENCH_FG;
+    p_star->centerx   = (int16_t)m_cx;
+    p_star->centery   = (int16_t)m_cy;
+    p_star->scaleval  = 256;
+    for (uint32_t i = 0; i < BENCH_STAR_POINTS; i++)
+    {
+        int32_t len = (i & 1) ? m_r * 2 / 5 : m_r - 10;
+
+        p_star->points[i].xcoord = (int16_t)(m_cos36[i] * len / 256);
+        p_star->points[i].ycoord = (int16_t)(m_sin36[i] * len / 256);
+    }
+
+    memset(m_rand_buf, 0, sizeof(m_rand_buf));
+    p_rand->numpoints = BENCH_RAND_POINTS;
+    p_rand->pencolor  = BENCH_FG;
+    p_rand->centerx   = (int16_t)m_cx;
+    p_rand->centery   = (int16_t)m_cy;
+    p_rand->scaleval  = 256;
+    for (uint32_t i = 0; i < BENCH_RAND_POINTS; i++)
+    {
+        p_rand->points[i].xcoord = (int16_t)(lcg(&seed) % (2 * m_r - 20)) - (m_r - 10);
+        p_rand->points[i].ycoord = (int16_t)(lcg(&seed) % (2 * m_r - 20)) - (m_r - 10);
+    }
+
+    // Tapered hand with a pointed tip and a short tail
+    memset(m_hand_buf, 0, sizeof(m_hand_buf));
+    p_hand->numpoints = BENCH_HAND_POINTS;
+    p_hand->pencolor  = BENCH_FG;
+    p_hand->centerx   = (int16_t)m_cx;
+    p_hand->centery   = (int16_t)m_cy;
+    p_hand->scaleval  = 256;
+    p_hand->points[0].xcoord = 0;
+    p_hand->points[0].ycoord = (int16_t)(m_r - 12);
+    p_hand->points[1].xcoord = 5;
+    p_hand->points[1].ycoord = (int16_t)(m_r - 30);
+    p_hand->points[2].xcoord = 4;
+    p_hand->points[2].ycoord = -12;
+    p_hand->points[3].xcoord = -4;
+    p_hand->points[3].ycoord = -12;
+    p_hand->points[4].xcoord = -5;
+    p_hand->points[4].ycoord = (int16_t)(m_r - 30);
+}
+
+
+/**@brief Tapered hand sprites pointing to 12:00, and a face with a dot pattern under them. */
+static void hands_init(void)
+{
+    uint8_t  bmp[BENCH_HAND_MAX * seMDC_GFX_SPRITE_ROWBYTES(BENCH_HAND_W)];
+    uint8_t  row[256];
+    uint32_t addr = m_scratch + BENCH_HANDS_OFS;
+    uint16_t side;
+
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        seMDC_GFX_Sprite * p_hand = &m_hands[i];
+        uint16_t           len    = (uint16_t)(m_r * (4 + 2 * i) / 10);   // Hour, minute, second
+
+        if (len + BENCH_HAND_TAIL > BENCH_HAND_MAX)
+        {
+            len = BENCH_HAND_MAX - BENCH_HAND_TAIL;
+        }
+        memset(p_hand, 0, sizeof(*p_hand));
+        p_hand->width  = BENCH_HAND_W;
+        p_hand->height = len + BENCH_HAND_TAIL;
+        p_hand->pivotx = BENCH_HAND_W / 2;
+        p_hand->pivoty = len;
+        p_hand->color  = BENCH_FG;
+        p_hand->scale  = 256;
+        for (uint32_t y = 0; y < p_hand->height; y++)
+        {
+            // Half width grows from the tip to the pivot and stays in the tail
+            uint32_t half = (y < len) ? (y * (BENCH_HAND_W / 2) + len - 1) / len : BENCH_HAND_W / 2;
+            uint16_t bits = 0;
+
+            for (uint32_t x = 0; x < BENCH_HAND_W; x++)
+            {
+                if ((x + half >= BENCH_HAND_W / 2) && (x <= BENCH_HAND_W / 2 + half))
+                {
+                    bits |= 0x8000 >> x;
+                }
+            }
+            for (uint32_t b = 0; b < seMDC_GFX_SPRITE_ROWBYTES(BENCH_HAND_W); b++)
+            {
+                bmp[y * seMDC_GFX_SPRITE_ROWBYTES(BENCH_HAND_W) + b] = (uint8_t)(bits >> (8 - 8 * b));
+            }
+        }
+        (void)seMDC_GFX_SpriteLoad(p_hand, addr, bmp);
+        addr += seMDC_GFX_SPRITE_ROWBYTES(BENCH_HAND_W) * p_hand->height;
+    }
+
+    // The face holds the longest hand at any angle
+    side = (uint16_t)(2 * (m_hands[2].height + 2));
+    memset(&m_face, 0, sizeof(m_face));
+    if ((side <= sizeof(row)) &&
+        (m_scratch + BENCH_FACE_OFS + (uint32_t)side * side <= RAM_BASE + 0x20000 - 16))
+    {
+        m_face.baseaddr = m_scratch + BENCH_FACE_OFS;
+        m_face.stride   = side;
+        m_face.left     = (int16_t)(m_cx - side / 2);
+        m_face.top      = (int16_t)(m_cy - side / 2);
+        m_face.width    = side;
+        m_face.height   = side;
+        for (uint32_t y = 0; y < side; y++)
+        {
+            for (uint32_t x = 0; x < side; x++)
+            {
+                row[x] = ((x % 8 == 0) && (y % 8 == 0)) ? BENCH_FG : BENCH_BG;
+            }
+            seS1D13C00Write(m_face.baseaddr + y * side, row, side);
+        }
+    }
+}
+
+
+/**@brief Dial image of the largest circle that fits, ring and minute ticks, packed both ways. */
+static void dial_init(void)
+{
+    uint32_t stride;
+    int32_t  r, dx, dy;
+    int32_t  ux = 0;
+    int32_t  uy = -65536;                                   // 12 o'clock, 16.16
+
+    m_dial_side = (uint16_t)((2 * m_r < BENCH_DIAL_MAX) ? 2 * m_r : BENCH_DIAL_MAX);
+    stride      = (m_dial_side >> 3) + 1;
+    r           = m_dial_side / 2 - 1;
+    memset(m_dial_bmp, 0, sizeof(m_dial_bmp));
+
+    for (int32_t y = 0; y < m_dial_side; y++)
+    {
+        for (int32_t x = 0; x < m_dial_side; x++)
+        {
+            dx = 2 * x + 1 - m_dial_side;                   // Half pixels from the center
+            dy = 2 * y + 1 - m_dial_side;
+            if ((dx * dx + dy * dy < 4 * r * r) && (dx * dx + dy * dy >= 4 * (r - 3) * (r - 3)))
+            {
+                m_dial_bmp[y * stride + (x >> 3)] |= (uint8_t)(0x80 >> (x & 7));
+            }
+        }
+    }
+
+    // Ticks from the ring inwards, turned 6 degrees at a time
+    for (uint32_t i = 0; i < 60; i++)
+    {
+        int32_t len = (i % 5 == 0) ? 14 : 6;
+        int32_t t;
+
+        for (int32_t d = r - 3 - len; d < r - 3; d++)
+        {
+            for (int32_t w = (i % 5 == 0) ? -1 : 0; w <= ((i % 5 == 0) ? 1 : 0); w++)
+            {
+                int32_t x = m_dial_side / 2 + (int32_t)(((int64_t)ux * d - (int64_t)uy * w) >> 16);
+                int32_t y = m_dial_side / 2 + (int32_t)(((int64_t)uy * d + (int64_t)ux * w) >> 16);
+
+                m_dial_bmp[y * stride + (x >> 3)] |= (uint8_t)(0x80 >> (x & 7));
+            }
+        }
+        t  = (int32_t)(((int64_t)ux * 65177 - (int64_t)uy * 6850) >> 16);  // cos and sin 6 * 65536
+        uy = (int32_t)(((int64_t)uy * 65177 + (int64_t)ux * 6850) >> 16);
+        ux = t;
+    }
+
+    m_dial_rle_len = seMDC_PACK_Encode(seMDC_PACK_RLE, m_dial_bmp, stride * m_dial_side, m_dial_rle, sizeof(m_dial_rle));
+    m_dial_lz_len  = seMDC_PACK_Encode(seMDC_PACK_LZ, m_dial_bmp, stride * m_dial_side, m_dial_lz, sizeof(m_dial_lz));
+}
+
+
+//---------------------------------------------------------------------------
+// Measurement and output
+//---------------------------------------------------------------------------
+
+static uint64_t gfx_busy_ns(void)
+{
+#ifdef SE_HCL_HOST
+    if (seS1D13C00GetTransport() == &seS1D13C00EmuTransport)
+    {
+        seEMU_Stats stats;
+
+        seEMU_GetStats(&stats);
+        return stats.gfx_busy_ns;
+    }
+#endif
+    return seTRACE_GetPollTime("seMDC_WaitGfxDone");
+}
+
+
+static void snap(bench_snap_t * p_snap)
+{
+    seTRACE_GetTotals(&p_snap->c);
+    p_snap->gfx_ns = gfx_busy_ns();
+    p_snap->t_ns   = seS1D13C00NowNS();
+}
+
+
+/**@brief Microseconds with three decimals. */
+static char const * us(uint64_t ns, char * p_buf, size_t size)
+{
+    snprintf(p_buf, size, "%lu.%03lu", (unsigned long)(ns / 1000), (unsigned long)(ns % 1000));
+    return p_buf;
+}
+
+
+static void result_add(bench_result_t * p_res, bench_snap_t const * p_a, bench_snap_t const * p_b,
+                       bench_snap_t const * p_c, uint32_t lines)
+{
+    p_res->xacts        += p_c->c.xacts - p_a->c.xacts;
+    p_res->wr_bytes     += p_c->c.wr_bytes - p_a->c.wr_bytes;
+    p_res->rd_bytes     += p_c->c.rd_bytes - p_a->c.rd_bytes;
+    p_res->wasted_xacts += p_c->c.wasted_xacts - p_a->c.wasted_xacts;
+    p_res->gfx_ns       += p_b->gfx_ns - p_a->gfx_ns;
+    p_res->draw_ns      += p_b->t_ns - p_a->t_ns;
+    p_res->upd_ns       += p_c->t_ns - p_b->t_ns;
+    p_res->lines        += lines;
+}
+
+
+static void put_result(gfx_bench_put_t put, void * p_ctx, char const * p_name, bool ok, bench_result_t const * p_res)
+{
+    char line[320];
+    char gfx[24], draw[24], upd[24], wall[24];
+
+    snprintf(line, sizeof(line),
+             "{\"case\":\"%s\",\"status\":\"%s\",\"xacts\":%lu,\"wr_bytes\":%lu,\"rd_bytes\":%lu,"
+             "\"wasted_xacts\":%lu,\"gfx_busy_us\":%s,\"draw_us\":%s,\"upd_us\":%s,\"wall_us\":%s,\"lines\":%lu}\n",
+             p_name, ok ? "ok" : "ng",
+             (unsigned long)p_res->xacts,
+             (unsigned long)p_res->wr_bytes,
+             (unsigned long)p_res->rd_bytes,
+             (unsigned long)p_res->wasted_xacts,
+             us(p_res->gfx_ns, gfx, sizeof(gfx)),
+             us(p_res->draw_ns, draw, sizeof(draw)),
+             us(p_res->upd_ns, upd, sizeof(upd)),
+             us(p_res->draw_ns + p_res->upd_ns, wall, sizeof(wall)),
+             (unsigned long)p_res->lines);
+    put(line, p_ctx);
+}
+
+
+static void put_anim(gfx_bench_put_t put, void * p_ctx, char const * p_name)
+{
+    seMDC_ANIM_Stats stats;
+    char             line[160];
+
+    seMDC_ANIM_GetStats(&stats);
+    snprintf(line, sizeof(line),
+             "{\"anim\":\"%s\",\"frames\":%lu,\"dropped\":%lu,\"fps\":%lu.%02lu,\"period_us\":%lu}\n",
+             p_name, (unsigned long)stats.frames, (unsigned long)stats.dropped,
+             (unsigned long)(stats.fps_x100 / 100), (unsigned long)(stats.fps_x100 % 100),
+             (unsigned long)stats.period_us);
+    put(line, p_ctx);
+}
+
+
+static void put_rate(gfx_bench_put_t put, void * p_ctx, char const * p_name)
+{
+    char     line[160];
+    char     cpu[24];
+    uint64_t rate = (m_layout_ns != 0) ? (uint64_t)m_layouts * 1000000000ULL / m_layout_ns : 0;
+
+    snprintf(line, sizeof(line), "{\"rate\":\"%s\",\"layouts\":%lu,\"cpu_us\":%s,\"layouts_per_s\":%lu}\n",
+             p_name, (unsigned long)m_layouts, us(m_layout_ns, cpu, sizeof(cpu)), (unsigned long)rate);
+    put(line, p_ctx);
+}
+
+
+/**@brief Bytes a dial case keeps in host flash, against the unpacked image. */
+static void put_stored(gfx_bench_put_t put, void * p_ctx, char const * p_name, uint16_t method)
+{
+    char     line[120];
+    uint32_t size   = (uint32_t)((m_dial_side >> 3) + 1) * m_dial_side;
+    uint32_t stored = (method == seMDC_PACK_RLE) ? m_dial_rle_len : (method == seMDC_PACK_LZ) ? m_dial_lz_len : size;
+
+    snprintf(line, sizeof(line), "{\"stored\":\"%s\",\"stored_bytes\":%lu,\"image_bytes\":%lu}\n",
+             p_name, (unsigned long)stored, (unsigned long)size);
+    put(line, p_ctx);
+}
+
+
+static void clear(void)
+{
+    seMDC_DrawRectangle(0, 0, m_w - 1, m_h - 1, BENCH_BG, 0, 0, FILL_ENABLE);
+    seMDC_WaitGfxDone();
+}
+
+
+bool gfx_bench_run(const char * p_transport, gfx_bench_put_t put, void * p_ctx)
+{
+    bench_snap_t   a, b, c;
+    bench_result_t total;
+    bool           ok = true;
+    char           line[200];
+
+    m_w = seS1D13C00Read16(MDC_GFXOWIDTH);
+    m_h = seS1D13C00Read16(MDC_GFXOHEIGHT);
+    if ((m_w < 64) || (m_h < 64))
+    {
+        return false;
+    }
+    m_cx      = m_w / 2;
+    m_cy      = m_h / 2;
+    m_r       = (uint16_t)(((m_w < m_h) ? m_w : m_h) / 2 - 4);
+    m_scratch = (seS1D13C00Read32(MDC_GFXOBADDR0) + (uint32_t)seS1D13C00Read16(MDC_GFXOSTRIDE) * m_h + 0xFFF) & ~0xFFFu;
+
+    if (seDMAC_Init(m_scratch + BENCH_DMA_OFS, 4) != seSTATUS_OK)
+    {
+        return false;
+    }
+    font_init();
+    shapes_init();
+    hands_init();
+    dial_init();
+
+    snprintf(line, sizeof(line),
+             "{\"suite\":\"gfx_bench\",\"version\":1,\"transport\":\"%s\",\"width\":%u,\"height\":%u,"
+             "\"reps\":%u,\"gfx_busy_src\":\"%s\"}\n",
+             p_transport, (unsigned)m_w, (unsigned)m_h, (unsigned)GFX_BENCH_REPS,
+#ifdef SE_HCL_HOST
+             (seS1D13C00GetTransport() == &seS1D13C00EmuTransport) ? "model" :
+#endif
+             "wait");
+    put(line, p_ctx);
+
+    seTRACE_Reset();
+    memset(&total, 0, sizeof(total));
+
+    for (uint32_t i = 0; i < sizeof(m_cases) / sizeof(m_cases[0]); i++)
+    {
+        bench_case_t const * p_case = &m_cases[i];
+        bench_result_t       res;
+        seStatus             status = seSTATUS_OK;
+        uint32_t             lines  = 0;
+
+        clear();
+        m_row_min = INT32_MAX;
+        m_row_max = -1;
+
+        snap(&a);
+        for (uint32_t rep = 0; (rep < GFX_BENCH_REPS) && (status == seSTATUS_OK); rep++)
+        {
+            status = p_case->fn(rep, p_case->arg);
+        }
+        snap(&b);
+        if (m_row_max >= m_row_min)
+        {
+            seMDC_PanelUpdate((uint16_t)m_row_min, (uint16_t)m_row_max);
+            seMDC_WaitUpdDone();
+            lines = (uint32_t)(m_row_max - m_row_min + 1);
+        }
+        snap(&c);
+
+        memset(&res, 0, sizeof(res));
+        result_add(&res, &a, &b, &c, lines);
+        result_add(&total, &a, &b, &c, lines);
+        put_result(put, p_ctx, p_case->p_name, status == seSTATUS_OK, &res);
+        if (p_case->fn == bench_anim)
+        {
+            put_anim(put, p_ctx, p_case->p_name);
+        }
+        if (p_case->fn == bench_layout_rate)
+        {
+            put_rate(put, p_ctx, p_case->p_name);
+        }
+        if (p_case->fn == bench_dial)
+        {
+            put_stored(put, p_ctx, p_case->p_name, p_case->arg[0]);
+        }
+        ok = ok && (status == seSTATUS_OK);
+    }
+
+    // Sum of the workloads, the clears in between are not counted
+    put_result(put, p_ctx, "_total", ok, &total);
+
+    return ok;
+}
+
+#endif // GFX_BENCH
@@ -0,0 +1,66 @@
+/** @file
+ *
+ * @brief    Graphics primitive benchmark for the S1D13C00 libraries.
+ *
+ * @details  Runs a fixed set of workloads (engine lines and rectangles, thick and dashed lines,
+ *           arcs, polygons, clock ticks, rot-scale bitmap copies, strings from an internal and an
+ *           external font) against whatever HCL transport is selected: the nRF SPIM on target, or
+ *           spidev or the emulator on Linux. Every workload starts from a cleared frame buffer and
+ *           its parameters are fixed, so runs of the same build are reproducible and runs of two
+ *           builds can be compared line by line.
+ *
+ *           Output is JSON Lines: a header object, one object per workload and a total. Per
+ *           workload it reports
+ *           - xacts, wr_bytes, rd_bytes: host transactions and their payload bytes (each
+ *             transaction adds a 5 byte write or 6 byte read header on the wire),
+ *           - wasted_xacts: polling transactions that found the engine still busy,
+ *           - gfx_busy_us: graphics engine busy time, modelled by the emulator, or on hardware the
+ *             time the host spent in seMDC_WaitGfxDone() (header field gfx_busy_src),
+ *           - draw_us, upd_us, wall_us: host time for drawing, for the panel update and both,
+ *           - lines: panel lines updated.
+ *           Animation cases add a line with frames and frame rate, the layout_rate case a line with
+ *           the layouts done, their CPU time and layouts per second, and the dial cases a line with
+ *           the bytes of the dial image kept in host flash, packed or not.
+ *
+ *           Times come from the transport time base (DWT cycle counter on nRF52, CLOCK_MONOTONIC
+ *           on spidev, virtual time in the emulator). Counters come from the transaction tracer,
+ *           so the benchmark needs SE_HCL_TRACE; its own overhead is included in the wall times.
+ *
+ *           Controller RAM after the frame buffer is used for the bitmap, the external font, the
+ *           string copy buffer and the DMAC descriptors.
+ */
+
+#ifndef GFX_BENCH_H__
+#define GFX_BENCH_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef GFX_BENCH_REPS
+#define GFX_BENCH_REPS          4                           /**< Repetitions of each workload. */
+#endif
+
+/**@brief Output function, called with pieces of at most one line. */
+typedef void (*gfx_bench_put_t)(const char * p_str, void * p_ctx);
+
+
+/**@brief Runs all workloads on an initialized controller and panel.
+ *
+ * @param[in] p_transport  Name of the transport, copied into the header.
+ * @param[in] put          Output function.
+ * @param[in] p_ctx        Passed to @p put.
+ *
+ * @retval false if the panel is not set up or a workload failed.
+ */
+bool gfx_bench_run(const char * p_transport, gfx_bench_put_t put, void * p_ctx);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GFX_BENCH_H__
@@ -0,0 +1,193 @@
+/** @file
+ *
+ * @brief    Linux runner for the graphics benchmark.
+ *
+ * @details  Runs against the emulator by default, or against a controller on spidev:
+ *
+ *           gcc -O2 -DSE_HCL_HOST -DSE_HCL_TRACE -DGFX_BENCH -Isrc/mdc \
+ *               bench/gfx_bench.c bench/gfx_bench_linux.c $(find src/mdc -name '*.c') -lm -o gfx_bench
+ *           ./gfx_bench [--spidev [device]] [--ttff] [-o results.jsonl]
+ *
+ *           or with the CMake project in spi_mdc, which also runs both reports as tests.
+ *
+ *           The panel initialization is GFX_BENCH_PANEL_INIT, LS012B7DH02 unless overridden.
+ *
+ *           --ttff reports the time to first frame of every panel in seMDC_Panels instead, one
+ *           object per panel and start-up path: cold (controller reset, panel initialized, with
+ *           and without the blank frame) and warm (host side restarted, seMDC_PanelResume()
+ *           takes over the panel left running by the cold run). A full screen rectangle is then
+ *           drawn and updated as the first frame. wake_us runs from the host interface start to
+ *           the end of that update, the other fields are those of seMDC_PanelInitReport.
+ */
+
+#ifdef GFX_BENCH
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "gfx_bench.h"
+#include "s1d13c00_hcl.h"
+#include "s1d13c00_memregs.h"
+#include "se_common.h"
+#include "se_clg.h"
+#include "se_mdc.h"
+#include "s1d13c00_emu.h"
+
+#ifndef GFX_BENCH_PANEL_INIT
+#define GFX_BENCH_PANEL_INIT()  seMDC_InitPanel_LS012B7DH02(20000000L, RAM_BASE)
+#endif
+
+
+static void put_file(const char * p_str, void * p_ctx)
+{
+    fputs(p_str, (FILE *)p_ctx);
+}
+
+
+static void usage(const char * p_prog)
+{
+    fprintf(stderr, "usage: %s [--spidev [device]] [--ttff] [-o file]\n", p_prog);
+}
+
+
+/**@brief Start-up paths measured by --ttff. */
+typedef enum
+{
+    PATH_COLD,                                              /**< Controller reset, panel initialized and blanked. */
+    PATH_COLD_NOBLANK,                                      /**< As PATH_COLD with seMDC_INIT_NOBLANK. */
+    PATH_WARM,                                              /**< Host restarted, the controller kept the panel running. */
+    PATH_COUNT
+} ttff_path_t;
+
+static char const * const m_path_names[PATH_COUNT] = { "cold", "cold_noblank", "warm" };
+
+
+static void controller_init(void)
+{
+    InitializeHost();
+    InitializeMDC(HOSTMCU_SPI_MONOADDR_MONODATA);
+    seCLG_Start(seCLG_IOSC);
+    seCLG_Start(seCLG_OSC1);
+}
+
+
+static seStatus ttff_wake(seMDC_PanelDesc const * p_panel, ttff_path_t path)
+{
+    if (path == PATH_WARM)
+    {
+        InitializeHost();
+        ResumeMDC(HOSTMCU_SPI_MONOADDR_MONODATA);
+        return seMDC_PanelResume(p_panel, 20000000L, RAM_BASE);
+    }
+    controller_init();
+    return seMDC_InitPanelDesc(p_panel, 20000000L, RAM_BASE, (path == PATH_COLD_NOBLANK) ? seMDC_INIT_NOBLANK : 0);
+}
+
+
+static bool ttff_run(bool emu, FILE * p_file)
+{
+    seMDC_PanelInitReport report;
+    uint64_t              t0;
+
+    for (uint32_t i = 0; i < seMDC_PANEL_COUNT; i++)
+    {
+        seMDC_PanelDesc const * p_panel = seMDC_Panels[i];
+
+        for (ttff_path_t path = PATH_COLD; path < PATH_COUNT; path++)
+        {
+            if (emu && (path != PATH_WARM))
+            {
+                seEMU_Reset();
+            }
+            t0 = seS1D13C00NowNS();
+            if (ttff_wake(p_panel, path) != seSTATUS_OK)
+            {
+                fprintf(stderr, "%s: %s start failed\n", p_panel->name, m_path_names[path]);
+                return false;
+            }
+            (void)seMDC_DrawRectangle(0, 0, p_panel->width - 1, p_panel->height - 1, 0, 0, 0, 1);
+            seMDC_WaitGfxDone();
+            (void)seMDC_PanelUpdate(0, p_panel->height - 1);
+            seMDC_WaitUpdDone();
+
+            seMDC_GetPanelInitReport(&report);
+            fprintf(p_file, "{\"panel\":\"%s\",\"path\":\"%s\",\"wake_us\":%u,\"init_us\":%u,"
+                            "\"ttff_us\":%u,\"wait_us\":%u,\"overlap_us\":%u}\n",
+                    p_panel->name, m_path_names[path], (unsigned)((seS1D13C00NowNS() - t0) / 1000),
+                    (unsigned)report.init_us, (unsigned)report.ttff_us,
+                    (unsigned)report.wait_us, (unsigned)report.overlap_us);
+        }
+    }
+    return true;
+}
+
+
+int main(int argc, char * argv[])
+{
+    char const * p_transport = "emu";
+    char const * p_out       = NULL;
+    FILE *       p_file      = stdout;
+    bool         ttff        = false;
+    bool         ok;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--spidev") == 0)
+        {
+            p_transport = "spidev";
+            if ((i + 1 < argc) && (argv[i + 1][0] != '-'))
+            {
+                setenv("SE_HCL_SPIDEV", argv[++i], 1);
+            }
+        }
+        else if (strcmp(argv[i], "--ttff") == 0)
+        {
+            ttff = true;
+        }
+        else if ((strcmp(argv[i], "-o") == 0) && (i + 1 < argc))
+        {
+            p_out = argv[++i];
+        }
+        else
+        {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    bool emu = (strcmp(p_transport, "emu") == 0);
+
+    seS1D13C00SetTransport(emu ? &seS1D13C00EmuTransport : &seS1D13C00SpidevTransport);
+    if (!ttff)
+    {
+        if (emu)
+        {
+            seEMU_Reset();
+        }
+        controller_init();
+        if (GFX_BENCH_PANEL_INIT() != seSTATUS_OK)
+        {
+            fprintf(stderr, "panel initialization failed\n");
+            return 1;
+        }
+    }
+
+    if (p_out != NULL)
+    {
+        p_file = fopen(p_out, "w");
+        if (p_file == NULL)
+        {
+            perror(p_out);
+            return 1;
+        }
+    }
+    ok = ttff ? ttff_run(emu, p_file) : gfx_bench_run(p_transport, put_file, p_file);
+    if (p_file != stdout)
+    {
+        fclose(p_file);
+    }
+
+    return ok ? 0 : 1;
+}
+
+#endif // GFX_BENCH
@@ -59,6 +59,14 @@
 #include "semdc_gfx.h"
 #include "se_t16.h"
 #include "se_qspi.h"
+#ifdef GFX_BENCH
+#include "s1d13c00_trace.h"
+#include "gfx_bench.h"
+#endif
+
+#ifndef SPI_MDC_HOSTIF
+#define SPI_MDC_HOSTIF  HOSTMCU_SPI_MONOADDR_DUALDATA  /**< Host interface mode, modes other than single data run on the QSPI. */
+#endif
 
 #if 0
 #define SPI_INSTANCE  0 /**< SPI instance index. */
@@ -100,7 +108,8 @@ int main(void)
     NRF_LOG_DEFAULT_BACKENDS_INIT();
 
     InitializeHost();
-    InitializeMDC(HOSTMCU_SPI_MONOADDR_MONODATA);
+    InitializeMDC(SPI_MDC_HOSTIF);
+    NRF_LOG_INFO("Host interface mode %d, requested %d.", seS1D13C00GetHostIf(), SPI_MDC_HOSTIF);
 
     /*iosc_fq = 3;
     iosc_raj = 32;
@@ -120,6 +129,11 @@ int main(void)
 
     seMDC_InitPanel_LS012B7DD06(20000000L, RAM_BASE);
 
+#ifdef GFX_BENCH
+    // Results go to RTT channel 0 as JSON Lines, see gfx_bench.h
+    gfx_bench_run("nrf", seTRACE_PutRTT, NULL);
+#endif
+
 #if 0
     nrf_drv_spi_config_t spi_config = NRF_DRV_SPI_DEFAULT_CONFIG;
     spi_config.ss_pin   = SPI_SS_PIN;
@@ -29,5 +29,6 @@
 #define _CRC16_H_
 
 unsigned short crc16_ccitt(const unsigned char *buf, int len);
+unsigned short crc16_ccitt_update(unsigned short crc, const unsigned char *buf, int len);
 
 #endif /* _CRC16_H_ */
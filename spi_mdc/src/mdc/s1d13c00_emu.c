@@ -0,0 +1,759 @@
+/**
+  ******************************************************************************
+  * @file    s1d13c00_emu.c
+  * @brief   In-process S1D13C00 emulator, see s1d13c00_emu.h.
+  ******************************************************************************
+  * @attention
+  *
+  * Engine and DMAC operations change memory as soon as they are triggered; only
+  * their completion flags wait for the virtual clock. Flags are brought up to
+  * date (UpdateFlags) before every register read.
+  ******************************************************************************
+  */
+
+#include <stdio.h>
+#include <string.h>
+#include "s1d13c00_hcl.h"
+#include "s1d13c00_memregs.h"
+#include "se_common.h"
+#include "se_dmac.h"
+#include "se_mdc.h"
+#include "semdc_sw.h"
+#include "s1d13c00_emu.h"
+
+#define REG_BASE                0x40000000UL
+#define REG_SIZE                0x4000UL
+#define DMA_CHANNELS            4
+
+#define NS_PER_S                1000000000ULL
+
+#define REG(a)                  ((uint32_t)(a) - REG_BASE)
+
+static uint8_t  ram[SE_EMU_RAM_SIZE];
+static uint8_t  regs[REG_SIZE];
+static uint8_t  panel[SE_EMU_PANEL_MAX];
+static uint16_t panel_w;
+static uint16_t panel_h;
+
+static uint64_t now_ns;
+static uint64_t gfx_done_ns;
+static uint64_t upd_done_ns;
+static uint64_t dma_done_ns[DMA_CHANNELS];
+static bool     gfx_pending;
+static bool     upd_pending;
+static uint8_t  dma_pending;                        // Channel mask
+
+static uint32_t init_wr_hz = 1000000;
+static uint32_t init_rd_hz = 1000000;
+
+static seEMU_Timing timing =
+{
+    .xact_ns             = 2000,
+    .wr_hz               = 0,
+    .rd_hz               = 0,
+    .sysclk_hz           = 20000000,
+    .gfx_setup_cycles    = 16,
+    .gfx_cycles_per_px   = 1,
+    .dma_cycles_per_xfer = 4,
+};
+
+static seEMU_Stats stats;
+
+
+//---------------------------------------------------------------------------
+// Register file
+//---------------------------------------------------------------------------
+
+static uint16_t Rd16( uint32_t addr )
+{
+    return (uint16_t)(regs[REG(addr)] | (regs[REG(addr) + 1] << 8));
+}
+
+static void Wr16( uint32_t addr, uint16_t val )
+{
+    regs[REG(addr)]     = (uint8_t)val;
+    regs[REG(addr) + 1] = (uint8_t)(val >> 8);
+}
+
+static uint32_t Rd32( uint32_t addr )
+{
+    return Rd16( addr ) | ((uint32_t)Rd16( addr + 2 ) << 16);
+}
+
+static uint64_t CyclesToNS( uint64_t cycles )
+{
+    return (cycles * NS_PER_S) / timing.sysclk_hz;
+}
+
+static void RegsReset( void )
+{
+    memset( regs, 0, sizeof(regs) );
+    Wr16( DMAC_STAT + 2, DMA_CHANNELS );            // Channel count, as seDMAC_Init() reads it
+    gfx_pending = false;
+    upd_pending = false;
+    dma_pending = 0;
+}
+
+
+//---------------------------------------------------------------------------
+// Memory access by the engine and the DMAC
+//---------------------------------------------------------------------------
+
+static uint8_t *RamPtr( uint32_t addr, uint32_t n )
+{
+    if ( n <= SE_EMU_RAM_SIZE && addr >= RAM_BASE && addr - RAM_BASE <= SE_EMU_RAM_SIZE - n )
+        return &ram[addr - RAM_BASE];
+    return NULL;
+}
+
+static uint8_t RegRead8( uint32_t addr );
+static void RegWrite8( uint32_t addr, uint8_t val );
+
+static uint8_t MemRead8( uint32_t addr )
+{
+    uint8_t *p = RamPtr( addr, 1 );
+
+    if ( p != NULL )
+        return *p;
+    if ( addr >= REG_BASE && addr - REG_BASE < REG_SIZE )
+        return RegRead8( addr );
+    stats.bad_accesses++;
+    return 0;
+}
+
+static void MemWrite8( uint32_t addr, uint8_t val )
+{
+    uint8_t *p = RamPtr( addr, 1 );
+
+    if ( p != NULL )
+        *p = val;
+    else if ( addr >= REG_BASE && addr - REG_BASE < REG_SIZE )
+        RegWrite8( addr, val );
+    else
+        stats.bad_accesses++;
+}
+
+
+//---------------------------------------------------------------------------
+// Graphics engine
+//---------------------------------------------------------------------------
+
+// Output window as set up in the registers, clipped as described in the header
+static void OutSetup( seMDC_SW_Target *tgt )
+{
+    uint32_t base    = Rd32( MDC_GFXOBADDR0 );
+    uint16_t owright = Rd16( MDC_GFXOWRIGHT );
+    uint16_t owbot   = Rd16( MDC_GFXOWBOT );
+    uint8_t  *p      = RamPtr( base, 1 );
+
+    seMDC_SW_InitTarget( tgt, p, (p != NULL) ? SE_EMU_RAM_SIZE - (base - RAM_BASE) : 0,
+                         Rd16( MDC_GFXOSTRIDE ), Rd16( MDC_GFXOWIDTH ), Rd16( MDC_GFXOHEIGHT ) );
+    if ( owright != 0 || owbot != 0 )
+    {
+        if ( Rd16( MDC_GFXOWLEFT ) > tgt->left )  tgt->left  = Rd16( MDC_GFXOWLEFT );
+        if ( Rd16( MDC_GFXOWTOP ) > tgt->top )    tgt->top   = Rd16( MDC_GFXOWTOP );
+        if ( owright < tgt->right )               tgt->right = owright;
+        if ( owbot < tgt->bot )                   tgt->bot   = owbot;
+    }
+}
+
+// Drawing is done by the software model, the engine only adds timing
+static void GfxRun( void )
+{
+    seMDC_SW_Target           tgt;
+    seMDC_ImgCopyRotScaleCtrl rsctrl;
+    seMDC_ImgCopyHVShearCtrl  shctrl;
+    uint16_t                  ctl     = Rd16( MDC_GFXCTL );
+    uint32_t                  ibase   = Rd32( MDC_GFXIBADDR0 );
+    const uint8_t             *src    = RamPtr( ibase, 1 );
+    uint32_t                  srcsize = (src != NULL) ? SE_EMU_RAM_SIZE - (ibase - RAM_BASE) : 0;
+    uint64_t                  busy;
+
+    if ( gfx_pending && now_ns < gfx_done_ns )
+        stats.gfx_overruns++;
+
+    OutSetup( &tgt );
+    switch ( ctl & MDC_GFXFUNC_bits )
+    {
+        case seMDC_FUNC_COPYROTSCALE:
+            rsctrl.ctrlword = ctl;
+            seMDC_SW_ImgCpyRotScale( &tgt, Rd16( MDC_GFXOXCENTER ), Rd16( MDC_GFXOYCENTER ),
+                                     src, srcsize, Rd16( MDC_GFXISTRIDE ), Rd16( MDC_GFXIWIDTH ), Rd16( MDC_GFXIHEIGHT ),
+                                     Rd16( MDC_GFXIXCENTER ), Rd16( MDC_GFXIYCENTER ),
+                                     Rd16( MDC_GFXCOLOR ), Rd16( MDC_GFXROTVAL ),
+                                     Rd16( MDC_GFXXLSCALE ), Rd16( MDC_GFXXRSCALE ),
+                                     Rd16( MDC_GFXYTSCALE ), Rd16( MDC_GFXYBSCALE ), &rsctrl );
+            break;
+        case seMDC_FUNC_COPYHVSHEAR:
+            shctrl.ctrlword  = ctl;
+            shctrl.shearctrl = Rd16( MDC_GFXSHEAR );
+            seMDC_SW_ImgCpyHVShear( &tgt, Rd16( MDC_GFXOXCENTER ), Rd16( MDC_GFXOYCENTER ),
+                                    src, srcsize, Rd16( MDC_GFXISTRIDE ), Rd16( MDC_GFXIWIDTH ), Rd16( MDC_GFXIHEIGHT ),
+                                    Rd16( MDC_GFXIXCENTER ), Rd16( MDC_GFXIYCENTER ),
+                                    Rd16( MDC_GFXCOLOR ), &shctrl );
+            break;
+        case seMDC_FUNC_RECTDRAW:
+            seMDC_SW_DrawRectangle( &tgt, Rd16( MDC_GFXIXCENTER ), Rd16( MDC_GFXIYCENTER ),
+                                    Rd16( MDC_GFXOXCENTER ), Rd16( MDC_GFXOYCENTER ), Rd16( MDC_GFXCOLOR ),
+                                    Rd16( MDC_GFXIWIDTH ), Rd16( MDC_GFXIHEIGHT ), (ctl & MDC_FILLEN_bits) != 0 );
+            break;
+        case seMDC_FUNC_LINEDRAW:
+            seMDC_SW_DrawLine( &tgt, Rd16( MDC_GFXIXCENTER ), Rd16( MDC_GFXIYCENTER ),
+                               Rd16( MDC_GFXOXCENTER ), Rd16( MDC_GFXOYCENTER ), Rd16( MDC_GFXCOLOR ),
+                               Rd16( MDC_GFXIWIDTH ) );
+            break;
+        case seMDC_FUNC_ELLIPDRAW:
+            seMDC_SW_DrawEllipse( &tgt, Rd16( MDC_GFXIXCENTER ), Rd16( MDC_GFXIYCENTER ),
+                                  Rd16( MDC_GFXOXCENTER ), Rd16( MDC_GFXOYCENTER ), Rd16( MDC_GFXCOLOR ),
+                                  Rd16( MDC_GFXIWIDTH ), Rd16( MDC_GFXIHEIGHT ), (ctl & MDC_FILLEN_bits) != 0 );
+            break;
+        default:
+            break;
+    }
+
+    busy = CyclesToNS( timing.gfx_setup_cycles + (uint64_t)tgt.pxvisited * timing.gfx_cycles_per_px );
+    gfx_done_ns = now_ns + busy;
+    gfx_pending = true;
+    stats.gfx_ops++;
+    stats.gfx_px += tgt.pxvisited;
+    stats.gfx_busy_ns += busy;
+    stats.bad_accesses += tgt.badaccess;
+}
+
+
+//---------------------------------------------------------------------------
+// Panel update
+//---------------------------------------------------------------------------
+
+static void UpdRun( void )
+{
+    uint16_t dispctl = Rd16( MDC_DISPCTL );
+    uint16_t w       = Rd16( MDC_DISPWIDTH );
+    uint16_t h       = Rd16( MDC_DISPHEIGHT );
+    uint16_t stride  = Rd16( MDC_DISPSTRIDE );
+    uint16_t starty  = Rd16( MDC_DISPSTARTY );
+    uint16_t endy    = Rd16( MDC_DISPENDY );
+    uint32_t fb      = Rd32( MDC_DISPFRMBUFF0 );
+    uint32_t sclk    = timing.sysclk_hz / ((Rd16( MDC_DISPCLKDIV ) & MDC_CLKDIV_bits) + 1);
+    uint32_t bits    = (uint32_t)w * ((dispctl & MDC_SPITYPE_bits) ? 3 : 1) + 32;  // Pixels, mode, address, dummy
+    uint32_t lines   = 0;
+    uint64_t busy;
+    uint16_t y;
+    uint8_t  *p;
+
+    if ( (uint32_t)w * h <= SE_EMU_PANEL_MAX && endy < h )
+    {
+        panel_w = w;
+        panel_h = h;
+        for ( y = starty; y <= endy; y++ )
+        {
+            p = RamPtr( fb + (uint32_t)y * stride, w );
+            if ( p != NULL )
+                memcpy( &panel[(uint32_t)y * w], p, w );
+            else
+                stats.bad_accesses++;
+            lines++;
+        }
+    }
+
+    busy = (uint64_t)lines * bits * NS_PER_S / sclk;
+    upd_done_ns = now_ns + busy;
+    upd_pending = true;
+    stats.upd_ops++;
+    stats.lines_updated += lines;
+    stats.upd_busy_ns += busy;
+}
+
+
+//---------------------------------------------------------------------------
+// DMAC
+//---------------------------------------------------------------------------
+
+static void DmaRun( uint8_t chans )
+{
+    uint32_t cptr = Rd32( DMAC_CPTR );
+    uint32_t c, i, k;
+
+    for ( c = 0; c < DMA_CHANNELS; c++ )
+    {
+        uint32_t desc = cptr + c * 16;
+        uint32_t src, dst, ctrl, n, size, sinc, dinc;
+
+        if ( !(chans & (1 << c)) )
+            continue;
+
+        src  = MemRead8( desc + 0 ) | MemRead8( desc + 1 ) << 8 | MemRead8( desc + 2 ) << 16 | (uint32_t)MemRead8( desc + 3 ) << 24;
+        dst  = MemRead8( desc + 4 ) | MemRead8( desc + 5 ) << 8 | MemRead8( desc + 6 ) << 16 | (uint32_t)MemRead8( desc + 7 ) << 24;
+        ctrl = MemRead8( desc + 8 ) | MemRead8( desc + 9 ) << 8 | MemRead8( desc + 10 ) << 16 | (uint32_t)MemRead8( desc + 11 ) << 24;
+        if ( (ctrl & 0x7) == seDMAC_MODE_STOP )
+            continue;
+
+        // Basic and auto-request cycles of the primary structure, all items at once
+        n    = ((ctrl >> 4) & 0x3FF) + 1;
+        size = 1U << ((ctrl >> 28) & 3);
+        sinc = (((ctrl >> 26) & 3) == seDMAC_INC_NO) ? 0 : 1U << ((ctrl >> 26) & 3);
+        dinc = (((ctrl >> 30) & 3) == seDMAC_INC_NO) ? 0 : 1U << ((ctrl >> 30) & 3);
+        src -= (n - 1) * sinc;
+        dst -= (n - 1) * dinc;
+        for ( i = 0; i < n; i++ )
+        {
+            for ( k = 0; k < size; k++ )
+                MemWrite8( dst + i * dinc + k, MemRead8( src + i * sinc + k ) );
+        }
+
+        dma_done_ns[c] = now_ns + CyclesToNS( (uint64_t)n * timing.dma_cycles_per_xfer );
+        dma_pending |= (uint8_t)(1 << c);
+        stats.dma_xfers += n;
+    }
+}
+
+
+//---------------------------------------------------------------------------
+// Completion flags
+//---------------------------------------------------------------------------
+
+static void UpdateFlags( void )
+{
+    uint32_t c, desc;
+
+    if ( gfx_pending && now_ns >= gfx_done_ns )
+    {
+        regs[REG(MDC_INTCTL)] |= MDC_GFXIF_bits;
+        gfx_pending = false;
+    }
+    if ( upd_pending && now_ns >= upd_done_ns )
+    {
+        regs[REG(MDC_INTCTL)] |= MDC_UPDIF_bits;
+        upd_pending = false;
+    }
+    for ( c = 0; c < DMA_CHANNELS; c++ )
+    {
+        if ( (dma_pending & (1 << c)) && now_ns >= dma_done_ns[c] )
+        {
+            // Back to stop mode with nothing left, as the controller writes it back
+            desc = Rd32( DMAC_CPTR ) + c * 16 + 8;
+            MemWrite8( desc + 0, MemRead8( desc + 0 ) & 0x08 );
+            MemWrite8( desc + 1, MemRead8( desc + 1 ) & 0xC0 );
+            regs[REG(DMAC_ENDIF)] |= (uint8_t)(1 << c);
+            dma_pending &= (uint8_t)~(1 << c);
+        }
+    }
+}
+
+static uint16_t SysInts( void )
+{
+    uint16_t ints = 0;
+    uint8_t  mdc  = regs[REG(MDC_INTCTL)];
+
+    if ( mdc & regs[REG(MDC_INTCTL) + 1] & 0x07 )
+        ints |= SYS_MDCINT_bits;
+    if ( regs[REG(DMAC_ENDIF)] & regs[REG(DMAC_ENDIESET)] )
+        ints |= SYS_DMACINT_bits;
+    if ( Rd16( CLG_INTF ) & Rd16( CLG_INTE ) )
+        ints |= SYS_CLGINT_bits;
+    return ints;
+}
+
+
+//---------------------------------------------------------------------------
+// Register side effects
+//---------------------------------------------------------------------------
+
+static uint8_t RegRead8( uint32_t addr )
+{
+    UpdateFlags();
+
+    switch ( addr )
+    {
+        case SYS_INTS:          return (uint8_t)SysInts();
+        case SYS_INTS + 1:      return (uint8_t)(SysInts() >> 8);
+        case QSPI_INTF:         return QSPI_INTF_TENDIF | QSPI_INTF_RBFIF | QSPI_INTF_TBEIF;
+        case QSPI_INTF + 1:     return 0;           // Never busy
+        case QSPI_RXD:          return 0xFF;        // No flash behind the QSPI
+        default:                return regs[REG(addr)];
+    }
+}
+
+static void SetClr( uint32_t set, uint8_t val, bool on )
+{
+    if ( on )
+        regs[REG(set)] |= val;
+    else
+        regs[REG(set)] &= (uint8_t)~val;
+}
+
+static void RegWrite8( uint32_t addr, uint8_t val )
+{
+    UpdateFlags();
+
+    switch ( addr )
+    {
+        case SYS_CTRL:
+            // Oscillator reported stable as soon as it is enabled
+            regs[REG(addr)] = (val & SYS_IOSCEN_bits) ? (val | SYS_IOSCSTA_bits) : (val & ~SYS_IOSCSTA_bits);
+            break;
+        case SYS_CTRL + 1:
+            if ( val & 0x80 )
+                RegsReset();
+            else
+                regs[REG(addr)] = val;
+            break;
+        case SYS_INTS:
+        case SYS_INTS + 1:
+        case DMAC_STAT:
+        case DMAC_STAT + 1:
+        case DMAC_STAT + 2:
+        case DMAC_STAT + 3:
+            break;
+
+        case CLG_OSC:
+            regs[REG(addr)] = val;
+            if ( val & CLG_OSC1EN_bits )
+                regs[REG(CLG_INTF)] |= CLG_OSC1STAIF_bits;
+            break;
+        case CLG_INTF:
+        case CLG_INTF + 1:
+        case MDC_INTCTL:
+        case DMAC_ENDIF:
+        case DMAC_ERRIF:
+        case QSPI_INTF:
+            regs[REG(addr)] &= (uint8_t)~val;       // Write 1 to clear
+            break;
+
+        case MDC_TRIGCTL:
+            if ( val & MDC_GFXTRIG_bits )
+                GfxRun();
+            if ( val & MDC_UPDTRIG_bits )
+                UpdRun();
+            break;
+
+        case QSPI_CTL:
+            regs[REG(addr)] = val & (uint8_t)~QSPI_SFTRST;
+            break;
+
+        case DMAC_SWREQ:
+            DmaRun( val & regs[REG(DMAC_ENSET)] );
+            break;
+        case DMAC_RMSET:    SetClr( DMAC_RMSET, val, true );        break;
+        case DMAC_RMCLR:    SetClr( DMAC_RMSET, val, false );       break;
+        case DMAC_ENSET:    SetClr( DMAC_ENSET, val, true );        break;
+        case DMAC_ENCLR:    SetClr( DMAC_ENSET, val, false );       break;
+        case DMAC_PASET:    SetClr( DMAC_PASET, val, true );        break;
+        case DMAC_PACLR:    SetClr( DMAC_PASET, val, false );       break;
+        case DMAC_PRSET:    SetClr( DMAC_PRSET, val, true );        break;
+        case DMAC_PRCLR:    SetClr( DMAC_PRSET, val, false );       break;
+        case DMAC_ENDIESET: SetClr( DMAC_ENDIESET, val, true );     break;
+        case DMAC_ENDIECLR: SetClr( DMAC_ENDIESET, val, false );    break;
+        case DMAC_ERRIESET: SetClr( DMAC_ERRIESET, val, true );     break;
+        case DMAC_ERRIECLR: SetClr( DMAC_ERRIESET, val, false );    break;
+
+        default:
+            regs[REG(addr)] = val;
+            break;
+    }
+}
+
+
+//---------------------------------------------------------------------------
+// Transport
+//---------------------------------------------------------------------------
+
+static void BusTime( uint32_t nbytes, uint32_t hz )
+{
+    now_ns += timing.xact_ns + (uint64_t)nbytes * 8 * NS_PER_S / hz;
+}
+
+static hostmcu_config EmuInit( hostmcu_config hostif, uint32_t spi_writespeed, uint32_t spi_readspeed )
+{
+    if ( spi_writespeed != 0 )
+        init_wr_hz = spi_writespeed;
+    if ( spi_readspeed != 0 )
+        init_rd_hz = spi_readspeed;
+
+    return HOSTMCU_SPI_MONOADDR_MONODATA;
+}
+
+static void EmuSetSpeed( uint32_t spi_writespeed, uint32_t spi_readspeed )
+{
+    (void)EmuInit( HOSTMCU_SPI_MONOADDR_MONODATA, spi_writespeed, spi_readspeed );
+}
+
+static void EmuXfer( const uint8_t hdr[], uint32_t hlen, const uint8_t wdata[], uint32_t wlen, uint8_t rdata[], uint32_t rlen )
+{
+    uint32_t addr = ((uint32_t)hdr[1] << 24) | ((uint32_t)hdr[2] << 16) | ((uint32_t)hdr[3] << 8) | hdr[4];
+    uint32_t i;
+    uint8_t  *p;
+
+    stats.xacts++;
+    stats.wr_bytes += hlen + wlen;
+    stats.rd_bytes += rlen;
+
+    if ( hdr[0] == CMD_PAGEPROG )
+    {
+        BusTime( hlen + wlen, timing.wr_hz ? timing.wr_hz : init_wr_hz );
+        p = RamPtr( addr, wlen );
+        if ( p != NULL )
+            memcpy( p, wdata, wlen );
+        else
+            for ( i = 0; i < wlen; i++ )
+                MemWrite8( addr + i, wdata[i] );
+    }
+    else if ( hdr[0] == CMD_FASTREAD )
+    {
+        BusTime( hlen + rlen, timing.rd_hz ? timing.rd_hz : init_rd_hz );
+        p = RamPtr( addr, rlen );
+        if ( p != NULL )
+            memcpy( rdata, p, rlen );
+        else if ( rlen == 2 && ( addr & 1 ) == 0 )
+        {
+            rdata[0] = MemRead8( addr + 1 );                                // Registers read alone come high byte first
+            rdata[1] = MemRead8( addr );
+        }
+        else
+            for ( i = 0; i < rlen; i++ )
+                rdata[i] = MemRead8( addr + i );
+    }
+    else
+    {
+        stats.bad_accesses++;
+        if ( rlen != 0 )
+            memset( rdata, 0xFF, rlen );
+    }
+}
+
+static void EmuSleepMS( uint32_t msval )
+{
+    now_ns += (uint64_t)msval * 1000000;
+}
+
+const seS1D13C00Transport seS1D13C00EmuTransport =
+{
+    .init      = EmuInit,
+    .xfer      = EmuXfer,
+    .sleep_ms  = EmuSleepMS,
+    .max_data  = 0,
+    .now_ns    = seEMU_Now,
+    .set_speed = EmuSetSpeed,
+};
+
+
+//---------------------------------------------------------------------------
+// Public functions
+//---------------------------------------------------------------------------
+
+void seEMU_Reset( void )
+{
+    memset( ram, 0, sizeof(ram) );
+    memset( panel, 0, sizeof(panel) );
+    panel_w = 0;
+    panel_h = 0;
+    now_ns = 0;
+    RegsReset();
+    seEMU_ResetStats();
+}
+
+void seEMU_SetTiming( const seEMU_Timing *t )
+{
+    timing = *t;
+    if ( timing.sysclk_hz == 0 )
+        timing.sysclk_hz = 20000000;
+}
+
+void seEMU_GetTiming( seEMU_Timing *t )
+{
+    *t = timing;
+}
+
+uint64_t seEMU_Now( void )
+{
+    return now_ns;
+}
+
+void seEMU_GetStats( seEMU_Stats *s )
+{
+    *s = stats;
+}
+
+void seEMU_ResetStats( void )
+{
+    memset( &stats, 0, sizeof(stats) );
+}
+
+uint8_t *seEMU_Ram( void )
+{
+    return ram;
+}
+
+
+//---------------------------------------------------------------------------
+// PNG output: stored (uncompressed) deflate blocks, 8-bit RGB
+//---------------------------------------------------------------------------
+
+typedef struct {
+    FILE     *f;
+    uint32_t crc;
+    uint32_t adler_a, adler_b;
+    uint32_t block_left;
+    uint32_t raw_left;
+    bool     err;
+} PngOut;
+
+static uint32_t Crc32( uint32_t crc, const uint8_t *p, uint32_t n )
+{
+    uint32_t k;
+
+    crc = ~crc;
+    while ( n-- )
+    {
+        crc ^= *p++;
+        for ( k = 0; k < 8; k++ )
+            crc = (crc >> 1) ^ (0xEDB88320UL & (0 - (crc & 1)));
+    }
+    return ~crc;
+}
+
+static void PngBytes( PngOut *z, const uint8_t *p, uint32_t n )
+{
+    if ( fwrite( p, 1, n, z->f ) != n )
+        z->err = true;
+    z->crc = Crc32( z->crc, p, n );
+}
+
+static void PngBE32( uint8_t *p, uint32_t v )
+{
+    p[0] = (uint8_t)(v >> 24);  p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);   p[3] = (uint8_t)v;
+}
+
+static void PngChunkStart( PngOut *z, const char *type, uint32_t len )
+{
+    uint8_t b[4];
+
+    PngBE32( b, len );
+    if ( fwrite( b, 1, 4, z->f ) != 4 )
+        z->err = true;
+    z->crc = 0;
+    PngBytes( z, (const uint8_t *)type, 4 );
+}
+
+static void PngChunkEnd( PngOut *z )
+{
+    uint8_t b[4];
+
+    PngBE32( b, z->crc );
+    if ( fwrite( b, 1, 4, z->f ) != 4 )
+        z->err = true;
+}
+
+// One byte of the uncompressed zlib stream
+static void PngRaw( PngOut *z, uint8_t v )
+{
+    uint8_t  hdr[5];
+    uint32_t n;
+
+    if ( z->block_left == 0 )
+    {
+        n = (z->raw_left > 65535) ? 65535 : z->raw_left;
+        hdr[0] = (n == z->raw_left) ? 1 : 0;        // BFINAL, BTYPE = stored
+        hdr[1] = (uint8_t)n;
+        hdr[2] = (uint8_t)(n >> 8);
+        hdr[3] = (uint8_t)~n;
+        hdr[4] = (uint8_t)(~n >> 8);
+        PngBytes( z, hdr, 5 );
+        z->block_left = n;
+    }
+    PngBytes( z, &v, 1 );
+    z->adler_a = (z->adler_a + v) % 65521;
+    z->adler_b = (z->adler_b + z->adler_a) % 65521;
+    z->block_left--;
+    z->raw_left--;
+}
+
+static void PixelRGB( uint8_t px, bool mono, uint8_t rgb[3] )
+{
+    if ( mono )
+    {
+        rgb[0] = rgb[1] = rgb[2] = (px & 1) ? 0xFF : 0x00;
+        return;
+    }
+    rgb[0] = (uint8_t)(((px >> 4) & 3) * 85);       // RRGGBB
+    rgb[1] = (uint8_t)(((px >> 2) & 3) * 85);
+    rgb[2] = (uint8_t)((px & 3) * 85);
+}
+
+seStatus seEMU_WritePNG( const char *path, seEMU_Source src )
+{
+    static const uint8_t sig[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    uint16_t dispctl = Rd16( MDC_DISPCTL );
+    bool     mono = (dispctl & MDC_DISPSPI_bits) && !(dispctl & MDC_SPITYPE_bits);
+    uint32_t w, h, stride, x, y, raw, blocks;
+    const uint8_t *pix;
+    uint8_t  ihdr[13], b[4], rgb[3];
+    PngOut   z;
+
+    if ( src == seEMU_SRC_PANEL )
+    {
+        w = panel_w;
+        h = panel_h;
+        stride = w;
+        pix = panel;
+    }
+    else
+    {
+        w = Rd16( MDC_DISPWIDTH );
+        h = Rd16( MDC_DISPHEIGHT );
+        stride = Rd16( MDC_DISPSTRIDE );
+        pix = RamPtr( Rd32( MDC_DISPFRMBUFF0 ), (h != 0) ? (h - 1) * stride + w : 0 );
+    }
+    if ( w == 0 || h == 0 || pix == NULL )
+        return seSTATUS_NG;
+
+    memset( &z, 0, sizeof(z) );
+    z.f = fopen( path, "wb" );
+    if ( z.f == NULL )
+        return seSTATUS_NG;
+
+    if ( fwrite( sig, 1, sizeof(sig), z.f ) != sizeof(sig) )
+        z.err = true;
+
+    PngBE32( &ihdr[0], w );
+    PngBE32( &ihdr[4], h );
+    ihdr[8]  = 8;                                   // Bit depth
+    ihdr[9]  = 2;                                   // RGB
+    ihdr[10] = 0;
+    ihdr[11] = 0;
+    ihdr[12] = 0;
+    PngChunkStart( &z, "IHDR", sizeof(ihdr) );
+    PngBytes( &z, ihdr, sizeof(ihdr) );
+    PngChunkEnd( &z );
+
+    raw    = h * (1 + w * 3);
+    blocks = (raw + 65534) / 65535;
+    z.raw_left = raw;
+    z.adler_a  = 1;
+    PngChunkStart( &z, "IDAT", 2 + blocks * 5 + raw + 4 );
+    b[0] = 0x78;                                    // Deflate, 32K window
+    b[1] = 0x01;
+    PngBytes( &z, b, 2 );
+    for ( y = 0; y < h; y++ )
+    {
+        PngRaw( &z, 0 );                            // Filter: none
+        for ( x = 0; x < w; x++ )
+        {
+            PixelRGB( pix[y * stride + x], mono, rgb );
+            PngRaw( &z, rgb[0] );
+            PngRaw( &z, rgb[1] );
+            PngRaw( &z, rgb[2] );
+        }
+    }
+    PngBE32( b, (z.adler_b << 16) | z.adler_a );
+    PngBytes( &z, b, 4 );
+    PngChunkEnd( &z );
+
+    PngChunkStart( &z, "IEND", 0 );
+    PngChunkEnd( &z );
+
+    if ( fclose( z.f ) != 0 )
+        z.err = true;
+    return z.err ? seSTATUS_NG : seSTATUS_OK;
+}
@@ -0,0 +1,136 @@
+/**
+  ******************************************************************************
+  * @file    s1d13c00_emu.h
+  * @brief   In-process S1D13C00 emulator, an HCL transport (seS1D13C00EmuTransport).
+  ******************************************************************************
+  * @attention
+  *
+  * The emulator decodes the SPI page program and fast read commands sent by
+  * the HCL and serves them from a model of the chip:
+  *  - internal RAM at RAM_BASE (SE_EMU_RAM_SIZE bytes),
+  *  - the register space from s1d13c00_memregs.h, with the side effects the
+  *    library relies on: soft reset, IOSC/OSC1 start-up flags, write-1-to-clear
+  *    interrupt flags, SYS_INTS, the QSPI status flags (always ready, no flash
+  *    behind it),
+  *  - the graphics engine: rectangle, line, ellipse, image/bitmap copy with
+  *    rotation and scaling, and with shear, drawing into the 8 bpp output window
+  *    with the software model in semdc_sw.c,
+  *  - the panel update, which copies frame buffer lines to an emulated panel,
+  *  - the DMAC primary channel descriptors (basic and auto-request cycles).
+  *
+  * Time is virtual. Every transaction advances the clock by the bus timing
+  * model, seSysSleepMS() advances it by the delay, and the graphics engine,
+  * panel update and DMAC raise their completion flags once the clock has passed
+  * their modelled busy time, so the library's polling loops see realistic
+  * durations without any real waiting.
+  *
+  * Model assumptions where the register description leaves room:
+  *  - GFXROTVAL is 512 steps per turn, clockwise. Scale values are 8.8 fixed
+  *    point (256 = 1.0), shear values 0.8 fixed point.
+  *  - 1-bit bitmaps: MSB first, (stride / 8) + 1 bytes per row, set bits drawn
+  *    in GFXCOLOR, clear bits transparent. 2-bit bitmaps: (stride / 4) + 1 bytes
+  *    per row, non-zero pixels drawn in GFXCOLOR. Images are 8 bpp and copied
+  *    as is, alpha is not modelled.
+  *  - A line or border thickness of 0 draws 1 pixel wide.
+  *  - GFXOWLEFT/RIGHT/TOP/BOT clip the output only while RIGHT or BOT is non-zero.
+  ******************************************************************************
+  */
+
+#ifndef S1D13C00_EMU_H_
+#define S1D13C00_EMU_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "se_common.h"
+
+#ifndef SE_EMU_RAM_SIZE
+#define SE_EMU_RAM_SIZE         0x20000         ///< Internal RAM size in bytes
+#endif
+
+#ifndef SE_EMU_PANEL_MAX
+#define SE_EMU_PANEL_MAX        (320 * 320)     ///< Largest emulated panel in pixels
+#endif
+
+
+/**
+  * @brief  Bus and engine timing model. Zero speeds take the values passed
+  *         to seS1D13C00InitializeController().
+  */
+typedef struct {
+    uint32_t xact_ns;                   ///< Overhead per chip select cycle (CS setup/hold, driver)
+    uint32_t wr_hz;                     ///< SPI clock for writes
+    uint32_t rd_hz;                     ///< SPI clock for reads
+    uint32_t sysclk_hz;                 ///< Graphics engine and DMAC clock
+    uint32_t gfx_setup_cycles;          ///< Cycles per graphics operation
+    uint32_t gfx_cycles_per_px;         ///< Cycles per destination pixel visited
+    uint32_t dma_cycles_per_xfer;       ///< Cycles per DMAC data item
+} seEMU_Timing;
+
+
+/**
+  * @brief  Counters since the last seEMU_ResetStats().
+  */
+typedef struct {
+    uint32_t xacts;                     ///< Chip select cycles
+    uint32_t wr_bytes;                  ///< Bytes sent, headers included
+    uint32_t rd_bytes;                  ///< Bytes received
+    uint32_t gfx_ops;                   ///< Graphics engine triggers
+    uint32_t gfx_overruns;              ///< Triggers while the engine was still busy
+    uint64_t gfx_busy_ns;               ///< Modelled engine busy time
+    uint32_t gfx_px;                    ///< Destination pixels visited
+    uint32_t upd_ops;                   ///< Panel updates
+    uint32_t lines_updated;             ///< Panel lines sent
+    uint64_t upd_busy_ns;               ///< Modelled panel update time
+    uint32_t dma_xfers;                 ///< DMAC data items moved
+    uint32_t bad_accesses;              ///< Accesses outside RAM and registers
+} seEMU_Stats;
+
+
+typedef enum {
+    seEMU_SRC_FRAMEBUF = 0,             ///< Frame buffer as set up in DISPFRMBUFF/DISPWIDTH/DISPHEIGHT
+    seEMU_SRC_PANEL    = 1              ///< What the panel shows after the last update
+} seEMU_Source;
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+  * @brief  Reset the chip model: clears RAM, registers, panel, clock and counters.
+  */
+void seEMU_Reset( void );
+
+/**
+  * @brief  Set or read the timing model.
+  */
+void seEMU_SetTiming( const seEMU_Timing *timing );
+void seEMU_GetTiming( seEMU_Timing *timing );
+
+/**
+  * @brief  Virtual time in nanoseconds since seEMU_Reset().
+  */
+uint64_t seEMU_Now( void );
+
+void seEMU_GetStats( seEMU_Stats *stats );
+void seEMU_ResetStats( void );
+
+/**
+  * @brief  Direct access to the emulated RAM, offset 0 is RAM_BASE. Does not
+  *         advance the clock or count as a transaction.
+  */
+uint8_t *seEMU_Ram( void );
+
+/**
+  * @brief  Write an image as an 8-bit RGB PNG file.
+  * @param  path:  file name
+  * @param  src:   frame buffer or panel
+  * @retval seSTATUS_NG if there is nothing to dump or the file cannot be written.
+  */
+seStatus seEMU_WritePNG( const char *path, seEMU_Source src );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* S1D13C00_EMU_H_ */
@@ -18,252 +18,191 @@
 //
 //===========================================================================
 
+#include <string.h>
 #include "s1d13c00_hcl.h"
-#include "s1d13C00_memregs.h"
+#include "s1d13c00_memregs.h"
 #include "se_common.h"
 #include "se_clg.h"
 #include "se_port.h"
-
+#include "s1d13c00_trace.h"
+
+#ifndef SE_HCL_DEFAULT_TRANSPORT
+#ifdef SE_HCL_HOST
+#define SE_HCL_DEFAULT_TRANSPORT    seS1D13C00EmuTransport
+#else
+#define SE_HCL_DEFAULT_TRANSPORT    seS1D13C00NrfTransport
+#endif
+#endif
+
+#ifndef SE_HCL_MULTI_TRANSPORT
+#ifdef SE_HCL_HOST
+#define SE_HCL_MULTI_TRANSPORT      SE_HCL_DEFAULT_TRANSPORT
+#else
+#define SE_HCL_MULTI_TRANSPORT      seS1D13C00NrfQspiTransport
+#endif
+#endif
+
+extern const seS1D13C00Transport SE_HCL_DEFAULT_TRANSPORT;
+extern const seS1D13C00Transport SE_HCL_MULTI_TRANSPORT;
+
+static const seS1D13C00Transport *transport = &SE_HCL_DEFAULT_TRANSPORT;
+static bool transport_set;
 static hostmcu_config hostif_type;
 static uint32_t spi_wrspeed;
 static uint32_t spi_rdspeed;
 static uint32_t system_freq;
-static uint32_t rxdata;
-static volatile uint8_t *indirect8base;
 
 
 //---------------------------------------------------------------------------
-// PRIVATE FUNCTION: SetSSI1ClkSpeed( uint32_t clkspeed )
+// PRIVATE FUNCTION: SetHeader()
+//   Command byte followed by the 32-bit address, MSB first.
 //---------------------------------------------------------------------------
-static void SetSSI1ClkSpeed( uint32_t clkspeed )
+static void SetHeader( uint8_t hdr[], uint8_t cmd, uint32_t addr )
 {
-    /*
-    uint32_t cpsrval;
-
-    cpsrval = (clkspeed * (((SSI1_CR0_R>>8)&0xFF)+1));
-    cpsrval = system_freq / cpsrval;
-    SSI1_CPSR_R = cpsrval;
-    */
+    hdr[0] = cmd;
+    hdr[1] = (uint8_t)(addr >> 24);
+    hdr[2] = (uint8_t)(addr >> 16);
+    hdr[3] = (uint8_t)(addr >>  8);
+    hdr[4] = (uint8_t)(addr >>  0);
 }
 
 
 //---------------------------------------------------------------------------
-// PRIVATE FUNCTION: InitializeSSI1()
-//
-// SSI1 pin configurations:
-//   PB4 = SSIFSS# (chip-select)
-//   PB5 = SSICLK
-//   PE4 = SSID0
-//   PE5 = SSID1
-//   PD4 = SSID2
-//   PD5 = SSID3
-//   PC7 = SPICFG[0]
-//   PC6 = SPICFG[1]
-//
+// PRIVATE FUNCTION: MaxChunk()
+//   Data bytes the transport takes in one chip select cycle.
 //---------------------------------------------------------------------------
-static void InitializeSSI1( hostmcu_config hostif )
+static uint32_t MaxChunk( uint32_t nBytes )
 {
-    /*
-    // Enable SSI1 and GPIO ports used for SPI/QSPI Host Interface
-    ROM_SysCtlPeripheralEnable(SYSCTL_PERIPH_SSI1);
-    ROM_SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOB);
-    ROM_SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOC);
-    ROM_SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOD);
-    ROM_SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOE);
-    ROM_SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOP);
-
-    // DE# output = HIGH
-    ROM_GPIOPinTypeGPIOOutput(GPIO_PORTB_BASE, GPIO_PIN_4);
-    GPIOPinWrite(GPIO_PORTB_BASE, GPIO_PIN_4, GPIO_PIN_4);
-
-    // SPICFG[1:0]
-    ROM_GPIOPinTypeGPIOOutput(GPIO_PORTC_BASE, (GPIO_PIN_6 | GPIO_PIN_7));
-    if (hostif == HOSTMCU_SPI_DUAL_ALL)
-        GPIOPinWrite(GPIO_PORTC_BASE, (GPIO_PIN_6 | GPIO_PIN_7), GPIO_PIN_6);                // SPICFG[1:0] = 10b
-    else if (hostif == HOSTMCU_SPI_QUAD_ALL)
-        GPIOPinWrite(GPIO_PORTC_BASE, (GPIO_PIN_6 | GPIO_PIN_7), (GPIO_PIN_6 | GPIO_PIN_7));  // SPICFG[1:0] = 11b
-    else
-        GPIOPinWrite(GPIO_PORTC_BASE, (GPIO_PIN_6 | GPIO_PIN_7), 0);                         // SPICFG[1:0] = 00b
-
-
-    // SSI signals
-    ROM_GPIOPinConfigure(GPIO_PB5_SSI1CLK);
-    ROM_GPIOPinConfigure(GPIO_PE4_SSI1XDAT0);
-    ROM_GPIOPinConfigure(GPIO_PE5_SSI1XDAT1);
-    ROM_GPIOPinConfigure(GPIO_PD4_SSI1XDAT2);
-    ROM_GPIOPinConfigure(GPIO_PD5_SSI1XDAT3);
-    ROM_GPIOPinTypeSSI(GPIO_PORTB_BASE, GPIO_PIN_5);
-    ROM_GPIOPinTypeSSI(GPIO_PORTD_BASE, GPIO_PIN_4 | GPIO_PIN_5);
-    ROM_GPIOPinTypeSSI(GPIO_PORTE_BASE, GPIO_PIN_4 | GPIO_PIN_5);
-
-    // Terminate floating data bus pins with pull-downs
-    GPIOPadConfigSet(GPIO_PORTE_BASE, GPIO_PIN_4, GPIO_STRENGTH_2MA, GPIO_PIN_TYPE_STD_WPD);  // HIFD0
-    GPIOPadConfigSet(GPIO_PORTE_BASE, GPIO_PIN_5, GPIO_STRENGTH_2MA, GPIO_PIN_TYPE_STD_WPD);  // HIFD1
-    GPIOPadConfigSet(GPIO_PORTD_BASE, GPIO_PIN_4, GPIO_STRENGTH_2MA, GPIO_PIN_TYPE_STD_WPD);  // HIFD2
-    GPIOPadConfigSet(GPIO_PORTD_BASE, GPIO_PIN_5, GPIO_STRENGTH_2MA, GPIO_PIN_TYPE_STD_WPD);  // HIFD3
-
-    // Drive unused Host Interface pins
-    ROM_GPIOPinTypeGPIOOutput(GPIO_PORTC_BASE, GPIO_PIN_4);                                   // HIFD7
-    GPIOPinWrite(GPIO_PORTC_BASE, GPIO_PIN_4, 0);
-    ROM_GPIOPinTypeGPIOOutput(GPIO_PORTC_BASE, GPIO_PIN_5);                                   // HIFD6
-    GPIOPinWrite(GPIO_PORTC_BASE, GPIO_PIN_5, 0);
-    ROM_GPIOPinTypeGPIOOutput(GPIO_PORTB_BASE, GPIO_PIN_3);                                   // #HIFRD
-    GPIOPinWrite(GPIO_PORTB_BASE, GPIO_PIN_3, GPIO_PIN_3);
-    ROM_GPIOPinTypeGPIOOutput(GPIO_PORTP_BASE, GPIO_PIN_3);                                   // #HIFCS
-    GPIOPinWrite(GPIO_PORTP_BASE, GPIO_PIN_3, GPIO_PIN_3);
-
-    // SSI configuration
-    ROM_SSIConfigSetExpClk(SSI1_BASE, system_freq, SSI_FRF_MOTO_MODE_0,
-                                                        SSI_MODE_MASTER, spi_wrspeed, 8);
-    ROM_SSIAdvModeSet(SSI1_BASE, SSI_ADV_MODE_READ_WRITE);
-    ROM_SSIEnable(SSI1_BASE);
-    */
+    uint32_t max = transport->max_data;
+
+    return (max != 0 && nBytes > max) ? max : nBytes;
 }
 
 
 //---------------------------------------------------------------------------
-// PRIVATE FUNCTION: QSPI_TxBytes()
+// PRIVATE FUNCTION: Xfer()
+//   One chip select cycle through the transport, recorded by the tracer
+//   when it is compiled in.
 //---------------------------------------------------------------------------
-static void QSPI_TxBytes( uint8_t data[], uint32_t size ) {
+static void Xfer( uint32_t addr, const uint8_t hdr[], uint32_t hlen, const uint8_t wdata[], uint32_t wlen, uint8_t rdata[], uint32_t rlen )
+{
+#ifdef SE_HCL_TRACE
+    uint64_t t0 = seS1D13C00NowNS();
+
+    transport->xfer( hdr, hlen, wdata, wlen, rdata, rlen );
+    seTRACE_Xact( addr, (rlen != 0) ? seTRACE_READ : seTRACE_WRITE, wlen + rlen, t0, seS1D13C00NowNS() );
+#else
+    transport->xfer( hdr, hlen, wdata, wlen, rdata, rlen );
+#endif
+}
 
-  /*
-  int32_t i;
 
-  for ( i = 0; i < size ; i++ )
-  {
-      ROM_SSIDataPut(SSI1_BASE, data[i]);
-  }
-  */
+//---------------------------------------------------------------------------
+// PRIVATE FUNCTION: CalPattern()
+//   Calibration pattern: alternating bits, walking one and walking zero
+//   stress the edges, then pseudo-random bytes that differ every round.
+//---------------------------------------------------------------------------
+static void CalPattern( uint8_t buf[], uint32_t round )
+{
+    uint32_t lfsr = ((0xACE1u ^ (round << 8)) & 0xFFFFu) | 1u;
+    uint32_t i;
 
+    for ( i = 0; i < SE_HCL_CAL_LEN; i++ )
+    {
+        switch ( round )
+        {
+        case 0:  buf[i] = (i & 1) ? 0xAA : 0x55;           break;
+        case 1:  buf[i] = (uint8_t)(1u << (i & 7));        break;
+        case 2:  buf[i] = (uint8_t)~(1u << (i & 7));       break;
+        default:
+            lfsr = (lfsr >> 1) ^ ((0u - (lfsr & 1u)) & 0xB400u);
+            buf[i] = (uint8_t)lfsr;
+            break;
+        }
+    }
 }
 
+
 //---------------------------------------------------------------------------
-// PRIVATE FUNCTION: QSPI_RxBytes()
+// PRIVATE FUNCTION: CalTry()
+//   All rounds written at wrspeed and read back at rdspeed.
 //---------------------------------------------------------------------------
-static void QSPI_RxBytes( uint8_t data[], uint32_t size ) {
+static bool CalTry( uint32_t addr, uint32_t wrspeed, uint32_t rdspeed )
+{
+    uint8_t  pattern[SE_HCL_CAL_LEN];
+    uint8_t  back[SE_HCL_CAL_LEN];
+    uint32_t round;
+
+    transport->set_speed( wrspeed, rdspeed );
+    for ( round = 0; round < SE_HCL_CAL_ROUNDS; round++ )
+    {
+        CalPattern( pattern, round );
+        seS1D13C00Write( addr, pattern, SE_HCL_CAL_LEN );
+        seS1D13C00Read( addr, back, SE_HCL_CAL_LEN );
+        if ( memcmp( pattern, back, SE_HCL_CAL_LEN ) != 0 )
+            return false;
+    }
+    return true;
+}
 
-  /*
-  int32_t i;
 
-  // Dummy byte read
-  SSI1_DR_R = 0x11;  // Dummy write
-  ROM_SSIDataGet(SSI1_BASE, &rxdata);
+//---------------------------------------------------------------------------
+// PRIVATE FUNCTION: CalSweep()
+//   Speed of one direction, the other staying at its reference speed.
+//   Speeds are tried upwards until one fails. The result keeps one step of
+//   margin below the fastest passing speed, unless all of them passed, and
+//   is 0 if the slowest failed.
+//---------------------------------------------------------------------------
+static uint32_t CalSweep( uint32_t addr, const uint32_t speeds[], uint32_t count, bool write )
+{
+    uint32_t i;
 
-  for ( i = 0; i < size ; i++ )
-  {
-      SSI1_DR_R = 0x11;  // Dummy write
-      ROM_SSIDataGet(SSI1_BASE, &rxdata);
-      data[i] = (uint8_t) (rxdata & 0xFF);
-  }
-  */
+    for ( i = 0; i < count; i++ )
+    {
+        if ( !CalTry( addr, write ? speeds[i] : spi_wrspeed, write ? spi_rdspeed : speeds[i] ) )
+            break;
+    }
 
+    if ( i == 0 )
+        return 0;
+    if ( i == count )
+        return speeds[count - 1];
+    return speeds[(i >= 2) ? i - 2 : 0];
 }
 
+
 //---------------------------------------------------------------------------
-// PRIVATE FUNCTION: InitializeINDIRECT8()
+// PUBLIC FUNCTION: seS1D13C00SetTransport()
+//   Select the backend used for all following accesses, instead of the one
+//   seS1D13C00InitializeController() picks for the host interface mode.
+//   NULL returns to that choice. Call before seS1D13C00InitializeController().
 //---------------------------------------------------------------------------
-static void InitializeINDIRECT8(void)
+void seS1D13C00SetTransport( const seS1D13C00Transport *t )
 {
-    /*
-    // Enable EPI0 and GPIO ports used for INDIRECT8 Host Interface
-    ROM_SysCtlPeripheralEnable(SYSCTL_PERIPH_EPI0);
-    ROM_SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOB);
-    ROM_SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOC);
-    ROM_SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOD);
-    ROM_SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOE);
-    ROM_SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOK);
-    ROM_SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOP);
-
-    // DE# output = HIGH
-    ROM_GPIOPinTypeGPIOOutput(GPIO_PORTB_BASE, GPIO_PIN_4);
-    GPIOPinWrite(GPIO_PORTB_BASE, GPIO_PIN_4, GPIO_PIN_4);
-
-    // EPI0 signals
-    ROM_GPIOPinConfigure(GPIO_PK0_EPI0S0);      // D0
-    ROM_GPIOPinConfigure(GPIO_PK1_EPI0S1);      // D1
-    ROM_GPIOPinConfigure(GPIO_PK2_EPI0S2);      // D2
-    ROM_GPIOPinConfigure(GPIO_PK3_EPI0S3);      // D3
-    ROM_GPIOPinConfigure(GPIO_PC7_EPI0S4);      // D4
-    ROM_GPIOPinConfigure(GPIO_PC6_EPI0S5);      // D5
-    ROM_GPIOPinConfigure(GPIO_PC5_EPI0S6);      // D6
-    ROM_GPIOPinConfigure(GPIO_PC4_EPI0S7);      // D7
-    ROM_GPIOPinConfigure(GPIO_PB3_EPI0S28);     // RDn
-    ROM_GPIOPinConfigure(GPIO_PP2_EPI0S29);     // WRn
-    ROM_GPIOPinConfigure(GPIO_PP3_EPI0S30);     // CSn
-    GPIOPinTypeEPI(GPIO_PORTB_BASE, GPIO_PIN_3);
-    GPIOPinTypeEPI(GPIO_PORTC_BASE, (GPIO_PIN_4 | GPIO_PIN_5 | GPIO_PIN_6 | GPIO_PIN_7));
-    GPIOPinTypeEPI(GPIO_PORTK_BASE, (GPIO_PIN_0 | GPIO_PIN_1 | GPIO_PIN_2 | GPIO_PIN_3));
-    GPIOPinTypeEPI(GPIO_PORTP_BASE, (GPIO_PIN_2 | GPIO_PIN_3));
-
-    // Terminate floating data bus pins with pull-downs
-    GPIOPadConfigSet(GPIO_PORTE_BASE, GPIO_PIN_4, GPIO_STRENGTH_2MA, GPIO_PIN_TYPE_STD_WPD);  // HIFD0
-    GPIOPadConfigSet(GPIO_PORTE_BASE, GPIO_PIN_5, GPIO_STRENGTH_2MA, GPIO_PIN_TYPE_STD_WPD);  // HIFD1
-    GPIOPadConfigSet(GPIO_PORTD_BASE, GPIO_PIN_4, GPIO_STRENGTH_2MA, GPIO_PIN_TYPE_STD_WPD);  // HIFD2
-    GPIOPadConfigSet(GPIO_PORTD_BASE, GPIO_PIN_5, GPIO_STRENGTH_2MA, GPIO_PIN_TYPE_STD_WPD);  // HIFD3
-    GPIOPadConfigSet(GPIO_PORTC_BASE, GPIO_PIN_7, GPIO_STRENGTH_2MA, GPIO_PIN_TYPE_STD_WPD);  // HIFD4
-    GPIOPadConfigSet(GPIO_PORTC_BASE, GPIO_PIN_6, GPIO_STRENGTH_2MA, GPIO_PIN_TYPE_STD_WPD);  // HIFD5
-    GPIOPadConfigSet(GPIO_PORTC_BASE, GPIO_PIN_5, GPIO_STRENGTH_2MA, GPIO_PIN_TYPE_STD_WPD);  // HIFD6
-    GPIOPadConfigSet(GPIO_PORTC_BASE, GPIO_PIN_4, GPIO_STRENGTH_2MA, GPIO_PIN_TYPE_STD_WPD);  // HIFD7
-
-    // EPI configuration
-    ROM_EPIModeSet(EPI0_BASE, EPI_MODE_HB8);
-    ROM_EPIDividerSet(EPI0_BASE, 5);
-    ROM_EPIConfigHB8Set(EPI0_BASE, (EPI_HB8_MODE_ADDEMUX | EPI_HB8_WRWAIT_3 | EPI_HB8_RDWAIT_3 | EPI_HB8_CSCFG_CS), 0);
-    ROM_EPIAddressMapSet(EPI0_BASE, (EPI_ADDR_PER_SIZE_256B | EPI_ADDR_PER_BASE_A));
-
-    indirect8base = (uint8_t *)0xA0000000;  // Base address of EPI bus
-    */
+    transport_set = ( t != NULL );
+    if ( t != NULL )
+        transport = t;
 }
 
-#include "nrf_drv_spi.h"
-#include "app_util_platform.h"
-#include "nrf_gpio.h"
-#include "nrf_delay.h"
-#include "boards.h"
-#include "app_error.h"
-#include "nrf_log.h"
-#include "nrf_log_ctrl.h"
-#include "nrf_log_default_backends.h"
-
-#define SPI_INSTANCE  0 /**< SPI instance index. */
-static const nrf_drv_spi_t spi = NRF_DRV_SPI_INSTANCE(SPI_INSTANCE);  /**< SPI instance. */
-static volatile bool spi_xfer_done;  /**< Flag used to indicate that SPI instance completed the transfer. */
-
-#define TEST_STRING "Nordic"
-static uint8_t       m_tx_buf[64];// = TEST_STRING;           /**< TX buffer. */
-static uint8_t       m_rx_buf[64];//[sizeof(TEST_STRING) + 1];    /**< RX buffer. */
-static uint8_t m_length = 0;//sizeof(m_tx_buf);        /**< Transfer length. */
-
-/**
- * @brief SPI user event handler.
- * @param event
- */
-void spi_event_handler(nrf_drv_spi_evt_t const * p_event,
-                       void *                    p_context)
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seS1D13C00HostIfTransport()
+//   Backend seS1D13C00InitializeController() picks for a host interface mode
+//   when none was set: SE_HCL_MULTI_TRANSPORT for the dual and quad modes,
+//   SE_HCL_DEFAULT_TRANSPORT for single data SPI. For wrappers around it.
+//---------------------------------------------------------------------------
+const seS1D13C00Transport *seS1D13C00HostIfTransport( hostmcu_config hostif )
 {
-    spi_xfer_done = true;
-    NRF_LOG_INFO("Transfer completed.");
-    if (m_rx_buf[0] != 0)
-    {
-        NRF_LOG_INFO(" Received:");
-        NRF_LOG_HEXDUMP_INFO(m_rx_buf, strlen((const char *)m_rx_buf));
-    }
+    return ( hostif == HOSTMCU_SPI_MONOADDR_MONODATA ) ? &SE_HCL_DEFAULT_TRANSPORT : &SE_HCL_MULTI_TRANSPORT;
 }
 
-void initSPI(void)
-{
-    
-    nrf_drv_spi_config_t spi_config = NRF_DRV_SPI_DEFAULT_CONFIG;
-    spi_config.ss_pin    = SPI_SS_PIN;
-    spi_config.miso_pin  = SPI_MISO_PIN;
-    spi_config.mosi_pin  = SPI_MOSI_PIN;
-    spi_config.sck_pin   = SPI_SCK_PIN;
-    spi_config.frequency = NRF_DRV_SPI_FREQ_500K;
-    spi_config.mode      = NRF_DRV_SPI_MODE_0;
-    spi_config.bit_order = NRF_DRV_SPI_BIT_ORDER_MSB_FIRST;
-
-    APP_ERROR_CHECK(nrf_drv_spi_init(&spi, &spi_config, spi_event_handler, NULL));
 
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seS1D13C00GetTransport()
+//---------------------------------------------------------------------------
+const seS1D13C00Transport *seS1D13C00GetTransport( void )
+{
+    return transport;
 }
 
 
@@ -272,33 +211,108 @@ void initSPI(void)
 //---------------------------------------------------------------------------
 void seS1D13C00InitializeController( hostmcu_config hostif, uint32_t sysfreq, uint32_t spi_writespeed, uint32_t spi_readspeed )
 {
-    hostif_type = hostif;
+    seS1D13C00ResumeController( hostif, sysfreq, spi_writespeed, spi_readspeed );
+    seS1D13C00SoftReset();
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seS1D13C00ResumeController()
+//   Host side of seS1D13C00InitializeController() only, the controller keeps
+//   its state. For a host waking up next to a controller that stayed powered.
+//---------------------------------------------------------------------------
+void seS1D13C00ResumeController( hostmcu_config hostif, uint32_t sysfreq, uint32_t spi_writespeed, uint32_t spi_readspeed )
+{
     spi_wrspeed = spi_writespeed;
     spi_rdspeed = spi_readspeed;
     system_freq = sysfreq;
 
-    switch(hostif)
-    {
-        case(HOSTMCU_SPI_MONOADDR_MONODATA):
-            initSPI();
-        case(HOSTMCU_SPI_MONOADDR_DUALDATA):
-        case(HOSTMCU_SPI_DUALADDR_DUALDATA):
-        case(HOSTMCU_SPI_MONOADDR_QUADDATA):
-        case(HOSTMCU_SPI_QUADADDR_QUADDATA):
-        case(HOSTMCU_SPI_DUAL_ALL):
-        case(HOSTMCU_SPI_QUAD_ALL):
-            InitializeSSI1(hostif);
-            break;
+    if ( !transport_set )
+        transport = seS1D13C00HostIfTransport( hostif );
 
-        case(HOSTMCU_INDIRECT_8BIT):
-            InitializeINDIRECT8();
-            break;
+    // Modes the transport cannot drive fall back to single data SPI
+    hostif_type = transport->init( hostif, spi_wrspeed, spi_rdspeed );
+}
 
-        default:
-            return;
-    }
 
-   seS1D13C00SoftReset();
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seS1D13C00GetHostIf()
+//   Host interface mode set up by seS1D13C00InitializeController(), which
+//   differs from the one requested after a fallback.
+//---------------------------------------------------------------------------
+hostmcu_config seS1D13C00GetHostIf( void )
+{
+    return hostif_type;
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seS1D13C00SetSpeed()
+//   Replace the write and read speeds, e.g. with calibrated ones kept from
+//   an earlier boot. No effect on transports without set_speed().
+//---------------------------------------------------------------------------
+void seS1D13C00SetSpeed( uint32_t spi_writespeed, uint32_t spi_readspeed )
+{
+    if ( transport->set_speed == NULL )
+        return;
+
+    spi_wrspeed = spi_writespeed;
+    spi_rdspeed = spi_readspeed;
+    transport->set_speed( spi_wrspeed, spi_rdspeed );
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seS1D13C00GetSpeed()
+//---------------------------------------------------------------------------
+void seS1D13C00GetSpeed( uint32_t *spi_writespeed, uint32_t *spi_readspeed )
+{
+    *spi_writespeed = spi_wrspeed;
+    *spi_readspeed = spi_rdspeed;
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seS1D13C00CalibrateSpeed()
+//   Find the fastest reliable write and read speeds among speeds[], given in
+//   increasing order, by writing and reading back patterns at addr, which
+//   must be SE_HCL_CAL_LEN bytes of S1D13C00 RAM. The current speeds are the
+//   reference and must work. Reads are calibrated first with reference
+//   writes, then writes with reference reads.
+//
+//   The RAM is restored at the reference speeds, then the controller is
+//   soft reset, since a header corrupted at a failing speed may have written
+//   a register. Call it right after seS1D13C00InitializeController(),
+//   before the clocks and the panel are set up. On success the
+//   speeds are set and returned, otherwise the reference speeds stay.
+//---------------------------------------------------------------------------
+seStatus seS1D13C00CalibrateSpeed( uint32_t addr, const uint32_t speeds[], uint32_t count,
+                                   uint32_t *spi_writespeed, uint32_t *spi_readspeed )
+{
+    uint8_t  saved[SE_HCL_CAL_LEN];
+    uint32_t wr;
+    uint32_t rd;
+
+    if ( transport->set_speed == NULL || count == 0 )
+        return seSTATUS_NG;
+
+    seS1D13C00Read( addr, saved, SE_HCL_CAL_LEN );
+
+    rd = CalSweep( addr, speeds, count, false );
+    wr = CalSweep( addr, speeds, count, true );
+
+    transport->set_speed( spi_wrspeed, spi_rdspeed );
+    seS1D13C00Write( addr, saved, SE_HCL_CAL_LEN );
+    seS1D13C00SoftReset();
+
+    if ( wr == 0 || rd == 0 )
+        return seSTATUS_NG;
+
+    seS1D13C00SetSpeed( wr, rd );
+    *spi_writespeed = wr;
+    *spi_readspeed = rd;
+
+    return seSTATUS_OK;
 }
 
 
@@ -308,12 +322,31 @@ void seS1D13C00InitializeController( hostmcu_config hostif, uint32_t sysfreq, ui
 void seS1D13C00SoftReset( void )
 {
     seS1D13C00Write16(SYS_CTRL, 0x8000);  // Soft reset
-
-    // >20us delay before doing anything else
     seSysSleepMS(1);
 }
 
 
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seS1D13C00SleepMS()
+//   Delay used by the library (seSysSleepMS). The emulator advances its
+//   clock instead of sleeping.
+//---------------------------------------------------------------------------
+void seS1D13C00SleepMS( uint32_t msval )
+{
+    transport->sleep_ms( msval );
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seS1D13C00NowNS()
+//   Transport time base in nanoseconds, 0 if the transport has none.
+//---------------------------------------------------------------------------
+uint64_t seS1D13C00NowNS( void )
+{
+    return (transport->now_ns != NULL) ? transport->now_ns() : 0;
+}
+
+
 //---------------------------------------------------------------------------
 // PUBLIC FUNCTION: seS1D13C00InitDispEn()
 //   Initialize Display Enable control output for SPI panels.
@@ -325,8 +358,6 @@ void seS1D13C00InitDispEn( void )
 }
 
 
-
-
 //---------------------------------------------------------------------------
 // PUBLIC FUNCTION: seS1D13C00DispEnable()
 //   Set Display Enable HIGH for SPI panels.
@@ -337,8 +368,6 @@ void seS1D13C00DispEnable( void )
 }
 
 
-
-
 //---------------------------------------------------------------------------
 // PUBLIC FUNCTION: seS1D13C00DispDisable()
 //   Set Display Enable LOW for SPI panels.
@@ -349,176 +378,63 @@ void seS1D13C00DispDisable( void )
 }
 
 
-
-
 //---------------------------------------------------------------------------
 // PUBLIC FUNCTION: seS1D13C00Write()
+//   Page program: command, address, data. Accesses longer than the
+//   transport takes at once are split, the address auto-increments.
 //---------------------------------------------------------------------------
 void seS1D13C00Write( uint32_t addr, uint8_t data[], uint32_t nBytes )
 {
+    uint8_t hdr[SE_HCL_WRITE_HDR_LEN];
+    uint32_t k;
 
-    uint32_t k, i;
-    uint8_t write[5];
-
-    if (nBytes == 0)
-       return;
-
-    // change the spi speed later
-    //if (hostif_type != HOSTMCU_INDIRECT_8BIT)
-    //   SetSSI1ClkSpeed(spi_wrspeed);
-    
-    write[1] = (uint8_t)(addr >> 24);
-    write[2] = (uint8_t)(addr >> 16);
-    write[3] = (uint8_t)(addr >>  8);
-    write[4] = (uint8_t)(addr >>  0);
-
-    // case HOSTMCU_SPI_MONOADDR_MONODATA
-    write[0] = CMD_PAGEPROG;
-
-    // beginning of sending the data over spi
-    m_length = nBytes + 5;
-
-    // Reset rx buffer and transfer done flag
-    memset(m_rx_buf, 0, m_length);
-    spi_xfer_done = false;
-
-    //memset(m_tx_buf, (int)write, 5);
-    //for(i = 0; i < 5; i++)
-    //{
-    //    m_tx_buf[i] = write[i];
-    //}
-    m_tx_buf[0] = write[0];
-    m_tx_buf[1] = write[1];
-    m_tx_buf[2] = write[2];
-    m_tx_buf[3] = write[3];
-    m_tx_buf[4] = write[4];
-    //memset(m_tx_buf+5, (int)data, nBytes);
-    for(i = 0; i < nBytes; i++)
+    while (nBytes > 0)
     {
-        m_tx_buf[i + 5] = data[i];
+        k = MaxChunk( nBytes );
+        SetHeader( hdr, CMD_PAGEPROG, addr );
+        Xfer( addr, hdr, sizeof(hdr), data, k, NULL, 0 );
+        addr   += k;
+        data   += k;
+        nBytes -= k;
     }
+}
 
-    APP_ERROR_CHECK(nrf_drv_spi_transfer(&spi, m_tx_buf, m_length, m_rx_buf, m_length));
-    //nrf_drv_spi_transfer(&spi, m_tx_buf, m_length, m_rx_buf, m_length);
 
-    while (!spi_xfer_done)
-    {
-        __WFE();
-    }
-
-    /*
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seS1D13C00WriteStart()
+//   As seS1D13C00Write(), returning while the last cycle is still sent
+//   when the transport can start writes. data can be reused at once, the
+//   next access waits for the write. The tracer times the starts only.
+//---------------------------------------------------------------------------
+void seS1D13C00WriteStart( uint32_t addr, const uint8_t data[], uint32_t nBytes )
+{
+    uint8_t hdr[SE_HCL_WRITE_HDR_LEN];
     uint32_t k;
-    uint8_t write[5];
-
-    if (nBytes == 0)
-       return;
+#ifdef SE_HCL_TRACE
+    uint64_t t0;
+#endif
 
-    if (hostif_type != HOSTMCU_INDIRECT_8BIT)
-       SetSSI1ClkSpeed(spi_wrspeed);
-
-    write[1] = (uint8_t)(addr >> 24);
-    write[2] = (uint8_t)(addr >> 16);
-    write[3] = (uint8_t)(addr >>  8);
-    write[4] = (uint8_t)(addr >>  0);
-
-    // Host access to the S1D13C00 must be completely contained.
-    // If another device were to interrupt and modify any of the
-    // interface hardware in use then future communications could
-    // be affected, thus the interrupt master disable/enable.
-    // NOTE: there may be other control mechanisms to ensure singular
-    //       access (eg. a flag or semaphore) whose implementation is
-    //       dependent on the environment.
-    ROM_IntMasterDisable();
-
-    GPIOPinWrite(GPIO_PORTB_BASE, GPIO_PIN_4, 0);  // Assert DE#
-
-    if (hostif_type != HOSTMCU_INDIRECT_8BIT)
+    if ( transport->write_start == NULL )
     {
-       switch(hostif_type)
-       {
-          case HOSTMCU_SPI_MONOADDR_MONODATA:
-             write[0] = CMD_PAGEPROG;
-             ROM_SSIAdvModeSet(SSI1_BASE, SSI_ADV_MODE_READ_WRITE);
-             QSPI_TxBytes( &(write[0]), 5 );
-             QSPI_TxBytes( data, nBytes );
-             break;
-
-          case HOSTMCU_SPI_MONOADDR_DUALDATA:
-             write[0] = CMD_DUALINFASTPROG;
-             ROM_SSIAdvModeSet(SSI1_BASE, SSI_ADV_MODE_READ_WRITE);
-             QSPI_TxBytes( &(write[0]), 5 );
-             ROM_SSIAdvModeSet(SSI1_BASE, SSI_ADV_MODE_BI_WRITE);
-             QSPI_TxBytes( data, nBytes );
-             break;
-
-          case HOSTMCU_SPI_DUALADDR_DUALDATA:
-             write[0] = CMD_EXTDUALINFASTPROG;
-             ROM_SSIAdvModeSet(SSI1_BASE, SSI_ADV_MODE_READ_WRITE);
-             QSPI_TxBytes( &(write[0]), 1 );
-             ROM_SSIAdvModeSet(SSI1_BASE, SSI_ADV_MODE_BI_WRITE);
-             QSPI_TxBytes( &(write[1]), 4 );
-             QSPI_TxBytes( data, nBytes );
-             break;
-
-          case HOSTMCU_SPI_MONOADDR_QUADDATA:
-             write[0] = CMD_QUADINFASTPROG;
-             ROM_SSIAdvModeSet(SSI1_BASE, SSI_ADV_MODE_READ_WRITE);
-             QSPI_TxBytes( &(write[0]), 5 );
-             ROM_SSIAdvModeSet(SSI1_BASE, SSI_ADV_MODE_QUAD_WRITE);
-             QSPI_TxBytes( data, nBytes );
-             break;
-
-          case HOSTMCU_SPI_QUADADDR_QUADDATA:
-             write[0] = CMD_EXTQUADINFASTPROG;
-             ROM_SSIAdvModeSet(SSI1_BASE, SSI_ADV_MODE_READ_WRITE);
-             QSPI_TxBytes( &(write[0]), 1 );
-             ROM_SSIAdvModeSet(SSI1_BASE, SSI_ADV_MODE_QUAD_WRITE);
-             QSPI_TxBytes( &(write[1]), 4 );
-             QSPI_TxBytes( data, nBytes );
-             break;
-
-          case HOSTMCU_SPI_DUAL_ALL:
-             write[0] = CMD_EXTDUALINFASTPROG;
-             ROM_SSIAdvModeSet(SSI1_BASE, SSI_ADV_MODE_BI_WRITE);
-             QSPI_TxBytes( &(write[0]), 5 );
-             QSPI_TxBytes( data, nBytes );
-             break;
-
-          case HOSTMCU_SPI_QUAD_ALL:
-             write[0] = CMD_EXTQUADINFASTPROG;
-             ROM_SSIAdvModeSet(SSI1_BASE, SSI_ADV_MODE_QUAD_WRITE);
-             QSPI_TxBytes( &(write[0]), 5 );
-             QSPI_TxBytes( data, nBytes );
-             break;
-
-       }
-
+        seS1D13C00Write( addr, (uint8_t *)data, nBytes );
+        return;
     }
-    else
+
+    while (nBytes > 0)
     {
-        write[0] = CMD_PAGEPROG;
-        for (k = 0; k < 5; k++)
-        {
-            *indirect8base = write[k];
-            while((EPI0_STAT_R & EPI_STAT_WBUSY) != 0);
-        }
-        for (k = 0; k < nBytes; k++)
-        {
-            *indirect8base = data[k];
-            while((EPI0_STAT_R & EPI_STAT_WBUSY) != 0);
-        }
+        k = MaxChunk( nBytes );
+        SetHeader( hdr, CMD_PAGEPROG, addr );
+#ifdef SE_HCL_TRACE
+        t0 = seS1D13C00NowNS();
+        transport->write_start( hdr, sizeof(hdr), data, k );
+        seTRACE_Xact( addr, seTRACE_WRITE, k, t0, seS1D13C00NowNS() );
+#else
+        transport->write_start( hdr, sizeof(hdr), data, k );
+#endif
+        addr   += k;
+        data   += k;
+        nBytes -= k;
     }
-
-    if (hostif_type != HOSTMCU_INDIRECT_8BIT)
-       while(ROM_SSIBusy(SSI1_BASE));
-
-    for (k = 0; k < 4; k++)
-       GPIOPinWrite(GPIO_PORTB_BASE, GPIO_PIN_4, 0);  // Assert DE#
-
-    GPIOPinWrite(GPIO_PORTB_BASE, GPIO_PIN_4, GPIO_PIN_4);  // De-assert DE#
-
-    ROM_IntMasterEnable();
-    */
 }
 
 
@@ -551,182 +467,23 @@ void seS1D13C00Write32( uint32_t addr, uint32_t data )
 
 //---------------------------------------------------------------------------
 // PUBLIC FUNCTION: seS1D13C00Read()
+//   Fast read: command and address, then data with no dummy byte, the
+//   transfer the board was brought up with.
 //---------------------------------------------------------------------------
 void seS1D13C00Read( uint32_t addr, uint8_t data[], uint32_t nBytes )
 {
-
-    uint8_t write[5];
-    uint32_t k, i;
-
-    // change the spi speed later
-    //if (hostif_type != HOSTMCU_INDIRECT_8BIT)
-    //   SetSSI1ClkSpeed(spi_rdspeed);
-
-    write[1] = (uint8_t)(addr >> 24);
-    write[2] = (uint8_t)(addr >> 16);
-    write[3] = (uint8_t)(addr >>  8);
-    write[4] = (uint8_t)(addr >>  0);
-
-    // case HOSTMCU_SPI_MONOADDR_MONODATA:
-    write[0] = CMD_FASTREAD;
-
-    // beginning of receiving the data over spi
-    m_length = nBytes + 5;
-
-    // Reset rx buffer and transfer done flag
-    memset(m_rx_buf, 0, m_length);
-    spi_xfer_done = false;
-
-    //memset(m_tx_buf, (int)write, 5);
-    m_tx_buf[0] = write[0];
-    m_tx_buf[1] = write[1];
-    m_tx_buf[2] = write[2];
-    m_tx_buf[3] = write[3];
-    m_tx_buf[4] = write[4];
-
-    APP_ERROR_CHECK(nrf_drv_spi_transfer(&spi, m_tx_buf, m_length, m_rx_buf, m_length));
-    //nrf_drv_spi_transfer(&spi, m_tx_buf, m_length, m_rx_buf, m_length);
-
-    while (!spi_xfer_done)
-    {
-        __WFE();
-    }
-
-    for(i = 0; i < nBytes; i++)
-    {
-        data[i] = m_rx_buf[i + 5];
-    }
-
-    /*
-    uint8_t write[5];
+    uint8_t hdr[SE_HCL_READ_HDR_LEN];
     uint32_t k;
 
-    if (hostif_type != HOSTMCU_INDIRECT_8BIT)
-       SetSSI1ClkSpeed(spi_rdspeed);
-
-    write[1] = (uint8_t)(addr >> 24);
-    write[2] = (uint8_t)(addr >> 16);
-    write[3] = (uint8_t)(addr >>  8);
-    write[4] = (uint8_t)(addr >>  0);
-
-    // Host access to the S1D13C00 must be completely contained.
-    // If another device were to interrupt and modify any of the
-    // interface hardware in use then future communications could
-    // be affected, thus the interrupt master disable/enable.
-    // NOTE: there may be other control mechanisms to ensure singular
-    //       access (eg. a flag or semaphore) whose implementation is
-    //       dependent on the environment.
-    ROM_IntMasterDisable();
-
-    GPIOPinWrite(GPIO_PORTB_BASE, GPIO_PIN_4, 0);  // Assert DE#
-
-    if (hostif_type != HOSTMCU_INDIRECT_8BIT)
+    while (nBytes > 0)
     {
-       switch(hostif_type)
-       {
-          case HOSTMCU_SPI_MONOADDR_MONODATA:
-             write[0] = CMD_FASTREAD;
-             ROM_SSIAdvModeSet(SSI1_BASE, SSI_ADV_MODE_READ_WRITE);
-             QSPI_TxBytes( &(write[0]), 5 );
-             while(ROM_SSIBusy(SSI1_BASE));  // Wait for cmd and address to finish
-             while(ROM_SSIDataGetNonBlocking(SSI1_BASE, &rxdata));  // Clear out RX bytes
-             QSPI_RxBytes( data, nBytes );    // Includes dummy byte already
-
-             break;
-
-          case HOSTMCU_SPI_MONOADDR_DUALDATA:
-             write[0] = CMD_DUALOUTFASTREAD;
-             ROM_SSIAdvModeSet(SSI1_BASE, SSI_ADV_MODE_READ_WRITE);
-             QSPI_TxBytes( &(write[0]), 5 );
-             while(ROM_SSIBusy(SSI1_BASE));  // Wait for cmd and address to finish
-             while(ROM_SSIDataGetNonBlocking(SSI1_BASE, &rxdata));  // Clear out RX bytes
-             ROM_SSIAdvModeSet(SSI1_BASE, SSI_ADV_MODE_BI_READ);
-             QSPI_RxBytes( data, nBytes );    // Includes dummy byte already
-             break;
-
-          case HOSTMCU_SPI_DUALADDR_DUALDATA:
-             write[0] = CMD_DUALIOFASTREAD;
-             ROM_SSIAdvModeSet(SSI1_BASE, SSI_ADV_MODE_READ_WRITE);
-             QSPI_TxBytes( &(write[0]), 1 );
-             ROM_SSIAdvModeSet(SSI1_BASE, SSI_ADV_MODE_BI_WRITE);
-             QSPI_TxBytes( &(write[1]), 4 );
-             while(ROM_SSIBusy(SSI1_BASE));  // Wait for cmd and address to finish
-             while(ROM_SSIDataGetNonBlocking(SSI1_BASE, &rxdata));  // Clear out RX bytes
-             ROM_SSIAdvModeSet(SSI1_BASE, SSI_ADV_MODE_BI_READ);
-             QSPI_RxBytes( data, nBytes );    // Includes dummy byte already
-             break;
-
-          case HOSTMCU_SPI_MONOADDR_QUADDATA:
-             write[0] = CMD_QUADOUTFASTREAD;
-             ROM_SSIAdvModeSet(SSI1_BASE, SSI_ADV_MODE_READ_WRITE);
-             QSPI_TxBytes( &(write[0]), 5 );
-             while(ROM_SSIBusy(SSI1_BASE));  // Wait for cmd and address to finish
-             while(ROM_SSIDataGetNonBlocking(SSI1_BASE, &rxdata));  // Clear out RX bytes
-             ROM_SSIAdvModeSet(SSI1_BASE, SSI_ADV_MODE_QUAD_READ);
-             QSPI_RxBytes( data, nBytes );    // Includes dummy byte already
-             break;
-
-          case HOSTMCU_SPI_QUADADDR_QUADDATA:
-             write[0] = CMD_QUADIOFASTREAD;
-             ROM_SSIAdvModeSet(SSI1_BASE, SSI_ADV_MODE_READ_WRITE);
-             QSPI_TxBytes( &(write[0]), 1 );
-             ROM_SSIAdvModeSet(SSI1_BASE, SSI_ADV_MODE_QUAD_WRITE);
-             QSPI_TxBytes( &(write[1]), 4 );
-             while(ROM_SSIBusy(SSI1_BASE));  // Wait for cmd and address to finish
-             while(ROM_SSIDataGetNonBlocking(SSI1_BASE, &rxdata));  // Clear out RX bytes
-             ROM_SSIAdvModeSet(SSI1_BASE, SSI_ADV_MODE_QUAD_READ);
-             QSPI_RxBytes( data, nBytes );    // Includes dummy byte already
-             break;
-
-          case HOSTMCU_SPI_DUAL_ALL:
-             write[0] = CMD_DUALIOFASTREAD;
-             ROM_SSIAdvModeSet(SSI1_BASE, SSI_ADV_MODE_BI_WRITE);
-             QSPI_TxBytes( &(write[0]), 5 );
-             while(ROM_SSIBusy(SSI1_BASE));  // Wait for cmd and address to finish
-             while(ROM_SSIDataGetNonBlocking(SSI1_BASE, &rxdata));  // Clear out RX bytes
-             ROM_SSIAdvModeSet(SSI1_BASE, SSI_ADV_MODE_BI_READ);
-             QSPI_RxBytes( data, nBytes );    // Includes dummy byte already
-             break;
-
-          case HOSTMCU_SPI_QUAD_ALL:
-             write[0] = CMD_QUADIOFASTREAD;
-             ROM_SSIAdvModeSet(SSI1_BASE, SSI_ADV_MODE_QUAD_WRITE);
-             QSPI_TxBytes( &(write[0]), 5 );
-             while(ROM_SSIBusy(SSI1_BASE));  // Wait for cmd and address to finish
-             while(ROM_SSIDataGetNonBlocking(SSI1_BASE, &rxdata));  // Clear out RX bytes
-             ROM_SSIAdvModeSet(SSI1_BASE, SSI_ADV_MODE_QUAD_READ);
-             QSPI_RxBytes( data, nBytes );    // Includes dummy byte already
-             break;
-
-       }
+        k = MaxChunk( nBytes );
+        SetHeader( hdr, CMD_FASTREAD, addr );
+        Xfer( addr, hdr, sizeof(hdr), NULL, 0, data, k );
+        addr   += k;
+        data   += k;
+        nBytes -= k;
     }
-    else
-    {
-        write[0] = CMD_FASTREAD;
-        for (k = 0; k < 5; k++)
-        {
-            *indirect8base = write[k];
-            while((EPI0_STAT_R & EPI_STAT_WBUSY) != 0);
-        }
-
-        data[0] = *indirect8base;  // Dummy byte read
-        for (k = 0; k < nBytes; k++)
-        {
-            data[k] = *indirect8base;
-            while((EPI0_STAT_R & EPI_STAT_NBRBUSY) != 0);
-        }
-    }
-
-    if (hostif_type != HOSTMCU_INDIRECT_8BIT)
-       while(ROM_SSIBusy(SSI1_BASE));
-
-    for (k = 0; k < 4; k++)
-       GPIOPinWrite(GPIO_PORTB_BASE, GPIO_PIN_4, 0);  // Assert DE#
-
-    GPIOPinWrite(GPIO_PORTB_BASE, GPIO_PIN_4, GPIO_PIN_4);  // De-assert DE#
-
-    ROM_IntMasterEnable();
-    */
 }
 
 
@@ -736,71 +493,22 @@ void seS1D13C00Read( uint32_t addr, uint8_t data[], uint32_t nBytes )
 uint8_t seS1D13C00Read8( uint32_t addr )
 {
     uint8_t data;
-    //seS1D13C00Read(addr, (uint8_t *)&data, 1);
-
-    // change the spi speed later
-    //if (hostif_type != HOSTMCU_INDIRECT_8BIT)
-    //   SetSSI1ClkSpeed(spi_rdspeed);
-
-    // beginning of receiving the data over spi
-    m_length = 6;
-
-    // Reset rx buffer and transfer done flag
-    //memset(m_rx_buf, 0, m_length);
-    spi_xfer_done = false;
-
-    //memset(m_tx_buf, (int)write, 5);
-    m_tx_buf[0] = CMD_FASTREAD;
-    m_tx_buf[1] = (uint8_t)(addr >> 24);
-    m_tx_buf[2] = (uint8_t)(addr >> 16);
-    m_tx_buf[3] = (uint8_t)(addr >>  8);
-    m_tx_buf[4] = (uint8_t)(addr >>  0);
-
-    APP_ERROR_CHECK(nrf_drv_spi_transfer(&spi, m_tx_buf, m_length, m_rx_buf, m_length));
 
-    while (!spi_xfer_done)
-    {
-        __WFE();
-    }
-
-    data = m_rx_buf[5];
-    
+    seS1D13C00Read(addr, &data, 1);
     return(data);
 }
 
 
 //---------------------------------------------------------------------------
 // PUBLIC FUNCTION: seS1D13C00Read16()
+//   The first byte received is the high byte.
 //---------------------------------------------------------------------------
 uint16_t seS1D13C00Read16( uint32_t addr )
 {
-    uint16_t data;
-    //seS1D13C00Read(addr, (uint8_t *)&data, 2);
-
-// beginning of receiving the data over spi
-    m_length = 7;
-
-    // Reset rx buffer and transfer done flag
-    //memset(m_rx_buf, 0, m_length);
-    spi_xfer_done = false;
+    uint8_t data[2];
 
-    //memset(m_tx_buf, (int)write, 5);
-    m_tx_buf[0] = CMD_FASTREAD;
-    m_tx_buf[1] = (uint8_t)(addr >> 24);
-    m_tx_buf[2] = (uint8_t)(addr >> 16);
-    m_tx_buf[3] = (uint8_t)(addr >>  8);
-    m_tx_buf[4] = (uint8_t)(addr >>  0);
-
-    APP_ERROR_CHECK(nrf_drv_spi_transfer(&spi, m_tx_buf, m_length, m_rx_buf, m_length));
-
-    while (!spi_xfer_done)
-    {
-        __WFE();
-    }
-
-    data = ((m_rx_buf[5] << 8) | m_rx_buf[6]);
-
-    return(data);
+    seS1D13C00Read(addr, data, 2);
+    return((uint16_t)((data[0] << 8) | data[1]));
 }
 
 
@@ -810,8 +518,7 @@ uint16_t seS1D13C00Read16( uint32_t addr )
 uint32_t seS1D13C00Read32( uint32_t addr )
 {
     uint32_t data;
+
     seS1D13C00Read(addr, (uint8_t *)&data, 4);
     return(data);
 }
-
-
@@ -39,13 +39,16 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "se_common.h"
 
-#include "nrf_drv_spi.h"
+#ifndef SE_HCL_HOST
+#include "nrfx_spim.h"
 #include "app_util_platform.h"
 #include "nrf_gpio.h"
 #include "nrf_delay.h"
 #include "boards.h"
 #include "app_error.h"
+#endif
 
 
 //=========================== BOARD-SPECIFIC DEFINITIONS =================================
@@ -89,18 +92,83 @@ typedef enum {
 #define CMD_QUADOUTFASTREAD             0x6B
 #define CMD_QUADIOFASTREAD              0xEB
 
+#define SE_HCL_WRITE_HDR_LEN            5       ///< Command and 32-bit address
+#define SE_HCL_READ_HDR_LEN             5       ///< Command and 32-bit address, no dummy byte
+
+//*****************************************************************************
+//
+// Host interface transport
+//
+// The HCL composes the command/address header and splits long accesses, the
+// transport moves the bytes. Backends: seS1D13C00NrfTransport (nRF SPIM),
+// seS1D13C00SpidevTransport (Linux spidev) and seS1D13C00EmuTransport
+// (in-process emulator, see s1d13c00_emu.h), and seS1D13C00NrfQspiTransport
+// (nRF52840 QSPI, dual and quad data modes, falling back to the SPIM).
+// Unless seS1D13C00SetTransport() chose one, seS1D13C00InitializeController()
+// picks it for the host interface mode: SE_HCL_DEFAULT_TRANSPORT for single
+// data SPI, SE_HCL_MULTI_TRANSPORT (the QSPI) for the others. Builds defining
+// SE_HCL_HOST default to the emulator for all modes.
+//
+// Headers always carry the single data commands, CMD_PAGEPROG and
+// CMD_FASTREAD. A transport driving more data lines maps them to the
+// command of the mode its init() set up.
+//
+//*****************************************************************************
+typedef struct {
+  /// Returns the mode set up, HOSTMCU_SPI_MONOADDR_MONODATA for modes the transport cannot drive.
+  hostmcu_config (*init)( hostmcu_config hostif, uint32_t spi_writespeed, uint32_t spi_readspeed );
+  /// One chip select cycle: hdr and wdata are sent, then rlen bytes are clocked into rdata.
+  void (*xfer)( const uint8_t hdr[], uint32_t hlen, const uint8_t wdata[], uint32_t wlen, uint8_t rdata[], uint32_t rlen );
+  void (*sleep_ms)( uint32_t msval );
+  uint32_t max_data;                       ///< Data bytes per xfer, 0 if unlimited
+  /// Monotonic time in nanoseconds, used by the transaction tracer. May be NULL.
+  uint64_t (*now_ns)( void );
+  /// Change the speeds given to init(), between transfers. May be NULL.
+  void (*set_speed)( uint32_t spi_writespeed, uint32_t spi_readspeed );
+  /// Start a write-only chip select cycle and return once hdr and wdata are copied. The transport
+  /// completes it before its next transfer. May be NULL.
+  void (*write_start)( const uint8_t hdr[], uint32_t hlen, const uint8_t wdata[], uint32_t wlen );
+  /// Release the peripheral and its pins, e.g. for another transport on the same pins. init()
+  /// takes them again. May be NULL.
+  void (*uninit)( void );
+} seS1D13C00Transport;
+
+#ifndef SE_HCL_CAL_LEN
+#define SE_HCL_CAL_LEN                  64      ///< RAM bytes used by seS1D13C00CalibrateSpeed()
+#endif
+#ifndef SE_HCL_CAL_ROUNDS
+#define SE_HCL_CAL_ROUNDS               8       ///< Patterns written and read back per speed
+#endif
+
 
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+extern const seS1D13C00Transport seS1D13C00NrfTransport;
+extern const seS1D13C00Transport seS1D13C00SpidevTransport;
+extern const seS1D13C00Transport seS1D13C00EmuTransport;
+extern const seS1D13C00Transport seS1D13C00NrfQspiTransport;
+
+void seS1D13C00SetTransport( const seS1D13C00Transport *t );
+const seS1D13C00Transport *seS1D13C00GetTransport( void );
+const seS1D13C00Transport *seS1D13C00HostIfTransport( hostmcu_config hostif );
 void seS1D13C00InitializeController( hostmcu_config hostif, uint32_t sysfreq, uint32_t spi_writespeed, uint32_t spi_readspeed );
+void seS1D13C00ResumeController( hostmcu_config hostif, uint32_t sysfreq, uint32_t spi_writespeed, uint32_t spi_readspeed );
+hostmcu_config seS1D13C00GetHostIf( void );
+void seS1D13C00SetSpeed( uint32_t spi_writespeed, uint32_t spi_readspeed );
+void seS1D13C00GetSpeed( uint32_t *spi_writespeed, uint32_t *spi_readspeed );
+seStatus seS1D13C00CalibrateSpeed( uint32_t addr, const uint32_t speeds[], uint32_t count,
+                                   uint32_t *spi_writespeed, uint32_t *spi_readspeed );
 void seS1D13C00SoftReset( void );
+void seS1D13C00SleepMS( uint32_t msval );
+uint64_t seS1D13C00NowNS( void );
 void seS1D13C00InitDispEn( void );
 void seS1D13C00DispEnable( void );
 void seS1D13C00DispDisable( void );
 void seS1D13C00Write( uint32_t addr, uint8_t data[], uint32_t nBytes );
+void seS1D13C00WriteStart( uint32_t addr, const uint8_t data[], uint32_t nBytes );
 void seS1D13C00Write8( uint32_t addr, uint8_t data );
 void seS1D13C00Write16( uint32_t addr, uint16_t data );
 void seS1D13C00Write32( uint32_t addr, uint32_t data );
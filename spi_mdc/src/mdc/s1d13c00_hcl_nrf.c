@@ -0,0 +1,239 @@
+//===========================================================================
+//
+// s1d13c00_hcl_nrf.c - HCL transport for the nRF52 SPIM
+//
+//  Single command, single address, single data SPI on SPIM0, mode 0,
+//  MSB first. The SPIM receives while it transmits, so the header and
+//  write data share the TX buffer and read data follows the header in
+//  the RX buffer. Writes and reads run at their own speed, rounded down
+//  to a SPIM frequency; the frequency is only rewritten when the
+//  direction changes it. A write started by nrf_write_start() runs from
+//  the TX buffer while the caller goes on, the next transfer waits for it.
+//
+//===========================================================================
+
+#ifndef SE_HCL_HOST
+
+#include <string.h>
+#include "s1d13c00_hcl.h"
+
+#define SPI_INSTANCE  0 /**< SPI instance index. */
+static const nrfx_spim_t spi = NRFX_SPIM_INSTANCE(SPI_INSTANCE);  /**< SPI instance. */
+static volatile bool spi_xfer_done;  /**< Flag used to indicate that SPI instance completed the transfer. */
+static bool          m_pending;      /**< A write started by nrf_write_start() may still run. */
+static bool          m_spim_init;    /**< SPIM initialized, the pins are taken. */
+
+#define SPI_MAX_DATA  256  /**< Data bytes per transfer, the HCL splits longer accesses. */
+
+static uint8_t       m_tx_buf[SE_HCL_READ_HDR_LEN + SPI_MAX_DATA];  /**< TX buffer, EasyDMA needs it in RAM. */
+static uint8_t       m_rx_buf[SE_HCL_READ_HDR_LEN + SPI_MAX_DATA];  /**< RX buffer. */
+
+static nrf_spim_frequency_t m_freq_wr;  /**< Frequency for writes. */
+static nrf_spim_frequency_t m_freq_rd;  /**< Frequency for reads. */
+static nrf_spim_frequency_t m_freq;     /**< Frequency the SPIM is set to. */
+
+/**@brief SPIM0 frequencies, fastest first. */
+static const struct
+{
+    uint32_t             hz;
+    nrf_spim_frequency_t freq;
+} m_freqs[] =
+{
+    { 8000000, NRF_SPIM_FREQ_8M   },
+    { 4000000, NRF_SPIM_FREQ_4M   },
+    { 2000000, NRF_SPIM_FREQ_2M   },
+    { 1000000, NRF_SPIM_FREQ_1M   },
+    {  500000, NRF_SPIM_FREQ_500K },
+    {  250000, NRF_SPIM_FREQ_250K },
+    {  125000, NRF_SPIM_FREQ_125K },
+};
+
+
+/**
+ * @brief SPI user event handler.
+ * @param event
+ */
+static void spi_event_handler(nrfx_spim_evt_t const * p_event,
+                       void *                  p_context)
+{
+    spi_xfer_done = true;
+}
+
+
+/**
+ * @brief Fastest SPIM frequency not above hz, 125 kHz if hz is lower.
+ */
+static nrf_spim_frequency_t nrf_freq(uint32_t hz)
+{
+    uint32_t i;
+
+    for (i = 0; i < sizeof(m_freqs) / sizeof(m_freqs[0]) - 1; i++)
+    {
+        if (m_freqs[i].hz <= hz)
+        {
+            break;
+        }
+    }
+    return m_freqs[i].freq;
+}
+
+
+static void nrf_set_speed( uint32_t spi_writespeed, uint32_t spi_readspeed )
+{
+    m_freq_wr = nrf_freq(spi_writespeed);
+    m_freq_rd = nrf_freq(spi_readspeed);
+}
+
+
+static void nrf_uninit( void );
+
+
+/**
+ * @brief Sets up the SPIM. It may already be set up, e.g. by ResumeMDC() before InitializeMDC()
+ *        on a cold start, nrfx_spim_init() would then fail, so it is released first.
+ */
+static hostmcu_config nrf_init( hostmcu_config hostif, uint32_t spi_writespeed, uint32_t spi_readspeed )
+{
+    nrfx_spim_config_t spi_config = NRFX_SPIM_DEFAULT_CONFIG;
+
+    nrf_uninit();
+
+    nrf_set_speed(spi_writespeed, spi_readspeed);
+    m_freq = m_freq_wr;
+
+    spi_config.ss_pin    = SPI_SS_PIN;
+    spi_config.miso_pin  = SPI_MISO_PIN;
+    spi_config.mosi_pin  = SPI_MOSI_PIN;
+    spi_config.sck_pin   = SPI_SCK_PIN;
+    spi_config.frequency = m_freq;
+    spi_config.mode      = NRF_SPIM_MODE_0;
+    spi_config.bit_order = NRF_SPIM_BIT_ORDER_MSB_FIRST;
+    APP_ERROR_CHECK(nrfx_spim_init(&spi, &spi_config, spi_event_handler, NULL));
+    m_spim_init = true;
+
+    // Cycle counter for nrf_now_ns(). Only enabled, never reset: nrf_now_ns() must not go
+    // back when init() runs again, and other users of the counter keep their start values.
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    return HOSTMCU_SPI_MONOADDR_MONODATA;
+}
+
+
+/**
+ * @brief Waits for the end of a write started by nrf_write_start().
+ */
+static void nrf_wait( void )
+{
+    if (m_pending)
+    {
+        while (!spi_xfer_done)
+        {
+            __WFE();
+        }
+        m_pending = false;
+    }
+}
+
+
+/**
+ * @brief Starts a transfer, the previous one done.
+ */
+static void nrf_start( const uint8_t hdr[], uint32_t hlen, const uint8_t wdata[], uint32_t wlen, uint32_t rlen )
+{
+    nrfx_spim_xfer_desc_t xfer = NRFX_SPIM_XFER_TRX(m_tx_buf, hlen + wlen, m_rx_buf, (rlen != 0) ? hlen + rlen : 0);
+    nrf_spim_frequency_t  freq = (rlen != 0) ? m_freq_rd : m_freq_wr;
+
+    nrf_wait();
+
+    // The SPIM is idle between transfers
+    if (freq != m_freq)
+    {
+        nrf_spim_frequency_set(spi.p_reg, freq);
+        m_freq = freq;
+    }
+
+    memcpy(m_tx_buf, hdr, hlen);
+    if (wlen != 0)
+    {
+        memcpy(&m_tx_buf[hlen], wdata, wlen);
+    }
+
+    spi_xfer_done = false;
+    APP_ERROR_CHECK(nrfx_spim_xfer(&spi, &xfer, 0));
+}
+
+
+static void nrf_xfer( const uint8_t hdr[], uint32_t hlen, const uint8_t wdata[], uint32_t wlen, uint8_t rdata[], uint32_t rlen )
+{
+    nrf_start(hdr, hlen, wdata, wlen, rlen);
+    m_pending = true;
+    nrf_wait();
+
+    if (rlen != 0)
+    {
+        memcpy(rdata, &m_rx_buf[hlen], rlen);
+    }
+}
+
+
+static void nrf_write_start( const uint8_t hdr[], uint32_t hlen, const uint8_t wdata[], uint32_t wlen )
+{
+    nrf_start(hdr, hlen, wdata, wlen, 0);
+    m_pending = true;
+}
+
+
+/**
+ * @brief Releases the SPIM and its pins, after a write still running.
+ */
+static void nrf_uninit( void )
+{
+    if (m_spim_init)
+    {
+        nrf_wait();
+        nrfx_spim_uninit(&spi);
+        m_spim_init = false;
+    }
+}
+
+
+static void nrf_sleep_ms( uint32_t msval )
+{
+    nrf_delay_ms(msval);
+}
+
+
+/**
+ * @brief Time from the DWT cycle counter. The counter wraps every 67 s at 64 MHz,
+ *        the wraps are counted as long as this is called at least that often.
+ */
+static uint64_t nrf_now_ns( void )
+{
+    static uint32_t last_cyc;
+    static uint64_t high;
+    uint32_t        cyc = DWT->CYCCNT;
+
+    if (cyc < last_cyc)
+    {
+        high += 1ULL << 32;
+    }
+    last_cyc = cyc;
+
+    return ((high + cyc) * 1000u) / (SystemCoreClock / 1000000u);
+}
+
+
+const seS1D13C00Transport seS1D13C00NrfTransport =
+{
+    .init      = nrf_init,
+    .xfer      = nrf_xfer,
+    .sleep_ms  = nrf_sleep_ms,
+    .max_data  = SPI_MAX_DATA,
+    .now_ns    = nrf_now_ns,
+    .set_speed = nrf_set_speed,
+    .write_start = nrf_write_start,
+    .uninit    = nrf_uninit,
+};
+
+#endif // SE_HCL_HOST
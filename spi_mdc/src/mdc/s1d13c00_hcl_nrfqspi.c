@@ -0,0 +1,444 @@
+//===========================================================================
+//
+// s1d13c00_hcl_nrfqspi.c - HCL transport for the nRF52840 QSPI
+//
+//  Dual and quad data host modes on the QSPI peripheral. It uses the SCK,
+//  CS, MOSI (IO0) and MISO (IO1) pins of the SPIM transport, plus IO2 and
+//  IO3 for the quad modes. Word aligned runs of whole words go through the
+//  QSPI READ and WRITE tasks on all data lines. The at most three bytes
+//  before and after them, e.g. 8 and 16-bit registers, are single data
+//  custom instructions with the commands the HCL sent. An access can so
+//  take up to three chip select cycles, in ascending address order.
+//
+//  The QSPI sends the command on IO0 only, and has no program command
+//  with the address on several lines. The DUAL_ALL and QUAD_ALL modes are
+//  therefore not supported, and the dual and quad address modes program
+//  with the single address command (0xA2, 0x32). The dummy cycles of the
+//  reads are those of serial flash, which the S1D13C00 commands follow.
+//
+//  The QSPI clock is 32 MHz divided by 1 to 16, set per direction, so the
+//  slowest speed is 32 MHz / 16 = 2 MHz. The WRITE task sends a write
+//  enable and polls a status register like a flash, which is checked at
+//  init() by writing and reading back a few bytes of S1D13C00 RAM,
+//  restored afterwards. Modes it does not support, init() speeds below
+//  2 MHz, a missing IO2 or IO3 pin and a failed check fall back to
+//  seS1D13C00NrfTransport in single data mode. init() releases the
+//  peripheral a previous init() left running, QSPI or SPIM, first.
+//
+//===========================================================================
+
+#ifndef SE_HCL_HOST
+
+#include <string.h>
+#include "nrfx_qspi.h"
+#include "s1d13c00_hcl.h"
+#include "s1d13c00_memregs.h"
+
+#ifndef SE_HCL_QSPI_IO2_PIN
+#define SE_HCL_QSPI_IO2_PIN  NRF_QSPI_PIN_NOT_CONNECTED  /**< IO2 pin, needed by the quad modes. */
+#endif
+#ifndef SE_HCL_QSPI_IO3_PIN
+#define SE_HCL_QSPI_IO3_PIN  NRF_QSPI_PIN_NOT_CONNECTED  /**< IO3 pin, needed by the quad modes. */
+#endif
+
+#define QSPI_MAX_DATA        256       /**< Data bytes per transfer, as the SPIM transport which takes over on fallback. */
+#define QSPI_BASE_HZ         32000000  /**< QSPI clock before the divider. */
+#define QSPI_MAX_DIV         16        /**< Largest divider. */
+#define QSPI_CINSTR_DATA     8         /**< Bytes after the opcode of a custom instruction. */
+#define QSPI_TEST_LEN        16        /**< Bytes written and read back by the init() check. */
+#define QSPI_TEST_TIMEOUT_US 10000     /**< Time the init() check allows a task. */
+
+/**@brief QSPI read and program commands of a host mode. */
+typedef struct
+{
+    nrf_qspi_readoc_t  readoc;
+    nrf_qspi_writeoc_t writeoc;
+    bool               quad;           /**< Needs IO2 and IO3. */
+} qspi_mode_t;
+
+static const qspi_mode_t m_modes[] =
+{
+    [HOSTMCU_SPI_MONOADDR_DUALDATA] = { NRF_QSPI_READOC_READ2O,  NRF_QSPI_WRITEOC_PP2O, false },  // CMD_DUALOUTFASTREAD, CMD_DUALINFASTPROG
+    [HOSTMCU_SPI_DUALADDR_DUALDATA] = { NRF_QSPI_READOC_READ2IO, NRF_QSPI_WRITEOC_PP2O, false },  // CMD_DUALIOFASTREAD, CMD_DUALINFASTPROG
+    [HOSTMCU_SPI_MONOADDR_QUADDATA] = { NRF_QSPI_READOC_READ4O,  NRF_QSPI_WRITEOC_PP4O, true  },  // CMD_QUADOUTFASTREAD, CMD_QUADINFASTPROG
+    [HOSTMCU_SPI_QUADADDR_QUADDATA] = { NRF_QSPI_READOC_READ4IO, NRF_QSPI_WRITEOC_PP4O, true  },  // CMD_QUADIOFASTREAD, CMD_QUADINFASTPROG
+};
+
+static bool                 m_active;           /**< The QSPI carries the accesses, otherwise the SPIM does. */
+static volatile bool        m_qspi_done;        /**< Flag used to indicate that a READ or WRITE task completed. */
+static nrf_qspi_frequency_t m_sck_wr;           /**< Divider for writes. */
+static nrf_qspi_frequency_t m_sck_rd;           /**< Divider for reads. */
+static nrf_qspi_frequency_t m_sck;              /**< Divider in IFCONFIG1. */
+static uint32_t             m_buf[QSPI_MAX_DATA / 4];  /**< Task buffer, EasyDMA needs it word aligned in RAM. */
+
+
+/**
+ * @brief QSPI event handler, the only event is READY.
+ */
+static void qspi_event_handler(nrfx_qspi_evt_t event, void * p_context)
+{
+    m_qspi_done = true;
+}
+
+
+/**
+ * @brief Divider for at most hz, QSPI_MAX_DIV + 1 if hz is too low.
+ */
+static uint32_t qspi_div(uint32_t hz)
+{
+    return (hz == 0) ? QSPI_MAX_DIV + 1 : (QSPI_BASE_HZ + hz - 1) / hz;
+}
+
+
+static void qspi_sck_set(nrf_qspi_frequency_t sck)
+{
+    if (sck != m_sck)
+    {
+        nrf_qspi_phy_conf_t phy =
+        {
+            .sck_delay = 1,
+            .dpmen     = false,
+            .spi_mode  = NRF_QSPI_MODE_0,
+            .sck_freq  = sck,
+        };
+
+        // Only written between tasks, the peripheral is idle
+        nrf_qspi_ifconfig1_set(NRF_QSPI, &phy);
+        m_sck = sck;
+    }
+}
+
+
+/**
+ * @brief Wait for a READ or WRITE task. With timeout, returns false if it does not complete
+ *        within QSPI_TEST_TIMEOUT_US.
+ */
+static bool qspi_wait(bool timeout)
+{
+    uint32_t us = 0;
+
+    while (!m_qspi_done)
+    {
+        if (!timeout)
+        {
+            __WFE();
+        }
+        else if (us++ < QSPI_TEST_TIMEOUT_US)
+        {
+            nrf_delay_us(1);
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+static void qspi_addr_set(uint8_t * p_dst, uint32_t addr)
+{
+    p_dst[0] = (uint8_t)(addr >> 24);
+    p_dst[1] = (uint8_t)(addr >> 16);
+    p_dst[2] = (uint8_t)(addr >>  8);
+    p_dst[3] = (uint8_t)(addr >>  0);
+}
+
+
+/**
+ * @brief Single data write of at most 3 bytes: command, address and data in one custom
+ *        instruction.
+ */
+static void cinstr_write(uint32_t addr, uint8_t const * p_data, uint32_t len)
+{
+    nrf_qspi_cinstr_conf_t cinstr = NRFX_QSPI_DEFAULT_CINSTR(CMD_PAGEPROG, 0);
+    uint8_t                tx[QSPI_CINSTR_DATA];
+
+    qspi_addr_set(tx, addr);
+    memcpy(&tx[4], p_data, len);
+
+    cinstr.length    = (nrf_qspi_cinstr_len_t)(1 + 4 + len);
+    cinstr.io2_level = true;
+    cinstr.io3_level = true;
+    APP_ERROR_CHECK(nrfx_qspi_cinstr_xfer(&cinstr, tx, NULL));
+}
+
+
+/**
+ * @brief Single data read of at most 3 bytes, right after the address as seS1D13C00Read().
+ */
+static void cinstr_read(uint32_t addr, uint8_t * p_data, uint32_t len)
+{
+    nrf_qspi_cinstr_conf_t cinstr = NRFX_QSPI_DEFAULT_CINSTR(CMD_FASTREAD, 0);
+    uint8_t                tx[QSPI_CINSTR_DATA] = {0};
+    uint8_t                rx[QSPI_CINSTR_DATA];
+
+    qspi_addr_set(tx, addr);
+
+    cinstr.length    = (nrf_qspi_cinstr_len_t)(1 + 4 + len);
+    cinstr.io2_level = true;
+    cinstr.io3_level = true;
+    APP_ERROR_CHECK(nrfx_qspi_cinstr_xfer(&cinstr, tx, rx));
+
+    memcpy(p_data, &rx[4], len);
+}
+
+
+static bool task_write(uint32_t addr, uint8_t const * p_data, uint32_t len, bool timeout)
+{
+    memcpy(m_buf, p_data, len);
+
+    m_qspi_done = false;
+    APP_ERROR_CHECK(nrfx_qspi_write(m_buf, len, addr));
+    return qspi_wait(timeout);
+}
+
+
+static bool task_read(uint32_t addr, uint8_t * p_data, uint32_t len, bool timeout)
+{
+    m_qspi_done = false;
+    APP_ERROR_CHECK(nrfx_qspi_read(m_buf, len, addr));
+    if (!qspi_wait(timeout))
+    {
+        return false;
+    }
+
+    memcpy(p_data, m_buf, len);
+    return true;
+}
+
+
+/**
+ * @brief Bytes up to the next word boundary, at most len.
+ */
+static uint32_t head_len(uint32_t addr, uint32_t len)
+{
+    uint32_t head = (0u - addr) & 3u;
+
+    return (head < len) ? head : len;
+}
+
+
+static void qspi_write(uint32_t addr, uint8_t const * p_data, uint32_t len)
+{
+    uint32_t head = head_len(addr, len);
+    uint32_t body = (len - head) & ~3u;
+
+    qspi_sck_set(m_sck_wr);
+
+    if (head != 0)
+    {
+        cinstr_write(addr, p_data, head);
+    }
+    if (body != 0)
+    {
+        (void)task_write(addr + head, &p_data[head], body, false);
+    }
+    if (len - head - body != 0)
+    {
+        cinstr_write(addr + head + body, &p_data[head + body], len - head - body);
+    }
+}
+
+
+static void qspi_read(uint32_t addr, uint8_t * p_data, uint32_t len)
+{
+    uint32_t head = head_len(addr, len);
+    uint32_t body = (len - head) & ~3u;
+
+    qspi_sck_set(m_sck_rd);
+
+    if (head != 0)
+    {
+        cinstr_read(addr, p_data, head);
+    }
+    if (body != 0)
+    {
+        (void)task_read(addr + head, &p_data[head], body, false);
+    }
+    if (len - head - body != 0)
+    {
+        cinstr_read(addr + head + body, &p_data[head + body], len - head - body);
+    }
+}
+
+
+/**
+ * @brief Check the READ and WRITE tasks on S1D13C00 RAM against custom instructions, which
+ *        only use IO0 and IO1 as the SPIM does.
+ */
+static bool qspi_check(void)
+{
+    uint8_t  saved[QSPI_TEST_LEN];
+    uint8_t  pattern[QSPI_TEST_LEN];
+    uint8_t  back[QSPI_TEST_LEN];
+    uint32_t i;
+    bool     ok;
+
+    for (i = 0; i < QSPI_TEST_LEN; i += 2)
+    {
+        cinstr_read(RAM_BASE + i, &saved[i], 2);
+        pattern[i]     = (uint8_t)(0x5A ^ (i * 0x11));
+        pattern[i + 1] = (uint8_t)~pattern[i];
+    }
+
+    qspi_sck_set(m_sck_wr);
+    ok = task_write(RAM_BASE, pattern, QSPI_TEST_LEN, true);
+    if (!ok)
+    {
+        return false;
+    }
+
+    qspi_sck_set(m_sck_rd);
+    for (i = 0; i < QSPI_TEST_LEN; i += 2)
+    {
+        cinstr_read(RAM_BASE + i, &back[i], 2);
+    }
+    ok = (memcmp(back, pattern, QSPI_TEST_LEN) == 0);
+
+    memset(back, 0, sizeof(back));
+    ok = ok && task_read(RAM_BASE, back, QSPI_TEST_LEN, true) && (memcmp(back, pattern, QSPI_TEST_LEN) == 0);
+
+    qspi_sck_set(m_sck_wr);
+    return task_write(RAM_BASE, saved, QSPI_TEST_LEN, true) && ok;
+}
+
+
+/**
+ * @brief Releases the QSPI, or the SPIM after a fallback, and the pins.
+ */
+static void qspi_uninit( void )
+{
+    if (m_active)
+    {
+        nrfx_qspi_uninit();
+        m_active = false;
+    }
+    else
+    {
+        seS1D13C00NrfTransport.uninit();
+    }
+}
+
+
+static hostmcu_config qspi_init( hostmcu_config hostif, uint32_t spi_writespeed, uint32_t spi_readspeed )
+{
+    nrfx_qspi_config_t config;
+    uint32_t           div_wr = qspi_div(spi_writespeed);
+    uint32_t           div_rd = qspi_div(spi_readspeed);
+
+    qspi_uninit();
+
+    if (hostif < HOSTMCU_SPI_MONOADDR_DUALDATA || hostif > HOSTMCU_SPI_QUADADDR_QUADDATA ||
+        div_wr > QSPI_MAX_DIV || div_rd > QSPI_MAX_DIV ||
+        (m_modes[hostif].quad && (SE_HCL_QSPI_IO2_PIN == NRF_QSPI_PIN_NOT_CONNECTED ||
+                                  SE_HCL_QSPI_IO3_PIN == NRF_QSPI_PIN_NOT_CONNECTED)))
+    {
+        return seS1D13C00NrfTransport.init(HOSTMCU_SPI_MONOADDR_MONODATA, spi_writespeed, spi_readspeed);
+    }
+
+    m_sck_wr = (nrf_qspi_frequency_t)(div_wr - 1);
+    m_sck_rd = (nrf_qspi_frequency_t)(div_rd - 1);
+    m_sck    = m_sck_rd;
+
+    memset(&config, 0, sizeof(config));
+    config.pins.sck_pin        = SPI_SCK_PIN;
+    config.pins.csn_pin        = SPI_SS_PIN;
+    config.pins.io0_pin        = SPI_MOSI_PIN;
+    config.pins.io1_pin        = SPI_MISO_PIN;
+    config.pins.io2_pin        = SE_HCL_QSPI_IO2_PIN;
+    config.pins.io3_pin        = SE_HCL_QSPI_IO3_PIN;
+    config.prot_if.readoc      = m_modes[hostif].readoc;
+    config.prot_if.writeoc     = m_modes[hostif].writeoc;
+    config.prot_if.addrmode    = NRF_QSPI_ADDRMODE_32BIT;
+    config.prot_if.dpmconfig   = false;
+    config.phy_if.sck_delay    = 1;
+    config.phy_if.dpmen        = false;
+    config.phy_if.spi_mode     = NRF_QSPI_MODE_0;
+    config.phy_if.sck_freq     = m_sck;
+    config.irq_priority        = APP_IRQ_PRIORITY_LOWEST;
+
+    if (nrfx_qspi_init(&config, qspi_event_handler, NULL) != NRFX_SUCCESS)
+    {
+        return seS1D13C00NrfTransport.init(HOSTMCU_SPI_MONOADDR_MONODATA, spi_writespeed, spi_readspeed);
+    }
+
+    if (!qspi_check())
+    {
+        // Releases the pins to the SPIM, and stops a task still waiting for the status
+        nrfx_qspi_uninit();
+        return seS1D13C00NrfTransport.init(HOSTMCU_SPI_MONOADDR_MONODATA, spi_writespeed, spi_readspeed);
+    }
+    m_active = true;
+
+    // Cycle counter for the SPIM transport's now_ns()
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    return hostif;
+}
+
+
+/**
+ * @brief Speeds after init(). While the QSPI is in use, speeds below QSPI_BASE_HZ / QSPI_MAX_DIV
+ *        run at that clock.
+ */
+static void qspi_set_speed( uint32_t spi_writespeed, uint32_t spi_readspeed )
+{
+    uint32_t div_wr = qspi_div(spi_writespeed);
+    uint32_t div_rd = qspi_div(spi_readspeed);
+
+    if (!m_active)
+    {
+        seS1D13C00NrfTransport.set_speed(spi_writespeed, spi_readspeed);
+        return;
+    }
+
+    m_sck_wr = (nrf_qspi_frequency_t)(((div_wr < QSPI_MAX_DIV) ? div_wr : QSPI_MAX_DIV) - 1);
+    m_sck_rd = (nrf_qspi_frequency_t)(((div_rd < QSPI_MAX_DIV) ? div_rd : QSPI_MAX_DIV) - 1);
+}
+
+
+static void qspi_xfer( const uint8_t hdr[], uint32_t hlen, const uint8_t wdata[], uint32_t wlen, uint8_t rdata[], uint32_t rlen )
+{
+    uint32_t addr = ((uint32_t)hdr[1] << 24) | ((uint32_t)hdr[2] << 16) | ((uint32_t)hdr[3] << 8) | hdr[4];
+
+    if (!m_active)
+    {
+        seS1D13C00NrfTransport.xfer(hdr, hlen, wdata, wlen, rdata, rlen);
+    }
+    else if (rlen != 0)
+    {
+        qspi_read(addr, rdata, rlen);
+    }
+    else
+    {
+        qspi_write(addr, wdata, wlen);
+    }
+}
+
+
+static void qspi_sleep_ms( uint32_t msval )
+{
+    nrf_delay_ms(msval);
+}
+
+
+static uint64_t qspi_now_ns( void )
+{
+    return seS1D13C00NrfTransport.now_ns();
+}
+
+
+const seS1D13C00Transport seS1D13C00NrfQspiTransport =
+{
+    .init      = qspi_init,
+    .xfer      = qspi_xfer,
+    .sleep_ms  = qspi_sleep_ms,
+    .max_data  = QSPI_MAX_DATA,
+    .now_ns    = qspi_now_ns,
+    .set_speed = qspi_set_speed,
+    .uninit    = qspi_uninit,
+};
+
+#endif // SE_HCL_HOST
@@ -0,0 +1,135 @@
+//===========================================================================
+//
+// s1d13c00_hcl_spidev.c - HCL transport for Linux spidev
+//
+//  Drives a real S1D13C00 from a Linux host (e.g. a Raspberry Pi) through
+//  /dev/spidevB.C. The header, write data and read data of one access are
+//  queued as separate segments of a single SPI_IOC_MESSAGE, so chip select
+//  stays asserted in between and nothing is copied.
+//
+//  SE_HCL_SPIDEV_DEVICE selects the device node, the environment variable
+//  SE_HCL_SPIDEV overrides it at run time.
+//
+//===========================================================================
+
+#ifdef __linux__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/spi/spidev.h>
+#include "s1d13c00_hcl.h"
+
+#ifndef SE_HCL_SPIDEV_DEVICE
+#define SE_HCL_SPIDEV_DEVICE    "/dev/spidev0.0"
+#endif
+
+#define SPIDEV_MAX_DATA         4096    // Default spidev bufsiz
+
+static int spi_fd = -1;
+static uint32_t spi_wrspeed;
+static uint32_t spi_rdspeed;
+
+
+static hostmcu_config spidev_init( hostmcu_config hostif, uint32_t spi_writespeed, uint32_t spi_readspeed )
+{
+    const char *dev = getenv( "SE_HCL_SPIDEV" );
+    uint8_t mode = SPI_MODE_0;
+    uint8_t bits = 8;
+
+    if ( dev == NULL )
+        dev = SE_HCL_SPIDEV_DEVICE;
+
+    spi_wrspeed = spi_writespeed;
+    spi_rdspeed = spi_readspeed;
+
+    if ( spi_fd >= 0 )
+        close( spi_fd );
+
+    spi_fd = open( dev, O_RDWR );
+    if ( spi_fd < 0 ||
+         ioctl( spi_fd, SPI_IOC_WR_MODE, &mode ) < 0 ||
+         ioctl( spi_fd, SPI_IOC_WR_BITS_PER_WORD, &bits ) < 0 ||
+         ioctl( spi_fd, SPI_IOC_WR_MAX_SPEED_HZ, &spi_wrspeed ) < 0 )
+    {
+        perror( dev );
+        exit( EXIT_FAILURE );
+    }
+
+    return HOSTMCU_SPI_MONOADDR_MONODATA;
+}
+
+
+// Per transfer speeds, the maximum set at open is only a default
+static void spidev_set_speed( uint32_t spi_writespeed, uint32_t spi_readspeed )
+{
+    spi_wrspeed = spi_writespeed;
+    spi_rdspeed = spi_readspeed;
+}
+
+
+static void spidev_xfer( const uint8_t hdr[], uint32_t hlen, const uint8_t wdata[], uint32_t wlen, uint8_t rdata[], uint32_t rlen )
+{
+    struct spi_ioc_transfer seg[2];
+    uint32_t speed = (rlen != 0) ? spi_rdspeed : spi_wrspeed;
+    int n = 1;
+
+    memset( seg, 0, sizeof(seg) );
+    seg[0].tx_buf = (unsigned long)hdr;
+    seg[0].len = hlen;
+    seg[0].speed_hz = speed;
+    seg[0].bits_per_word = 8;
+
+    if ( wlen != 0 || rlen != 0 )
+    {
+        seg[1].tx_buf = (unsigned long)wdata;
+        seg[1].rx_buf = (unsigned long)rdata;
+        seg[1].len = (wlen != 0) ? wlen : rlen;
+        seg[1].speed_hz = speed;
+        seg[1].bits_per_word = 8;
+        n = 2;
+    }
+
+    if ( ioctl( spi_fd, SPI_IOC_MESSAGE(n), seg ) < 0 )
+    {
+        perror( "SPI_IOC_MESSAGE" );
+        exit( EXIT_FAILURE );
+    }
+}
+
+
+static void spidev_sleep_ms( uint32_t msval )
+{
+    struct timespec ts;
+
+    ts.tv_sec = msval / 1000;
+    ts.tv_nsec = (long)(msval % 1000) * 1000000L;
+    while ( nanosleep( &ts, &ts ) != 0 )
+        ;
+}
+
+
+static uint64_t spidev_now_ns( void )
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+
+const seS1D13C00Transport seS1D13C00SpidevTransport =
+{
+    .init      = spidev_init,
+    .xfer      = spidev_xfer,
+    .sleep_ms  = spidev_sleep_ms,
+    .max_data  = SPIDEV_MAX_DATA,
+    .now_ns    = spidev_now_ns,
+    .set_speed = spidev_set_speed,
+};
+
+#endif // __linux__
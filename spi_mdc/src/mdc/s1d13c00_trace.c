@@ -0,0 +1,811 @@
+//===========================================================================
+//
+// s1d13c00_trace.c - Host bus transaction tracer, see s1d13c00_trace.h
+//
+//===========================================================================
+
+#ifdef SE_HCL_TRACE
+
+#include <stdio.h>
+#include <string.h>
+#include "s1d13c00_hcl.h"
+#include "s1d13c00_memregs.h"
+#include "s1d13c00_trace.h"
+
+#if !defined(SE_HCL_HOST) && !defined(__linux__)
+#include "SEGGER_RTT.h"
+#endif
+
+#define EV_XACT                 0
+#define EV_ENTER                1
+#define EV_LEAVE                2
+#define EV_POLL_BEGIN           3
+#define EV_POLL_END             4
+#define EV_FRAME                5
+
+#define EV_F_READ               0x01            // Read transaction
+#define EV_F_POLL               0x02            // Issued by a polling loop
+#define EV_F_WASTED             0x04            // Polling test that found the condition unmet
+
+#define POLL_PENDING_MAX        4               // Transactions per polling test tracked for the wasted count
+
+typedef struct {
+    uint64_t    t_ns;                       // Start, relative to seTRACE_Reset()
+    const char *tag;                        // Function, NULL outside any seTRACE_API()
+    uint32_t    addr;                       // Address; source line for polling events; frame number
+    uint32_t    dur_ns;
+    uint16_t    len;
+    uint8_t     kind;
+    uint8_t     flags;
+} Event;
+
+typedef struct {
+    uint32_t         addr;
+    seTRACE_Counters c;
+} RegStat;
+
+typedef struct {
+    const char      *name;                  // NULL collects transactions outside any API call
+    uint32_t         calls;
+    uint64_t         wall_ns;
+    seTRACE_Counters c;
+} ApiStat;
+
+typedef struct {
+    const char      *func;
+    uint16_t         line;
+    uint32_t         loops;
+    uint64_t         wall_ns;
+    seTRACE_Counters c;
+} PollStat;
+
+typedef struct {
+    uint32_t         no;
+    uint64_t         wall_ns;
+    seTRACE_Counters c;
+} FrameStat;
+
+typedef struct {
+    RegStat         *reg;
+    uint32_t         seq;
+    uint32_t         dur_ns;
+} Pending;
+
+typedef struct {
+    const char *name;
+    uint32_t    addr;
+} RegName;
+
+#define REG(r)  { #r, (r) }
+
+static const RegName reg_names[] =
+{
+    REG(SYS_SYSPROT), REG(CLG_OSC), REG(CLG_OSC1), REG(CLG_INTF), REG(CLG_INTE), REG(CLG_FOUT),
+    REG(CLG_OSC1TRM), REG(RTC_CTLL), REG(RTC_CTLH), REG(RTC_ALM1), REG(RTC_ALM2),
+    REG(RTC_SWCTL), REG(RTC_SEC), REG(RTC_HUR), REG(RTC_MON), REG(RTC_YAR), REG(RTC_INTF),
+    REG(RTC_INTE), REG(MDC_DISPCTL), REG(MDC_DISPWIDTH), REG(MDC_DISPHEIGHT),
+    REG(MDC_DISPVCOMDIV), REG(MDC_DISPCLKDIV), REG(MDC_DISPPRM21), REG(MDC_DISPPRM43),
+    REG(MDC_DISPPRM65), REG(MDC_DISPPRM87), REG(MDC_DISPSTARTY), REG(MDC_DISPENDY),
+    REG(MDC_DISPSTRIDE), REG(MDC_DISPFRMBUFF0), REG(MDC_DISPFRMBUFF1), REG(MDC_TRIGCTL),
+    REG(MDC_INTCTL), REG(MDC_GFXCTL), REG(MDC_GFXIXCENTER), REG(MDC_GFXIYCENTER),
+    REG(MDC_GFXIWIDTH), REG(MDC_GFXIHEIGHT), REG(MDC_GFXOXCENTER), REG(MDC_GFXOYCENTER),
+    REG(MDC_GFXOWIDTH), REG(MDC_GFXOHEIGHT), REG(MDC_GFXXLSCALE), REG(MDC_GFXXRSCALE),
+    REG(MDC_GFXYTSCALE), REG(MDC_GFXYBSCALE), REG(MDC_GFXSHEAR), REG(MDC_GFXROTVAL),
+    REG(MDC_GFXCOLOR), REG(MDC_GFXIBADDR0), REG(MDC_GFXIBADDR1), REG(MDC_GFXOBADDR0),
+    REG(MDC_GFXOBADDR1), REG(MDC_GFXISTRIDE), REG(MDC_GFXOSTRIDE), REG(MDC_GFXOWLEFT),
+    REG(MDC_GFXOWRIGHT), REG(MDC_GFXOWTOP), REG(MDC_GFXOWBOT), REG(MDC_DISPPRM109),
+    REG(MDC_DISPPRM1211), REG(MDC_DISPPRM1413), REG(MDC_DISPCTL2), REG(MDC_VCNTCOMP),
+    REG(MDC_VCNT), REG(MDC_SCRATCHA0), REG(MDC_SCRATCHA1), REG(MDC_EPBASEADDR0),
+    REG(MDC_EPBASEADDR1), REG(MDC_SCRATCHB), REG(MDC_VCOMCLKCTL), REG(MDC_EPCTRL),
+    REG(MDC_PRODCODE), REG(MDC_REVCODE), REG(MDC_BSTCLK), REG(MDC_BSTPWR), REG(MDC_BSTVMD),
+    REG(SYS_CTRL), REG(SYS_TEST), REG(SYS_INTS), REG(PORT_P0DAT), REG(PORT_P0IOEN),
+    REG(PORT_P0RCTL), REG(PORT_P0INTF), REG(PORT_P0INTCTL), REG(PORT_P0CHATEN),
+    REG(PORT_P0MODSEL), REG(PORT_P0FNCSEL), REG(PORT_P1DAT), REG(PORT_P1IOEN), REG(PORT_P1RCTL),
+    REG(PORT_P1INTF), REG(PORT_P1INTCTL), REG(PORT_P1CHATEN), REG(PORT_P1MODSEL),
+    REG(PORT_P1FNCSEL), REG(PORT_CLK), REG(PORT_INTFGRP), REG(SND_CLK), REG(SND_SEL),
+    REG(SND_CTL), REG(SND_DAT), REG(SND_INTF), REG(SND_INTE), REG(SND_EMDMAEN), REG(REMC_CLK),
+    REG(REMC_DBCTL), REG(REMC_DBCNT), REG(REMC_APLEN), REG(REMC_DBLEN), REG(REMC_INTF),
+    REG(REMC_INTE), REG(REMC_CARR), REG(REMC_CCTL), REG(SPI_MOD), REG(SPI_CTL), REG(SPI_TXD),
+    REG(SPI_RXD), REG(SPI_INTF), REG(SPI_INTE), REG(SPI_TBEDMAEN), REG(SPI_RBFDMAEN),
+    REG(I2C_CLK), REG(I2C_MOD), REG(I2C_BR), REG(I2C_OADR), REG(I2C_CTL), REG(I2C_TXD),
+    REG(I2C_RXD), REG(I2C_INTF), REG(I2C_INTE), REG(I2C_TBEDMAEN), REG(I2C_RBFDMAEN),
+    REG(QSPI_MOD), REG(QSPI_CTL), REG(QSPI_TXD), REG(QSPI_RXD), REG(QSPI_INTF), REG(QSPI_INTE),
+    REG(QSPI_TBEDMAEN), REG(QSPI_RBFDMAEN), REG(QSPI_FRLDMAEN), REG(QSPI_MMACFG1),
+    REG(QSPI_RMADRH), REG(QSPI_MMACFG2), REG(QSPI_MB), REG(DMAC_STAT), REG(DMAC_CFG),
+    REG(DMAC_CPTR), REG(DMAC_ACPTR), REG(DMAC_SWREQ), REG(DMAC_RMSET), REG(DMAC_RMCLR),
+    REG(DMAC_ENSET), REG(DMAC_ENCLR), REG(DMAC_PASET), REG(DMAC_PACLR), REG(DMAC_PRSET),
+    REG(DMAC_PRCLR), REG(DMAC_ERRIF), REG(DMAC_ENDIF), REG(DMAC_ENDIESET), REG(DMAC_ENDIECLR),
+    REG(DMAC_ERRIESET), REG(DMAC_ERRIECLR),
+};
+
+
+static bool enabled = true;
+
+static struct {
+    uint64_t         t_base;
+
+    Event            ring[SE_TRACE_RING_SIZE];
+    uint32_t         seq;                   // Events recorded, the ring holds the last SE_TRACE_RING_SIZE
+
+    seTRACE_Counters total;
+    RegStat          regs[SE_TRACE_MAX_REGS];
+    seTRACE_Counters reg_other;             // Addresses that did not fit in regs[]
+    ApiStat          apis[SE_TRACE_MAX_APIS];
+    uint32_t         napis;
+    ApiStat         *cur_api;
+    PollStat         polls[SE_TRACE_MAX_POLLS];
+    uint32_t         npolls;
+
+    const char      *stack[SE_TRACE_MAX_DEPTH];
+    uint8_t          depth;
+    uint64_t         enter_ns;
+
+    PollStat        *poll;
+    uint8_t          poll_nest;
+    uint64_t         poll_t0;
+    Pending          pending[POLL_PENDING_MAX];
+    uint32_t         npending;
+
+    seTRACE_Counters frame;
+    uint64_t         frame_t0;
+    uint32_t         frame_no;
+    FrameStat        frames[SE_TRACE_FRAMES];
+    uint64_t         frame_bus_min;
+    uint64_t         frame_bus_max;
+    uint64_t         frame_bus_sum;
+} trc;
+
+
+static uint64_t Now( void )
+{
+    return seS1D13C00NowNS() - trc.t_base;
+}
+
+
+static Event *Push( uint8_t kind, const char *tag, uint32_t addr, uint64_t t_ns )
+{
+    Event *ev = &trc.ring[trc.seq % SE_TRACE_RING_SIZE];
+
+    trc.seq++;
+    ev->t_ns   = t_ns;
+    ev->tag    = tag;
+    ev->addr   = addr;
+    ev->dur_ns = 0;
+    ev->len    = 0;
+    ev->kind   = kind;
+    ev->flags  = 0;
+    return ev;
+}
+
+
+static void Count( seTRACE_Counters *c, seTRACE_Dir dir, uint32_t len, uint32_t dur_ns )
+{
+    c->xacts++;
+    if ( dir == seTRACE_READ )
+        c->rd_bytes += len;
+    else
+        c->wr_bytes += len;
+    c->bus_ns += dur_ns;
+}
+
+
+static void Waste( seTRACE_Counters *c, uint32_t dur_ns )
+{
+    c->wasted_xacts++;
+    c->wasted_ns += dur_ns;
+}
+
+
+//---------------------------------------------------------------------------
+// RAM and external memory are aggregated as one entry each, registers
+// individually.
+//---------------------------------------------------------------------------
+static uint32_t RegKey( uint32_t addr )
+{
+    if ( (addr & 0xF0000000) == RAM_BASE )
+        return RAM_BASE;
+    if ( addr < SYS_PROT_BASE )
+        return EXTMEM_BASE;
+    return addr;
+}
+
+
+static RegStat *FindReg( uint32_t addr )
+{
+    uint32_t key = RegKey( addr );
+    uint32_t i = (key >> 1) % SE_TRACE_MAX_REGS;
+    uint32_t n;
+
+    for ( n = 0; n < SE_TRACE_MAX_REGS; n++ )
+    {
+        RegStat *r = &trc.regs[i];
+
+        if ( r->c.xacts == 0 )
+        {
+            r->addr = key;
+            return r;
+        }
+        if ( r->addr == key )
+            return r;
+        i = (i + 1) % SE_TRACE_MAX_REGS;
+    }
+    return NULL;
+}
+
+
+static ApiStat *FindApi( const char *name )
+{
+    uint32_t i;
+
+    for ( i = 0; i < trc.napis; i++ )
+    {
+        if ( trc.apis[i].name == name )
+            return &trc.apis[i];
+    }
+    if ( trc.napis == SE_TRACE_MAX_APIS )
+        return NULL;
+
+    trc.apis[trc.napis].name = name;
+    return &trc.apis[trc.napis++];
+}
+
+
+static PollStat *FindPoll( const char *func, uint16_t line )
+{
+    uint32_t i;
+
+    for ( i = 0; i < trc.npolls; i++ )
+    {
+        if ( trc.polls[i].func == func && trc.polls[i].line == line )
+            return &trc.polls[i];
+    }
+    if ( trc.npolls == SE_TRACE_MAX_POLLS )
+        return NULL;
+
+    trc.polls[trc.npolls].func = func;
+    trc.polls[trc.npolls].line = line;
+    return &trc.polls[trc.npolls++];
+}
+
+
+static ApiStat *CurApi( void )
+{
+    if ( trc.cur_api == NULL )
+        trc.cur_api = FindApi( (trc.depth != 0) ? trc.stack[0] : NULL );
+    return trc.cur_api;
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seTRACE_Reset()
+//---------------------------------------------------------------------------
+void seTRACE_Reset( void )
+{
+    const char *stack[SE_TRACE_MAX_DEPTH];
+    uint8_t depth = trc.depth;
+    uint8_t poll_nest = trc.poll_nest;
+
+    // Scopes and a polling loop open right now stay open
+    memcpy( stack, trc.stack, sizeof(stack) );
+    memset( &trc, 0, sizeof(trc) );
+    memcpy( trc.stack, stack, sizeof(stack) );
+    trc.depth = depth;
+    trc.poll_nest = poll_nest;
+
+    trc.t_base = seS1D13C00NowNS();
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seTRACE_Enable()
+//---------------------------------------------------------------------------
+void seTRACE_Enable( bool enable )
+{
+    enabled = enable;
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seTRACE_Xact()
+//---------------------------------------------------------------------------
+void seTRACE_Xact( uint32_t addr, seTRACE_Dir dir, uint32_t len, uint64_t t0_ns, uint64_t t1_ns )
+{
+    uint32_t dur = (uint32_t)(t1_ns - t0_ns);
+    RegStat *reg;
+    ApiStat *api;
+    Event *ev;
+
+    if ( !enabled )
+        return;
+
+    Count( &trc.total, dir, len, dur );
+    Count( &trc.frame, dir, len, dur );
+
+    reg = FindReg( addr );
+    Count( (reg != NULL) ? &reg->c : &trc.reg_other, dir, len, dur );
+
+    api = CurApi();
+    if ( api != NULL )
+        Count( &api->c, dir, len, dur );
+
+    ev = Push( EV_XACT, (trc.depth != 0) ? trc.stack[trc.depth - 1] : NULL, addr, t0_ns - trc.t_base );
+    ev->dur_ns = dur;
+    ev->len = (uint16_t)len;
+    ev->flags = (dir == seTRACE_READ) ? EV_F_READ : 0;
+
+    if ( trc.poll_nest != 0 )
+    {
+        ev->flags |= EV_F_POLL;
+        if ( trc.poll != NULL )
+            Count( &trc.poll->c, dir, len, dur );
+        if ( trc.npending < POLL_PENDING_MAX )
+        {
+            trc.pending[trc.npending].reg = reg;
+            trc.pending[trc.npending].seq = trc.seq - 1;
+            trc.pending[trc.npending].dur_ns = dur;
+            trc.npending++;
+        }
+    }
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seTRACE_Enter()
+//---------------------------------------------------------------------------
+seTRACE_Scope seTRACE_Enter( const char *func )
+{
+    seTRACE_Scope scope = trc.depth;
+    ApiStat *api;
+
+    if ( trc.depth == SE_TRACE_MAX_DEPTH )
+        return scope;
+
+    trc.stack[trc.depth++] = func;
+    if ( !enabled )
+        return scope;
+
+    if ( scope == 0 )
+    {
+        trc.enter_ns = Now();
+        trc.cur_api = NULL;
+        api = CurApi();
+        if ( api != NULL )
+            api->calls++;
+    }
+    Push( EV_ENTER, func, 0, Now() );
+    return scope;
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seTRACE_Leave()
+//---------------------------------------------------------------------------
+void seTRACE_Leave( seTRACE_Scope *scope )
+{
+    if ( *scope >= trc.depth )
+        return;                                     // Entered beyond SE_TRACE_MAX_DEPTH
+
+    if ( enabled )
+        Push( EV_LEAVE, trc.stack[*scope], 0, Now() );
+
+    trc.depth = *scope;
+    if ( trc.depth == 0 )
+    {
+        if ( enabled && trc.cur_api != NULL )
+            trc.cur_api->wall_ns += Now() - trc.enter_ns;
+        trc.cur_api = NULL;
+    }
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seTRACE_PollBegin()
+//---------------------------------------------------------------------------
+void seTRACE_PollBegin( const char *func, uint16_t line )
+{
+    if ( trc.poll_nest++ != 0 )
+        return;
+
+    trc.npending = 0;
+    trc.poll = NULL;
+    if ( !enabled )
+        return;
+
+    trc.poll = FindPoll( func, line );
+    if ( trc.poll != NULL )
+        trc.poll->loops++;
+    trc.poll_t0 = Now();
+    Push( EV_POLL_BEGIN, func, line, trc.poll_t0 );
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seTRACE_PollTest()
+//   Called before each test of the loop condition: the transactions of the
+//   previous test found the condition unmet and are counted as wasted.
+//---------------------------------------------------------------------------
+bool seTRACE_PollTest( void )
+{
+    uint32_t i;
+
+    if ( trc.poll_nest != 1 )
+        return true;
+
+    for ( i = 0; i < trc.npending; i++ )
+    {
+        Pending *p = &trc.pending[i];
+        ApiStat *api = CurApi();
+
+        Waste( &trc.total, p->dur_ns );
+        Waste( &trc.frame, p->dur_ns );
+        Waste( (p->reg != NULL) ? &p->reg->c : &trc.reg_other, p->dur_ns );
+        if ( api != NULL )
+            Waste( &api->c, p->dur_ns );
+        if ( trc.poll != NULL )
+            Waste( &trc.poll->c, p->dur_ns );
+        if ( trc.seq - p->seq <= SE_TRACE_RING_SIZE )
+            trc.ring[p->seq % SE_TRACE_RING_SIZE].flags |= EV_F_WASTED;
+    }
+    trc.npending = 0;
+    return true;
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seTRACE_PollEnd()
+//   Called once the condition is met, always returns false.
+//---------------------------------------------------------------------------
+bool seTRACE_PollEnd( void )
+{
+    if ( --trc.poll_nest != 0 )
+        return false;
+
+    trc.npending = 0;
+    if ( enabled && trc.poll != NULL )
+    {
+        uint64_t t = Now();
+
+        trc.poll->wall_ns += t - trc.poll_t0;
+        Push( EV_POLL_END, trc.poll->func, trc.poll->line, t );
+    }
+    trc.poll = NULL;
+    return false;
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seTRACE_Frame()
+//---------------------------------------------------------------------------
+void seTRACE_Frame( void )
+{
+    FrameStat *f;
+    uint64_t t;
+
+    if ( !enabled )
+        return;
+
+    t = Now();
+    f = &trc.frames[trc.frame_no % SE_TRACE_FRAMES];
+    f->no = trc.frame_no;
+    f->wall_ns = t - trc.frame_t0;
+    f->c = trc.frame;
+
+    if ( trc.frame_no == 0 || trc.frame.bus_ns < trc.frame_bus_min )
+        trc.frame_bus_min = trc.frame.bus_ns;
+    if ( trc.frame.bus_ns > trc.frame_bus_max )
+        trc.frame_bus_max = trc.frame.bus_ns;
+    trc.frame_bus_sum += trc.frame.bus_ns;
+
+    Push( EV_FRAME, NULL, trc.frame_no, t );
+
+    trc.frame_no++;
+    memset( &trc.frame, 0, sizeof(trc.frame) );
+    trc.frame_t0 = t;
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seTRACE_GetTotals()
+//---------------------------------------------------------------------------
+void seTRACE_GetTotals( seTRACE_Counters *totals )
+{
+    *totals = trc.total;
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seTRACE_GetLastFrame()
+//---------------------------------------------------------------------------
+void seTRACE_GetLastFrame( seTRACE_Counters *frame )
+{
+    if ( trc.frame_no == 0 )
+        memset( frame, 0, sizeof(*frame) );
+    else
+        *frame = trc.frames[(trc.frame_no - 1) % SE_TRACE_FRAMES].c;
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seTRACE_GetPollTime()
+//---------------------------------------------------------------------------
+uint64_t seTRACE_GetPollTime( const char *func )
+{
+    uint64_t ns = 0;
+    uint32_t i;
+
+    for ( i = 0; i < trc.npolls; i++ )
+    {
+        if ( strcmp( trc.polls[i].func, func ) == 0 )
+            ns += trc.polls[i].wall_ns;
+    }
+    return ns;
+}
+
+
+//===========================================================================
+// Output
+//===========================================================================
+
+static const char *RegNameOf( uint32_t addr, char buf[], size_t size )
+{
+    uint32_t i;
+
+    switch ( RegKey( addr ) )
+    {
+    case RAM_BASE:      return "RAM";
+    case EXTMEM_BASE:   return "EXTMEM";
+    default:            break;
+    }
+
+    for ( i = 0; i < sizeof(reg_names) / sizeof(reg_names[0]); i++ )
+    {
+        if ( reg_names[i].addr == addr )
+            return reg_names[i].name;
+    }
+    snprintf( buf, size, "0x%08lX", (unsigned long)addr );
+    return buf;
+}
+
+
+// Microseconds, with three decimals when frac is set.
+static const char *Us( uint64_t ns, bool frac, char buf[], size_t size )
+{
+    if ( frac )
+        snprintf( buf, size, "%lu.%03lu", (unsigned long)(ns / 1000), (unsigned long)(ns % 1000) );
+    else
+        snprintf( buf, size, "%lu", (unsigned long)(ns / 1000) );
+    return buf;
+}
+
+
+// Indices of n counters sorted by bus time, largest first.
+static void SortByBus( uint16_t idx[], const seTRACE_Counters *c[], uint32_t n )
+{
+    uint32_t i, j;
+
+    for ( i = 0; i < n; i++ )
+    {
+        uint16_t k = (uint16_t)i;
+
+        for ( j = i; j > 0 && c[idx[j - 1]]->bus_ns < c[k]->bus_ns; j-- )
+            idx[j] = idx[j - 1];
+        idx[j] = k;
+    }
+}
+
+
+static void PutCounters( seTRACE_PutFn put, void *ctx, const char *name, const seTRACE_Counters *c, const char *extra )
+{
+    char line[160], us1[24], us2[24];
+
+    snprintf( line, sizeof(line), "  %-30s %8lu %9lu %9lu %10s %8lu %10s%s\r\n", name,
+              (unsigned long)c->xacts, (unsigned long)c->wr_bytes, (unsigned long)c->rd_bytes,
+              Us( c->bus_ns, false, us1, sizeof(us1) ),
+              (unsigned long)c->wasted_xacts, Us( c->wasted_ns, false, us2, sizeof(us2) ), extra );
+    put( line, ctx );
+}
+
+
+static void PutHeading( seTRACE_PutFn put, void *ctx, const char *title, const char *extra )
+{
+    char line[160];
+
+    snprintf( line, sizeof(line), "\r\n%s\r\n  %-30s %8s %9s %9s %10s %8s %10s%s\r\n", title,
+              "", "xacts", "wr bytes", "rd bytes", "bus us", "wasted", "wasted us", extra );
+    put( line, ctx );
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seTRACE_WriteSummary()
+//---------------------------------------------------------------------------
+void seTRACE_WriteSummary( seTRACE_PutFn put, void *ctx )
+{
+    const seTRACE_Counters *c[SE_TRACE_MAX_REGS > SE_TRACE_MAX_APIS ? SE_TRACE_MAX_REGS : SE_TRACE_MAX_APIS];
+    const RegStat *regs[SE_TRACE_MAX_REGS];
+    uint16_t idx[sizeof(c) / sizeof(c[0])];
+    uint64_t wall = Now();
+    uint32_t permille = (wall != 0) ? (uint32_t)(trc.total.bus_ns * 1000 / wall) : 0;
+    char line[160], name[40], buf[24], us1[24], us2[24], us3[24];
+    uint32_t i, n;
+
+    snprintf( line, sizeof(line), "S1D13C00 host bus trace: %s us, bus busy %lu.%lu %%, %lu events, %lu kept\r\n",
+              Us( wall, false, us1, sizeof(us1) ),
+              (unsigned long)(permille / 10), (unsigned long)(permille % 10),
+              (unsigned long)trc.seq,
+              (unsigned long)((trc.seq < SE_TRACE_RING_SIZE) ? trc.seq : SE_TRACE_RING_SIZE) );
+    put( line, ctx );
+    PutHeading( put, ctx, "Total", "" );
+    PutCounters( put, ctx, "all", &trc.total, "" );
+
+    // Per API function
+    PutHeading( put, ctx, "Per API function (outermost call)", "    calls    wall us" );
+    for ( i = 0; i < trc.napis; i++ )
+        c[i] = &trc.apis[i].c;
+    SortByBus( idx, c, trc.napis );
+    for ( i = 0; i < trc.napis; i++ )
+    {
+        const ApiStat *a = &trc.apis[idx[i]];
+        char extra[40];
+
+        snprintf( extra, sizeof(extra), " %8lu %10s", (unsigned long)a->calls, Us( a->wall_ns, false, buf, sizeof(buf) ) );
+        PutCounters( put, ctx, (a->name != NULL) ? a->name : "(direct HCL access)", &a->c, extra );
+    }
+
+    // Per register
+    PutHeading( put, ctx, "Per register", "" );
+    for ( i = n = 0; i < SE_TRACE_MAX_REGS; i++ )
+    {
+        if ( trc.regs[i].c.xacts != 0 )
+        {
+            regs[n] = &trc.regs[i];
+            c[n++] = &trc.regs[i].c;
+        }
+    }
+    SortByBus( idx, c, n );
+    for ( i = 0; i < n; i++ )
+        PutCounters( put, ctx, RegNameOf( regs[idx[i]]->addr, name, sizeof(name) ), &regs[idx[i]]->c, "" );
+    if ( trc.reg_other.xacts != 0 )
+        PutCounters( put, ctx, "(table full)", &trc.reg_other, "" );
+
+    // Polling loops
+    PutHeading( put, ctx, "Polling loops", "    loops    wall us" );
+    for ( i = 0; i < trc.npolls; i++ )
+    {
+        const PollStat *p = &trc.polls[i];
+        char extra[2 + 20 + sizeof(buf)];                               // Blanks, 64-bit count, time
+
+        snprintf( name, sizeof(name), "%.24s:%u", p->func, (unsigned)p->line );
+        snprintf( extra, sizeof(extra), " %8lu %10s", (unsigned long)p->loops, Us( p->wall_ns, false, buf, sizeof(buf) ) );
+        PutCounters( put, ctx, name, &p->c, extra );
+    }
+
+    // Frames
+    n = (trc.frame_no < SE_TRACE_FRAMES) ? trc.frame_no : SE_TRACE_FRAMES;
+    snprintf( line, sizeof(line), "\r\nFrames: %lu, bus us min %s avg %s max %s\r\n",
+              (unsigned long)trc.frame_no,
+              Us( trc.frame_bus_min, false, us1, sizeof(us1) ),
+              Us( (trc.frame_no != 0) ? trc.frame_bus_sum / trc.frame_no : 0, false, us2, sizeof(us2) ),
+              Us( trc.frame_bus_max, false, us3, sizeof(us3) ) );
+    put( line, ctx );
+    if ( n != 0 )
+        PutHeading( put, ctx, "Last frames", "    wall us" );
+    for ( i = trc.frame_no - n; i < trc.frame_no; i++ )
+    {
+        const FrameStat *f = &trc.frames[i % SE_TRACE_FRAMES];
+        char extra[1 + sizeof(buf)];                                    // Blank, time
+
+        snprintf( name, sizeof(name), "frame %lu", (unsigned long)f->no );
+        snprintf( extra, sizeof(extra), " %10s", Us( f->wall_ns, false, buf, sizeof(buf) ) );
+        PutCounters( put, ctx, name, &f->c, extra );
+    }
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seTRACE_WriteChromeJSON()
+//   Trace event format: transactions are complete ("X") events, API calls
+//   and polling loops begin/end pairs, frames global instant events. Pairs
+//   whose begin has left the ring are dropped.
+//---------------------------------------------------------------------------
+void seTRACE_WriteChromeJSON( seTRACE_PutFn put, void *ctx )
+{
+    uint32_t n = (trc.seq < SE_TRACE_RING_SIZE) ? trc.seq : SE_TRACE_RING_SIZE;
+    uint32_t api_depth = 0, poll_depth = 0;
+    const char *sep = "";
+    char line[256], name[40], ts[24], dur[24];
+    uint32_t i;
+
+    put( "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n", ctx );
+
+    for ( i = trc.seq - n; i != trc.seq; i++ )
+    {
+        const Event *ev = &trc.ring[i % SE_TRACE_RING_SIZE];
+        const char *tag = (ev->tag != NULL) ? ev->tag : "";
+
+        Us( ev->t_ns, true, ts, sizeof(ts) );
+        switch ( ev->kind )
+        {
+        case EV_XACT:
+            snprintf( line, sizeof(line),
+                      "%s{\"name\":\"%c %s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%s,\"dur\":%s,\"pid\":1,\"tid\":1,"
+                      "\"args\":{\"addr\":\"0x%08lX\",\"len\":%u,\"caller\":\"%s\"}}",
+                      sep, (ev->flags & EV_F_READ) ? 'R' : 'W', RegNameOf( ev->addr, name, sizeof(name) ),
+                      (ev->flags & EV_F_WASTED) ? "xact,poll,wasted" : (ev->flags & EV_F_POLL) ? "xact,poll" : "xact",
+                      ts, Us( ev->dur_ns, true, dur, sizeof(dur) ),
+                      (unsigned long)ev->addr, (unsigned)ev->len, tag );
+            break;
+
+        case EV_ENTER:
+        case EV_LEAVE:
+            if ( ev->kind == EV_LEAVE && api_depth == 0 )
+                continue;
+            api_depth += (ev->kind == EV_ENTER) ? 1 : -1;
+            snprintf( line, sizeof(line), "%s{\"name\":\"%s\",\"cat\":\"api\",\"ph\":\"%c\",\"ts\":%s,\"pid\":1,\"tid\":1}",
+                      sep, tag, (ev->kind == EV_ENTER) ? 'B' : 'E', ts );
+            break;
+
+        case EV_POLL_BEGIN:
+        case EV_POLL_END:
+            if ( ev->kind == EV_POLL_END && poll_depth == 0 )
+                continue;
+            poll_depth += (ev->kind == EV_POLL_BEGIN) ? 1 : -1;
+            snprintf( line, sizeof(line), "%s{\"name\":\"poll %s:%lu\",\"cat\":\"poll\",\"ph\":\"%c\",\"ts\":%s,\"pid\":1,\"tid\":1}",
+                      sep, tag, (unsigned long)ev->addr, (ev->kind == EV_POLL_BEGIN) ? 'B' : 'E', ts );
+            break;
+
+        default:
+            snprintf( line, sizeof(line), "%s{\"name\":\"frame %lu\",\"cat\":\"frame\",\"ph\":\"i\",\"s\":\"g\",\"ts\":%s,\"pid\":1,\"tid\":1}",
+                      sep, (unsigned long)ev->addr, ts );
+            break;
+        }
+        put( line, ctx );
+        sep = ",\n";
+    }
+
+    snprintf( line, sizeof(line), "\n],\"otherData\":{\"events\":%lu,\"dropped\":%lu}}\n",
+              (unsigned long)trc.seq, (unsigned long)(trc.seq - n) );
+    put( line, ctx );
+}
+
+
+#if defined(SE_HCL_HOST) || defined(__linux__)
+
+static void PutFile( const char *str, void *ctx )
+{
+    fputs( str, (FILE *)ctx );
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seTRACE_SaveFile()
+//---------------------------------------------------------------------------
+seStatus seTRACE_SaveFile( const char *path, seTRACE_Format fmt )
+{
+    FILE *f = fopen( path, "w" );
+
+    if ( f == NULL )
+        return seSTATUS_NG;
+
+    if ( fmt == seTRACE_FMT_JSON )
+        seTRACE_WriteChromeJSON( PutFile, f );
+    else
+        seTRACE_WriteSummary( PutFile, f );
+
+    return (fclose( f ) == 0) ? seSTATUS_OK : seSTATUS_NG;
+}
+
+#else
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seTRACE_PutRTT()
+//---------------------------------------------------------------------------
+void seTRACE_PutRTT( const char *str, void *ctx )
+{
+    (void)ctx;
+    SEGGER_RTT_WriteString( 0, str );
+}
+
+#endif
+
+#endif // SE_HCL_TRACE
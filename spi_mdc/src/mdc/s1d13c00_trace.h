@@ -0,0 +1,194 @@
+/**
+  ******************************************************************************
+  * @file    s1d13c00_trace.h
+  * @brief   Host bus transaction tracer and per call site profiler for the HCL.
+  ******************************************************************************
+  * @attention
+  *
+  * Compiled in only when SE_HCL_TRACE is defined, otherwise the macros below
+  * expand to nothing and the library is unchanged.
+  *
+  * Every chip select cycle the HCL runs is recorded with its address,
+  * direction, length, start time and duration (from the transport's now_ns)
+  * and the innermost library function active at the time (seTRACE_API()).
+  * Events go to a ring buffer for the Chrome trace export; the aggregates are
+  * kept separately so they stay complete when the ring wraps:
+  *  - per register (RAM and external memory are one entry each),
+  *  - per public API function, attributed to the outermost call so that
+  *    seMDC_GFX_PutString() includes the seMDC_Draw*() calls it makes,
+  *  - per frame, a frame ending at each seTRACE_FRAME(),
+  *  - per polling loop (seTRACE_POLL_WHILE()). A loop's transactions other
+  *    than the ones of its final, successful test are counted as wasted.
+  *
+  * seTRACE_WriteChromeJSON() produces a file for chrome://tracing or
+  * https://ui.perfetto.dev, seTRACE_WriteSummary() a text report. Both emit
+  * through a caller supplied function, seTRACE_PutRTT() and seTRACE_SaveFile()
+  * cover the usual cases.
+  *
+  * The tracer has no locking; callers already serialize HCL access.
+  ******************************************************************************
+  */
+
+#ifndef S1D13C00_TRACE_H_
+#define S1D13C00_TRACE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "se_common.h"
+
+#ifdef SE_HCL_TRACE
+
+#ifndef SE_TRACE_RING_SIZE
+#ifdef SE_HCL_HOST
+#define SE_TRACE_RING_SIZE      65536           ///< Events kept for the Chrome trace
+#else
+#define SE_TRACE_RING_SIZE      256
+#endif
+#endif
+
+#ifndef SE_TRACE_MAX_REGS
+#define SE_TRACE_MAX_REGS       64              ///< Distinct addresses aggregated
+#endif
+
+#ifndef SE_TRACE_MAX_APIS
+#define SE_TRACE_MAX_APIS       32              ///< Distinct API functions aggregated
+#endif
+
+#ifndef SE_TRACE_MAX_POLLS
+#define SE_TRACE_MAX_POLLS      32              ///< Distinct polling loops aggregated
+#endif
+
+#ifndef SE_TRACE_FRAMES
+#define SE_TRACE_FRAMES         8               ///< Most recent frames reported individually
+#endif
+
+#ifndef SE_TRACE_MAX_DEPTH
+#define SE_TRACE_MAX_DEPTH      8               ///< API nesting tracked
+#endif
+
+
+typedef enum {
+    seTRACE_WRITE = 0,
+    seTRACE_READ  = 1
+} seTRACE_Dir;
+
+
+typedef enum {
+    seTRACE_FMT_SUMMARY = 0,                ///< Text report
+    seTRACE_FMT_JSON    = 1                 ///< Chrome trace event JSON
+} seTRACE_Format;
+
+
+/**
+  * @brief  Bus counters, used for the totals and for each frame.
+  */
+typedef struct {
+    uint32_t xacts;                         ///< Chip select cycles
+    uint32_t wr_bytes;                      ///< Data bytes written, headers excluded
+    uint32_t rd_bytes;                      ///< Data bytes read
+    uint64_t bus_ns;                        ///< Time spent in the transport
+    uint32_t wasted_xacts;                  ///< Polling transactions that found the condition unmet
+    uint64_t wasted_ns;                     ///< Bus time of those
+} seTRACE_Counters;
+
+
+typedef void (*seTRACE_PutFn)( const char *str, void *ctx );
+
+/// Token returned by seTRACE_Enter(), restored by seTRACE_Leave().
+typedef uint8_t seTRACE_Scope;
+
+
+/**
+  * @brief  Tag the calling library function. Place at the top of the body;
+  *         the scope ends on every return (GCC/Clang cleanup attribute).
+  */
+#define seTRACE_API()                                                           \
+    seTRACE_Scope seTRACE_scope_ __attribute__((cleanup(seTRACE_Leave))) =      \
+        seTRACE_Enter( __func__ )
+
+/**
+  * @brief  Polling loop, used as "seTRACE_POLL_WHILE( cond );" in place of
+  *         "while ( cond );". cond is tested the same way.
+  */
+#define seTRACE_POLL_WHILE( cond )                                              \
+    for ( seTRACE_PollBegin( __func__, __LINE__ );                              \
+          seTRACE_PollTest() && ((cond) || seTRACE_PollEnd()); )
+
+/**
+  * @brief  End of a frame, typically after the last panel update of a redraw.
+  */
+#define seTRACE_FRAME()         seTRACE_Frame()
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+  * @brief  Clear the ring and all aggregates and restart the time base.
+  */
+void seTRACE_Reset( void );
+
+/**
+  * @brief  Pause or resume recording. Recording is on after start-up.
+  */
+void seTRACE_Enable( bool enable );
+
+/**
+  * @brief  Record one transaction, called by the HCL.
+  * @param  t0_ns, t1_ns:  transport time before and after the transfer
+  */
+void seTRACE_Xact( uint32_t addr, seTRACE_Dir dir, uint32_t len, uint64_t t0_ns, uint64_t t1_ns );
+
+seTRACE_Scope seTRACE_Enter( const char *func );
+void seTRACE_Leave( seTRACE_Scope *scope );
+void seTRACE_PollBegin( const char *func, uint16_t line );
+bool seTRACE_PollTest( void );
+bool seTRACE_PollEnd( void );
+void seTRACE_Frame( void );
+
+/**
+  * @brief  Totals since seTRACE_Reset(), and the last completed frame.
+  */
+void seTRACE_GetTotals( seTRACE_Counters *totals );
+void seTRACE_GetLastFrame( seTRACE_Counters *frame );
+
+/**
+  * @brief  Time spent in the polling loops of func since seTRACE_Reset(),
+  *         e.g. "seMDC_WaitGfxDone" for the graphics engine time the host saw.
+  */
+uint64_t seTRACE_GetPollTime( const char *func );
+
+/**
+  * @brief  Emit the report or the trace through put, in pieces of at most
+  *         a line.
+  */
+void seTRACE_WriteSummary( seTRACE_PutFn put, void *ctx );
+void seTRACE_WriteChromeJSON( seTRACE_PutFn put, void *ctx );
+
+#if defined(SE_HCL_HOST) || defined(__linux__)
+/**
+  * @brief  Write the report or the trace to a file.
+  * @retval seSTATUS_NG if the file cannot be written.
+  */
+seStatus seTRACE_SaveFile( const char *path, seTRACE_Format fmt );
+#else
+/**
+  * @brief  seTRACE_PutFn for SEGGER RTT channel 0, ctx is unused.
+  */
+void seTRACE_PutRTT( const char *str, void *ctx );
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#else // SE_HCL_TRACE
+
+#define seTRACE_API()               do { } while (0)
+#define seTRACE_POLL_WHILE( cond )  while ( cond )
+#define seTRACE_FRAME()             do { } while (0)
+
+#endif // SE_HCL_TRACE
+
+#endif /* S1D13C00_TRACE_H_ */
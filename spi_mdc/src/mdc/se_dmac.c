@@ -15,7 +15,8 @@
 #include <string.h>
 
 #include "s1d13c00_hcl.h"
-#include "s1d13C00_memregs.h"
+#include "s1d13c00_memregs.h"
+#include "s1d13c00_trace.h"
 #include "se_common.h"
 #include "se_dmac.h"
 
@@ -339,6 +340,7 @@ uint32_t seDMAC_NonBlockTransfMemToPeriph( uint32_t saddress, uint32_t periph, u
 
 void seDMAC_MemFill8 (uint32_t dstaddr, uint32_t nbytes, uint8_t fillbyte, seDMAC_CHANNEL chan)
 {
+    seTRACE_API();
     uint32_t k, m, cdata1;
 
     ///< Configure the primary data structure for the DMA channel
@@ -361,11 +363,11 @@ void seDMAC_MemFill8 (uint32_t dstaddr, uint32_t nbytes, uint8_t fillbyte, seDMA
         seDMAC_Start(chan);
 
         // Wait transfer complete
-        while((seS1D13C00Read8(DMAC_ENDIF) & chan) == 0);
+        seTRACE_POLL_WHILE( (seS1D13C00Read8(DMAC_ENDIF) & chan) == 0 );
         seSetBits8( DMAC_ENDIF, chan, chan );
 
         // Check that DMA is stopped
-        while ( (seDMAC_GetMode( chan ) != seDMAC_MODE_STOP ) );
+        seTRACE_POLL_WHILE( (seDMAC_GetMode( chan ) != seDMAC_MODE_STOP ) );
     }
 
     if ((nbytes % 1024) != 0)
@@ -380,11 +382,11 @@ void seDMAC_MemFill8 (uint32_t dstaddr, uint32_t nbytes, uint8_t fillbyte, seDMA
         seDMAC_Start(chan);
 
         // Wait transfer complete
-        while((seS1D13C00Read8(DMAC_ENDIF) & chan) == 0);
+        seTRACE_POLL_WHILE( (seS1D13C00Read8(DMAC_ENDIF) & chan) == 0 );
         seSetBits8( DMAC_ENDIF, chan, chan );
 
         // Check that DMA is stopped
-        while ( (seDMAC_GetMode( chan ) != seDMAC_MODE_STOP ) );
+        seTRACE_POLL_WHILE( (seDMAC_GetMode( chan ) != seDMAC_MODE_STOP ) );
     }
 
     seDMAC_Disable(  chan );
@@ -395,6 +397,7 @@ void seDMAC_MemFill8 (uint32_t dstaddr, uint32_t nbytes, uint8_t fillbyte, seDMA
 
 void seDMAC_MemFill16 (uint32_t dstaddr, uint32_t nhwords, uint16_t fillhword, seDMAC_CHANNEL chan)
 {
+    seTRACE_API();
     uint32_t k, m, cdata1;
 
     ///< Configure the primary data structure for the DMA channel
@@ -417,11 +420,11 @@ void seDMAC_MemFill16 (uint32_t dstaddr, uint32_t nhwords, uint16_t fillhword, s
         seDMAC_Start(chan);
 
         // Wait transfer complete
-        while((seS1D13C00Read8(DMAC_ENDIF) & chan) == 0);
+        seTRACE_POLL_WHILE( (seS1D13C00Read8(DMAC_ENDIF) & chan) == 0 );
         seSetBits8( DMAC_ENDIF, chan, chan );
 
         // Check that DMA is stopped
-        while ( (seDMAC_GetMode( chan ) != seDMAC_MODE_STOP ) );
+        seTRACE_POLL_WHILE( (seDMAC_GetMode( chan ) != seDMAC_MODE_STOP ) );
     }
 
     if ((nhwords % 1024) != 0)
@@ -436,11 +439,11 @@ void seDMAC_MemFill16 (uint32_t dstaddr, uint32_t nhwords, uint16_t fillhword, s
         seDMAC_Start(chan);
 
         // Wait transfer complete
-        while((seS1D13C00Read8(DMAC_ENDIF) & chan) == 0);
+        seTRACE_POLL_WHILE( (seS1D13C00Read8(DMAC_ENDIF) & chan) == 0 );
         seSetBits8( DMAC_ENDIF, chan, chan );
 
         // Check that DMA is stopped
-        while ( (seDMAC_GetMode( chan ) != seDMAC_MODE_STOP ) );
+        seTRACE_POLL_WHILE( (seDMAC_GetMode( chan ) != seDMAC_MODE_STOP ) );
     }
 
     seDMAC_Disable(  chan );
@@ -451,6 +454,7 @@ void seDMAC_MemFill16 (uint32_t dstaddr, uint32_t nhwords, uint16_t fillhword, s
 
 void seDMAC_MemFill32 (uint32_t dstaddr, uint32_t nwords, uint32_t fillword, seDMAC_CHANNEL chan)
 {
+    seTRACE_API();
     uint32_t k, m, cdata1;
 
     ///< Configure the primary data structure for the DMA channel
@@ -473,11 +477,11 @@ void seDMAC_MemFill32 (uint32_t dstaddr, uint32_t nwords, uint32_t fillword, seD
         seDMAC_Start(chan);
 
         // Wait transfer complete
-        while((seS1D13C00Read8(DMAC_ENDIF) & chan) == 0);
+        seTRACE_POLL_WHILE( (seS1D13C00Read8(DMAC_ENDIF) & chan) == 0 );
         seSetBits8( DMAC_ENDIF, chan, chan );
 
         // Check that DMA is stopped
-        while ( (seDMAC_GetMode( chan ) != seDMAC_MODE_STOP ) );
+        seTRACE_POLL_WHILE( (seDMAC_GetMode( chan ) != seDMAC_MODE_STOP ) );
     }
 
     if ((nwords % 1024) != 0)
@@ -492,11 +496,11 @@ void seDMAC_MemFill32 (uint32_t dstaddr, uint32_t nwords, uint32_t fillword, seD
         seDMAC_Start(chan);
 
         // Wait transfer complete
-        while((seS1D13C00Read8(DMAC_ENDIF) & chan) == 0);
+        seTRACE_POLL_WHILE( (seS1D13C00Read8(DMAC_ENDIF) & chan) == 0 );
         seSetBits8( DMAC_ENDIF, chan, chan );
 
         // Check that DMA is stopped
-        while ( (seDMAC_GetMode( chan ) != seDMAC_MODE_STOP ) );
+        seTRACE_POLL_WHILE( (seDMAC_GetMode( chan ) != seDMAC_MODE_STOP ) );
     }
 
     seDMAC_Disable(  chan );
@@ -507,6 +511,7 @@ void seDMAC_MemFill32 (uint32_t dstaddr, uint32_t nwords, uint32_t fillword, seD
 
 void seDMAC_MemCpy8 (uint32_t srcaddr, uint32_t dstaddr, uint32_t nbytes, seDMAC_CHANNEL chan)
 {
+    seTRACE_API();
     uint32_t k, m, cdata1;
 
     ///< Configure the primary data structure for the DMA channel
@@ -530,11 +535,11 @@ void seDMAC_MemCpy8 (uint32_t srcaddr, uint32_t dstaddr, uint32_t nbytes, seDMAC
         seDMAC_Start(chan);
 
         // Wait transfer complete interrupt
-        while((seS1D13C00Read16(SYS_INTS) & SYS_DMACINT_bits) == 0);
+        seTRACE_POLL_WHILE( (seS1D13C00Read16(SYS_INTS) & SYS_DMACINT_bits) == 0 );
         seS1D13C00Write8(DMAC_ENDIF, chan);     // Clear CHx completion interrupt flag
 
         // Check that DMA is stopped
-        while ( (seDMAC_GetMode( chan ) != seDMAC_MODE_STOP ) );
+        seTRACE_POLL_WHILE( (seDMAC_GetMode( chan ) != seDMAC_MODE_STOP ) );
     }
 
     if ((nbytes % 1024) != 0)
@@ -549,11 +554,11 @@ void seDMAC_MemCpy8 (uint32_t srcaddr, uint32_t dstaddr, uint32_t nbytes, seDMAC
         seDMAC_Start(chan);
 
         // Wait transfer complete interrupt
-        while((seS1D13C00Read16(SYS_INTS) & SYS_DMACINT_bits) == 0);
+        seTRACE_POLL_WHILE( (seS1D13C00Read16(SYS_INTS) & SYS_DMACINT_bits) == 0 );
         seS1D13C00Write8(DMAC_ENDIF, chan);     // Clear CHx completion interrupt flag
 
         // Check that DMA is stopped
-        while ( (seDMAC_GetMode( chan ) != seDMAC_MODE_STOP ) );
+        seTRACE_POLL_WHILE( (seDMAC_GetMode( chan ) != seDMAC_MODE_STOP ) );
     }
 
     seDMAC_DisableInt( seDMAC_TRANSF_COMPL, chan   );
@@ -564,6 +569,7 @@ void seDMAC_MemCpy8 (uint32_t srcaddr, uint32_t dstaddr, uint32_t nbytes, seDMAC
 
 void seDMAC_MemCpy16 (uint32_t srcaddr, uint32_t dstaddr, uint32_t nhwords, seDMAC_CHANNEL chan)
 {
+    seTRACE_API();
     uint32_t k, m, cdata1;
 
     ///< Configure the primary data structure for the DMA channel
@@ -587,11 +593,11 @@ void seDMAC_MemCpy16 (uint32_t srcaddr, uint32_t dstaddr, uint32_t nhwords, seDM
         seDMAC_Start(chan);
 
         // Wait transfer complete interrupt
-        while((seS1D13C00Read16(SYS_INTS) & SYS_DMACINT_bits) == 0);
+        seTRACE_POLL_WHILE( (seS1D13C00Read16(SYS_INTS) & SYS_DMACINT_bits) == 0 );
         seS1D13C00Write8(DMAC_ENDIF, chan);     // Clear CHx completion interrupt flag
 
         // Check that DMA is stopped
-        while ( (seDMAC_GetMode( chan ) != seDMAC_MODE_STOP ) );
+        seTRACE_POLL_WHILE( (seDMAC_GetMode( chan ) != seDMAC_MODE_STOP ) );
     }
 
     if ((nhwords % 1024) != 0)
@@ -606,11 +612,11 @@ void seDMAC_MemCpy16 (uint32_t srcaddr, uint32_t dstaddr, uint32_t nhwords, seDM
         seDMAC_Start(chan);
 
         // Wait transfer complete interrupt
-        while((seS1D13C00Read16(SYS_INTS) & SYS_DMACINT_bits) == 0);
+        seTRACE_POLL_WHILE( (seS1D13C00Read16(SYS_INTS) & SYS_DMACINT_bits) == 0 );
         seS1D13C00Write8(DMAC_ENDIF, chan);     // Clear CHx completion interrupt flag
 
         // Check that DMA is stopped
-        while ( (seDMAC_GetMode( chan ) != seDMAC_MODE_STOP ) );
+        seTRACE_POLL_WHILE( (seDMAC_GetMode( chan ) != seDMAC_MODE_STOP ) );
     }
 
     seDMAC_DisableInt( seDMAC_TRANSF_COMPL, chan   );
@@ -621,6 +627,7 @@ void seDMAC_MemCpy16 (uint32_t srcaddr, uint32_t dstaddr, uint32_t nhwords, seDM
 
 void seDMAC_MemCpy32 (uint32_t srcaddr, uint32_t dstaddr, uint32_t nwords, seDMAC_CHANNEL chan)
 {
+    seTRACE_API();
     uint32_t k, m, cdata1;
 
     ///< Configure the primary data structure for the DMA channel
@@ -644,11 +651,11 @@ void seDMAC_MemCpy32 (uint32_t srcaddr, uint32_t dstaddr, uint32_t nwords, seDMA
         seDMAC_Start(chan);
 
         // Wait transfer complete interrupt
-        while((seS1D13C00Read16(SYS_INTS) & SYS_DMACINT_bits) == 0);
+        seTRACE_POLL_WHILE( (seS1D13C00Read16(SYS_INTS) & SYS_DMACINT_bits) == 0 );
         seS1D13C00Write8(DMAC_ENDIF, chan);     // Clear CHx completion interrupt flag
 
         // Check that DMA is stopped
-        while ( (seDMAC_GetMode( chan ) != seDMAC_MODE_STOP ) );
+        seTRACE_POLL_WHILE( (seDMAC_GetMode( chan ) != seDMAC_MODE_STOP ) );
     }
 
     if ((nwords % 1024) != 0)
@@ -663,11 +670,11 @@ void seDMAC_MemCpy32 (uint32_t srcaddr, uint32_t dstaddr, uint32_t nwords, seDMA
         seDMAC_Start(chan);
 
         // Wait transfer complete interrupt
-        while((seS1D13C00Read16(SYS_INTS) & SYS_DMACINT_bits) == 0);
+        seTRACE_POLL_WHILE( (seS1D13C00Read16(SYS_INTS) & SYS_DMACINT_bits) == 0 );
         seS1D13C00Write8(DMAC_ENDIF, chan);     // Clear CHx completion interrupt flag
 
         // Check that DMA is stopped
-        while ( (seDMAC_GetMode( chan ) != seDMAC_MODE_STOP ) );
+        seTRACE_POLL_WHILE( (seDMAC_GetMode( chan ) != seDMAC_MODE_STOP ) );
     }
 
     seDMAC_DisableInt( seDMAC_TRANSF_COMPL, chan   );
@@ -14,7 +14,8 @@
 
 
 #include "s1d13c00_hcl.h"
-#include "s1d13C00_memregs.h"
+#include "s1d13c00_memregs.h"
+#include "s1d13c00_trace.h"
 #include "se_common.h"
 #include "se_clg.h"
 #include "se_port.h"
@@ -101,7 +102,7 @@ seStatus seI2C_Reset( void )
     seStatus fStatus = seSTATUS_OK;
 
     seSetBits16( I2C_CTL, I2C_SFTRST_bits, I2C_SFTRST_bits );
-    while( seS1D13C00Read16( I2C_CTL ) & I2C_SFTRST_bits );
+    seTRACE_POLL_WHILE( seS1D13C00Read16( I2C_CTL ) & I2C_SFTRST_bits );
 
     return fStatus;
 }
@@ -138,7 +139,7 @@ seStatus seI2C_MstSendData( uint16_t address, uint8_t data[], uint32_t size, uin
             address |= 0x1e << 10;     //< add leading '11110 to introduce the 10 bit addressing scheme
             seS1D13C00Write16( I2C_TXD, (uint8_t)((address>>8) << 1) + 0 );
 
-            while( (seS1D13C00Read16( I2C_INTF ) & I2C_TBEIF_bits) == 0 );
+            seTRACE_POLL_WHILE( (seS1D13C00Read16( I2C_INTF ) & I2C_TBEIF_bits) == 0 );
 
             if ( fStatus == seSTATUS_OK ) {
                 seS1D13C00Write16( I2C_TXD, (uint8_t)address );
@@ -153,7 +154,7 @@ seStatus seI2C_MstSendData( uint16_t address, uint8_t data[], uint32_t size, uin
 
         while ( size--  && (fStatus==seSTATUS_OK) )
         {
-            while( (seS1D13C00Read16( I2C_INTF ) & (I2C_TBEIF_bits | I2C_NACKIF_bits)) == 0 );
+            seTRACE_POLL_WHILE( (seS1D13C00Read16( I2C_INTF ) & (I2C_TBEIF_bits | I2C_NACKIF_bits)) == 0 );
 
             if ( fStatus == seSTATUS_OK )
             {
@@ -220,7 +221,7 @@ seStatus seI2C_MstReceiveData( uint16_t address, uint8_t data[], uint32_t size,
 
     while ( size--  && (fStatus == seSTATUS_OK) )
     {
-        while( (seS1D13C00Read16( I2C_INTF ) & (I2C_RBFIF_bits | I2C_NACKIF_bits)) == 0 );
+        seTRACE_POLL_WHILE( (seS1D13C00Read16( I2C_INTF ) & (I2C_RBFIF_bits | I2C_NACKIF_bits)) == 0 );
 
         if ( fStatus == seSTATUS_OK )
         {
@@ -280,7 +281,7 @@ seStatus seI2C_SlvSendData( uint8_t data[], uint32_t size )
                     seS1D13C00Write8( I2C_TXD, *data++ );
 
                     ///< Wait for an interrupt request
-                    while( (seS1D13C00Read16(I2C_INTF) & (I2C_TBEIF_bits | I2C_NACKIF_bits | I2C_STOPIF_bits)) == 0 );
+                    seTRACE_POLL_WHILE( (seS1D13C00Read16(I2C_INTF) & (I2C_TBEIF_bits | I2C_NACKIF_bits | I2C_STOPIF_bits)) == 0 );
                     if ( fStatus == seSTATUS_OK )
                     {
                         intF = seS1D13C00Read16( I2C_INTF );
@@ -300,7 +301,7 @@ seStatus seI2C_SlvSendData( uint8_t data[], uint32_t size )
 
                 if ( fStatus == seSTATUS_OK )
                 {
-                    while( (seS1D13C00Read16( I2C_INTF) & I2C_TBEIF_bits) == 0 );
+                    seTRACE_POLL_WHILE( (seS1D13C00Read16( I2C_INTF) & I2C_TBEIF_bits) == 0 );
 
                     if ( fStatus == seSTATUS_OK ) {
                         seS1D13C00Write8( I2C_TXD, 0 );
@@ -353,7 +354,7 @@ seStatus seI2C_SlvReceiveData( uint8_t data[], uint32_t size )
 
             while ( size-- )
             {
-                while( (seS1D13C00Read16( I2C_INTF) & (I2C_RBFIF_bits | I2C_BYTEENDIF_bits)) == 0 );
+                seTRACE_POLL_WHILE( (seS1D13C00Read16( I2C_INTF) & (I2C_RBFIF_bits | I2C_BYTEENDIF_bits)) == 0 );
 
                 if ( fStatus == seSTATUS_NG ) {
                     break;
@@ -430,7 +431,7 @@ static seStatus setI2cMstStartCondition( void )
     seSetBits16( I2C_CTL, I2C_TXSTART_bits, I2C_TXSTART_bits );
 
     ///< Wait START condition.
-    while( (seS1D13C00Read16( I2C_INTF ) & I2C_STARTIF_bits) == 0 );
+    seTRACE_POLL_WHILE( (seS1D13C00Read16( I2C_INTF ) & I2C_STARTIF_bits) == 0 );
 
     ///< Clear START condition interrupt.
     seI2C_ClearIntFlag( seI2C_STARTIF );
@@ -454,7 +455,7 @@ static seStatus setI2cMstStopCondition( void )
     seSetBits16( I2C_CTL, I2C_TXSTOP_bits, I2C_TXSTOP_bits );
 
     ///< Wait Stop flag condition.
-    while( (seS1D13C00Read16( I2C_INTF ) & I2C_STOPIF_bits) == 0 );
+    seTRACE_POLL_WHILE( (seS1D13C00Read16( I2C_INTF ) & I2C_STOPIF_bits) == 0 );
 
     ///< Clear STOP condition interrupt.
     seI2C_ClearIntFlag( seI2C_STOPIF );
@@ -475,7 +476,7 @@ inline seStartStopCondition waitI2cSlvStartStopCondition( void )
     seStartStopCondition ss_condition = seI2C_TIME_OUT_CND;
 
     ///< Wait for a START/STOP condition interrupt.
-    while( (seS1D13C00Read16( I2C_INTF) & (I2C_STOPIF_bits | I2C_STARTIF_bits)) == 0 );
+    seTRACE_POLL_WHILE( (seS1D13C00Read16( I2C_INTF) & (I2C_STOPIF_bits | I2C_STARTIF_bits)) == 0 );
 
     if ( fStatus == seSTATUS_OK )
     {
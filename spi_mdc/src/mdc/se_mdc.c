@@ -13,1014 +13,1018 @@
   */
 
 #include <stdio.h>
+#include <string.h>
 
 #include "s1d13c00_hcl.h"
-#include "s1d13C00_memregs.h"
+#include "s1d13c00_memregs.h"
+#include "s1d13c00_trace.h"
 #include "se_common.h"
 #include "se_mdc.h"
+#include "crc16.h"
+
+
+
+//---------------------------------------------------------------------------
+// Panel descriptors
+//   DISPCTL values have VCOMEN cleared, the init engine sets it last.
+//---------------------------------------------------------------------------
+#define DISPCTL_6BIT    ( seMDC_DISP_PANELNOTGS   << 11 | \
+                          seMDC_DISP_PIXNORMAL    <<  7 | \
+                          seMDC_DISP_UPD          <<  6 | \
+                          seMDC_DISP_PANEL6BIT    <<  4 | \
+                          seMDC_DISP_ROT0         <<  2 )
+
+#define DISPCTL_SPI1BIT ( seMDC_DISP_PANELNOTGS   << 11 | \
+                          seMDC_DISP_SPILSBFIRST  <<  9 | \
+                          seMDC_DISP_AUTOCOMOFF   <<  8 | \
+                          seMDC_DISP_PIXNORMAL    <<  7 | \
+                          seMDC_DISP_UPD          <<  6 | \
+                          seMDC_DISP_SPI1BIT      <<  5 | \
+                          seMDC_DISP_PANELSPI     <<  4 | \
+                          seMDC_DISP_ROT0         <<  2 )
+
+#define DISPCTL_SPI3BIT ( seMDC_DISP_PANELNOTGS   << 11 | \
+                          seMDC_DISP_SPIRGB       << 10 | \
+                          seMDC_DISP_AUTOCOMOFF   <<  8 | \
+                          seMDC_DISP_PIXNORMAL    <<  7 | \
+                          seMDC_DISP_UPD          <<  6 | \
+                          seMDC_DISP_SPI3BIT      <<  5 | \
+                          seMDC_DISP_PANELSPI     <<  4 | \
+                          seMDC_DISP_ROT0         <<  2 )
+
+// LPM011M133B (218x218, 6-bit color, 1.1" round)
+const seMDC_PanelDesc seMDC_Panel_LPM011M133B = {
+    .name     = "LPM011M133B",
+    .width    = 218,
+    .height   = 218,
+    .vcomdiv  = 136,                                // VCOM freq = 32768 / (4*(136+1)) = ~60Hz
+    .clkhz    = 2850000,                            // T = 0.35us
+    .tim0     = 0x0100,                             // VCKHST = (1 + 1) * T = 0.7us
+    .prm      = { 0x0075,                           // VSTVCK = (117 + 1) * T = 41.3us, HSTHCK = (0 + 1) * T = 0.35us
+                  0x1900,                           // HCKDLY = (0 + 1) * T = 0.35us, t0 + t2 + 25 * 2T = 18.55us
+                  0x3636,                           // ENBW = 54 HCK counts = 37.8us, XRSTVST = (54 + 1) * T = 19.25us
+                  0x0000,                           // HCK to HST/data = 0.35us, end of line to VCK = 0.7us
+                  0x0101,                           // HCK count for start of pixel data, extra HCK counts after line
+                  0x0002,                           // VCK count for start of pixel data, extra VCK counts after frame
+                  0x0003 },                         // Fast VCK high/low width = 3 * T = 1.05us
+    .nprm     = 7,
+    .flags    = seMDC_PANEL_DISPCTL2,
+    .dispctl  = DISPCTL_6BIT,
+    .dispctl2 = seMDC_DISP_CSPOLNORM << 4 | seMDC_DISP_VSTFALL << 3 | seMDC_DISP_HSTRISE << 2 |
+                seMDC_DISP_ENBLSB << 1 | seMDC_DISP_VCKFAST << 0,
+    .bstvmd   = { seMDC_VMDH_4V5 << 12 | seMDC_VMDL_3V2 << 4 | 0x0001,     // VMDL on
+                  seMDC_VMDH_4V5 << 12 | seMDC_VMDL_3V2 << 4 | 0x0101 },   // VMDH on
+    .pwrms    = 2,
+    .vmdms    = { 2, 3 },                           // T1, T2 + T3 (panel internal circuit reset)
+    .dispenms = 0,
+    .vcomms   = 17,                                 // About 1 VCOM cycle
+    .black    = 0x00C0,
+};
+
+// LPM012M134B (240x240, 6-bit color, 1.2" round)
+const seMDC_PanelDesc seMDC_Panel_LPM012M134B = {
+    .name     = "LPM012M134B",
+    .width    = 240,
+    .height   = 240,
+    .vcomdiv  = 136,                                // VCOM freq = ~60Hz
+    .clkhz    = 2850000,                            // T = 0.35us
+    .tim0     = 0x0100,                             // VCKHST = (1 + 1) * T = 0.7us
+    .prm      = { 0x0075,                           // VSTVCK = (117 + 1) * T = 41.3us, HSTHCK = 0.35us
+                  0x1D00,                           // HCKDLY = 0.35us, t0 + t2 + 29 * 2T
+                  0x363C,                           // ENBW = 54 HCK counts = 37.8us, XRSTVST = (60 + 1) * T
+                  0x0000,
+                  0x0101,
+                  0x0002,
+                  0x0003 },
+    .nprm     = 7,
+    .flags    = seMDC_PANEL_DISPCTL2,
+    .dispctl  = DISPCTL_6BIT,
+    .dispctl2 = seMDC_DISP_CSPOLNORM << 4 | seMDC_DISP_VSTFALL << 3 | seMDC_DISP_HSTRISE << 2 |
+                seMDC_DISP_ENBLSB << 1 | seMDC_DISP_VCKFAST << 0,
+    .bstvmd   = { seMDC_VMDH_4V5 << 12 | seMDC_VMDL_3V2 << 4 | 0x0001,
+                  seMDC_VMDH_4V5 << 12 | seMDC_VMDL_3V2 << 4 | 0x0101 },
+    .pwrms    = 2,
+    .vmdms    = { 2, 3 },
+    .dispenms = 0,
+    .vcomms   = 17,
+    .black    = 0x00C0,
+};
+
+// LS010B7DH01 (128x128, SPI, 1-bit BW, 1.0" round)
+const seMDC_PanelDesc seMDC_Panel_LS010B7DH01 = {
+    .name     = "LS010B7DH01",
+    .width    = 128,
+    .height   = 128,
+    .vcomdiv  = 16383,                              // EXTCOM freq = ~0.5Hz
+    .clkhz    = 1500000,                            // SCLK is 1.5MHz
+    .tim0     = 0x0400,                             // tsSCS = (4 + 1) * T
+    .prm      = { 0x0F01,                           // thSCS, data transfer period = 16 SCLK cycles
+                  0x0701,                           // Mode bits value, number of mode bits = 8
+                  0x0107 },                         // Number of address bits = 8, twSCSL = (1 + 1) * T
+    .nprm     = 3,
+    .flags    = seMDC_PANEL_DISPEN | seMDC_PANEL_DISPCTL2,
+    .dispctl  = DISPCTL_SPI1BIT,
+    .dispctl2 = seMDC_DISP_GSALPHAON << 5,
+    .bstvmd   = { seMDC_VMDH_5V0 << 12 | seMDC_VMDL_3V0 << 4 | 0x0101, 0 },  // VMDL and VMDH on
+    .pwrms    = 2,
+    .vmdms    = { 2, 0 },                           // T1
+    .dispenms = 1,                                  // At least 30us
+    .vcomms   = 1,
+    .black    = 0x0002,
+};
+
+// LS012B7DD06 (240x240, 6-bit color, 1.2" round)
+const seMDC_PanelDesc seMDC_Panel_LS012B7DD06 = {
+    .name     = "LS012B7DD06",
+    .width    = 240,
+    .height   = 240,
+    .vcomdiv  = 272,                                // VCOM freq = ~30Hz
+    .clkhz    = 5000000,                            // T = 0.2us
+    .tim0     = 0x0000,
+    .prm      = { 0x0036, 0x7A00, 0x3118, 0x2100, 0x0202, 0x0202, 0x0003 },
+    .nprm     = 7,
+    .flags    = seMDC_PANEL_DISPCTL2,
+    .dispctl  = DISPCTL_6BIT,
+    .dispctl2 = seMDC_DISP_CSPOLNORM << 4 | seMDC_DISP_VSTFALL << 3 | seMDC_DISP_HSTFALL << 2 |
+                seMDC_DISP_ENBMSB << 1 | seMDC_DISP_VCKNORM << 0,
+    .bstvmd   = { seMDC_VMDH_5V0 << 12 | seMDC_VMDL_3V2 << 4 | 0x0001,
+                  seMDC_VMDH_5V0 << 12 | seMDC_VMDL_3V2 << 4 | 0x0101 },
+    .pwrms    = 2,
+    .vmdms    = { 2, 3 },
+    .dispenms = 0,
+    .vcomms   = 17,
+    .black    = 0x00C0,
+};
+
+// 6BIT260X260 (260x260, 6-bit color, 1.2" round)
+const seMDC_PanelDesc seMDC_Panel_6BIT260X260 = {
+    .name     = "6BIT260X260",
+    .width    = 260,
+    .height   = 260,
+    .vcomdiv  = 272,
+    .clkhz    = 5000000,
+    .tim0     = 0x0000,
+    .prm      = { 0x0036, 0x7A00, 0x3118, 0x0000, 0x0301, 0x0502, 0x0003 },
+    .nprm     = 7,
+    .flags    = seMDC_PANEL_DISPCTL2,
+    .dispctl  = DISPCTL_6BIT,
+    .dispctl2 = seMDC_DISP_CSPOLNORM << 4 | seMDC_DISP_VSTFALL << 3 | seMDC_DISP_HSTFALL << 2 |
+                seMDC_DISP_ENBLSB << 1 | seMDC_DISP_VCKNORM << 0,
+    .bstvmd   = { seMDC_VMDH_5V0 << 12 | seMDC_VMDL_3V2 << 4 | 0x0001,
+                  seMDC_VMDH_5V0 << 12 | seMDC_VMDL_3V2 << 4 | 0x0101 },
+    .pwrms    = 2,
+    .vmdms    = { 2, 3 },
+    .dispenms = 0,
+    .vcomms   = 17,
+    .black    = 0x00C0,
+};
+
+// LS013B4DN04 (96x96, SPI, 1-bit BW, 1.3" square)
+const seMDC_PanelDesc seMDC_Panel_LS013B4DN04 = {
+    .name     = "LS013B4DN04",
+    .width    = 96,
+    .height   = 96,
+    .vcomdiv  = 16383,
+    .clkhz    = 1500000,
+    .tim0     = 0x0800,                             // tsSCS = (8 + 1) * T = 6us
+    .prm      = { 0x0F02, 0x0701, 0x0207 },
+    .nprm     = 3,
+    .flags    = seMDC_PANEL_DISPEN | seMDC_PANEL_DISPCTL2,
+    .dispctl  = DISPCTL_SPI1BIT,
+    .dispctl2 = seMDC_DISP_GSALPHAON << 5,
+    .bstvmd   = { seMDC_VMDL_3V0 << 4 | 0x0001, 0 },                     // VMDL on
+    .pwrms    = 2,
+    .vmdms    = { 2, 0 },
+    .dispenms = 1,
+    .vcomms   = 1,
+    .black    = 0x0002,
+};
+
+// LS013B7DH06 (128x128, SPI, 3-bit color, 1.33" square)
+const seMDC_PanelDesc seMDC_Panel_LS013B7DH06 = {
+    .name     = "LS013B7DH06",
+    .width    = 128,
+    .height   = 128,
+    .vcomdiv  = 16383,
+    .clkhz    = 1500000,
+    .tim0     = 0x0400,
+    .prm      = { 0x0F01, 0x0701, 0x0107 },
+    .nprm     = 3,
+    .flags    = seMDC_PANEL_DISPEN,
+    .dispctl  = DISPCTL_SPI3BIT | seMDC_DISP_SPILSBFIRST << 9,
+    .dispctl2 = 0,
+    .bstvmd   = { seMDC_VMDH_5V0 << 12 | seMDC_VMDL_3V0 << 4 | 0x0101, 0 },
+    .pwrms    = 2,
+    .vmdms    = { 2, 0 },
+    .dispenms = 1,
+    .vcomms   = 1,
+    .black    = 0x0008,
+};
+
+// LS012B7DH02 (240x240, SPI, 1-bit BW, 1.2" square)
+const seMDC_PanelDesc seMDC_Panel_LS012B7DH02 = {
+    .name     = "LS012B7DH02",
+    .width    = 240,
+    .height   = 240,
+    .vcomdiv  = 286,                                // EXTCOM freq = ~28.5Hz typical
+    .clkhz    = 1500000,
+    .tim0     = 0x0800,
+    .prm      = { 0x0F01, 0x0701, 0x0107 },
+    .nprm     = 3,
+    .flags    = seMDC_PANEL_DISPEN | seMDC_PANEL_DISPCTL2,
+    .dispctl  = DISPCTL_SPI1BIT,
+    .dispctl2 = seMDC_DISP_GSALPHAON << 5,
+    .bstvmd   = { seMDC_VMDL_3V0 << 4 | 0x0001, 0 },
+    .pwrms    = 2,
+    .vmdms    = { 2, 0 },
+    .dispenms = 1,
+    .vcomms   = 1,
+    .black    = 0x0002,
+};
+
+// LPM013M126C (176x176, SPI, 3-bit color, 1.28" square)
+const seMDC_PanelDesc seMDC_Panel_LPM013M126C = {
+    .name     = "LPM013M126C",
+    .width    = 176,
+    .height   = 176,
+    .vcomdiv  = 8191,                               // EXTCOM freq = ~1Hz typical
+    .clkhz    = 1500000,
+    .tim0     = 0x0800,
+    .prm      = { 0x0F02,                           // thSCS = (2 + 1) * T = 2us, 16 SCLK cycles per transfer
+                  0x0501,                           // Number of mode bits = 6
+                  0x0809 },                         // Number of address bits = 10, twSCSL = (8 + 1) * T = 6us
+    .nprm     = 3,
+    .flags    = seMDC_PANEL_DISPEN,
+    .dispctl  = DISPCTL_SPI3BIT | seMDC_DISP_SPIMSBFIRST << 9,
+    .dispctl2 = 0,
+    .bstvmd   = { seMDC_VMDL_3V0 << 4 | 0x0001, 0 },
+    .pwrms    = 2,
+    .vmdms    = { 2, 0 },
+    .dispenms = 1,
+    .vcomms   = 1,
+    .black    = 0x0008,
+};
+
+// LPM027M128A (400x240, SPI, 3-bit color, 2.7" rectangular)
+const seMDC_PanelDesc seMDC_Panel_LPM027M128A = {
+    .name     = "LPM027M128A",
+    .width    = 400,
+    .height   = 240,
+    .vcomdiv  = 8191,
+    .clkhz    = 1500000,
+    .tim0     = 0x0800,
+    .prm      = { 0x0F02, 0x0501, 0x0809 },
+    .nprm     = 3,
+    .flags    = seMDC_PANEL_DISPEN,
+    .dispctl  = DISPCTL_SPI3BIT | seMDC_DISP_SPIMSBFIRST << 9,
+    .dispctl2 = 0,
+    .bstvmd   = { seMDC_VMDL_3V0 << 4 | 0x0001, 0 },
+    .pwrms    = 2,
+    .vmdms    = { 2, 0 },
+    .dispenms = 1,
+    .vcomms   = 1,
+    .black    = 0x0008,
+};
+
+const seMDC_PanelDesc * const seMDC_Panels[seMDC_PANEL_COUNT] = {
+    &seMDC_Panel_LPM011M133B,
+    &seMDC_Panel_LPM012M134B,
+    &seMDC_Panel_LS010B7DH01,
+    &seMDC_Panel_LS012B7DD06,
+    &seMDC_Panel_6BIT260X260,
+    &seMDC_Panel_LS013B4DN04,
+    &seMDC_Panel_LS013B7DH06,
+    &seMDC_Panel_LS012B7DH02,
+    &seMDC_Panel_LPM013M126C,
+    &seMDC_Panel_LPM027M128A,
+};
+
+
+//---------------------------------------------------------------------------
+// Panel init engine state
+//   The supply sequence runs as steps, each taken once the wait of the
+//   previous one has passed. Steps are taken by seMDC_PanelInitPoll() when
+//   the transport has a time base, or else by seMDC_PanelInitFinish().
+//---------------------------------------------------------------------------
+typedef enum {
+    PANEL_IDLE = 0,                     // No init in progress
+    PANEL_PWR,                          // BSTPWR on, waiting pwrms
+    PANEL_VMDL,                         // First BSTVMD step, waiting vmdms[0]
+    PANEL_VMDH,                         // Second BSTVMD step, waiting vmdms[1]
+    PANEL_SUPPLY,                       // Supplies up, seMDC_PanelInitFinish() not called yet
+    PANEL_FIRST,                        // Panel set up, seMDC_WaitUpdDone() of the first update enables it (seMDC_INIT_NOBLANK)
+    PANEL_SETTLE,                       // Panel enabled, VCOM settling until readyns
+    PANEL_READY
+} PanelState;
+
+static struct {
+    const seMDC_PanelDesc *panel;
+    uint32_t    options;
+    PanelState  state;
+    uint32_t    stepms;                 // Wait after the last step
+    uint64_t    stepns;                 // Time of the last step
+    uint64_t    readyns;                // End of the VCOM settling time
+    uint64_t    startns;                // seMDC_PanelInitStart() time
+    uint64_t    waitns;                 // Time slept for the sequence
+    uint32_t    needms;                 // Sum of the sequence waits
+    uint32_t    init_us;
+    uint32_t    ttff_us;
+    uint8_t     ttff;                   // Waiting for the end of the first frame
+    uint16_t    regs[13];               // DISPWIDTH to DISPFRMBUFF1 as written
+} PanelInit;
+
+#define PANEL_RESUME_MAGIC      0x5743444DUL                            // "MDCW"
+
+//---------------------------------------------------------------------------
+// Panel update scheduler state
+//   One update runs at a time. Lines requested while it runs or while its
+//   trigger is not due yet are merged into one pending range. The booster
+//   leaves ECO mode once per burst and is put back when the last update of
+//   the burst is done.
+//---------------------------------------------------------------------------
+typedef enum {
+    UPD_IDLE = 0,                       // No update running or pending
+    UPD_DUE,                            // Range pending, triggered once the booster and panel are ready
+    UPD_BUSY                            // Update running, a range may be pending
+} UpdState;
+
+#define UPD_BOOST_NS            1000000                                 // Booster stabilization time after leaving ECO mode
+
+static struct {
+    UpdState    state;
+    uint8_t     pending;                // starty..endy requested, not triggered
+    uint8_t     boost;                  // Booster out of ECO mode
+    uint16_t    bstpwr;                 // BSTPWR read when leaving ECO mode
+    uint16_t    starty;
+    uint16_t    endy;
+    uint64_t    boostns;                // Time ECO mode was left
+} PanelUpd;
+
+// DISPCTL bits checked on resume, rotation and inversion may have changed since
+#define PANEL_DISPCTL_KEEP      ( 0x0800 | MDC_RGBORD_bits | MDC_ADDRLSB_bits | MDC_AUTOCOM_bits | \
+                                  MDC_UPDFUNC_bits | MDC_SPITYPE_bits | MDC_DISPSPI_bits | MDC_VCOMEN_bits )
+
+//---------------------------------------------------------------------------
+// Graphics output state
+//   Host copy of the destination window size and of the output clip window,
+//   so that primitives outside them are dropped before any register traffic.
+//   owidth is 0 until a window is set through this file, only the clip is
+//   checked then. The engine registers of a filled rectangle are kept while
+//   rectnext is set, seMDC_FillRectangleNext() draws a whole rectangle
+//   otherwise.
+//---------------------------------------------------------------------------
+static struct {
+    uint16_t    owidth;
+    uint16_t    oheight;
+    uint16_t    clip[4];                // GFXOWLEFT, GFXOWRIGHT, GFXOWTOP, GFXOWBOT as written
+    uint8_t     pending;                // Operation triggered and not waited for
+    uint8_t     rectnext;               // Last operation was a filled rectangle
+    uint16_t    rectcolor;              // Pen color of the last filled seMDC_DrawRectangle()
+} GfxOut;
+
+
+//---------------------------------------------------------------------------
+// PRIVATE FUNCTION: PanelWriteRun()
+//   Write count consecutive 16-bit registers from addr in one transaction.
+//---------------------------------------------------------------------------
+static void PanelWriteRun( uint32_t addr, const uint16_t vals[], uint32_t count )
+{
+    uint8_t buf[2 * 13];
+    uint32_t i;
 
+    for ( i = 0; i < count; i++ ) {
+        buf[2 * i]     = (uint8_t)vals[i];
+        buf[2 * i + 1] = (uint8_t)(vals[i] >> 8);
+    }
+    seS1D13C00Write( addr, buf, 2 * count );
+}
 
 
-/**
-  * Initialize Panel Interface for LPM011M133B (218x218, 6-bit color, 1.1" round)
-  * Return value:  Status
-  */
-seStatus seMDC_InitPanel_LPM011M133B( uint32_t sysfreqhz, uint32_t framebuffaddr )
+//---------------------------------------------------------------------------
+// PRIVATE FUNCTION: GfxTrigger()
+//   Start the function set up in the engine registers.
+//---------------------------------------------------------------------------
+static void GfxTrigger( void )
 {
-    // Sequence power-on of voltage supplies
-    seS1D13C00Write16(MDC_BSTCLK, ((5 << 4) | (seMDC_OSC1 << 0)));
-  
-    seS1D13C00Write16( MDC_BSTPWR, 0x0007 ); // VMDBUP = normal, BSTON = on, REGECO = on, REGON = on
-  
-    seSysSleepMS(2);           // Wait stabilization time
-
-    //================== T1 ======================================================================
-    // Turn on VMDL
-    seS1D13C00Write16( MDC_BSTVMD, seMDC_VMDH_4V5 << 12 | seMDC_VMDL_3V2 << 4 | 0x0001); // VMDH = 4.5V, VMDL = 4.5V
-    seSysSleepMS(2);           // VMDL stabilization time = T1
-
-    //================== T2 ======================================================================
-    // Turn on VMDH
-    seS1D13C00Write16( MDC_BSTVMD, seMDC_VMDH_4V5 << 12 | seMDC_VMDL_3V2 << 4 | 0x0101); // VMDH = 4.5V, VMDL = 3.2V
-    seSysSleepMS(2);           // VMDH stabilization time = T2
-
-    //================== T3 ======================================================================
-    seSysSleepMS(1);           // Panel internal circuit reset time = T3 (>twXRST)
-
-    //================== T4 ======================================================================
-
-    // Initialize clocks and panel interface
-    seS1D13C00Write16(MDC_DISPWIDTH, 218);
-    seS1D13C00Write16(MDC_DISPHEIGHT, 218);
-    seS1D13C00Write16(MDC_DISPSTRIDE, 218);
-    seS1D13C00Write16(MDC_DISPVCOMDIV, 136);                            // VCOM freq = 32768 / (4*(136+1)) = ~60Hz
-
-    uint16_t clkdiv = ((uint16_t)(sysfreqhz / 2850000)) - 1;            // Divider value to get T = 0.35us (2.85MHz)
-    seS1D13C00Write16( MDC_DISPCLKDIV, 0x0100 | clkdiv );               // VCKHST = (1 + 1) * T = 0.7us
-
-    seS1D13C00Write16( MDC_DISPPRM21, 0x0075 );                         // VSTVCK = 0x75 = (117 + 1) * T = 41.3us
-                                                                        // HSTHCK = 0x00 = (0 + 1) * T = 0.35us
-
-    seS1D13C00Write16( MDC_DISPPRM43, 0x1900 );                         // HCKDLY = (0 + 1) * T = 0.35us
-                                                                        // t0 + t2 + (25) * 2T = 0.7 + 0.35 + 25*0.7 = 18.55us
-
-    seS1D13C00Write16( MDC_DISPPRM65, 0x3636 );                         // ENBW = 54 HCK counts = 54 * 0.7us = 37.8us
-                                                                        // XRSTVST = (54 + 1) * T = 19.25us;
-
-    seS1D13C00Write16( MDC_DISPPRM87, 0x0000 );                         // HCK to HST/data = (0 + 1) * T = 0.35us
-                                                                        // End of line to VCK = (0 + 1) * 2T = 0.7us
-
-    seS1D13C00Write16( MDC_DISPPRM109, 0x0101 );                        // HCK count for start of pixel data
-                                                                        // Extra HCK counts after end of line pixel data
-
-    seS1D13C00Write16( MDC_DISPPRM1211, 0x0002 );                       // VCK count for start of pixel data
-                                                                        // Extra VCK counts after last line of pixel data
-
-    seS1D13C00Write16( MDC_DISPPRM1413, 0x0003 );                       // Fast VCK high/low width = 3 * T = 1.05us
-  
-    seS1D13C00Write16( MDC_DISPFRMBUFF0, (uint16_t) (framebuffaddr & 0xFFFF));
-    seS1D13C00Write16( MDC_DISPFRMBUFF1, (uint16_t)((framebuffaddr >> 16) & 0xFFFF));
-
-    seS1D13C00Write16( MDC_DISPCTL, seMDC_DISP_PANELNOTGS << 11 |
-                                    seMDC_DISP_PIXNORMAL  <<  7 |
-                                    seMDC_DISP_UPD        <<  6 |
-                                    seMDC_DISP_PANEL6BIT  <<  4 |
-                                    seMDC_DISP_ROT0       <<  2 |
-                                    seMDC_VCOMEN_DISABLE  <<  1 );  // Initially VCOM should be disabled
-
-    seS1D13C00Write16( MDC_DISPCTL2, seMDC_DISP_CSPOLNORM << 4 |
-                                     seMDC_DISP_VSTFALL   << 3 |
-                                     seMDC_DISP_HSTRISE   << 2 |
-                                     seMDC_DISP_ENBLSB    << 1 |
-                                     seMDC_DISP_VCKFAST   << 0 );
-
-    // Send black screen to panel
-    seS1D13C00Write32(MDC_GFXOBADDR0, framebuffaddr);
-    seS1D13C00Write16(MDC_GFXOWIDTH, 218);
-    seS1D13C00Write16(MDC_GFXOHEIGHT, 218);
-    seS1D13C00Write16(MDC_GFXOSTRIDE, 218);
-    seMDC_DrawRectangle( 0, 0, 217, 217, 0x00C0, 0, 0, 1);  // filled rectangle with black pixel
-    seMDC_WaitGfxDone();
-
-    seS1D13C00Write16(MDC_DISPSTARTY, 0);
-    seS1D13C00Write16(MDC_DISPENDY, 217);
+    seS1D13C00Write8( MDC_TRIGCTL, 0x01 );                              // GFXTRIG = 1
+    GfxOut.pending = 1;
+    GfxOut.rectnext = 0;
+}
 
-    // Clear interrupt flag
-    seS1D13C00Write8(MDC_INTCTL, 0x02);  // UPDINT flag
 
-    // Trigger display update
-    seS1D13C00Write8(MDC_TRIGCTL, 0x02);  // UPDTRIG = 1
-    seMDC_WaitUpdDone();
+//---------------------------------------------------------------------------
+// PRIVATE FUNCTION: GfxReach()
+//   Farthest output distance, in X plus Y, of a source pixel from the center
+//   of transformation, for scales up to scale/256. Rotation and shear below 1
+//   do not take a pixel farther than its X plus Y distance.
+//---------------------------------------------------------------------------
+static int32_t GfxReach( uint16_t iwidth, uint16_t iheight, int32_t icenterx, int32_t icentery, uint32_t scale )
+{
+    int32_t dx = ( icenterx > iwidth - icenterx ) ? icenterx : iwidth - icenterx;
+    int32_t dy = ( icentery > iheight - icentery ) ? icentery : iheight - icentery;
+
+    return (int32_t)( ( (uint32_t)( dx + dy ) * scale ) >> 8 ) + 2;
+}
 
-    seS1D13C00Write16( MDC_DISPCTL, seMDC_DISP_PANELNOTGS << 11 |
-                                    seMDC_DISP_PIXNORMAL  <<  7 |
-                                    seMDC_DISP_UPD        <<  6 |
-                                    seMDC_DISP_PANEL6BIT  <<  4 |
-                                    seMDC_DISP_ROT0       <<  2 |
-                                    seMDC_VCOMEN_ENABLE   <<  1 );  // Enable VCOM
 
+//---------------------------------------------------------------------------
+// PRIVATE FUNCTION: PanelImage()
+//   Values of DISPWIDTH to DISPFRMBUFF1 for a panel.
+//---------------------------------------------------------------------------
+static seStatus PanelImage( const seMDC_PanelDesc *panel, uint32_t sysfreqhz, uint32_t framebuffaddr, uint16_t regs[13] )
+{
+    uint32_t clkdiv;
 
-    seSysSleepMS(17);           // Wait about 1 VCOM cycle which is ~16.7ms (60Hz).
+    if ( panel == NULL || panel->clkhz == 0 || panel->nprm < 3 || panel->nprm > 7 )
+        return seSTATUS_NG;
+    clkdiv = sysfreqhz / panel->clkhz;
+    if ( clkdiv == 0 || clkdiv > 0x100 )
+        return seSTATUS_NG;
 
+    regs[0] = panel->width;
+    regs[1] = panel->height;
+    regs[2] = panel->vcomdiv;
+    regs[3] = panel->tim0 | (uint16_t)( clkdiv - 1 );
+    regs[4] = panel->prm[0];
+    regs[5] = panel->prm[1];
+    regs[6] = panel->prm[2];
+    regs[7] = panel->prm[3];
+    regs[8] = 0;                                                        // DISPSTARTY
+    regs[9] = panel->height - 1;                                        // DISPENDY
+    regs[10] = panel->width;                                            // DISPSTRIDE
+    regs[11] = (uint16_t)( framebuffaddr & 0xFFFF );
+    regs[12] = (uint16_t)( ( framebuffaddr >> 16 ) & 0xFFFF );
     return seSTATUS_OK;
 }
 
 
-/**
-  * Initialize Panel Interface for LPM012M134B (240x240, 6-bit color, 1.2" round)
-  * Return value:  seStatus
-  */
-seStatus seMDC_InitPanel_LPM012M134B( uint32_t sysfreqhz, uint32_t framebuffaddr )
+//---------------------------------------------------------------------------
+// PRIVATE FUNCTION: PanelSignature()
+//   Resume signature of the panel in PanelInit: magic, frame buffer address,
+//   then the CRC of the panel set-up and its complement.
+//---------------------------------------------------------------------------
+static void PanelSignature( uint32_t sig[3] )
 {
-    // Sequence power-on of voltage supplies
-    seS1D13C00Write16(MDC_BSTCLK, ((5 << 4) | (seMDC_OSC1 << 0)));
-  
-    seS1D13C00Write16( MDC_BSTPWR, 0x0007 ); // VMDBUP = normal, BSTON = on, REGECO = on, REGON = on
-  
-    seSysSleepMS(2);           // Wait stabilization time
+    const seMDC_PanelDesc *panel = PanelInit.panel;
+    uint16_t crc;
+
+    crc = crc16_ccitt( (const unsigned char *)PanelInit.regs, sizeof(PanelInit.regs) );
+    crc = crc16_ccitt_update( crc, (const unsigned char *)panel->prm, sizeof(panel->prm) );
+    crc = crc16_ccitt_update( crc, (const unsigned char *)&panel->dispctl, sizeof(panel->dispctl) );
+    crc = crc16_ccitt_update( crc, (const unsigned char *)panel->bstvmd, sizeof(panel->bstvmd) );
+    sig[0] = PANEL_RESUME_MAGIC;
+    sig[1] = (uint32_t)PanelInit.regs[11] | (uint32_t)PanelInit.regs[12] << 16;
+    sig[2] = crc | (uint32_t)(uint16_t)~crc << 16;
+}
 
-    //================== T1 ======================================================================
-    // Turn on VMDL
-    seS1D13C00Write16( MDC_BSTVMD, seMDC_VMDH_4V5 << 12 | seMDC_VMDL_3V2 << 4 | 0x0001); // VMDH = 4.5V, VMDL = 4.5V
-          seSysSleepMS(2);           // VMDL stabilization time = T1
 
-    //================== T2 ======================================================================
-    // Turn on VMDH
-    seS1D13C00Write16( MDC_BSTVMD, seMDC_VMDH_4V5 << 12 | seMDC_VMDL_3V2 << 4 | 0x0101); // VMDH = 4.5V, VMDL = 3.2V
-    seSysSleepMS(2);           // VMDH stabilization time = T2
+//---------------------------------------------------------------------------
+// PRIVATE FUNCTION: PanelSign()
+//   Write (valid != 0) or invalidate the resume signature at seMDC_RESUME_ADDR.
+//---------------------------------------------------------------------------
+static void PanelSign( int valid )
+{
+    uint32_t sig[3] = { 0, 0, 0 };
 
-    //================== T3 ======================================================================
-    seSysSleepMS(1);           // Panel internal circuit reset time = T3 (>twXRST)
+    if ( valid )
+        PanelSignature( sig );
+    seS1D13C00Write( seMDC_RESUME_ADDR, (uint8_t *)sig, sizeof(sig) );
+}
 
-    //================== T4 ======================================================================
 
-    // Initialize clocks and panel interface
-    seS1D13C00Write16(MDC_DISPWIDTH, 240);
-    seS1D13C00Write16(MDC_DISPHEIGHT, 240);
-    seS1D13C00Write16(MDC_DISPSTRIDE, 240);
-    seS1D13C00Write16(MDC_DISPVCOMDIV, 136);                            // VCOM freq = 32768 / (4*(136+1)) = ~60Hz
+//---------------------------------------------------------------------------
+// PRIVATE FUNCTION: PanelStepDue()
+//   True if the wait after the last step has passed. Always false without a
+//   time base, the step then needs PanelStepWait().
+//---------------------------------------------------------------------------
+static int PanelStepDue( void )
+{
+    uint64_t now = seS1D13C00NowNS();
 
-    uint16_t clkdiv = ((uint16_t)(sysfreqhz / 2850000)) - 1;            // Divider value to get T = 0.35us (2.85MHz)
-    seS1D13C00Write16( MDC_DISPCLKDIV, 0x0100 | clkdiv );               // VCKHST = (1 + 1) * T = 0.7us
+    return ( now != 0 ) && ( now - PanelInit.stepns >= (uint64_t)PanelInit.stepms * 1000000 );
+}
 
-    seS1D13C00Write16( MDC_DISPPRM21, 0x0075 );                         // VSTVCK = 0x75 = (117 + 1) * T = 41.3us
-                                                                        // HSTHCK = 0x00 = (0 + 1) * T = 0.35us
 
-    seS1D13C00Write16( MDC_DISPPRM43, 0x1D00 );                         // HCKDLY = (0 + 1) * T = 0.35us
-                                                                        // t0 + t2 + (29) * 2T = 0.7 + 0.35 + 29*0.7 = 21.35us
+//---------------------------------------------------------------------------
+// PRIVATE FUNCTION: PanelStepWait()
+//   Sleep for what is left of the wait after the last step.
+//---------------------------------------------------------------------------
+static void PanelStepWait( void )
+{
+    uint64_t now = seS1D13C00NowNS();
+    uint64_t waitns = (uint64_t)PanelInit.stepms * 1000000;
+    uint64_t t0 = now;
 
-    seS1D13C00Write16( MDC_DISPPRM65, 0x363C );                         // ENBW = 60 HCK counts = 54 * 0.7us = 42us
-                                                                        // XRSTVST = (54 + 1) * T = 19.25us;
+    if ( now != 0 ) {
+        waitns = ( now - PanelInit.stepns >= waitns ) ? 0 : waitns - ( now - PanelInit.stepns );
+    }
+    if ( waitns != 0 ) {
+        seSysSleepMS( (uint32_t)( ( waitns + 999999 ) / 1000000 ) );
+        PanelInit.waitns += ( now != 0 ) ? seS1D13C00NowNS() - t0 : waitns;
+    }
+}
 
-    seS1D13C00Write16( MDC_DISPPRM87, 0x0000 );                         // HCK to HST/data = (0 + 1) * T = 0.35us
-                                                                        // End of line to VCK = (0 + 1) * 2T = 0.7us
 
-    seS1D13C00Write16( MDC_DISPPRM109, 0x0101 );                        // HCK count for start of pixel data
-                                                                        // Extra HCK counts after end of line pixel data
+//---------------------------------------------------------------------------
+// PRIVATE FUNCTION: PanelStep()
+//   Take the next step of the supply sequence and start its wait.
+//---------------------------------------------------------------------------
+static void PanelStep( void )
+{
+    const seMDC_PanelDesc *panel = PanelInit.panel;
 
-    seS1D13C00Write16( MDC_DISPPRM1211, 0x0002 );                       // VCK count for start of pixel data
-                                                                        // Extra VCK counts after last line of pixel data
+    switch ( PanelInit.state ) {
+    case PANEL_PWR:
+        seS1D13C00Write16( MDC_BSTVMD, panel->bstvmd[0] );
+        PanelInit.stepms = panel->vmdms[0];
+        PanelInit.state = PANEL_VMDL;
+        break;
+    case PANEL_VMDL:
+        if ( panel->bstvmd[1] != 0 ) {
+            seS1D13C00Write16( MDC_BSTVMD, panel->bstvmd[1] );
+            PanelInit.stepms = panel->vmdms[1];
+            PanelInit.state = PANEL_VMDH;
+            break;
+        }
+        PanelInit.stepms = 0;
+        PanelInit.state = PANEL_SUPPLY;
+        break;
+    case PANEL_VMDH:
+        PanelInit.stepms = 0;
+        PanelInit.state = PANEL_SUPPLY;
+        break;
+    default:
+        return;
+    }
+    PanelInit.stepns = seS1D13C00NowNS();
+}
 
-    seS1D13C00Write16( MDC_DISPPRM1413, 0x0003 );                       // Fast VCK high/low width = 3 * T = 1.05us
-  
-    seS1D13C00Write16( MDC_DISPFRMBUFF0, (uint16_t) (framebuffaddr & 0xFFFF));
-    seS1D13C00Write16( MDC_DISPFRMBUFF1, (uint16_t)((framebuffaddr >> 16) & 0xFFFF));
 
-    seS1D13C00Write16( MDC_DISPCTL, seMDC_DISP_PANELNOTGS << 11 |
-                                    seMDC_DISP_PIXNORMAL  <<  7 |
-                                    seMDC_DISP_UPD        <<  6 |
-                                    seMDC_DISP_PANEL6BIT  <<  4 |
-                                    seMDC_DISP_ROT0       <<  2 |
-                                    seMDC_VCOMEN_DISABLE  <<  1 );  // Initially VCOM should be disabled
+//---------------------------------------------------------------------------
+// PRIVATE FUNCTION: PanelEnable()
+//   Last part of the sequence, after the first update: DISP_EN, then VCOM.
+//   Without a time base the VCOM settling time is slept here, otherwise it
+//   is waited for before the next update is triggered.
+//---------------------------------------------------------------------------
+static void PanelEnable( void )
+{
+    const seMDC_PanelDesc *panel = PanelInit.panel;
 
+    if ( panel->flags & seMDC_PANEL_DISPEN ) {
+        seS1D13C00DispEnable();                                         // DISP_EN = 1
+        PanelInit.stepms = panel->dispenms;
+        PanelInit.stepns = seS1D13C00NowNS();
+        PanelStepWait();
+    }
+    seS1D13C00Write16( MDC_DISPCTL, panel->dispctl | seMDC_VCOMEN_ENABLE << 1 );
+
+    PanelInit.readyns = seS1D13C00NowNS();
+    if ( PanelInit.readyns == 0 ) {
+        seSysSleepMS( panel->vcomms );
+        PanelInit.state = PANEL_READY;
+    } else {
+        PanelInit.readyns += (uint64_t)panel->vcomms * 1000000;
+        PanelInit.state = PANEL_SETTLE;
+    }
+    PanelSign( 1 );
+}
 
-    seS1D13C00Write16( MDC_DISPCTL2, seMDC_DISP_CSPOLNORM << 4 |
-                                     seMDC_DISP_VSTFALL   << 3 |
-                                     seMDC_DISP_HSTRISE   << 2 |
-                                     seMDC_DISP_ENBLSB    << 1 |
-                                     seMDC_DISP_VCKFAST   << 0 );
 
-    // Send black screen to panel
-    seS1D13C00Write32(MDC_GFXOBADDR0, framebuffaddr);
-    seS1D13C00Write16(MDC_GFXOWIDTH, 240);
-    seS1D13C00Write16(MDC_GFXOHEIGHT, 240);
-    seS1D13C00Write16(MDC_GFXOSTRIDE, 240);
-    seMDC_DrawRectangle( 0, 0, 239, 239, 0x00C0, 0, 0, 1);  // filled rectangle with black pixel
-    seMDC_WaitGfxDone();
+//---------------------------------------------------------------------------
+// PRIVATE FUNCTION: UpdWait()
+//   Wait for the running update by the MDC interrupt status, then clear it.
+//---------------------------------------------------------------------------
+static void UpdWait( void )
+{
+    seS1D13C00Write8(MDC_INTCTL+1, 0x02);  // Enable interrupt
+    seTRACE_POLL_WHILE( (seS1D13C00Read16(SYS_INTS) & SYS_MDCINT_bits) == 0 );   // Poll wait until interrupt occurs
+    seS1D13C00Write8(MDC_INTCTL, 0x02);    // Clear interrupt
+}
 
-    seS1D13C00Write16(MDC_DISPSTARTY, 0);
-    seS1D13C00Write16(MDC_DISPENDY, 239);
 
-    // Clear interrupt flag
-    seS1D13C00Write8(MDC_INTCTL, 0x02);  // UPDINT flag
+//---------------------------------------------------------------------------
+// PRIVATE FUNCTION: UpdDueNS()
+//   Time the pending range can be triggered: booster stabilized and VCOM
+//   settled. 0 without a time base.
+//---------------------------------------------------------------------------
+static uint64_t UpdDueNS( void )
+{
+    uint64_t due = PanelUpd.boostns + UPD_BOOST_NS;
 
-    // Trigger display update
-    seS1D13C00Write8(MDC_TRIGCTL, 0x02);  // UPDTRIG = 1
-    seMDC_WaitUpdDone();
+    if ( PanelInit.state == PANEL_SETTLE && PanelInit.readyns > due )
+        due = PanelInit.readyns;
+    return ( seS1D13C00NowNS() != 0 ) ? due : 0;
+}
 
-    seS1D13C00Write16( MDC_DISPCTL, seMDC_DISP_PANELNOTGS << 11 |
-                                    seMDC_DISP_PIXNORMAL  <<  7 |
-                                    seMDC_DISP_UPD        <<  6 |
-                                    seMDC_DISP_PANEL6BIT  <<  4 |
-                                    seMDC_DISP_ROT0       <<  2 |
-                                    seMDC_VCOMEN_ENABLE   <<  1 );  // Enable VCOM
 
-    seSysSleepMS(17);           // Wait about 1 VCOM cycle which is ~16.7ms (60Hz).
+//---------------------------------------------------------------------------
+// PRIVATE FUNCTION: UpdSleepDue()
+//   Sleep until the pending range can be triggered. Without a time base the
+//   waits have been slept already.
+//---------------------------------------------------------------------------
+static void UpdSleepDue( void )
+{
+    uint64_t now = seS1D13C00NowNS();
+    uint64_t due = UpdDueNS();
 
-    return seSTATUS_OK;
+    if ( now != 0 && now < due )
+        seSysSleepMS( (uint32_t)( ( due - now + 999999 ) / 1000000 ) );
 }
 
 
-/**
-  * Initialize Panel Interface for LS010B7DH01 (128x128, SPI, 1-bit BW, 1.0" round)
-  * Return value:  seStatus
-  */
-seStatus seMDC_InitPanel_LS010B7DH01( uint32_t sysfreqhz, uint32_t framebuffaddr )
+//---------------------------------------------------------------------------
+// PRIVATE FUNCTION: UpdTrigger()
+//   Start the update of the pending range.
+//---------------------------------------------------------------------------
+static void UpdTrigger( void )
 {
-    seS1D13C00InitDispEn();   // Initialize DISP_EN control pin
- 
-    // Sequence power-on of voltage supplies
-    seS1D13C00Write16(MDC_BSTCLK, ((5 << 4) | (seMDC_OSC1 << 0)));
-  
-    seS1D13C00Write16( MDC_BSTPWR, 0x0007 ); // VMDBUP = normal, BSTON = on, REGECO = on, REGON = on
-  
-    seSysSleepMS(2);           // Wait stabilization time
-
-    //================== T1 ======================================================================
-    // Turn on VMDL and VMDH
-    seS1D13C00Write16( MDC_BSTVMD, seMDC_VMDH_5V0 << 12 | seMDC_VMDL_3V0 << 4 | 0x0101); // VMDH = 5.0V, VMDL = 3.0V
-    seSysSleepMS(2);           // VMDL stabilization time = T1
-
-    //================== T2 ======================================================================
-    // Initialize clocks and panel interface
-    seS1D13C00Write16(MDC_DISPWIDTH, 128);
-    seS1D13C00Write16(MDC_DISPHEIGHT, 128);
-    seS1D13C00Write16(MDC_DISPSTRIDE, 128);
-    seS1D13C00Write16( MDC_DISPVCOMDIV, 16383 );                        // EXTCOM freq = 32768 / (4*(16383+1)) = ~0.5Hz typical
-
-    uint16_t clkdiv = ((uint16_t)(sysfreqhz / 1500000)) - 1;            // SCLK is 1.5MHz
-    seS1D13C00Write16( MDC_DISPCLKDIV, 0x0400 | clkdiv );               // tsSCS = (4 + 1) * T = 3.33us
-
-    seS1D13C00Write16( MDC_DISPPRM21, 0x0F01 );                         // thSCS = (1 + 1) * T = 1.33us
-                                                                        // Data transfer period = (15 + 1) = 16 SCLK cycles
-
-    seS1D13C00Write16( MDC_DISPPRM43, 0x0701 );                         // Mode bits value for display update
-                                                                        // Number of Mode bits to send = (7+1) = 8
-
-    seS1D13C00Write16( MDC_DISPPRM65, 0x0107 );                         // twSCSL = (1 + 1) * T = 1.33us;
-                                                                        // Number of address bits to send = (7+1) = 8
-
-    seS1D13C00Write16( MDC_DISPFRMBUFF0, (uint16_t) (framebuffaddr & 0xFFFF));
-    seS1D13C00Write16( MDC_DISPFRMBUFF1, (uint16_t)((framebuffaddr >> 16) & 0xFFFF));
-
-    seS1D13C00Write16( MDC_DISPCTL, seMDC_DISP_PANELNOTGS   << 11 |
-                                    seMDC_DISP_SPILSBFIRST  <<  9 |
-                                    seMDC_DISP_AUTOCOMOFF   <<  8 |
-                                    seMDC_DISP_PIXNORMAL    <<  7 |
-                                    seMDC_DISP_UPD          <<  6 |
-                                    seMDC_DISP_SPI1BIT      <<  5 |
-                                    seMDC_DISP_PANELSPI     <<  4 |
-                                    seMDC_DISP_ROT0         <<  2 |
-                                    seMDC_VCOMEN_DISABLE    <<  1 );  // Initially VCOM should be disabled
-
-    seS1D13C00Write16( MDC_DISPCTL2, seMDC_DISP_GSALPHAON << 5);
-
-    // Send black screen to panel
-    seS1D13C00Write32(MDC_GFXOBADDR0, framebuffaddr);
-    seS1D13C00Write16(MDC_GFXOWIDTH, 128);
-    seS1D13C00Write16(MDC_GFXOHEIGHT, 128);
-    seS1D13C00Write16(MDC_GFXOSTRIDE, 128);
-    seMDC_DrawRectangle( 0, 0, 127, 127, 0x0002, 0, 0, 1);  // filled rectangle with black pixel
-    seMDC_WaitGfxDone();
-
-    seS1D13C00Write16(MDC_DISPSTARTY, 0);
-    seS1D13C00Write16(MDC_DISPENDY, 127);
-
-    // Clear interrupt flag
-    seS1D13C00Write8(MDC_INTCTL, 0x02);  // UPDINT flag
+    uint16_t range[2];
+
+    if ( PanelInit.state == PANEL_SETTLE )
+        PanelInit.state = PANEL_READY;                                  // Trigger is due, VCOM has settled
+
+    range[0] = PanelUpd.starty;
+    range[1] = PanelUpd.endy;
+    PanelWriteRun( MDC_DISPSTARTY, range, 2 );
+    seS1D13C00Write8( MDC_INTCTL, 0x02 );                               // Clear UPDINT flag
+    seS1D13C00Write8( MDC_TRIGCTL, 0x02 );                              // UPDTRIG = 1
+    PanelUpd.pending = 0;
+    PanelUpd.state = UPD_BUSY;
+}
 
-    // Trigger display update
-    seS1D13C00Write8(MDC_TRIGCTL, 0x02);  // UPDTRIG = 1
-    seMDC_WaitUpdDone();
-
-    //================== T3 ======================================================================
-    seS1D13C00DispEnable();    // Enable display (DISP_EN = 1)
-    seSysSleepMS(1);           // Wait at least 30us
-
-    //================== T4 ======================================================================
-    seS1D13C00Write16( MDC_DISPCTL, seMDC_DISP_PANELNOTGS   << 11 |
-                                    seMDC_DISP_SPILSBFIRST  <<  9 |
-                                    seMDC_DISP_AUTOCOMOFF   <<  8 |
-                                    seMDC_DISP_PIXNORMAL    <<  7 |
-                                    seMDC_DISP_UPD          <<  6 |
-                                    seMDC_DISP_SPI1BIT      <<  5 |
-                                    seMDC_DISP_PANELSPI     <<  4 |
-                                    seMDC_DISP_ROT0         <<  2 |
-                                    seMDC_VCOMEN_ENABLE     <<  1 );  // Enable VCOM
-
-    seSysSleepMS(1);           // Wait at least 30us
 
-    return seSTATUS_OK;
+//---------------------------------------------------------------------------
+// PRIVATE FUNCTION: UpdDone()
+//   The running update is done: queue the pending range, or end the burst
+//   and put the booster back into ECO mode.
+//---------------------------------------------------------------------------
+static void UpdDone( void )
+{
+    if ( PanelInit.ttff ) {
+        PanelInit.ttff = 0;
+        if ( PanelInit.startns != 0 )
+            PanelInit.ttff_us = (uint32_t)( ( seS1D13C00NowNS() - PanelInit.startns ) / 1000 );
+    }
+    if ( PanelInit.state == PANEL_FIRST )
+        PanelEnable();                                                  // First frame after seMDC_INIT_NOBLANK is in the panel
+
+    if ( PanelUpd.pending ) {
+        PanelUpd.state = UPD_DUE;
+    } else {
+        // Slower response for voltage booster, enter ECO mode
+        seS1D13C00Write16( MDC_BSTPWR, (uint16_t)( ( PanelUpd.bstpwr & ~MDC_VMDBUP_bits ) | MDC_REGECO_bits ) );
+        PanelUpd.boost = 0;
+        PanelUpd.state = UPD_IDLE;
+    }
 }
 
+
 /**
-  * Initialize Panel Interface for LS012B7DD06 (240x240, 6-bit color, 1.2" round)
-  * Return value:  seStatus
+  * Start the initialization of a panel from its descriptor
+  * Return value:  Status
   */
-seStatus seMDC_InitPanel_LS012B7DD06( uint32_t sysfreqhz, uint32_t framebuffaddr )
+seStatus seMDC_PanelInitStart( const seMDC_PanelDesc *panel, uint32_t sysfreqhz, uint32_t framebuffaddr, uint32_t options )
 {
-    // Sequence power-on of voltage supplies
-    seS1D13C00Write16(MDC_BSTCLK, ((5 << 4) | (seMDC_OSC1 << 0)));
-  
-    seS1D13C00Write16( MDC_BSTPWR, 0x0007 ); // VMDBUP = normal, BSTON = on, REGECO = on, REGON = on
-  
-    seSysSleepMS(2);           // Wait stabilization time
-
-    //================== T1 ======================================================================
-    // Turn on VMDL
-    seS1D13C00Write16( MDC_BSTVMD, seMDC_VMDH_5V0 << 12 | seMDC_VMDL_3V2 << 4 | 0x0001); // VMDH = 5.0V, VMDL = 4.5V
-          seSysSleepMS(2);           // VMDL stabilization time = T1
-
-    //================== T2 ======================================================================
-    // Turn on VMDH
-    seS1D13C00Write16( MDC_BSTVMD, seMDC_VMDH_5V0 << 12 | seMDC_VMDL_3V2 << 4 | 0x0101); // VMDH = 5.0V, VMDL = 3.2V
-    seSysSleepMS(2);           // VMDH stabilization time = T2
-
-    //================== T3 ======================================================================
-    seSysSleepMS(1);           // Panel internal circuit reset time = T3 (>twXRST)
-
-    //================== T4 ======================================================================
+    uint16_t *regs = PanelInit.regs;
 
-    // Initialize clocks and panel interface
-    seS1D13C00Write16(MDC_DISPWIDTH, 240);
-    seS1D13C00Write16(MDC_DISPHEIGHT, 240);
-    seS1D13C00Write16(MDC_DISPSTRIDE, 240);
-    seS1D13C00Write16(MDC_DISPVCOMDIV, 272);                            // VCOM freq = 32768 / (4*(272+1)) = ~30Hz
-
-    uint16_t clkdiv = ((uint16_t)(sysfreqhz / 5000000)) - 1;            // Divider value to get T = 0.2us (5MHz)
-    seS1D13C00Write16( MDC_DISPCLKDIV, 0x0000 | clkdiv );               // VCKHST = (0 + 1) * T = 0.2us
-
-    seS1D13C00Write16( MDC_DISPPRM21, 0x0036 );                         // VSTVCK = 0x36 = (54 + 1) * T = 11us
-                                                                        // HSTHCK = 0x00 = (0 + 1) * T = 0.2us
-
-    seS1D13C00Write16( MDC_DISPPRM43, 0x7A00 );                         // HCKDLY = (0 + 1) * T = 0.2us
-                                                                        // t0 + t2 + (122) * 2T = 0.7 + 0.2 + 122*0.4 = 49.2us
-
-    seS1D13C00Write16( MDC_DISPPRM65, 0x3118 );                         // ENBW = 24 HCK counts = 24 * 0.4us = 9.6us
-                                                                        // XRSTVST = (49 + 1) * T = 10us;
-
-    seS1D13C00Write16( MDC_DISPPRM87, 0x2100 );                         // HCK to HST/data = (0 + 1) * T = 0.2us
-                                                                        // End of line to VCK = (33 + 1) * 2T = 13.6us
-
-    seS1D13C00Write16( MDC_DISPPRM109, 0x0202 );                        // HCK count for start of pixel data
-                                                                        // Extra HCK counts after end of line pixel data
-
-    seS1D13C00Write16( MDC_DISPPRM1211, 0x0202 );                       // VCK count for start of pixel data
-                                                                        // Extra VCK counts after last line of pixel data
-
-    seS1D13C00Write16( MDC_DISPPRM1413, 0x0003 );                       // Fast VCK high/low width = 3 * T = 0.6us
-  
-    seS1D13C00Write16( MDC_DISPFRMBUFF0, (uint16_t) (framebuffaddr & 0xFFFF));
-    seS1D13C00Write16( MDC_DISPFRMBUFF1, (uint16_t)((framebuffaddr >> 16) & 0xFFFF));
-
-    seS1D13C00Write16( MDC_DISPCTL, seMDC_DISP_PANELNOTGS << 11 |
-                                    seMDC_DISP_PIXNORMAL  <<  7 |
-                                    seMDC_DISP_UPD        <<  6 |
-                                    seMDC_DISP_PANEL6BIT  <<  4 |
-                                    seMDC_DISP_ROT0       <<  2 |
-                                    seMDC_VCOMEN_DISABLE  <<  1 );  // Initially VCOM should be disabled
-
-
-    seS1D13C00Write16( MDC_DISPCTL2, seMDC_DISP_CSPOLNORM << 4 |
-                                     seMDC_DISP_VSTFALL   << 3 |
-                                     seMDC_DISP_HSTFALL   << 2 |
-                                     seMDC_DISP_ENBMSB    << 1 |
-                                     seMDC_DISP_VCKNORM   << 0 );
-
-    // Send black screen to panel
-    seS1D13C00Write32(MDC_GFXOBADDR0, framebuffaddr);
-    seS1D13C00Write16(MDC_GFXOWIDTH, 240);
-    seS1D13C00Write16(MDC_GFXOHEIGHT, 240);
-    seS1D13C00Write16(MDC_GFXOSTRIDE, 240);
-    seMDC_DrawRectangle( 0, 0, 239, 239, 0x00C0, 0, 0, 1);  // filled rectangle with black pixel
-    seMDC_WaitGfxDone();
-
-    seS1D13C00Write16(MDC_DISPSTARTY, 0);
-    seS1D13C00Write16(MDC_DISPENDY, 239);
-
-    // Clear interrupt flag
-    seS1D13C00Write8(MDC_INTCTL, 0x02);  // UPDINT flag
-
-    // Trigger display update
-    seS1D13C00Write8(MDC_TRIGCTL, 0x02);  // UPDTRIG = 1
-    seMDC_WaitUpdDone();
+    seTRACE_API();
+    if ( PanelImage( panel, sysfreqhz, framebuffaddr, regs ) != seSTATUS_OK )
+        return seSTATUS_NG;
 
-    seS1D13C00Write16( MDC_DISPCTL, seMDC_DISP_PANELNOTGS << 11 |
-                                    seMDC_DISP_PIXNORMAL  <<  7 |
-                                    seMDC_DISP_UPD        <<  6 |
-                                    seMDC_DISP_PANEL6BIT  <<  4 |
-                                    seMDC_DISP_ROT0       <<  2 |
-                                    seMDC_VCOMEN_ENABLE   <<  1 );  // Enable VCOM
+    PanelInit.panel = panel;
+    PanelInit.options = options;
+    PanelInit.startns = seS1D13C00NowNS();
+    PanelInit.waitns = 0;
+    PanelInit.needms = panel->pwrms + panel->vmdms[0] + ( panel->bstvmd[1] != 0 ? panel->vmdms[1] : 0 );
+    PanelInit.init_us = 0;
+    PanelInit.ttff_us = 0;
+    PanelInit.ttff = 0;
+    memset( &PanelUpd, 0, sizeof(PanelUpd) );
+
+    PanelSign( 0 );                                                     // Not resumable until enabled
+
+    if ( panel->flags & seMDC_PANEL_DISPEN )
+        seS1D13C00InitDispEn();                                         // Initialize DISP_EN control pin
+
+    // Sequence power-on of voltage supplies, the steps after BSTPWR are timed by PanelStep()
+    seS1D13C00Write16( MDC_BSTCLK, ((5 << 4) | (seMDC_OSC1 << 0)) );
+    seS1D13C00Write16( MDC_BSTPWR, 0x0007 );                            // VMDBUP = normal, BSTON = on, REGECO = on, REGON = on
+    PanelInit.stepms = panel->pwrms;
+    PanelInit.stepns = seS1D13C00NowNS();
+    PanelInit.state = PANEL_PWR;
+
+    // Panel interface registers, DISPWIDTH to DISPFRMBUFF1 without DISPPRM87 for SPI panels.
+    // DISPCTL is written once the supplies are up.
+    if ( panel->nprm > 3 ) {
+        PanelWriteRun( MDC_DISPWIDTH, regs, 13 );
+        PanelWriteRun( MDC_DISPPRM109, &panel->prm[4], panel->nprm - 4 );
+    } else {
+        PanelWriteRun( MDC_DISPWIDTH, regs, 4 + panel->nprm );
+        PanelWriteRun( MDC_DISPSTARTY, &regs[8], 5 );
+    }
 
-    seSysSleepMS(17);           // Wait about 1 VCOM cycle which is ~16.7ms (60Hz).
+    // Black fill, runs on the graphics engine while the supplies come up
+    if ( !( options & seMDC_INIT_NOBLANK ) ) {
+        seS1D13C00Write32( MDC_GFXOBADDR0, framebuffaddr );
+        seS1D13C00Write16( MDC_GFXOWIDTH, panel->width );
+        seS1D13C00Write16( MDC_GFXOHEIGHT, panel->height );
+        seS1D13C00Write16( MDC_GFXOSTRIDE, panel->width );
+        GfxOut.owidth = panel->width;
+        GfxOut.oheight = panel->height;
+        seMDC_DrawRectangle( 0, 0, panel->width - 1, panel->height - 1, panel->black, 0, 0, 1 );
+    }
 
+    seMDC_PanelInitPoll();
     return seSTATUS_OK;
 }
 
 
 /**
-  * Initialize Panel Interface for LSxxxxxxxxx (260x260, 6-bit color, 1.2" round)
-  * Return value:  seStatus
+  * Take the supply sequence steps that are due
+  * Return value:  seSTATUS_OK once the supplies are up
   */
-seStatus seMDC_InitPanel_6BIT260X260( uint32_t sysfreqhz, uint32_t framebuffaddr )
+seStatus seMDC_PanelInitPoll( void )
 {
-    // Sequence power-on of voltage supplies
-    seS1D13C00Write16(MDC_BSTCLK, ((5 << 4) | (seMDC_OSC1 << 0)));
-  
-    seS1D13C00Write16( MDC_BSTPWR, 0x0007 ); // VMDBUP = normal, BSTON = on, REGECO = on, REGON = on
-  
-    seSysSleepMS(2);           // Wait stabilization time
-
-    //================== T1 ======================================================================
-    // Turn on VMDL
-    seS1D13C00Write16( MDC_BSTVMD, seMDC_VMDH_5V0 << 12 | seMDC_VMDL_3V2 << 4 | 0x0001); // VMDH = 5.0V, VMDL = 4.5V
-          seSysSleepMS(2);           // VMDL stabilization time = T1
-
-    //================== T2 ======================================================================
-    // Turn on VMDH
-    seS1D13C00Write16( MDC_BSTVMD, seMDC_VMDH_5V0 << 12 | seMDC_VMDL_3V2 << 4 | 0x0101); // VMDH = 5.0V, VMDL = 3.2V
-    seSysSleepMS(2);           // VMDH stabilization time = T2
-
-    //================== T3 ======================================================================
-    seSysSleepMS(1);           // Panel internal circuit reset time = T3 (>twXRST)
-
-    //================== T4 ======================================================================
-
-    // Initialize clocks and panel interface
-    seS1D13C00Write16(MDC_DISPWIDTH, 260);
-    seS1D13C00Write16(MDC_DISPHEIGHT, 260);
-    seS1D13C00Write16(MDC_DISPSTRIDE, 260);
-    seS1D13C00Write16(MDC_DISPVCOMDIV, 272);                            // VCOM freq = 32768 / (4*(272+1)) = ~30Hz
-
-    uint16_t clkdiv = ((uint16_t)(sysfreqhz / 5000000)) - 1;            // Divider value to get T = 0.2us (5MHz)
-    seS1D13C00Write16( MDC_DISPCLKDIV, 0x0000 | clkdiv );               // VCKHST = (0 + 1) * T = 0.2us
-
-    seS1D13C00Write16( MDC_DISPPRM21, 0x0036 );                         // VSTVCK = 0x36 = (54 + 1) * T = 11us
-                                                                        // HSTHCK = 0x00 = (0 + 1) * T = 0.2us
-
-    seS1D13C00Write16( MDC_DISPPRM43, 0x7A00 );                         // HCKDLY = (0 + 1) * T = 0.2us
-                                                                        // t0 + t2 + (122) * 2T = 0.7 + 0.2 + 122*0.4 = 49.2us
-
-    seS1D13C00Write16( MDC_DISPPRM65, 0x3118 );                         // ENBW = 24 HCK counts = 24 * 0.4us = 9.6us
-                                                                        // XRSTVST = (49 + 1) * T = 10us;
-
-    seS1D13C00Write16( MDC_DISPPRM87, 0x0000 );                         // HCK to HST/data = (0 + 1) * T = 0.2us
-                                                                        // End of line to VCK = (0) * 2T = 0.0us
-
-    seS1D13C00Write16( MDC_DISPPRM109, 0x0301 );                        // HCK count for start of pixel data = 1
-                                                                        // Extra HCK counts after end of line pixel data = 3
-
-    seS1D13C00Write16( MDC_DISPPRM1211, 0x0502 );                       // VCK count for start of pixel data = 2
-                                                                        // Extra VCK counts after last line of pixel data = 5
-
-    seS1D13C00Write16( MDC_DISPPRM1413, 0x0003 );                       // Fast VCK high/low width = 3 * T = 0.6us
-  
-    seS1D13C00Write16( MDC_DISPFRMBUFF0, (uint16_t) (framebuffaddr & 0xFFFF));
-    seS1D13C00Write16( MDC_DISPFRMBUFF1, (uint16_t)((framebuffaddr >> 16) & 0xFFFF));
-
-    seS1D13C00Write16( MDC_DISPCTL, seMDC_DISP_PANELNOTGS << 11 |
-                                    seMDC_DISP_PIXNORMAL  <<  7 |
-                                    seMDC_DISP_UPD        <<  6 |
-                                    seMDC_DISP_PANEL6BIT  <<  4 |
-                                    seMDC_DISP_ROT0       <<  2 |
-                                    seMDC_VCOMEN_DISABLE  <<  1 );  // Initially VCOM should be disabled
-
-    seS1D13C00Write16( MDC_DISPCTL2, seMDC_DISP_CSPOLNORM << 4 |
-                                     seMDC_DISP_VSTFALL   << 3 |
-                                     seMDC_DISP_HSTFALL   << 2 |
-                                     seMDC_DISP_ENBLSB    << 1 |
-                                     seMDC_DISP_VCKNORM   << 0 );
-
-    // Send black screen to panel
-    seS1D13C00Write32(MDC_GFXOBADDR0, framebuffaddr);
-    seS1D13C00Write16(MDC_GFXOWIDTH, 260);
-    seS1D13C00Write16(MDC_GFXOHEIGHT, 260);
-    seS1D13C00Write16(MDC_GFXOSTRIDE, 260);
-    seMDC_DrawRectangle( 0, 0, 259, 259, 0x00C0, 0, 0, 1);  // filled rectangle with black pixel
-    seMDC_WaitGfxDone();
-
-    seS1D13C00Write16(MDC_DISPSTARTY, 0);
-    seS1D13C00Write16(MDC_DISPENDY, 259);
-
-    // Clear interrupt flag
-    seS1D13C00Write8(MDC_INTCTL, 0x02);  // UPDINT flag
-
-    // Trigger display update
-    seS1D13C00Write8(MDC_TRIGCTL, 0x02);  // UPDTRIG = 1
-    seMDC_WaitUpdDone();
-
-    seS1D13C00Write16( MDC_DISPCTL, seMDC_DISP_PANELNOTGS << 11 |
-                                    seMDC_DISP_PIXNORMAL  <<  7 |
-                                    seMDC_DISP_UPD        <<  6 |
-                                    seMDC_DISP_PANEL6BIT  <<  4 |
-                                    seMDC_DISP_ROT0       <<  2 |
-                                    seMDC_VCOMEN_ENABLE   <<  1 );  // Enable VCOM
-
-    seSysSleepMS(17);           // Wait about 1 VCOM cycle which is ~16.7ms (60Hz).
-
-    return seSTATUS_OK;
+    while ( PanelInit.state >= PANEL_PWR && PanelInit.state <= PANEL_VMDH && PanelStepDue() )
+        PanelStep();
+    return ( PanelInit.state >= PANEL_SUPPLY ) ? seSTATUS_OK : seSTATUS_NG;
 }
 
 
 /**
-  * Initialize Panel Interface for LS013B4DN04 (96x96, SPI, 1-bit BW, 1.3" square)
+  * Complete the initialization started by seMDC_PanelInitStart()
   * Return value:  Status
   */
-seStatus seMDC_InitPanel_LS013B4DN04 ( uint32_t sysfreqhz, uint32_t framebuffaddr )
+seStatus seMDC_PanelInitFinish( void )
 {
-    seS1D13C00InitDispEn();   // Initialize DISP_EN control pin
-
-    // Sequence power-on of voltage supplies
-    seS1D13C00Write16(MDC_BSTCLK, ((5 << 4) | (seMDC_OSC1 << 0)));
-  
-    seS1D13C00Write16( MDC_BSTPWR, 0x0007 ); // VMDBUP = normal, BSTON = on, REGECO = on, REGON = on
-  
-    seSysSleepMS(2);           // Wait stabilization time
-
-    //================== T1 ======================================================================
-    // Turn on VMDL
-    seS1D13C00Write16( MDC_BSTVMD, seMDC_VMDL_3V0 << 4 | 0x0001 ); // VMDL = 3.0V
-    seSysSleepMS(2);           // VMDL stabilization time = T1
-
-    //================== T2 ======================================================================
-    // Initialize clocks and panel interface
-    seS1D13C00Write16(MDC_DISPWIDTH, 96);
-    seS1D13C00Write16(MDC_DISPHEIGHT, 96);
-    seS1D13C00Write16(MDC_DISPSTRIDE, 96);
-    seS1D13C00Write16( MDC_DISPVCOMDIV, 16383 );                        // EXTCOM freq = 32768 / (4*(16383+1)) = ~0.5Hz typical
-
-    uint16_t clkdiv = ((uint16_t)(sysfreqhz / 1500000)) - 1;            // SCLK is 1.5MHz
-    seS1D13C00Write16( MDC_DISPCLKDIV, 0x0800 | clkdiv );               // tsSCS = (8 + 1) * T = 6us
-
-    seS1D13C00Write16( MDC_DISPPRM21, 0x0F02 );                         // thSCS = (2 + 1) * T = 2us
-                                                                        // Data transfer period = (15 + 1) = 16 SCLK cycles
-
-    seS1D13C00Write16( MDC_DISPPRM43, 0x0701 );                         // Mode bits value for display update
-                                                                        // Number of Mode bits to send = (7+1) = 8
-
-    seS1D13C00Write16( MDC_DISPPRM65, 0x0207 );                         // twSCSL = (2 + 1) * T = 2us;
-                                                                        // Number of address bits to send = (7+1) = 8
-
-    seS1D13C00Write16( MDC_DISPFRMBUFF0, (uint16_t) (framebuffaddr & 0xFFFF));
-    seS1D13C00Write16( MDC_DISPFRMBUFF1, (uint16_t)((framebuffaddr >> 16) & 0xFFFF));
-
-    seS1D13C00Write16( MDC_DISPCTL, seMDC_DISP_PANELNOTGS   << 11 |
-                                    seMDC_DISP_SPILSBFIRST  <<  9 |
-                                    seMDC_DISP_AUTOCOMOFF   <<  8 |
-                                    seMDC_DISP_PIXNORMAL    <<  7 |
-                                    seMDC_DISP_UPD          <<  6 |
-                                    seMDC_DISP_SPI1BIT      <<  5 |
-                                    seMDC_DISP_PANELSPI     <<  4 |
-                                    seMDC_DISP_ROT0         <<  2 |
-                                    seMDC_VCOMEN_DISABLE    <<  1 );  // Initially VCOM should be disabled
-
-    seS1D13C00Write16( MDC_DISPCTL2, seMDC_DISP_GSALPHAON << 5);
-
-    // Send black screen to panel
-    seS1D13C00Write32(MDC_GFXOBADDR0, framebuffaddr);
-    seS1D13C00Write16(MDC_GFXOWIDTH, 96);
-    seS1D13C00Write16(MDC_GFXOHEIGHT, 96);
-    seS1D13C00Write16(MDC_GFXOSTRIDE, 96);
-    seMDC_DrawRectangle( 0, 0, 95, 95, 0x0002, 0, 0, 1);  // filled rectangle with black pixel
-    seMDC_WaitGfxDone();
-
-    seS1D13C00Write16(MDC_DISPSTARTY, 0);
-    seS1D13C00Write16(MDC_DISPENDY, 95);
+    const seMDC_PanelDesc *panel = PanelInit.panel;
 
-    // Clear interrupt flag
-    seS1D13C00Write8(MDC_INTCTL, 0x02);  // UPDINT flag
+    seTRACE_API();
+    if ( panel == NULL || PanelInit.state == PANEL_IDLE )
+        return seSTATUS_NG;
 
-    // Trigger display update
-    seS1D13C00Write8(MDC_TRIGCTL, 0x02);  // UPDTRIG = 1
-    seMDC_WaitUpdDone();
-
-    //================== T3 ======================================================================
-    seS1D13C00DispEnable();    // Enable display (DISP_EN = 1)
-    seSysSleepMS(1);           // Wait at least 30us
-
-    //================== T4 ======================================================================
-    seS1D13C00Write16( MDC_DISPCTL, seMDC_DISP_PANELNOTGS   << 11 |
-                                    seMDC_DISP_SPILSBFIRST  <<  9 |
-                                    seMDC_DISP_AUTOCOMOFF   <<  8 |
-                                    seMDC_DISP_PIXNORMAL    <<  7 |
-                                    seMDC_DISP_UPD          <<  6 |
-                                    seMDC_DISP_SPI1BIT      <<  5 |
-                                    seMDC_DISP_PANELSPI     <<  4 |
-                                    seMDC_DISP_ROT0         <<  2 |
-                                    seMDC_VCOMEN_ENABLE     << 1 );  // Enable VCOM
-
-    seSysSleepMS(1);           // Wait at least 30us
+    while ( PanelInit.state >= PANEL_PWR && PanelInit.state <= PANEL_VMDH ) {
+        PanelStepWait();
+        PanelStep();
+    }
+    if ( PanelInit.state != PANEL_SUPPLY )
+        return seSTATUS_OK;
+
+    seS1D13C00Write16( MDC_DISPCTL, panel->dispctl );                  // Initially VCOM should be disabled
+    if ( panel->flags & seMDC_PANEL_DISPCTL2 )
+        seS1D13C00Write16( MDC_DISPCTL2, panel->dispctl2 );
+
+    if ( PanelInit.options & seMDC_INIT_NOBLANK ) {
+        PanelInit.state = PANEL_FIRST;
+    } else {
+        // Send black screen to panel
+        seMDC_WaitGfxDone();
+        seS1D13C00Write8( MDC_INTCTL, 0x02 );                           // Clear UPDINT flag
+        seS1D13C00Write8( MDC_TRIGCTL, 0x02 );                          // UPDTRIG = 1
+        UpdWait();
+        PanelEnable();
+    }
 
+    if ( PanelInit.startns != 0 )
+        PanelInit.init_us = (uint32_t)( ( seS1D13C00NowNS() - PanelInit.startns ) / 1000 );
+    PanelInit.ttff = 1;
     return seSTATUS_OK;
 }
 
 
 /**
-  * Initialize Panel Interface for LS013B7DH06 (128x128, SPI, 3-bit color, 1.33" square)
+  * Initialize a panel from its descriptor
   * Return value:  Status
   */
-seStatus seMDC_InitPanel_LS013B7DH06 ( uint32_t sysfreqhz, uint32_t framebuffaddr )
+seStatus seMDC_InitPanelDesc( const seMDC_PanelDesc *panel, uint32_t sysfreqhz, uint32_t framebuffaddr, uint32_t options )
 {
-    seS1D13C00InitDispEn();   // Initialize DISP_EN control pin
-
-    // Sequence power-on of voltage supplies
-    seS1D13C00Write16(MDC_BSTCLK, ((5 << 4) | (seMDC_OSC1 << 0)));
+    if ( seMDC_PanelInitStart( panel, sysfreqhz, framebuffaddr, options ) != seSTATUS_OK )
+        return seSTATUS_NG;
+    return seMDC_PanelInitFinish();
+}
 
-    seS1D13C00Write16( MDC_BSTPWR, 0x0007 ); // VMDBUP = normal, BSTON = on, REGECO = on, REGON = on
 
-    seSysSleepMS(2);           // Wait stabilization time
+/**
+  * Take over a panel the controller still drives from before a host reset
+  * Return value:  Status
+  */
+seStatus seMDC_PanelResume( const seMDC_PanelDesc *panel, uint32_t sysfreqhz, uint32_t framebuffaddr )
+{
+    uint16_t regs[13];
+    uint16_t cur[14];
+    uint32_t sig[3];
+    uint32_t expect[3];
+    uint64_t t0 = seS1D13C00NowNS();
+    uint32_t i;
+
+    seTRACE_API();
+    if ( PanelImage( panel, sysfreqhz, framebuffaddr, regs ) != seSTATUS_OK )
+        return seSTATUS_NG;
 
-    //================== T1 ======================================================================
-    // Turn on VMDH
-    seS1D13C00Write16( MDC_BSTVMD, seMDC_VMDH_5V0 << 12 | seMDC_VMDL_3V0 << 4 | 0x0101); // VMDH = 5.0V, VMDL = 3.0V
-    seSysSleepMS(2);           // VMDH stabilization time = T1
+    // Signature left by PanelEnable(), gone with a power cycle or a new init
+    seS1D13C00Read( seMDC_RESUME_ADDR, (uint8_t *)sig, sizeof(sig) );
+    PanelInit.panel = panel;
+    memcpy( PanelInit.regs, regs, sizeof(regs) );
+    PanelSignature( expect );
+    if ( memcmp( sig, expect, sizeof(sig) ) != 0 ) {
+        PanelInit.state = PANEL_IDLE;
+        return seSTATUS_NG;
+    }
 
-    //================== T2 ======================================================================
-    // Initialize clocks and panel interface
-    seS1D13C00Write16(MDC_DISPWIDTH, 128);
-    seS1D13C00Write16(MDC_DISPHEIGHT, 128);
-    seS1D13C00Write16(MDC_DISPSTRIDE, 128);
-    seS1D13C00Write16( MDC_DISPVCOMDIV, 16383 );                        // EXTCOM freq = 32768 / (4*(16383+1)) = ~0.5Hz typical
+    // Key registers, a soft reset of the controller clears them
+    seS1D13C00Read( MDC_DISPCTL, (uint8_t *)cur, sizeof(cur) );
+    for ( i = 0; i < 13; i++ ) {
+        if ( i == 8 || i == 9 || ( i == 7 && panel->nprm < 4 ) )
+            continue;                                                   // DISPSTARTY/ENDY change with every update
+        if ( cur[1 + i] != regs[i] )
+            break;
+    }
+    if ( i < 13
+      || ( cur[0] & PANEL_DISPCTL_KEEP ) != ( ( panel->dispctl | seMDC_VCOMEN_ENABLE << 1 ) & PANEL_DISPCTL_KEEP )
+      || ( seS1D13C00Read16( MDC_BSTPWR ) & ( MDC_BSTON_bits | MDC_REGON_bits ) ) != ( MDC_BSTON_bits | MDC_REGON_bits )
+      || seS1D13C00Read16( MDC_BSTVMD ) != panel->bstvmd[panel->bstvmd[1] != 0 ? 1 : 0]
+      || ( seS1D13C00Read16( SYS_CTRL ) & ( SYS_IOSCEN_bits | SYS_IOSCSTA_bits ) ) != ( SYS_IOSCEN_bits | SYS_IOSCSTA_bits )
+      || ( seS1D13C00Read8( CLG_OSC ) & CLG_OSC1EN_bits ) == 0 ) {
+        PanelInit.state = PANEL_IDLE;
+        return seSTATUS_NG;
+    }
 
-    uint16_t clkdiv = ((uint16_t)(sysfreqhz / 1500000)) - 1;            // SCLK is 1.5MHz
-    seS1D13C00Write16( MDC_DISPCLKDIV, 0x0400 | clkdiv );               // tsSCS = (4 + 1) * T = 3.33us
+    seS1D13C00Write16( MDC_INTCTL, MDC_UPDIF_bits | MDC_GFXIF_bits );   // Disable and clear interrupts left from before
+
+    // Destination window size and clip window left from before
+    memset( &GfxOut, 0, sizeof(GfxOut) );
+    seS1D13C00Read( MDC_GFXOWIDTH, (uint8_t *)cur, 4 );
+    GfxOut.owidth = cur[0];
+    GfxOut.oheight = cur[1];
+    seS1D13C00Read( MDC_GFXOWLEFT, (uint8_t *)GfxOut.clip, sizeof(GfxOut.clip) );
+
+    PanelInit.options = 0;
+    PanelInit.state = PANEL_READY;
+    PanelInit.startns = t0;
+    PanelInit.waitns = 0;
+    PanelInit.needms = 0;
+    PanelInit.init_us = ( t0 != 0 ) ? (uint32_t)( ( seS1D13C00NowNS() - t0 ) / 1000 ) : 0;
+    PanelInit.ttff_us = 0;
+    PanelInit.ttff = 1;
+    memset( &PanelUpd, 0, sizeof(PanelUpd) );                           // Booster back in ECO mode at the end of the next burst
+    return seSTATUS_OK;
+}
 
-    seS1D13C00Write16( MDC_DISPPRM21, 0x0F01 );                         // thSCS = (1 + 1) * T = 1.33us
-                                                                        // Data transfer period = (15 + 1) = 16 SCLK cycles
 
-    seS1D13C00Write16( MDC_DISPPRM43, 0x0701 );                         // Mode bits value for display update
-                                                                        // Number of Mode bits to send = (7+1) = 8
+/**
+  * Report the timing of the last panel initialization
+  * Return value:  None
+  */
+void seMDC_GetPanelInitReport( seMDC_PanelInitReport *report )
+{
+    uint32_t wait_us = (uint32_t)( PanelInit.waitns / 1000 );
 
-    seS1D13C00Write16( MDC_DISPPRM65, 0x0107 );                         // Number of address bits to send = (7+1) = 8
-                                                                        // twSCSL = (1 + 1) * T = 1.33us;
+    report->panel = PanelInit.panel;
+    report->init_us = PanelInit.init_us;
+    report->ttff_us = PanelInit.ttff_us;
+    report->wait_us = wait_us;
+    report->overlap_us = ( PanelInit.needms * 1000 > wait_us ) ? PanelInit.needms * 1000 - wait_us : 0;
+}
 
-    seS1D13C00Write16( MDC_DISPFRMBUFF0, (uint16_t) (framebuffaddr & 0xFFFF));
-    seS1D13C00Write16( MDC_DISPFRMBUFF1, (uint16_t)((framebuffaddr >> 16) & 0xFFFF));
 
-    seS1D13C00Write16( MDC_DISPCTL, seMDC_DISP_PANELNOTGS   << 11 |
-                                    seMDC_DISP_SPIRGB       << 10 |
-                                    seMDC_DISP_SPILSBFIRST  <<  9 |
-                                    seMDC_DISP_AUTOCOMOFF   <<  8 |
-                                    seMDC_DISP_PIXNORMAL    <<  7 |
-                                    seMDC_DISP_UPD          <<  6 |
-                                    seMDC_DISP_SPI3BIT      <<  5 |
-                                    seMDC_DISP_PANELSPI     <<  4 |
-                                    seMDC_DISP_ROT0         <<  2 |
-                                    seMDC_VCOMEN_DISABLE    <<  1 );  // Initially VCOM should be disabled
+seStatus seMDC_InitPanel_LPM011M133B( uint32_t sysfreqhz, uint32_t framebuffaddr )
+{
+    return seMDC_InitPanelDesc( &seMDC_Panel_LPM011M133B, sysfreqhz, framebuffaddr, 0 );
+}
 
-    // Send black screen to panel
-    seS1D13C00Write32(MDC_GFXOBADDR0, framebuffaddr);
-    seS1D13C00Write16(MDC_GFXOWIDTH, 128);
-    seS1D13C00Write16(MDC_GFXOHEIGHT, 128);
-    seS1D13C00Write16(MDC_GFXOSTRIDE, 128);
-    seMDC_DrawRectangle( 0, 0, 127, 127, 0x0008, 0, 0, 1);  // filled rectangle with black pixel
-    seMDC_WaitGfxDone();
+seStatus seMDC_InitPanel_LPM012M134B( uint32_t sysfreqhz, uint32_t framebuffaddr )
+{
+    return seMDC_InitPanelDesc( &seMDC_Panel_LPM012M134B, sysfreqhz, framebuffaddr, 0 );
+}
 
-    seS1D13C00Write16(MDC_DISPSTARTY, 0);
-    seS1D13C00Write16(MDC_DISPENDY, 127);
+seStatus seMDC_InitPanel_LS010B7DH01( uint32_t sysfreqhz, uint32_t framebuffaddr )
+{
+    return seMDC_InitPanelDesc( &seMDC_Panel_LS010B7DH01, sysfreqhz, framebuffaddr, 0 );
+}
 
-    // Clear interrupt flag
-    seS1D13C00Write8(MDC_INTCTL, 0x02);  // UPDINT flag
+seStatus seMDC_InitPanel_LS012B7DD06( uint32_t sysfreqhz, uint32_t framebuffaddr )
+{
+    return seMDC_InitPanelDesc( &seMDC_Panel_LS012B7DD06, sysfreqhz, framebuffaddr, 0 );
+}
 
-    // Trigger display update
-    seS1D13C00Write8(MDC_TRIGCTL, 0x02);  // UPDTRIG = 1
-    seMDC_WaitUpdDone();
-
-    //================== T3 ======================================================================
-    seS1D13C00DispEnable();    // Enable display (DISP_EN = 1)
-    seSysSleepMS(1);           // Wait at least 30us
-
-    //================== T4 ======================================================================
-    seS1D13C00Write16( MDC_DISPCTL, seMDC_DISP_PANELNOTGS   << 11 |
-                                    seMDC_DISP_SPIRGB       << 10 |
-                                    seMDC_DISP_SPILSBFIRST  <<  9 |
-                                    seMDC_DISP_AUTOCOMOFF   <<  8 |
-                                    seMDC_DISP_PIXNORMAL    <<  7 |
-                                    seMDC_DISP_UPD          <<  6 |
-                                    seMDC_DISP_SPI3BIT      <<  5 |
-                                    seMDC_DISP_PANELSPI     <<  4 |
-                                    seMDC_DISP_ROT0         <<  2 |
-                                    seMDC_VCOMEN_ENABLE     <<  1 );  // Enable VCOM
-
-    seSysSleepMS(1);           // Wait at least 30us
+seStatus seMDC_InitPanel_6BIT260X260( uint32_t sysfreqhz, uint32_t framebuffaddr )
+{
+    return seMDC_InitPanelDesc( &seMDC_Panel_6BIT260X260, sysfreqhz, framebuffaddr, 0 );
+}
 
-    return seSTATUS_OK;
+seStatus seMDC_InitPanel_LS013B4DN04( uint32_t sysfreqhz, uint32_t framebuffaddr )
+{
+    return seMDC_InitPanelDesc( &seMDC_Panel_LS013B4DN04, sysfreqhz, framebuffaddr, 0 );
 }
 
+seStatus seMDC_InitPanel_LS013B7DH06( uint32_t sysfreqhz, uint32_t framebuffaddr )
+{
+    return seMDC_InitPanelDesc( &seMDC_Panel_LS013B7DH06, sysfreqhz, framebuffaddr, 0 );
+}
 
-/**
-  * Initialize Panel Interface for LS012B7DH02 (240x240, SPI, 1-bit BW, 1.2" round)
-  * Return value:  seStatus
-  */
 seStatus seMDC_InitPanel_LS012B7DH02( uint32_t sysfreqhz, uint32_t framebuffaddr )
 {
-    seS1D13C00InitDispEn();   // Initialize DISP_EN control pin
-
-    // Sequence power-on of voltage supplies
-    seS1D13C00Write16(MDC_BSTCLK, ((5 << 4) | (seMDC_OSC1 << 0)));
-  
-    seS1D13C00Write16( MDC_BSTPWR, 0x0007 ); // VMDBUP = normal, BSTON = on, REGECO = on, REGON = on
-  
-    seSysSleepMS(2);           // Wait stabilization time
-
-    //================== T1 ======================================================================
-    // Turn on VMDL
-    seS1D13C00Write16( MDC_BSTVMD, seMDC_VMDL_3V0 << 4 | 0x0001 ); // VMDL = 3.0V
-    seSysSleepMS(2);           // VMDL stabilization time = T1
-
-    //================== T2 ======================================================================
-    // Initialize clocks and panel interface
-    seS1D13C00Write16(MDC_DISPWIDTH, 240);
-    seS1D13C00Write16(MDC_DISPHEIGHT, 240);
-    seS1D13C00Write16(MDC_DISPSTRIDE, 240);
-    seS1D13C00Write16( MDC_DISPVCOMDIV, 286 );                          // EXTCOM freq = 32768 / (4*(286+1)) = ~28.5Hz typical
-
-    uint16_t clkdiv = ((uint16_t)(sysfreqhz / 1500000)) - 1;            // SCLK is 1.5MHz
-    seS1D13C00Write16( MDC_DISPCLKDIV, 0x0800 | clkdiv );               // tsSCS = (8 + 1) * T = 6us
-
-    seS1D13C00Write16( MDC_DISPPRM21, 0x0F01 );                         // tsSCS = (4 + 1) * T = 3.33us
-                                                                        // Data transfer period = (15 + 1) = 16 SCLK cycles
-
-    seS1D13C00Write16( MDC_DISPPRM43, 0x0701 );                         // Mode bits value for display update
-                                                                        // Number of Mode bits to send = (7+1) = 8
-
-    seS1D13C00Write16( MDC_DISPPRM65, 0x0107 );                         // Number of address bits to send = (7+1) = 8
-                                                                        // twSCSL = (1 + 1) * T = 1.33us;
-
-    seS1D13C00Write16( MDC_DISPFRMBUFF0, (uint16_t) (framebuffaddr & 0xFFFF));
-    seS1D13C00Write16( MDC_DISPFRMBUFF1, (uint16_t)((framebuffaddr >> 16) & 0xFFFF));
-
-    seS1D13C00Write16( MDC_DISPCTL, seMDC_DISP_PANELNOTGS   << 11 |
-                                    seMDC_DISP_SPILSBFIRST  <<  9 |
-                                    seMDC_DISP_AUTOCOMOFF   <<  8 |
-                                    seMDC_DISP_PIXNORMAL    <<  7 |
-                                    seMDC_DISP_UPD          <<  6 |
-                                    seMDC_DISP_SPI1BIT      <<  5 |
-                                    seMDC_DISP_PANELSPI     <<  4 |
-                                    seMDC_DISP_ROT0         <<  2 |
-                                    seMDC_VCOMEN_DISABLE    <<  1 );  // Initially VCOM should be disabled
-
-    seS1D13C00Write16( MDC_DISPCTL2, seMDC_DISP_GSALPHAON << 5);
-
-    // Send black screen to panel
-    seS1D13C00Write32(MDC_GFXOBADDR0, framebuffaddr);
-    seS1D13C00Write16(MDC_GFXOWIDTH, 240);
-    seS1D13C00Write16(MDC_GFXOHEIGHT, 240);
-    seS1D13C00Write16(MDC_GFXOSTRIDE, 240);
-    seMDC_DrawRectangle( 0, 0, 239, 239, 0x0002, 0, 0, 1);  // filled rectangle with black pixel
-    seMDC_WaitGfxDone();
-
-    seS1D13C00Write16(MDC_DISPSTARTY, 0);
-    seS1D13C00Write16(MDC_DISPENDY, 239);
-
-    // Clear interrupt flag
-    seS1D13C00Write8(MDC_INTCTL, 0x02);  // UPDINT flag
-
-    // Trigger display update
-    seS1D13C00Write8(MDC_TRIGCTL, 0x02);  // UPDTRIG = 1
-    seMDC_WaitUpdDone();
-
-    //================== T3 ======================================================================
-    seS1D13C00DispEnable();    // Enable display (DISP_EN = 1)
-    seSysSleepMS(1);           // Wait at least 30us
-
-    //================== T4 ======================================================================
-    seS1D13C00Write16( MDC_DISPCTL, seMDC_DISP_PANELNOTGS   << 11 |
-                                    seMDC_DISP_SPILSBFIRST  <<  9 |
-                                    seMDC_DISP_AUTOCOMOFF   <<  8 |
-                                    seMDC_DISP_PIXNORMAL    <<  7 |
-                                    seMDC_DISP_UPD          <<  6 |
-                                    seMDC_DISP_SPI1BIT      <<  5 |
-                                    seMDC_DISP_PANELSPI     <<  4 |
-                                    seMDC_DISP_ROT0         <<  2 |
-                                    seMDC_VCOMEN_ENABLE     <<  1 );  // Enable VCOM
-
-    seSysSleepMS(1);           // Wait at least 30us
-
-    return seSTATUS_OK;
+    return seMDC_InitPanelDesc( &seMDC_Panel_LS012B7DH02, sysfreqhz, framebuffaddr, 0 );
 }
 
-/**
-  * Initialize Panel Interface for LPM013M126C (176x176, SPI, 3-bit color, 1.28" square)
-  * Return value:  Status
-  */
 seStatus seMDC_InitPanel_LPM013M126C( uint32_t sysfreqhz, uint32_t framebuffaddr )
 {
-    seS1D13C00InitDispEn();   // Initialize DISP_EN control pin
-
-    // Sequence power-on of voltage supplies
-    seS1D13C00Write16(MDC_BSTCLK, ((5 << 4) | (seMDC_OSC1 << 0)));
-  
-    seS1D13C00Write16( MDC_BSTPWR, 0x0007 ); // VMDBUP = normal, BSTON = on, REGECO = on, REGON = on
-  
-    seSysSleepMS(2);           // Wait stabilization time
-
-    //================== T1 ======================================================================
-    // Turn on VMDL
-    seS1D13C00Write16( MDC_BSTVMD, seMDC_VMDL_3V0 << 4 | 0x0001 ); // VMDL = 3.0V
-    seSysSleepMS(2);           // VMDL stabilization time = T1
-
-    //================== T2 ======================================================================
-    // Initialize clocks and panel interface
-    seS1D13C00Write16(MDC_DISPWIDTH, 176);
-    seS1D13C00Write16(MDC_DISPHEIGHT, 176);
-    seS1D13C00Write16(MDC_DISPSTRIDE, 176);
-    seS1D13C00Write16( MDC_DISPVCOMDIV, 8191 );                         // EXTCOM freq = 32768 / (4*(8191+1)) = ~1Hz typical
-
-    uint16_t clkdiv = ((uint16_t)(sysfreqhz / 1500000)) - 1;            // SCLK is 1.5MHz
-    seS1D13C00Write16( MDC_DISPCLKDIV, 0x0800 | clkdiv );               // tsSCS = (8 + 1) * T = 6us
-
-    seS1D13C00Write16( MDC_DISPPRM21, 0x0F02 );                         // thSCS = (2 + 1) * T = 2us
-                                                                        // Data transfer period = (15 + 1) = 16 SCLK cycles
-
-    seS1D13C00Write16( MDC_DISPPRM43, 0x0501 );                         // Mode bits value for display update
-                                                                        // Number of Mode bits to send = (5+1) = 6
-
-    seS1D13C00Write16( MDC_DISPPRM65, 0x0809 );                         // Number of address bits to send = (9+1) = 10
-                                                                        // twSCSL = (8 + 1) * T = 6us;
-
-    seS1D13C00Write16( MDC_DISPFRMBUFF0, (uint16_t) (framebuffaddr & 0xFFFF));
-    seS1D13C00Write16( MDC_DISPFRMBUFF1, (uint16_t)((framebuffaddr >> 16) & 0xFFFF));
-
-    seS1D13C00Write16( MDC_DISPCTL, seMDC_DISP_PANELNOTGS   << 11 |
-                                    seMDC_DISP_SPIRGB       << 10 |
-                                    seMDC_DISP_SPIMSBFIRST  <<  9 |
-                                    seMDC_DISP_AUTOCOMOFF   <<  8 |
-                                    seMDC_DISP_PIXNORMAL    <<  7 |
-                                    seMDC_DISP_UPD          <<  6 |
-                                    seMDC_DISP_SPI3BIT      <<  5 |
-                                    seMDC_DISP_PANELSPI     <<  4 |
-                                    seMDC_DISP_ROT0         <<  2 |
-                                    seMDC_VCOMEN_DISABLE    <<  1 );  // Initially VCOM should be disabled
-
-    // Send black screen to panel
-    seS1D13C00Write32(MDC_GFXOBADDR0, framebuffaddr);
-    seS1D13C00Write16(MDC_GFXOWIDTH, 176);
-    seS1D13C00Write16(MDC_GFXOHEIGHT, 176);
-    seS1D13C00Write16(MDC_GFXOSTRIDE, 176);
-    seMDC_DrawRectangle( 0, 0, 175, 175, 0x0008, 0, 0, 1);  // filled rectangle with black pixel
-    seMDC_WaitGfxDone();
-
-    seS1D13C00Write16(MDC_DISPSTARTY, 0);
-    seS1D13C00Write16(MDC_DISPENDY, 175);
-
-    // Clear interrupt flag
-    seS1D13C00Write8(MDC_INTCTL, 0x02);  // UPDINT flag
-
-    // Trigger display update
-    seS1D13C00Write8(MDC_TRIGCTL, 0x02);  // UPDTRIG = 1
-    seMDC_WaitUpdDone();
-
-    //================== T3 ======================================================================
-    seS1D13C00DispEnable();    // Enable display (DISP_EN = 1)
-    seSysSleepMS(1);           // Wait at least 30us
-
-    //================== T4 ======================================================================
-    seS1D13C00Write16( MDC_DISPCTL, seMDC_DISP_PANELNOTGS   << 11 |
-                                    seMDC_DISP_SPIRGB       << 10 |
-                                    seMDC_DISP_SPIMSBFIRST  <<  9 |
-                                    seMDC_DISP_AUTOCOMOFF   <<  8 |
-                                    seMDC_DISP_PIXNORMAL    <<  7 |
-                                    seMDC_DISP_UPD          <<  6 |
-                                    seMDC_DISP_SPI3BIT      <<  5 |
-                                    seMDC_DISP_PANELSPI     <<  4 |
-                                    seMDC_DISP_ROT0         <<  2 |
-                                    seMDC_VCOMEN_ENABLE     <<  1 );  // Enable VCOM
-
-    seSysSleepMS(1);           // Wait at least 30us
+    return seMDC_InitPanelDesc( &seMDC_Panel_LPM013M126C, sysfreqhz, framebuffaddr, 0 );
+}
 
-    return seSTATUS_OK;
+seStatus seMDC_InitPanel_LPM027M128A( uint32_t sysfreqhz, uint32_t framebuffaddr )
+{
+    return seMDC_InitPanelDesc( &seMDC_Panel_LPM027M128A, sysfreqhz, framebuffaddr, 0 );
 }
 
 
 /**
-  * Initialize Panel Interface for LPM027M128A (400x240, SPI, 3-bit color, 2.7" rectangular)
+  * Update the panel with image from frame/display buffer
+  * Parameters:
+  *     startline: Starting line number (0 is first line).
+  *     endline: Endng line number
+  * For full screen update, startline=0 and endline=(<display height>-1).
+  * The update has been triggered on return, unless another one is still
+  * running: the lines are then merged into the next one.
   * Return value:  Status
   */
-seStatus seMDC_InitPanel_LPM027M128A ( uint32_t sysfreqhz, uint32_t framebuffaddr )
+seStatus seMDC_PanelUpdate( uint16_t startline, uint16_t endline )
 {
-    seS1D13C00InitDispEn();   // Initialize DISP_EN control pin
-
-    // Sequence power-on of voltage supplies
-    seS1D13C00Write16(MDC_BSTCLK, ((5 << 4) | (seMDC_OSC1 << 0)));
-  
-    seS1D13C00Write16( MDC_BSTPWR, 0x0007 ); // VMDBUP = normal, BSTON = on, REGECO = on, REGON = on
-  
-    seSysSleepMS(2);           // Wait stabilization time
-
-    //================== T1 ======================================================================
-    // Turn on VMDL
-    seS1D13C00Write16( MDC_BSTVMD, seMDC_VMDL_3V0 << 4 | 0x0001 ); // VMDL = 3.0V
-    seSysSleepMS(2);           // VMDL stabilization time = T1
-
-    //================== T2 ======================================================================
-    // Initialize clocks and panel interface
-    seS1D13C00Write16(MDC_DISPWIDTH, 400);
-    seS1D13C00Write16(MDC_DISPHEIGHT, 240);
-    seS1D13C00Write16(MDC_DISPSTRIDE, 400);
-    seS1D13C00Write16( MDC_DISPVCOMDIV, 8191 );                         // EXTCOM freq = 32768 / (4*(8191+1)) = ~1Hz typical
-
-    uint16_t clkdiv = ((uint16_t)(sysfreqhz / 1500000)) - 1;            // SCLK is 1.5MHz
-    seS1D13C00Write16( MDC_DISPCLKDIV, 0x0800 | clkdiv );               // tsSCS = (8 + 1) * T = 6us
-
-    seS1D13C00Write16( MDC_DISPPRM21, 0x0F02 );                         // thSCS = (2 + 1) * T = 2us
-                                                                        // Data transfer period = (15 + 1) = 16 SCLK cycles
-
-    seS1D13C00Write16( MDC_DISPPRM43, 0x0501 );                         // Mode bits value for display update
-                                                                        // Number of Mode bits to send = (5+1) = 6
-
-    seS1D13C00Write16( MDC_DISPPRM65, 0x0809 );                         // Number of address bits to send = (9+1) = 10
-                                                                        // twSCSL = (8 + 1) * T = 6us;
-
-    seS1D13C00Write16( MDC_DISPFRMBUFF0, (uint16_t) (framebuffaddr & 0xFFFF));
-    seS1D13C00Write16( MDC_DISPFRMBUFF1, (uint16_t)((framebuffaddr >> 16) & 0xFFFF));
-
-    seS1D13C00Write16( MDC_DISPCTL, seMDC_DISP_PANELNOTGS   << 11 |
-                                    seMDC_DISP_SPIRGB       << 10 |
-                                    seMDC_DISP_SPIMSBFIRST  <<  9 |
-                                    seMDC_DISP_AUTOCOMOFF   <<  8 |
-                                    seMDC_DISP_PIXNORMAL    <<  7 |
-                                    seMDC_DISP_UPD          <<  6 |
-                                    seMDC_DISP_SPI3BIT      <<  5 |
-                                    seMDC_DISP_PANELSPI     <<  4 |
-                                    seMDC_DISP_ROT0         <<  2 |
-                                    seMDC_VCOMEN_DISABLE    <<  1 );  // Initially VCOM should be disabled
-
-    // Send black screen to panel
-    seS1D13C00Write32(MDC_GFXOBADDR0, framebuffaddr);
-    seS1D13C00Write16(MDC_GFXOWIDTH, 400);
-    seS1D13C00Write16(MDC_GFXOHEIGHT, 240);
-    seS1D13C00Write16(MDC_GFXOSTRIDE, 400);
-    seMDC_DrawRectangle( 0, 0, 399, 239, 0x0008, 0, 0, 1);  // filled rectangle with black pixel
-    seMDC_WaitGfxDone();
-
-    seS1D13C00Write16(MDC_DISPSTARTY, 0);
-    seS1D13C00Write16(MDC_DISPENDY, 239);
-
-    // Clear interrupt flag
-    seS1D13C00Write8(MDC_INTCTL, 0x02);  // UPDINT flag
-
-    // Trigger display update
-    seS1D13C00Write8(MDC_TRIGCTL, 0x02);  // UPDTRIG = 1
-    seMDC_WaitUpdDone();
-
-    //================== T3 ======================================================================
-    seS1D13C00DispEnable();    // Enable display (DISP_EN = 1)
-    seSysSleepMS(1);           // Wait at least 30us
-
-    //================== T4 ======================================================================
-    seS1D13C00Write16( MDC_DISPCTL, seMDC_DISP_PANELNOTGS   << 11 |
-                                    seMDC_DISP_SPIRGB       << 10 |
-                                    seMDC_DISP_SPIMSBFIRST  <<  9 |
-                                    seMDC_DISP_AUTOCOMOFF   <<  8 |
-                                    seMDC_DISP_PIXNORMAL    <<  7 |
-                                    seMDC_DISP_UPD          <<  6 |
-                                    seMDC_DISP_SPI3BIT      <<  5 |
-                                    seMDC_DISP_PANELSPI     <<  4 |
-                                    seMDC_DISP_ROT0         <<  2 |
-                                    seMDC_VCOMEN_ENABLE     <<  1 );  // Enable VCOM
-
-    seSysSleepMS(1);           // Wait at least 30us
+    seTRACE_API();
+    if ( seMDC_PanelUpdateAsync( startline, endline ) != seSTATUS_OK )
+        return seSTATUS_NG;
 
+    if ( PanelUpd.state == UPD_DUE ) {
+        UpdSleepDue();
+        UpdTrigger();
+    }
     return seSTATUS_OK;
 }
 
 
 /**
-  * Update the panel with image from frame/display buffer
+  * Request a panel update without waiting
   * Parameters:
   *     startline: Starting line number (0 is first line).
   *     endline: Endng line number
-  * For full screen update, startline=0 and endline=(<display height>-1).
+  * The first request of a burst takes the booster out of ECO mode. Lines
+  * requested while an update runs are merged and sent by
+  * seMDC_PanelUpdatePoll() or seMDC_WaitUpdDone() once it is done.
   * Return value:  Status
   */
-seStatus seMDC_PanelUpdate( uint16_t startline, uint16_t endline )
+seStatus seMDC_PanelUpdateAsync( uint16_t startline, uint16_t endline )
 {
-    seSetBits16( MDC_BSTPWR, MDC_VMDBUP_bits | MDC_REGECO_bits, MDC_VMDBUP_bits );  // Faster response for voltage booster, exit ECO mode
-    seSysSleepMS(1);           // Wait stabilization time
+    seTRACE_API();
+    if ( startline > endline )
+        return seSTATUS_NG;
 
-    seS1D13C00Write16(MDC_DISPSTARTY, startline );
-    seS1D13C00Write16(MDC_DISPENDY, endline );
+    if ( PanelUpd.pending ) {
+        if ( startline < PanelUpd.starty )
+            PanelUpd.starty = startline;
+        if ( endline > PanelUpd.endy )
+            PanelUpd.endy = endline;
+    } else {
+        PanelUpd.starty = startline;
+        PanelUpd.endy = endline;
+        PanelUpd.pending = 1;
+    }
 
-    // Clear interrupt flag
-    seS1D13C00Write8( MDC_INTCTL, 0x02 );  // UPDINT flag
+    if ( !PanelUpd.boost ) {
+        // Faster response for voltage booster, exit ECO mode
+        PanelUpd.bstpwr = seS1D13C00Read16( MDC_BSTPWR );
+        seS1D13C00Write16( MDC_BSTPWR, (uint16_t)( ( PanelUpd.bstpwr & ~MDC_REGECO_bits ) | MDC_VMDBUP_bits ) );
+        PanelUpd.boostns = seS1D13C00NowNS();
+        PanelUpd.boost = 1;
+        if ( PanelUpd.boostns == 0 )
+            seSysSleepMS(1);                                            // Wait stabilization time
+    }
+    if ( PanelUpd.state == UPD_IDLE )
+        PanelUpd.state = UPD_DUE;
 
-    // Trigger display update
-    seS1D13C00Write8( MDC_TRIGCTL, 0x02 );  // UPDTRIG = 1
+    if ( PanelUpd.state == UPD_DUE && seS1D13C00NowNS() >= UpdDueNS() )
+        UpdTrigger();                                                   // Due already, or no time base to wait on
+    return seSTATUS_OK;
+}
 
-    seSetBits16( MDC_BSTPWR, MDC_VMDBUP_bits | MDC_REGECO_bits, MDC_REGECO_bits ); // Slower response for voltage booster, enter ECO mode
 
-    return seSTATUS_OK;
+/**
+  * Advance the panel updates without waiting: trigger the pending range once
+  * the running update is done and the booster is ready, end the burst when
+  * nothing is left. Needs a time base to trigger a range that is not due yet,
+  * seMDC_WaitUpdDone() sleeps for it instead.
+  * Return value:  seSTATUS_OK once no update is running or pending
+  */
+seStatus seMDC_PanelUpdatePoll( void )
+{
+    if ( PanelUpd.state == UPD_BUSY ) {
+        if ( ( seS1D13C00Read8( MDC_INTCTL ) & MDC_UPDIF_bits ) == 0 )
+            return seSTATUS_NG;
+        seS1D13C00Write8( MDC_INTCTL, 0x02 );                           // Clear UPDINT flag
+        UpdDone();
+    }
+    if ( PanelUpd.state == UPD_DUE && seS1D13C00NowNS() >= UpdDueNS() )
+        UpdTrigger();
+    return ( PanelUpd.state == UPD_IDLE ) ? seSTATUS_OK : seSTATUS_NG;
 }
 
 
@@ -1032,6 +1036,7 @@ seStatus seMDC_PanelUpdate( uint16_t startline, uint16_t endline )
   */
 seStatus seMDC_VCOMChangeDivider( uint16_t vcomval )
 {
+    seTRACE_API();
     seS1D13C00Write8(MDC_VCOMCLKCTL, 0x01);  // Disable CLK32K for VCOM counter
     seS1D13C00Write8(MDC_VCOMCLKCTL, 0x03);  // Hold VCOM counter in reset
     seS1D13C00Write16(MDC_DISPVCOMDIV, vcomval);  // New VCOM divider value
@@ -1049,15 +1054,122 @@ seStatus seMDC_VCOMChangeDivider( uint16_t vcomval )
   */
 seStatus seMDC_SetDestWindow( seMDC_DestWindowParams * destwinparams_ptr )
 {
+    seTRACE_API();
     seS1D13C00Write16( MDC_GFXOBADDR0, destwinparams_ptr->obaseaddr_b.obaseaddr0 );
     seS1D13C00Write16( MDC_GFXOBADDR1, destwinparams_ptr->obaseaddr_b.obaseaddr1 );
     seS1D13C00Write16( MDC_GFXOWIDTH,  destwinparams_ptr->owidth );
     seS1D13C00Write16( MDC_GFXOHEIGHT, destwinparams_ptr->oheight );
     seS1D13C00Write16( MDC_GFXOSTRIDE, destwinparams_ptr->ostride );
+    GfxOut.owidth = destwinparams_ptr->owidth;
+    GfxOut.oheight = destwinparams_ptr->oheight;
     return seSTATUS_OK;
 }
 
 
+/**
+  * Get the Destination Window size, read from the registers only if it was not set through
+  * this file.
+  * Parameters:
+  *         owidth, oheight:  Returned size.
+  * Return value:  None
+  */
+void seMDC_GetDestWindowSize( uint16_t *owidth, uint16_t *oheight )
+{
+    if ( GfxOut.owidth == 0 ) {
+        GfxOut.owidth = seS1D13C00Read16( MDC_GFXOWIDTH );
+        GfxOut.oheight = seS1D13C00Read16( MDC_GFXOHEIGHT );
+    }
+    *owidth = GfxOut.owidth;
+    *oheight = GfxOut.oheight;
+}
+
+
+/**
+  * Set the output clip window. Registers are written in one transaction, and only when the
+  * window changes.
+  * Parameters:
+  *         left, top:  Top left corner, inclusive.
+  *         right, bottom:  Bottom right corner, inclusive.
+  * Return value:  seSTATUS_NG if the window is empty or cannot be programmed
+  *
+  * NOTE:  The clip is off while GFXOWRIGHT and GFXOWBOT are both 0, a window of pixel (0, 0)
+  *        only cannot be set.
+  */
+seStatus seMDC_SetClipWindow( uint16_t left, uint16_t top, uint16_t right, uint16_t bottom )
+{
+    uint16_t clip[4];
+
+    seTRACE_API();
+    if ( right < left || bottom < top || ( right == 0 && bottom == 0 ) )
+        return seSTATUS_NG;
+
+    clip[0] = left;
+    clip[1] = right;
+    clip[2] = top;
+    clip[3] = bottom;
+    if ( memcmp( clip, GfxOut.clip, sizeof(clip) ) != 0 ) {
+        PanelWriteRun( MDC_GFXOWLEFT, clip, 4 );
+        memcpy( GfxOut.clip, clip, sizeof(clip) );
+    }
+    return seSTATUS_OK;
+}
+
+
+/**
+  * Turn the output clip window off, the whole destination window is drawn.
+  */
+void seMDC_ResetClipWindow( void )
+{
+    static const uint16_t off[4] = { 0, 0, 0, 0 };
+
+    seTRACE_API();
+    if ( memcmp( off, GfxOut.clip, sizeof(off) ) != 0 ) {
+        PanelWriteRun( MDC_GFXOWLEFT, off, 4 );
+        memset( GfxOut.clip, 0, sizeof(GfxOut.clip) );
+    }
+}
+
+
+/**
+  * Check an inclusive box against the destination and clip windows, on the host only.
+  * Parameters:
+  *         left, top, right, bottom:  Box in destination window coordinates.
+  * Return value:  Non-zero if no pixel of the box can be drawn
+  */
+int seMDC_IsClipped( int32_t left, int32_t top, int32_t right, int32_t bottom )
+{
+    int32_t wl = 0, wt = 0;
+    int32_t wr = ( GfxOut.owidth != 0 ) ? (int32_t)GfxOut.owidth - 1 : 0xFFFF;
+    int32_t wb = ( GfxOut.owidth != 0 ) ? (int32_t)GfxOut.oheight - 1 : 0xFFFF;
+
+    if ( GfxOut.clip[1] != 0 || GfxOut.clip[3] != 0 ) {
+        if ( GfxOut.clip[0] > wl ) wl = GfxOut.clip[0];
+        if ( GfxOut.clip[1] < wr ) wr = GfxOut.clip[1];
+        if ( GfxOut.clip[2] > wt ) wt = GfxOut.clip[2];
+        if ( GfxOut.clip[3] < wb ) wb = GfxOut.clip[3];
+    }
+    return ( right < wl || left > wr || bottom < wt || top > wb );
+}
+
+
+/**
+  * Check whether an image copy at scales up to scale/256 can draw anything, on the host only.
+  * Parameters:
+  *         ocenterx, ocentery:  Destination Window center.
+  *         iwidth, iheight:  Source Window size.
+  *         icenterx, icentery:  Source Window center of transformation.
+  *         scale:  Largest scaling value, 256 for a shear copy.
+  * Return value:  Non-zero if the copy is outside the destination or clip window
+  */
+int seMDC_IsCopyClipped( int32_t ocenterx, int32_t ocentery, uint16_t iwidth, uint16_t iheight,
+                         int32_t icenterx, int32_t icentery, uint16_t scale )
+{
+    int32_t reach = GfxReach( iwidth, iheight, icenterx, icentery, scale );
+
+    return seMDC_IsClipped( ocenterx - reach, ocentery - reach, ocenterx + reach, ocentery + reach );
+}
+
+
 /**
   * Draw a line
   * Parameters:
@@ -1076,12 +1188,24 @@ seStatus seMDC_SetDestWindow( seMDC_DestWindowParams * destwinparams_ptr )
 seStatus seMDC_DrawLine( uint16_t point1x, uint16_t point1y, uint16_t point2x, uint16_t point2y,
                          uint16_t pencolor, uint16_t thickness )
 {
+    seTRACE_API();
+    point1x = ( point1x >= 0x8000 ) ? 0 : point1x;
+    point1y = ( point1y >= 0x8000 ) ? 0 : point1y;
+    point2x = ( point2x >= 0x8000 ) ? 0 : point2x;
+    point2y = ( point2y >= 0x8000 ) ? 0 : point2y;
+
+    // Nothing to draw, the pen reaches at most thickness pixels off the line
+    if ( seMDC_IsClipped( ( ( point1x < point2x ) ? point1x : point2x ) - thickness,
+                          ( ( point1y < point2y ) ? point1y : point2y ) - thickness,
+                          ( ( point1x > point2x ) ? point1x : point2x ) + thickness,
+                          ( ( point1y > point2y ) ? point1y : point2y ) + thickness ) )
+        return seSTATUS_OK;
 
     // Setup the line draw parameters
-    seS1D13C00Write16( MDC_GFXIXCENTER, (point1x >= 0x8000) ? 0 : point1x );
-    seS1D13C00Write16( MDC_GFXIYCENTER, (point1y >= 0x8000) ? 0 : point1y );
-    seS1D13C00Write16( MDC_GFXOXCENTER, (point2x >= 0x8000) ? 0 : point2x );
-    seS1D13C00Write16( MDC_GFXOYCENTER, (point2y >= 0x8000) ? 0 : point2y );
+    seS1D13C00Write16( MDC_GFXIXCENTER, point1x );
+    seS1D13C00Write16( MDC_GFXIYCENTER, point1y );
+    seS1D13C00Write16( MDC_GFXOXCENTER, point2x );
+    seS1D13C00Write16( MDC_GFXOYCENTER, point2y );
     seS1D13C00Write16( MDC_GFXCOLOR, pencolor );
     seS1D13C00Write16( MDC_GFXIWIDTH, thickness );
 
@@ -1090,7 +1214,7 @@ seStatus seMDC_DrawLine( uint16_t point1x, uint16_t point1y, uint16_t point2x, u
 
     // Trigger update
     seSetBits16( MDC_GFXCTL, MDC_GFXFUNC_bits, seMDC_FUNC_LINEDRAW );
-    seS1D13C00Write8( MDC_TRIGCTL, 0x01 );  // GFXTRIG = 1
+    GfxTrigger();
 
     return seSTATUS_OK;
 }
@@ -1116,6 +1240,7 @@ seStatus seMDC_DrawLine( uint16_t point1x, uint16_t point1y, uint16_t point2x, u
 seStatus seMDC_DrawRectangle( uint16_t tlcornerx, uint16_t tlcornery, uint16_t brcornerx, uint16_t brcornery,
                               uint16_t pencolor, uint16_t vlinethick, uint16_t hlinethick, uint8_t fillenable)
 {
+    seTRACE_API();
     tlcornerx = ( tlcornerx >= 0x8000 ) ? 0 : tlcornerx;
     tlcornery = ( tlcornery >= 0x8000 ) ? 0 : tlcornery;
     brcornerx = ( brcornerx >= 0x8000 ) ? 0 : brcornerx;
@@ -1125,6 +1250,14 @@ seStatus seMDC_DrawRectangle( uint16_t tlcornerx, uint16_t tlcornery, uint16_t b
         return seSTATUS_NG;
     }
 
+    if ( seMDC_IsClipped( tlcornerx, tlcornery, brcornerx, brcornery ) ) {
+        if ( fillenable ) {
+            GfxOut.rectcolor = pencolor;                                // For seMDC_FillRectangleNext()
+            GfxOut.rectnext = 0;
+        }
+        return seSTATUS_OK;
+    }
+
     // Setup the rectangle parameters
     seS1D13C00Write16( MDC_GFXIXCENTER, tlcornerx );
     seS1D13C00Write16( MDC_GFXIYCENTER, tlcornery );
@@ -1141,12 +1274,64 @@ seStatus seMDC_DrawRectangle( uint16_t tlcornerx, uint16_t tlcornery, uint16_t b
     seS1D13C00Write8( MDC_INTCTL, 0x01 );
 
     seSetBits16( MDC_GFXCTL, MDC_GFXFUNC_bits, seMDC_FUNC_RECTDRAW );
-    seS1D13C00Write8( MDC_TRIGCTL, 0x01 );
+    GfxTrigger();
+    if ( fillenable ) {
+        GfxOut.rectcolor = pencolor;
+        GfxOut.rectnext = 1;
+    }
 
     return seSTATUS_OK;
 }
 
 
+/**
+  * Fill another rectangle with the pen color of the previous filled seMDC_DrawRectangle().
+  * Parameters:
+  *         tlcornerx: Top left corner X coordinate.
+  *         tlcornery: Top left corner Y coordinate.
+  *         brcornerx: Bottom right corner X coordinate.
+  *         brcornery: Bottom right corner Y coordinate.
+  * Return value:  Status
+  *
+  * NOTE:  Only the corners are written, in one transaction, then the engine is triggered. The
+  *        previous rectangle must have been waited for with seMDC_WaitGfxDone(), and no other
+  *        graphics function called since.
+  */
+seStatus seMDC_FillRectangleNext( uint16_t tlcornerx, uint16_t tlcornery, uint16_t brcornerx, uint16_t brcornery )
+{
+    uint8_t buf[12];
+
+    seTRACE_API();
+    tlcornerx = ( tlcornerx >= 0x8000 ) ? 0 : tlcornerx;
+    tlcornery = ( tlcornery >= 0x8000 ) ? 0 : tlcornery;
+    brcornerx = ( brcornerx >= 0x8000 ) ? 0 : brcornerx;
+    brcornery = ( brcornery >= 0x8000 ) ? 0 : brcornery;
+
+    if ( (brcornery < tlcornery) || (brcornerx < tlcornerx) ) {
+        return seSTATUS_NG;
+    }
+
+    if ( seMDC_IsClipped( tlcornerx, tlcornery, brcornerx, brcornery ) )
+        return seSTATUS_OK;
+
+    // The previous rectangle was clipped, set the engine up again
+    if ( !GfxOut.rectnext )
+        return seMDC_DrawRectangle( tlcornerx, tlcornery, brcornerx, brcornery, GfxOut.rectcolor, 0, 0, 1 );
+
+    // GFXIXCENTER, GFXIYCENTER, GFXIWIDTH = 0, GFXIHEIGHT = 0, GFXOXCENTER, GFXOYCENTER
+    memset( buf, 0, sizeof(buf) );
+    buf[0] = (uint8_t)tlcornerx;  buf[1] = (uint8_t)( tlcornerx >> 8 );
+    buf[2] = (uint8_t)tlcornery;  buf[3] = (uint8_t)( tlcornery >> 8 );
+    buf[8] = (uint8_t)brcornerx;  buf[9] = (uint8_t)( brcornerx >> 8 );
+    buf[10] = (uint8_t)brcornery; buf[11] = (uint8_t)( brcornery >> 8 );
+    seS1D13C00Write( MDC_GFXIXCENTER, buf, sizeof(buf) );
+
+    GfxTrigger();
+    GfxOut.rectnext = 1;
+    return seSTATUS_OK;
+}
+
+
 /**
   * Draw an ellipse.
   * Parameters:
@@ -1167,6 +1352,11 @@ seStatus seMDC_DrawRectangle( uint16_t tlcornerx, uint16_t tlcornery, uint16_t b
 seStatus seMDC_DrawEllipse( uint16_t centerx, uint16_t centery, uint16_t radiusx, uint16_t radiusy,
                             uint16_t pencolor, uint16_t xcrossthick, uint16_t ycrossthick, uint8_t fillenable )
 {
+    seTRACE_API();
+
+    if ( seMDC_IsClipped( (int32_t)centerx - radiusx - 1, (int32_t)centery - radiusy - 1,
+                          (int32_t)centerx + radiusx + 1, (int32_t)centery + radiusy + 1 ) )
+        return seSTATUS_OK;
 
     // Setup ellipse parameters
     seS1D13C00Write16( MDC_GFXIXCENTER, centerx );
@@ -1184,7 +1374,7 @@ seStatus seMDC_DrawEllipse( uint16_t centerx, uint16_t centery, uint16_t radiusx
     seS1D13C00Write8( MDC_INTCTL, 0x01 );
 
     seSetBits16( MDC_GFXCTL, MDC_GFXFUNC_bits, seMDC_FUNC_ELLIPDRAW );
-    seS1D13C00Write8( MDC_TRIGCTL, 0x01 );  // GFXTRIG = 1
+    GfxTrigger();
 
     return seSTATUS_OK;
 }
@@ -1221,6 +1411,15 @@ seStatus seMDC_ImgCpyRotScale( uint16_t ocenterx, uint16_t ocentery,
                                uint16_t xlscale, uint16_t xrscale, uint16_t ytscale, uint16_t ybscale,
                                seMDC_ImgCopyRotScaleCtrl * ctrl_ptr)
 {
+    uint16_t scale = xlscale;
+
+    seTRACE_API();
+    scale = ( xrscale > scale ) ? xrscale : scale;
+    scale = ( ytscale > scale ) ? ytscale : scale;
+    scale = ( ybscale > scale ) ? ybscale : scale;
+    if ( seMDC_IsCopyClipped( (int16_t)ocenterx, (int16_t)ocentery, iwidth, iheight,
+                              (int16_t)icenterx, (int16_t)icentery, scale ) )
+        return seSTATUS_OK;
 
     // Setup image copy parameters
     seS1D13C00Write16( MDC_GFXOXCENTER, ocenterx );
@@ -1249,7 +1448,7 @@ seStatus seMDC_ImgCpyRotScale( uint16_t ocenterx, uint16_t ocentery,
     ctrl_ptr->ctrlword |= seMDC_FUNC_COPYROTSCALE;
     seS1D13C00Write16( MDC_GFXCTL, ctrl_ptr->ctrlword );
 
-    seS1D13C00Write8( MDC_TRIGCTL, 0x01 );
+    GfxTrigger();
 
     return seSTATUS_OK;
 }
@@ -1280,6 +1479,11 @@ seStatus seMDC_ImgCpyHVShear( uint16_t ocenterx, uint16_t ocentery,
                               uint16_t fillcolor,
                               seMDC_ImgCopyHVShearCtrl * ctrl_ptr)
 {
+    seTRACE_API();
+
+    if ( seMDC_IsCopyClipped( (int16_t)ocenterx, (int16_t)ocentery, iwidth, iheight,
+                              (int16_t)icenterx, (int16_t)icentery, 256 ) )
+        return seSTATUS_OK;
 
     seS1D13C00Write16( MDC_GFXOXCENTER, ocenterx );
     seS1D13C00Write16( MDC_GFXOYCENTER, ocentery );
@@ -1304,7 +1508,7 @@ seStatus seMDC_ImgCpyHVShear( uint16_t ocenterx, uint16_t ocentery,
     ctrl_ptr->ctrlword |= seMDC_FUNC_COPYHVSHEAR;
     seS1D13C00Write16( MDC_GFXCTL, ctrl_ptr->ctrlword );
 
-    seS1D13C00Write8( MDC_TRIGCTL, 0x01 );  // GFXTRIG = 1
+    GfxTrigger();
 
     return seSTATUS_OK;
 }
@@ -1312,24 +1516,35 @@ seStatus seMDC_ImgCpyHVShear( uint16_t ocenterx, uint16_t ocentery,
 
 void seMDC_WaitGfxDone( void )
 {
+    seTRACE_API();
+    if ( !GfxOut.pending )
+        return;                            // Nothing triggered, or the operation was clipped
     seS1D13C00Write8(MDC_INTCTL+1, 0x01);  // Enable interrupt
-    while((seS1D13C00Read16(SYS_INTS) & SYS_MDCINT_bits) == 0);   // Poll wait until interrupt occurs
+    seTRACE_POLL_WHILE( (seS1D13C00Read16(SYS_INTS) & SYS_MDCINT_bits) == 0 );   // Poll wait until interrupt occurs
     seS1D13C00Write8(MDC_INTCTL, 0x01);    // Clear interrupt
+    GfxOut.pending = 0;
 }
 
 
 
 void seMDC_WaitUpdDone( void )
 {
-    seS1D13C00Write8(MDC_INTCTL+1, 0x02);  // Enable interrupt
-    while((seS1D13C00Read16(SYS_INTS) & SYS_MDCINT_bits) == 0);   // Poll wait until interrupt occurs
-    seS1D13C00Write8(MDC_INTCTL, 0x02);    // Clear interrupt
+    seTRACE_API();
+    while ( PanelUpd.state != UPD_IDLE ) {
+        if ( PanelUpd.state == UPD_DUE ) {
+            UpdSleepDue();
+            UpdTrigger();
+        }
+        UpdWait();
+        UpdDone();
+    }
 }
 
 
 
 void seMDC_SelectClkSrc( seMDC_ClkSrc clock )
 {
+    seTRACE_API();
     switch (clock)
     {
     case seMDC_IOSC:
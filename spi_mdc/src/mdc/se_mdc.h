@@ -305,6 +305,53 @@ typedef struct {
 } seMDC_ImgCopyHVShearCtrl;
 
 
+typedef enum {
+    seMDC_PANEL_DISPEN      = 0x01U,    ///< Panel has a DISP_EN pin
+    seMDC_PANEL_DISPCTL2    = 0x02U     ///< Write MDC_DISPCTL2
+} seMDC_PanelFlags;
+
+typedef enum {
+    seMDC_INIT_NOBLANK      = 0x01U     ///< No black fill and blank update, the first seMDC_PanelUpdate() shows the first frame
+} seMDC_PanelInitOptions;
+
+/**
+  * @brief  Panel descriptor, everything the panel init engine needs to bring up a panel.
+  * The supply sequence is MDC_BSTPWR on, wait pwrms, then each MDC_BSTVMD step
+  * followed by its wait. After the first update DISP_EN is set (waiting dispenms)
+  * and then VCOMEN, and the next update waits vcomms.
+  */
+typedef struct {
+    const char *name;                   ///< Panel part number
+    uint16_t    width;                  ///< MDC_DISPWIDTH, also MDC_DISPSTRIDE
+    uint16_t    height;                 ///< MDC_DISPHEIGHT
+    uint16_t    vcomdiv;                ///< MDC_DISPVCOMDIV, VCOM freq = 32768 / (4 * (vcomdiv + 1))
+    uint16_t    tim0;                   ///< MDC_DISPCLKDIV TIM0 field, in place
+    uint32_t    clkhz;                  ///< Panel timing clock, CLKDIV = sysfreqhz / clkhz - 1
+    uint16_t    prm[7];                 ///< MDC_DISPPRM21, 43, 65, 87, 109, 1211, 1413
+    uint8_t     nprm;                   ///< Timing registers used, 3 for SPI panels, 7 for 6-bit panels
+    uint8_t     flags;                  ///< Combination of @ref seMDC_PanelFlags
+    uint16_t    dispctl;                ///< MDC_DISPCTL without VCOMEN
+    uint16_t    dispctl2;               ///< MDC_DISPCTL2, with seMDC_PANEL_DISPCTL2
+    uint16_t    bstvmd[2];              ///< MDC_BSTVMD steps, bstvmd[1] = 0 for a single step
+    uint8_t     pwrms;                  ///< Wait after MDC_BSTPWR
+    uint8_t     vmdms[2];               ///< Wait after each MDC_BSTVMD step
+    uint8_t     dispenms;               ///< Wait after DISP_EN
+    uint8_t     vcomms;                 ///< Wait after VCOMEN
+    uint16_t    black;                  ///< Black in the frame buffer format
+} seMDC_PanelDesc;
+
+/**
+  * @brief  Timing of the last panel initialization, from the transport time base (all 0 without one).
+  */
+typedef struct {
+    const seMDC_PanelDesc *panel;       ///< Panel initialized
+    uint32_t    init_us;                ///< seMDC_PanelInitStart() to the return of seMDC_PanelInitFinish(), or time in seMDC_PanelResume()
+    uint32_t    ttff_us;                ///< seMDC_PanelInitStart() or seMDC_PanelResume() to seMDC_WaitUpdDone() of the first seMDC_PanelUpdate() after it, 0 until then
+    uint32_t    wait_us;                ///< Time slept in the supply sequence
+    uint32_t    overlap_us;             ///< Supply sequence waits covered by other work
+} seMDC_PanelInitReport;
+
+
 /**
   * @}
   */ // MDC_Types
@@ -394,6 +441,80 @@ seStatus seMDC_InitPanel_LPM013M126C ( uint32_t sysfreqhz, uint32_t framebuffadd
   */
 seStatus seMDC_InitPanel_LPM027M128A ( uint32_t sysfreqhz, uint32_t framebuffaddr );
 
+#define seMDC_PANEL_COUNT   10
+
+#ifndef seMDC_RESUME_ADDR
+#define seMDC_RESUME_ADDR   0x2001FFF4  ///< 12 bytes of controller RAM for the resume signature, the last of the 128KB
+#endif
+
+extern const seMDC_PanelDesc seMDC_Panel_LPM011M133B;
+extern const seMDC_PanelDesc seMDC_Panel_LPM012M134B;
+extern const seMDC_PanelDesc seMDC_Panel_LS010B7DH01;
+extern const seMDC_PanelDesc seMDC_Panel_LS012B7DD06;
+extern const seMDC_PanelDesc seMDC_Panel_6BIT260X260;
+extern const seMDC_PanelDesc seMDC_Panel_LS013B4DN04;
+extern const seMDC_PanelDesc seMDC_Panel_LS013B7DH06;
+extern const seMDC_PanelDesc seMDC_Panel_LS012B7DH02;
+extern const seMDC_PanelDesc seMDC_Panel_LPM013M126C;
+extern const seMDC_PanelDesc seMDC_Panel_LPM027M128A;
+extern const seMDC_PanelDesc * const seMDC_Panels[seMDC_PANEL_COUNT];   ///< All of the above
+
+/**
+  * @brief  Start initializing a panel from its descriptor. Writes the panel registers in
+  *         bursts, starts the supply sequence and the black fill, and returns without
+  *         waiting for the supplies. Host side setup can run until seMDC_PanelInitFinish(),
+  *         calling seMDC_PanelInitPoll() now and then, as long as it leaves the MDC alone.
+  * @param  panel:  panel descriptor, e.g. &seMDC_Panel_LS012B7DH02
+  * @param  sysfreqhz:  system clock frequency in hertz
+  * @param  framebuffaddr:  frame buffer base address
+  * @param  options:  combination of @ref seMDC_PanelInitOptions, seMDC_INIT_NOBLANK if the
+  *         frame buffer is drawn and updated in full before anything else is shown
+  * @retval Status: seSTATUS_NG if the panel clock cannot be divided from sysfreqhz
+  */
+seStatus seMDC_PanelInitStart( const seMDC_PanelDesc *panel, uint32_t sysfreqhz, uint32_t framebuffaddr, uint32_t options );
+
+/**
+  * @brief  Take the supply sequence steps that are due. Needs a transport time base,
+  *         without one all steps are taken by seMDC_PanelInitFinish().
+  * @retval Status: seSTATUS_OK once the supplies are up
+  */
+seStatus seMDC_PanelInitPoll( void );
+
+/**
+  * @brief  Complete the initialization: sleep for what is left of the supply sequence, set
+  *         up the panel interface and, unless seMDC_INIT_NOBLANK, send the black screen and
+  *         enable the panel. With seMDC_INIT_NOBLANK the panel is enabled by the
+  *         seMDC_WaitUpdDone() that follows the first seMDC_PanelUpdate().
+  * @retval Status: can be a value of @ref seStatus
+  */
+seStatus seMDC_PanelInitFinish( void );
+
+/**
+  * @brief  seMDC_PanelInitStart() and seMDC_PanelInitFinish().
+  * @retval Status: can be a value of @ref seStatus
+  */
+seStatus seMDC_InitPanelDesc( const seMDC_PanelDesc *panel, uint32_t sysfreqhz, uint32_t framebuffaddr, uint32_t options );
+
+/**
+  * @brief  Take over a panel the controller has kept running while the host was reset or
+  *         powered down, without touching the panel or the frame buffer. Checks the resume
+  *         signature written when the panel was enabled, the panel interface and supply
+  *         registers and the clocks. Call after seS1D13C00ResumeController() in place of
+  *         the clock and panel initialization; if it fails, initialize from scratch.
+  * @param  panel:  panel descriptor the controller was initialized with
+  * @param  sysfreqhz:  system clock frequency in hertz
+  * @param  framebuffaddr:  frame buffer base address
+  * @retval Status: seSTATUS_OK if the panel can be drawn and updated right away
+  */
+seStatus seMDC_PanelResume( const seMDC_PanelDesc *panel, uint32_t sysfreqhz, uint32_t framebuffaddr );
+
+/**
+  * @brief  Timing of the last panel initialization.
+  * @param  report:  filled in
+  * @retval None
+  */
+void seMDC_GetPanelInitReport( seMDC_PanelInitReport *report );
+
 /**
   * @brief  Initialize Panel Interface
   * @param  sysfreqhz:  system clock frequency in hertz
@@ -415,10 +536,36 @@ void seMDC_PwrOnSeq6Bit ( void );
   * @param  startline: Starting line number (0 is first line).
   * @param  endline: Endng line number
   * @note   For full screen update, startline=0 and endline=(<display height>-1).
+  * @note   The update has been triggered on return, after the booster stabilization time if
+  *         the booster was in ECO mode. If an update is still running, the lines are merged
+  *         into the next one instead, see seMDC_PanelUpdateAsync().
   * @retval Status: can be a value of @ref seStatus
   */
 seStatus seMDC_PanelUpdate( uint16_t startline, uint16_t endline );
 
+/**
+  * @brief  Request a panel update without waiting, so the next frame can be drawn while the
+  *         panel refreshes.
+  * @param  startline: Starting line number (0 is first line).
+  * @param  endline: Endng line number
+  * @note   The first request of a burst takes the booster out of ECO mode. The update is
+  *         triggered once the booster has stabilized and no other update runs; lines requested
+  *         meanwhile are merged into one range. The booster returns to ECO mode when the last
+  *         update of the burst is done. Call seMDC_PanelUpdatePoll() or seMDC_WaitUpdDone() to
+  *         advance the burst.
+  * @retval Status: can be a value of @ref seStatus
+  */
+seStatus seMDC_PanelUpdateAsync( uint16_t startline, uint16_t endline );
+
+/**
+  * @brief  Advance the panel updates without waiting: trigger the merged range once the running
+  *         update is done, put the booster back into ECO mode once nothing is left.
+  * @note   Can be called from the handler of the S1D13C00 interrupt. Without a transport time
+  *         base the booster wait is slept by seMDC_PanelUpdateAsync() already.
+  * @retval seSTATUS_OK once no update is running or pending.
+  */
+seStatus seMDC_PanelUpdatePoll( void );
+
 /**
   * @brief  Change VCOM divider value
   * @param  vcomval: new divider value
@@ -433,6 +580,46 @@ seStatus seMDC_VCOMChangeDivider( uint16_t vcomval );
   */
 seStatus seMDC_SetDestWindow( seMDC_DestWindowParams * destwinparams_ptr );
 
+/**
+  * @brief  Get the Destination Window size without register access once it is known.
+  * @param  owidth, oheight:  Returned size.
+  * @retval None
+  */
+void seMDC_GetDestWindowSize( uint16_t *owidth, uint16_t *oheight );
+
+/**
+  * @brief  Set the output clip window. The registers are written in one transaction, and only
+  *         when the window changes. Primitives outside it are dropped before any register traffic.
+  * @param  left, top:  Top left corner, inclusive.
+  * @param  right, bottom:  Bottom right corner, inclusive.
+  * @note   The clip is off while right and bottom are both 0, so a window of pixel (0, 0) only
+  *         cannot be set.
+  * @retval Status: seSTATUS_NG if the window is empty or cannot be set
+  */
+seStatus seMDC_SetClipWindow( uint16_t left, uint16_t top, uint16_t right, uint16_t bottom );
+
+/**
+  * @brief  Turn the output clip window off.
+  */
+void seMDC_ResetClipWindow( void );
+
+/**
+  * @brief  Check an inclusive box against the destination and clip windows, without register access.
+  * @retval Non-zero if no pixel of the box can be drawn
+  */
+int seMDC_IsClipped( int32_t left, int32_t top, int32_t right, int32_t bottom );
+
+/**
+  * @brief  Check an image copy against the destination and clip windows, without register access.
+  * @param  ocenterx, ocentery:  Destination Window center.
+  * @param  iwidth, iheight:  Source Window size.
+  * @param  icenterx, icentery:  Source Window center of transformation.
+  * @param  scale:  Largest scaling value of the copy, 256 for a shear copy.
+  * @retval Non-zero if the copy cannot draw any pixel
+  */
+int seMDC_IsCopyClipped( int32_t ocenterx, int32_t ocentery, uint16_t iwidth, uint16_t iheight,
+                         int32_t icenterx, int32_t icentery, uint16_t scale );
+
 /**
   * @brief  Trigger graphics engine line draw.  Does not check for completion (caller is responsible).
   * @param  point1x: POINT1 X coordinate.
@@ -461,6 +648,19 @@ seStatus seMDC_DrawLine( uint16_t point1x, uint16_t point1y, uint16_t point2x, u
 seStatus seMDC_DrawRectangle( uint16_t tlcornerx, uint16_t tlcornery, uint16_t brcornerx, uint16_t brcornery,
                               uint16_t pencolor, uint16_t vlinethick, uint16_t hlinethick, uint8_t fillenable);
 
+/**
+  * @brief  Trigger another filled rectangle with the pen color of the previous filled
+  *         seMDC_DrawRectangle(), writing only its corners.  Does not check for completion.
+  * @param  tlcornerx: Top left corner X coordinate.
+  * @param  tlcornery: Top left corner Y coordinate.
+  * @param  brcornerx: Bottom right corner X coordinate.
+  * @param  brcornery: Bottom right corner Y coordinate.
+  * @note   Call after seMDC_WaitGfxDone() of the previous rectangle, with no other graphics
+  *         function in between. A whole rectangle is drawn when the previous one was clipped.
+  * @retval Status: can be a value of @ref seStatus
+  */
+seStatus seMDC_FillRectangleNext( uint16_t tlcornerx, uint16_t tlcornery, uint16_t brcornerx, uint16_t brcornery );
+
 /**
   * @brief  Trigger graphics engine ellipse draw.  Does not check for completion (caller is responsible).
   * @param  centerx: Center X coordinate.
@@ -523,13 +723,15 @@ seStatus seMDC_ImgCpyHVShear( uint16_t ocenterx, uint16_t ocentery,
                               seMDC_ImgCopyHVShearCtrl * ctrl_ptr);
 
 /**
-  * @brief  Wait for graphics engine to complete by checking MDC interrupt status.
+  * @brief  Wait for graphics engine to complete by checking MDC interrupt status. Returns at once
+  *         when the last graphics function was clipped.
   * @retval None
   */
 void seMDC_WaitGfxDone( void );
 
 /**
-  * @brief  Wait for display updater to complete by checking MDC interrupt status.
+  * @brief  Wait for the panel updates to complete by checking MDC interrupt status, including
+  *         the merged range still pending, then put the booster back into ECO mode.
   * @retval None
   */
 void seMDC_WaitUpdDone( void );
@@ -13,7 +13,7 @@
  */
 
 #include "s1d13c00_hcl.h"
-#include "s1d13C00_memregs.h"
+#include "s1d13c00_memregs.h"
 #include "se_common.h"
 #include "se_clg.h"
 #include "se_port.h"
@@ -15,7 +15,8 @@
   */
 
 #include "s1d13c00_hcl.h"
-#include "s1d13C00_memregs.h"
+#include "s1d13c00_memregs.h"
+#include "s1d13c00_trace.h"
 #include "se_common.h"
 #include "se_clg.h"
 #include "se_t16.h"
@@ -171,22 +172,23 @@ seStatus seQSPI_Reset( void )
 
     ///< Software reset then wait for the status bit
     seSetBits16( QSPI_CTL, QSPI_SFTRST, QSPI_SFTRST );
-    while( seS1D13C00Read16(QSPI_CTL) & QSPI_SFTRST );
+    seTRACE_POLL_WHILE( seS1D13C00Read16(QSPI_CTL) & QSPI_SFTRST );
 
     return fStatus;
 }
 
 seStatus seQSPI_TxValue( uint8_t value, uint32_t count )
 {
+    seTRACE_API();
     seStatus fStatus = seSTATUS_OK;
 
     while ( count-- )
     {
-        while( (seS1D13C00Read16( QSPI_INTF ) & QSPI_INTF_TBEIF) == 0 );
+        seTRACE_POLL_WHILE( (seS1D13C00Read16( QSPI_INTF ) & QSPI_INTF_TBEIF) == 0 );
         seS1D13C00Write16( QSPI_TXD, value );
     }
 
-    while( seS1D13C00Read16( QSPI_INTF ) & QSPI_INTF_BSY );
+    seTRACE_POLL_WHILE( seS1D13C00Read16( QSPI_INTF ) & QSPI_INTF_BSY );
 
     return fStatus;
 }
@@ -194,16 +196,17 @@ seStatus seQSPI_TxValue( uint8_t value, uint32_t count )
 
 seStatus seQSPI_TxBytes( uint8_t data[], uint32_t size )
 {
+    seTRACE_API();
     seStatus fStatus = seSTATUS_OK;
 
     while ( size-- )
     {
-        while( (seS1D13C00Read16( QSPI_INTF ) & QSPI_INTF_TBEIF) == 0 );
+        seTRACE_POLL_WHILE( (seS1D13C00Read16( QSPI_INTF ) & QSPI_INTF_TBEIF) == 0 );
 
         seS1D13C00Write16( QSPI_TXD, *data++ );
     }
 
-    while( seS1D13C00Read16( QSPI_INTF ) & QSPI_INTF_BSY );
+    seTRACE_POLL_WHILE( seS1D13C00Read16( QSPI_INTF ) & QSPI_INTF_BSY );
 
     return fStatus;
 }
@@ -211,15 +214,16 @@ seStatus seQSPI_TxBytes( uint8_t data[], uint32_t size )
 
 seStatus seQSPI_TxHWords( uint16_t data[], uint32_t size )
 {
+    seTRACE_API();
     seStatus fStatus = seSTATUS_OK;
 
     while ( size-- )
     {
-        while( (seS1D13C00Read16( QSPI_INTF ) & QSPI_INTF_TBEIF) == 0 );
+        seTRACE_POLL_WHILE( (seS1D13C00Read16( QSPI_INTF ) & QSPI_INTF_TBEIF) == 0 );
         seS1D13C00Write16( QSPI_TXD, *data++ );
     }
 
-    while( (seS1D13C00Read16( QSPI_INTF ) & QSPI_INTF_BSY) == 0 );
+    seTRACE_POLL_WHILE( (seS1D13C00Read16( QSPI_INTF ) & QSPI_INTF_BSY) == 0 );
 
   return fStatus;
 }
@@ -232,6 +236,7 @@ void seQSPI_SetIO( seQSPI_IO direction )
 
 seStatus seQSPI_RxBytes( uint8_t data[], uint32_t size )
 {
+    seTRACE_API();
     seStatus fStatus = seSTATUS_OK;
     uint8_t dummy = seS1D13C00Read16( QSPI_RXD ); //< dummy read
 
@@ -243,13 +248,13 @@ seStatus seQSPI_RxBytes( uint8_t data[], uint32_t size )
             size = 1;		// If size is zero we still read 1 byte.
         }
         ///< Check transmit buffer empty.
-        while( (seS1D13C00Read16( QSPI_INTF ) & QSPI_INTF_TBEIF) == 0 );
+        seTRACE_POLL_WHILE( (seS1D13C00Read16( QSPI_INTF ) & QSPI_INTF_TBEIF) == 0 );
         ///< Receive data.
         do {
             ///< Set transmit dummy data (Master mode only)
             seS1D13C00Write16( QSPI_TXD, dummy );
             ///< Check receive buffer full.
-            while( (seS1D13C00Read16( QSPI_INTF) & QSPI_INTF_RBFIF) == 0 );
+            seTRACE_POLL_WHILE( (seS1D13C00Read16( QSPI_INTF) & QSPI_INTF_RBFIF) == 0 );
             ///< Read receive data.
             *data++ = seS1D13C00Read16( QSPI_RXD );
         } while ( --size );
@@ -259,20 +264,21 @@ seStatus seQSPI_RxBytes( uint8_t data[], uint32_t size )
         while ( size-- )
         {
             ///< Check receive buffer full.
-            while( (seS1D13C00Read16( QSPI_INTF ) & QSPI_INTF_RBFIF) == 0 );
+            seTRACE_POLL_WHILE( (seS1D13C00Read16( QSPI_INTF ) & QSPI_INTF_RBFIF) == 0 );
             ///< Read receive data.
             *data++ = seS1D13C00Read16( QSPI_RXD );
         }
     }
 
     ///< wait for idle state.
-    while( seS1D13C00Read16( QSPI_INTF ) & QSPI_INTF_BSY );
+    seTRACE_POLL_WHILE( seS1D13C00Read16( QSPI_INTF ) & QSPI_INTF_BSY );
 
   return fStatus;
 }
 
 seStatus seQSPI_RxHWords( uint16_t data[], uint32_t size )
 {
+    seTRACE_API();
     seStatus fStatus = seSTATUS_OK;
     uint8_t dummy = seS1D13C00Read8( QSPI_RXD ); //< dummy read
 
@@ -286,14 +292,14 @@ seStatus seQSPI_RxHWords( uint16_t data[], uint32_t size )
             size = 1;
         }
         ///< Check transmit buffer empty.
-        while( (seS1D13C00Read16( QSPI_INTF ) & QSPI_INTF_TBEIF) == 0 );
+        seTRACE_POLL_WHILE( (seS1D13C00Read16( QSPI_INTF ) & QSPI_INTF_TBEIF) == 0 );
 
         ///< Receive data.
         do {
             ///< Set transmit dummy data(Master mode only).
             seS1D13C00Write16( QSPI_TXD, dummy);
             ///< Check receive buffer full.
-            while( (seS1D13C00Read16( QSPI_INTF ) & QSPI_INTF_RBFIF) == 0 );
+            seTRACE_POLL_WHILE( (seS1D13C00Read16( QSPI_INTF ) & QSPI_INTF_RBFIF) == 0 );
             ///< Read receive data.
             *data++ = seS1D13C00Read16( QSPI_RXD );
         } while ( --size );
@@ -305,20 +311,21 @@ seStatus seQSPI_RxHWords( uint16_t data[], uint32_t size )
         while ( size-- )
         {
             ///< Check receive buffer full.
-            while( (seS1D13C00Read16( QSPI_INTF ) & QSPI_INTF_RBFIF) == 0 );
+            seTRACE_POLL_WHILE( (seS1D13C00Read16( QSPI_INTF ) & QSPI_INTF_RBFIF) == 0 );
             ///< Read receive data.
             *data++ = seS1D13C00Read16( QSPI_RXD );
         }
     }
 
     ///< wait for idle state.
-    while( seS1D13C00Read16( QSPI_INTF ) & QSPI_INTF_BSY );
+    seTRACE_POLL_WHILE( seS1D13C00Read16( QSPI_INTF ) & QSPI_INTF_BSY );
 
     return fStatus;
 }
 
 
 seStatus seQSPI_DmaTxHWords( uint16_t data[], uint32_t size, uint32_t localaddr ) {
+  seTRACE_API();
 
   seStatus fStatus = seSTATUS_OK;
   uint16_t rdval;
@@ -336,7 +343,7 @@ seStatus seQSPI_DmaTxHWords( uint16_t data[], uint32_t size, uint32_t localaddr
     rdval |= seDMAC_CH0;
     seS1D13C00Write16(QSPI_TBEDMAEN, rdval);
     do {
-      while(seDMAC_GetIntFlag( seDMAC_TRANSF_COMPL, seDMAC_CH0 ) == seINTERRUPT_NOT_OCCURRED);
+      seTRACE_POLL_WHILE( seDMAC_GetIntFlag( seDMAC_TRANSF_COMPL, seDMAC_CH0 ) == seINTERRUPT_NOT_OCCURRED );
       if ( seDMAC_GetIntFlag( seDMAC_TRANSF_COMPL, seDMAC_CH0 ) ) {
         rdval  &= ~seDMAC_CH0;
         seS1D13C00Write16(QSPI_TBEDMAEN, rdval);
@@ -346,7 +353,7 @@ seStatus seQSPI_DmaTxHWords( uint16_t data[], uint32_t size, uint32_t localaddr
 
     seDMAC_EnableRequestMask( seDMAC_CH0 );
     seDMAC_Disable( seDMAC_CH0 );
-    while( seS1D13C00Read16(QSPI_INTF) & QSPI_INTF_BSY );
+    seTRACE_POLL_WHILE( seS1D13C00Read16(QSPI_INTF) & QSPI_INTF_BSY );
   } else {
     fStatus = seSTATUS_NG;
   }
@@ -356,6 +363,7 @@ seStatus seQSPI_DmaTxHWords( uint16_t data[], uint32_t size, uint32_t localaddr
 
 
 seStatus seQSPI_DmaRxHWords( uint16_t data[], uint32_t size, uint32_t localaddr ) {
+  seTRACE_API();
 
   seStatus fStatus = seSTATUS_OK;
   uint16_t rbfdmaen, tbedmaen;
@@ -379,7 +387,7 @@ seStatus seQSPI_DmaRxHWords( uint16_t data[], uint32_t size, uint32_t localaddr
     tbedmaen |= seDMAC_CH1;
     seS1D13C00Write16(QSPI_TBEDMAEN, tbedmaen);
     do {
-      while(seDMAC_GetIntFlag( seDMAC_TRANSF_COMPL, seDMAC_CH1 ) == seINTERRUPT_NOT_OCCURRED);
+      seTRACE_POLL_WHILE( seDMAC_GetIntFlag( seDMAC_TRANSF_COMPL, seDMAC_CH1 ) == seINTERRUPT_NOT_OCCURRED );
       if ( seDMAC_GetIntFlag( seDMAC_TRANSF_COMPL, seDMAC_CH1 ) ) {
         tbedmaen  &= ~seDMAC_CH1;
         seS1D13C00Write16(QSPI_TBEDMAEN, tbedmaen);
@@ -387,7 +395,7 @@ seStatus seQSPI_DmaRxHWords( uint16_t data[], uint32_t size, uint32_t localaddr
       }
     } while (  seDMAC_GetMode( seDMAC_CH1 ) != seDMAC_MODE_STOP );
 
-    while( seS1D13C00Read16(QSPI_INTF) & QSPI_INTF_BSY );
+    seTRACE_POLL_WHILE( seS1D13C00Read16(QSPI_INTF) & QSPI_INTF_BSY );
   } else {
     fStatus = seSTATUS_NG;
   }
@@ -403,6 +411,7 @@ seStatus seQSPI_DmaRxHWords( uint16_t data[], uint32_t size, uint32_t localaddr
 }
 
 seStatus seQSPI_DmaRxMmaWords( uint32_t offset, uint32_t data[], uint32_t size ) {
+    seTRACE_API();
 
     uint16_t rdval;
     uint32_t size_m1 = size-1;
@@ -531,10 +540,10 @@ seStatus seQSPI_SetMasterRxMMA( uint32_t raddr, uint16_t flash_rcmd )
         seQSPI_ASSERT_MST_CS0();
         seQSPI_SetMode(seQSPI_MODE_SINGLE, seQSPI_08CLK, seQSPI_08CLK);
         seQSPI_SetIO( seQSPI_Output );
-        while( (seS1D13C00Read16( QSPI_INTF) & QSPI_INTF_BSY) != 0 );
+        seTRACE_POLL_WHILE( (seS1D13C00Read16( QSPI_INTF) & QSPI_INTF_BSY) != 0 );
         seS1D13C00Write16( QSPI_TXD, flash_rcmd );
-        while( (seS1D13C00Read16( QSPI_INTF) & QSPI_INTF_TBEIF) == 0 );
-        while( (seS1D13C00Read16( QSPI_INTF) & QSPI_INTF_TENDIF) == 0 );
+        seTRACE_POLL_WHILE( (seS1D13C00Read16( QSPI_INTF) & QSPI_INTF_TBEIF) == 0 );
+        seTRACE_POLL_WHILE( (seS1D13C00Read16( QSPI_INTF) & QSPI_INTF_TENDIF) == 0 );
         seSetBits16( QSPI_INTF, QSPI_INTF_TENDIF, QSPI_INTF_TENDIF );
         if ( fStatus == seSTATUS_OK ) {
           seQSPI_SetMode(seQSPI_MODE_QUAD, seQSPI_02CLK, seQSPI_02CLK);
@@ -562,7 +571,7 @@ seStatus seQSPI_ClearMasterRxMMA(void )
 
     seQSPI_NEGATE_MST_CS0();
     seSetBits16(QSPI_MMACFG2, QSPI_MMAEN, 0 );
-    while( seS1D13C00Read16( QSPI_INTF ) & QSPI_INTF_MMABSY );
+    seTRACE_POLL_WHILE( seS1D13C00Read16( QSPI_INTF ) & QSPI_INTF_MMABSY );
     return fStatus;
 }
 
@@ -570,7 +579,7 @@ seStatus seQSPI_TermMasterTx( void )
 {
     seStatus fStatus = seSTATUS_OK;
 
-    while( (seS1D13C00Read16( QSPI_INTF ) & QSPI_INTF_TENDIF) == 0 );
+    seTRACE_POLL_WHILE( (seS1D13C00Read16( QSPI_INTF ) & QSPI_INTF_TENDIF) == 0 );
     seS1D13C00Write16( QSPI_INTF, QSPI_INTF_TENDIF);
     seQSPI_Stop();
 
@@ -13,7 +13,8 @@
  */
 
 #include "s1d13c00_hcl.h"
-#include "s1d13C00_memregs.h"
+#include "s1d13c00_memregs.h"
+#include "s1d13c00_trace.h"
 #include "se_common.h"
 #include "se_clg.h"
 #include "se_rtc.h"
@@ -71,7 +72,7 @@ seStatus seRTC_Start( void )
 
     ///< Execute software reset.
     seSetBits8( RTC_CTLL, RTC_RST_bits, RTC_RST_bits );
-    while( seS1D13C00Read8(RTC_CTLL) & RTC_RST_bits );
+    seTRACE_POLL_WHILE( seS1D13C00Read8(RTC_CTLL) & RTC_RST_bits );
     seSetBits8( RTC_CTLL, RTC_RUN_bits, 1 );
 
     return fStatus;
@@ -405,7 +406,7 @@ seStatus seRTC_Set30secCorrection( void )
     {
         seSetBits8( RTC_CTLL, RTC_ADJ_bits, RTC_ADJ_bits );
         // Wait until this bit goes away to prevent an unintentional write of 1 by read/modify of CTL. And return the status
-        while( seS1D13C00Read8(RTC_CTLL) & RTC_ADJ_bits );
+        seTRACE_POLL_WHILE( seS1D13C00Read8(RTC_CTLL) & RTC_ADJ_bits );
     } else {
         fStatus = seSTATUS_NG;
     }
@@ -553,7 +554,7 @@ seStatus seRTC_TheoreticalRegulationTrim( int16_t curr_freqerr_mHz )
     if (rtcTrim < 0)  // make value right for RTCTRM register
       rtcTrim = rtcTrim + 128;
 
-    while ( seS1D13C00Read8( RTC_CTLH ) & RTC_TRMBSY_bits );
+    seTRACE_POLL_WHILE( seS1D13C00Read8( RTC_CTLH ) & RTC_TRMBSY_bits );
     seSetBits8( RTC_CTLH, RTC_TRM_bits, (uint8_t)((rtcTrim & 0x7F) << 8));
 
     // Set up for next sample
@@ -570,7 +571,7 @@ static seStatus unprotect( void )
     seStatus fStatus = seSTATUS_OK;
 
     ///< Check busy.
-    while( seS1D13C00Read8( RTC_CTLL ) & RTC_BSY_bits );
+    seTRACE_POLL_WHILE( seS1D13C00Read8( RTC_CTLL ) & RTC_BSY_bits );
 
 
     ///< Halt RTC
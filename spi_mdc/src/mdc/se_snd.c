@@ -13,7 +13,8 @@
   */
 
 #include "s1d13c00_hcl.h"
-#include "s1d13C00_memregs.h"
+#include "s1d13c00_memregs.h"
+#include "s1d13c00_trace.h"
 #include "se_common.h"
 #include "se_clg.h"
 #include "se_port.h"
@@ -103,7 +104,7 @@ seStatus seSND_Stop( void )
     seSetBits16( SND_CTL, SND_SSTP_bits, SND_SSTP_bits );
 
     ///< Wait for output to stop
-    while( seS1D13C00Read16( SND_CTL ) & SND_SSTP_bits );
+    seTRACE_POLL_WHILE( seS1D13C00Read16( SND_CTL ) & SND_SSTP_bits );
 
     ///< Clear interrupt flag.
     seS1D13C00Write16( SND_INTF, 1 );
@@ -13,7 +13,8 @@
   */
 
 #include "s1d13c00_hcl.h"
-#include "s1d13C00_memregs.h"
+#include "s1d13c00_memregs.h"
+#include "s1d13c00_trace.h"
 #include "se_common.h"
 #include "se_clg.h"
 #include "se_t16.h"
@@ -112,7 +113,7 @@ seStatus seSPI_Reset( void )
 
     ///< Execute software reset.
     seSetBits16(SPI_CTL, SPI_SFTRST_bits, SPI_SFTRST_bits );
-    while( seS1D13C00Read16( SPI_CTL ) & SPI_SFTRST_bits );
+    seTRACE_POLL_WHILE( seS1D13C00Read16( SPI_CTL ) & SPI_SFTRST_bits );
 
     return fStatus;
 }
@@ -122,18 +123,18 @@ seStatus seSPI_TxBytes( uint8_t data[], uint32_t size )
 {
     seStatus fStatus = seSTATUS_OK;
 
-    while( (seS1D13C00Read16( SPI_INTF ) & SPI_TBEIF_bits) == 0 );
+    seTRACE_POLL_WHILE( (seS1D13C00Read16( SPI_INTF ) & SPI_TBEIF_bits) == 0 );
 
     ///< Send data.
     while ( size-- )
     {
         seS1D13C00Write16( SPI_TXD, *data++ );
         ///< Wait for transmit buffer empty.
-        while( (seS1D13C00Read16( SPI_INTF ) & SPI_TBEIF_bits) == 0 );
+        seTRACE_POLL_WHILE( (seS1D13C00Read16( SPI_INTF ) & SPI_TBEIF_bits) == 0 );
     }
 
     ///< Wait for idle state.
-    while( (seS1D13C00Read16( SPI_INTF ) & SPI_BSY_bits) );
+    seTRACE_POLL_WHILE( (seS1D13C00Read16( SPI_INTF ) & SPI_BSY_bits) );
 
     return fStatus;
 }
@@ -165,7 +166,7 @@ seStatus seSPI_DmaTxHWords( uint16_t data[], uint32_t size )
         seDMAC_ClearIntFlag( seDMAC_TRANSF_COMPL, seDMAC_CH0 );
         seDMAC_EnableRequestMask( seDMAC_CH0 );
         seDMAC_Disable( seDMAC_CH0 );
-        while( seS1D13C00Read16( SPI_INTF) & SPI_BSY_bits );
+        seTRACE_POLL_WHILE( seS1D13C00Read16( SPI_INTF) & SPI_BSY_bits );
     } else {
         fStatus = seSTATUS_NG;
     }
@@ -178,18 +179,18 @@ seStatus seSPI_TxHWords( uint16_t data[], uint32_t size )
 {
     seStatus fStatus = seSTATUS_OK;
 
-    while( (seS1D13C00Read16(SPI_INTF) & SPI_TBEIF_bits) == 0 );
+    seTRACE_POLL_WHILE( (seS1D13C00Read16(SPI_INTF) & SPI_TBEIF_bits) == 0 );
 
     while( size-- )
     {
         ///< Send data.
         seS1D13C00Write16( SPI_TXD, *data++ );
         ///< Wait for transmit buffer empty.
-        while( (seS1D13C00Read16( SPI_INTF ) & SPI_TBEIF_bits) == 0 );
+        seTRACE_POLL_WHILE( (seS1D13C00Read16( SPI_INTF ) & SPI_TBEIF_bits) == 0 );
     }
 
     ///< Wait for idle state.
-    while( seS1D13C00Read16( SPI_INTF ) & SPI_BSY_bits );
+    seTRACE_POLL_WHILE( seS1D13C00Read16( SPI_INTF ) & SPI_BSY_bits );
 
     return fStatus;
 }
@@ -204,7 +205,7 @@ seStatus seSPI_RxBytes( uint8_t data[], uint32_t size )
     {
         ///< Set transmit dummy data(Master mode only).
         ///< Check transmit buffer empty.
-        while( (seS1D13C00Read16( SPI_INTF ) & SPI_TBEIF_bits) == 0 );
+        seTRACE_POLL_WHILE( (seS1D13C00Read16( SPI_INTF ) & SPI_TBEIF_bits) == 0 );
 
         ///< Receive data (Master).
         while ( size-- )
@@ -212,7 +213,7 @@ seStatus seSPI_RxBytes( uint8_t data[], uint32_t size )
             ///< Set transmit dummy data(Master mode only).
             seS1D13C00Write16( SPI_TXD, dummy );
             ///< Check receive buffer full.
-            while( (seS1D13C00Read16( SPI_INTF ) & SPI_RBFIF_bits) == 0 );
+            seTRACE_POLL_WHILE( (seS1D13C00Read16( SPI_INTF ) & SPI_RBFIF_bits) == 0 );
             *data++ = seS1D13C00Read16( SPI_RXD );
         }
     } else {
@@ -220,13 +221,13 @@ seStatus seSPI_RxBytes( uint8_t data[], uint32_t size )
         while ( size-- )
         {
             ///< Check receive buffer full.
-            while( (seS1D13C00Read16( SPI_INTF ) & SPI_RBFIF_bits) == 0 );
+            seTRACE_POLL_WHILE( (seS1D13C00Read16( SPI_INTF ) & SPI_RBFIF_bits) == 0 );
             *data++ = seS1D13C00Read16( SPI_RXD );
         }
     }
 
     ///< Wait for idle state.
-    while( seS1D13C00Read16(SPI_INTF) & SPI_BSY_bits );
+    seTRACE_POLL_WHILE( seS1D13C00Read16(SPI_INTF) & SPI_BSY_bits );
 
     return fStatus;
 }
@@ -242,9 +243,9 @@ seStatus seSPI_RxHWords( uint16_t data[], uint32_t size )
     {
         ///< Set transmit dummy data(Master mode only).
         ///< Check transmit buffer empty.
-        while( (seS1D13C00Read16( SPI_INTF ) & SPI_TBEIF_bits) == 0 );
+        seTRACE_POLL_WHILE( (seS1D13C00Read16( SPI_INTF ) & SPI_TBEIF_bits) == 0 );
         seS1D13C00Write8( SPI_TXD, dummy );
-        while( (seS1D13C00Read16( SPI_INTF ) & SPI_TBEIF_bits) == 0 );
+        seTRACE_POLL_WHILE( (seS1D13C00Read16( SPI_INTF ) & SPI_TBEIF_bits) == 0 );
 
         ///< Receive data (Master).
         while ( size-- )
@@ -252,7 +253,7 @@ seStatus seSPI_RxHWords( uint16_t data[], uint32_t size )
             ///< Set transmit dummy data(Master mode only).
             seS1D13C00Write8( SPI_TXD, dummy );
             ///< Check receive buffer full.
-            while( (seS1D13C00Read16( SPI_INTF ) & SPI_RBFIF_bits) == 0 );
+            seTRACE_POLL_WHILE( (seS1D13C00Read16( SPI_INTF ) & SPI_RBFIF_bits) == 0 );
             *data++ = seS1D13C00Read16( SPI_RXD );
         }
     } else {
@@ -260,13 +261,13 @@ seStatus seSPI_RxHWords( uint16_t data[], uint32_t size )
         while ( size-- )
         {
             ///< Check receive buffer full.
-            while( (seS1D13C00Read16(SPI_INTF) & SPI_RBFIF_bits) == 0 );
+            seTRACE_POLL_WHILE( (seS1D13C00Read16(SPI_INTF) & SPI_RBFIF_bits) == 0 );
             *data++ = seS1D13C00Read16( SPI_RXD );
         }
     }
 
     ///< Wait for idle
-    while( seS1D13C00Read16(SPI_INTF) & SPI_BSY_bits );
+    seTRACE_POLL_WHILE( seS1D13C00Read16(SPI_INTF) & SPI_BSY_bits );
 
     return fStatus;
 }
@@ -354,7 +355,7 @@ seStatus seSPI_DmaRxHWords( uint16_t data[], uint32_t size )
     }
 
     ///< wait for idle state.
-    while( seS1D13C00Read16(SPI_INTF) & SPI_BSY_bits );
+    seTRACE_POLL_WHILE( seS1D13C00Read16(SPI_INTF) & SPI_BSY_bits );
 
     return fStatus;
 }
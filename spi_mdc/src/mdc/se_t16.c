@@ -13,7 +13,8 @@
   */
 
 #include "s1d13c00_hcl.h"
-#include "s1d13C00_memregs.h"
+#include "s1d13c00_memregs.h"
+#include "s1d13c00_trace.h"
 #include "se_common.h"
 #include "se_clg.h"
 #include "se_t16.h"
@@ -183,7 +184,7 @@ seStatus seT16_SetCounter( uint32_t T16BaseAddr, uint16_t counter )
     }
 
     // Wait for the preset operation to complete
-    while( seS1D13C00Read16( T16BaseAddr + T16_CTL_OFFSET) & T16_PRESET_bits );
+    seTRACE_POLL_WHILE( seS1D13C00Read16( T16BaseAddr + T16_CTL_OFFSET) & T16_PRESET_bits );
 
     return fResult;
 }
@@ -0,0 +1,400 @@
+/**
+  ******************************************************************************
+  * @file    semdc_anim.c
+  * @brief   Sprite animation scheduler, see semdc_anim.h.
+  ******************************************************************************
+  */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "s1d13c00_hcl.h"
+#include "s1d13c00_memregs.h"
+#include "s1d13c00_trace.h"
+#include "se_common.h"
+#include "se_dmac.h"
+#include "se_mdc.h"
+#include "semdc_anim.h"
+#include "semdc_gfx.h"
+
+// Inclusive frame rectangle
+typedef struct {
+    int32_t left, top, right, bot;
+} Rect;
+
+static struct {
+    const seMDC_GFX_SpriteBg *bg;
+    seMDC_ANIM_Object *objects;         // Stacking order, linked by next
+    uint16_t           height;          // Panel lines
+    uint64_t           periodns;
+    uint64_t           duens;           // Next slot
+    uint64_t           firstns;         // Slots of the first and last frame
+    uint64_t           lastns;
+    uint32_t           frames;
+    uint32_t           dropped;
+    Rect               removed;         // Boxes of the objects removed since the last frame
+    bool               hasremoved;
+} anim;
+
+
+//---------------------------------------------------------------------------
+// PRIVATE FUNCTIONS
+//---------------------------------------------------------------------------
+
+static void SpriteRect( const seMDC_GFX_Sprite *sprite, Rect *r )
+{
+    r->left  = sprite->left;
+    r->top   = sprite->top;
+    r->right = sprite->right;
+    r->bot   = sprite->bottom;
+}
+
+static void OldRect( const seMDC_ANIM_Object *obj, Rect *r )
+{
+    r->left  = obj->oldleft;
+    r->top   = obj->oldtop;
+    r->right = obj->oldright;
+    r->bot   = obj->oldbottom;
+}
+
+static bool RectOverlap( const Rect *r, const Rect *s )
+{
+    return s->left <= s->right && r->left <= s->right && s->left <= r->right && r->top <= s->bot && s->top <= r->bot;
+}
+
+// Union of r and s in r, r empty while *any is false
+static void RectAdd( Rect *r, bool *any, const Rect *s )
+{
+    if ( s->left > s->right || s->top > s->bot )
+        return;
+    if ( !*any )
+    {
+        *r = *s;
+        *any = true;
+        return;
+    }
+    if ( s->left < r->left )    r->left  = s->left;
+    if ( s->top < r->top )      r->top   = s->top;
+    if ( s->right > r->right )  r->right = s->right;
+    if ( s->bot > r->bot )      r->bot   = s->bot;
+}
+
+// Eased fraction of 65536
+static uint32_t Ease( uint8_t ease, uint32_t f )
+{
+    switch ( ease )
+    {
+    case seMDC_ANIM_EASEIN:
+        return (uint32_t)(((uint64_t)f * f) >> 16);
+    case seMDC_ANIM_EASEOUT:
+        return 65536U - (uint32_t)(((uint64_t)(65536U - f) * (65536U - f)) >> 16);
+    case seMDC_ANIM_EASEINOUT:
+        return (uint32_t)(((uint64_t)f * f * (3U * 65536U - 2U * f)) >> 32);
+    default:
+        return f;
+    }
+}
+
+// Value of a running tween at slot time t, ending it when it is done
+static int32_t TweenValue( seMDC_ANIM_Tween *tw, uint64_t t )
+{
+    uint64_t durns = (uint64_t)tw->durms * 1000000U;
+    uint64_t el;
+    uint32_t f;
+
+    if ( tw->active == 2 )
+    {
+        tw->startns = t;
+        tw->active  = 1;
+    }
+    el = t - tw->startns;
+    if ( el >= durns )
+    {
+        if ( durns == 0 || !(tw->flags & seMDC_ANIM_LOOP) )
+        {
+            tw->active = 0;
+            return tw->to;
+        }
+        tw->startns += el / durns * durns;
+        el %= durns;
+    }
+    f = Ease( tw->ease, (uint32_t)((el << 16) / durns) );
+    return tw->from + (int32_t)(((int64_t)(tw->to - tw->from) * f) >> 16);
+}
+
+// Slot time of the next frame, after sleeping until it. Slots already passed are dropped.
+static uint64_t WaitSlot( void )
+{
+    uint64_t now = seS1D13C00NowNS();
+    uint64_t late;
+
+    (void)seMDC_PanelUpdatePoll();
+    if ( anim.frames == 0 )
+    {
+        anim.firstns = now;
+        return now;
+    }
+    if ( now == 0 )
+    {
+        // No time base: the period is slept and the slots counted here
+        seSysSleepMS( (uint32_t)((anim.periodns + 999999) / 1000000) );
+        return anim.duens;
+    }
+    if ( now < anim.duens )
+    {
+        seSysSleepMS( (uint32_t)((anim.duens - now + 999999) / 1000000) );
+        (void)seMDC_PanelUpdatePoll();
+        return anim.duens;
+    }
+    late = (now - anim.duens) / anim.periodns;
+    anim.dropped += (uint32_t)late;
+    return anim.duens + late * anim.periodns;
+}
+
+// An unchanged object lost pixels to an erased box, or was drawn over by an object under it
+static bool Covered( const seMDC_ANIM_Object *obj )
+{
+    const seMDC_ANIM_Object *p;
+    bool under = true;
+    Rect box, r;
+
+    SpriteRect( obj->sprite, &box );
+    if ( anim.hasremoved && RectOverlap( &box, &anim.removed ) )
+        return true;
+    for ( p = anim.objects; p != NULL; p = p->next )
+    {
+        if ( p == obj )
+        {
+            under = false;
+            continue;
+        }
+        OldRect( p, &r );
+        if ( p->changed == 1 && RectOverlap( &box, &r ) )
+            return true;
+        SpriteRect( p->sprite, &r );
+        if ( under && p->changed && RectOverlap( &box, &r ) )
+            return true;
+    }
+    return false;
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seMDC_ANIM_Init()
+//---------------------------------------------------------------------------
+seStatus seMDC_ANIM_Init( const seMDC_GFX_SpriteBg *bg, uint16_t fps )
+{
+    seTRACE_API();
+
+    memset( &anim, 0, sizeof(anim) );
+    anim.bg     = bg;
+    anim.height = seS1D13C00Read16( MDC_DISPHEIGHT );
+    return seMDC_ANIM_SetRate( fps );
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seMDC_ANIM_SetRate()
+//---------------------------------------------------------------------------
+seStatus seMDC_ANIM_SetRate( uint16_t fps )
+{
+    uint64_t vcomns, framens, n;
+
+    if ( fps == 0 )
+        return seSTATUS_NG;
+
+    // VCOM freq = 32768 / (4 * (vcomdiv + 1))
+    vcomns  = ((uint64_t)seS1D13C00Read16( MDC_DISPVCOMDIV ) + 1) * 1000000000U / 8192;
+    framens = 1000000000U / fps;
+    if ( vcomns <= framens )
+    {
+        n = (framens + vcomns / 2) / vcomns;
+        anim.periodns = n * vcomns;
+    }
+    else
+    {
+        n = (vcomns + framens / 2) / framens;
+        anim.periodns = vcomns / n;
+    }
+    return seSTATUS_OK;
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seMDC_ANIM_Add()
+//---------------------------------------------------------------------------
+void seMDC_ANIM_Add( seMDC_ANIM_Object *obj )
+{
+    seMDC_ANIM_Object **pp;
+
+    for ( pp = &anim.objects; *pp != NULL; pp = &(*pp)->next )
+        ;
+    obj->next    = NULL;
+    obj->changed = 0;
+    obj->sprite->drawn = 0;
+    *pp = obj;
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seMDC_ANIM_Remove()
+//---------------------------------------------------------------------------
+seStatus seMDC_ANIM_Remove( seMDC_ANIM_Object *obj )
+{
+    seTRACE_API();
+    seMDC_ANIM_Object **pp;
+    Rect r;
+
+    for ( pp = &anim.objects; *pp != NULL; pp = &(*pp)->next )
+    {
+        if ( *pp == obj )
+        {
+            *pp = obj->next;
+            break;
+        }
+    }
+    obj->next = NULL;
+    if ( !obj->sprite->drawn )
+        return seSTATUS_OK;
+
+    SpriteRect( obj->sprite, &r );
+    RectAdd( &anim.removed, &anim.hasremoved, &r );
+    return seMDC_GFX_SpriteErase( obj->sprite, anim.bg );
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seMDC_ANIM_Start()
+//---------------------------------------------------------------------------
+void seMDC_ANIM_Start( seMDC_ANIM_Object *obj, seMDC_ANIM_PROP prop, int32_t to, uint32_t durms,
+                       seMDC_ANIM_EASE ease, uint8_t flags )
+{
+    seMDC_ANIM_Tween *tw = &obj->tween[prop];
+
+    tw->from   = obj->value[prop];
+    tw->to     = to;
+    tw->durms  = durms;
+    tw->ease   = (uint8_t)ease;
+    tw->flags  = flags;
+    tw->active = 2;
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seMDC_ANIM_Stop()
+//---------------------------------------------------------------------------
+void seMDC_ANIM_Stop( seMDC_ANIM_Object *obj, seMDC_ANIM_PROP prop )
+{
+    obj->tween[prop].active = 0;
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seMDC_ANIM_Running()
+//---------------------------------------------------------------------------
+int seMDC_ANIM_Running( void )
+{
+    const seMDC_ANIM_Object *o;
+    int i;
+
+    for ( o = anim.objects; o != NULL; o = o->next )
+    {
+        for ( i = 0; i < seMDC_ANIM_NUMPROPS; i++ )
+        {
+            if ( o->tween[i].active && !(o->tween[i].flags & seMDC_ANIM_LOOP) )
+                return 1;
+        }
+    }
+    return 0;
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seMDC_ANIM_Frame()
+//---------------------------------------------------------------------------
+seStatus seMDC_ANIM_Frame( void )
+{
+    seTRACE_API();
+    seMDC_ANIM_Object *o;
+    seStatus fResult = seSTATUS_OK;
+    Rect rows = anim.removed, r;
+    bool any = anim.hasremoved;
+    uint64_t t;
+    int i;
+
+    t = WaitSlot();
+
+    // Erase every changed sprite before drawing any
+    for ( o = anim.objects; o != NULL; o = o->next )
+    {
+        for ( i = 0; i < seMDC_ANIM_NUMPROPS; i++ )
+        {
+            if ( o->tween[i].active )
+                o->value[i] = TweenValue( &o->tween[i], t );
+        }
+        o->changed   = !o->sprite->drawn || memcmp( o->value, o->shown, sizeof(o->value) ) != 0;
+        o->oldleft   = 1;
+        o->oldright  = 0;
+        if ( o->changed && o->sprite->drawn )
+        {
+            o->oldleft   = o->sprite->left;
+            o->oldtop    = o->sprite->top;
+            o->oldright  = o->sprite->right;
+            o->oldbottom = o->sprite->bottom;
+            OldRect( o, &r );
+            RectAdd( &rows, &any, &r );
+            if ( seMDC_GFX_SpriteErase( o->sprite, anim.bg ) != seSTATUS_OK )
+                fResult = seSTATUS_NG;
+        }
+    }
+
+    // Draw in stacking order what changed and what lost pixels or was covered
+    for ( o = anim.objects; o != NULL && fResult == seSTATUS_OK; o = o->next )
+    {
+        if ( !o->changed )
+        {
+            if ( !Covered( o ) )
+                continue;
+            o->changed = 2;
+        }
+        o->sprite->scale = (uint16_t)o->value[seMDC_ANIM_SCALE];
+        fResult = seMDC_GFX_SpriteDraw( o->sprite, (int16_t)o->value[seMDC_ANIM_X], (int16_t)o->value[seMDC_ANIM_Y],
+                                        (uint16_t)(o->value[seMDC_ANIM_ROT] & 511) );
+        memcpy( o->shown, o->value, sizeof(o->shown) );
+        if ( o->changed == 1 )
+        {
+            SpriteRect( o->sprite, &r );
+            RectAdd( &rows, &any, &r );
+        }
+    }
+    anim.hasremoved = false;
+
+    // Lines of the old and new boxes
+    if ( any && rows.top < (int32_t)anim.height && rows.bot >= 0 )
+    {
+        if ( rows.top < 0 )
+            rows.top = 0;
+        if ( rows.bot >= (int32_t)anim.height )
+            rows.bot = (int32_t)anim.height - 1;
+        if ( fResult == seSTATUS_OK )
+            fResult = seMDC_PanelUpdateAsync( (uint16_t)rows.top, (uint16_t)rows.bot );
+    }
+
+    anim.frames++;
+    anim.lastns = t;
+    anim.duens  = t + anim.periodns;
+    return fResult;
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seMDC_ANIM_GetStats()
+//---------------------------------------------------------------------------
+void seMDC_ANIM_GetStats( seMDC_ANIM_Stats *stats )
+{
+    stats->frames    = anim.frames;
+    stats->dropped   = anim.dropped;
+    stats->fps_x100  = ( anim.frames > 1 && anim.lastns > anim.firstns ) ?
+                       (uint32_t)((uint64_t)(anim.frames - 1) * 100000000000ULL / (anim.lastns - anim.firstns)) : 0;
+    stats->period_us = (uint32_t)(anim.periodns / 1000);
+}
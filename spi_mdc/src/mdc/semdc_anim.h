@@ -0,0 +1,172 @@
+/**
+  ******************************************************************************
+  * @file    semdc_anim.h
+  * @brief   Sprite animation: tweened position, rotation and scale drawn at a
+  *          frame rate locked to the panel VCOM cadence.
+  ******************************************************************************
+  * @attention
+  *
+  * An object is a sprite with four properties, seMDC_ANIM_PROP, each either
+  * set by the caller or moved by a tween from its current value to a target
+  * over a duration. seMDC_ANIM_Frame() draws one frame: it waits for the next
+  * frame slot, evaluates the tweens at the slot time, and redraws only what
+  * changed. The sprites whose properties changed are erased from the
+  * background, then the objects are drawn again in the order they were added:
+  * the changed ones and those overlapping a box that was erased or drawn over.
+  * The panel update covers the rows of the old and new boxes of the changed
+  * sprites and is requested with seMDC_PanelUpdateAsync().
+  *
+  * The frame period is a whole number of VCOM periods, as given by
+  * MDC_DISPVCOMDIV, nearest to the target rate, or a whole fraction of one for
+  * panels toggling VCOM slower than that. Slots follow each other by the
+  * period from the first frame. A frame that ends after the next slot drops
+  * the slots it missed instead of catching up: the next frame shows the state
+  * of its own slot, and the slots skipped are counted. Without a transport time
+  * base the period is slept between frames and no frame is dropped.
+  *
+  * The engine must be idle when these functions are called; they wait for
+  * completion before returning. Sprites must lie within the background, as for
+  * seMDC_GFX_SpriteErase().
+  ******************************************************************************
+  */
+
+#ifndef SEMDC_ANIM_H
+#define SEMDC_ANIM_H
+
+#include <stdint.h>
+#include "se_common.h"
+#include "se_dmac.h"
+#include "se_mdc.h"
+#include "semdc_gfx.h"
+
+#define seMDC_ANIM_LOOP         0x01U           ///< Tween starts over from its first value when it ends
+
+
+typedef enum {
+    seMDC_ANIM_X = 0,                   ///< Destination X of the sprite pivot
+    seMDC_ANIM_Y,                       ///< Destination Y of the sprite pivot
+    seMDC_ANIM_ROT,                     ///< rotval, 512 for a full turn clockwise, drawn modulo 512
+    seMDC_ANIM_SCALE,                   ///< Scale in 1/256
+    seMDC_ANIM_NUMPROPS
+} seMDC_ANIM_PROP;
+
+typedef enum {
+    seMDC_ANIM_LINEAR = 0U,
+    seMDC_ANIM_EASEIN,                  ///< Starts slowly, quadratic
+    seMDC_ANIM_EASEOUT,                 ///< Ends slowly, quadratic
+    seMDC_ANIM_EASEINOUT                ///< Starts and ends slowly, smoothstep
+} seMDC_ANIM_EASE;
+
+/**
+  * @brief  Tween of one property, set by seMDC_ANIM_Start().
+  */
+typedef struct {
+    int32_t  from;
+    int32_t  to;
+    uint64_t startns;                   ///< Slot time of the first value
+    uint32_t durms;
+    uint8_t  ease;                      ///< A value of seMDC_ANIM_EASE
+    uint8_t  flags;                     ///< Combination of seMDC_ANIM_LOOP
+    uint8_t  active;                    ///< 1 while running, 2 until its first frame
+} seMDC_ANIM_Tween;
+
+typedef struct seMDC_ANIM_Object seMDC_ANIM_Object;
+
+/**
+  * @brief  Animated sprite, owned by the caller and linked in while added.
+  */
+struct seMDC_ANIM_Object {
+    seMDC_GFX_Sprite *sprite;           ///< Loaded sprite, its scale is set from seMDC_ANIM_SCALE
+    int32_t  value[seMDC_ANIM_NUMPROPS];///< Properties, set before seMDC_ANIM_Add() and at any time
+    seMDC_ANIM_Tween tween[seMDC_ANIM_NUMPROPS];
+    // Set by the scheduler
+    int32_t  shown[seMDC_ANIM_NUMPROPS];///< Properties last drawn
+    int16_t  oldleft;                   ///< Box erased in the current frame
+    int16_t  oldtop;
+    int16_t  oldright;
+    int16_t  oldbottom;
+    uint8_t  changed;                   ///< Current frame: 1 moved or new, 2 drawn again as it was covered
+    seMDC_ANIM_Object *next;
+};
+
+/**
+  * @brief  Frame counters since seMDC_ANIM_Init().
+  */
+typedef struct {
+    uint32_t frames;                    ///< Frames drawn
+    uint32_t dropped;                   ///< Slots skipped by late frames
+    uint32_t fps_x100;                  ///< Frames drawn per second from the first frame to the last, times 100
+    uint32_t period_us;                 ///< Frame period
+} seMDC_ANIM_Stats;
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+  * @brief  Start with no objects and clear the counters.
+  * @param  bg:  background the sprites are erased from, kept by reference
+  * @param  fps:  target frame rate, see seMDC_ANIM_SetRate()
+  * @retval Status: seSTATUS_NG if fps is 0
+  */
+seStatus seMDC_ANIM_Init( const seMDC_GFX_SpriteBg *bg, uint16_t fps );
+
+/**
+  * @brief  Derive the frame period from a target rate and the VCOM divider in
+  *         MDC_DISPVCOMDIV. Call again after seMDC_VCOMChangeDivider().
+  * @retval Status: seSTATUS_NG if fps is 0
+  */
+seStatus seMDC_ANIM_SetRate( uint16_t fps );
+
+/**
+  * @brief  Put an object on top. It is drawn at the next frame.
+  * @param  obj:  sprite and value set, no tween running
+  */
+void seMDC_ANIM_Add( seMDC_ANIM_Object *obj );
+
+/**
+  * @brief  Erase an object and take it out. The objects it covered are drawn
+  *         again and its rows updated at the next frame.
+  */
+seStatus seMDC_ANIM_Remove( seMDC_ANIM_Object *obj );
+
+/**
+  * @brief  Tween a property from its current value, starting at the next frame.
+  * @param  obj:  object
+  * @param  prop:  property
+  * @param  to:  value at the end
+  * @param  durms:  duration, 0 jumps to the value at the next frame
+  * @param  ease:  speed curve
+  * @param  flags:  combination of seMDC_ANIM_LOOP
+  */
+void seMDC_ANIM_Start( seMDC_ANIM_Object *obj, seMDC_ANIM_PROP prop, int32_t to, uint32_t durms,
+                       seMDC_ANIM_EASE ease, uint8_t flags );
+
+/**
+  * @brief  Stop the tween of a property, keeping its current value.
+  */
+void seMDC_ANIM_Stop( seMDC_ANIM_Object *obj, seMDC_ANIM_PROP prop );
+
+/**
+  * @brief  Non-zero while a tween without seMDC_ANIM_LOOP runs.
+  */
+int seMDC_ANIM_Running( void );
+
+/**
+  * @brief  Wait for the next frame slot, dropping the slots already passed,
+  *         then draw the frame and request the panel update of its rows.
+  * @retval Status: can be a value of @ref seStatus
+  */
+seStatus seMDC_ANIM_Frame( void );
+
+/**
+  * @brief  Frame counters.
+  */
+void seMDC_ANIM_GetStats( seMDC_ANIM_Stats *stats );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SEMDC_ANIM_H */
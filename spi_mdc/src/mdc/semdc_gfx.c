@@ -17,6 +17,7 @@
 
 #include "s1d13c00_hcl.h"
 #include "s1d13c00_memregs.h"
+#include "s1d13c00_trace.h"
 #include "se_common.h"
 #include "se_mdc.h"
 #include "se_dmac.h"
@@ -172,11 +173,13 @@ const static uint32_t sinlut[129] = {
   */
 seStatus seMDC_GFX_Rotval2XY ( int16_t centerx, int16_t centery, uint16_t radius, uint16_t rotval,
                                uint16_t *xval, uint16_t *yval ) {
+    seTRACE_API();
 
   long x, y;
   unsigned long dx, dy;
-  long gfxOWidth = seS1D13C00Read16( MDC_GFXOWIDTH );
-  long gfxOHeight = seS1D13C00Read16( MDC_GFXOHEIGHT );
+  uint16_t gfxOWidth, gfxOHeight;
+
+  seMDC_GetDestWindowSize( &gfxOWidth, &gfxOHeight );
 
   if (rotval <= 15)
       rotval = ((15-rotval)*512)/60;
@@ -252,6 +255,7 @@ seStatus seMDC_GFX_Rotval2XY ( int16_t centerx, int16_t centery, uint16_t radius
 seStatus seMDC_GFX_ClockLine ( int16_t centerx, int16_t centery, uint16_t radius1, uint16_t radius2,
                                uint8_t timeangle, uint16_t linecolor, uint16_t linethickness )
 {
+    seTRACE_API();
     uint16_t x1, y1, x2, y2;
     seStatus fResult;
 
@@ -275,6 +279,7 @@ seStatus seMDC_GFX_ClockLine ( int16_t centerx, int16_t centery, uint16_t radius
   */
 seStatus seMDC_GFX_DrawClockTicks ( seMDC_GFX_ClockTicksStruct *clockticks )
 {
+    seTRACE_API();
     uint8_t odd, timeangle, startangle, endangle;
     uint16_t center, xc, yc, xc1, yc1, radius1, radius2, linecolor, linethickness;
 
@@ -399,6 +404,7 @@ seStatus seMDC_GFX_DrawClockTicks ( seMDC_GFX_ClockTicksStruct *clockticks )
 seStatus seMDC_GFX_DrawLine( uint16_t point1x, uint16_t point1y, uint16_t point2x, uint16_t point2y,
                              uint16_t pencolor, uint16_t thickness, uint8_t roundtips )
 {
+    seTRACE_API();
     seStatus fResult;
 
     fResult = seMDC_DrawLine(point1x, point1y, point2x, point2y, pencolor, thickness);
@@ -433,6 +439,7 @@ seStatus seMDC_GFX_DrawDHLine( uint16_t point1x, uint16_t point1y, uint16_t poin
                                uint16_t pencolor, uint16_t thickness,
                                uint16_t dashlen, uint16_t blanklen )
 {
+    seTRACE_API();
   seStatus fResult;
   uint32_t start, end;
 
@@ -481,6 +488,7 @@ seStatus seMDC_GFX_DrawDVLine( uint16_t point1x, uint16_t point1y, uint16_t poin
                                uint16_t pencolor, uint16_t thickness,
                                uint16_t dashlen, uint16_t blanklen )
 {
+    seTRACE_API();
   seStatus fResult;
   uint32_t start, end;
 
@@ -600,6 +608,7 @@ static int32_t isigma;
 seStatus seMDC_GFX_DrawArc ( uint16_t centerx, uint16_t centery, uint16_t radius, uint16_t thickness,
                              uint16_t startangle0, uint16_t endangle0, uint16_t pencolor)
 {
+    seTRACE_API();
     uint32_t iradius;                            // inner radius
     uint32_t startangle, endangle;
     uint32_t q1draw, q2draw, q3draw, q4draw;      // Quadrant draw enable:
@@ -1555,6 +1564,7 @@ seStatus seMDC_GFX_DrawArc ( uint16_t centerx, uint16_t centery, uint16_t radius
 seStatus seMDC_GFX_DrawDArc ( uint16_t centerx, uint16_t centery, uint16_t radius, uint16_t thickness,
                               uint16_t startangle, uint16_t endangle, uint16_t pencolor, uint16_t dashang, uint16_t blankang)
 {
+    seTRACE_API();
     seStatus fResult = seSTATUS_OK;
     uint32_t start, end, endangle1;
 
@@ -1585,131 +1595,607 @@ seStatus seMDC_GFX_DrawDArc ( uint16_t centerx, uint16_t centery, uint16_t radiu
 
 
 
+//---------------------------------------------------------------------------
+// Filled polygon state
+//   Transformed vertices, the crossings of the current row and the spans
+//   still open: a span that repeats on the next row grows its rectangle
+//   instead of starting a new one.
+//---------------------------------------------------------------------------
+#define POLY_COORD_MAX          16383   // Transformed coordinates, keeps the crossing products in 31 bits
+
+static int16_t polyx[seMDC_GFX_POLYGON_MAXFILL];
+static int16_t polyy[seMDC_GFX_POLYGON_MAXFILL];
+static int16_t polyxs[seMDC_GFX_POLYGON_MAXFILL];                  // Crossings of one row
+typedef struct {
+    int16_t x0;
+    int16_t x1;
+    int16_t y0;                                                     // First row of the rectangle
+} PolygonSpan;
+static PolygonSpan polyopen[seMDC_GFX_POLYGON_MAXFILL / 2];        // Open rectangles, left to right
+static PolygonSpan polynext[seMDC_GFX_POLYGON_MAXFILL / 2];
+
+
+//---------------------------------------------------------------------------
+// PRIVATE FUNCTION: GfxSinCos()
+//   Sine and cosine * 65536 of a rotation in 512ths of a turn.
+//---------------------------------------------------------------------------
+static void GfxSinCos( uint16_t rotval, int32_t *sinval, int32_t *cosval )
+{
+    rotval &= 511;
+    if (rotval < 128)
+    {
+        *cosval = sinlut[128-rotval];
+        *sinval = sinlut[rotval];
+    }
+    else if (rotval < 256)
+    {
+        *cosval = -sinlut[rotval-128];
+        *sinval = sinlut[256-rotval];
+    }
+    else if (rotval < 384)
+    {
+        *cosval = -sinlut[384-rotval];
+        *sinval = -sinlut[rotval-256];
+    }
+    else
+    {
+        *cosval = sinlut[rotval-384];
+        *sinval = -sinlut[512-rotval];
+    }
+}
+
+
+//---------------------------------------------------------------------------
+// PRIVATE FUNCTION: PolygonPoint()
+//   Scale, rotate and place point k, rounding half away from zero after each
+//   step, so that shapes symmetric about the center stay symmetric.
+//---------------------------------------------------------------------------
+static void PolygonPoint( const seMDC_GFX_PolygonStruct *polygon, uint16_t k, int32_t sinval, int32_t cosval,
+                          int32_t *xcoord, int32_t *ycoord )
+{
+    int32_t x, y, xtmp, ytmp;
+
+    // Calculate scaled coordinates
+    x = polygon->points[k].xcoord * polygon->scaleval;
+    x = (x < 0) ? -((128 - x) >> 8) : (x + 128) >> 8;
+    y = polygon->points[k].ycoord * polygon->scaleval;
+    y = (y < 0) ? -((128 - y) >> 8) : (y + 128) >> 8;
+
+    // Calculate rotated coordinates
+    xtmp = (x * cosval) - (y * sinval);
+    ytmp = (x * sinval) + (y * cosval);
+    xtmp = (xtmp < 0) ? -((32768 - xtmp) >> 16) : (xtmp + 32768) >> 16;
+    ytmp = (ytmp < 0) ? -((32768 - ytmp) >> 16) : (ytmp + 32768) >> 16;
+
+    // Center adjustment
+    *xcoord = polygon->centerx + xtmp;
+    *ycoord = polygon->centery - ytmp;
+}
+
+
+//---------------------------------------------------------------------------
+// PRIVATE FUNCTION: PolygonCeilDiv()
+//   Smallest integer >= num/den, den > 0.
+//---------------------------------------------------------------------------
+static int32_t PolygonCeilDiv( int32_t num, int32_t den )
+{
+    return (num >= 0) ? (num + den - 1) / den : -((-num) / den);
+}
+
+
+//---------------------------------------------------------------------------
+// PRIVATE FUNCTION: PolygonRect()
+//   Fill one rectangle, waiting for the previous one first. The next row is
+//   worked out while the engine draws. Only the first rectangle sets up the
+//   engine, the others write their corners.
+//---------------------------------------------------------------------------
+static seStatus PolygonRect( int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint16_t pencolor, uint8_t *busy )
+{
+    if (*busy)
+    {
+        seMDC_WaitGfxDone();
+        return seMDC_FillRectangleNext( (uint16_t)x0, (uint16_t)y0, (uint16_t)x1, (uint16_t)y1 );
+    }
+    *busy = 1;
+    return seMDC_DrawRectangle( (uint16_t)x0, (uint16_t)y0, (uint16_t)x1, (uint16_t)y1, pencolor, 0, 0, FILL_ENABLE );
+}
+
+
+//---------------------------------------------------------------------------
+// PRIVATE FUNCTION: PolygonFill()
+//   Scanline fill of the transformed vertices, even-odd rule. Pixel (x, y)
+//   is inside if its center is: rows and columns are taken from the top
+//   and left edges up to but not including the bottom and right edges, so
+//   a rectangle of w by h pixels is filled w by h.
+//---------------------------------------------------------------------------
+static seStatus PolygonFill( uint16_t n, uint16_t pencolor )
+{
+    seStatus fResult = seSTATUS_OK;
+    uint16_t owidth, oheight;
+    int32_t ymin = polyy[0], ymax = polyy[0];
+    int32_t y, x0, x1, x, t;
+    uint16_t k, j, top, bot, nxs, nopen, nnext, o;
+    uint8_t busy = 0;
+
+    seMDC_GetDestWindowSize( &owidth, &oheight );
+    for (k = 1; k < n; k++)
+    {
+        if (polyy[k] < ymin)
+            ymin = polyy[k];
+        if (polyy[k] > ymax)
+            ymax = polyy[k];
+    }
+    if (ymin < 0)
+        ymin = 0;
+    if (ymax > oheight)
+        ymax = oheight;
+
+    nopen = 0;
+    for (y = ymin; y <= ymax; y++)
+    {
+        // Crossings of the edges that span row y, top inclusive, bottom exclusive
+        nxs = 0;
+        if (y < ymax)
+        {
+            for (k = 0; k < n; k++)
+            {
+                j = (k + 1 < n) ? k + 1 : 0;
+                if ((polyy[k] <= y) == (polyy[j] <= y))
+                    continue;
+                top = (polyy[k] < polyy[j]) ? k : j;
+                bot = (top == k) ? j : k;
+                // Column of the first pixel center right of the crossing
+                x = polyx[top] + PolygonCeilDiv( (y - polyy[top]) * (polyx[bot] - polyx[top]), polyy[bot] - polyy[top] );
+                for (t = nxs; t > 0 && polyxs[t-1] > x; t--)
+                    polyxs[t] = polyxs[t-1];
+                polyxs[t] = (int16_t)x;
+                nxs++;
+            }
+        }
+
+        // Open rectangles with the same span on this row grow, the others are filled
+        nnext = 0;
+        o = 0;
+        for (k = 0; k + 1 < nxs; k += 2)
+        {
+            x0 = (polyxs[k] < 0) ? 0 : polyxs[k];
+            x1 = ((polyxs[k+1] > owidth) ? owidth : polyxs[k+1]) - 1;
+            if (x0 > x1)
+                continue;                                           // Empty or outside the window
+            while (o < nopen && (polyopen[o].x0 < x0 || (polyopen[o].x0 == x0 && polyopen[o].x1 != x1)))
+            {
+                fResult = PolygonRect( polyopen[o].x0, polyopen[o].y0, polyopen[o].x1, y - 1, pencolor, &busy );
+                o++;
+            }
+            if (o < nopen && polyopen[o].x0 == x0)
+            {
+                polynext[nnext++] = polyopen[o++];
+            }
+            else
+            {
+                polynext[nnext].x0 = (int16_t)x0;
+                polynext[nnext].x1 = (int16_t)x1;
+                polynext[nnext].y0 = (int16_t)y;
+                nnext++;
+            }
+        }
+        while (o < nopen)
+        {
+            fResult = PolygonRect( polyopen[o].x0, polyopen[o].y0, polyopen[o].x1, y - 1, pencolor, &busy );
+            o++;
+        }
+        memcpy(polyopen, polynext, nnext * sizeof(PolygonSpan));
+        nopen = nnext;
+        if (fResult != seSTATUS_OK)
+            break;
+    }
+
+    if (busy)
+        seMDC_WaitGfxDone();
+    return fResult;
+}
+
+
+
 /**
-  * Draw a polygon outline.
+  * Draw a polygon outline, or fill it if fillenable is set.
   * Parameters:
   *         polygon:   pointer to polygon parameters structure
   * Return value:  Status
   */
 seStatus seMDC_GFX_DrawPolygon ( seMDC_GFX_PolygonStruct *polygon )
 {
+    seTRACE_API();
     seStatus fResult = seSTATUS_OK;
     uint16_t k;
-    int32_t xcoord1, ycoord1, xcoord2, ycoord2, xcoordtmp, ycoordtmp;
+    int32_t xcoord1, ycoord1, xcoord2, ycoord2, xcoord0, ycoord0;
     int32_t sinval, cosval;
-    uint16_t rotval;
 
-    for (k = 0; k < polygon->numpoints; k++)
-    {
-        // Calculate scaled coordinates
-        xcoord1 = polygon->points[k].xcoord;
-        xcoord1 = (xcoord1*polygon->scaleval);
-        if (xcoord1 < 0)
-            xcoord1 -= 128;
-        else
-            xcoord1 += 128;
-        xcoord1 = (xcoord1 >> 8);
+    if (polygon->numpoints == 0)
+        return seSTATUS_OK;
 
-        ycoord1 = polygon->points[k].ycoord;
-        ycoord1 = (ycoord1*polygon->scaleval);
-        if (ycoord1 < 0)
-            ycoord1 -= 128;
-        else
-            ycoord1 += 128;
-        ycoord1 = (ycoord1 >> 8);
+    GfxSinCos(polygon->rotval, &sinval, &cosval);
 
-        if (k < (polygon->numpoints-1))
+    if (polygon->fillenable)
+    {
+        if (polygon->numpoints > seMDC_GFX_POLYGON_MAXFILL)
+            return seSTATUS_NG;
+        for (k = 0; k < polygon->numpoints; k++)
         {
-            xcoord2 = polygon->points[k+1].xcoord;
-            ycoord2 = polygon->points[k+1].ycoord;
+            PolygonPoint(polygon, k, sinval, cosval, &xcoord1, &ycoord1);
+            if ((xcoord1 < -POLY_COORD_MAX) || (xcoord1 > POLY_COORD_MAX) ||
+                (ycoord1 < -POLY_COORD_MAX) || (ycoord1 > POLY_COORD_MAX))
+                return seSTATUS_NG;
+            polyx[k] = (int16_t)xcoord1;
+            polyy[k] = (int16_t)ycoord1;
         }
+        return PolygonFill(polygon->numpoints, polygon->pencolor);
+    }
+
+    // Each point is transformed once and ends one edge and starts the next
+    PolygonPoint(polygon, 0, sinval, cosval, &xcoord0, &ycoord0);
+    xcoord1 = xcoord0;
+    ycoord1 = ycoord0;
+    for (k = 0; k < polygon->numpoints; k++)
+    {
+        if (k < (polygon->numpoints-1))
+            PolygonPoint(polygon, k+1, sinval, cosval, &xcoord2, &ycoord2);
         else
         {
-            xcoord2 = polygon->points[0].xcoord;
-            ycoord2 = polygon->points[0].ycoord;
+            xcoord2 = xcoord0;
+            ycoord2 = ycoord0;
         }
 
-        xcoord2 = (xcoord2*polygon->scaleval);
-        if (xcoord2 < 0)
-            xcoord2 -= 128;
-        else
-            xcoord2 += 128;
-        xcoord2 = (xcoord2 >> 8);
+        fResult = seMDC_GFX_DrawLine(xcoord1, ycoord1, xcoord2, ycoord2,
+                                     polygon->pencolor, polygon->thickness, 1);   // Waits for completion
+        if (fResult != seSTATUS_OK)
+            break;
 
-        ycoord2 = (ycoord2*polygon->scaleval);
-        if (ycoord2 < 0)
-            ycoord2 -= 128;
-        else
-            ycoord2 += 128;
-        ycoord2 = (ycoord2 >> 8);
+        xcoord1 = xcoord2;
+        ycoord1 = ycoord2;
+    }
 
-        // Calculate rotated coordinates
-        rotval = polygon->rotval;
-        if (rotval < 128)
-        {
-            cosval = sinlut[128-rotval];
-            sinval = sinlut[rotval];
-        }
-        else if (polygon->rotval < 256)
-        {
-            cosval = -sinlut[rotval-128];
-            sinval = sinlut[256-rotval];
-        }
-        else if (polygon->rotval < 384)
-        {
-            cosval = -sinlut[384-rotval];
-            sinval = -sinlut[rotval-256];
-        }
-        else
-        {
-            cosval = sinlut[rotval-384];
-            sinval = -sinlut[512-rotval];
-        }
+    return fResult;
+}
 
-        xcoordtmp = (xcoord1 * cosval) - (ycoord1 * sinval);
-        ycoordtmp = (xcoord1 * sinval) + (ycoord1 * cosval);
-        if (xcoordtmp < 1)
-            xcoordtmp -= 32768;
-        else
-            xcoordtmp += 32768;
-        xcoord1 = xcoordtmp >> 16;
 
-        if (ycoordtmp < 1)
-            ycoordtmp -= 32768;
-        else
-            ycoordtmp += 32768;
-        ycoord1 = ycoordtmp >> 16;
 
-        xcoordtmp = (xcoord2 * cosval) - (ycoord2 * sinval);
-        ycoordtmp = (xcoord2 * sinval) + (ycoord2 * cosval);
-        if (xcoordtmp < 1)
-            xcoordtmp -= 32768;
-        else
-            xcoordtmp += 32768;
-        xcoord2 = xcoordtmp >> 16;
+/**
+  * Copy a sprite bitmap from host memory to controller memory.
+  * Parameters:
+  *         sprite:   sprite, width and height set. baseaddr is set to addr.
+  *         addr:     controller RAM address
+  *         bitmap:   1-bit bitmap, seMDC_GFX_SPRITE_ROWBYTES(width) bytes per row
+  * Return value:  Status
+  */
+seStatus seMDC_GFX_SpriteLoad ( seMDC_GFX_Sprite *sprite, uint32_t addr, const uint8_t *bitmap )
+{
+    seTRACE_API();
+
+    if ((sprite->width == 0) || (sprite->height == 0))
+        return seSTATUS_NG;
+
+    seS1D13C00Write(addr, (uint8_t *)bitmap, (uint32_t)seMDC_GFX_SPRITE_ROWBYTES(sprite->width) * sprite->height);
+    sprite->baseaddr = addr;
+    sprite->drawn = 0;
+    return seSTATUS_OK;
+}
+
+
+
+/**
+  * Draw a sprite rotated about its pivot with one bitmap copy. Clear bits
+  * are transparent.
+  * Parameters:
+  *         sprite:   sprite
+  *         x, y:     destination of the pivot
+  *         rotval:   rotation, 0 to 511 for a full turn clockwise
+  * Return value:  Status
+  */
+seStatus seMDC_GFX_SpriteDraw ( seMDC_GFX_Sprite *sprite, int16_t x, int16_t y, uint16_t rotval )
+{
+    seTRACE_API();
+    seMDC_ImgCopyRotScaleCtrl ctrl;
+    seStatus fResult;
+    int32_t sinval, cosval, ex, ey, k;
+    int64_t ox, oy, minx = 0, maxx = 0, miny = 0, maxy = 0;
+    const int64_t den = 65536 * 256;
+
+    if ((sprite->width == 0) || (sprite->height == 0) || (sprite->scale == 0))
+        return seSTATUS_NG;
+
+    // Box of the transformed corners, as the engine walks it, for seMDC_GFX_SpriteErase()
+    GfxSinCos(rotval, &sinval, &cosval);
+    for (k = 0; k < 4; k++)
+    {
+        ex = ((k & 1) ? sprite->width : 0) - sprite->pivotx;
+        ey = ((k & 2) ? sprite->height : 0) - sprite->pivoty;
+        ox = ((int64_t)cosval * ex - (int64_t)sinval * ey) * sprite->scale;
+        oy = ((int64_t)sinval * ex + (int64_t)cosval * ey) * sprite->scale;
+        if ((k == 0) || (ox < minx))
+            minx = ox;
+        if ((k == 0) || (ox > maxx))
+            maxx = ox;
+        if ((k == 0) || (oy < miny))
+            miny = oy;
+        if ((k == 0) || (oy > maxy))
+            maxy = oy;
+    }
+    sprite->left = (int16_t)(x + ((minx >= 0) ? minx / den : -((den - 1 - minx) / den)) - 1);
+    sprite->right = (int16_t)(x + ((maxx >= 0) ? (maxx + den - 1) / den : -((-maxx) / den)) + 1);
+    sprite->top = (int16_t)(y + ((miny >= 0) ? miny / den : -((den - 1 - miny) / den)) - 1);
+    sprite->bottom = (int16_t)(y + ((maxy >= 0) ? (maxy + den - 1) / den : -((-maxy) / den)) + 1);
+    sprite->drawn = 1;
+
+    ctrl.ctrlword = 0;
+    ctrl.ctrlword_b.bitmapen = 1;
+    ctrl.ctrlword_b.bitmapfmt = seMDC_BITMAP_1BIT;
+    fResult = seMDC_ImgCpyRotScale((uint16_t)x, (uint16_t)y, sprite->baseaddr,
+                                   sprite->width, sprite->width, sprite->height, sprite->pivotx, sprite->pivoty,
+                                   sprite->color, rotval & 511,
+                                   sprite->scale, sprite->scale, sprite->scale, sprite->scale, &ctrl);
+    seMDC_WaitGfxDone();
+    return fResult;
+}
+
+
+
+/**
+  * Restore the background under the sprite as last drawn, with one image
+  * copy from the background.
+  * Parameters:
+  *         sprite:   sprite
+  *         bg:       background image in controller memory
+  * Return value:  Status
+  */
+seStatus seMDC_GFX_SpriteErase ( seMDC_GFX_Sprite *sprite, const seMDC_GFX_SpriteBg *bg )
+{
+    seTRACE_API();
+    seMDC_ImgCopyRotScaleCtrl ctrl;
+    seStatus fResult;
+    int32_t x0, y0, x1, y1;
+
+    if (!sprite->drawn)
+        return seSTATUS_OK;
+    sprite->drawn = 0;
+
+    // Clip to the background
+    x0 = (sprite->left > bg->left) ? sprite->left : bg->left;
+    y0 = (sprite->top > bg->top) ? sprite->top : bg->top;
+    x1 = (sprite->right < bg->left + bg->width - 1) ? sprite->right : bg->left + bg->width - 1;
+    y1 = (sprite->bottom < bg->top + bg->height - 1) ? sprite->bottom : bg->top + bg->height - 1;
+    if ((x0 > x1) || (y0 > y1))
+        return seSTATUS_OK;
+
+    ctrl.ctrlword = 0;
+    fResult = seMDC_ImgCpyRotScale((uint16_t)x0, (uint16_t)y0,
+                                   bg->baseaddr + (uint32_t)(y0 - bg->top) * bg->stride + (uint32_t)(x0 - bg->left),
+                                   bg->stride, (uint16_t)(x1 - x0 + 1), (uint16_t)(y1 - y0 + 1), 0, 0,
+                                   0, 0, 256, 256, 256, 256, &ctrl);
+    seMDC_WaitGfxDone();
+    return fResult;
+}
+
+
+
+//---------------------------------------------------------------------------
+// Dash pattern state
+//   Bitmap rows are built on the host and written to controller RAM a
+//   buffer at a time.
+//---------------------------------------------------------------------------
+static uint8_t dashbuf[seMDC_GFX_DASH_BUFSIZE];
+static uint32_t dashaddr;                                       // Where dashbuf goes
+static uint32_t dashfill;                                       // Bytes in dashbuf
+
+
+//---------------------------------------------------------------------------
+// PRIVATE FUNCTION: DashRow()
+//   Room for the next row of rowbytes bytes, cleared. The buffer is written
+//   out first if the row does not fit.
+//---------------------------------------------------------------------------
+static uint8_t *DashRow( uint32_t rowbytes )
+{
+    uint8_t *row;
+
+    if (dashfill + rowbytes > sizeof(dashbuf))
+    {
+        seS1D13C00Write(dashaddr, dashbuf, dashfill);
+        dashaddr += dashfill;
+        dashfill = 0;
+    }
+    row = &dashbuf[dashfill];
+    dashfill += rowbytes;
+    memset(row, 0, rowbytes);
+    return row;
+}
+
+
+//---------------------------------------------------------------------------
+// PRIVATE FUNCTION: DashFlush()
+//---------------------------------------------------------------------------
+static void DashFlush( void )
+{
+    if (dashfill != 0)
+        seS1D13C00Write(dashaddr, dashbuf, dashfill);
+    dashfill = 0;
+}
 
-        if (ycoordtmp < 1)
-            ycoordtmp -= 32768;
+
+//---------------------------------------------------------------------------
+// PRIVATE FUNCTION: DashOn()
+//   Whether position pos of span is in a dash: dashes of dash units start
+//   every period units from 0, up to but not including span, and the last
+//   one ends at span.
+//---------------------------------------------------------------------------
+static uint8_t DashOn( uint32_t pos, uint32_t span, uint32_t dash, uint32_t period )
+{
+    return (pos <= span) && ((pos % period) < dash) && ((pos - pos % period) < span);
+}
+
+
+//---------------------------------------------------------------------------
+// PRIVATE FUNCTION: DashAngle()
+//   Angle of pixel offset (dx, dy) from the center, in 512ths of a turn
+//   clockwise from up, rounded down. Not defined for (0, 0).
+//---------------------------------------------------------------------------
+static uint32_t DashAngle( int32_t dx, int32_t dy )
+{
+    uint32_t quad, p, q, lo, hi, mid;
+
+    // Distance along the quadrant's first axis and towards the next one
+    if ((dy < 0) && (dx >= 0))
+    {
+        quad = 0;   q = -dy;  p = dx;
+    }
+    else if ((dx > 0) && (dy >= 0))
+    {
+        quad = 128; q = dx;   p = dy;
+    }
+    else if ((dy > 0) && (dx <= 0))
+    {
+        quad = 256; q = dy;   p = -dx;
+    }
+    else
+    {
+        quad = 384; q = -dx;  p = -dy;
+    }
+
+    // Largest k below 128 with tan(k) <= p/q
+    lo = 0;
+    hi = 127;
+    while (lo < hi)
+    {
+        mid = (lo + hi + 1) >> 1;
+        if (sinlut[mid] * q <= sinlut[128-mid] * p)
+            lo = mid;
         else
-            ycoordtmp += 32768;
-        ycoord2 = ycoordtmp >> 16;
+            hi = mid - 1;
+    }
+    return quad + lo;
+}
 
-        // Center adjustment
-        xcoord1 = polygon->centerx + xcoord1;
-        ycoord1 = polygon->centery - ycoord1;
-        xcoord2 = polygon->centerx + xcoord2;
-        ycoord2 = polygon->centery - ycoord2;
 
-        if (fResult == seSTATUS_OK) {
-            fResult = seMDC_GFX_DrawLine(xcoord1, ycoord1, xcoord2, ycoord2,
-                                   polygon->pencolor, polygon->thickness, 1);
-            seMDC_WaitGfxDone();
+
+/**
+  * Build a straight dashed line as a 1-bit sprite in controller RAM. Drawn
+  * with seMDC_GFX_SpriteDraw() at the first point, it gives the pixels of
+  * seMDC_GFX_DrawDHLine() or seMDC_GFX_DrawDVLine() with one bitmap copy.
+  * The pen spans the rows or columns the engine's line pen covers.
+  * Parameters:
+  *         dash:       sprite, color set by the caller. The rest is set here.
+  *         addr:       controller RAM address, seMDC_GFX_SPRITE_BYTES() of
+  *                     length by thickness, or thickness by length if vertical
+  *         length:     pixels from the first to the last point, inclusive
+  *         thickness:  line thickness
+  *         dashlen:    length of dash in pixels
+  *         blanklen:   length of blank in pixels
+  *         vertical:   the line goes down instead of right
+  * Return value:  Status
+  */
+seStatus seMDC_GFX_DashLineLoad ( seMDC_GFX_Sprite *dash, uint32_t addr, uint16_t length, uint16_t thickness,
+                                  uint16_t dashlen, uint16_t blanklen, uint8_t vertical )
+{
+    seTRACE_API();
+    uint32_t rowbytes, x, y, t;
+    uint8_t *row;
+
+    t = (thickness != 0) ? thickness : 1;
+    if ((length == 0) || (dashlen == 0))
+        return seSTATUS_NG;
+
+    dash->width = (uint16_t)(vertical ? t : length);
+    dash->height = (uint16_t)(vertical ? length : t);
+    dash->pivotx = (uint16_t)(vertical ? (t - 1) / 2 : 0);
+    dash->pivoty = (uint16_t)(vertical ? 0 : (t - 1) / 2);
+    dash->scale = 256;
+    rowbytes = seMDC_GFX_SPRITE_ROWBYTES(dash->width);
+    if (rowbytes > sizeof(dashbuf))
+        return seSTATUS_NG;
+
+    dashaddr = addr;
+    dashfill = 0;
+    for (y = 0; y < dash->height; y++)
+    {
+        row = DashRow(rowbytes);
+        for (x = 0; x < dash->width; x++)
+        {
+            if (DashOn(vertical ? y : x, length - 1, dashlen, (uint32_t)dashlen + blanklen))
+                row[x >> 3] |= 0x80 >> (x & 7);
         }
-        else
-            break;
-  }
+    }
+    DashFlush();
 
-  return fResult;
+    dash->baseaddr = addr;
+    dash->drawn = 0;
+    return seSTATUS_OK;
+}
+
+
+
+/**
+  * Build a dashed arc as a 1-bit sprite in controller RAM, drawn with
+  * seMDC_GFX_SpriteDraw() at the center with one bitmap copy. The ring is
+  * the pixels from radius - thickness to radius, as seMDC_GFX_DrawArc()
+  * draws it, each circle taken half a pixel out. Dashes are as in
+  * seMDC_GFX_DrawDArc().
+  * Parameters:
+  *         dash:       sprite, color set by the caller. The rest is set here.
+  *         addr:       controller RAM address, seMDC_GFX_SPRITE_BYTES() of
+  *                     2 * radius + 1 by 2 * radius + 1
+  *         radius:     outer radius
+  *         thickness:  thickness, inner radius = radius - thickness
+  *         startangle: start angle, 0 to 511 for a full circle clockwise from up
+  *         endangle:   end angle, 0 to 511
+  *         dashang:    dash angle segments in angle units
+  *         blankang:   blank angle segments in angle units
+  * Return value:  Status
+  */
+seStatus seMDC_GFX_DashArcLoad ( seMDC_GFX_Sprite *dash, uint32_t addr, uint16_t radius, uint16_t thickness,
+                                 uint16_t startangle, uint16_t endangle, uint16_t dashang, uint16_t blankang )
+{
+    seTRACE_API();
+    uint32_t rowbytes, span, side, rin, x;
+    int32_t dx, dy, d2, out2, in2;
+    uint8_t *row;
+
+    if ((startangle > 511) || (endangle > 511) || (dashang == 0) || (thickness > radius))
+        return seSTATUS_NG;
+
+    side = 2 * (uint32_t)radius + 1;
+    rowbytes = seMDC_GFX_SPRITE_ROWBYTES(side);
+    if ((side > 0xFFFF) || (rowbytes > sizeof(dashbuf)))
+        return seSTATUS_NG;
+    dash->width = (uint16_t)side;
+    dash->height = (uint16_t)side;
+    dash->pivotx = radius;
+    dash->pivoty = radius;
+    dash->scale = 256;
+
+    span = (startangle > endangle) ? endangle + 512 - startangle : endangle - startangle;
+    rin = radius - thickness;
+    out2 = (int32_t)radius * radius + radius;
+    in2 = (rin != 0) ? (int32_t)(rin * rin - rin) : -1;                  // Within rin - 1, half a pixel out
+
+    dashaddr = addr;
+    dashfill = 0;
+    for (dy = -(int32_t)radius; dy <= (int32_t)radius; dy++)
+    {
+        row = DashRow(rowbytes);
+        for (x = 0; x < side; x++)
+        {
+            dx = (int32_t)x - radius;
+            d2 = dx * dx + dy * dy;
+            if ((d2 > out2) || (d2 <= in2))
+                continue;
+            if (DashOn((DashAngle(dx, dy) + 512 - startangle) & 511, span, dashang, (uint32_t)dashang + blankang))
+                row[x >> 3] |= 0x80 >> (x & 7);
+        }
+    }
+    DashFlush();
+
+    dash->baseaddr = addr;
+    dash->drawn = 0;
+    return seSTATUS_OK;
 }
 
 
@@ -1848,6 +2334,199 @@ uint16_t utf8strlen ( char *textstr )
 
 
 
+//---------------------------------------------------------------------------
+// Font metric cache
+//   Descriptors of external fonts, read from serial flash in one DMAC burst
+//   on first use and kept on the host.
+//---------------------------------------------------------------------------
+typedef struct {
+    const seMDC_GFX_FontStruct *font;                           // NULL when free
+    uint32_t first;                                             // charstbl index of chars[0]
+    uint32_t count;
+    seMDC_GFX_FontChar chars[seMDC_GFX_FONTCACHE_CHARS];
+} FontCacheEntry;
+
+static FontCacheEntry fontcache[seMDC_GFX_FONTCACHE_FONTS];
+static uint32_t fontcachenext;                                  // Entry replaced next
+
+
+//---------------------------------------------------------------------------
+// PRIVATE FUNCTION: FontCacheFill()
+//   Read count descriptors from index first of an external font through the
+//   controller RAM at bufaddr, into the entry of the font or the next one.
+//---------------------------------------------------------------------------
+static FontCacheEntry *FontCacheFill( const seMDC_GFX_FontStruct *font, uint32_t first, uint32_t count,
+                                      uint32_t bufaddr, seDMAC_CHANNEL dmachan )
+{
+    FontCacheEntry *entry;
+    uint32_t i;
+
+    for (i = 0; i < seMDC_GFX_FONTCACHE_FONTS; i++)
+    {
+        if (fontcache[i].font == font)
+            break;
+    }
+    if (i == seMDC_GFX_FONTCACHE_FONTS)
+    {
+        i = fontcachenext;
+        fontcachenext = (fontcachenext + 1) % seMDC_GFX_FONTCACHE_FONTS;
+    }
+    entry = &fontcache[i];
+
+    seDMAC_MemCpy8((uint32_t)(uintptr_t) &(font->charstbl[first]), bufaddr, count * sizeof(seMDC_GFX_FontChar), dmachan);
+    seS1D13C00Read(bufaddr, (uint8_t *) entry->chars, count * sizeof(seMDC_GFX_FontChar));
+    entry->font = font;
+    entry->first = first;
+    entry->count = count;
+    return entry;
+}
+
+
+//---------------------------------------------------------------------------
+// PRIVATE FUNCTION: FontCharFetch()
+//   Descriptor index of an external font. The cache is filled from
+//   seMDC_GFX_FONTCACHE_FIRST on the first use of the font, characters it
+//   does not hold are read one at a time.
+//---------------------------------------------------------------------------
+static void FontCharFetch( const seMDC_GFX_FontStruct *font, uint32_t index, uint32_t bufaddr, seDMAC_CHANNEL dmachan,
+                           seMDC_GFX_FontChar *fontchar )
+{
+    FontCacheEntry *entry;
+    uint32_t i, first, count;
+
+    entry = NULL;
+    for (i = 0; i < seMDC_GFX_FONTCACHE_FONTS; i++)
+    {
+        if (fontcache[i].font == font)
+            entry = &fontcache[i];
+    }
+
+    if (entry == NULL)
+    {
+        first = 0;
+        if (font->unicode_base < seMDC_GFX_FONTCACHE_FIRST)
+            first = seMDC_GFX_FONTCACHE_FIRST - font->unicode_base;
+        if (first >= font->numchars)
+            first = 0;
+        count = font->numchars - first;
+        if (count > seMDC_GFX_FONTCACHE_CHARS)
+            count = seMDC_GFX_FONTCACHE_CHARS;
+        entry = FontCacheFill(font, first, count, bufaddr, dmachan);
+    }
+
+    if ((index >= entry->first) && (index - entry->first < entry->count))
+    {
+        *fontchar = entry->chars[index - entry->first];
+    }
+    else
+    {
+        seDMAC_MemCpy8((uint32_t)(uintptr_t) &(font->charstbl[index]), bufaddr, sizeof(seMDC_GFX_FontChar), dmachan);
+        seS1D13C00Read(bufaddr, (uint8_t *) fontchar, sizeof(seMDC_GFX_FontChar));
+    }
+}
+
+
+/**
+  * Load the descriptors of a range of characters of an external font into the font metric cache.
+  * Parameters:
+  *         font:  font in serial flash
+  *         firstchar:  Unicode value of the first character
+  *         count:  number of characters, at most seMDC_GFX_FONTCACHE_CHARS are kept
+  *         bufaddr:  controller RAM address for count * sizeof(seMDC_GFX_FontChar) bytes
+  *         dmachan:  DMA channel
+  * Return value:  Status
+  */
+seStatus seMDC_GFX_FontCacheLoad ( const seMDC_GFX_FontStruct *font, uint32_t firstchar, uint32_t count,
+                                   uint32_t bufaddr, seDMAC_CHANNEL dmachan )
+{
+    seTRACE_API();
+    uint32_t first;
+
+    if ((firstchar < font->unicode_base) || (firstchar - font->unicode_base >= font->numchars) || (count == 0))
+        return seSTATUS_NG;
+
+    first = firstchar - font->unicode_base;
+    if (count > font->numchars - first)
+        count = font->numchars - first;
+    if (count > seMDC_GFX_FONTCACHE_CHARS)
+        count = seMDC_GFX_FONTCACHE_CHARS;
+    FontCacheFill(font, first, count, bufaddr, dmachan);
+    return seSTATUS_OK;
+}
+
+
+/**
+  * Descriptor of a character of a font, through the font metric cache for an external font.
+  * Parameters:
+  *         font:  font
+  *         extloc:  0=internal (Host MCU), 1=external (memory-mapped serial flash)
+  *         unicode_val:  Unicode value of the character
+  *         bufaddr:  controller RAM address for the descriptors of an external font
+  *         dmachan:  DMA channel
+  *         fontchar:  descriptor
+  * Return value:  Status, seSTATUS_NG if the character is not in the font
+  */
+seStatus seMDC_GFX_GetFontChar ( const seMDC_GFX_FontStruct *font, uint8_t extloc, uint32_t unicode_val,
+                                 uint32_t bufaddr, seDMAC_CHANNEL dmachan, seMDC_GFX_FontChar *fontchar )
+{
+    if ((unicode_val < font->unicode_base) || (unicode_val - font->unicode_base >= font->numchars))
+        return seSTATUS_NG;
+
+    if (extloc)
+        FontCharFetch(font, unicode_val - font->unicode_base, bufaddr, dmachan, fontchar);
+    else
+        *fontchar = font->charstbl[unicode_val - font->unicode_base];
+    return seSTATUS_OK;
+}
+
+
+/**
+  * Empty the font metric cache.
+  * Parameters:  None
+  * Return value:  None
+  */
+void seMDC_GFX_FontCacheFlush ( void )
+{
+    seTRACE_API();
+
+    memset(fontcache, 0, sizeof(fontcache));
+    fontcachenext = 0;
+}
+
+
+/**
+  * Width of a string as seMDC_GFX_PutString() lays it out, in one pass over the string.
+  * Parameters:
+  *         putstr_params:  Parameters structure for string display, fonts and xscale used
+  *         textstr:  pointer to text string
+  *         width:  width in destination pixels
+  * Return value:  Status, seSTATUS_NG if a character is in neither font
+  */
+seStatus seMDC_GFX_StringWidth ( seMDC_GFX_PutStr_Params *putstr_params, char *textstr, uint16_t *width )
+{
+    seTRACE_API();
+    seMDC_GFX_FontChar fontchar;
+    uint32_t unicode_val, sum;
+
+    sum = 0;
+    while (*textstr != 0)
+    {
+        unicode_val = UTF8toUnicode(&textstr);
+
+        if ((seMDC_GFX_GetFontChar(putstr_params->font1, putstr_params->extloc1, unicode_val, putstr_params->extbuffaddr,
+                                   putstr_params->dmachan, &fontchar) != seSTATUS_OK) &&
+            (seMDC_GFX_GetFontChar(putstr_params->font2, putstr_params->extloc2, unicode_val, putstr_params->extbuffaddr,
+                                   putstr_params->dmachan, &fontchar) != seSTATUS_OK))
+            return seSTATUS_NG;
+        sum += fontchar.width;
+    }
+
+    *width = (uint16_t) (((sum * putstr_params->xscale) + 128) >> 8);
+    return seSTATUS_OK;
+}
+
+
+
 
 /**
   * Display a string using a bitmap font set.  Starting point in Destination Window is in the center of character.
@@ -1858,6 +2537,7 @@ uint16_t utf8strlen ( char *textstr )
   */
 seStatus seMDC_GFX_PutString ( seMDC_GFX_PutStr_Params *putstr_params, char *textstr )
 {
+    seTRACE_API();
     uint32_t unicode_base1, unicode_base2, unicode_val;
     uint32_t numfontchars1, numfontchars2;
     seMDC_GFX_STR_JUSTIFICATION justify;
@@ -1874,9 +2554,6 @@ seStatus seMDC_GFX_PutString ( seMDC_GFX_PutStr_Params *putstr_params, char *tex
     seMDC_BITMAPFMT bitmapfmt;
     char *textstr1;
 
-    long gfxOWidth   = seS1D13C00Read16( MDC_GFXOWIDTH );
-    long gfxOHeight  = seS1D13C00Read16( MDC_GFXOHEIGHT );
-
     unicode_base1 = putstr_params->font1->unicode_base;
     numfontchars1 = putstr_params->font1->numchars;
     unicode_base2 = putstr_params->font2->unicode_base;
@@ -1903,8 +2580,7 @@ seStatus seMDC_GFX_PutString ( seMDC_GFX_PutStr_Params *putstr_params, char *tex
         {
             if (putstr_params->extloc1)
             {
-                seDMAC_MemCpy8((uint32_t) &(putstr_params->font1->charstbl[unicode_val - unicode_base1]), putstr_params->extbuffaddr, sizeof(seMDC_GFX_FontChar), putstr_params->dmachan);
-                seS1D13C00Read(putstr_params->extbuffaddr, (uint8_t *) &(fontchar), sizeof(seMDC_GFX_FontChar));
+                FontCharFetch(putstr_params->font1, unicode_val - unicode_base1, putstr_params->extbuffaddr, putstr_params->dmachan, &fontchar);
             }
             else
             {
@@ -1916,8 +2592,7 @@ seStatus seMDC_GFX_PutString ( seMDC_GFX_PutStr_Params *putstr_params, char *tex
         {
             if (putstr_params->extloc2)
             {
-                seDMAC_MemCpy8((uint32_t) &(putstr_params->font2->charstbl[unicode_val - unicode_base2]), putstr_params->extbuffaddr, sizeof(seMDC_GFX_FontChar), putstr_params->dmachan);
-                seS1D13C00Read(putstr_params->extbuffaddr, (uint8_t *) &(fontchar), sizeof(seMDC_GFX_FontChar));
+                FontCharFetch(putstr_params->font2, unicode_val - unicode_base2, putstr_params->extbuffaddr, putstr_params->dmachan, &fontchar);
             }
             else
             {
@@ -1992,6 +2667,7 @@ seStatus seMDC_GFX_PutString ( seMDC_GFX_PutStr_Params *putstr_params, char *tex
 
     cpyctrl.ctrlword = 0;
     cpyctrl.ctrlword_b.bitmapen = 1;
+    fResult = seSTATUS_OK;
 
      // Rotate whole string
      if ((putstr_params->rotation == seMDC_GFX_ROTSTRING) && (rotval != 0))
@@ -2005,8 +2681,7 @@ seStatus seMDC_GFX_PutString ( seMDC_GFX_PutStr_Params *putstr_params, char *tex
                  if (putstr_params->extloc1)
                  {
                 	 extloc = 1;
-                     seDMAC_MemCpy8((uint32_t) &(putstr_params->font1->charstbl[unicode_val - unicode_base1]), putstr_params->extbuffaddr, sizeof(seMDC_GFX_FontChar), putstr_params->dmachan);
-                     seS1D13C00Read(putstr_params->extbuffaddr, (uint8_t *) &(fontchar), sizeof(seMDC_GFX_FontChar));
+                     FontCharFetch(putstr_params->font1, unicode_val - unicode_base1, putstr_params->extbuffaddr, putstr_params->dmachan, &fontchar);
                  }
                  else
                  {
@@ -2025,8 +2700,7 @@ seStatus seMDC_GFX_PutString ( seMDC_GFX_PutStr_Params *putstr_params, char *tex
                  if (putstr_params->extloc2)
                  {
                 	 extloc = 1;
-                     seDMAC_MemCpy8((uint32_t) &(putstr_params->font2->charstbl[unicode_val - unicode_base2]), putstr_params->extbuffaddr, sizeof(seMDC_GFX_FontChar), putstr_params->dmachan);
-                     seS1D13C00Read(putstr_params->extbuffaddr, (uint8_t *) &(fontchar), sizeof(seMDC_GFX_FontChar));
+                     FontCharFetch(putstr_params->font2, unicode_val - unicode_base2, putstr_params->extbuffaddr, putstr_params->dmachan, &fontchar);
                  }
                  else
                  {
@@ -2040,11 +2714,20 @@ seStatus seMDC_GFX_PutString ( seMDC_GFX_PutStr_Params *putstr_params, char *tex
                  bitmapfmt = putstr_params->font2->bitmapfmt;
                  cpyctrl.ctrlword_b.bitmapfmt = bitmapfmt;
              }
-
+             else   // Rejected above already
+                 return seSTATUS_NG;
 
              fontwidth = fontchar.width;
              k = ((fontwidth>>(3-bitmapfmt))+1) * fontheight;
 
+             // Characters outside the clip are not loaded
+             if (seMDC_IsCopyClipped(originx, originy, fontwidth, fontheight, ixcenter, fontheight>>1,
+                                     (xscale > yscale) ? xscale : yscale))
+             {
+                 ixcenter -= fontwidth;
+                 continue;
+             }
+
              if (extloc)
              {
                  fontoffset = ((uint32_t) pxdata) + fontchar.offsetloc;
@@ -2074,8 +2757,7 @@ seStatus seMDC_GFX_PutString ( seMDC_GFX_PutStr_Params *putstr_params, char *tex
              if ((putstr_params->extloc1) && (*textstr != 0))
              {
             	 extloc = 1;
-                 seDMAC_MemCpy8((uint32_t) &(putstr_params->font1->charstbl[unicode_val - unicode_base1]), putstr_params->extbuffaddr, sizeof(seMDC_GFX_FontChar), putstr_params->dmachan);
-                 seS1D13C00Read(putstr_params->extbuffaddr, (uint8_t *) &(fontchar), sizeof(seMDC_GFX_FontChar));
+                 FontCharFetch(putstr_params->font1, unicode_val - unicode_base1, putstr_params->extbuffaddr, putstr_params->dmachan, &fontchar);
              }
              else
              {
@@ -2094,8 +2776,7 @@ seStatus seMDC_GFX_PutString ( seMDC_GFX_PutStr_Params *putstr_params, char *tex
              if ((putstr_params->extloc2) && (*textstr != 0))
              {
             	 extloc = 1;
-                 seDMAC_MemCpy8((uint32_t) &(putstr_params->font2->charstbl[unicode_val - unicode_base2]), putstr_params->extbuffaddr, sizeof(seMDC_GFX_FontChar), putstr_params->dmachan);
-                 seS1D13C00Read(putstr_params->extbuffaddr, (uint8_t *) &(fontchar), sizeof(seMDC_GFX_FontChar));
+                 FontCharFetch(putstr_params->font2, unicode_val - unicode_base2, putstr_params->extbuffaddr, putstr_params->dmachan, &fontchar);
              }
              else
              {
@@ -2109,23 +2790,28 @@ seStatus seMDC_GFX_PutString ( seMDC_GFX_PutStr_Params *putstr_params, char *tex
              bitmapfmt = putstr_params->font2->bitmapfmt;
              cpyctrl.ctrlword_b.bitmapfmt = bitmapfmt;
          }
+         else   // Empty string, other characters outside the fonts were rejected above
+             return seSTATUS_OK;
 
          while(*textstr1 != 0)
          {
              fontwidth = fontchar.width;
              k = ((fontwidth>>(3-bitmapfmt))+1) * fontheight;
 
-             if (extloc)
-             {
-                 fontoffset = ((uint32_t) pxdata) + fontchar.offsetloc;
-             }
-             else
-             {
-                 fontoffset = putstr_params->extbuffaddr;
-                 seS1D13C00Write(fontoffset, pxdata + fontchar.offsetloc, k);
-             }
+             // Characters outside the clip are not loaded, the center must be in range of the engine
+             if ((oxcenter >= 0) && (originy >= 0) &&
+                 !seMDC_IsCopyClipped(oxcenter, originy, fontwidth, fontheight, fontwidth>>1, fontheight>>1,
+                                      (xscale > yscale) ? xscale : yscale)) {
+                 if (extloc)
+                 {
+                     fontoffset = ((uint32_t)(uintptr_t) pxdata) + fontchar.offsetloc;
+                 }
+                 else
+                 {
+                     fontoffset = putstr_params->extbuffaddr;
+                     seS1D13C00Write(fontoffset, pxdata + fontchar.offsetloc, k);
+                 }
 
-             if ((oxcenter >= 0) && (oxcenter < gfxOWidth) && (originy >= 0) && (originy < gfxOHeight)) {
                  fResult = seMDC_ImgCpyRotScale(oxcenter, originy, fontoffset, fontwidth, fontwidth, fontheight, fontwidth>>1, fontheight>>1,
                                                 pencolor, rotval, xscale, xscale, yscale, yscale, &cpyctrl);
                  seMDC_WaitGfxDone();
@@ -2144,8 +2830,7 @@ seStatus seMDC_GFX_PutString ( seMDC_GFX_PutStr_Params *putstr_params, char *tex
                  if ((putstr_params->extloc1) && (*textstr1 != 0))
                  {
                 	 extloc = 1;
-                     seDMAC_MemCpy8((uint32_t) &(putstr_params->font1->charstbl[unicode_val - unicode_base1]), putstr_params->extbuffaddr, sizeof(seMDC_GFX_FontChar), putstr_params->dmachan);
-                     seS1D13C00Read(putstr_params->extbuffaddr, (uint8_t *) &(fontchar), sizeof(seMDC_GFX_FontChar));
+                     FontCharFetch(putstr_params->font1, unicode_val - unicode_base1, putstr_params->extbuffaddr, putstr_params->dmachan, &fontchar);
                  }
                  else
                  {
@@ -2167,8 +2852,7 @@ seStatus seMDC_GFX_PutString ( seMDC_GFX_PutStr_Params *putstr_params, char *tex
                  if ((putstr_params->extloc2) && (*textstr1 != 0))
                  {
                 	 extloc = 1;
-                     seDMAC_MemCpy8((uint32_t) &(putstr_params->font2->charstbl[unicode_val - unicode_base2]), putstr_params->extbuffaddr, sizeof(seMDC_GFX_FontChar), putstr_params->dmachan);
-                     seS1D13C00Read(putstr_params->extbuffaddr, (uint8_t *) &(fontchar), sizeof(seMDC_GFX_FontChar));
+                     FontCharFetch(putstr_params->font2, unicode_val - unicode_base2, putstr_params->extbuffaddr, putstr_params->dmachan, &fontchar);
                  }
                  else
                  {
@@ -39,6 +39,29 @@ typedef enum {
    seMDC_GFX_ROTCHAR            = 1U      ///< Rotate individual characters
 } seMDC_GFX_STR_ROTTYPE;
 
+#define seMDC_GFX_SPRITE_ROWBYTES(w)  (((w) >> 3) + 1)  ///< Bytes per row of a sprite bitmap of width w, as the engine reads 1-bit bitmaps
+#define seMDC_GFX_SPRITE_BYTES(w,h)   ((uint32_t)seMDC_GFX_SPRITE_ROWBYTES(w) * (h))  ///< Bytes of a sprite bitmap of w by h
+
+#ifndef seMDC_GFX_DASH_BUFSIZE
+#define seMDC_GFX_DASH_BUFSIZE       256       ///< Host buffer building dash bitmaps, bytes written per transaction and longest row
+#endif
+
+#ifndef seMDC_GFX_FONTCACHE_CHARS
+#define seMDC_GFX_FONTCACHE_CHARS    96        ///< Descriptors cached per external font, at least 1
+#endif
+
+#ifndef seMDC_GFX_FONTCACHE_FONTS
+#define seMDC_GFX_FONTCACHE_FONTS    2         ///< External fonts cached at once, at least 1
+#endif
+
+#ifndef seMDC_GFX_FONTCACHE_FIRST
+#define seMDC_GFX_FONTCACHE_FIRST    0x20      ///< First character cached on the first use of an external font
+#endif
+
+#ifndef seMDC_GFX_POLYGON_MAXFILL
+#define seMDC_GFX_POLYGON_MAXFILL    32        ///< Most points of a filled polygon, sizes the host-side edge buffers
+#endif
+
 
 
 /**
@@ -97,7 +120,7 @@ typedef struct {
    seMDC_GFX_STR_JUSTIFICATION justify; ///< Justification setting
    seMDC_GFX_STR_ROTTYPE rotation;      ///< Rotation type, whole string or individual characters
    uint16_t rotval;                     ///< Rotation value, rotation is rotval*360/512 degrees counterclockwise
-   uint32_t extbuffaddr;                ///< Address of external buffer (RAM) for copying
+   uint32_t extbuffaddr;                ///< Address of external buffer (RAM) for copying, at least seMDC_GFX_FONTCACHE_CHARS * sizeof(seMDC_GFX_FontChar) bytes with an external font
    seDMAC_CHANNEL dmachan;              ///< DMA channel used for copying data
 } seMDC_GFX_PutStr_Params;
 
@@ -131,7 +154,7 @@ typedef struct {
 
 
 /** 
-  * @brief  MDC polygon outline drawing parameters structure
+  * @brief  MDC polygon drawing parameters structure
   */
 typedef struct {
    uint16_t numpoints;                  ///< number of points in polygon
@@ -142,10 +165,43 @@ typedef struct {
    uint16_t scaleval;                   ///< scaling value, scaling is (scaleval/256).
    uint16_t rotval;                     ///< rotation value, rotation is (rotval*360)/512 degrees counter clockwise
    uint16_t roundtips;                  ///< line segments have round tips or not
+   uint16_t fillenable;                 ///< fill the polygon instead, at most seMDC_GFX_POLYGON_MAXFILL points
    seMDC_GFX_Point points[];            ///< array of points relative to center
 } seMDC_GFX_PolygonStruct;
 
 
+/** 
+  * @brief  MDC sprite: a 1-bit bitmap in controller memory drawn rotated about its pivot
+  */
+typedef struct {
+   uint32_t baseaddr;                   ///< bitmap address, controller RAM or serial flash mapped at EXTMEM_BASE
+   uint16_t width;                      ///< bitmap width, rows are seMDC_GFX_SPRITE_ROWBYTES(width) bytes
+   uint16_t height;                     ///< bitmap height
+   uint16_t pivotx;                     ///< pivot X coordinate in the bitmap
+   uint16_t pivoty;                     ///< pivot Y coordinate in the bitmap
+   uint16_t color;                      ///< color of the set bits
+   uint16_t scale;                      ///< scaling value, scaling is (scale/256)
+   int16_t left;                        ///< box last drawn, set by seMDC_GFX_SpriteDraw()
+   int16_t top;
+   int16_t right;
+   int16_t bottom;
+   uint8_t drawn;                       ///< box is valid, cleared by seMDC_GFX_SpriteErase()
+} seMDC_GFX_Sprite;
+
+
+/** 
+  * @brief  MDC sprite background: the image under the sprites, kept in controller memory
+  */
+typedef struct {
+   uint32_t baseaddr;                   ///< address of the top left pixel, destination window format
+   uint16_t stride;                     ///< background stride
+   int16_t left;                        ///< destination X coordinate of the top left pixel
+   int16_t top;                         ///< destination Y coordinate of the top left pixel
+   uint16_t width;                      ///< background width
+   uint16_t height;                     ///< background height
+} seMDC_GFX_SpriteBg;
+
+
 /**
   * @}
   */  
@@ -265,11 +321,86 @@ seStatus seMDC_GFX_DrawDArc ( uint16_t centerx, uint16_t centery, uint16_t radiu
                              uint16_t startangle0, uint16_t endangle0, uint16_t pencolor, uint16_t dashang, uint16_t blankang);
 
 /**
-  * @brief  Draw a polygon outline.
+  * @brief  Draw a polygon outline, or fill it if fillenable is set.
   * @param  polygon:  polygon parameters structure of type @ref seMDC_GFX_PolygonStruct
+  * @note   Filling rasterizes the scaled and rotated polygon on the host (even-odd rule, pixel
+  *         centers inside, so a w x h rectangle fills w x h pixels) and fills it as rectangles:
+  *         a span that repeats on consecutive rows is one rectangle. The polygon is clipped to
+  *         the destination window. Thickness and roundtips are not used.
   * @retval Status: can be a value of @ref seStatus
   */
 seStatus seMDC_GFX_DrawPolygon ( seMDC_GFX_PolygonStruct *polygon );
+
+/**
+  * @brief  Copy a sprite bitmap from host memory to controller RAM. A bitmap already in
+  *         controller memory or serial flash only needs baseaddr set.
+  * @param  sprite:  sprite, width and height set. baseaddr is set to addr.
+  * @param  addr:  controller RAM address
+  * @param  bitmap:  1-bit bitmap, seMDC_GFX_SPRITE_ROWBYTES(width) bytes per row
+  * @retval Status: can be a value of @ref seStatus
+  */
+seStatus seMDC_GFX_SpriteLoad ( seMDC_GFX_Sprite *sprite, uint32_t addr, const uint8_t *bitmap );
+
+/**
+  * @brief  Draw a sprite rotated about its pivot with one bitmap copy, clear bits are transparent.
+  *         The box drawn is kept for seMDC_GFX_SpriteErase().
+  * @param  sprite:  sprite
+  * @param  x:  destination X coordinate of the pivot
+  * @param  y:  destination Y coordinate of the pivot
+  * @param  rotval:  rotation, 0 to 511 for a full turn clockwise. A clock hand drawn pointing to
+  *                  12:00 is at second s with rotval = s * 512 / 60.
+  * @retval Status: can be a value of @ref seStatus
+  */
+seStatus seMDC_GFX_SpriteDraw ( seMDC_GFX_Sprite *sprite, int16_t x, int16_t y, uint16_t rotval );
+
+/**
+  * @brief  Restore the background under a sprite with one image copy. Erase all moving sprites
+  *         before drawing them again, as the boxes may overlap.
+  * @param  sprite:  sprite, nothing is done if not drawn since the last erase
+  * @param  bg:  background, the part outside it is left as is
+  * @retval Status: can be a value of @ref seStatus
+  */
+seStatus seMDC_GFX_SpriteErase ( seMDC_GFX_Sprite *sprite, const seMDC_GFX_SpriteBg *bg );
+
+/**
+  * @brief  Build a horizontal or vertical dashed line as a sprite. Drawn with seMDC_GFX_SpriteDraw()
+  *         at the first point and rotation 0, it gives the pixels of seMDC_GFX_DrawDHLine() or
+  *         seMDC_GFX_DrawDVLine() with one bitmap copy, and can be drawn again while in place.
+  *         Other rotations give dashed lines at any angle.
+  * @note   The engine draws a one pixel dash of a thick vertical line across it, the sprite
+  *         along it.
+  * @param  dash:  sprite, color set by the caller
+  * @param  addr:  controller RAM address, seMDC_GFX_SPRITE_BYTES(length, thickness) bytes,
+  *                seMDC_GFX_SPRITE_BYTES(thickness, length) if vertical
+  * @param  length:  pixels from the first to the last point, inclusive
+  * @param  thickness:  line thickness
+  * @param  dashlen:  length of dash in pixels
+  * @param  blanklen:  length of blank in pixels
+  * @param  vertical:  the line goes down from the first point instead of right
+  * @retval Status: can be a value of @ref seStatus
+  */
+seStatus seMDC_GFX_DashLineLoad ( seMDC_GFX_Sprite *dash, uint32_t addr, uint16_t length, uint16_t thickness,
+                                  uint16_t dashlen, uint16_t blanklen, uint8_t vertical );
+
+/**
+  * @brief  Build a dashed arc as a sprite, drawn with seMDC_GFX_SpriteDraw() at the center with
+  *         one bitmap copy. An unchanged bezel costs one copy per frame, and can be turned with
+  *         the rotation of the copy.
+  * @param  dash:  sprite, color set by the caller
+  * @param  addr:  controller RAM address, seMDC_GFX_SPRITE_BYTES(2 * radius + 1, 2 * radius + 1) bytes
+  * @param  radius:  Outer radius.
+  * @param  thickness:  Thickness.  Inner radius = radius - thickness
+  * @param  startangle:  Start angle.  0 to 511 corresponds to full circle
+  * @param  endangle:  End angle.  0 to 511 corresponds to full circle.  Y-axis is 0.  Clockwise.
+  * @param  dashang:  Dash angle segments in angle units (0 to 511)
+  * @param  blankang:  Blank angle segments in angle units (0 to 511)
+  * @note   The ring is the pixels from radius - thickness to radius, each circle taken half a
+  *         pixel out, and a pixel is in a dash if its center angle is. This can differ from
+  *         seMDC_GFX_DrawDArc() by a pixel at the edges and the ends of the dashes.
+  * @retval Status: can be a value of @ref seStatus
+  */
+seStatus seMDC_GFX_DashArcLoad ( seMDC_GFX_Sprite *dash, uint32_t addr, uint16_t radius, uint16_t thickness,
+                                 uint16_t startangle, uint16_t endangle, uint16_t dashang, uint16_t blankang );
   
 /**
   * @brief  UTF-8 to Unicode converter.  String pointer is incremented according to UTF-8 code.
@@ -293,6 +424,53 @@ uint16_t utf8strlen ( char *textstr );
   */
 seStatus seMDC_GFX_PutString ( seMDC_GFX_PutStr_Params *putstr_params, char *textstr );
 
+/**
+  * @brief  Load the descriptors of a range of characters of an external font into the font
+  *         metric cache, replacing the entry of the font or the oldest one. On its first use by
+  *         seMDC_GFX_PutString() or seMDC_GFX_StringWidth(), an external font is loaded from
+  *         seMDC_GFX_FONTCACHE_FIRST; call this instead when the text uses another range.
+  * @param  font:  font in serial flash
+  * @param  firstchar:  Unicode value of the first character
+  * @param  count:  number of characters, at most seMDC_GFX_FONTCACHE_CHARS are kept
+  * @param  bufaddr:  controller RAM address for count * sizeof(seMDC_GFX_FontChar) bytes
+  * @param  dmachan:  DMA channel
+  * @retval Status: seSTATUS_NG if firstchar is not in the font
+  */
+seStatus seMDC_GFX_FontCacheLoad ( const seMDC_GFX_FontStruct *font, uint32_t firstchar, uint32_t count,
+                                   uint32_t bufaddr, seDMAC_CHANNEL dmachan );
+
+/**
+  * @brief  Descriptor of a character of a font. For an external font it comes from the font
+  *         metric cache, loaded as on first use by seMDC_GFX_PutString().
+  * @param  font:  font
+  * @param  extloc:  0=internal (Host MCU), 1=external (memory-mapped serial flash)
+  * @param  unicode_val:  Unicode value of the character
+  * @param  bufaddr:  controller RAM address for the descriptors of an external font,
+  *                   seMDC_GFX_FONTCACHE_CHARS * sizeof(seMDC_GFX_FontChar) bytes
+  * @param  dmachan:  DMA channel
+  * @param  fontchar:  descriptor
+  * @retval Status: seSTATUS_NG if the character is not in the font
+  */
+seStatus seMDC_GFX_GetFontChar ( const seMDC_GFX_FontStruct *font, uint8_t extloc, uint32_t unicode_val,
+                                 uint32_t bufaddr, seDMAC_CHANNEL dmachan, seMDC_GFX_FontChar *fontchar );
+
+/**
+  * @brief  Empty the font metric cache, when the descriptors of a cached font are changed or the
+  *         font structure is reused for another font.
+  * @retval None
+  */
+void seMDC_GFX_FontCacheFlush ( void );
+
+/**
+  * @brief  Width of a string as seMDC_GFX_PutString() lays it out, the sum of the character
+  *         widths scaled by xscale, computed in one pass from the font metric cache.
+  * @param  putstr_params:  String display parameters structure, fonts and xscale used
+  * @param  textstr:  pointer to text string
+  * @param  width:  width in destination pixels
+  * @retval Status: seSTATUS_NG if a character is in neither font
+  */
+seStatus seMDC_GFX_StringWidth ( seMDC_GFX_PutStr_Params *putstr_params, char *textstr, uint16_t *width );
+
 /**
   * @}
   */   // MDC_GFX_Functions
@@ -0,0 +1,383 @@
+/**
+  ******************************************************************************
+  * @file    semdc_layer.c
+  * @brief   Off-screen layers and their compositor, see semdc_layer.h.
+  ******************************************************************************
+  */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "s1d13c00_hcl.h"
+#include "s1d13c00_memregs.h"
+#include "s1d13c00_trace.h"
+#include "se_common.h"
+#include "se_dmac.h"
+#include "se_mdc.h"
+#include "semdc_layer.h"
+
+// Inclusive frame rectangle
+typedef struct {
+    int32_t left, top, right, bot;
+} Rect;
+
+static struct {
+    uint32_t               pooladdr;
+    uint32_t               poolend;
+    seMDC_DestWindowParams frame;
+    seDMAC_CHANNEL         dmachan;
+    seMDC_LAYER_Layer      *bottom;         // Stack, linked by above
+    seMDC_LAYER_Layer      *addrs;          // Surfaces by address, linked by nextaddr
+    Rect                   damage[SE_MDC_LAYER_MAX_DAMAGE];
+    uint32_t               ndamage;
+} lyr;
+
+
+//---------------------------------------------------------------------------
+// PRIVATE FUNCTIONS
+//---------------------------------------------------------------------------
+
+static void LayerRect( const seMDC_LAYER_Layer *layer, Rect *r )
+{
+    r->left  = layer->left;
+    r->top   = layer->top;
+    r->right = (int32_t)layer->left + layer->width - 1;
+    r->bot   = (int32_t)layer->top + layer->height - 1;
+}
+
+static uint32_t RectArea( const Rect *r )
+{
+    return (uint32_t)(r->right - r->left + 1) * (uint32_t)(r->bot - r->top + 1);
+}
+
+static void RectUnion( Rect *r, const Rect *s )
+{
+    if ( s->left < r->left )    r->left  = s->left;
+    if ( s->top < r->top )      r->top   = s->top;
+    if ( s->right > r->right )  r->right = s->right;
+    if ( s->bot > r->bot )      r->bot   = s->bot;
+}
+
+// Intersection of r and s in r, false if empty
+static bool RectClip( Rect *r, const Rect *s )
+{
+    if ( s->left > r->left )    r->left  = s->left;
+    if ( s->top > r->top )      r->top   = s->top;
+    if ( s->right < r->right )  r->right = s->right;
+    if ( s->bot < r->bot )      r->bot   = s->bot;
+    return r->left <= r->right && r->top <= r->bot;
+}
+
+static void DamageRect( Rect r )
+{
+    Rect     frame = { 0, 0, (int32_t)lyr.frame.owidth - 1, (int32_t)lyr.frame.oheight - 1 };
+    Rect     u;
+    uint32_t i, best = 0, grow, bestgrow = 0xFFFFFFFFUL;
+
+    if ( !RectClip( &r, &frame ) )
+        return;
+
+    // Join a rectangle it overlaps or touches, else keep it apart while there is room
+    for ( i = 0; i < lyr.ndamage; i++ )
+    {
+        Rect *d = &lyr.damage[i];
+
+        if ( r.left <= d->right + 1 && r.right + 1 >= d->left && r.top <= d->bot + 1 && r.bot + 1 >= d->top )
+        {
+            RectUnion( d, &r );
+            return;
+        }
+    }
+    if ( lyr.ndamage < SE_MDC_LAYER_MAX_DAMAGE )
+    {
+        lyr.damage[lyr.ndamage++] = r;
+        return;
+    }
+
+    // Full: merge into the one that grows least
+    for ( i = 0; i < lyr.ndamage; i++ )
+    {
+        u = lyr.damage[i];
+        RectUnion( &u, &r );
+        grow = RectArea( &u ) - RectArea( &lyr.damage[i] );
+        if ( grow < bestgrow )
+        {
+            bestgrow = grow;
+            best     = i;
+        }
+    }
+    RectUnion( &lyr.damage[best], &r );
+}
+
+static void DamageLayer( const seMDC_LAYER_Layer *layer )
+{
+    Rect r;
+
+    LayerRect( layer, &r );
+    DamageRect( r );
+}
+
+// First hole of size bytes: its address and the link to insert the surface at, NULL if none
+static seMDC_LAYER_Layer **FindHole( uint32_t size, uint32_t *addr )
+{
+    seMDC_LAYER_Layer **link = &lyr.addrs;
+    uint32_t pos = lyr.pooladdr;
+    uint32_t end;
+
+    for ( ;; )
+    {
+        end = (*link != NULL) ? (*link)->baseaddr : lyr.poolend;
+        if ( end - pos >= size )
+        {
+            *addr = pos;
+            return link;
+        }
+        if ( *link == NULL )
+            return NULL;
+        pos  = (*link)->baseaddr + (*link)->size;
+        link = &(*link)->nextaddr;
+    }
+}
+
+static void Unlink( seMDC_LAYER_Layer **head, seMDC_LAYER_Layer *layer, bool byaddr )
+{
+    seMDC_LAYER_Layer **link = head;
+
+    while ( *link != NULL && *link != layer )
+        link = byaddr ? &(*link)->nextaddr : &(*link)->above;
+    if ( *link != NULL )
+        *link = byaddr ? layer->nextaddr : layer->above;
+}
+
+// One opaque copy of the part of r on the layer
+static seStatus CopyLayer( const seMDC_LAYER_Layer *layer, const Rect *r, Rect *written )
+{
+    seMDC_ImgCopyRotScaleCtrl ctrl;
+    seStatus fResult;
+    Rect c;
+
+    LayerRect( layer, &c );
+    if ( !RectClip( &c, r ) )
+        return seSTATUS_OK;
+
+    ctrl.ctrlword = 0;
+    fResult = seMDC_ImgCpyRotScale( (uint16_t)c.left, (uint16_t)c.top,
+                                    layer->baseaddr + (uint32_t)(c.top - layer->top) * layer->width + (uint32_t)(c.left - layer->left),
+                                    layer->width, (uint16_t)(c.right - c.left + 1), (uint16_t)(c.bot - c.top + 1), 0, 0,
+                                    0, 0, 256, 256, 256, 256, &ctrl );
+    seMDC_WaitGfxDone();
+    if ( c.top < written->top )
+        written->top = c.top;
+    if ( c.bot > written->bot )
+        written->bot = c.bot;
+    return fResult;
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seMDC_LAYER_Init()
+//---------------------------------------------------------------------------
+seStatus seMDC_LAYER_Init( uint32_t pooladdr, uint32_t poolsize, const seMDC_DestWindowParams *frame,
+                           seDMAC_CHANNEL dmachan )
+{
+    lyr.pooladdr = (pooladdr + 3) & ~3UL;
+    lyr.poolend  = (pooladdr + poolsize) & ~3UL;
+    if ( lyr.poolend < lyr.pooladdr )
+        lyr.poolend = lyr.pooladdr;
+    lyr.frame   = *frame;
+    lyr.dmachan = dmachan;
+    lyr.bottom  = NULL;
+    lyr.addrs   = NULL;
+    lyr.ndamage = 0;
+    return (lyr.poolend > lyr.pooladdr) ? seSTATUS_OK : seSTATUS_NG;
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seMDC_LAYER_Add()
+//---------------------------------------------------------------------------
+seStatus seMDC_LAYER_Add( seMDC_LAYER_Layer *layer )
+{
+    seTRACE_API();
+    seMDC_LAYER_Layer **link;
+    uint32_t size, addr, freebytes, largest;
+
+    if ( layer->width == 0 || layer->height == 0 )
+        return seSTATUS_NG;
+
+    size = ((uint32_t)layer->width * layer->height + 3) & ~3UL;
+    link = FindHole( size, &addr );
+    if ( link == NULL )
+    {
+        seMDC_LAYER_PoolInfo( &freebytes, &largest );
+        if ( freebytes < size )
+            return seSTATUS_NG;
+        seMDC_LAYER_Defrag();
+        link = FindHole( size, &addr );
+        if ( link == NULL )
+            return seSTATUS_NG;
+    }
+
+    layer->baseaddr = addr;
+    layer->size     = size;
+    layer->nextaddr = *link;
+    *link = layer;
+
+    layer->above = NULL;
+    for ( link = &lyr.bottom; *link != NULL; link = &(*link)->above )
+        ;
+    *link = layer;
+    layer->dirty = 1;
+    return seSTATUS_OK;
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seMDC_LAYER_Remove()
+//---------------------------------------------------------------------------
+void seMDC_LAYER_Remove( seMDC_LAYER_Layer *layer )
+{
+    Unlink( &lyr.bottom, layer, false );
+    Unlink( &lyr.addrs, layer, true );
+    layer->above    = NULL;
+    layer->nextaddr = NULL;
+    layer->size     = 0;
+    DamageLayer( layer );
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seMDC_LAYER_Invalidate()
+//---------------------------------------------------------------------------
+void seMDC_LAYER_Invalidate( seMDC_LAYER_Layer *layer )
+{
+    layer->dirty = 1;
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seMDC_LAYER_Move()
+//---------------------------------------------------------------------------
+void seMDC_LAYER_Move( seMDC_LAYER_Layer *layer, int16_t left, int16_t top )
+{
+    DamageLayer( layer );
+    layer->left = left;
+    layer->top  = top;
+    DamageLayer( layer );
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seMDC_LAYER_Damage()
+//---------------------------------------------------------------------------
+void seMDC_LAYER_Damage( int16_t left, int16_t top, int16_t right, int16_t bottom )
+{
+    Rect r = { left, top, right, bottom };
+
+    if ( left <= right && top <= bottom )
+        DamageRect( r );
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seMDC_LAYER_Compose()
+//---------------------------------------------------------------------------
+seStatus seMDC_LAYER_Compose( uint16_t *starty, uint16_t *endy )
+{
+    seTRACE_API();
+    seMDC_DestWindowParams win;
+    seMDC_LAYER_Layer *layer, *start;
+    seStatus fResult = seSTATUS_OK;
+    bool rendered = false;
+    Rect written = { 0, 0x7FFFFFFF, 0, -1 };
+    Rect r;
+    uint32_t i;
+
+    for ( layer = lyr.bottom; layer != NULL; layer = layer->above )
+    {
+        if ( !layer->dirty && !(layer->flags & seMDC_LAYER_DYNAMIC) )
+            continue;
+
+        win.obaseaddr = layer->baseaddr;
+        win.owidth    = layer->width;
+        win.oheight   = layer->height;
+        win.ostride   = layer->width;
+        seMDC_SetDestWindow( &win );
+        if ( layer->render != NULL && layer->render( layer ) != seSTATUS_OK )
+            fResult = seSTATUS_NG;
+        layer->dirty = 0;
+        DamageLayer( layer );
+        rendered = true;
+    }
+    if ( rendered )
+        seMDC_SetDestWindow( &lyr.frame );
+
+    for ( i = 0; i < lyr.ndamage; i++ )
+    {
+        // Layers under one that covers the whole rectangle are hidden
+        start = lyr.bottom;
+        for ( layer = lyr.bottom; layer != NULL; layer = layer->above )
+        {
+            LayerRect( layer, &r );
+            if ( r.left <= lyr.damage[i].left && r.right >= lyr.damage[i].right &&
+                 r.top <= lyr.damage[i].top && r.bot >= lyr.damage[i].bot )
+                start = layer;
+        }
+        for ( layer = start; layer != NULL; layer = layer->above )
+        {
+            if ( CopyLayer( layer, &lyr.damage[i], &written ) != seSTATUS_OK )
+                fResult = seSTATUS_NG;
+        }
+    }
+    lyr.ndamage = 0;
+
+    *starty = (written.bot >= written.top) ? (uint16_t)written.top : 0xFFFF;
+    *endy   = (written.bot >= written.top) ? (uint16_t)written.bot : 0;
+    return fResult;
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seMDC_LAYER_Defrag()
+//---------------------------------------------------------------------------
+void seMDC_LAYER_Defrag( void )
+{
+    seTRACE_API();
+    seMDC_LAYER_Layer *layer;
+    uint32_t pos = lyr.pooladdr;
+
+    // Downward moves in address order never overwrite a surface not moved yet
+    for ( layer = lyr.addrs; layer != NULL; layer = layer->nextaddr )
+    {
+        if ( layer->baseaddr != pos )
+        {
+            seDMAC_MemCpy32( layer->baseaddr, pos, layer->size / 4, lyr.dmachan );
+            layer->baseaddr = pos;
+        }
+        pos += layer->size;
+    }
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seMDC_LAYER_PoolInfo()
+//---------------------------------------------------------------------------
+void seMDC_LAYER_PoolInfo( uint32_t *freebytes, uint32_t *largest )
+{
+    seMDC_LAYER_Layer *layer = lyr.addrs;
+    uint32_t pos = lyr.pooladdr;
+    uint32_t end;
+
+    *freebytes = 0;
+    *largest   = 0;
+    for ( ;; )
+    {
+        end = (layer != NULL) ? layer->baseaddr : lyr.poolend;
+        *freebytes += end - pos;
+        if ( end - pos > *largest )
+            *largest = end - pos;
+        if ( layer == NULL )
+            break;
+        pos   = layer->baseaddr + layer->size;
+        layer = layer->nextaddr;
+    }
+}
@@ -0,0 +1,142 @@
+/**
+  ******************************************************************************
+  * @file    semdc_layer.h
+  * @brief   Off-screen layers in controller RAM composited into the frame
+  *          buffer by the graphics engine.
+  ******************************************************************************
+  * @attention
+  *
+  * A layer is an 8 bpp surface in a pool of controller RAM, placed at a
+  * position in the frame. Layers are opaque and stacked in the order they are
+  * added. A layer is drawn by its render function with the destination window
+  * set to its surface, once after seMDC_LAYER_Add() or seMDC_LAYER_Invalidate(),
+  * or at every compose for seMDC_LAYER_DYNAMIC layers. Everything else comes
+  * from the surfaces: seMDC_LAYER_Compose() copies the damaged part of the
+  * frame from every layer under it, one rot-scale copy at scale 1.0 per layer
+  * and damaged rectangle, starting at the topmost layer that covers the whole
+  * rectangle. Content drawn straight into the frame buffer after composing,
+  * such as sprites, is removed by damaging its box with seMDC_LAYER_Damage().
+  * Frame pixels outside every layer are never written.
+  *
+  * The pool is allocated first fit. When no hole is large enough but the free
+  * total is, the surfaces are moved down to the start of the pool in address
+  * order with DMAC word copies, keeping their pixels, and the request is
+  * served from the single hole left at the end.
+  *
+  * The engine must be idle when these functions are called; they wait for
+  * completion before returning. Render functions using seMDC_SW_AutoDraw*()
+  * must call seMDC_SW_SyncOutput() first, and the frame destination window is
+  * restored before the copies. The output clip window is left as it is.
+  ******************************************************************************
+  */
+
+#ifndef SEMDC_LAYER_H
+#define SEMDC_LAYER_H
+
+#include <stdint.h>
+#include "se_common.h"
+#include "se_dmac.h"
+#include "se_mdc.h"
+
+#ifndef SE_MDC_LAYER_MAX_DAMAGE
+#define SE_MDC_LAYER_MAX_DAMAGE 4               ///< Damaged rectangles kept apart, more are merged
+#endif
+
+#define seMDC_LAYER_DYNAMIC     0x01U           ///< Render at every compose
+
+
+typedef struct seMDC_LAYER_Layer seMDC_LAYER_Layer;
+
+/**
+  * @brief  Draws a layer in surface coordinates, (0, 0) to (width-1, height-1),
+  *         and returns with the engine idle.
+  */
+typedef seStatus (*seMDC_LAYER_RenderFunc)( seMDC_LAYER_Layer *layer );
+
+/**
+  * @brief  Layer, owned by the caller and linked in while added.
+  */
+struct seMDC_LAYER_Layer {
+    seMDC_LAYER_RenderFunc render;      ///< Draws the surface
+    void     *arg;                      ///< For the render function
+    int16_t  left;                      ///< Frame position of the top left pixel, see seMDC_LAYER_Move()
+    int16_t  top;
+    uint16_t width;                     ///< Surface size, also its stride
+    uint16_t height;
+    uint8_t  flags;                     ///< Combination of seMDC_LAYER_DYNAMIC
+    // Set by the layer manager
+    uint8_t  dirty;                     ///< Render at the next compose
+    uint32_t baseaddr;                  ///< Surface address, changes when the pool is defragmented
+    uint32_t size;                      ///< Bytes taken from the pool
+    seMDC_LAYER_Layer *above;           ///< Next layer up
+    seMDC_LAYER_Layer *nextaddr;        ///< Next surface in the pool
+};
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+  * @brief  Set up an empty layer stack.
+  * @param  pooladdr:  controller RAM for surfaces, rounded up to a word
+  * @param  poolsize:  bytes from pooladdr
+  * @param  frame:  frame buffer destination window, restored after rendering
+  * @param  dmachan:  DMAC channel moving surfaces, seDMAC_Init() done
+  * @retval Status: can be a value of @ref seStatus
+  */
+seStatus seMDC_LAYER_Init( uint32_t pooladdr, uint32_t poolsize, const seMDC_DestWindowParams *frame,
+                           seDMAC_CHANNEL dmachan );
+
+/**
+  * @brief  Allocate a surface and put the layer on top. It is rendered and
+  *         composited at the next compose.
+  * @param  layer:  render, left, top, width, height and flags set
+  * @retval Status: seSTATUS_NG if the pool is short of width * height bytes
+  */
+seStatus seMDC_LAYER_Add( seMDC_LAYER_Layer *layer );
+
+/**
+  * @brief  Free the surface of a layer and damage the frame under it.
+  */
+void seMDC_LAYER_Remove( seMDC_LAYER_Layer *layer );
+
+/**
+  * @brief  Render a layer again at the next compose.
+  */
+void seMDC_LAYER_Invalidate( seMDC_LAYER_Layer *layer );
+
+/**
+  * @brief  Place a layer elsewhere in the frame, without rendering it again.
+  */
+void seMDC_LAYER_Move( seMDC_LAYER_Layer *layer, int16_t left, int16_t top );
+
+/**
+  * @brief  Composite an inclusive frame rectangle again at the next compose.
+  */
+void seMDC_LAYER_Damage( int16_t left, int16_t top, int16_t right, int16_t bottom );
+
+/**
+  * @brief  Render the dirty and dynamic layers and composite the damaged
+  *         rectangles into the frame buffer.
+  * @param  starty, endy:  lines written, for seMDC_PanelUpdate(). endy < starty
+  *                        when nothing was written.
+  * @retval Status: can be a value of @ref seStatus
+  */
+seStatus seMDC_LAYER_Compose( uint16_t *starty, uint16_t *endy );
+
+/**
+  * @brief  Move every surface down to the start of the pool, leaving one hole.
+  */
+void seMDC_LAYER_Defrag( void );
+
+/**
+  * @brief  Free bytes in the pool and the largest hole.
+  */
+void seMDC_LAYER_PoolInfo( uint32_t *freebytes, uint32_t *largest );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SEMDC_LAYER_H */
@@ -0,0 +1,341 @@
+/**
+  ******************************************************************************
+  * @file    semdc_pack.c
+  * @brief   Packed image unpacker and packer, see semdc_pack.h.
+  ******************************************************************************
+  */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "s1d13c00_hcl.h"
+#include "s1d13c00_trace.h"
+#include "se_common.h"
+#include "semdc_pack.h"
+
+#if (SE_MDC_PACK_WINDOW & (SE_MDC_PACK_WINDOW - 1)) || (SE_MDC_PACK_WINDOW % SE_MDC_PACK_CHUNK)
+#error "SE_MDC_PACK_WINDOW must be a power of 2 and a multiple of SE_MDC_PACK_CHUNK"
+#endif
+
+#define RING_MASK   (SE_MDC_PACK_WINDOW - 1)
+
+// Unpacker: output ring, written to controller RAM a chunk at a time
+static struct {
+    uint8_t  ring[SE_MDC_PACK_WINDOW];
+    uint32_t addr;                      // Controller address of output byte 0
+    uint32_t pos;                       // Bytes unpacked
+    uint32_t flushed;                   // Bytes written
+} unp;
+
+// Packer output
+typedef struct {
+    uint8_t  *buf;
+    uint32_t len;
+    uint32_t max;
+} Out;
+
+
+//---------------------------------------------------------------------------
+// PRIVATE FUNCTIONS
+//---------------------------------------------------------------------------
+
+static uint32_t Get32( const uint8_t *p )
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void Flush( void )
+{
+    if ( unp.pos != unp.flushed )
+    {
+        seS1D13C00WriteStart( unp.addr + unp.flushed, &unp.ring[unp.flushed & RING_MASK], unp.pos - unp.flushed );
+        unp.flushed = unp.pos;
+    }
+}
+
+static void Put( uint8_t b )
+{
+    unp.ring[unp.pos++ & RING_MASK] = b;
+    if ( unp.pos - unp.flushed == SE_MDC_PACK_CHUNK )
+        Flush();
+}
+
+// Length extension of an LZ token nibble, false if the input ends
+static bool LzLen( const uint8_t **in, const uint8_t *end, uint32_t *len )
+{
+    uint8_t b;
+
+    if ( *len != 15 )
+        return true;
+    do
+    {
+        if ( *in == end )
+            return false;
+        b = *(*in)++;
+        *len += b;
+    } while ( b == 255 );
+    return true;
+}
+
+static bool UnpackRle( const uint8_t *in, const uint8_t *end, uint32_t size )
+{
+    uint32_t n;
+    uint8_t c;
+
+    while ( unp.pos < size )
+    {
+        if ( in == end )
+            return false;
+        c = *in++;
+        if ( c < 0x80 )
+        {
+            n = (uint32_t)c + 1;
+            if ( (uint32_t)(end - in) < n || size - unp.pos < n )
+                return false;
+            while ( n-- != 0 )
+                Put( *in++ );
+        }
+        else
+        {
+            n = (uint32_t)c - 0x80 + 3;
+            if ( in == end || size - unp.pos < n )
+                return false;
+            c = *in++;
+            while ( n-- != 0 )
+                Put( c );
+        }
+    }
+    return true;
+}
+
+static bool UnpackLz( const uint8_t *in, const uint8_t *end, uint32_t size )
+{
+    uint32_t lit, mlen, off;
+    uint8_t token;
+
+    while ( unp.pos < size )
+    {
+        if ( in == end )
+            return false;
+        token = *in++;
+        lit = token >> 4;
+        if ( !LzLen( &in, end, &lit ) || (uint32_t)(end - in) < lit || size - unp.pos < lit )
+            return false;
+        while ( lit-- != 0 )
+            Put( *in++ );
+        if ( unp.pos == size )
+            break;
+
+        if ( end - in < 2 )
+            return false;
+        off = (uint32_t)in[0] | ((uint32_t)in[1] << 8);
+        in += 2;
+        mlen = token & 0x0F;
+        if ( !LzLen( &in, end, &mlen ) )
+            return false;
+        mlen += 4;
+        if ( off == 0 || off > unp.pos || off >= SE_MDC_PACK_WINDOW || size - unp.pos < mlen )
+            return false;
+        // Byte by byte, a match may overlap the bytes it makes
+        while ( mlen-- != 0 )
+            Put( unp.ring[(unp.pos - off) & RING_MASK] );
+    }
+    return true;
+}
+
+static bool Emit( Out *o, uint8_t b )
+{
+    if ( o->len == o->max )
+        return false;
+    o->buf[o->len++] = b;
+    return true;
+}
+
+static bool EmitBytes( Out *o, const uint8_t *p, uint32_t n )
+{
+    if ( o->max - o->len < n )
+        return false;
+    memcpy( &o->buf[o->len], p, n );
+    o->len += n;
+    return true;
+}
+
+static bool EmitLen( Out *o, uint32_t len )
+{
+    if ( len < 15 )
+        return true;
+    for ( len -= 15; len >= 255; len -= 255 )
+    {
+        if ( !Emit( o, 255 ) )
+            return false;
+    }
+    return Emit( o, (uint8_t)len );
+}
+
+static bool PackRle( Out *o, const uint8_t *data, uint32_t len )
+{
+    uint32_t i = 0, start = 0, run = 0;
+
+    // Literals gather from start until a run or 128 of them
+    for ( ;; )
+    {
+        if ( i < len )
+        {
+            for ( run = 1; i + run < len && run < 130 && data[i + run] == data[i]; run++ )
+                ;
+            if ( run < 3 && i - start < 128 )
+            {
+                i++;
+                continue;
+            }
+        }
+        if ( i != start )
+        {
+            if ( !Emit( o, (uint8_t)(i - start - 1) ) || !EmitBytes( o, &data[start], i - start ) )
+                return false;
+        }
+        if ( i == len )
+            return true;
+        if ( run >= 3 )
+        {
+            if ( !Emit( o, (uint8_t)(0x80 + run - 3) ) || !Emit( o, data[i] ) )
+                return false;
+            i += run;
+        }
+        start = i;
+    }
+}
+
+static bool LzSequence( Out *o, const uint8_t *lits, uint32_t lit, uint32_t off, uint32_t mlen )
+{
+    uint32_t m = (mlen != 0) ? mlen - 4 : 0;
+
+    return Emit( o, (uint8_t)(((lit < 15) ? lit : 15) << 4 | ((m < 15) ? m : 15)) ) &&
+           EmitLen( o, lit ) && EmitBytes( o, lits, lit ) &&
+           (mlen == 0 || (Emit( o, (uint8_t)off ) && Emit( o, (uint8_t)(off >> 8) ) && EmitLen( o, m )));
+}
+
+// Greedy longest match within the window; offline speed is what matters
+static bool PackLz( Out *o, const uint8_t *data, uint32_t len, uint32_t *maxoff )
+{
+    uint32_t i = 0, anchor = 0, off, l, best, bestoff;
+
+    while ( i < len )
+    {
+        best = 0;
+        bestoff = 0;
+        for ( off = 1; off <= i && off < SE_MDC_PACK_WINDOW; off++ )
+        {
+            if ( data[i - off] != data[i] || (best != 0 && (i + best >= len || data[i - off + best] != data[i + best])) )
+                continue;
+            for ( l = 1; i + l < len && data[i - off + l] == data[i + l]; l++ )
+                ;
+            if ( l > best )
+            {
+                best = l;
+                bestoff = off;
+            }
+        }
+
+        if ( best < 4 )
+        {
+            i++;
+            continue;
+        }
+        if ( !LzSequence( o, &data[anchor], i - anchor, bestoff, best ) )
+            return false;
+        if ( bestoff > *maxoff )
+            *maxoff = bestoff;
+        i += best;
+        anchor = i;
+    }
+    return anchor == len || LzSequence( o, &data[anchor], len - anchor, 0, 0 );
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seMDC_PACK_Size()
+//---------------------------------------------------------------------------
+uint32_t seMDC_PACK_Size( const uint8_t *packed )
+{
+    if ( packed[0] != seMDC_PACK_MAGIC || packed[1] > seMDC_PACK_LZ )
+        return 0;
+    return Get32( &packed[4] );
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seMDC_PACK_Load()
+//---------------------------------------------------------------------------
+seStatus seMDC_PACK_Load( uint32_t addr, const uint8_t *packed, uint32_t packedlen )
+{
+    seTRACE_API();
+    const uint8_t *in, *end;
+    uint32_t size;
+    bool ok;
+
+    if ( packedlen < seMDC_PACK_HDR_LEN || packed[0] != seMDC_PACK_MAGIC )
+        return seSTATUS_NG;
+    size = Get32( &packed[4] );
+    in   = packed + seMDC_PACK_HDR_LEN;
+    end  = packed + packedlen;
+
+    switch ( packed[1] )
+    {
+    case seMDC_PACK_RAW:
+        if ( (uint32_t)(end - in) < size )
+            return seSTATUS_NG;
+        seS1D13C00Write( addr, (uint8_t *)in, size );
+        return seSTATUS_OK;
+    case seMDC_PACK_RLE:
+        break;
+    case seMDC_PACK_LZ:
+        if ( ((uint32_t)packed[2] | ((uint32_t)packed[3] << 8)) >= SE_MDC_PACK_WINDOW )
+            return seSTATUS_NG;
+        break;
+    default:
+        return seSTATUS_NG;
+    }
+
+    unp.addr    = addr;
+    unp.pos     = 0;
+    unp.flushed = 0;
+    ok = (packed[1] == seMDC_PACK_RLE) ? UnpackRle( in, end, size ) : UnpackLz( in, end, size );
+    Flush();
+    return ok ? seSTATUS_OK : seSTATUS_NG;
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seMDC_PACK_Encode()
+//---------------------------------------------------------------------------
+uint32_t seMDC_PACK_Encode( seMDC_PACK_METHOD method, const uint8_t *data, uint32_t len,
+                            uint8_t *packed, uint32_t packedmax )
+{
+    Out o = { packed, seMDC_PACK_HDR_LEN, packedmax };
+    uint32_t maxoff = 0;
+    bool ok;
+
+    if ( packedmax < seMDC_PACK_HDR_LEN )
+        return 0;
+
+    switch ( method )
+    {
+    case seMDC_PACK_RAW: ok = EmitBytes( &o, data, len );          break;
+    case seMDC_PACK_RLE: ok = PackRle( &o, data, len );            break;
+    case seMDC_PACK_LZ:  ok = PackLz( &o, data, len, &maxoff );    break;
+    default:             ok = false;                               break;
+    }
+    if ( !ok )
+        return 0;
+
+    packed[0] = seMDC_PACK_MAGIC;
+    packed[1] = (uint8_t)method;
+    packed[2] = (uint8_t)maxoff;
+    packed[3] = (uint8_t)(maxoff >> 8);
+    packed[4] = (uint8_t)len;
+    packed[5] = (uint8_t)(len >> 8);
+    packed[6] = (uint8_t)(len >> 16);
+    packed[7] = (uint8_t)(len >> 24);
+    return o.len;
+}
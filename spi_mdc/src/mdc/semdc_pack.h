@@ -0,0 +1,95 @@
+/**
+  ******************************************************************************
+  * @file    semdc_pack.h
+  * @brief   Packed images: bitmaps and fonts compressed in host memory,
+  *          unpacked while they are written to controller RAM.
+  ******************************************************************************
+  * @attention
+  *
+  * A packed image is a seMDC_PACK_HDR_LEN byte header followed by the payload:
+  *
+  *   byte 0      seMDC_PACK_MAGIC
+  *   byte 1      method, a value of seMDC_PACK_METHOD
+  *   bytes 2-3   farthest LZ match offset used, little endian, 0 otherwise
+  *   bytes 4-7   unpacked size in bytes, little endian
+  *
+  * seMDC_PACK_RLE suits 1-bit and 2-bit bitmaps: a control byte c below 0x80
+  * is followed by c + 1 literal bytes, one from 0x80 up by a byte written
+  * c - 0x80 + 3 times. seMDC_PACK_LZ uses the sequences of LZ4 blocks: a token
+  * with the literal count in its high nibble and the match length minus 4 in
+  * its low nibble, 15 extended by bytes added up to the first below 255, the
+  * literals, then a 16-bit little endian offset back into the output and the
+  * match length extension. The last sequence has literals only. Offsets stay
+  * below SE_MDC_PACK_WINDOW, the history the unpacker keeps.
+  *
+  * seMDC_PACK_Load() unpacks into a ring of SE_MDC_PACK_WINDOW bytes and
+  * writes every SE_MDC_PACK_CHUNK bytes with seS1D13C00WriteStart(), so with
+  * a transport that starts writes, the next chunk is unpacked while the last
+  * one is on the bus. The unpacked bytes are what crosses the bus, so packing
+  * saves host flash, not transfers. seMDC_PACK_Encode() makes packed images;
+  * tools/mdc_pack.c wraps it for files on Linux.
+  ******************************************************************************
+  */
+
+#ifndef SEMDC_PACK_H
+#define SEMDC_PACK_H
+
+#include <stdint.h>
+#include "se_common.h"
+
+#ifndef SE_MDC_PACK_WINDOW
+#define SE_MDC_PACK_WINDOW      2048            ///< LZ history and unpack ring, a power of 2
+#endif
+#ifndef SE_MDC_PACK_CHUNK
+#define SE_MDC_PACK_CHUNK       256             ///< Bytes per write, divides SE_MDC_PACK_WINDOW
+#endif
+
+#define seMDC_PACK_MAGIC        0xC5U
+#define seMDC_PACK_HDR_LEN      8
+#define seMDC_PACK_BOUND(n)     (seMDC_PACK_HDR_LEN + (n) + (n) / 64 + 16)  ///< Largest packed size of n bytes
+
+typedef enum {
+    seMDC_PACK_RAW = 0U,                ///< Bytes as they are
+    seMDC_PACK_RLE = 1U,                ///< Runs of a byte and literal blocks
+    seMDC_PACK_LZ  = 2U                 ///< LZ4 block sequences within SE_MDC_PACK_WINDOW
+} seMDC_PACK_METHOD;
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+  * @brief  Unpacked size of a packed image.
+  * @retval Bytes, 0 if the header is not valid
+  */
+uint32_t seMDC_PACK_Size( const uint8_t *packed );
+
+/**
+  * @brief  Unpack an image into controller RAM.
+  * @param  addr:  controller RAM address for seMDC_PACK_Size() bytes
+  * @param  packed:  packed image in host memory
+  * @param  packedlen:  bytes at packed
+  * @retval Status: seSTATUS_NG if the image is not valid, its LZ offsets go
+  *         beyond SE_MDC_PACK_WINDOW or it ends early. What was unpacked
+  *         before the error is written.
+  */
+seStatus seMDC_PACK_Load( uint32_t addr, const uint8_t *packed, uint32_t packedlen );
+
+/**
+  * @brief  Pack an image.
+  * @param  method:  packing
+  * @param  data:  image
+  * @param  len:  bytes at data
+  * @param  packed:  output, seMDC_PACK_BOUND(len) bytes are always enough
+  * @param  packedmax:  bytes at packed
+  * @retval Bytes written to packed, 0 if they do not fit
+  */
+uint32_t seMDC_PACK_Encode( seMDC_PACK_METHOD method, const uint8_t *data, uint32_t len,
+                            uint8_t *packed, uint32_t packedmax );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SEMDC_PACK_H */
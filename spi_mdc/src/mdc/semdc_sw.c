@@ -0,0 +1,675 @@
+/**
+  ******************************************************************************
+  * @file    semdc_sw.c
+  * @brief   Software model of the MDC graphics engine, see semdc_sw.h.
+  ******************************************************************************
+  * @attention
+  *
+  * The model half (up to seMDC_SW_ImgCpyHVShear) is plain C without bus
+  * access. Image copies map every destination pixel of the transformed source
+  * bounding box back to the source in fixed point and round to the nearest
+  * source pixel, halves up.
+  ******************************************************************************
+  */
+
+#include <string.h>
+#include "s1d13c00_hcl.h"
+#include "s1d13c00_memregs.h"
+#include "s1d13c00_trace.h"
+#include "se_common.h"
+#include "se_mdc.h"
+#include "semdc_sw.h"
+
+#define NO_COST                 0xFFFFFFFFUL
+
+// sin() in 65536ths for 0 to 128 in 512ths of a turn, as sinlut in semdc_gfx.c
+static const int32_t sinq[129] = {
+        0,   804,  1608,  2412,  3216,  4019,  4821,  5623,
+     6424,  7224,  8022,  8820,  9616, 10411, 11204, 11996,
+    12785, 13573, 14359, 15143, 15924, 16703, 17479, 18253,
+    19024, 19792, 20557, 21320, 22078, 22834, 23586, 24335,
+    25080, 25821, 26558, 27291, 28020, 28745, 29466, 30182,
+    30893, 31600, 32303, 33000, 33692, 34380, 35062, 35738,
+    36410, 37076, 37736, 38391, 39040, 39683, 40320, 40951,
+    41576, 42194, 42806, 43412, 44011, 44604, 45190, 45769,
+    46341, 46906, 47464, 48015, 48559, 49095, 49624, 50146,
+    50660, 51166, 51665, 52156, 52639, 53114, 53581, 54040,
+    54491, 54934, 55368, 55794, 56212, 56621, 57022, 57414,
+    57798, 58172, 58538, 58896, 59244, 59583, 59914, 60235,
+    60547, 60851, 61145, 61429, 61705, 61971, 62228, 62476,
+    62714, 62943, 63162, 63372, 63572, 63763, 63944, 64115,
+    64277, 64429, 64571, 64704, 64827, 64940, 65043, 65137,
+    65220, 65294, 65358, 65413, 65457, 65492, 65516, 65531,
+    65536
+};
+
+
+//---------------------------------------------------------------------------
+// Model
+//---------------------------------------------------------------------------
+
+// Source window of an image copy
+typedef struct {
+    const uint8_t *buf;
+    uint32_t       size;
+    uint16_t       stride;
+    int32_t        width;
+    int32_t        height;
+    uint16_t       ctl;                         // GFXCTL bits
+    uint8_t        color;
+} Source;
+
+// Inverse map u = (m0 dx + m1 dy) 256 / uden, v = (m2 dx + m3 dy) 256 / vden,
+// the denominator chosen by the sign of the numerator. Forward map for the
+// bounding box o = (f0 e + f1 e') / fden.
+typedef struct {
+    int64_t m[4];
+    int64_t uden[2];                            // Numerator < 0, >= 0
+    int64_t vden[2];
+    int64_t f[4];
+    int64_t fden;
+} Xform;
+
+static int64_t FloorDiv( int64_t a, int64_t b )
+{
+    int64_t q = a / b;
+
+    if ( (a % b) != 0 && (a < 0) != (b < 0) )
+        q--;
+    return q;
+}
+
+// Nearest integer to a / b, halves up, b > 0
+static int32_t RoundDiv( int64_t a, int64_t b )
+{
+    return (int32_t)FloorDiv( 2 * a + b, 2 * b );
+}
+
+static void SinCos( uint16_t rotval, int32_t *s, int32_t *c )
+{
+    uint16_t a = rotval & 0x1FF;
+
+    if ( a < 128 )      { *s =  sinq[a];       *c =  sinq[128 - a]; }
+    else if ( a < 256 ) { *s =  sinq[256 - a]; *c = -sinq[a - 128]; }
+    else if ( a < 384 ) { *s = -sinq[a - 256]; *c = -sinq[384 - a]; }
+    else                { *s = -sinq[512 - a]; *c =  sinq[a - 384]; }
+}
+
+static void PutPx( seMDC_SW_Target *tgt, int32_t x, int32_t y, uint8_t val )
+{
+    int64_t ofs;
+
+    if ( x < tgt->left || x > tgt->right || y < tgt->top || y > tgt->bot )
+        return;
+    tgt->pxvisited++;
+    ofs = (int64_t)(y - tgt->originy) * tgt->stride + (x - tgt->originx);
+    if ( tgt->buf != NULL && ofs >= 0 && ofs < tgt->size )
+        tgt->buf[ofs] = val;
+    else
+        tgt->badaccess++;
+}
+
+static void FillRect( seMDC_SW_Target *tgt, int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint8_t color )
+{
+    int32_t x, y;
+
+    for ( y = y1; y <= y2; y++ )
+    {
+        for ( x = x1; x <= x2; x++ )
+            PutPx( tgt, x, y, color );
+    }
+}
+
+static int32_t Thick( uint16_t t )
+{
+    return (t == 0) ? 1 : t;
+}
+
+static bool InEllipse( int64_t dx, int64_t dy, int64_t rx, int64_t ry )
+{
+    if ( rx <= 0 || ry <= 0 )
+        return false;
+    return dx * dx * ry * ry + dy * dy * rx * rx <= rx * rx * ry * ry;
+}
+
+// Source pixel at (sx, sy), -1 if transparent or outside the source
+static int32_t SrcPx( seMDC_SW_Target *tgt, const Source *src, int32_t sx, int32_t sy )
+{
+    uint32_t ofs;
+    uint8_t  b;
+
+    if ( sx < 0 || sy < 0 || sx >= src->width || sy >= src->height )
+        return -1;
+
+    if ( !(src->ctl & MDC_BITMAPEN_bits) )
+        ofs = (uint32_t)sy * src->stride + (uint32_t)sx;
+    else if ( !(src->ctl & MDC_BITMAPFMT_bits) )
+        ofs = (uint32_t)sy * ((src->stride >> 3) + 1) + (uint32_t)(sx >> 3);
+    else
+        ofs = (uint32_t)sy * ((src->stride >> 2) + 1) + (uint32_t)(sx >> 2);
+
+    if ( src->buf == NULL || ofs >= src->size )
+    {
+        tgt->badaccess++;
+        b = 0;
+    }
+    else
+        b = src->buf[ofs];
+
+    if ( !(src->ctl & MDC_BITMAPEN_bits) )
+        return b;
+    if ( !(src->ctl & MDC_BITMAPFMT_bits) )
+        return (b & (0x80 >> (sx & 7))) ? src->color : -1;
+    return ((b >> (6 - 2 * (sx & 3))) & 3) ? src->color : -1;
+}
+
+static void CopyRun( seMDC_SW_Target *tgt, const Source *src, const Xform *xf,
+                     int32_t ocx, int32_t ocy, int32_t icx, int32_t icy )
+{
+    int32_t cx[4] = { -icx, src->width - icx, -icx, src->width - icx };
+    int32_t cy[4] = { -icy, -icy, src->height - icy, src->height - icy };
+    int64_t minx = INT64_MAX, maxx = INT64_MIN, miny = INT64_MAX, maxy = INT64_MIN;
+    int64_t un, vn;
+    int32_t x, y, x1, x2, y1, y2, u, v, px, i;
+
+    // Bounding box of the transformed source corners
+    for ( i = 0; i < 4; i++ )
+    {
+        int64_t ex = (src->ctl & MDC_CPYNEGX_bits) ? -cx[i] : cx[i];
+        int64_t ey = (src->ctl & MDC_CPYNEGY_bits) ? -cy[i] : cy[i];
+        int64_t ox = xf->f[0] * ex + xf->f[1] * ey;
+        int64_t oy = xf->f[2] * ex + xf->f[3] * ey;
+        if ( ox < minx ) minx = ox;
+        if ( ox > maxx ) maxx = ox;
+        if ( oy < miny ) miny = oy;
+        if ( oy > maxy ) maxy = oy;
+    }
+    x1 = (int32_t)FloorDiv( minx, xf->fden ) - 1;
+    x2 = (int32_t)-FloorDiv( -maxx, xf->fden ) + 1;
+    y1 = (int32_t)FloorDiv( miny, xf->fden ) - 1;
+    y2 = (int32_t)-FloorDiv( -maxy, xf->fden ) + 1;
+
+    for ( y = y1; y <= y2; y++ )
+    {
+        if ( ocy + y < tgt->top || ocy + y > tgt->bot )
+            continue;
+        for ( x = x1; x <= x2; x++ )
+        {
+            if ( ocx + x < tgt->left || ocx + x > tgt->right )
+                continue;
+            un = xf->m[0] * x + xf->m[1] * y;
+            vn = xf->m[2] * x + xf->m[3] * y;
+            u  = RoundDiv( un * 256, xf->uden[un >= 0] );
+            v  = RoundDiv( vn * 256, xf->vden[vn >= 0] );
+            if ( src->ctl & MDC_CPYNEGX_bits ) u = -u;
+            if ( src->ctl & MDC_CPYNEGY_bits ) v = -v;
+            px = SrcPx( tgt, src, icx + u, icy + v );
+            if ( px >= 0 )
+                PutPx( tgt, ocx + x, ocy + y, (uint8_t)px );
+            else
+                tgt->pxvisited++;                   // Visited, nothing written
+        }
+    }
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seMDC_SW_InitTarget()
+//---------------------------------------------------------------------------
+void seMDC_SW_InitTarget( seMDC_SW_Target *tgt, uint8_t *buf, uint32_t size,
+                          uint16_t stride, uint16_t width, uint16_t height )
+{
+    memset( tgt, 0, sizeof( *tgt ) );
+    tgt->buf    = buf;
+    tgt->size   = size;
+    tgt->stride = stride;
+    tgt->right  = (int32_t)width - 1;
+    tgt->bot    = (int32_t)height - 1;
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seMDC_SW_DrawLine()
+//---------------------------------------------------------------------------
+void seMDC_SW_DrawLine( seMDC_SW_Target *tgt, uint16_t point1x, uint16_t point1y, uint16_t point2x, uint16_t point2y,
+                        uint16_t pencolor, uint16_t thickness )
+{
+    int32_t x0 = point1x, y0 = point1y;
+    int32_t x1 = point2x, y1 = point2y;
+    int32_t t  = Thick( thickness );
+    int32_t dx = (x1 > x0) ? x1 - x0 : x0 - x1;
+    int32_t dy = (y1 > y0) ? y0 - y1 : y1 - y0;
+    int32_t sx = (x0 < x1) ? 1 : -1;
+    int32_t sy = (y0 < y1) ? 1 : -1;
+    int32_t err = dx + dy, e2;
+    int32_t lo = -(t - 1) / 2, hi = t / 2, k;
+    bool    xmajor = dx >= -dy;
+
+    // Bresenham, the pen is a span across the major direction
+    for ( ;; )
+    {
+        for ( k = lo; k <= hi; k++ )
+        {
+            if ( xmajor )
+                PutPx( tgt, x0, y0 + k, (uint8_t)pencolor );
+            else
+                PutPx( tgt, x0 + k, y0, (uint8_t)pencolor );
+        }
+        if ( x0 == x1 && y0 == y1 )
+            break;
+        e2 = 2 * err;
+        if ( e2 >= dy ) { err += dy; x0 += sx; }
+        if ( e2 <= dx ) { err += dx; y0 += sy; }
+    }
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seMDC_SW_DrawRectangle()
+//---------------------------------------------------------------------------
+void seMDC_SW_DrawRectangle( seMDC_SW_Target *tgt, uint16_t tlcornerx, uint16_t tlcornery, uint16_t brcornerx, uint16_t brcornery,
+                             uint16_t pencolor, uint16_t vlinethick, uint16_t hlinethick, uint8_t fillenable )
+{
+    int32_t x1 = tlcornerx, y1 = tlcornery;
+    int32_t x2 = brcornerx, y2 = brcornery;
+    int32_t vt = Thick( vlinethick ), ht = Thick( hlinethick );
+    uint8_t c  = (uint8_t)pencolor;
+
+    if ( fillenable )
+    {
+        FillRect( tgt, x1, y1, x2, y2, c );
+        return;
+    }
+    FillRect( tgt, x1, y1, x2, y1 + ht - 1, c );
+    FillRect( tgt, x1, y2 - ht + 1, x2, y2, c );
+    FillRect( tgt, x1, y1 + ht, x1 + vt - 1, y2 - ht, c );
+    FillRect( tgt, x2 - vt + 1, y1 + ht, x2, y2 - ht, c );
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seMDC_SW_DrawEllipse()
+//---------------------------------------------------------------------------
+void seMDC_SW_DrawEllipse( seMDC_SW_Target *tgt, uint16_t centerx, uint16_t centery, uint16_t radiusx, uint16_t radiusy,
+                           uint16_t pencolor, uint16_t xcrossthick, uint16_t ycrossthick, uint8_t fillenable )
+{
+    int32_t cx = centerx, cy = centery;
+    int32_t rx = radiusx, ry = radiusy;
+    int32_t xt = Thick( xcrossthick ), yt = Thick( ycrossthick );
+    int32_t x, y;
+
+    for ( y = -ry; y <= ry; y++ )
+    {
+        for ( x = -rx; x <= rx; x++ )
+        {
+            if ( !InEllipse( x, y, rx, ry ) )
+                continue;
+            if ( !fillenable && InEllipse( x, y, rx - xt, ry - yt ) )
+                continue;
+            PutPx( tgt, cx + x, cy + y, (uint8_t)pencolor );
+        }
+    }
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seMDC_SW_ImgCpyRotScale()
+//---------------------------------------------------------------------------
+void seMDC_SW_ImgCpyRotScale( seMDC_SW_Target *tgt, uint16_t ocenterx, uint16_t ocentery,
+                              const uint8_t *src, uint32_t srcsize, uint16_t istride, uint16_t iwidth, uint16_t iheight,
+                              uint16_t icenterx, uint16_t icentery,
+                              uint16_t fillcolor, uint16_t rotval,
+                              uint16_t xlscale, uint16_t xrscale, uint16_t ytscale, uint16_t ybscale,
+                              const seMDC_ImgCopyRotScaleCtrl *ctrl_ptr )
+{
+    Source  s = { src, srcsize, istride, iwidth, iheight, ctrl_ptr->ctrlword, (uint8_t)fillcolor };
+    Xform   xf;
+    int64_t sx = (xlscale > xrscale) ? xlscale : xrscale;
+    int64_t sy = (ytscale > ybscale) ? ytscale : ybscale;
+    int32_t sn, cs;
+
+    if ( xlscale == 0 || xrscale == 0 || ytscale == 0 || ybscale == 0 )
+        return;
+
+    // Rotate back, then undo the scale of the half the point is in
+    SinCos( rotval, &sn, &cs );
+    xf.m[0]    = cs;   xf.m[1] = sn;
+    xf.m[2]    = -sn;  xf.m[3] = cs;
+    xf.uden[0] = (int64_t)xlscale * 65536;
+    xf.uden[1] = (int64_t)xrscale * 65536;
+    xf.vden[0] = (int64_t)ytscale * 65536;
+    xf.vden[1] = (int64_t)ybscale * 65536;
+    xf.f[0]    = cs * sx;  xf.f[1] = -sn * sy;
+    xf.f[2]    = sn * sx;  xf.f[3] = cs * sy;
+    xf.fden    = 65536 * 256;
+    CopyRun( tgt, &s, &xf, (int16_t)ocenterx, (int16_t)ocentery, (int16_t)icenterx, (int16_t)icentery );
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seMDC_SW_ImgCpyHVShear()
+//---------------------------------------------------------------------------
+void seMDC_SW_ImgCpyHVShear( seMDC_SW_Target *tgt, uint16_t ocenterx, uint16_t ocentery,
+                             const uint8_t *src, uint32_t srcsize, uint16_t istride, uint16_t iwidth, uint16_t iheight,
+                             uint16_t icenterx, uint16_t icentery,
+                             uint16_t fillcolor,
+                             const seMDC_ImgCopyHVShearCtrl *ctrl_ptr )
+{
+    Source  s = { src, srcsize, istride, iwidth, iheight, ctrl_ptr->ctrlword, (uint8_t)fillcolor };
+    Xform   xf;
+    int64_t hx = ctrl_ptr->shearctrl_b.xshear;
+    int64_t vy = ctrl_ptr->shearctrl_b.yshear;
+
+    if ( ctrl_ptr->ctrlword & MDC_SHEARNEGX_bits ) hx = -hx;
+    if ( ctrl_ptr->ctrlword & MDC_SHEARNEGY_bits ) vy = -vy;
+
+    // Shear values are below 1, so the determinant 65536 - hx vy is positive
+    xf.m[0]    = 256;  xf.m[1] = -hx;
+    xf.m[2]    = -vy;  xf.m[3] = 256;
+    xf.uden[0] = xf.uden[1] = 65536 - hx * vy;
+    xf.vden[0] = xf.vden[1] = 65536 - hx * vy;
+    xf.f[0]    = 256;  xf.f[1] = hx;
+    xf.f[2]    = vy;   xf.f[3] = 256;
+    xf.fden    = 256;
+    CopyRun( tgt, &s, &xf, (int16_t)ocenterx, (int16_t)ocentery, (int16_t)icenterx, (int16_t)icentery );
+}
+
+
+//---------------------------------------------------------------------------
+// Cost model and automatic selection
+//---------------------------------------------------------------------------
+
+#define WR16                    (SE_HCL_WRITE_HDR_LEN + 2 + SE_MDC_SW_XACT_COST)
+#define WR8                     (SE_HCL_WRITE_HDR_LEN + 1 + SE_MDC_SW_XACT_COST)
+#define RD16                    (SE_HCL_READ_HDR_LEN + 2 + SE_MDC_SW_XACT_COST)
+
+// seMDC_WaitGfxDone() with one poll: enable, poll, clear
+#define COST_WAIT               (WR8 + RD16 + WR8)
+// seMDC_DrawLine(): 6 parameters, flag clear, GFXCTL read-modify-write, trigger
+#define COST_LINE               (6 * WR16 + WR8 + RD16 + WR16 + WR8 + COST_WAIT)
+// seMDC_DrawRectangle(), seMDC_DrawEllipse(): 7 parameters and a second read-modify-write for FILLEN
+#define COST_RECT               (7 * WR16 + 2 * (RD16 + WR16) + 2 * WR8 + COST_WAIT)
+
+static struct {
+    bool     valid;
+    uint32_t base;
+    uint16_t stride;
+    int32_t  left, top, right, bot;
+} outwin;
+
+static seMDC_SW_Stats swstats;
+
+
+// runs accesses of len bytes each, split as the HCL splits them
+static uint32_t RunCost( uint32_t runs, uint32_t len, uint32_t hdr )
+{
+    uint32_t max    = seS1D13C00GetTransport()->max_data;
+    uint32_t chunks = (max == 0 || len <= max) ? 1 : (len + max - 1) / max;
+
+    return runs * (chunks * (hdr + SE_MDC_SW_XACT_COST) + len);
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seMDC_SW_SyncOutput()
+//---------------------------------------------------------------------------
+void seMDC_SW_SyncOutput( void )
+{
+    uint16_t owright = seS1D13C00Read16( MDC_GFXOWRIGHT );
+    uint16_t owbot   = seS1D13C00Read16( MDC_GFXOWBOT );
+
+    outwin.base   = seS1D13C00Read32( MDC_GFXOBADDR0 );
+    outwin.stride = seS1D13C00Read16( MDC_GFXOSTRIDE );
+    outwin.left   = 0;
+    outwin.top    = 0;
+    outwin.right  = (int32_t)seS1D13C00Read16( MDC_GFXOWIDTH ) - 1;
+    outwin.bot    = (int32_t)seS1D13C00Read16( MDC_GFXOHEIGHT ) - 1;
+
+    // Same clip rule as the emulator, see s1d13c00_emu.h
+    if ( owright != 0 || owbot != 0 )
+    {
+        uint16_t owleft = seS1D13C00Read16( MDC_GFXOWLEFT );
+        uint16_t owtop  = seS1D13C00Read16( MDC_GFXOWTOP );
+
+        if ( owleft > outwin.left )  outwin.left  = owleft;
+        if ( owtop > outwin.top )    outwin.top   = owtop;
+        if ( owright < outwin.right ) outwin.right = owright;
+        if ( owbot < outwin.bot )    outwin.bot   = owbot;
+    }
+    outwin.valid = true;
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seMDC_SW_Cost()
+//---------------------------------------------------------------------------
+void seMDC_SW_Cost( seMDC_GFXFUNC func, int32_t x1, int32_t y1, int32_t x2, int32_t y2, bool opaque,
+                    seMDC_SW_CostEst *cost )
+{
+    uint32_t w, h, runs, len;
+
+    if ( !outwin.valid )
+        seMDC_SW_SyncOutput();
+
+    cost->engine = (func == seMDC_FUNC_LINEDRAW) ? COST_LINE : COST_RECT;
+    cost->local  = NO_COST;
+    if ( x2 < x1 || y2 < y1 )
+    {
+        cost->local = 0;
+        return;
+    }
+
+    w = (uint32_t)(x2 - x1 + 1);
+    h = (uint32_t)(y2 - y1 + 1);
+    if ( w * h > SE_MDC_SW_MAX_TILE || func > seMDC_FUNC_ELLIPDRAW || func < seMDC_FUNC_RECTDRAW )
+        return;
+
+    // Whole lines are one access, anything narrower one access per line
+    runs = (h == 1 || w == outwin.stride) ? 1 : h;
+    len  = w * h / runs;
+    cost->local = RunCost( runs, len, SE_HCL_WRITE_HDR_LEN );
+    if ( !opaque )
+        cost->local += RunCost( runs, len, SE_HCL_READ_HDR_LEN );
+}
+
+
+// Arguments of the draw call, in the order of its parameters
+typedef struct {
+    uint16_t a[8];
+} DrawArgs;
+
+static void DrawModel( seMDC_SW_Target *tgt, seMDC_GFXFUNC func, const DrawArgs *d )
+{
+    const uint16_t *a = d->a;
+
+    if ( func == seMDC_FUNC_LINEDRAW )
+        seMDC_SW_DrawLine( tgt, a[0], a[1], a[2], a[3], a[4], a[5] );
+    else if ( func == seMDC_FUNC_RECTDRAW )
+        seMDC_SW_DrawRectangle( tgt, a[0], a[1], a[2], a[3], a[4], a[5], a[6], (uint8_t)a[7] );
+    else
+        seMDC_SW_DrawEllipse( tgt, a[0], a[1], a[2], a[3], a[4], a[5], a[6], (uint8_t)a[7] );
+}
+
+static seStatus DrawEngine( seMDC_GFXFUNC func, const DrawArgs *d )
+{
+    const uint16_t *a = d->a;
+    seStatus        status;
+
+    if ( func == seMDC_FUNC_LINEDRAW )
+        status = seMDC_DrawLine( a[0], a[1], a[2], a[3], a[4], a[5] );
+    else if ( func == seMDC_FUNC_RECTDRAW )
+        status = seMDC_DrawRectangle( a[0], a[1], a[2], a[3], a[4], a[5], a[6], (uint8_t)a[7] );
+    else
+        status = seMDC_DrawEllipse( a[0], a[1], a[2], a[3], a[4], a[5], a[6], (uint8_t)a[7] );
+    if ( status == seSTATUS_OK )
+        seMDC_WaitGfxDone();
+    return status;
+}
+
+// Move the tile between the frame buffer and host memory
+static void TileXfer( bool write, uint8_t *tile, int32_t x1, int32_t y1, uint32_t w, uint32_t h )
+{
+    uint32_t addr = outwin.base + (uint32_t)y1 * outwin.stride + (uint32_t)x1;
+    uint32_t r;
+
+    if ( h == 1 || w == outwin.stride )
+    {
+        if ( write )
+            seS1D13C00Write( addr, tile, w * h );
+        else
+            seS1D13C00Read( addr, tile, w * h );
+        return;
+    }
+    for ( r = 0; r < h; r++, addr += outwin.stride, tile += w )
+    {
+        if ( write )
+            seS1D13C00Write( addr, tile, w );
+        else
+            seS1D13C00Read( addr, tile, w );
+    }
+}
+
+// bx1..by2: box the primitive can touch, opaque if it covers all of it
+static seStatus Dispatch( seMDC_GFXFUNC func, const DrawArgs *d,
+                          int32_t bx1, int32_t by1, int32_t bx2, int32_t by2, bool opaque )
+{
+    uint8_t          tile[SE_MDC_SW_MAX_TILE];
+    seMDC_SW_Target  tgt;
+    seMDC_SW_CostEst cost;
+    uint32_t         w, h;
+
+    if ( !outwin.valid )
+        seMDC_SW_SyncOutput();
+
+    if ( bx1 < outwin.left )  bx1 = outwin.left;
+    if ( by1 < outwin.top )   by1 = outwin.top;
+    if ( bx2 > outwin.right ) bx2 = outwin.right;
+    if ( by2 > outwin.bot )   by2 = outwin.bot;
+
+    seMDC_SW_Cost( func, bx1, by1, bx2, by2, opaque, &cost );
+    if ( cost.local >= cost.engine )
+    {
+        swstats.engine_ops++;
+        return DrawEngine( func, d );
+    }
+
+    swstats.local_ops++;
+    swstats.cost_saved += cost.engine - cost.local;
+    if ( bx2 < bx1 || by2 < by1 )
+        return seSTATUS_OK;                     // Nothing visible
+
+    w = (uint32_t)(bx2 - bx1 + 1);
+    h = (uint32_t)(by2 - by1 + 1);
+    memset( &tgt, 0, sizeof( tgt ) );
+    tgt.buf     = tile;
+    tgt.size    = w * h;
+    tgt.stride  = (uint16_t)w;
+    tgt.originx = bx1;
+    tgt.originy = by1;
+    tgt.left    = bx1;
+    tgt.top     = by1;
+    tgt.right   = bx2;
+    tgt.bot     = by2;
+
+    if ( !opaque )
+        TileXfer( false, tile, bx1, by1, w, h );
+    DrawModel( &tgt, func, d );
+    TileXfer( true, tile, bx1, by1, w, h );
+
+    return seSTATUS_OK;
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seMDC_SW_AutoDrawLine()
+//---------------------------------------------------------------------------
+seStatus seMDC_SW_AutoDrawLine( uint16_t point1x, uint16_t point1y, uint16_t point2x, uint16_t point2y,
+                                uint16_t pencolor, uint16_t thickness )
+{
+    seTRACE_API();
+    DrawArgs d;
+    int32_t  x1, y1, x2, y2, t, lo, hi;
+    bool     xmajor;
+
+    // As seMDC_DrawLine() programs them
+    d.a[0] = (point1x >= 0x8000) ? 0 : point1x;
+    d.a[1] = (point1y >= 0x8000) ? 0 : point1y;
+    d.a[2] = (point2x >= 0x8000) ? 0 : point2x;
+    d.a[3] = (point2y >= 0x8000) ? 0 : point2y;
+    d.a[4] = pencolor;
+    d.a[5] = thickness;
+
+    x1 = (d.a[0] < d.a[2]) ? d.a[0] : d.a[2];
+    x2 = (d.a[0] < d.a[2]) ? d.a[2] : d.a[0];
+    y1 = (d.a[1] < d.a[3]) ? d.a[1] : d.a[3];
+    y2 = (d.a[1] < d.a[3]) ? d.a[3] : d.a[1];
+    t  = Thick( thickness );
+    lo = -(t - 1) / 2;
+    hi = t / 2;
+
+    // The pen spans the minor direction; axis-parallel lines fill their box
+    xmajor = (x2 - x1) >= (y2 - y1);
+    if ( xmajor )
+        return Dispatch( seMDC_FUNC_LINEDRAW, &d, x1, y1 + lo, x2, y2 + hi, y1 == y2 );
+    return Dispatch( seMDC_FUNC_LINEDRAW, &d, x1 + lo, y1, x2 + hi, y2, x1 == x2 );
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seMDC_SW_AutoDrawRectangle()
+//---------------------------------------------------------------------------
+seStatus seMDC_SW_AutoDrawRectangle( uint16_t tlcornerx, uint16_t tlcornery, uint16_t brcornerx, uint16_t brcornery,
+                                     uint16_t pencolor, uint16_t vlinethick, uint16_t hlinethick, uint8_t fillenable )
+{
+    seTRACE_API();
+    DrawArgs d;
+    int32_t  vt = Thick( vlinethick ), ht = Thick( hlinethick );
+    int32_t  x1, y1, x2, y2;
+
+    // As seMDC_DrawRectangle() checks and programs them
+    x1 = (tlcornerx >= 0x8000) ? 0 : tlcornerx;
+    y1 = (tlcornery >= 0x8000) ? 0 : tlcornery;
+    x2 = (brcornerx >= 0x8000) ? 0 : brcornerx;
+    y2 = (brcornery >= 0x8000) ? 0 : brcornery;
+    if ( (y2 < y1) || (x2 < x1) )
+        return seSTATUS_NG;
+    d = (DrawArgs){ { (uint16_t)x1, (uint16_t)y1, (uint16_t)x2, (uint16_t)y2, pencolor, vlinethick, hlinethick, fillenable } };
+
+    if ( fillenable )
+        return Dispatch( seMDC_FUNC_RECTDRAW, &d, x1, y1, x2, y2, true );
+
+    // Borders thicker than the rectangle reach past its corners
+    return Dispatch( seMDC_FUNC_RECTDRAW, &d,
+                     (x2 - vt + 1 < x1) ? x2 - vt + 1 : x1, (y2 - ht + 1 < y1) ? y2 - ht + 1 : y1,
+                     (x1 + vt - 1 > x2) ? x1 + vt - 1 : x2, (y1 + ht - 1 > y2) ? y1 + ht - 1 : y2, false );
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seMDC_SW_AutoDrawEllipse()
+//---------------------------------------------------------------------------
+seStatus seMDC_SW_AutoDrawEllipse( uint16_t centerx, uint16_t centery, uint16_t radiusx, uint16_t radiusy,
+                                   uint16_t pencolor, uint16_t xcrossthick, uint16_t ycrossthick, uint8_t fillenable )
+{
+    seTRACE_API();
+    DrawArgs d = { { centerx, centery, radiusx, radiusy, pencolor, xcrossthick, ycrossthick, fillenable } };
+
+    if ( radiusx == 0 || radiusy == 0 )
+        return Dispatch( seMDC_FUNC_ELLIPDRAW, &d, 0, 0, -1, -1, true );
+    return Dispatch( seMDC_FUNC_ELLIPDRAW, &d, (int32_t)centerx - radiusx, (int32_t)centery - radiusy,
+                     (int32_t)centerx + radiusx, (int32_t)centery + radiusy, false );
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seMDC_SW_GetStats(), seMDC_SW_ResetStats()
+//---------------------------------------------------------------------------
+void seMDC_SW_GetStats( seMDC_SW_Stats *stats )
+{
+    *stats = swstats;
+}
+
+void seMDC_SW_ResetStats( void )
+{
+    memset( &swstats, 0, sizeof( swstats ) );
+}
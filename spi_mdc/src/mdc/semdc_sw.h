@@ -0,0 +1,157 @@
+/**
+  ******************************************************************************
+  * @file    semdc_sw.h
+  * @brief   Software model of the MDC graphics engine, and a host-side
+  *          fallback that uses it for primitives cheaper to draw locally.
+  ******************************************************************************
+  * @attention
+  *
+  * seMDC_SW_Draw*() and seMDC_SW_ImgCpy*() take the same arguments as the
+  * seMDC_Draw*() and seMDC_ImgCpy*() functions that program the engine, plus
+  * the target, and produce the same pixels in an 8 bpp frame buffer in host
+  * memory. They use integer arithmetic only, so results are identical on every
+  * host, and they do not touch the bus. The emulator draws with them, so they
+  * are the golden model for pixel tests of the higher level renderers. They
+  * follow the model assumptions listed in s1d13c00_emu.h, which are only as
+  * exact as the register description.
+  *
+  * seMDC_SW_AutoDraw*() draw through the engine or locally, whichever the cost
+  * model says is cheaper on the bus. A local draw reads the bounding box from
+  * the frame buffer unless the primitive covers all of it, draws into a tile
+  * of at most SE_MDC_SW_MAX_TILE pixels and writes the tile back. Costs are in
+  * byte times: bytes on the wire plus SE_MDC_SW_XACT_COST per transaction for
+  * chip select and driver overhead. Both paths wait for completion, and the
+  * engine must be idle when they are called.
+  ******************************************************************************
+  */
+
+#ifndef SEMDC_SW_H
+#define SEMDC_SW_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "se_common.h"
+#include "se_mdc.h"
+
+#ifndef SE_MDC_SW_MAX_TILE
+#define SE_MDC_SW_MAX_TILE      256             ///< Largest local draw in pixels, also its stack buffer
+#endif
+
+#ifndef SE_MDC_SW_XACT_COST
+#define SE_MDC_SW_XACT_COST     8               ///< Overhead of one transaction in byte times
+#endif
+
+
+/**
+  * @brief  Where the model draws: a frame buffer or a tile of one.
+  */
+typedef struct {
+    uint8_t  *buf;                      ///< Pixel (originx, originy), 8 bpp
+    uint32_t size;                      ///< Bytes addressable from buf
+    uint16_t stride;                    ///< Bytes per line
+    int32_t  originx;                   ///< Output window coordinates of buf[0]
+    int32_t  originy;
+    int32_t  left;                      ///< Inclusive clip in output window coordinates
+    int32_t  top;
+    int32_t  right;
+    int32_t  bot;
+    uint32_t pxvisited;                 ///< Destination pixels visited, the engine time driver
+    uint32_t badaccess;                 ///< Accesses outside buf or the source
+} seMDC_SW_Target;
+
+
+/**
+  * @brief  Bus cost of one operation, see seMDC_SW_Cost().
+  */
+typedef struct {
+    uint32_t engine;                    ///< Programming the engine and waiting once
+    uint32_t local;                     ///< Tile read (if needed) and write, 0xFFFFFFFF if not possible
+} seMDC_SW_CostEst;
+
+
+/**
+  * @brief  Counters since seMDC_SW_ResetStats().
+  */
+typedef struct {
+    uint32_t engine_ops;                ///< Auto draws sent to the engine
+    uint32_t local_ops;                 ///< Auto draws rendered on the host
+    uint32_t cost_saved;                ///< Sum of engine - local cost over the local draws
+} seMDC_SW_Stats;
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+  * @brief  Target covering a whole output window, origin 0 and no clip
+  *         beyond the window.
+  */
+void seMDC_SW_InitTarget( seMDC_SW_Target *tgt, uint8_t *buf, uint32_t size,
+                          uint16_t stride, uint16_t width, uint16_t height );
+
+void seMDC_SW_DrawLine( seMDC_SW_Target *tgt, uint16_t point1x, uint16_t point1y, uint16_t point2x, uint16_t point2y,
+                        uint16_t pencolor, uint16_t thickness );
+
+void seMDC_SW_DrawRectangle( seMDC_SW_Target *tgt, uint16_t tlcornerx, uint16_t tlcornery, uint16_t brcornerx, uint16_t brcornery,
+                             uint16_t pencolor, uint16_t vlinethick, uint16_t hlinethick, uint8_t fillenable );
+
+void seMDC_SW_DrawEllipse( seMDC_SW_Target *tgt, uint16_t centerx, uint16_t centery, uint16_t radiusx, uint16_t radiusy,
+                           uint16_t pencolor, uint16_t xcrossthick, uint16_t ycrossthick, uint8_t fillenable );
+
+/**
+  * @brief  Image copies. src and srcsize replace ibaseaddr; src is the source
+  *         window in host memory.
+  */
+void seMDC_SW_ImgCpyRotScale( seMDC_SW_Target *tgt, uint16_t ocenterx, uint16_t ocentery,
+                              const uint8_t *src, uint32_t srcsize, uint16_t istride, uint16_t iwidth, uint16_t iheight,
+                              uint16_t icenterx, uint16_t icentery,
+                              uint16_t fillcolor, uint16_t rotval,
+                              uint16_t xlscale, uint16_t xrscale, uint16_t ytscale, uint16_t ybscale,
+                              const seMDC_ImgCopyRotScaleCtrl *ctrl_ptr );
+
+void seMDC_SW_ImgCpyHVShear( seMDC_SW_Target *tgt, uint16_t ocenterx, uint16_t ocentery,
+                             const uint8_t *src, uint32_t srcsize, uint16_t istride, uint16_t iwidth, uint16_t iheight,
+                             uint16_t icenterx, uint16_t icentery,
+                             uint16_t fillcolor,
+                             const seMDC_ImgCopyHVShearCtrl *ctrl_ptr );
+
+/**
+  * @brief  Read the destination window registers into the cache the auto
+  *         draws use. Call after changing the destination or clip window; the
+  *         first auto draw calls it if it has not been called.
+  */
+void seMDC_SW_SyncOutput( void );
+
+/**
+  * @brief  Estimated bus cost of drawing through the engine and locally.
+  * @param  func:  seMDC_FUNC_LINEDRAW, seMDC_FUNC_RECTDRAW or seMDC_FUNC_ELLIPDRAW
+  * @param  x1, y1, x2, y2:  inclusive bounding box in output window coordinates
+  * @param  opaque:  the primitive covers every pixel of the box, no read needed
+  */
+void seMDC_SW_Cost( seMDC_GFXFUNC func, int32_t x1, int32_t y1, int32_t x2, int32_t y2, bool opaque,
+                    seMDC_SW_CostEst *cost );
+
+/**
+  * @brief  Draw through the engine or locally, whichever is cheaper, and wait
+  *         for completion. Arguments as seMDC_DrawLine(), seMDC_DrawRectangle()
+  *         and seMDC_DrawEllipse().
+  * @retval Status: can be a value of @ref seStatus
+  */
+seStatus seMDC_SW_AutoDrawLine( uint16_t point1x, uint16_t point1y, uint16_t point2x, uint16_t point2y,
+                                uint16_t pencolor, uint16_t thickness );
+
+seStatus seMDC_SW_AutoDrawRectangle( uint16_t tlcornerx, uint16_t tlcornery, uint16_t brcornerx, uint16_t brcornery,
+                                     uint16_t pencolor, uint16_t vlinethick, uint16_t hlinethick, uint8_t fillenable );
+
+seStatus seMDC_SW_AutoDrawEllipse( uint16_t centerx, uint16_t centery, uint16_t radiusx, uint16_t radiusy,
+                                   uint16_t pencolor, uint16_t xcrossthick, uint16_t ycrossthick, uint8_t fillenable );
+
+void seMDC_SW_GetStats( seMDC_SW_Stats *stats );
+void seMDC_SW_ResetStats( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SEMDC_SW_H */
@@ -0,0 +1,226 @@
+/**
+  ******************************************************************************
+  * @file    semdc_text.c
+  * @brief   Text layout into glyph runs and drawing from them, see semdc_text.h.
+  ******************************************************************************
+  */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "s1d13c00_hcl.h"
+#include "s1d13c00_memregs.h"
+#include "s1d13c00_trace.h"
+#include "se_common.h"
+#include "se_dmac.h"
+#include "se_mdc.h"
+#include "semdc_gfx.h"
+#include "semdc_text.h"
+
+
+//---------------------------------------------------------------------------
+// PRIVATE FUNCTIONS
+//---------------------------------------------------------------------------
+
+// Destination point from the start of the string, as seMDC_GFX_PutString() justifies
+static int32_t Anchor( const seMDC_TEXT_Run *run )
+{
+    const seMDC_TEXT_Glyph *last;
+
+    if ( run->count == 0 )
+        return 0;
+    switch ( run->justify )
+    {
+    case seMDC_GFX_LEFT_JUSTIFIED:
+        return run->glyphs[0].width >> 1;
+    case seMDC_GFX_RIGHT_JUSTIFIED:
+        last = &run->glyphs[run->count - 1];
+        return last->x + (last->width >> 1);
+    default:
+        return run->width >> 1;
+    }
+}
+
+// Font pixels to destination pixels
+static int32_t Scale( int32_t v, uint16_t scale )
+{
+    return ((v * scale) + 128) >> 8;
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seMDC_TEXT_Layout()
+//---------------------------------------------------------------------------
+seStatus seMDC_TEXT_Layout( seMDC_TEXT_Run *run, const char *textstr )
+{
+    seMDC_TEXT_Glyph *g;
+    seMDC_GFX_FontChar fontchar;
+    seStatus fResult = seSTATUS_OK;
+    char *p = (char *)textstr;
+    uint32_t unicode;
+    uint16_t i = 0, keep;
+    int32_t x = 0;
+    uint8_t f;
+
+    keep = run->count;
+    if ( run->keyfonts != run->fonts || run->keynumfonts != run->numfonts )
+        keep = 0;
+    run->prevwidth   = (run->count != 0) ? run->width : 0;
+    run->prevanchor  = (run->count != 0) ? run->anchor : 0;
+    run->keyfonts    = run->fonts;
+    run->keynumfonts = run->numfonts;
+
+    while ( *p != 0 )
+    {
+        // ASCII needs no decoding
+        if ( (uint8_t)*p < 0x80 )
+            unicode = (uint8_t)*p++;
+        else
+            unicode = UTF8toUnicode( &p );
+
+        // Glyphs of the common prefix keep their fonts and positions
+        if ( i < keep && run->glyphs[i].unicode == unicode )
+        {
+            x += run->glyphs[i++].width;
+            continue;
+        }
+        if ( keep > i )
+            keep = i;
+
+        if ( i == SE_MDC_TEXT_MAX_GLYPHS )
+        {
+            fResult = seSTATUS_NG;
+            break;
+        }
+        for ( f = 0; f < run->numfonts; f++ )
+        {
+            if ( seMDC_GFX_GetFontChar( run->fonts[f].font, run->fonts[f].extloc, unicode, run->extbuffaddr,
+                                        run->dmachan, &fontchar ) == seSTATUS_OK )
+                break;
+        }
+        if ( f == run->numfonts )
+        {
+            fResult = seSTATUS_NG;
+            break;
+        }
+
+        g = &run->glyphs[i++];
+        g->unicode   = unicode;
+        g->offsetloc = fontchar.offsetloc;
+        g->x         = x;
+        g->width     = fontchar.width;
+        g->font      = f;
+        x += fontchar.width;
+    }
+    if ( keep > i )
+        keep = i;
+
+    run->count  = i;
+    run->width  = x;
+    run->anchor = Anchor( run );
+    // The last glyph kept is drawn again over its column next to the changed ones
+    if ( run->anchor != run->prevanchor )
+        run->redraw = 0;
+    else if ( keep == i && run->width == run->prevwidth )
+        run->redraw = i;
+    else
+        run->redraw = (keep != 0) ? keep - 1 : 0;
+    return fResult;
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seMDC_TEXT_Draw()
+//---------------------------------------------------------------------------
+seStatus seMDC_TEXT_Draw( const seMDC_TEXT_Run *run, uint16_t first, const seMDC_TEXT_Style *style )
+{
+    seTRACE_API();
+    const seMDC_TEXT_Glyph *g;
+    const seMDC_GFX_FontStruct *font;
+    seMDC_ImgCopyRotScaleCtrl cpyctrl;
+    seStatus fResult;
+    uint32_t addr;
+    int32_t ox, icx;
+    uint16_t i, w, h;
+    uint16_t scale = (style->xscale > style->yscale) ? style->xscale : style->yscale;
+    bool perchar = style->rotation == seMDC_GFX_ROTCHAR && style->rotval != 0;
+
+    cpyctrl.ctrlword = 0;
+    cpyctrl.ctrlword_b.bitmapen = 1;
+    for ( i = first; i < run->count; i++ )
+    {
+        g    = &run->glyphs[i];
+        font = run->fonts[g->font].font;
+        w    = g->width;
+        h    = font->height;
+
+        // Each glyph about its own center, or the whole string about the destination point
+        if ( perchar )
+        {
+            ox  = style->destx + Scale( g->x + (w >> 1) - run->anchor, style->xscale );
+            icx = w >> 1;
+            if ( ox < 0 )
+                continue;
+        }
+        else
+        {
+            ox  = style->destx;
+            icx = run->anchor - g->x;
+        }
+        if ( seMDC_IsCopyClipped( ox, style->desty, w, h, icx, h >> 1, scale ) )
+            continue;
+
+        if ( run->fonts[g->font].extloc )
+        {
+            addr = (uint32_t)(uintptr_t)font->pxdata + g->offsetloc;
+        }
+        else
+        {
+            addr = run->extbuffaddr;
+            seS1D13C00Write( addr, font->pxdata + g->offsetloc, ((w >> (3 - font->bitmapfmt)) + 1) * h );
+        }
+        cpyctrl.ctrlword_b.bitmapfmt = font->bitmapfmt;
+        fResult = seMDC_ImgCpyRotScale( (uint16_t)ox, style->desty, addr, w, w, h, (uint16_t)icx, h >> 1,
+                                        style->textcolor, style->rotval, style->xscale, style->xscale,
+                                        style->yscale, style->yscale, &cpyctrl );
+        seMDC_WaitGfxDone();
+        if ( fResult != seSTATUS_OK )
+            return fResult;
+    }
+    return seSTATUS_OK;
+}
+
+
+//---------------------------------------------------------------------------
+// PUBLIC FUNCTION: seMDC_TEXT_Box()
+//---------------------------------------------------------------------------
+int seMDC_TEXT_Box( const seMDC_TEXT_Run *run, const seMDC_TEXT_Style *style,
+                    int32_t *left, int32_t *top, int32_t *right, int32_t *bottom )
+{
+    int32_t from, to, h = 0;
+    uint8_t f;
+
+    // Font pixels from the destination point; the old glyphs after a kept
+    // redraw started at the same place, or anywhere when redraw is 0
+    if ( run->redraw == 0 )
+        from = ( -run->prevanchor < -run->anchor ) ? -run->prevanchor : -run->anchor;
+    else if ( run->redraw == run->count )
+        from = run->width - run->anchor;
+    else
+        from = run->glyphs[run->redraw].x + run->glyphs[run->redraw].width - run->anchor;
+    to   = run->width - run->anchor;
+    if ( run->prevwidth - run->prevanchor > to )
+        to = run->prevwidth - run->prevanchor;
+    if ( from >= to )
+        return 1;
+
+    for ( f = 0; f < run->numfonts; f++ )
+    {
+        if ( run->fonts[f].font->height > h )
+            h = run->fonts[f].font->height;
+    }
+    *left   = style->destx + Scale( from, style->xscale ) - 1;
+    *right  = style->destx + Scale( to, style->xscale );
+    *top    = style->desty - Scale( h >> 1, style->yscale ) - 1;
+    *bottom = *top + Scale( h, style->yscale ) + 1;
+    return 0;
+}
@@ -0,0 +1,138 @@
+/**
+  ******************************************************************************
+  * @file    semdc_text.h
+  * @brief   Text layout: strings decoded once into glyph runs, drawn from the
+  *          runs with bitmap fonts.
+  ******************************************************************************
+  * @attention
+  *
+  * A run holds the glyphs of one string: character, font, descriptor and left
+  * edge in font pixels from the start of the string. seMDC_TEXT_Layout() makes
+  * one pass over the string, decoding ASCII without the UTF-8 decoder, and looks
+  * new characters up in the fonts of the run in order; the first font holding a
+  * character draws it. The run is its own cache: while the fonts stay the same,
+  * the glyphs of the longest common prefix with the text it holds are kept, so
+  * laying out an unchanged label looks nothing up and a clock string only lays
+  * out the characters after the first one that changed. Scale, rotation and
+  * color are applied by seMDC_TEXT_Draw() and need no new layout.
+  *
+  * Glyphs are placed as seMDC_GFX_PutString() places them: the justification
+  * puts the center of the string, of its first glyph or of its last glyph at
+  * the destination point, and each glyph is centered vertically on it.
+  * After a layout, glyphs before redraw are where they were drawn before, and
+  * only the columns from seMDC_TEXT_Box() need erasing and drawing again. The
+  * engine rounds a scaled glyph one column into its neighbors, so redraw is the
+  * last glyph kept, drawn again over the column the box takes from it.
+  ******************************************************************************
+  */
+
+#ifndef SEMDC_TEXT_H
+#define SEMDC_TEXT_H
+
+#include <stdint.h>
+#include "se_common.h"
+#include "se_dmac.h"
+#include "se_mdc.h"
+#include "semdc_gfx.h"
+
+#ifndef SE_MDC_TEXT_MAX_GLYPHS
+#define SE_MDC_TEXT_MAX_GLYPHS  32              ///< Longest string a run holds
+#endif
+
+
+/**
+  * @brief  Font of a run.
+  */
+typedef struct {
+    seMDC_GFX_FontStruct *font;
+    uint8_t  extloc;                    ///< 0=internal (Host MCU), 1=external (memory-mapped serial flash)
+} seMDC_TEXT_Font;
+
+/**
+  * @brief  Laid out character.
+  */
+typedef struct {
+    uint32_t unicode;                   ///< Character
+    uint32_t offsetloc;                 ///< Pixel data offset in its font
+    int32_t  x;                         ///< Left edge from the start of the string, font pixels
+    uint16_t width;                     ///< Advance, font pixels
+    uint8_t  font;                      ///< Index in the fonts of the run
+} seMDC_TEXT_Glyph;
+
+/**
+  * @brief  Glyph run, owned by the caller. Clear count to lay the text out again
+  *         from scratch, e.g. after changing the fonts the run points to.
+  */
+typedef struct {
+    // Set by the caller
+    const seMDC_TEXT_Font *fonts;       ///< Fonts in fallback order
+    uint8_t  numfonts;
+    seMDC_GFX_STR_JUSTIFICATION justify; ///< Point of the string at the destination
+    uint32_t extbuffaddr;               ///< Controller RAM for glyphs of internal fonts and descriptors of external ones, see seMDC_GFX_PutStr_Params
+    seDMAC_CHANNEL dmachan;             ///< DMA channel for external fonts
+    // Set by seMDC_TEXT_Layout()
+    uint16_t count;                     ///< Glyphs
+    uint16_t redraw;                    ///< First glyph to draw again, count when none
+    int32_t  width;                     ///< Sum of the advances, font pixels
+    int32_t  anchor;                    ///< Destination point from the start of the string, font pixels
+    int32_t  prevwidth;                 ///< width and anchor before the last layout
+    int32_t  prevanchor;
+    const seMDC_TEXT_Font *keyfonts;    ///< fonts and numfonts of the glyphs
+    uint8_t  keynumfonts;
+    seMDC_TEXT_Glyph glyphs[SE_MDC_TEXT_MAX_GLYPHS];
+} seMDC_TEXT_Run;
+
+/**
+  * @brief  How a run is drawn.
+  */
+typedef struct {
+    uint16_t destx;                     ///< Destination point
+    uint16_t desty;
+    uint16_t textcolor;                 ///< Color of text
+    uint16_t xscale;                    ///< X scaling value, scale factor = xscale/256
+    uint16_t yscale;                    ///< Y scaling value, scale factor = yscale/256
+    seMDC_GFX_STR_ROTTYPE rotation;     ///< Rotation type, whole string or individual characters
+    uint16_t rotval;                    ///< Rotation value, rotation is rotval*360/512 degrees counterclockwise
+} seMDC_TEXT_Style;
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+  * @brief  Lay out a string, keeping the glyphs of the prefix it shares with the
+  *         text in the run.
+  * @param  run:  fonts, numfonts, justify, extbuffaddr and dmachan set
+  * @param  textstr:  UTF-8 string
+  * @retval Status: seSTATUS_NG if a character is in none of the fonts or the
+  *         string is longer than SE_MDC_TEXT_MAX_GLYPHS, with the glyphs before
+  *         it laid out
+  */
+seStatus seMDC_TEXT_Layout( seMDC_TEXT_Run *run, const char *textstr );
+
+/**
+  * @brief  Draw the glyphs of a run from first on, skipping the clipped ones, and
+  *         return with the engine idle.
+  * @param  run:  laid out run
+  * @param  first:  first glyph drawn, 0 or run->redraw
+  * @param  style:  destination, color, scale and rotation
+  * @retval Status: can be a value of @ref seStatus
+  */
+seStatus seMDC_TEXT_Draw( const seMDC_TEXT_Run *run, uint16_t first, const seMDC_TEXT_Style *style );
+
+/**
+  * @brief  Destination box of the glyphs after run->redraw, as drawn after the
+  *         last layout and before it, for erasing unrotated text. The box is one
+  *         pixel out to cover the rounding of the engine, into the last column
+  *         of run->redraw when it is kept, or of the whole text when redraw is 0.
+  * @retval Non-zero if there is nothing to erase
+  */
+int seMDC_TEXT_Box( const seMDC_TEXT_Run *run, const seMDC_TEXT_Style *style,
+                    int32_t *left, int32_t *top, int32_t *right, int32_t *bottom );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SEMDC_TEXT_H */
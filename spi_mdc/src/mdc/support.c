@@ -23,6 +23,21 @@
 
 uint32_t g_ui32SysClock;
 
+#define MDC_SPI_WRSPEED     6000000     // Host interface write speed
+#define MDC_SPI_RDSPEED     800000      // Single data read speed
+#define MDC_QSPI_RDSPEED    2000000     // Read speed of the dual and quad modes, the slowest QSPI clock
+
+
+//---------------------------------------------------------------------------
+// PRIVATE FUNCTION: ReadSpeed()
+//   Single data reads keep the conservative speed. The QSPI transport
+//   cannot clock below 2 MHz and would fall back to single data.
+//---------------------------------------------------------------------------
+static uint32_t ReadSpeed( hostmcu_config hostif )
+{
+    return ( hostif == HOSTMCU_SPI_MONOADDR_MONODATA ) ? MDC_SPI_RDSPEED : MDC_QSPI_RDSPEED;
+}
+
 
 void InitializeHost( void )
 {
@@ -71,7 +86,7 @@ void DisableHostInterrupt( void )
 void InitializeMDC( hostmcu_config hostif )
 {
     // Initialize S1D13C00 controller interface
-    seS1D13C00InitializeController(hostif, g_ui32SysClock, 6000000, 800000);
+    seS1D13C00InitializeController(hostif, g_ui32SysClock, MDC_SPI_WRSPEED, ReadSpeed( hostif ));
 
 #ifdef DEBUG_PRINT
     printf("S1D13C00 Interface configured...\n");
@@ -79,6 +94,13 @@ void InitializeMDC( hostmcu_config hostif )
 }
 
 
+void ResumeMDC( hostmcu_config hostif )
+{
+    // Same interface as InitializeMDC(), without the soft reset
+    seS1D13C00ResumeController(hostif, g_ui32SysClock, MDC_SPI_WRSPEED, ReadSpeed( hostif ));
+}
+
+
 
 static void (*button1callback)(void);
 void PortJ1Handler(void)
@@ -20,7 +20,7 @@
 #define LED_OFF()           (GPIOPinWrite(GPIO_PORTN_BASE, GPIO_PIN_0, 0))
 #define LED_TOGGLE()        (GPIOPinWrite(GPIO_PORTN_BASE, GPIO_PIN_0, GPIOPinRead(GPIO_PORTN_BASE, GPIO_PIN_0) ^ GPIO_PIN_0))
 
-#define seSysSleepMS(msval) nrf_delay_ms(msval)//ROM_SysCtlDelay((120000000/3000)*msval)
+#define seSysSleepMS(msval) seS1D13C00SleepMS(msval)//ROM_SysCtlDelay((120000000/3000)*msval)
 #define seSysSleep()        ROM_SysCtlSleep()
 
 #define TM4C1294
@@ -33,6 +33,7 @@ void DisableHostInterrupt( void );
 
 
 void InitializeMDC( hostmcu_config hostif );
+void ResumeMDC( hostmcu_config hostif );
 
 void InitializeButton1( void (*callback)(void) );
 bool Button1Pressed( void );
@@ -0,0 +1 @@
+#include "nrf_stub.h"
@@ -0,0 +1,245 @@
+/** @file
+ *
+ * @brief    Minimal nRF SDK declarations for building the nRF transports on the host.
+ *
+ * @details  Only what the SPIM and QSPI transports and the headers they include use. The drivers
+ *           are implemented by the test, see qspi_test.c, which serves them from the emulator.
+ */
+
+#ifndef NRF_STUB_H__
+#define NRF_STUB_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+typedef int nrfx_err_t;
+
+#define NRFX_SUCCESS                    0
+#define NRFX_ERROR_INVALID_STATE        8
+
+#define APP_ERROR_CHECK(err)            do { if ((err) != NRFX_SUCCESS) nrf_stub_error((err), __FILE__, __LINE__); } while (0)
+#define APP_IRQ_PRIORITY_LOWEST         7
+
+#define SPI_SS_PIN                      29
+#define SPI_MISO_PIN                    28
+#define SPI_MOSI_PIN                    4
+#define SPI_SCK_PIN                     3
+
+#define __WFE()                         ((void)0)
+
+extern uint32_t SystemCoreClock;
+
+void nrf_stub_error(nrfx_err_t err, char const * p_file, int line);
+void nrf_delay_us(uint32_t us);
+void nrf_delay_ms(uint32_t ms);
+
+typedef struct
+{
+    uint32_t DEMCR;
+} CoreDebug_Type;
+
+typedef struct
+{
+    uint32_t CTRL;
+    uint32_t CYCCNT;
+} DWT_Type;
+
+extern CoreDebug_Type nrf_stub_coredebug;
+extern DWT_Type       nrf_stub_dwt;
+
+#define CoreDebug                       (&nrf_stub_coredebug)
+#define DWT                             (&nrf_stub_dwt)
+#define CoreDebug_DEMCR_TRCENA_Msk      (1UL << 24)
+#define DWT_CTRL_CYCCNTENA_Msk          (1UL << 0)
+
+typedef struct NRF_SPIM_Type NRF_SPIM_Type;
+
+typedef enum
+{
+    NRF_SPIM_FREQ_125K,
+    NRF_SPIM_FREQ_250K,
+    NRF_SPIM_FREQ_500K,
+    NRF_SPIM_FREQ_1M,
+    NRF_SPIM_FREQ_2M,
+    NRF_SPIM_FREQ_4M,
+    NRF_SPIM_FREQ_8M,
+} nrf_spim_frequency_t;
+
+typedef enum
+{
+    NRF_SPIM_MODE_0,
+    NRF_SPIM_MODE_1,
+} nrf_spim_mode_t;
+
+typedef enum
+{
+    NRF_SPIM_BIT_ORDER_MSB_FIRST,
+    NRF_SPIM_BIT_ORDER_LSB_FIRST,
+} nrf_spim_bit_order_t;
+
+typedef struct
+{
+    NRF_SPIM_Type * p_reg;
+    uint8_t         drv_inst_idx;
+} nrfx_spim_t;
+
+#define NRFX_SPIM_INSTANCE(id)          { .p_reg = NULL, .drv_inst_idx = (id) }
+
+typedef struct
+{
+    uint8_t              sck_pin;
+    uint8_t              mosi_pin;
+    uint8_t              miso_pin;
+    uint8_t              ss_pin;
+    nrf_spim_frequency_t frequency;
+    nrf_spim_mode_t      mode;
+    nrf_spim_bit_order_t bit_order;
+} nrfx_spim_config_t;
+
+#define NRFX_SPIM_DEFAULT_CONFIG        { .frequency = NRF_SPIM_FREQ_4M }
+
+typedef struct
+{
+    uint8_t const * p_tx_buffer;
+    size_t          tx_length;
+    uint8_t *       p_rx_buffer;
+    size_t          rx_length;
+} nrfx_spim_xfer_desc_t;
+
+#define NRFX_SPIM_XFER_TRX(p_tx_buf, tx_len, p_rx_buf, rx_len)                 \
+    { .p_tx_buffer = (uint8_t const *)(p_tx_buf), .tx_length = (tx_len),       \
+      .p_rx_buffer = (p_rx_buf), .rx_length = (rx_len) }
+
+typedef struct
+{
+    nrfx_spim_xfer_desc_t xfer_desc;
+} nrfx_spim_evt_t;
+
+typedef void (* nrfx_spim_evt_handler_t)(nrfx_spim_evt_t const * p_event, void * p_context);
+
+void       nrf_spim_frequency_set(NRF_SPIM_Type * p_reg, nrf_spim_frequency_t frequency);
+nrfx_err_t nrfx_spim_init(nrfx_spim_t const * p_instance, nrfx_spim_config_t const * p_config,
+                          nrfx_spim_evt_handler_t handler, void * p_context);
+void       nrfx_spim_uninit(nrfx_spim_t const * p_instance);
+nrfx_err_t nrfx_spim_xfer(nrfx_spim_t const * p_instance, nrfx_spim_xfer_desc_t const * p_xfer_desc,
+                          uint32_t flags);
+
+#define NRF_QSPI_PIN_NOT_CONNECTED      0xFF
+
+typedef enum
+{
+    NRF_QSPI_READOC_FASTREAD,
+    NRF_QSPI_READOC_READ2O,
+    NRF_QSPI_READOC_READ2IO,
+    NRF_QSPI_READOC_READ4O,
+    NRF_QSPI_READOC_READ4IO,
+} nrf_qspi_readoc_t;
+
+typedef enum
+{
+    NRF_QSPI_WRITEOC_PP,
+    NRF_QSPI_WRITEOC_PP2O,
+    NRF_QSPI_WRITEOC_PP4O,
+    NRF_QSPI_WRITEOC_PP4IO,
+} nrf_qspi_writeoc_t;
+
+typedef enum
+{
+    NRF_QSPI_ADDRMODE_24BIT,
+    NRF_QSPI_ADDRMODE_32BIT,
+} nrf_qspi_addrmode_t;
+
+typedef enum
+{
+    NRF_QSPI_MODE_0,
+    NRF_QSPI_MODE_1,
+} nrf_qspi_spi_mode_t;
+
+typedef enum
+{
+    NRF_QSPI_FREQ_32MDIV1,
+    NRF_QSPI_FREQ_32MDIV16 = 15,
+} nrf_qspi_frequency_t;
+
+typedef enum
+{
+    NRF_QSPI_CINSTR_LEN_1B = 1,
+    NRF_QSPI_CINSTR_LEN_9B = 9,
+} nrf_qspi_cinstr_len_t;
+
+typedef struct
+{
+    uint8_t              sck_delay;
+    bool                 dpmen;
+    nrf_qspi_spi_mode_t  spi_mode;
+    nrf_qspi_frequency_t sck_freq;
+} nrf_qspi_phy_conf_t;
+
+typedef struct
+{
+    nrf_qspi_readoc_t   readoc;
+    nrf_qspi_writeoc_t  writeoc;
+    nrf_qspi_addrmode_t addrmode;
+    bool                dpmconfig;
+} nrf_qspi_prot_conf_t;
+
+typedef struct
+{
+    uint8_t sck_pin;
+    uint8_t csn_pin;
+    uint8_t io0_pin;
+    uint8_t io1_pin;
+    uint8_t io2_pin;
+    uint8_t io3_pin;
+} nrf_qspi_pins_t;
+
+typedef struct
+{
+    uint32_t             xip_offset;
+    nrf_qspi_pins_t      pins;
+    nrf_qspi_prot_conf_t prot_if;
+    nrf_qspi_phy_conf_t  phy_if;
+    uint8_t              irq_priority;
+} nrfx_qspi_config_t;
+
+typedef struct
+{
+    uint8_t               opcode;
+    nrf_qspi_cinstr_len_t length;
+    bool                  io2_level;
+    bool                  io3_level;
+    bool                  wipwait;
+    bool                  wren;
+} nrf_qspi_cinstr_conf_t;
+
+#define NRFX_QSPI_DEFAULT_CINSTR(opc, len)                      \
+{                                                               \
+    .opcode    = (opc),                                         \
+    .length    = (nrf_qspi_cinstr_len_t)(len),                  \
+    .io2_level = false,                                         \
+    .io3_level = false,                                         \
+    .wipwait   = false,                                         \
+    .wren      = false,                                         \
+}
+
+typedef enum
+{
+    NRFX_QSPI_EVENT_DONE,
+} nrfx_qspi_evt_t;
+
+typedef void (* nrfx_qspi_handler_t)(nrfx_qspi_evt_t event, void * p_context);
+
+typedef struct NRF_QSPI_Type NRF_QSPI_Type;
+
+#define NRF_QSPI                        ((NRF_QSPI_Type *)NULL)
+
+void       nrf_qspi_ifconfig1_set(NRF_QSPI_Type * p_reg, nrf_qspi_phy_conf_t const * p_config);
+nrfx_err_t nrfx_qspi_init(nrfx_qspi_config_t const * p_config, nrfx_qspi_handler_t handler, void * p_context);
+void       nrfx_qspi_uninit(void);
+nrfx_err_t nrfx_qspi_cinstr_xfer(nrf_qspi_cinstr_conf_t const * p_config, void const * p_tx_buffer, void * p_rx_buffer);
+nrfx_err_t nrfx_qspi_write(void const * p_tx_buffer, size_t tx_buffer_length, uint32_t dst_address);
+nrfx_err_t nrfx_qspi_read(void * p_rx_buffer, size_t rx_buffer_length, uint32_t src_address);
+
+#endif // NRF_STUB_H__
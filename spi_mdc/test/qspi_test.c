@@ -0,0 +1,401 @@
+/** @file
+ *
+ * @brief    Host test of the nRF52840 QSPI and SPIM transports against the emulator.
+ *
+ * @details  qspi_test [iterations]
+ *
+ *           s1d13c00_hcl_nrfqspi.c and s1d13c00_hcl_nrf.c are built unchanged against the
+ *           declarations in nrf_stub. The driver calls land here: custom instructions, the QSPI
+ *           READ and WRITE tasks and the SPIM transfers are checked against what the peripherals
+ *           accept (opcodes, lengths, word alignment, the mode set up at init) and served by the
+ *           emulator. Like the nrfx drivers, an init of a driver already initialized fails, which
+ *           APP_ERROR_CHECK turns into a test failure, and so does a peripheral taking the pins
+ *           the other one holds.
+ *
+ *           s1d13c00_hcl.c is built as for the nRF too, so the transport it picks for the host
+ *           interface mode is the firmware's. The auto scenarios leave the choice to it, the
+ *           wrapped one installs a counting wrapper around it the way mdc_disp does.
+ *
+ *           Each scenario starts the host interface the way the firmware does, InitializeMDC()
+ *           after ResumeMDC(), and reports the mode set up and which peripheral carried the
+ *           accesses. The dual data scenario then starts the panel, draws, and writes and reads
+ *           back random runs at random addresses, compared with the emulator RAM.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "nrfx_qspi.h"
+#include "s1d13c00_hcl.h"
+#include "s1d13c00_memregs.h"
+#include "s1d13c00_emu.h"
+#include "se_common.h"
+#include "se_clg.h"
+#include "se_mdc.h"
+
+#define TEST_RAM_SIZE                   0x4000                                      /**< RAM bytes used by the random runs. */
+#define TEST_MAX_RUN                    700                                         /**< Longest random run, several transfers. */
+
+/**@brief Accesses per peripheral since the last counters_reset(). */
+typedef struct
+{
+    uint32_t spim_xfers;
+    uint32_t cinstrs;
+    uint32_t tasks;
+    uint32_t task_bytes;
+    uint32_t wrapped_xfers;
+} test_counters_t;
+
+CoreDebug_Type nrf_stub_coredebug;
+DWT_Type       nrf_stub_dwt;
+uint32_t       SystemCoreClock = 64000000;
+
+static test_counters_t      m_count;
+static bool                 m_spim_init;
+static bool                 m_qspi_init;
+static nrfx_qspi_config_t   m_qspi_config;
+static nrfx_qspi_handler_t  m_qspi_handler;
+static nrfx_spim_evt_handler_t m_spim_handler;
+static uint32_t             m_failures;
+static uint32_t             m_rand = 0x9E3779B9UL;
+static seS1D13C00Transport const * mp_wrapped;                                      /**< Transport the counting wrapper forwards to. */
+static seS1D13C00Transport  m_wrapper;
+
+
+static uint32_t rand32(void)
+{
+    m_rand ^= m_rand << 13;
+    m_rand ^= m_rand >> 17;
+    m_rand ^= m_rand << 5;
+    return m_rand;
+}
+
+
+static void fail(char const * p_what, uint32_t a, uint32_t b)
+{
+    if (m_failures++ < 10)
+    {
+        printf("FAIL %s (%lu, %lu)\n", p_what, (unsigned long)a, (unsigned long)b);
+    }
+}
+
+
+static void emu_xfer(uint8_t cmd, uint32_t addr, uint8_t const * p_wdata, uint32_t wlen,
+                     uint8_t * p_rdata, uint32_t rlen)
+{
+    uint8_t hdr[SE_HCL_WRITE_HDR_LEN] =
+    {
+        cmd, (uint8_t)(addr >> 24), (uint8_t)(addr >> 16), (uint8_t)(addr >> 8), (uint8_t)addr
+    };
+
+    seS1D13C00EmuTransport.xfer(hdr, sizeof(hdr), p_wdata, wlen, p_rdata, rlen);
+}
+
+
+static void wrapper_xfer(uint8_t const hdr[], uint32_t hlen, uint8_t const wdata[], uint32_t wlen,
+                         uint8_t rdata[], uint32_t rlen)
+{
+    m_count.wrapped_xfers++;
+    mp_wrapped->xfer(hdr, hlen, wdata, wlen, rdata, rlen);
+}
+
+
+void nrf_stub_error(nrfx_err_t err, char const * p_file, int line)
+{
+    printf("FAIL APP_ERROR_CHECK %d at %s:%d\n", err, p_file, line);
+    exit(1);
+}
+
+
+void nrf_delay_us(uint32_t us)
+{
+}
+
+
+void nrf_delay_ms(uint32_t ms)
+{
+    seS1D13C00EmuTransport.sleep_ms(ms);
+}
+
+
+void nrf_spim_frequency_set(NRF_SPIM_Type * p_reg, nrf_spim_frequency_t frequency)
+{
+    if (!m_spim_init)
+    {
+        fail("SPIM frequency without init", frequency, 0);
+    }
+}
+
+
+nrfx_err_t nrfx_spim_init(nrfx_spim_t const * p_instance, nrfx_spim_config_t const * p_config,
+                          nrfx_spim_evt_handler_t handler, void * p_context)
+{
+    if (m_spim_init)
+    {
+        return NRFX_ERROR_INVALID_STATE;
+    }
+    if (m_qspi_init)
+    {
+        fail("SPIM init with the QSPI holding the pins", 0, 0);
+    }
+    m_spim_handler = handler;
+    m_spim_init    = true;
+    return NRFX_SUCCESS;
+}
+
+
+void nrfx_spim_uninit(nrfx_spim_t const * p_instance)
+{
+    m_spim_init = false;
+}
+
+
+/**@brief A transfer is a header and write data, or a header and the bytes clocked in after it. */
+nrfx_err_t nrfx_spim_xfer(nrfx_spim_t const * p_instance, nrfx_spim_xfer_desc_t const * p_xfer_desc,
+                          uint32_t flags)
+{
+    uint8_t const * p_tx = p_xfer_desc->p_tx_buffer;
+    uint32_t        addr = ((uint32_t)p_tx[1] << 24) | ((uint32_t)p_tx[2] << 16) | ((uint32_t)p_tx[3] << 8) | p_tx[4];
+
+    if (!m_spim_init || (p_xfer_desc->tx_length < SE_HCL_WRITE_HDR_LEN))
+    {
+        fail("SPIM transfer", m_spim_init, (uint32_t)p_xfer_desc->tx_length);
+        return NRFX_SUCCESS;
+    }
+    m_count.spim_xfers++;
+    if (p_xfer_desc->rx_length != 0)
+    {
+        emu_xfer(p_tx[0], addr, NULL, 0, &p_xfer_desc->p_rx_buffer[SE_HCL_READ_HDR_LEN],
+                 (uint32_t)p_xfer_desc->rx_length - SE_HCL_READ_HDR_LEN);
+    }
+    else
+    {
+        emu_xfer(p_tx[0], addr, &p_tx[SE_HCL_WRITE_HDR_LEN], (uint32_t)p_xfer_desc->tx_length - SE_HCL_WRITE_HDR_LEN,
+                 NULL, 0);
+    }
+    m_spim_handler(NULL, NULL);
+    return NRFX_SUCCESS;
+}
+
+
+void nrf_qspi_ifconfig1_set(NRF_QSPI_Type * p_reg, nrf_qspi_phy_conf_t const * p_config)
+{
+    if (!m_qspi_init || (p_config->sck_freq > NRF_QSPI_FREQ_32MDIV16))
+    {
+        fail("IFCONFIG1", m_qspi_init, p_config->sck_freq);
+    }
+}
+
+
+nrfx_err_t nrfx_qspi_init(nrfx_qspi_config_t const * p_config, nrfx_qspi_handler_t handler, void * p_context)
+{
+    if (m_qspi_init)
+    {
+        return NRFX_ERROR_INVALID_STATE;
+    }
+    if (m_spim_init)
+    {
+        fail("QSPI init with the SPIM holding the pins", 0, 0);
+    }
+    if ((p_config->phy_if.sck_freq > NRF_QSPI_FREQ_32MDIV16) ||
+        (p_config->prot_if.addrmode != NRF_QSPI_ADDRMODE_32BIT) || (handler == NULL))
+    {
+        fail("QSPI configuration", p_config->phy_if.sck_freq, p_config->prot_if.addrmode);
+    }
+    m_qspi_config  = *p_config;
+    m_qspi_handler = handler;
+    m_qspi_init    = true;
+    return NRFX_SUCCESS;
+}
+
+
+void nrfx_qspi_uninit(void)
+{
+    m_qspi_init = false;
+}
+
+
+nrfx_err_t nrfx_qspi_cinstr_xfer(nrf_qspi_cinstr_conf_t const * p_config, void const * p_tx_buffer, void * p_rx_buffer)
+{
+    uint8_t const * p_tx = p_tx_buffer;
+    uint32_t        addr;
+    uint32_t        len;
+
+    // Opcode, 32-bit address and 1 to 3 bytes
+    if (!m_qspi_init || (p_config->length < 6) || (p_config->length > 8) ||
+        ((p_config->opcode != CMD_PAGEPROG) && (p_config->opcode != CMD_FASTREAD)))
+    {
+        fail("custom instruction", p_config->opcode, p_config->length);
+        return NRFX_SUCCESS;
+    }
+    addr = ((uint32_t)p_tx[0] << 24) | ((uint32_t)p_tx[1] << 16) | ((uint32_t)p_tx[2] << 8) | p_tx[3];
+    len  = p_config->length - 5;
+
+    m_count.cinstrs++;
+    if (p_config->opcode == CMD_PAGEPROG)
+    {
+        emu_xfer(CMD_PAGEPROG, addr, &p_tx[4], len, NULL, 0);
+    }
+    else
+    {
+        memset(p_rx_buffer, 0, 4);
+        emu_xfer(CMD_FASTREAD, addr, NULL, 0, &((uint8_t *)p_rx_buffer)[4], len);
+    }
+    return NRFX_SUCCESS;
+}
+
+
+static bool task_check(void const * p_buffer, size_t length, uint32_t address)
+{
+    if (!m_qspi_init || (((uintptr_t)p_buffer & 3) != 0) || ((length & 3) != 0) ||
+        ((address & 3) != 0) || (length == 0) || (length > 256))
+    {
+        fail("task", address, (uint32_t)length);
+        return false;
+    }
+    m_count.tasks++;
+    m_count.task_bytes += (uint32_t)length;
+    return true;
+}
+
+
+nrfx_err_t nrfx_qspi_write(void const * p_tx_buffer, size_t tx_buffer_length, uint32_t dst_address)
+{
+    if (task_check(p_tx_buffer, tx_buffer_length, dst_address))
+    {
+        emu_xfer(CMD_PAGEPROG, dst_address, p_tx_buffer, (uint32_t)tx_buffer_length, NULL, 0);
+    }
+    m_qspi_handler(NRFX_QSPI_EVENT_DONE, NULL);
+    return NRFX_SUCCESS;
+}
+
+
+nrfx_err_t nrfx_qspi_read(void * p_rx_buffer, size_t rx_buffer_length, uint32_t src_address)
+{
+    if (task_check(p_rx_buffer, rx_buffer_length, src_address))
+    {
+        emu_xfer(CMD_FASTREAD, src_address, NULL, 0, p_rx_buffer, (uint32_t)rx_buffer_length);
+    }
+    m_qspi_handler(NRFX_QSPI_EVENT_DONE, NULL);
+    return NRFX_SUCCESS;
+}
+
+
+/**@brief Writes and reads back random runs at random addresses, checked against the emulator RAM. */
+static void random_runs(uint32_t iterations)
+{
+    static uint8_t wr[TEST_MAX_RUN];
+    static uint8_t rd[TEST_MAX_RUN];
+
+    for (uint32_t it = 0; it < iterations; it++)
+    {
+        uint32_t len  = 1 + rand32() % TEST_MAX_RUN;
+        uint32_t offs = rand32() % (TEST_RAM_SIZE - len);
+
+        for (uint32_t i = 0; i < len; i++)
+        {
+            wr[i] = (uint8_t)rand32();
+        }
+        seS1D13C00Write(RAM_BASE + offs, wr, len);
+        if (memcmp(&seEMU_Ram()[offs], wr, len) != 0)
+        {
+            fail("write", offs, len);
+        }
+        seS1D13C00Read(RAM_BASE + offs, rd, len);
+        if (memcmp(rd, wr, len) != 0)
+        {
+            fail("read", offs, len);
+        }
+    }
+}
+
+
+/**@brief Starts the host interface in a mode, checks the mode set up and the peripheral used.
+ *        p_transport NULL leaves the choice of the transport to the HCL.
+ */
+static void scenario_run(char const * p_name, seS1D13C00Transport const * p_transport, hostmcu_config hostif,
+                         hostmcu_config expect, uint32_t iterations)
+{
+    uint32_t     failures = m_failures;
+    seEMU_Stats  stats;
+    bool         qspi;
+
+    seEMU_Reset();
+    memset(&m_count, 0, sizeof(m_count));
+    seS1D13C00SetTransport(p_transport);
+
+    InitializeHost();
+    ResumeMDC(hostif);
+    InitializeMDC(hostif);
+    qspi = m_qspi_init;
+    if ((seS1D13C00GetHostIf() != expect) || (qspi != (expect != HOSTMCU_SPI_MONOADDR_MONODATA)) ||
+        (qspi == m_spim_init))
+    {
+        fail("mode set up", seS1D13C00GetHostIf(), expect);
+    }
+    if ((p_transport == &m_wrapper) && (m_count.wrapped_xfers == 0))
+    {
+        fail("wrapper bypassed", m_count.spim_xfers, m_count.tasks);
+    }
+
+    if (iterations != 0)
+    {
+        memset(&m_count, 0, sizeof(m_count));
+        seCLG_Start(seCLG_IOSC);
+        seCLG_Start(seCLG_OSC1);
+        if (seMDC_InitPanel_LS012B7DH02(20000000L, RAM_BASE) != seSTATUS_OK)
+        {
+            fail("panel init", hostif, 0);
+        }
+        (void)seMDC_DrawRectangle(10, 10, 100, 60, 0x03, 0, 0, 1);
+        seMDC_WaitGfxDone();
+        (void)seMDC_PanelUpdate(0, 239);
+        seMDC_WaitUpdDone();
+        random_runs(iterations);
+        if (qspi ? ((m_count.spim_xfers != 0) || (m_count.tasks == 0)) : (m_count.cinstrs + m_count.tasks != 0))
+        {
+            fail("accesses on the wrong peripheral", m_count.spim_xfers, m_count.tasks);
+        }
+    }
+
+    seEMU_GetStats(&stats);
+    if (stats.bad_accesses != 0)
+    {
+        fail("bad accesses", stats.bad_accesses, 0);
+    }
+    seS1D13C00GetTransport()->uninit();
+
+    printf("{\"scenario\":\"%s\",\"ok\":%s,\"hostif\":%d,\"qspi\":%s,\"tasks\":%lu,\"task_bytes\":%lu,"
+           "\"cinstrs\":%lu,\"spim_xfers\":%lu}\n",
+           p_name, (m_failures == failures) ? "true" : "false", (int)seS1D13C00GetHostIf(),
+           qspi ? "true" : "false", (unsigned long)m_count.tasks, (unsigned long)m_count.task_bytes,
+           (unsigned long)m_count.cinstrs, (unsigned long)m_count.spim_xfers);
+}
+
+
+int main(int argc, char * argv[])
+{
+    uint32_t iterations = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : 2000;
+
+    seS1D13C00Transport const * p_qspi = &seS1D13C00NrfQspiTransport;
+    seS1D13C00Transport const * p_spim = &seS1D13C00NrfTransport;
+
+    scenario_run("dual", p_qspi, HOSTMCU_SPI_MONOADDR_DUALDATA, HOSTMCU_SPI_MONOADDR_DUALDATA, iterations);
+    scenario_run("dual_addr", p_qspi, HOSTMCU_SPI_DUALADDR_DUALDATA, HOSTMCU_SPI_DUALADDR_DUALDATA, 0);
+    scenario_run("single", p_qspi, HOSTMCU_SPI_MONOADDR_MONODATA, HOSTMCU_SPI_MONOADDR_MONODATA, 0);
+    scenario_run("quad_no_io2", p_qspi, HOSTMCU_SPI_MONOADDR_QUADDATA, HOSTMCU_SPI_MONOADDR_MONODATA, 0);
+    scenario_run("dual_all", p_qspi, HOSTMCU_SPI_DUAL_ALL, HOSTMCU_SPI_MONOADDR_MONODATA, 0);
+    scenario_run("spim", p_spim, HOSTMCU_SPI_MONOADDR_MONODATA, HOSTMCU_SPI_MONOADDR_MONODATA, iterations);
+    scenario_run("auto_dual", NULL, HOSTMCU_SPI_MONOADDR_DUALDATA, HOSTMCU_SPI_MONOADDR_DUALDATA, 0);
+    scenario_run("auto_single", NULL, HOSTMCU_SPI_MONOADDR_MONODATA, HOSTMCU_SPI_MONOADDR_MONODATA, 0);
+
+    mp_wrapped       = seS1D13C00HostIfTransport(HOSTMCU_SPI_MONOADDR_DUALDATA);
+    m_wrapper        = *mp_wrapped;
+    m_wrapper.xfer   = wrapper_xfer;
+    scenario_run("wrapped", &m_wrapper, HOSTMCU_SPI_MONOADDR_DUALDATA, HOSTMCU_SPI_MONOADDR_DUALDATA, 0);
+
+    printf("%s\n", (m_failures == 0) ? "PASS" : "FAIL");
+    return (m_failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,429 @@
+/** @file
+ *
+ * @brief    Host test of the text layout (semdc_text) against the emulator.
+ *
+ * @details  text_test
+ *
+ *           Layout: glyph positions, widths and anchors for each justification, font fallback
+ *           order, UTF-8 decoding, characters in no font, strings longer than a run, external
+ *           fonts, and the run as a cache: the common prefix is kept while the fonts stay the
+ *           same, and redraw points at the first glyph that moved or changed.
+ *
+ *           Drawing, compared pixel by pixel in the emulated frame buffer: a run rotated as a
+ *           whole string draws what seMDC_GFX_PutString() draws, and erasing seMDC_TEXT_Box()
+ *           then drawing from redraw gives the same frame as drawing the new text from scratch,
+ *           for a ticking clock at several scales and justifications.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "s1d13c00_hcl.h"
+#include "s1d13c00_memregs.h"
+#include "s1d13c00_emu.h"
+#include "se_common.h"
+#include "se_clg.h"
+#include "se_dmac.h"
+#include "se_mdc.h"
+#include "semdc_gfx.h"
+#include "semdc_text.h"
+
+#define TEST_FONT_H                     16
+#define TEST_ASCII_FIRST                0x20
+#define TEST_ASCII_CHARS                95
+#define TEST_DIGIT_W                    12                                          /**< Digit font, '0' to '9'. */
+#define TEST_GREEK_FIRST                0x391                                       /**< Greek capitals, from Alpha. */
+#define TEST_GREEK_CHARS                25
+#define TEST_GREEK_W                    9
+#define TEST_PX_MAX                     (TEST_ASCII_CHARS * 2 * TEST_FONT_H)
+
+#define TEST_FONT_OFS                   0x10000                                     /**< External copy of the ASCII font, from RAM_BASE. */
+#define TEST_STRBUF_OFS                 0x18000                                     /**< Glyph copy buffer. */
+#define TEST_DMA_OFS                    0x1C000                                     /**< DMAC descriptors, 1 KB aligned. */
+#define TEST_FB_MAX                     (320 * 320)
+
+/**@brief A font with its descriptors and pixels. */
+typedef struct
+{
+    seMDC_GFX_FontStruct font;
+    seMDC_GFX_FontChar   chars[TEST_ASCII_CHARS];
+    uint8_t              px[TEST_PX_MAX];
+} test_font_t;
+
+static test_font_t          m_ascii;
+static test_font_t          m_digits;
+static test_font_t          m_greek;
+static seMDC_GFX_FontStruct m_ascii_ext;
+static seMDC_TEXT_Font      m_fonts[4];                                             /**< ASCII, digits, Greek, external ASCII. */
+
+static uint16_t             m_w;
+static uint16_t             m_h;
+static uint32_t             m_fb_size;
+static uint8_t              m_frame[TEST_FB_MAX];
+static uint32_t             m_checks;
+static uint32_t             m_failures;
+
+
+static void check(bool ok, char const * p_what, int32_t a, int32_t b)
+{
+    m_checks++;
+    if (!ok && (m_failures++ < 20))
+    {
+        printf("FAIL %s (%ld, %ld)\n", p_what, (long)a, (long)b);
+    }
+}
+
+
+/**@brief Builds a font of count characters from first, of width(c) pixels, with a pattern
+ *        differing per character and row.
+ */
+static void font_build(test_font_t * p_font, uint32_t first, uint32_t count, uint16_t width, bool vary)
+{
+    uint32_t offset = 0;
+
+    for (uint32_t c = 0; c < count; c++)
+    {
+        uint16_t w      = (uint16_t)(vary ? width + c % 5 : width);
+        uint32_t stride = (w >> 3) + 1;
+
+        p_font->chars[c].width     = w;
+        p_font->chars[c].offsetloc = offset;
+        for (uint32_t i = 0; i < stride * TEST_FONT_H; i++)
+        {
+            p_font->px[offset + i] = (uint8_t)((first + c) * 37 + i * 11);
+        }
+        offset += stride * TEST_FONT_H;
+    }
+    p_font->font.bitmapfmt    = seMDC_BITMAP_1BIT;
+    p_font->font.height       = TEST_FONT_H;
+    p_font->font.numchars     = count;
+    p_font->font.unicode_base = first;
+    p_font->font.charstbl     = p_font->chars;
+    p_font->font.pxdata       = p_font->px;
+}
+
+
+static void fonts_init(void)
+{
+    uint32_t ext = RAM_BASE + TEST_FONT_OFS;
+
+    font_build(&m_ascii, TEST_ASCII_FIRST, TEST_ASCII_CHARS, 6, true);
+    font_build(&m_digits, '0', 10, TEST_DIGIT_W, false);
+    font_build(&m_greek, TEST_GREEK_FIRST, TEST_GREEK_CHARS, TEST_GREEK_W, false);
+
+    // External fonts are read by controller address
+    seS1D13C00Write(ext, (uint8_t *)m_ascii.chars, sizeof(m_ascii.chars));
+    seS1D13C00Write(ext + sizeof(m_ascii.chars), m_ascii.px, sizeof(m_ascii.px));
+    m_ascii_ext          = m_ascii.font;
+    m_ascii_ext.charstbl = (seMDC_GFX_FontChar *)(uintptr_t)ext;
+    m_ascii_ext.pxdata   = (uint8_t *)(uintptr_t)(ext + sizeof(m_ascii.chars));
+
+    m_fonts[0].font   = &m_ascii.font;
+    m_fonts[1].font   = &m_digits.font;
+    m_fonts[2].font   = &m_greek.font;
+    m_fonts[3].font   = &m_ascii_ext;
+    m_fonts[3].extloc = 1;
+}
+
+
+static uint16_t ascii_w(char c)
+{
+    return m_ascii.chars[(uint8_t)c - TEST_ASCII_FIRST].width;
+}
+
+
+static void run_init(seMDC_TEXT_Run * p_run, seMDC_TEXT_Font const * p_fonts, uint8_t numfonts,
+                     seMDC_GFX_STR_JUSTIFICATION justify)
+{
+    memset(p_run, 0, sizeof(*p_run));
+    p_run->fonts       = p_fonts;
+    p_run->numfonts    = numfonts;
+    p_run->justify     = justify;
+    p_run->extbuffaddr = RAM_BASE + TEST_STRBUF_OFS;
+    p_run->dmachan     = seDMAC_CH0;
+}
+
+
+/**@brief Positions, widths and anchors of an ASCII string for each justification. */
+static void test_positions(void)
+{
+    static char const     text[] = "Hello, 10:08!";
+    seMDC_TEXT_Run        run;
+    int32_t               x = 0;
+
+    run_init(&run, &m_fonts[0], 1, seMDC_GFX_CENTER_JUSTIFIED);
+    check(seMDC_TEXT_Layout(&run, text) == seSTATUS_OK, "layout", 0, 0);
+    check(run.count == strlen(text), "count", run.count, (int32_t)strlen(text));
+    for (uint16_t i = 0; i < run.count; i++)
+    {
+        seMDC_TEXT_Glyph const * p_g = &run.glyphs[i];
+
+        check((p_g->unicode == (uint8_t)text[i]) && (p_g->font == 0), "glyph", i, (int32_t)p_g->unicode);
+        check((p_g->x == x) && (p_g->width == ascii_w(text[i])), "position", i, p_g->x);
+        check(p_g->offsetloc == m_ascii.chars[(uint8_t)text[i] - TEST_ASCII_FIRST].offsetloc, "offset", i, 0);
+        x += p_g->width;
+    }
+    check(run.width == x, "width", run.width, x);
+    check(run.anchor == x / 2, "center anchor", run.anchor, x / 2);
+    check(run.redraw == 0, "first layout redraws all", run.redraw, 0);
+
+    run_init(&run, &m_fonts[0], 1, seMDC_GFX_LEFT_JUSTIFIED);
+    (void)seMDC_TEXT_Layout(&run, text);
+    check(run.anchor == ascii_w('H') / 2, "left anchor", run.anchor, ascii_w('H') / 2);
+
+    run_init(&run, &m_fonts[0], 1, seMDC_GFX_RIGHT_JUSTIFIED);
+    (void)seMDC_TEXT_Layout(&run, text);
+    check(run.anchor == x - ascii_w('!') + ascii_w('!') / 2, "right anchor", run.anchor, 0);
+
+    run_init(&run, &m_fonts[0], 1, seMDC_GFX_CENTER_JUSTIFIED);
+    check((seMDC_TEXT_Layout(&run, "") == seSTATUS_OK) && (run.count == 0) && (run.width == 0) &&
+          (run.anchor == 0), "empty string", run.count, run.width);
+}
+
+
+/**@brief Fonts are tried in order, UTF-8 is decoded, failures keep the glyphs before them. */
+static void test_fonts(void)
+{
+    static seMDC_TEXT_Font const digits_first[2] = { { &m_digits.font, 0 }, { &m_ascii.font, 0 } };
+    static seMDC_TEXT_Font const greek_ascii[2]  = { { &m_greek.font, 0 },  { &m_ascii.font, 0 } };
+    char                         longtext[SE_MDC_TEXT_MAX_GLYPHS + 2];
+    seMDC_TEXT_Run               run;
+
+    run_init(&run, digits_first, 2, seMDC_GFX_LEFT_JUSTIFIED);
+    check(seMDC_TEXT_Layout(&run, "a1b") == seSTATUS_OK, "fallback layout", 0, 0);
+    check((run.glyphs[0].font == 1) && (run.glyphs[1].font == 0) && (run.glyphs[2].font == 1),
+          "fallback order", run.glyphs[0].font, run.glyphs[1].font);
+    check(run.glyphs[1].width == TEST_DIGIT_W, "digit from the first font", run.glyphs[1].width, TEST_DIGIT_W);
+
+    // U+0391 U+03A9 between ASCII, two bytes each
+    run_init(&run, greek_ascii, 2, seMDC_GFX_LEFT_JUSTIFIED);
+    check(seMDC_TEXT_Layout(&run, "x\xCE\x91y\xCE\xA9") == seSTATUS_OK, "UTF-8 layout", 0, 0);
+    check(run.count == 4, "UTF-8 count", run.count, 4);
+    check((run.glyphs[1].unicode == 0x391) && (run.glyphs[3].unicode == 0x3A9) && (run.glyphs[1].font == 0) &&
+          (run.glyphs[0].font == 1), "UTF-8 decode", (int32_t)run.glyphs[1].unicode, (int32_t)run.glyphs[3].unicode);
+    check(run.glyphs[3].x == ascii_w('x') + TEST_GREEK_W + ascii_w('y'), "UTF-8 position", run.glyphs[3].x, 0);
+
+    // Omega is in no font of this run
+    run_init(&run, &m_fonts[0], 1, seMDC_GFX_LEFT_JUSTIFIED);
+    check(seMDC_TEXT_Layout(&run, "ab\xCE\xA9" "cd") == seSTATUS_NG, "missing character", 0, 0);
+    check((run.count == 2) && (run.width == ascii_w('a') + ascii_w('b')), "glyphs before it", run.count, run.width);
+
+    memset(longtext, 'm', sizeof(longtext) - 1);
+    longtext[sizeof(longtext) - 1] = 0;
+    check(seMDC_TEXT_Layout(&run, longtext) == seSTATUS_NG, "too long", 0, 0);
+    check(run.count == SE_MDC_TEXT_MAX_GLYPHS, "run full", run.count, SE_MDC_TEXT_MAX_GLYPHS);
+    longtext[SE_MDC_TEXT_MAX_GLYPHS] = 0;
+    check(seMDC_TEXT_Layout(&run, longtext) == seSTATUS_OK, "longest", run.count, SE_MDC_TEXT_MAX_GLYPHS);
+}
+
+
+/**@brief An external font lays out as its internal copy. */
+static void test_external(void)
+{
+    static char const text[] = "Ext 42 ~";
+    seMDC_TEXT_Run    a, b;
+
+    run_init(&a, &m_fonts[0], 1, seMDC_GFX_CENTER_JUSTIFIED);
+    run_init(&b, &m_fonts[3], 1, seMDC_GFX_CENTER_JUSTIFIED);
+    check((seMDC_TEXT_Layout(&a, text) == seSTATUS_OK) && (seMDC_TEXT_Layout(&b, text) == seSTATUS_OK),
+          "external layout", 0, 0);
+    check((a.count == b.count) && (a.width == b.width) && (a.anchor == b.anchor), "external run", a.width, b.width);
+    for (uint16_t i = 0; i < a.count; i++)
+    {
+        check((a.glyphs[i].width == b.glyphs[i].width) && (a.glyphs[i].offsetloc == b.glyphs[i].offsetloc),
+              "external glyph", i, b.glyphs[i].width);
+    }
+}
+
+
+/**@brief The run keeps the common prefix while the fonts are the same, and sets redraw. */
+static void test_cache(void)
+{
+    static seMDC_TEXT_Font fonts_b[1] = { { &m_ascii.font, 0 } };
+    seMDC_TEXT_Run         run;
+    uint16_t               saved = m_ascii.chars['1' - TEST_ASCII_FIRST].width;
+
+    run_init(&run, &m_fonts[0], 1, seMDC_GFX_LEFT_JUSTIFIED);
+    (void)seMDC_TEXT_Layout(&run, "10:08:30");
+    (void)seMDC_TEXT_Layout(&run, "10:08:31");
+    check(run.redraw == 6, "tick redraws the last glyph and the one before", run.redraw, 6);
+    (void)seMDC_TEXT_Layout(&run, "10:08:31");
+    check(run.redraw == run.count, "unchanged text redraws nothing", run.redraw, run.count);
+    (void)seMDC_TEXT_Layout(&run, "10:08:3");
+    check((run.redraw == 6) && (run.count == 7), "shorter text", run.redraw, run.count);
+
+    // Kept glyphs are not looked up again: a changed descriptor only shows in new glyphs
+    m_ascii.chars['1' - TEST_ASCII_FIRST].width = 20;
+    (void)seMDC_TEXT_Layout(&run, "10:08:31");
+    check(run.glyphs[0].width == saved, "prefix kept", run.glyphs[0].width, saved);
+    check(run.glyphs[7].width == 20, "new glyph looked up", run.glyphs[7].width, 20);
+
+    // Other fonts, or a cleared run, lay out from scratch
+    run.fonts = fonts_b;
+    (void)seMDC_TEXT_Layout(&run, "10:08:31");
+    check((run.glyphs[0].width == 20) && (run.redraw == 0), "new fonts", run.glyphs[0].width, run.redraw);
+    m_ascii.chars['1' - TEST_ASCII_FIRST].width = saved;
+    run.count = 0;
+    (void)seMDC_TEXT_Layout(&run, "10:08:31");
+    check(run.glyphs[0].width == saved, "cleared run", run.glyphs[0].width, saved);
+
+    // A moved anchor moves every glyph
+    run_init(&run, &m_fonts[0], 1, seMDC_GFX_CENTER_JUSTIFIED);
+    (void)seMDC_TEXT_Layout(&run, "10:08:30");
+    (void)seMDC_TEXT_Layout(&run, "10:08:32");
+    check((ascii_w('0') == ascii_w('2')) || (run.redraw == 0), "center anchor moved", run.redraw, 0);
+    (void)seMDC_TEXT_Layout(&run, "10:08:3 ");
+    check(run.redraw == ((ascii_w('2') == ascii_w(' ')) ? 6 : 0), "center redraw", run.redraw, 0);
+}
+
+
+static void frame_clear(void)
+{
+    (void)seMDC_DrawRectangle(0, 0, m_w - 1, m_h - 1, 0, 0, 0, FILL_ENABLE);
+    seMDC_WaitGfxDone();
+}
+
+
+/**@brief Whole-string rotation draws what PutString draws. */
+static void test_putstring(void)
+{
+    static char const       text[] = "Wq 10:08";
+    static uint16_t const   rotvals[] = { 32, 64, 200, 448 };
+    seMDC_GFX_PutStr_Params params;
+    seMDC_TEXT_Style        style;
+    seMDC_TEXT_Run          run;
+
+    for (uint32_t r = 0; r < sizeof(rotvals) / sizeof(rotvals[0]); r++)
+    {
+        for (uint32_t j = seMDC_GFX_CENTER_JUSTIFIED; j <= seMDC_GFX_RIGHT_JUSTIFIED; j++)
+        {
+            memset(&params, 0, sizeof(params));
+            params.destx       = m_w / 2;
+            params.desty       = m_h / 2;
+            params.font1       = &m_ascii.font;
+            params.font2       = &m_ascii.font;
+            params.textcolor   = 0xFF;
+            params.xscale      = 256 + 64 * r;
+            params.yscale      = 256;
+            params.justify     = (seMDC_GFX_STR_JUSTIFICATION)j;
+            params.rotation    = seMDC_GFX_ROTSTRING;
+            params.rotval      = rotvals[r];
+            params.extbuffaddr = RAM_BASE + TEST_STRBUF_OFS;
+            params.dmachan     = seDMAC_CH0;
+
+            frame_clear();
+            check(seMDC_GFX_PutString(&params, (char *)text) == seSTATUS_OK, "PutString", (int32_t)r, (int32_t)j);
+            memcpy(m_frame, seEMU_Ram(), m_fb_size);
+
+            memset(&style, 0, sizeof(style));
+            style.destx     = params.destx;
+            style.desty     = params.desty;
+            style.textcolor = params.textcolor;
+            style.xscale    = params.xscale;
+            style.yscale    = params.yscale;
+            style.rotation  = params.rotation;
+            style.rotval    = params.rotval;
+            run_init(&run, &m_fonts[0], 1, (seMDC_GFX_STR_JUSTIFICATION)j);
+            (void)seMDC_TEXT_Layout(&run, text);
+
+            frame_clear();
+            check(seMDC_TEXT_Draw(&run, 0, &style) == seSTATUS_OK, "draw", (int32_t)r, (int32_t)j);
+            check(memcmp(m_frame, seEMU_Ram(), m_fb_size) == 0, "same pixels as PutString", (int32_t)r, (int32_t)j);
+        }
+    }
+}
+
+
+/**@brief A ticking clock redrawn from redraw after erasing the box matches a full draw. */
+static void test_incremental(void)
+{
+    static char const * const times[] = { "9:59:58", "9:59:59", "10:00:00", "10:00:01", "10:00:11", "10:01:11",
+                                          "10:01:1", "10:01:1", "11:11:11", "1:00:00", "", "1:00:00" };
+    static uint16_t const     scales[] = { 256, 384, 512 };
+    seMDC_TEXT_Style          style;
+    seMDC_TEXT_Run            run, fresh;
+    int32_t                   left, top, right, bottom;
+
+    for (uint32_t s = 0; s < sizeof(scales) / sizeof(scales[0]); s++)
+    {
+        for (uint32_t j = seMDC_GFX_CENTER_JUSTIFIED; j <= seMDC_GFX_RIGHT_JUSTIFIED; j++)
+        {
+            memset(&style, 0, sizeof(style));
+            style.destx     = m_w / 2;
+            style.desty     = m_h / 2;
+            style.textcolor = 0xFF;
+            style.xscale    = scales[s];
+            style.yscale    = scales[s];
+            style.rotation  = seMDC_GFX_ROTSTRING;
+
+            run_init(&run, &m_fonts[0], 1, (seMDC_GFX_STR_JUSTIFICATION)j);
+            frame_clear();
+            for (uint32_t t = 0; t < sizeof(times) / sizeof(times[0]); t++)
+            {
+                (void)seMDC_TEXT_Layout(&run, times[t]);
+                if (seMDC_TEXT_Box(&run, &style, &left, &top, &right, &bottom) == 0)
+                {
+                    (void)seMDC_DrawRectangle((uint16_t)left, (uint16_t)top, (uint16_t)right, (uint16_t)bottom,
+                                              0, 0, 0, FILL_ENABLE);
+                    seMDC_WaitGfxDone();
+                }
+                (void)seMDC_TEXT_Draw(&run, run.redraw, &style);
+                memcpy(m_frame, seEMU_Ram(), m_fb_size);
+
+                run_init(&fresh, &m_fonts[0], 1, (seMDC_GFX_STR_JUSTIFICATION)j);
+                (void)seMDC_TEXT_Layout(&fresh, times[t]);
+                frame_clear();
+                (void)seMDC_TEXT_Draw(&fresh, 0, &style);
+                check(memcmp(m_frame, seEMU_Ram(), m_fb_size) == 0, "incremental redraw", (int32_t)(s * 3 + j),
+                      (int32_t)t);
+
+                // Go on from the incremental frame
+                memcpy(seEMU_Ram(), m_frame, m_fb_size);
+            }
+        }
+    }
+}
+
+
+int main(void)
+{
+    seS1D13C00SetTransport(&seS1D13C00EmuTransport);
+    seEMU_Reset();
+    InitializeHost();
+    InitializeMDC(HOSTMCU_SPI_MONOADDR_MONODATA);
+    seCLG_Start(seCLG_IOSC);
+    seCLG_Start(seCLG_OSC1);
+    if (seMDC_InitPanel_LS012B7DH02(20000000L, RAM_BASE) != seSTATUS_OK)
+    {
+        printf("FAIL panel init\n");
+        return 1;
+    }
+    m_w       = seS1D13C00Read16(MDC_GFXOWIDTH);
+    m_h       = seS1D13C00Read16(MDC_GFXOHEIGHT);
+    m_fb_size = (uint32_t)seS1D13C00Read16(MDC_GFXOSTRIDE) * m_h;
+    if ((seS1D13C00Read32(MDC_GFXOBADDR0) != RAM_BASE) || (m_fb_size > sizeof(m_frame)) ||
+        (m_fb_size > TEST_FONT_OFS))
+    {
+        printf("FAIL frame buffer\n");
+        return 1;
+    }
+    if (seDMAC_Init(RAM_BASE + TEST_DMA_OFS, 4) != seSTATUS_OK)
+    {
+        printf("FAIL DMAC init\n");
+        return 1;
+    }
+    fonts_init();
+
+    test_positions();
+    test_fonts();
+    test_external();
+    test_cache();
+    test_putstring();
+    test_incremental();
+
+    printf("%lu checks, %lu failed\n%s\n", (unsigned long)m_checks, (unsigned long)m_failures,
+           (m_failures == 0) ? "PASS" : "FAIL");
+    return (m_failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,174 @@
+/** @file
+ *
+ * @brief    Offline packer for images unpacked by seMDC_PACK_Load().
+ *
+ * @details  Packs a raw bitmap or font file in the format of semdc_pack.h. Built by the mdc_pack
+ *           target of the CMake host build, or by hand:
+ *
+ *           gcc -O2 -DSE_HCL_HOST -Isrc/mdc tools/mdc_pack.c $(find src/mdc -name '*.c') -lm -o mdc_pack
+ *           ./mdc_pack [-m raw|rle|lz|best] [-c name] input output
+ *
+ *           best, the default, keeps the smallest of the three. -c writes a C array named name
+ *           instead of a binary file. Build with the SE_MDC_PACK_WINDOW of the firmware, an image
+ *           packed with a larger window is rejected by the unpacker.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "semdc_pack.h"
+
+static char const * const m_method_names[] = { "raw", "rle", "lz" };
+
+
+static void usage(const char * p_prog)
+{
+    fprintf(stderr, "usage: %s [-m raw|rle|lz|best] [-c name] input output\n", p_prog);
+}
+
+
+static uint8_t * read_file(const char * p_path, uint32_t * p_len)
+{
+    FILE *    p_file = fopen(p_path, "rb");
+    uint8_t * p_data;
+    long      len;
+
+    if (p_file == NULL)
+    {
+        perror(p_path);
+        return NULL;
+    }
+    fseek(p_file, 0, SEEK_END);
+    len = ftell(p_file);
+    fseek(p_file, 0, SEEK_SET);
+    p_data = malloc((len > 0) ? (size_t)len : 1);
+    if ((p_data == NULL) || (fread(p_data, 1, (size_t)len, p_file) != (size_t)len))
+    {
+        fprintf(stderr, "%s: read failed\n", p_path);
+        free(p_data);
+        p_data = NULL;
+    }
+    fclose(p_file);
+    *p_len = (uint32_t)len;
+    return p_data;
+}
+
+
+static bool write_file(const char * p_path, const char * p_name, const uint8_t * p_data, uint32_t len)
+{
+    FILE * p_file = fopen(p_path, p_name != NULL ? "w" : "wb");
+    bool   ok;
+
+    if (p_file == NULL)
+    {
+        perror(p_path);
+        return false;
+    }
+    if (p_name == NULL)
+    {
+        ok = (fwrite(p_data, 1, len, p_file) == len);
+    }
+    else
+    {
+        fprintf(p_file, "#include <stdint.h>\n\n/* Packed with mdc_pack, %lu bytes unpacked. */\n"
+                        "const uint8_t %s[%lu] =\n{",
+                (unsigned long)seMDC_PACK_Size(p_data), p_name, (unsigned long)len);
+        for (uint32_t i = 0; i < len; i++)
+        {
+            fprintf(p_file, "%s0x%02X,", (i % 16 == 0) ? "\n    " : " ", p_data[i]);
+        }
+        ok = (fprintf(p_file, "\n};\n") > 0);
+    }
+    ok = (fclose(p_file) == 0) && ok;
+    if (!ok)
+    {
+        fprintf(stderr, "%s: write failed\n", p_path);
+    }
+    return ok;
+}
+
+
+int main(int argc, char * argv[])
+{
+    char const * p_name = NULL;
+    int          method = -1;
+    int          i;
+    uint8_t *    p_data;
+    uint8_t *    p_out;
+    uint8_t *    p_best = NULL;
+    uint32_t     len, bound, packed, best = 0;
+    bool         ok;
+
+    for (i = 1; (i < argc) && (argv[i][0] == '-'); i++)
+    {
+        if ((strcmp(argv[i], "-m") == 0) && (i + 1 < argc))
+        {
+            i++;
+            for (method = seMDC_PACK_LZ; method >= 0; method--)
+            {
+                if (strcmp(argv[i], m_method_names[method]) == 0)
+                {
+                    break;
+                }
+            }
+            if ((method < 0) && (strcmp(argv[i], "best") != 0))
+            {
+                usage(argv[0]);
+                return 2;
+            }
+        }
+        else if ((strcmp(argv[i], "-c") == 0) && (i + 1 < argc))
+        {
+            p_name = argv[++i];
+        }
+        else
+        {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (i + 2 != argc)
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    p_data = read_file(argv[i], &len);
+    if (p_data == NULL)
+    {
+        return 1;
+    }
+    bound  = seMDC_PACK_BOUND(len);
+    p_out  = malloc(bound);
+    p_best = malloc(bound);
+    if ((p_out == NULL) || (p_best == NULL))
+    {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    for (int m = seMDC_PACK_RAW; m <= seMDC_PACK_LZ; m++)
+    {
+        if ((method >= 0) && (m != method))
+        {
+            continue;
+        }
+        packed = seMDC_PACK_Encode((seMDC_PACK_METHOD)m, p_data, len, p_out, bound);
+        fprintf(stderr, "%s: %lu -> %lu bytes\n", m_method_names[m], (unsigned long)len, (unsigned long)packed);
+        if ((packed != 0) && ((best == 0) || (packed < best)))
+        {
+            uint8_t * p_tmp = p_best;
+
+            p_best = p_out;
+            p_out  = p_tmp;
+            best   = packed;
+        }
+    }
+
+    ok = (best != 0) && write_file(argv[i + 1], p_name, p_best, best);
+    free(p_data);
+    free(p_out);
+    free(p_best);
+    return ok ? 0 : 1;
+}